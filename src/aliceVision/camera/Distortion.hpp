@@ -25,6 +25,11 @@ public:
         return _distortionParams;
     }
 
+    const std::vector<double>& getParameters() const
+    {
+        return _distortionParams;
+    }
+
     size_t getDistortionParametersCount()
     {
         return _distortionParams.size();
@@ -42,6 +47,22 @@ public:
         return p;
     }
 
+    /// Add distortion to a set of points (one point per column, in the camera frame [normalized coordinates])
+    virtual void addDistortionPoints(const Mat2X& p, Mat2X& out) const
+    {
+        out.resize(2, p.cols());
+        for(Eigen::Index i = 0; i < p.cols(); ++i)
+            out.col(i) = addDistortion(p.col(i));
+    }
+
+    /// Remove distortion from a set of points (one point per column, in the camera frame [normalized coordinates])
+    virtual void removeDistortionPoints(const Mat2X& p, Mat2X& out) const
+    {
+        out.resize(2, p.cols());
+        for(Eigen::Index i = 0; i < p.cols(); ++i)
+            out.col(i) = removeDistortion(p.col(i));
+    }
+
     virtual double getUndistortedRadius(double r) const
     {
         return r;
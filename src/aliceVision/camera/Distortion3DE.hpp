@@ -242,12 +242,15 @@ public:
 
   Eigen::Matrix2d getDerivativeRemoveDistoWrtPt(const Vec2 & p) const override
   {
-    ALICEVISION_THROW_ERROR("Invalid class for getDerivativeRemoveDistoWrtPt");
+    // removeDistortion is the inverse of addDistortion
+    return getDerivativeAddDistoWrtPt(removeDistortion(p)).inverse();
   }
 
   Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2 & p) const override
   {
-    ALICEVISION_THROW_ERROR("Invalid class for getDerivativeRemoveDistoWrtDisto");
+    // implicit function: addDistortion(removeDistortion(p)) = p
+    const Vec2 p_undist = removeDistortion(p);
+    return -getDerivativeAddDistoWrtPt(p_undist).inverse() * getDerivativeAddDistoWrtDisto(p_undist);
   }
 
   double getUndistortedRadius(double r) const override
@@ -321,12 +324,12 @@ public:
     //np.y() = y * (1.0 + cyx * xx + cyy * yy);
 
     //np.x() = x + cxx * xxx + cxy * xyy);
-    //np.x() = y + cxx * yxx + cxy * yyy);
+    //np.y() = y + cyx * yxx + cyy * yyy);
 
     ret(0, 0) = 1.0 + 3.0 * cxx * xx + cxy * yy;
-    ret(0, 1) = 2.0 * cxy * y;
-    ret(1, 0) = 2.0 * cyx * x;
-    ret(1, 1) = 1.0 + cxx * xx + 3.0 * cxy * yy;
+    ret(0, 1) = 2.0 * cxy * x * y;
+    ret(1, 0) = 2.0 * cyx * x * y;
+    ret(1, 1) = 1.0 + cyx * xx + 3.0 * cyy * yy;
 
     return ret;
   }
@@ -383,12 +386,15 @@ public:
 
   Eigen::Matrix2d getDerivativeRemoveDistoWrtPt(const Vec2 & p) const override
   {
-    ALICEVISION_THROW_ERROR("Invalid class for getDerivativeRemoveDistoWrtPt");
+    // removeDistortion is the inverse of addDistortion
+    return getDerivativeAddDistoWrtPt(removeDistortion(p)).inverse();
   }
 
   Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2 & p) const override
   {
-    ALICEVISION_THROW_ERROR("Invalid class for getDerivativeRemoveDistoWrtDisto");
+    // implicit function: addDistortion(removeDistortion(p)) = p
+    const Vec2 p_undist = removeDistortion(p);
+    return -getDerivativeAddDistoWrtPt(p_undist).inverse() * getDerivativeAddDistoWrtDisto(p_undist);
   }
 
   double getUndistortedRadius(double r) const override
@@ -641,12 +647,15 @@ public:
 
   Eigen::Matrix2d getDerivativeRemoveDistoWrtPt(const Vec2 & p) const override
   {
-    ALICEVISION_THROW_ERROR("Invalid class for getDerivativeRemoveDistoWrtPt");
+    // removeDistortion is the inverse of addDistortion
+    return getDerivativeAddDistoWrtPt(removeDistortion(p)).inverse();
   }
 
   Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2 & p) const override
   {
-    ALICEVISION_THROW_ERROR("Invalid class for getDerivativeRemoveDistoWrtDisto");
+    // implicit function: addDistortion(removeDistortion(p)) = p
+    const Vec2 p_undist = removeDistortion(p);
+    return -getDerivativeAddDistoWrtPt(p_undist).inverse() * getDerivativeAddDistoWrtDisto(p_undist);
   }
 
   double getUndistortedRadius(double r) const override
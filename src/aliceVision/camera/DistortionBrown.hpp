@@ -50,6 +50,68 @@ public:
         return p_u;
     }
 
+    void addDistortionPoints(const Mat2X& p, Mat2X& out) const override
+    {
+        Mat2X d;
+        distoFunctionPoints(_distortionParams, p, d);
+        out = p + d;
+    }
+
+    Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2& p) const override
+    {
+        const double k1 = _distortionParams[0], k2 = _distortionParams[1], k3 = _distortionParams[2];
+        const double t1 = _distortionParams[3], t2 = _distortionParams[4];
+        const double x = p(0);
+        const double y = p(1);
+        const double r2 = x * x + y * y;
+        const double k_diff = r2 * (k1 + r2 * (k2 + r2 * k3));
+        const double d_k_diff_d_r2 = k1 + r2 * (2.0 * k2 + 3.0 * r2 * k3);
+
+        Eigen::Matrix2d J;
+        J(0, 0) = 1.0 + k_diff + 2.0 * x * x * d_k_diff_d_r2 + 6.0 * t2 * x + 2.0 * t1 * y;
+        J(0, 1) = 2.0 * x * y * d_k_diff_d_r2 + 2.0 * t2 * y + 2.0 * t1 * x;
+        J(1, 0) = 2.0 * x * y * d_k_diff_d_r2 + 2.0 * t1 * x + 2.0 * t2 * y;
+        J(1, 1) = 1.0 + k_diff + 2.0 * y * y * d_k_diff_d_r2 + 6.0 * t1 * y + 2.0 * t2 * x;
+
+        return J;
+    }
+
+    Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2& p) const override
+    {
+        const double x = p(0);
+        const double y = p(1);
+        const double r2 = x * x + y * y;
+        const double r4 = r2 * r2;
+        const double r6 = r4 * r2;
+
+        Eigen::Matrix<double, 2, 5> J;
+        J(0, 0) = x * r2;
+        J(0, 1) = x * r4;
+        J(0, 2) = x * r6;
+        J(0, 3) = 2.0 * x * y;
+        J(0, 4) = r2 + 2.0 * x * x;
+        J(1, 0) = y * r2;
+        J(1, 1) = y * r4;
+        J(1, 2) = y * r6;
+        J(1, 3) = r2 + 2.0 * y * y;
+        J(1, 4) = 2.0 * x * y;
+
+        return J;
+    }
+
+    Eigen::Matrix2d getDerivativeRemoveDistoWrtPt(const Vec2& p) const override
+    {
+        // removeDistortion is the inverse of addDistortion
+        return getDerivativeAddDistoWrtPt(removeDistortion(p)).inverse();
+    }
+
+    Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2& p) const override
+    {
+        // implicit function: addDistortion(removeDistortion(p)) = p
+        const Vec2 p_undist = removeDistortion(p);
+        return -getDerivativeAddDistoWrtPt(p_undist).inverse() * getDerivativeAddDistoWrtDisto(p_undist);
+    }
+
     // Functor to calculate distortion offset accounting for both radial and tangential distortion
     static Vec2 distoFunction(const std::vector<double>& params, const Vec2& p)
     {
@@ -65,6 +127,20 @@ public:
         return d;
     }
 
+    // Distortion offset of a set of points (one point per column)
+    static void distoFunctionPoints(const std::vector<double>& params, const Mat2X& p, Mat2X& d)
+    {
+        const double k1 = params[0], k2 = params[1], k3 = params[2], t1 = params[3], t2 = params[4];
+        const auto x = p.row(0).array();
+        const auto y = p.row(1).array();
+        const Eigen::Array<double, 1, Eigen::Dynamic> r2 = x * x + y * y;
+        const Eigen::Array<double, 1, Eigen::Dynamic> k_diff = r2 * (k1 + r2 * (k2 + r2 * k3));
+
+        d.resize(2, p.cols());
+        d.row(0).array() = x * k_diff + t2 * (r2 + 2 * x * x) + 2 * t1 * x * y;
+        d.row(1).array() = y * k_diff + t1 * (r2 + 2 * y * y) + 2 * t2 * x * y;
+    }
+
     ~DistortionBrown() override = default;
 };
 
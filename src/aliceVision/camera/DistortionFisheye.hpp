@@ -135,6 +135,43 @@ public:
     return ret;
   }
 
+  void addDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    const double eps = 1e-8;
+    const double k1 = _distortionParams.at(0);
+    const double k2 = _distortionParams.at(1);
+    const double k3 = _distortionParams.at(2);
+    const double k4 = _distortionParams.at(3);
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r = p.colwise().norm().array();
+    const Eigen::Array<double, 1, Eigen::Dynamic> theta = r.atan();
+    const Eigen::Array<double, 1, Eigen::Dynamic> theta2 = theta.square();
+    const Eigen::Array<double, 1, Eigen::Dynamic> theta_dist = theta * (1. + theta2 * (k1 + theta2 * (k2 + theta2 * (k3 + theta2 * k4))));
+    const Eigen::Array<double, 1, Eigen::Dynamic> cdist = (r < eps).select(1.0, theta_dist / r);
+
+    out = p.array().rowwise() * cdist;
+  }
+
+  void removeDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    const double eps = 1e-8;
+    const double k1 = _distortionParams.at(0);
+    const double k2 = _distortionParams.at(1);
+    const double k3 = _distortionParams.at(2);
+    const double k4 = _distortionParams.at(3);
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> theta_dist = p.colwise().norm().array();
+    Eigen::Array<double, 1, Eigen::Dynamic> theta = theta_dist;
+    for (int j = 0; j < 10; ++j)
+    {
+      const Eigen::Array<double, 1, Eigen::Dynamic> theta2 = theta.square();
+      theta = theta_dist / (1. + theta2 * (k1 + theta2 * (k2 + theta2 * (k3 + theta2 * k4))));
+    }
+    const Eigen::Array<double, 1, Eigen::Dynamic> scale = (theta_dist > eps).select(theta.tan() / theta_dist, 1.0);
+
+    out = p.array().rowwise() * scale;
+  }
+
   /// Remove distortion (return p' such that disto(p') = p)
   Vec2 removeDistortion(const Vec2& p) const override
   {
@@ -173,54 +210,11 @@ public:
     return Jinv.inverse();
   }
 
-  Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2 & p) const override {
-    
-    double r_dist = sqrt(p(0)*p(0) + p(1)*p(1));
-    const double eps = 1e-8;
-    if (r_dist < eps) {
-      return Eigen::Matrix<double, 2, 4>::Zero();
-    }
-
+  Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2 & p) const override
+  {
+    // implicit function: addDistortion(removeDistortion(p)) = p
     const Vec2 p_undist = removeDistortion(p);
-    const double r = sqrt(p_undist(0) * p_undist(0) + p_undist(1) * p_undist(1));
-
-    const double k1 = _distortionParams.at(0);
-    const double k2 = _distortionParams.at(1);
-    const double k3 = _distortionParams.at(2);
-    const double k4 = _distortionParams.at(3);
-
-    const double theta = std::atan(r);
-    const double theta2 = theta*theta;
-    const double theta3 = theta2*theta;
-    const double theta4 = theta2*theta2;
-    const double theta5 = theta4*theta;
-    const double theta6 = theta3*theta3;
-    const double theta7 = theta6*theta;
-    const double theta8 = theta4*theta4;
-    const double theta9 = theta8*theta;
-    const double theta_dist = theta + k1 * theta3 + k2 * theta5 + k3 * theta7 + k4 * theta9;
-    const double r_coeff = theta_dist / r;
-    double d_r_coeff_d_theta_dist = 1.0 / r;
-
-    Eigen::Matrix<double, 1, 4> d_r_theta_dist_d_params;
-    d_r_theta_dist_d_params(0, 0) = theta3;
-    d_r_theta_dist_d_params(0, 1) = theta5;
-    d_r_theta_dist_d_params(0, 2) = theta7;
-    d_r_theta_dist_d_params(0, 3) = theta9;
-
-    Eigen::Matrix<double, 1, 4> d_rcoeff_d_params = d_r_coeff_d_theta_dist * d_r_theta_dist_d_params;
-    
-    Eigen::Matrix<double, 2, 4> ret;
-    ret(0, 0) = - (p(0) * d_rcoeff_d_params(0, 0)) / (r_coeff * r_coeff);
-    ret(0, 1) = - (p(0) * d_rcoeff_d_params(0, 1)) / (r_coeff * r_coeff);
-    ret(0, 2) = - (p(0) * d_rcoeff_d_params(0, 2)) / (r_coeff * r_coeff);
-    ret(0, 3) = - (p(0) * d_rcoeff_d_params(0, 3)) / (r_coeff * r_coeff);
-    ret(1, 0) = - (p(1) * d_rcoeff_d_params(0, 0)) / (r_coeff * r_coeff);
-    ret(1, 1) = - (p(1) * d_rcoeff_d_params(0, 1)) / (r_coeff * r_coeff);
-    ret(1, 2) = - (p(1) * d_rcoeff_d_params(0, 2)) / (r_coeff * r_coeff);
-    ret(1, 3) = - (p(1) * d_rcoeff_d_params(0, 3)) / (r_coeff * r_coeff);
-
-    return ret;
+    return -getDerivativeAddDistoWrtPt(p_undist).inverse() * getDerivativeAddDistoWrtDisto(p_undist);
   }
 
   ~DistortionFisheye() override = default;
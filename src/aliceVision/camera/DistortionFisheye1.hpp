@@ -45,6 +45,72 @@ public:
     return  p * coef;
   }
 
+  Eigen::Matrix2d getDerivativeAddDistoWrtPt(const Vec2 & p) const override
+  {
+    const double eps = 1e-8;
+    const double k1 = _distortionParams.at(0);
+    const double a = 2.0 * std::tan(0.5 * k1);
+    const double r = std::hypot(p(0), p(1));
+    if (r < eps)
+    {
+      return Eigen::Matrix2d::Identity() * (a / k1);
+    }
+
+    const double coef = (std::atan(a * r) / k1) / r;
+    const double d_coef_d_r = a / (k1 * r * (1.0 + a * a * r * r)) - coef / r;
+
+    Eigen::Matrix<double, 1, 2> d_r_d_p;
+    d_r_d_p(0) = p(0) / r;
+    d_r_d_p(1) = p(1) / r;
+
+    return Eigen::Matrix2d::Identity() * coef + p * d_coef_d_r * d_r_d_p;
+  }
+
+  Eigen::MatrixXd getDerivativeAddDistoWrtDisto(const Vec2 & p) const override
+  {
+    const double eps = 1e-8;
+    const double k1 = _distortionParams.at(0);
+    const double a = 2.0 * std::tan(0.5 * k1);
+    const double d_a_d_k1 = 1.0 + 0.25 * a * a;
+    const double r = std::hypot(p(0), p(1));
+
+    double d_coef_d_k1 = d_a_d_k1 / k1 - a / (k1 * k1);
+    if (r >= eps)
+    {
+      d_coef_d_k1 = d_a_d_k1 / (k1 * (1.0 + a * a * r * r)) - std::atan(a * r) / (k1 * k1 * r);
+    }
+
+    const Eigen::Matrix<double, 2, 1> J = p * d_coef_d_k1;
+    return J;
+  }
+
+  Eigen::Matrix2d getDerivativeRemoveDistoWrtPt(const Vec2 & p) const override
+  {
+    // removeDistortion is the inverse of addDistortion
+    return getDerivativeAddDistoWrtPt(removeDistortion(p)).inverse();
+  }
+
+  Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2 & p) const override
+  {
+    // implicit function: addDistortion(removeDistortion(p)) = p
+    const Vec2 p_undist = removeDistortion(p);
+    return -getDerivativeAddDistoWrtPt(p_undist).inverse() * getDerivativeAddDistoWrtDisto(p_undist);
+  }
+
+  void addDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    const double k1 = _distortionParams.at(0);
+    const Eigen::Array<double, 1, Eigen::Dynamic> r = p.colwise().norm().array();
+    out = p.array().rowwise() * ((2.0 * std::tan(0.5 * k1) * r).atan() / (k1 * r));
+  }
+
+  void removeDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    const double k1 = _distortionParams.at(0);
+    const Eigen::Array<double, 1, Eigen::Dynamic> r = p.colwise().norm().array();
+    out = p.array().rowwise() * (0.5 * (k1 * r).tan() / (std::tan(0.5 * k1) * r));
+  }
+
   ~DistortionFisheye1() override  = default;
 };
 
@@ -46,6 +46,83 @@ namespace radial_distortion{
     return .5*(lowerbound+upbound);
   }
 
+  /**
+   * @brief Remove the radial distortion of a set of points with Newton iterations on the radius.
+   *        For large sets, the iterations are seeded from a lookup table of the inverse
+   *        distortion function, sampled up to the largest distorted radius of the set.
+   *        Points where Newton does not converge fall back to Disto::removeDistortion (bisection).
+   * @param[in] disto the radial distortion model, providing the static radiusFunctor
+   *            computing the distorted radius and its derivative from the undistorted radius
+   * @param[in] p distorted points (one per column)
+   * @param[out] out undistorted points
+   * @param[in] lutSize size of the lookup table
+   */
+  template <class Disto>
+  void newton_Radius_Solve(const Disto& disto,
+                           const Mat2X& p,
+                           Mat2X& out,
+                           int lutSize = 256)
+  {
+    const std::vector<double>& params = disto.getParameters();
+    const Eigen::Index nbPoints = p.cols();
+    const Eigen::ArrayXd rd = p.colwise().norm().transpose().array();
+
+    // seed: undistorted radius sampled on a regular grid of distorted radius
+    Eigen::ArrayXd ru = rd;
+    if(nbPoints >= lutSize && rd.maxCoeff() > 0.0)
+    {
+      const double rdStep = rd.maxCoeff() / (lutSize - 1);
+      std::vector<double> lut(1, 0.0);
+      lut.reserve(lutSize);
+
+      double prevRu = 0.0;
+      double prevRd = 0.0;
+      for(int i = 1; i <= 4 * lutSize && static_cast<int>(lut.size()) < lutSize; ++i)
+      {
+        const double r = i * rdStep;
+        double rdi, derivative;
+        Disto::radiusFunctor(params, r, rdi, derivative);
+        // the distortion is not invertible beyond its first extremum
+        if(derivative <= 0.0)
+          break;
+        while(static_cast<int>(lut.size()) < lutSize && lut.size() * rdStep <= rdi)
+        {
+          const double target = lut.size() * rdStep;
+          lut.push_back(prevRu + (r - prevRu) * (target - prevRd) / (rdi - prevRd));
+        }
+        prevRu = r;
+        prevRd = rdi;
+      }
+
+      for(Eigen::Index i = 0; i < nbPoints; ++i)
+      {
+        const double pos = rd(i) / rdStep;
+        const std::size_t j = static_cast<std::size_t>(pos);
+        if(j + 1 < lut.size())
+          ru(i) = lut[j] + (lut[j + 1] - lut[j]) * (pos - j);
+      }
+    }
+
+    Eigen::ArrayXd rdCur(nbPoints), derivative(nbPoints);
+    for(int iter = 0; iter < 6; ++iter)
+    {
+      Disto::radiusFunctor(params, ru, rdCur, derivative);
+      ru -= (rdCur - rd) / derivative;
+    }
+    Disto::radiusFunctor(params, ru, rdCur, derivative);
+
+    out.resize(2, nbPoints);
+    for(Eigen::Index i = 0; i < nbPoints; ++i)
+    {
+      if(rd(i) == 0.0)
+        out.col(i) = p.col(i);
+      else if(ru(i) > 0.0 && derivative(i) > 0.0 && std::abs(rdCur(i) - rd(i)) <= 1e-10 * std::max(1.0, rd(i)))
+        out.col(i) = p.col(i) * (ru(i) / rd(i));
+      else
+        out.col(i) = disto.removeDistortion(p.col(i));
+    }
+  }
+
 } // namespace radial_distortion
 
 /**
@@ -155,32 +232,24 @@ public:
     return Jinv.inverse();
   }
 
-  Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2 & p) const override {
-    
-    double r_dist = sqrt(p(0)*p(0) + p(1)*p(1));
-    const double eps = 1e-8;
-    if (r_dist < eps)
-    {
-      return Eigen::Matrix<double, 2, 1>::Zero();
-    }
-
+  Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2 & p) const override
+  {
+    // implicit function: addDistortion(removeDistortion(p)) = p
     const Vec2 p_undist = removeDistortion(p);
+    return -getDerivativeAddDistoWrtPt(p_undist).inverse() * getDerivativeAddDistoWrtDisto(p_undist);
+  }
 
-    const double k1 = _distortionParams[0];
-
-    const double r = sqrt(p_undist(0)*p_undist(0) + p_undist(1)*p_undist(1));
-    const double r2 = r * r;
-    
-    const double r_coeff = 1.0 + k1 * r2;
+  void addDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    const double k1 = _distortionParams.at(0);
 
-    Eigen::Matrix<double, 1, 1> d_rcoeff_d_params;
-    d_rcoeff_d_params(0, 0) = r2;
-    
-    Eigen::Matrix<double, 2, 1> ret;
-    ret(0, 0) = - (p(0) * d_rcoeff_d_params(0, 0)) / (r_coeff * r_coeff);
-    ret(1, 0) = - (p(1) * d_rcoeff_d_params(0, 0)) / (r_coeff * r_coeff);
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = p.colwise().squaredNorm().array();
+    out = p.array().rowwise() * (1. + k1 * r2);
+  }
 
-    return ret;
+  void removeDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    radial_distortion::newton_Radius_Solve(*this, p, out);
   }
 
   double getUndistortedRadius(double r) const override
@@ -195,6 +264,16 @@ public:
     return r2 * Square(1.+r2*k1);
   }
 
+  /// Distorted radius and its derivative from the undistorted radius r (scalar or Eigen array)
+  template <class T>
+  static void radiusFunctor(const std::vector<double> & params, const T& r, T& rd, T& derivative)
+  {
+    const double k1 = params[0];
+    const T r2 = r * r;
+    rd = r * (1. + k1 * r2);
+    derivative = 1. + 3. * k1 * r2;
+  }
+
   ~DistortionRadialK1() override = default;
 };
 
@@ -333,40 +412,24 @@ public:
 
   Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2 & p) const override
   {
-    
-    double r_dist = sqrt(p(0)*p(0) + p(1)*p(1));
-    const double eps = 1e-8;
-    if (r_dist < eps) {
-      return Eigen::Matrix<double, 2, 3>::Zero();
-    }
-
-    Vec2 p_undist = removeDistortion(p);
+    // implicit function: addDistortion(removeDistortion(p)) = p
+    const Vec2 p_undist = removeDistortion(p);
+    return -getDerivativeAddDistoWrtPt(p_undist).inverse() * getDerivativeAddDistoWrtDisto(p_undist);
+  }
 
+  void addDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
     const double k1 = _distortionParams[0];
     const double k2 = _distortionParams[1];
     const double k3 = _distortionParams[2];
 
-    const double r = sqrt(p_undist(0) * p_undist(0) + p_undist(1) * p_undist(1));
-    const double r2 = r * r;
-    const double r4 = r2 * r2;
-    const double r6 = r4 * r2;
-    
-    const double r_coeff = 1.0 + k1 * r2 + k2 * r4 + k3 * r6;
-
-    Eigen::Matrix<double, 1, 3> d_rcoeff_d_params;
-    d_rcoeff_d_params(0, 0) = r2;
-    d_rcoeff_d_params(0, 1) = r4;
-    d_rcoeff_d_params(0, 2) = r6;
-    
-    Eigen::Matrix<double, 2, 3> ret;
-    ret(0, 0) = - (p(0) * d_rcoeff_d_params(0, 0)) / (r_coeff * r_coeff);
-    ret(0, 1) = - (p(0) * d_rcoeff_d_params(0, 1)) / (r_coeff * r_coeff);
-    ret(0, 2) = - (p(0) * d_rcoeff_d_params(0, 2)) / (r_coeff * r_coeff);
-    ret(1, 0) = - (p(1) * d_rcoeff_d_params(0, 0)) / (r_coeff * r_coeff);
-    ret(1, 1) = - (p(1) * d_rcoeff_d_params(0, 1)) / (r_coeff * r_coeff);
-    ret(1, 2) = - (p(1) * d_rcoeff_d_params(0, 2)) / (r_coeff * r_coeff);
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = p.colwise().squaredNorm().array();
+    out = p.array().rowwise() * (1. + r2 * (k1 + r2 * (k2 + r2 * k3)));
+  }
 
-    return ret;
+  void removeDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    radial_distortion::newton_Radius_Solve(*this, p, out);
   }
 
   double getUndistortedRadius(double r) const override
@@ -381,6 +444,16 @@ public:
     return r2 * Square(1.+r2*(k1+r2*(k2+r2*k3)));
   }
 
+  /// Distorted radius and its derivative from the undistorted radius r (scalar or Eigen array)
+  template <class T>
+  static void radiusFunctor(const std::vector<double> & params, const T& r, T& rd, T& derivative)
+  {
+    const double k1 = params[0], k2 = params[1], k3 = params[2];
+    const T r2 = r * r;
+    rd = r * (1. + r2 * (k1 + r2 * (k2 + r2 * k3)));
+    derivative = 1. + r2 * (3. * k1 + r2 * (5. * k2 + r2 * 7. * k3));
+  }
+
   ~DistortionRadialK3() override = default;
 };
 
@@ -504,50 +577,9 @@ public:
 
   Eigen::MatrixXd getDerivativeRemoveDistoWrtDisto(const Vec2 & p) const override
   {
-    
-    const double k1 = _distortionParams[0];
-    const double k2 = _distortionParams[1];
-    const double k3 = _distortionParams[2];
-
-    double r_dist = sqrt(p(0)*p(0) + p(1)*p(1));
-    const double eps = 1e-8;
-    if (r_dist < eps) {
-      return Eigen::Matrix<double, 2, 3>::Zero();
-    }
-
-    Vec2 p_undist = removeDistortion(p);
-    double r = sqrt(p_undist(0) * p_undist(0) + p_undist(1) * p_undist(1));
-
-    const double r2 = r * r;
-    const double r4 = r2 * r2;
-    const double r6 = r4 * r2;
-    
-    const double denum = (1.0 + k1 + k2 + k3);
-    const double num = (1.0 + k1*r2 + k2*r4 + k3*r6);
-    const double r_coeff = num / denum;
-
-    double denum2 = denum * denum;
-    Eigen::Matrix<double, 1, 3> d_num_d_params;
-    d_num_d_params(0, 0) = r2;
-    d_num_d_params(0, 1) = r4;
-    d_num_d_params(0, 2) = r6;
-
-    Eigen::Matrix<double, 1, 3> d_denum_d_params;
-    d_denum_d_params(0, 0) = 1;
-    d_denum_d_params(0, 1) = 1;
-    d_denum_d_params(0, 2) = 1;
-
-    Eigen::Matrix<double, 1, 3> d_rcoeff_d_params = (denum * d_num_d_params - num * d_denum_d_params) / denum2;
-    
-    Eigen::Matrix<double, 2, 3> ret;
-    ret(0, 0) = - (p(0) * d_rcoeff_d_params(0, 0)) / (r_coeff * r_coeff);
-    ret(0, 1) = - (p(0) * d_rcoeff_d_params(0, 1)) / (r_coeff * r_coeff);
-    ret(0, 2) = - (p(0) * d_rcoeff_d_params(0, 2)) / (r_coeff * r_coeff);
-    ret(1, 0) = - (p(1) * d_rcoeff_d_params(0, 0)) / (r_coeff * r_coeff);
-    ret(1, 1) = - (p(1) * d_rcoeff_d_params(0, 1)) / (r_coeff * r_coeff);
-    ret(1, 2) = - (p(1) * d_rcoeff_d_params(0, 2)) / (r_coeff * r_coeff);
-
-    return ret;
+    // implicit function: addDistortion(removeDistortion(p)) = p
+    const Vec2 p_undist = removeDistortion(p);
+    return -getDerivativeAddDistoWrtPt(p_undist).inverse() * getDerivativeAddDistoWrtDisto(p_undist);
   }
 
   /// Remove distortion (return p' such that disto(p') = p)
@@ -565,11 +597,37 @@ public:
     return p_undist;
   }
 
+  void addDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    const double k1 = _distortionParams[0];
+    const double k2 = _distortionParams[1];
+    const double k3 = _distortionParams[2];
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> r2 = p.colwise().squaredNorm().array();
+    out = p.array().rowwise() * ((1. + r2 * (k1 + r2 * (k2 + r2 * k3))) / (1.0 + k1 + k2 + k3));
+  }
+
+  void removeDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    radial_distortion::newton_Radius_Solve(*this, p, out);
+  }
+
   double getUndistortedRadius(double r) const override
   {
     return std::sqrt(radial_distortion::bisection_Radius_Solve(_distortionParams, r * r, distoFunctor));
   }
 
+  /// Distorted radius and its derivative from the undistorted radius r (scalar or Eigen array)
+  template <class T>
+  static void radiusFunctor(const std::vector<double> & params, const T& r, T& rd, T& derivative)
+  {
+    const double k1 = params[0], k2 = params[1], k3 = params[2];
+    const double denum = 1.0 + k1 + k2 + k3;
+    const T r2 = r * r;
+    rd = r * (1. + r2 * (k1 + r2 * (k2 + r2 * k3))) / denum;
+    derivative = (1. + r2 * (3. * k1 + r2 * (5. * k2 + r2 * 7. * k3))) / denum;
+  }
+
   /// Functor to solve Square(disto(radius(p'))) = r^2
   static double distoFunctor(const std::vector<double> & params, double r2)
   {
@@ -96,6 +96,40 @@ public:
     return pt_ima;
   }
 
+  void projectPoints(const geometry::Pose3& pose, const Mat3X& pts3D, Mat2X& out, bool applyDistortion = true) const override
+  {
+    const double rsensor = std::min(sensorWidth(), sensorHeight());
+    const double rscale = sensorWidth() / std::max(w(), h());
+    const double fmm = _scale(0) * rscale;
+    const double fov = rsensor / fmm;
+
+    const Mat3X X = pose(pts3D);
+    const auto atan2Op = [](double y, double x) { return std::atan2(y, x); };
+
+    // Compute angle with optical center
+    const Eigen::Array<double, 1, Eigen::Dynamic> angle_Z = X.topRows<2>().colwise().norm().array().binaryExpr(X.row(2).array(), atan2Op);
+
+    // Ignore depth component and compute radial angle
+    const Eigen::Array<double, 1, Eigen::Dynamic> angle_radial = X.row(1).array().binaryExpr(X.row(0).array(), atan2Op);
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> radius = angle_Z / (0.5 * fov);
+
+    Mat2X P(2, pts3D.cols());
+    P.row(0).array() = angle_radial.cos() * radius;
+    P.row(1).array() = angle_radial.sin() * radius;
+
+    if(applyDistortion)
+    {
+      Mat2X pt_disto;
+      this->addDistortionPoints(P, pt_disto);
+      this->cam2imaPoints(pt_disto, out);
+    }
+    else
+    {
+      this->cam2imaPoints(P, out);
+    }
+  }
+
   Eigen::Matrix<double, 2, 9> getDerivativeProjectWrtRotation(const geometry::Pose3& pose, const Vec4 & pt) 
   {
     Eigen::Matrix4d T = pose.getHomogeneous();
@@ -244,7 +278,7 @@ public:
     return getDerivativeCam2ImaWrtPoint() * getDerivativeAddDistoWrtPt(P) * d_P_d_angles * d_angles_d_X * d_X_d_pt;
   }
 
-  Eigen::Matrix<double, 2, 3> getDerivativeProjectWrtDisto(const geometry::Pose3& pose, const Vec4 & pt)
+  Eigen::Matrix<double, 2, Eigen::Dynamic> getDerivativeProjectWrtDisto(const geometry::Pose3& pose, const Vec4 & pt) const
   {
     Eigen::Matrix4d T = pose.getHomogeneous();
     const Vec4 X = T * pt; // apply pose
@@ -268,7 +302,7 @@ public:
     return getDerivativeCam2ImaWrtPoint() * getDerivativeAddDistoWrtDisto(P);
   }
 
-  Eigen::Matrix<double, 2, 2> getDerivativeProjectWrtScale(const geometry::Pose3& pose, const Vec4 & pt)
+  Eigen::Matrix<double, 2, 2> getDerivativeProjectWrtScale(const geometry::Pose3& pose, const Vec4 & pt) const
   {
     Eigen::Matrix4d T = pose.getHomogeneous();
     const Vec4 X = T * pt; // apply pose
@@ -303,13 +337,49 @@ public:
     return getDerivativeCam2ImaWrtPoint() * getDerivativeAddDistoWrtPt(P) * d_P_d_radius * d_radius_d_fov * d_fov_d_scale;
   }
 
-  Eigen::Matrix<double, 2, 2> getDerivativeProjectWrtPrincipalPoint(const geometry::Pose3& pose, const Vec4 & pt)
+  Eigen::Matrix<double, 2, 2> getDerivativeProjectWrtPrincipalPoint(const geometry::Pose3& pose, const Vec4 & pt) const
   {
     return getDerivativeCam2ImaWrtPrincipalPoint();
   }
 
   Eigen::Matrix<double, 2, Eigen::Dynamic> getDerivativeProjectWrtParams(const geometry::Pose3& pose, const Vec4& pt3D) const override {
-    return Eigen::Matrix<double, 2, Eigen::Dynamic>(2, 6);
+
+    Eigen::Matrix<double, 2, Eigen::Dynamic> ret(2, getParams().size());
+
+    ret.block<2, 2>(0, 0) = getDerivativeProjectWrtScale(pose, pt3D);
+    ret.block<2, 2>(0, 2) = getDerivativeProjectWrtPrincipalPoint(pose, pt3D);
+
+    if (hasDistortion()) {
+
+      size_t distortionSize = _pDistortion->getDistortionParametersCount();
+
+      ret.block(0, 4, 2, distortionSize) = getDerivativeProjectWrtDisto(pose, pt3D);
+    }
+
+    return ret;
+  }
+
+  Eigen::Matrix<double, 3, Eigen::Dynamic> getDerivativeBearingWrtParams(const Vec2& pt2D) const override {
+
+    const Vec2 ptCam = ima2cam(pt2D);
+    const Vec2 ptUndist = removeDistortion(ptCam);
+    const Eigen::Matrix<double, 3, 2> d_bearing_d_undist = getDerivativetoUnitSphereWrtPoint(ptUndist);
+    const Eigen::Matrix<double, 3, 2> d_bearing_d_cam = d_bearing_d_undist * getDerivativeRemoveDistoWrtPt(ptCam);
+
+    Eigen::Matrix<double, 3, Eigen::Dynamic> ret(3, getParams().size());
+
+    // the scale only changes the field of view
+    ret.block<3, 2>(0, 0) = getDerivativetoUnitSphereWrtScale(ptUndist);
+    ret.block<3, 2>(0, 2) = d_bearing_d_cam * getDerivativeIma2CamWrtPrincipalPoint();
+
+    if (hasDistortion()) {
+
+      size_t distortionSize = _pDistortion->getDistortionParametersCount();
+
+      ret.block(0, 4, 3, distortionSize) = d_bearing_d_undist * getDerivativeRemoveDistoWrtDisto(ptCam);
+    }
+
+    return ret;
   }
 
   Vec3 toUnitSphere(const Vec2 & pt) const override
@@ -329,7 +399,24 @@ public:
     return ret;
   }
 
-  Eigen::Matrix<double, 3, 2> getDerivativetoUnitSphereWrtPoint(const Vec2 & pt)
+  void toUnitSpherePoints(const Mat2X& pts, Mat3X& out) const override
+  {
+    const double rsensor = std::min(sensorWidth(), sensorHeight());
+    const double rscale = sensorWidth() / std::max(w(), h());
+    const double fmm = _scale(0) * rscale;
+    const double fov = rsensor / fmm;
+
+    const Eigen::Array<double, 1, Eigen::Dynamic> angle_radial = pts.row(1).array().binaryExpr(pts.row(0).array(), [](double y, double x) { return std::atan2(y, x); });
+    const Eigen::Array<double, 1, Eigen::Dynamic> angle_Z = pts.colwise().norm().array() * (0.5 * fov);
+    const Eigen::Array<double, 1, Eigen::Dynamic> sin_Z = angle_Z.sin();
+
+    out.resize(3, pts.cols());
+    out.row(0).array() = angle_radial.cos() * sin_Z;
+    out.row(1).array() = angle_radial.sin() * sin_Z;
+    out.row(2).array() = angle_Z.cos();
+  }
+
+  Eigen::Matrix<double, 3, 2> getDerivativetoUnitSphereWrtPoint(const Vec2 & pt) const
   {
     const double rsensor = std::min(sensorWidth(), sensorHeight());
     const double rscale = sensorWidth() / std::max(w(), h());
@@ -356,7 +443,7 @@ public:
     return d_ret_d_angles * d_angles_d_pt;
   }
 
-  Eigen::Matrix<double, 3, 2> getDerivativetoUnitSphereWrtScale(const Vec2 & pt)
+  Eigen::Matrix<double, 3, 2> getDerivativetoUnitSphereWrtScale(const Vec2 & pt) const
   {
     const double rsensor = std::min(sensorWidth(), sensorHeight());
     const double rscale = sensorWidth() / std::max(w(), h());
@@ -397,6 +484,11 @@ public:
     return _circleRadius * p  + getPrincipalPoint();
   }
 
+  void cam2imaPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    out = (_circleRadius * p).colwise() + getPrincipalPoint();
+  }
+
   Eigen::Matrix2d getDerivativeCam2ImaWrtPoint() const override
   {
     return Eigen::Matrix2d::Identity() * _circleRadius;
@@ -408,11 +500,28 @@ public:
     return (p - getPrincipalPoint()) / _circleRadius;
   }
 
+  void ima2camPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    out = (p.colwise() - getPrincipalPoint()) / _circleRadius;
+  }
+
   Eigen::Matrix2d getDerivativeIma2CamWrtPoint() const override
   {
     return Eigen::Matrix2d::Identity() * (1.0 / _circleRadius);
   }
 
+  /// the circle radius does not depend on the focal length
+  Eigen::Matrix2d getDerivativeCam2ImaWrtScale(const Vec2& p) const override
+  {
+    return Eigen::Matrix2d::Zero();
+  }
+
+  /// the circle radius does not depend on the focal length
+  Eigen::Matrix2d getDerivativeIma2CamWrtScale(const Vec2& p) const override
+  {
+    return Eigen::Matrix2d::Zero();
+  }
+
   Eigen::Matrix2d getDerivativeIma2CamWrtPrincipalPoint() const override
   {
     return Eigen::Matrix2d::Identity() * (-1.0 / _circleRadius);
@@ -157,6 +157,43 @@ public:
       return output;
   }
 
+  /**
+   * @brief Projection of a set of 3D points into the camera plane (Apply pose, disto (if any) and Intrinsics)
+   * @param[in] pose The pose
+   * @param[in] pts3D The 3d points (one per column)
+   * @param[out] out The 2d projections in the camera plane
+   * @param[in] applyDistortion If true apply distrortion if any
+   */
+  virtual void projectPoints(const geometry::Pose3& pose, const Mat3X& pts3D, Mat2X& out, bool applyDistortion = true) const
+  {
+    out.resize(2, pts3D.cols());
+    for(Eigen::Index i = 0; i < pts3D.cols(); ++i)
+      out.col(i) = project(pose, pts3D.col(i).homogeneous(), applyDistortion);
+  }
+
+  /**
+   * @brief Back-projection of a set of 2D points at a specific depth into 3D points
+   * @param[in] pts2D The 2d points (one per column)
+   * @param[out] out The 3d points
+   * @param[in] applyUndistortion If true remove distortion if any
+   * @param[in] pose The camera pose
+   * @param[in] depth The depth
+   */
+  void backprojectPoints(const Mat2X& pts2D, Mat3X& out, bool applyUndistortion = true, const geometry::Pose3& pose = geometry::Pose3(), double depth = 1.0) const
+  {
+    Mat2X pts2D_cam;
+    ima2camPoints(pts2D, pts2D_cam);
+    if(applyUndistortion)
+    {
+      Mat2X pts2D_undist;
+      removeDistortionPoints(pts2D_cam, pts2D_undist);
+      pts2D_cam.swap(pts2D_undist);
+    }
+
+    toUnitSpherePoints(pts2D_cam, out);
+    out = pose.inverse()(depth * out);
+  }
+
   Vec4 getCartesianfromSphericalCoordinates(const Vec3 & pt)
   {
     double u = pt(0);
@@ -210,6 +247,13 @@ public:
    */
   virtual Eigen::Matrix<double, 2, Eigen::Dynamic> getDerivativeProjectWrtParams(const geometry::Pose3& pose, const Vec4& pt3D) const = 0;
 
+  /**
+   * @brief get derivative of the bearing of an image point: toUnitSphere(removeDistortion(ima2cam(pt2D)))
+   * @param[in] pt2D The 2d point in the image plane
+   * @return The bearing jacobian wrt params
+   */
+  virtual Eigen::Matrix<double, 3, Eigen::Dynamic> getDerivativeBearingWrtParams(const Vec2& pt2D) const = 0;
+
    /**
    * @brief Compute the residual between the 3D projected point X and an image observation x
    * @param[in] pose The pose
@@ -233,13 +277,9 @@ public:
   inline Mat2X residuals(const geometry::Pose3& pose, const Mat3X& X, const Mat2X& x) const
   {
     assert(X.cols() == x.cols());
-    const std::size_t numPts = x.cols();
-    Mat2X residuals = Mat2X::Zero(2, numPts);
-    for(std::size_t i = 0; i < numPts; ++i)
-    {
-      residuals.col(i) = residual(pose, ((const Vec3&)X.col(i)).homogeneous(), x.col(i));
-    }
-    return residuals;
+    Mat2X proj;
+    projectPoints(pose, X, proj);
+    return x - proj;
   }
 
   /**
@@ -374,6 +414,30 @@ public:
    */
   virtual Vec2 ima2cam(const Vec2& p) const = 0;
 
+  /**
+   * @brief Transform a set of points from the camera plane to the image plane
+   * @param[in] p Points from the camera plane (one per column)
+   * @param[out] out Image plane points
+   */
+  virtual void cam2imaPoints(const Mat2X& p, Mat2X& out) const
+  {
+    out.resize(2, p.cols());
+    for(Eigen::Index i = 0; i < p.cols(); ++i)
+      out.col(i) = cam2ima(p.col(i));
+  }
+
+  /**
+   * @brief Transform a set of points from the image plane to the camera plane
+   * @param[in] p Points from the image plane (one per column)
+   * @param[out] out Camera plane points
+   */
+  virtual void ima2camPoints(const Mat2X& p, Mat2X& out) const
+  {
+    out.resize(2, p.cols());
+    for(Eigen::Index i = 0; i < p.cols(); ++i)
+      out.col(i) = ima2cam(p.col(i));
+  }
+
   /**
    * @brief Camera model handle a distortion field
    * @return True if the camera model handle a distortion field
@@ -411,6 +475,54 @@ public:
    */
   virtual Vec2 get_d_pixel(const Vec2& p) const = 0;
 
+  /**
+   * @brief Add the distortion field to a set of points (that are in normalized camera frame)
+   * @param[in] p The points (one per column)
+   * @param[out] out The points with added distortion field
+   */
+  virtual void addDistortionPoints(const Mat2X& p, Mat2X& out) const
+  {
+    out.resize(2, p.cols());
+    for(Eigen::Index i = 0; i < p.cols(); ++i)
+      out.col(i) = addDistortion(p.col(i));
+  }
+
+  /**
+   * @brief Remove the distortion to a set of camera points (that are in normalized camera frame)
+   * @param[in] p The points (one per column)
+   * @param[out] out The points with removed distortion field
+   */
+  virtual void removeDistortionPoints(const Mat2X& p, Mat2X& out) const
+  {
+    out.resize(2, p.cols());
+    for(Eigen::Index i = 0; i < p.cols(); ++i)
+      out.col(i) = removeDistortion(p.col(i));
+  }
+
+  /**
+   * @brief Return the undistorted pixels (with removed distortion) of a set of points
+   * @param[in] p The points (one per column)
+   * @param[out] out The undistorted pixels
+   */
+  virtual void get_ud_pixels(const Mat2X& p, Mat2X& out) const
+  {
+    out.resize(2, p.cols());
+    for(Eigen::Index i = 0; i < p.cols(); ++i)
+      out.col(i) = get_ud_pixel(p.col(i));
+  }
+
+  /**
+   * @brief Return the distorted pixels (with added distortion) of a set of points
+   * @param[in] p The undistorted points (one per column)
+   * @param[out] out The distorted pixels
+   */
+  virtual void get_d_pixels(const Mat2X& p, Mat2X& out) const
+  {
+    out.resize(2, p.cols());
+    for(Eigen::Index i = 0; i < p.cols(); ++i)
+      out.col(i) = get_d_pixel(p.col(i));
+  }
+
   /**
    * @brief Normalize a given unit pixel error to the camera plane
    * @param[in] value Given unit pixel error
@@ -500,6 +612,18 @@ public:
    */
   virtual Vec3 toUnitSphere(const Vec2 & pt) const = 0;
 
+  /**
+   * @brief transform a set of points to unit sphere in meters
+   * @param pts the input points (one per column)
+   * @param out points on the unit sphere
+   */
+  virtual void toUnitSpherePoints(const Mat2X& pts, Mat3X& out) const
+  {
+    out.resize(3, pts.cols());
+    for(Eigen::Index i = 0; i < pts.cols(); ++i)
+      out.col(i) = toUnitSphere(pts.col(i));
+  }
+
 protected:
 
   /// initialization mode
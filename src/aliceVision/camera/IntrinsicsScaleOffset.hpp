@@ -118,6 +118,16 @@ public:
     return np;
   }
 
+  void cam2imaPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    out = (_scale.asDiagonal() * p).colwise() + getPrincipalPoint();
+  }
+
+  void ima2camPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    out = ((p.colwise() - getPrincipalPoint()).array().colwise() / _scale.array()).matrix();
+  }
+
   virtual Eigen::Matrix<double, 2, 2> getDerivativeIma2CamWrtScale(const Vec2& p) const
   {
       Eigen::Matrix2d M = Eigen::Matrix2d::Zero();
@@ -27,6 +27,24 @@ public:
   , _pDistortion(distortion)
   {}
 
+  /// copies own their distortion, updating the parameters of a copy does not affect the original
+  IntrinsicsScaleOffsetDisto(const IntrinsicsScaleOffsetDisto& other)
+  : IntrinsicsScaleOffset(other)
+  {
+    if(other._pDistortion != nullptr)
+      _pDistortion.reset(other._pDistortion->clone());
+  }
+
+  IntrinsicsScaleOffsetDisto& operator=(const IntrinsicsScaleOffsetDisto& other)
+  {
+    if(this == &other)
+      return *this;
+
+    IntrinsicsScaleOffset::operator=(other);
+    _pDistortion.reset(other._pDistortion != nullptr ? other._pDistortion->clone() : nullptr);
+    return *this;
+  }
+
   void assign(const IntrinsicBase& other) override
   {
     *this = dynamic_cast<const IntrinsicsScaleOffsetDisto&>(other);
@@ -81,6 +99,42 @@ public:
     return cam2ima(addDistortion(ima2cam(p)));
   }
 
+  void addDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    if (_pDistortion == nullptr)
+    {
+      out = p;
+      return;
+    }
+    _pDistortion->addDistortionPoints(p, out);
+  }
+
+  void removeDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    if (_pDistortion == nullptr)
+    {
+      out = p;
+      return;
+    }
+    _pDistortion->removeDistortionPoints(p, out);
+  }
+
+  void get_ud_pixels(const Mat2X& p, Mat2X& out) const override
+  {
+    Mat2X cam, undist;
+    ima2camPoints(p, cam);
+    removeDistortionPoints(cam, undist);
+    cam2imaPoints(undist, out);
+  }
+
+  void get_d_pixels(const Mat2X& p, Mat2X& out) const override
+  {
+    Mat2X cam, dist;
+    ima2camPoints(p, cam);
+    addDistortionPoints(cam, dist);
+    cam2imaPoints(dist, out);
+  }
+
   std::vector<double> getDistortionParams() const
   {
     if (!hasDistortion()) {
@@ -109,6 +109,16 @@ public:
     return impt;
   }
 
+  void projectPoints(const geometry::Pose3& pose, const Mat3X& pts3D, Mat2X& out, bool applyDistortion = true) const override
+  {
+    const Mat3X X = pose(pts3D); // apply pose
+    const Mat2X P = X.topRows<2>().array().rowwise() / X.row(2).array();
+
+    Mat2X distorted;
+    this->addDistortionPoints(P, distorted);
+    this->cam2imaPoints(distorted, out);
+  }
+
   Eigen::Matrix<double, 2, 9> getDerivativeProjectWrtRotation(const geometry::Pose3& pose, const Vec4 & pt)
   {
     const Vec4 X = pose.getHomogeneous() * pt; // apply pose
@@ -212,12 +222,39 @@ public:
     return ret;
   }
 
+  Eigen::Matrix<double, 3, Eigen::Dynamic> getDerivativeBearingWrtParams(const Vec2& pt2D) const override {
+
+    const Vec2 ptCam = ima2cam(pt2D);
+    const Vec2 ptUndist = removeDistortion(ptCam);
+    const Eigen::Matrix<double, 3, 2> d_bearing_d_undist = getDerivativetoUnitSphereWrtPoint(ptUndist);
+    const Eigen::Matrix<double, 3, 2> d_bearing_d_cam = d_bearing_d_undist * getDerivativeRemoveDistoWrtPt(ptCam);
+
+    Eigen::Matrix<double, 3, Eigen::Dynamic> ret(3, getParams().size());
+
+    ret.block<3, 2>(0, 0) = d_bearing_d_cam * getDerivativeIma2CamWrtScale(pt2D);
+    ret.block<3, 2>(0, 2) = d_bearing_d_cam * getDerivativeIma2CamWrtPrincipalPoint();
+
+    if (hasDistortion()) {
+
+      size_t distortionSize = _pDistortion->getDistortionParametersCount();
+
+      ret.block(0, 4, 3, distortionSize) = d_bearing_d_undist * getDerivativeRemoveDistoWrtDisto(ptCam);
+    }
+
+    return ret;
+  }
+
   Vec3 toUnitSphere(const Vec2 & pt) const override
   {
     return pt.homogeneous().normalized();
   }
 
-  Eigen::Matrix<double, 3, 2> getDerivativetoUnitSphereWrtPoint(const Vec2 & pt)
+  void toUnitSpherePoints(const Mat2X& pts, Mat3X& out) const override
+  {
+    out = pts.colwise().homogeneous().colwise().normalized();
+  }
+
+  Eigen::Matrix<double, 3, 2> getDerivativetoUnitSphereWrtPoint(const Vec2 & pt) const
   {
     double norm2 = pt(0)*pt(0) + pt(1)*pt(1) + 1.0;
     double norm = sqrt(norm2);
@@ -67,16 +67,22 @@ void UndistortImage(
     
     #pragma omp parallel for
     for(int j = 0; j < heightRoi; ++j)
+    {
+        // compute coordinates with distortion for the whole row at once
+        Mat2X undisto_pix(2, widthRoi);
+        undisto_pix.row(0).setLinSpaced(widthRoi, xOffset + ppCorrection(0), xOffset + ppCorrection(0) + widthRoi - 1);
+        undisto_pix.row(1).setConstant(j + yOffset + ppCorrection(1));
+
+        Mat2X disto_pix;
+        intrinsicPtr->get_d_pixels(undisto_pix, disto_pix);
+
         for(int i = 0; i < widthRoi; ++i)
-        {       
-            const Vec2 undisto_pix(i + xOffset, j + yOffset); 
-            // compute coordinates with distortion
-            const Vec2 disto_pix = intrinsicPtr->get_d_pixel(undisto_pix + ppCorrection);
-           
+        {
             // pick pixel if it is in the image domain
-            if(imageIn.Contains(disto_pix(1), disto_pix(0)))
-                image_ud(j, i) = sampler(imageIn, disto_pix(1), disto_pix(0));
+            if(imageIn.Contains(disto_pix(1, i), disto_pix(0, i)))
+                image_ud(j, i) = sampler(imageIn, disto_pix(1, i), disto_pix(0, i));
         }
+    }
   }
 }
 
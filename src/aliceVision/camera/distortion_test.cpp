@@ -5,6 +5,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/camera/Distortion.hpp>
+#include <aliceVision/camera/Distortion3DE.hpp>
 #include <aliceVision/camera/DistortionBrown.hpp>
 #include <aliceVision/camera/DistortionFisheye.hpp>
 #include <aliceVision/camera/DistortionFisheye1.hpp>
@@ -51,3 +52,108 @@ BOOST_AUTO_TEST_CASE(distortion_distort_undistort)
         }
     }
 }
+
+//-----------------
+BOOST_AUTO_TEST_CASE(distortion_batch_points)
+{
+    makeRandomOperationsReproducible();
+
+    std::array<std::unique_ptr<Distortion>, 6> distortionsModels;
+    distortionsModels[0].reset(new DistortionBrown(-0.25349, 0.11868, -0.00028, 0.00005, 0.0000001));
+    distortionsModels[1].reset(new DistortionFisheye(0.02, -0.03, 0.1, -0.2));
+    distortionsModels[2].reset(new DistortionFisheye1(0.02));
+    distortionsModels[3].reset(new DistortionRadialK1(0.02));
+    distortionsModels[4].reset(new DistortionRadialK3(-1.8061369278146561e-01, 1.8759742680633607e-01, -2.5341468279930644e-02));
+    distortionsModels[5].reset(new DistortionRadialK3PT(-1.8061369278146561e-01, 1.8759742680633607e-01, -2.5341468279930644e-02));
+
+    const double epsilon = 1e-6;
+
+    // a small set (no lookup table) and a large one (lookup table seeding)
+    for(const int numPts : {10, 1000})
+    {
+        // random points in [-lim, lim]x[-lim, lim]
+        const double lim{0.8};
+        const Mat2X ptsImage = lim * Mat2X::Random(2, numPts);
+
+        for(const auto& model : distortionsModels)
+        {
+            Mat2X distorted, undistorted;
+            model->addDistortionPoints(ptsImage, distorted);
+            model->removeDistortionPoints(distorted, undistorted);
+
+            BOOST_CHECK_EQUAL(distorted.cols(), numPts);
+            BOOST_CHECK_EQUAL(undistorted.cols(), numPts);
+
+            for(int i = 0; i < numPts; ++i)
+            {
+                EXPECT_MATRIX_NEAR(model->addDistortion(ptsImage.col(i)), distorted.col(i), epsilon);
+                EXPECT_MATRIX_NEAR(model->removeDistortion(distorted.col(i)), undistorted.col(i), epsilon);
+                EXPECT_MATRIX_NEAR(ptsImage.col(i), undistorted.col(i), epsilon);
+            }
+        }
+    }
+}
+
+//-----------------
+BOOST_AUTO_TEST_CASE(distortion_derivatives)
+{
+    makeRandomOperationsReproducible();
+
+    std::array<std::unique_ptr<Distortion>, 9> distortionsModels;
+    distortionsModels[0].reset(new DistortionBrown(-0.25349, 0.11868, -0.00028, 0.00005, 0.0000001));
+    distortionsModels[1].reset(new DistortionFisheye(0.02, -0.03, 0.1, -0.2));
+    distortionsModels[2].reset(new DistortionFisheye1(0.02));
+    distortionsModels[3].reset(new DistortionRadialK1(0.02));
+    distortionsModels[4].reset(new DistortionRadialK3(-1.8061369278146561e-01, 1.8759742680633607e-01, -2.5341468279930644e-02));
+    distortionsModels[5].reset(new DistortionRadialK3PT(-1.8061369278146561e-01, 1.8759742680633607e-01, -2.5341468279930644e-02));
+    distortionsModels[6].reset(new Distortion3DERadial4(-0.02, 0.01, 0.005, -0.003, 0.002, 0.001));
+    distortionsModels[7].reset(new Distortion3DEAnamorphic4(-0.03, 0.02, 0.01, -0.04));
+    distortionsModels[8].reset(new Distortion3DEClassicLD(-0.02, 1.05, 0.01, -0.01, 0.003));
+
+    const double delta = 1e-6;
+    const double epsilon = 1e-4;
+    const std::size_t numPts{100};
+    for(std::size_t i = 0; i < numPts; ++i)
+    {
+        // random point in [-lim, lim]x[-lim, lim]
+        const double lim{0.6};
+        const Vec2 pt = lim*Vec2::Random();
+
+        for(const auto& model : distortionsModels)
+        {
+            // central finite differences wrt the point
+            Eigen::Matrix2d addWrtPt;
+            for(int j = 0; j < 2; ++j)
+            {
+                const Vec2 d = delta * Vec2::Unit(j);
+                addWrtPt.col(j) = (model->addDistortion(pt + d) - model->addDistortion(pt - d)) / (2.0 * delta);
+            }
+            EXPECT_MATRIX_NEAR(addWrtPt, model->getDerivativeAddDistoWrtPt(pt), epsilon);
+
+            // removeDistortion is the inverse of addDistortion
+            const Eigen::Matrix2d identity = model->getDerivativeRemoveDistoWrtPt(model->addDistortion(pt)) * model->getDerivativeAddDistoWrtPt(pt);
+            EXPECT_MATRIX_NEAR(Eigen::Matrix2d::Identity(), identity, epsilon);
+
+            // central finite differences wrt the distortion parameters
+            std::vector<double>& params = model->getParameters();
+            Eigen::MatrixXd addWrtDisto(2, params.size());
+            for(std::size_t j = 0; j < params.size(); ++j)
+            {
+                const double value = params[j];
+                params[j] = value + delta;
+                const Vec2 addPlus = model->addDistortion(pt);
+                params[j] = value - delta;
+                const Vec2 addMinus = model->addDistortion(pt);
+                params[j] = value;
+
+                addWrtDisto.col(j) = (addPlus - addMinus) / (2.0 * delta);
+            }
+            EXPECT_MATRIX_NEAR(addWrtDisto, model->getDerivativeAddDistoWrtDisto(pt), epsilon);
+
+            // implicit function: addDistortion(removeDistortion(p)) = p
+            const Vec2 distorted = model->addDistortion(pt);
+            const Eigen::MatrixXd removeWrtDisto = -model->getDerivativeRemoveDistoWrtPt(distorted) * addWrtDisto;
+            EXPECT_MATRIX_NEAR(removeWrtDisto, model->getDerivativeRemoveDistoWrtDisto(distorted), epsilon);
+        }
+    }
+}
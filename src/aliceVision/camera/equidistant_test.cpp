@@ -64,5 +64,87 @@ BOOST_AUTO_TEST_CASE(cameraEquidistant_disto_undisto_Radial)
   }
 }
 
+//-----------------
+// Test summary:
+//-----------------
+// - Generate random points inside the image domain
+// - Check that the batch back-projection / projection match the per point ones
+//-----------------
+BOOST_AUTO_TEST_CASE(cameraEquidistant_batch_project_backproject)
+{
+  makeRandomOperationsReproducible();
+
+  const EquiDistantRadialK3 cam(1000, 800, 800.0, 0.0, 0.0, 0.0, 0.3, 0.2, 0.1);
+
+  const double epsilon = 1e-4;
+  const int numPts = 500;
 
+  // generate random points inside the image domain
+  const Mat2X ptsImage_gt = (Mat2X::Random(2, numPts) * 700./2.).colwise() + Vec2(500, 400);
+  const double depth_gt = 10.0;
+  const geometry::Pose3 pose(geometry::randomPose());
 
+  Mat3X pts3d;
+  cam.backprojectPoints(ptsImage_gt, pts3d, true, pose, depth_gt);
+  Mat2X pts2d_proj;
+  cam.projectPoints(pose, pts3d, pts2d_proj, true);
+
+  Mat2X ptsUndist, ptsDist;
+  cam.get_ud_pixels(ptsImage_gt, ptsUndist);
+  cam.get_d_pixels(ptsUndist, ptsDist);
+
+  for(int i = 0; i < numPts; ++i)
+  {
+    const Vec2 ptImage_gt = ptsImage_gt.col(i);
+    EXPECT_MATRIX_NEAR(cam.backproject(ptImage_gt, true, pose, depth_gt), pts3d.col(i), epsilon);
+    EXPECT_MATRIX_NEAR(cam.project(pose, pts3d.col(i).homogeneous(), true), pts2d_proj.col(i), epsilon);
+    EXPECT_MATRIX_NEAR(ptImage_gt, pts2d_proj.col(i), epsilon);
+    EXPECT_MATRIX_NEAR(cam.get_ud_pixel(ptImage_gt), ptsUndist.col(i), epsilon);
+    EXPECT_MATRIX_NEAR(ptImage_gt, ptsDist.col(i), epsilon);
+  }
+
+  BOOST_CHECK_SMALL(cam.residuals(pose, pts3d, ptsImage_gt).cwiseAbs().maxCoeff(), epsilon);
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Compare the analytic derivatives of the projection and of the bearing
+//   wrt the intrinsic parameters with central finite differences
+//-----------------
+BOOST_AUTO_TEST_CASE(cameraEquidistant_derivatives_params)
+{
+  makeRandomOperationsReproducible();
+
+  const EquiDistantRadialK3 cam(1000, 800, 800.0, 0.0, 0.0, 0.0, 0.3, 0.2, 0.1);
+
+  const double delta = 1e-6;
+  const double epsilon = 1e-3;
+  const std::vector<double> params = cam.getParams();
+
+  for (int i = 0; i < 10; ++i)
+  {
+    const Vec2 ptImage = (Vec2::Random() * 700./2.) + Vec2(500, 400);
+    const geometry::Pose3 pose(geometry::randomPose());
+    const Vec3 pt3d = cam.backproject(ptImage, true, pose, 10.0);
+
+    Eigen::Matrix<double, 2, Eigen::Dynamic> dProjectWrtParams(2, params.size());
+    Eigen::Matrix<double, 3, Eigen::Dynamic> dBearingWrtParams(3, params.size());
+    for (std::size_t j = 0; j < params.size(); ++j)
+    {
+      std::vector<double> paramsPlus = params, paramsMinus = params;
+      paramsPlus[j] += delta;
+      paramsMinus[j] -= delta;
+
+      EquiDistantRadialK3 camPlus(cam), camMinus(cam);
+      camPlus.updateFromParams(paramsPlus);
+      camMinus.updateFromParams(paramsMinus);
+
+      dProjectWrtParams.col(j) = (camPlus.project(pose, pt3d.homogeneous(), true) - camMinus.project(pose, pt3d.homogeneous(), true)) / (2.0 * delta);
+      dBearingWrtParams.col(j) = (camPlus.toUnitSphere(camPlus.removeDistortion(camPlus.ima2cam(ptImage))) -
+                                  camMinus.toUnitSphere(camMinus.removeDistortion(camMinus.ima2cam(ptImage)))) / (2.0 * delta);
+    }
+    EXPECT_MATRIX_NEAR(dProjectWrtParams, cam.getDerivativeProjectWrtParams(pose, pt3d.homogeneous()), epsilon);
+    EXPECT_MATRIX_NEAR(dBearingWrtParams, cam.getDerivativeBearingWrtParams(ptImage), epsilon);
+  }
+}
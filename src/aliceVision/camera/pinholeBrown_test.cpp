@@ -56,3 +56,52 @@ BOOST_AUTO_TEST_CASE(cameraPinholeBrown_disto_undisto_T2)
     EXPECT_MATRIX_NEAR(ptImage_gt, pt2d_proj, epsilon);
   }
 }
+
+//-----------------
+// Test summary:
+//-----------------
+// - Create a PinholeBrownT2
+// - Compare the analytic derivatives of the projection and of the bearing
+//   wrt the intrinsic parameters with central finite differences
+//-----------------
+BOOST_AUTO_TEST_CASE(cameraPinholeBrown_derivatives_params_T2)
+{
+  makeRandomOperationsReproducible();
+
+  const PinholeBrownT2 cam(1000, 1000, 1000, 1000, 0, 0,
+  // K1, K2, K3, T1, T2
+  -0.054, 0.014, 0.006, 0.001, -0.001);
+
+  const double delta = 1e-6;
+  const double epsilon = 1e-3;
+  const std::vector<double> params = cam.getParams();
+
+  for (int i = 0; i < 10; ++i)
+  {
+    const Vec2 ptImage = (Vec2::Random() * 800./2.) + Vec2(500,500);
+    const geometry::Pose3 pose(geometry::randomPose());
+    const Vec3 pt3d = cam.backproject(ptImage, true, pose, 10.0);
+
+    Eigen::Matrix<double, 2, Eigen::Dynamic> dProjectWrtParams(2, params.size());
+    Eigen::Matrix<double, 3, Eigen::Dynamic> dBearingWrtParams(3, params.size());
+    for (std::size_t j = 0; j < params.size(); ++j)
+    {
+      std::vector<double> paramsPlus = params, paramsMinus = params;
+      paramsPlus[j] += delta;
+      paramsMinus[j] -= delta;
+
+      PinholeBrownT2 camPlus(cam), camMinus(cam);
+      camPlus.updateFromParams(paramsPlus);
+      camMinus.updateFromParams(paramsMinus);
+
+      dProjectWrtParams.col(j) = (camPlus.project(pose, pt3d.homogeneous(), true) - camMinus.project(pose, pt3d.homogeneous(), true)) / (2.0 * delta);
+      dBearingWrtParams.col(j) = (camPlus.toUnitSphere(camPlus.removeDistortion(camPlus.ima2cam(ptImage))) -
+                                  camMinus.toUnitSphere(camMinus.removeDistortion(camMinus.ima2cam(ptImage)))) / (2.0 * delta);
+    }
+    EXPECT_MATRIX_NEAR(dProjectWrtParams, cam.getDerivativeProjectWrtParams(pose, pt3d.homogeneous()), epsilon);
+    EXPECT_MATRIX_NEAR(dBearingWrtParams, cam.getDerivativeBearingWrtParams(ptImage), epsilon);
+
+    // the copies own their distortion
+    BOOST_CHECK(cam.getParams() == params);
+  }
+}
@@ -102,3 +102,47 @@ BOOST_AUTO_TEST_CASE(cameraPinholeRadial_disto_undisto_K3)
 
   }
 }
+
+//-----------------
+// Test summary:
+//-----------------
+// - Generate random points inside the image domain
+// - Check that the batch back-projection / projection match the per point ones
+//-----------------
+BOOST_AUTO_TEST_CASE(cameraPinholeRadial_batch_project_backproject)
+{
+  makeRandomOperationsReproducible();
+
+  const PinholeRadialK3 cam(1000, 1000, 1000, 1000, 0, 0,
+    // K3
+    -0.245539, 0.255195, 0.163773);
+
+  const double epsilon = 1e-4;
+  const int numPts = 500;
+
+  // generate random points inside the image domain
+  const Mat2X ptsImage_gt = (Mat2X::Random(2, numPts) * 700./2.).colwise() + Vec2(500, 400);
+  const double depth_gt = 10.0;
+  const geometry::Pose3 pose(geometry::randomPose());
+
+  Mat3X pts3d;
+  cam.backprojectPoints(ptsImage_gt, pts3d, true, pose, depth_gt);
+  Mat2X pts2d_proj;
+  cam.projectPoints(pose, pts3d, pts2d_proj, true);
+
+  Mat2X ptsUndist, ptsDist;
+  cam.get_ud_pixels(ptsImage_gt, ptsUndist);
+  cam.get_d_pixels(ptsUndist, ptsDist);
+
+  for(int i = 0; i < numPts; ++i)
+  {
+    const Vec2 ptImage_gt = ptsImage_gt.col(i);
+    EXPECT_MATRIX_NEAR(cam.backproject(ptImage_gt, true, pose, depth_gt), pts3d.col(i), epsilon);
+    EXPECT_MATRIX_NEAR(cam.project(pose, pts3d.col(i).homogeneous(), true), pts2d_proj.col(i), epsilon);
+    EXPECT_MATRIX_NEAR(ptImage_gt, pts2d_proj.col(i), epsilon);
+    EXPECT_MATRIX_NEAR(cam.get_ud_pixel(ptImage_gt), ptsUndist.col(i), epsilon);
+    EXPECT_MATRIX_NEAR(ptImage_gt, ptsDist.col(i), epsilon);
+  }
+
+  BOOST_CHECK_SMALL(cam.residuals(pose, pts3d, ptsImage_gt).cwiseAbs().maxCoeff(), epsilon);
+}
@@ -15,6 +15,7 @@
 
 #include <string>
 #include <cstddef>
+#include <cstring>
 #include <typeinfo>
 #include <memory>
 
@@ -117,6 +118,16 @@ public:
    */
   virtual const void * DescriptorRawData() const = 0;
 
+  /// Return the size in bytes of one descriptor
+  virtual std::size_t DescriptorByteSize() const = 0;
+
+  /**
+   * @brief Replace the descriptors by a copy of a flat array of descriptors.
+   * @param[in] rawData the descriptors, DescriptorByteSize() bytes each
+   * @param[in] count the number of descriptors
+   */
+  virtual void assignDescriptors(const void* rawData, std::size_t count) = 0;
+
   virtual void clearDescriptors() = 0;
 
   /// Return the squared distance between two descriptors
@@ -218,6 +229,16 @@ public:
 
   inline const void* DescriptorRawData() const override { return &_vec_descs[0];}
 
+  inline std::size_t DescriptorByteSize() const override { return sizeof(DescriptorT); }
+
+  void assignDescriptors(const void* rawData, std::size_t count) override
+  {
+    static_assert(sizeof(DescriptorT) == L * sizeof(T), "Descriptors must be stored as a flat array.");
+    _vec_descs.resize(count);
+    if(count > 0)
+      std::memcpy(&_vec_descs[0], rawData, count * sizeof(DescriptorT));
+  }
+
   inline void clearDescriptors() override { _vec_descs.clear(); }
 
   inline void swap(This& other)
@@ -50,6 +50,7 @@ inline float sigma(const float sigma0 , const int p , const int q , const int Q)
  * @param[in] nbSlice Slices per octave
  * @param[in] sigma0 First octave initial scale
  * @param[in] contrastFactor
+ * @param[in,out] buffers Temporary images of the octave
  * @param Li Diffusion image
  * @param Lx X derivatives
  * @param Ly Y derivatives
@@ -61,6 +62,7 @@ void computeAKAZESlice(const image::Image<float>& src,
                        const int nbSlice,
                        const float sigma0,
                        const float contrastFactor,
+                       AKAZE::TOctaveBuffers& buffers,
                        image::Image<float>& Li,
                        image::Image<float>& Lx,
                        image::Image<float>& Ly,
@@ -70,7 +72,7 @@ void computeAKAZESlice(const image::Image<float>& src,
   const float ratio = 1 << p; //pow(2,p);
   const int sigmaScale = MathTrait<float>::round(sigmaCur * derivativeFactor / ratio);
 
-  image::Image<float> smoothed;
+  image::Image<float>& smoothed = buffers.smoothed;
 
   if(p == 0 && q == 0)
   {
@@ -80,7 +82,7 @@ void computeAKAZESlice(const image::Image<float>& src,
   else
   {
     // general case
-    image::Image<float> in;
+    image::Image<float>& in = buffers.diffused;
     if( q == 0 )
     {
       image::ImageHalfSample(src , in);
@@ -109,8 +111,11 @@ void computeAKAZESlice(const image::Image<float>& src,
     // compute FED cycles
     std::vector<float> tau ;
     image::FEDCycleTimings(total_cycle_time, 0.25f, tau);
-    image::ImageFEDCycle(in, diff, tau);
-    Li = in ; // evolution image
+    image::ImageFEDCycle(in, diff, tau, buffers.fedStep);
+
+    // evolution image
+    // note: buffers are swapped (same size), so memory stays allocated for the next slice
+    Li.swap(in);
   }
 
   // compute Hessian response
@@ -129,7 +134,9 @@ void computeAKAZESlice(const image::Image<float>& src,
   image::ImageScaledScharrYDerivative(smoothed, Ly, sigmaScale);
 
   // second order spatial derivatives
-  image::Image<float> Lxx, Lyy, Lxy;
+  image::Image<float>& Lxx = buffers.Lxx;
+  image::Image<float>& Lyy = buffers.Lyy;
+  image::Image<float>& Lxy = buffers.Lxy;
   image::ImageScaledScharrXDerivative(Lx, Lxx, sigmaScale);
   image::ImageScaledScharrYDerivative(Lx, Lxy, sigmaScale);
   image::ImageScaledScharrYDerivative(Ly, Lyy, sigmaScale);
@@ -138,7 +145,8 @@ void computeAKAZESlice(const image::Image<float>& src,
   Ly *= static_cast<float>(sigmaScale);
 
   // compute Determinant of the Hessian
-  Lhess.resize(Li.Width(), Li.Height());
+  if(Lhess.Width() != Li.Width() || Lhess.Height() != Li.Height())
+    Lhess.resize(Li.Width(), Li.Height(), false);
   const float sigmaSizeQuad = Square(sigmaScale) * Square(sigmaScale);
   Lhess.array() = (Lxx.array() * Lyy.array() - Lxy.array().square()) * sigmaSizeQuad;
 }
@@ -153,21 +161,44 @@ void convertScale(Image& src)
 }
 #endif // DEBUG_OCTAVE
 
-AKAZE::AKAZE(const image::Image<float>& image, const AKAZEOptions& options):
-    _input(image),
-    _options(options)
+AKAZE::AKAZE(const image::Image<float>& image, const AKAZEOptions& options)
+  : _options(options)
+  , _ownedScaleSpace(new TScaleSpace)
+  , _scaleSpace(*_ownedScaleSpace)
+{
+  _scaleSpace.input = image;
+  _options.descFactor = std::max(6.f * sqrtf(2.f), _options.descFactor);
+
+  // safety check to limit the computable octave count
+  const int nbOctaveMax = ceil(std::log2( std::min(image.Width(), image.Height())));
+  _options.nbOctaves = std::min(_options.nbOctaves, nbOctaveMax);
+}
+
+AKAZE::AKAZE(const image::Image<float>& image, const AKAZEOptions& options, TScaleSpace& scaleSpace)
+  : _options(options)
+  , _scaleSpace(scaleSpace)
 {
+  // copy in the existing buffer (no allocation if the size is unchanged)
+  _scaleSpace.input = image;
   _options.descFactor = std::max(6.f * sqrtf(2.f), _options.descFactor);
 
   // safety check to limit the computable octave count
-  const int nbOctaveMax = ceil(std::log2( std::min(_input.Width(), _input.Height())));
+  const int nbOctaveMax = ceil(std::log2( std::min(image.Width(), image.Height())));
   _options.nbOctaves = std::min(_options.nbOctaves, nbOctaveMax);
 }
 
 void AKAZE::computeScaleSpace()
 {
-  float contrastFactor = computeAutomaticContrastFactor( _input, 0.7f);
-  image::Image<float> input = _input;
+  const image::Image<float>& input = _scaleSpace.input;
+
+  // keep the existing images, they are resized only if the image size changed
+  _scaleSpace.evolution.resize(_options.nbOctaves * _options.nbSlicePerOctave);
+  _scaleSpace.octaveBuffers.resize(_options.nbOctaves);
+
+  // first octave buffers are used as temporary images
+  TOctaveBuffers& firstOctaveBuffers = _scaleSpace.octaveBuffers.front();
+  float contrastFactor = computeAutomaticContrastFactor(input, 0.7f, firstOctaveBuffers.smoothed,
+                                                        firstOctaveBuffers.Lxx, firstOctaveBuffers.Lyy);
 
   // octave computation
   for(int p = 0; p < _options.nbOctaves; ++p)
@@ -176,15 +207,15 @@ void AKAZE::computeScaleSpace()
 
     for(int q = 0; q < _options.nbSlicePerOctave; ++q)
     {
-      _evolution.emplace_back(TEvolution());
-      TEvolution& evo = _evolution.back();
+      const int sliceIndex = p * _options.nbSlicePerOctave + q;
+      TEvolution& evo = _scaleSpace.evolution.at(sliceIndex);
 
-      // compute Slice at (p,q) index
-      computeAKAZESlice(input, p, q, _options.nbSlicePerOctave, _options.sigma0, contrastFactor,
-        evo.cur, evo.Lx, evo.Ly, evo.Lhess);
+      // the input of a slice is the previous slice
+      const image::Image<float>& sliceInput = (sliceIndex == 0) ? input : _scaleSpace.evolution.at(sliceIndex - 1).cur;
 
-      // Prepare inputs for next slice
-      input = evo.cur;
+      // compute Slice at (p,q) index
+      computeAKAZESlice(sliceInput, p, q, _options.nbSlicePerOctave, _options.sigma0, contrastFactor,
+        _scaleSpace.octaveBuffers.at(p), evo.cur, evo.Lx, evo.Ly, evo.Lhess);
 
       // DEBUG octave image
 #if DEBUG_OCTAVE
@@ -236,7 +267,7 @@ void AKAZE::featureDetection(std::vector<AKAZEKeypoint>& keypoints) const
     for(int q = 0 ; q < _options.nbSlicePerOctave ; ++q)
     {
       const float sigma_cur = sigma( _options.sigma0 , p , q , _options.nbSlicePerOctave );
-      const image::Image<float>& LDetHess = _evolution[_options.nbOctaves * p + q].Lhess;
+      const image::Image<float>& LDetHess = _scaleSpace.evolution[_options.nbOctaves * p + q].Lhess;
 
       // check that the point is under the image limits for the descriptor computation
       const float borderLimit =
@@ -311,8 +342,8 @@ void AKAZE::gridFiltering(std::vector<AKAZEKeypoint>& keypoints) const
 
   const std::size_t sizeMat = _options.gridSize * _options.gridSize;
   const std::size_t keypointsPerCell = _options.maxTotalKeypoints / sizeMat;
-  const double regionWidth = _input.Width() / static_cast<double>(_options.gridSize);
-  const double regionHeight = _input.Height() / static_cast<double>(_options.gridSize);
+  const double regionWidth = _scaleSpace.input.Width() / static_cast<double>(_options.gridSize);
+  const double regionHeight = _scaleSpace.input.Height() / static_cast<double>(_options.gridSize);
 
   std::vector<std::size_t> countFeatPerCell(sizeMat, 0);
   std::vector<std::size_t> rejectedIndexes;
@@ -393,7 +424,7 @@ void AKAZE::subpixelRefinement(std::vector<AKAZEKeypoint>& keypoints) const
   for(int i = 0; i < static_cast<int>(in_keypoints.size()); ++i)
   {
     AKAZEKeypoint& point = in_keypoints[i];
-    if(subpixelRefinement(point, this->_evolution[point.class_id].Lhess))
+    if(subpixelRefinement(point, _scaleSpace.evolution[point.class_id].Lhess))
     {
       #pragma omp critical
       keypoints.emplace_back(point);
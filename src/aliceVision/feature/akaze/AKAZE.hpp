@@ -17,6 +17,9 @@
 #include <aliceVision/feature/PointFeature.hpp>
 #include <aliceVision/feature/Descriptor.hpp>
 
+#include <memory>
+#include <vector>
+
 namespace aliceVision {
 namespace feature {
 
@@ -97,6 +100,38 @@ public:
     image::Image<float> Lhess;
   };
 
+  /**
+   * @brief Temporary images used to compute the slices of an octave
+   */
+  struct TOctaveBuffers
+  {
+    /// diffused image
+    image::Image<float> diffused;
+    /// smoothed image / diffusion coefficients
+    image::Image<float> smoothed;
+    /// FED step buffer
+    image::Image<float> fedStep;
+    /// second order derivatives
+    image::Image<float> Lxx;
+    image::Image<float> Lxy;
+    image::Image<float> Lyy;
+  };
+
+  /**
+   * @brief Scale space memory
+   * @note It can be kept alive to process images of the same size
+   *       without any new allocation.
+   */
+  struct TScaleSpace
+  {
+    /// input image
+    image::Image<float> input;
+    /// nonlinear diffusion evolution (one per slice)
+    std::vector<TEvolution> evolution;
+    /// temporary images (one set per octave)
+    std::vector<TOctaveBuffers> octaveBuffers;
+  };
+
   /**
    * @brief Constructor
    * @param[in] image Input image
@@ -104,6 +139,14 @@ public:
    */
   AKAZE(const image::Image<float>& image, const AKAZEOptions& options);
 
+  /**
+   * @brief Constructor using an external scale space memory
+   * @param[in] image Input image
+   * @param[in] options AKAZE configuration options
+   * @param[in,out] scaleSpace Scale space memory, reused if it comes from an image of the same size
+   */
+  AKAZE(const image::Image<float>& image, const AKAZEOptions& options, TScaleSpace& scaleSpace);
+
   /**
    * @brief Compute the AKAZE non linear diffusion scale space per slice
    */
@@ -151,16 +194,16 @@ public:
    */
   inline const std::vector<TEvolution>& getSlices() const
   {
-    return _evolution;
+    return _scaleSpace.evolution;
   }
 
 private:
   /// configuration options for AKAZE
   AKAZEOptions _options;
-  /// vector of nonlinear diffusion evolution (Scale Space)
-  std::vector<TEvolution> _evolution;
-  /// input image
-  image::Image<float> _input;
+  /// scale space memory, if not provided by the user
+  std::unique_ptr<TScaleSpace> _ownedScaleSpace;
+  /// scale space memory (Nonlinear diffusion evolution, input image and temporary images)
+  TScaleSpace& _scaleSpace;
 };
 
 } // namespace feature
@@ -0,0 +1,111 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/akaze/ImageDescriber_AKAZE.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#define BOOST_TEST_MODULE AKAZE
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+namespace {
+
+/// gaussian blobs of random size and contrast on a smooth gradient
+image::Image<float> createBlobsImage(int width, int height, int nbBlobs, unsigned int seed)
+{
+  image::Image<float> img(width, height);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      img(y, x) = 0.3f + 0.2f * float(x + y) / float(width + height);
+
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> distX(0.f, float(width));
+  std::uniform_real_distribution<float> distY(0.f, float(height));
+  std::uniform_real_distribution<float> distSigma(2.f, 12.f);
+  std::uniform_real_distribution<float> distContrast(-0.3f, 0.3f);
+
+  for(int i = 0; i < nbBlobs; ++i)
+  {
+    const float cx = distX(generator);
+    const float cy = distY(generator);
+    const float sigma = distSigma(generator);
+    const float contrast = distContrast(generator);
+    const int radius = static_cast<int>(3.f * sigma);
+    for(int y = std::max(0, int(cy) - radius); y < std::min(height, int(cy) + radius); ++y)
+      for(int x = std::max(0, int(cx) - radius); x < std::min(width, int(cx) + radius); ++x)
+      {
+        const float d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+        img(y, x) += contrast * std::exp(-0.5f * d2 / (sigma * sigma));
+      }
+  }
+  return img;
+}
+
+std::unique_ptr<Regions> describe(ImageDescriber_AKAZE& describer, const image::Image<float>& img)
+{
+  std::unique_ptr<Regions> regions;
+  BOOST_REQUIRE(describer.describe(img, regions));
+  BOOST_REQUIRE(regions);
+  return regions;
+}
+
+/// same keypoints and descriptors, in the same order
+void checkSameRegions(const Regions& regions, const Regions& regionsRef)
+{
+  BOOST_REQUIRE_EQUAL(regions.RegionCount(), regionsRef.RegionCount());
+  for(std::size_t i = 0; i < regionsRef.RegionCount(); ++i)
+  {
+    const PointFeature& featRef = regionsRef.Features()[i];
+    const PointFeature& feat = regions.Features()[i];
+    BOOST_CHECK_EQUAL(feat.x(), featRef.x());
+    BOOST_CHECK_EQUAL(feat.y(), featRef.y());
+    BOOST_CHECK_EQUAL(feat.scale(), featRef.scale());
+    BOOST_CHECK_EQUAL(feat.orientation(), featRef.orientation());
+  }
+  BOOST_REQUIRE_EQUAL(regions.DescriptorByteSize(), regionsRef.DescriptorByteSize());
+  BOOST_CHECK(std::memcmp(regions.DescriptorRawData(), regionsRef.DescriptorRawData(),
+                          regionsRef.RegionCount() * regionsRef.DescriptorByteSize()) == 0);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(AKAZE_scaleSpaceReuse)
+{
+  // the second image has the size of the first one, the third one is larger
+  // and the last one comes back to the first size after the larger allocation
+  const std::vector<image::Image<float>> images = {
+    createBlobsImage(400, 300, 250, 42),
+    createBlobsImage(400, 300, 250, 7),
+    createBlobsImage(520, 430, 400, 13),
+    createBlobsImage(400, 300, 250, 7),
+  };
+
+  for(EAKAZE_DESCRIPTOR descriptorType : {AKAZE_MSURF, AKAZE_LIOP, AKAZE_MLDB})
+  {
+    BOOST_TEST_MESSAGE("AKAZE descriptor: " << descriptorType);
+    const AKAZEParams params(AKAZEOptions(), descriptorType);
+
+    // a single describer keeps its scale space from one image to the next
+    ImageDescriber_AKAZE describer(params);
+
+    for(const image::Image<float>& img : images)
+    {
+      const std::unique_ptr<Regions> regions = describe(describer, img);
+
+      ImageDescriber_AKAZE freshDescriber(params);
+      const std::unique_ptr<Regions> regionsRef = describe(freshDescriber, img);
+      BOOST_REQUIRE_GT(regionsRef->RegionCount(), 50);
+
+      checkSameRegions(*regions, *regionsRef);
+    }
+  }
+}
@@ -23,7 +23,21 @@ bool ImageDescriber_AKAZE::describe(const image::Image<float>& image,
   std::vector<AKAZEKeypoint> keypoints;
   keypoints.reserve(_params.options.maxTotalKeypoints * 2);
 
-  AKAZE akaze(image, _params.options);
+  // scale space memory is kept by the describer, so the following images of the same size
+  // are processed without any new allocation (e.g. video frames)
+  std::unique_ptr<AKAZE::TScaleSpace> scaleSpace;
+  {
+    std::lock_guard<std::mutex> lock(_scaleSpacesMutex);
+    if(!_scaleSpaces.empty())
+    {
+      scaleSpace = std::move(_scaleSpaces.back());
+      _scaleSpaces.pop_back();
+    }
+  }
+  if(scaleSpace == nullptr)
+    scaleSpace.reset(new AKAZE::TScaleSpace);
+
+  AKAZE akaze(image, _params.options, *scaleSpace);
   akaze.computeScaleSpace();
   akaze.featureDetection(keypoints);
   akaze.subpixelRefinement(keypoints);
@@ -162,6 +176,12 @@ bool ImageDescriber_AKAZE::describe(const image::Image<float>& image,
     }
     break;
   }
+
+  // give back the scale space memory for the next image
+  {
+    std::lock_guard<std::mutex> lock(_scaleSpacesMutex);
+    _scaleSpaces.push_back(std::move(scaleSpace));
+  }
   return true;
 }
 
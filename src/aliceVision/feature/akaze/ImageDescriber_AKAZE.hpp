@@ -16,6 +16,10 @@
 #include <aliceVision/feature/akaze/descriptorMLDB.hpp>
 #include <aliceVision/feature/akaze/descriptorMSURF.hpp>
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace aliceVision {
 namespace feature {
 
@@ -86,19 +90,21 @@ public:
    * @param[in] width The image width
    * @param[in] height The image height
    * @return total amount of memory needed
+   * @note The scale space memory is kept by the describer after the extraction.
    */
   std::size_t getMemoryConsumption(std::size_t width, std::size_t height) const override
   {
     std::size_t fullImgSize = width * height;
-    std::size_t memoryConsuption = 0;
+    std::size_t octavesSize = 0;
     double downscale = 1.0;
     for(int octave = 0; octave < _params.options.nbOctaves; ++octave)
     {
-      memoryConsuption += fullImgSize / (downscale * downscale);
+      octavesSize += fullImgSize / (downscale * downscale);
       downscale *= 2.0;
     }
-    memoryConsuption *= _params.options.nbSlicePerOctave * sizeof(float);
-    return 4 * memoryConsuption + (3 * width * height * sizeof(float)) + 1.5 * std::pow(2,30); // add arbitrary 1.5 GB
+    // scale space: 4 images per slice (evolution) and 6 temporary images per octave
+    const std::size_t scaleSpaceSize = (4 * _params.options.nbSlicePerOctave + 6) * octavesSize * sizeof(float);
+    return scaleSpaceSize + (3 * width * height * sizeof(float)) + 1.5 * std::pow(2,30); // add arbitrary 1.5 GB
   }
 
   /**
@@ -186,6 +192,11 @@ public:
 private:
   AKAZEParams _params;
   bool _isOriented = true;
+
+  /// scale space memory kept between the images, one per concurrent extraction
+  /// (the describer may be shared by several extraction threads)
+  std::vector<std::unique_ptr<AKAZE::TScaleSpace>> _scaleSpaces;
+  std::mutex _scaleSpacesMutex;
 };
 
 } // namespace feature
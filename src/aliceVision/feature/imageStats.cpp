@@ -13,17 +13,22 @@ namespace aliceVision {
 namespace feature {
 
 float computeAutomaticContrastFactor(const image::Image<float>& image, const float percentile)
+{
+    image::Image<float> smoothed, Lx, Ly;
+    return computeAutomaticContrastFactor(image, percentile, smoothed, Lx, Ly);
+}
+
+float computeAutomaticContrastFactor(const image::Image<float>& image, const float percentile,
+                                     image::Image<float>& smoothed, image::Image<float>& Lx, image::Image<float>& Ly)
 {
     const size_t nbBins = 300;
     const int height = image.Height();
     const int width = image.Width();
 
     // smooth the image
-    image::Image<float> smoothed;
     image::ImageGaussianFilter(image, 1.f, smoothed, 0, 0);
 
     // compute gradient
-    image::Image<float> Lx, Ly;
     image::ImageScharrXDerivative(smoothed, Lx, false);
     image::ImageScharrYDerivative(smoothed, Ly, false);
 
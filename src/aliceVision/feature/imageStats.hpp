@@ -22,5 +22,19 @@ namespace feature {
  */
 float computeAutomaticContrastFactor(const image::Image<float>& image, const float percentile);
 
+/**
+ * @brief Estimate a contrast factor using the percentile of the image gradients.
+ *        Version using user provided temporary images (reused if they already have the right size).
+ *
+ * @param[in] image Input image for the given octave
+ * @param[in] percentile
+ * @param[in,out] smoothed Temporary image
+ * @param[in,out] Lx Temporary image
+ * @param[in,out] Ly Temporary image
+ * @return contrastFactor
+ */
+float computeAutomaticContrastFactor(const image::Image<float>& image, const float percentile,
+                                     image::Image<float>& smoothed, image::Image<float>& Lx, image::Image<float>& Ly);
+
 }  // namespace feature
 }  // namespace aliceVision
@@ -6,6 +6,8 @@
 
 #include "SIFT.hpp"
 
+#include <array>
+
 namespace aliceVision {
 namespace feature {
 
@@ -368,36 +370,44 @@ bool extractSIFT(const image::Image<float>& image, std::unique_ptr<Regions>& reg
             filteredKeypointsIndex.swap(newFilteredKeypointsIndex);
         }
 
-        std::vector<std::vector<double>> anglesPerKeypoint(filteredKeypointsIndex.size());
+        // compute from 1 to 4 orientations per keypoint
+        std::vector<std::array<double, 4>> anglesPerKeypoint(filteredKeypointsIndex.size(), {0.0, 0.0, 0.0, 0.0});
+        std::vector<std::size_t> featuresOffset(filteredKeypointsIndex.size() + 1, 0);
 
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 64)
         for(int ii = 0; ii < filteredKeypointsIndex.size(); ++ii)
         {
             const int i = filteredKeypointsIndex[ii];
-
-            double angles[4] = {0.0, 0.0, 0.0, 0.0};
             int nangles = 1; // by default (1 upright feature)
             if(orientation)
-            { // compute from 1 to 4 orientations
-                nangles = vl_sift_calc_keypoint_orientations(filt, angles, keys + i);
-            }
+                nangles = vl_sift_calc_keypoint_orientations(filt, anglesPerKeypoint[ii].data(), keys + i);
+            featuresOffset[ii + 1] = nangles;
+        }
+
+        // output slots of each keypoint, so features are stored in keypoints order whatever the threads scheduling
+        std::partial_sum(featuresOffset.begin(), featuresOffset.end(), featuresOffset.begin());
+        const std::size_t firstFeature = regionsCasted->Features().size();
+        const std::size_t nbFeatures = firstFeature + featuresOffset.back();
+        regionsCasted->Features().resize(nbFeatures);
+        regionsCasted->Descriptors().resize(nbFeatures);
+        featuresPeakValue.resize(nbFeatures);
+
+#pragma omp parallel for schedule(dynamic, 64)
+        for(int ii = 0; ii < filteredKeypointsIndex.size(); ++ii)
+        {
+            const int i = filteredKeypointsIndex[ii];
 
             Descriptor<vl_sift_pix, 128> vlFeatDescriptor;
-            Descriptor<T, 128> descriptor;
 
-            for(int q = 0; q < nangles; ++q)
+            for(std::size_t f = firstFeature + featuresOffset[ii]; f < firstFeature + featuresOffset[ii + 1]; ++f)
             {
-                const PointFeature fp(keys[i].x, keys[i].y, keys[i].sigma, static_cast<float>(angles[q]));
+                const double angle = anglesPerKeypoint[ii][f - firstFeature - featuresOffset[ii]];
 
-                vl_sift_calc_keypoint_descriptor(filt, &vlFeatDescriptor[0], keys + i, angles[q]);
-                convertSIFT<T>(&vlFeatDescriptor[0], descriptor, params._rootSift);
+                vl_sift_calc_keypoint_descriptor(filt, &vlFeatDescriptor[0], keys + i, angle);
+                convertSIFT<T>(&vlFeatDescriptor[0], regionsCasted->Descriptors()[f], params._rootSift);
 
-#pragma omp critical
-                {
-                    regionsCasted->Descriptors().push_back(descriptor);
-                    regionsCasted->Features().push_back(fp);
-                    featuresPeakValue.push_back(keys[i].peak_value);
-                }
+                regionsCasted->Features()[f] = PointFeature(keys[i].x, keys[i].y, keys[i].sigma, static_cast<float>(angle));
+                featuresPeakValue[f] = keys[i].peak_value;
             }
         }
 
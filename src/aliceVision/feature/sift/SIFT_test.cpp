@@ -0,0 +1,97 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/sift/ImageDescriber_SIFT_vlfeat.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <cmath>
+#include <random>
+
+#define BOOST_TEST_MODULE SIFT
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+namespace {
+
+/// gaussian blobs of random size and contrast on a smooth gradient
+image::Image<float> createBlobsImage(int width, int height, int nbBlobs)
+{
+  image::Image<float> img(width, height);
+  for(int y = 0; y < height; ++y)
+    for(int x = 0; x < width; ++x)
+      img(y, x) = 0.3f + 0.2f * float(x + y) / float(width + height);
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distX(0.f, float(width));
+  std::uniform_real_distribution<float> distY(0.f, float(height));
+  std::uniform_real_distribution<float> distSigma(2.f, 12.f);
+  std::uniform_real_distribution<float> distContrast(-0.3f, 0.3f);
+
+  for(int i = 0; i < nbBlobs; ++i)
+  {
+    const float cx = distX(generator);
+    const float cy = distY(generator);
+    const float sigma = distSigma(generator);
+    const float contrast = distContrast(generator);
+    const int radius = static_cast<int>(3.f * sigma);
+    for(int y = std::max(0, int(cy) - radius); y < std::min(height, int(cy) + radius); ++y)
+      for(int x = std::max(0, int(cx) - radius); x < std::min(width, int(cx) + radius); ++x)
+      {
+        const float d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+        img(y, x) += contrast * std::exp(-0.5f * d2 / (sigma * sigma));
+      }
+  }
+  return img;
+}
+
+std::unique_ptr<Regions> describe(const image::Image<float>& img, int nbThreads)
+{
+  const int previousNbThreads = omp_get_max_threads();
+  omp_set_num_threads(nbThreads);
+
+  ImageDescriber_SIFT_vlfeat describer;
+  std::unique_ptr<Regions> regions;
+  const bool success = describer.describe(img, regions);
+
+  omp_set_num_threads(previousNbThreads);
+  BOOST_REQUIRE(success);
+  return regions;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SIFT_threadsIndependence)
+{
+  // large enough for the parallel processing of the first octaves
+  const image::Image<float> img = createBlobsImage(800, 700, 600);
+
+  const std::unique_ptr<Regions> regionsRef = describe(img, 1);
+  const SIFT_Regions& siftRef = dynamic_cast<const SIFT_Regions&>(*regionsRef);
+  BOOST_REQUIRE_GT(siftRef.RegionCount(), 100);
+
+  for(int nbThreads : {2, 3, 8})
+  {
+    const std::unique_ptr<Regions> regions = describe(img, nbThreads);
+    const SIFT_Regions& sift = dynamic_cast<const SIFT_Regions&>(*regions);
+
+    // same keypoints and descriptors, in the same order
+    BOOST_REQUIRE_EQUAL(sift.RegionCount(), siftRef.RegionCount());
+    for(std::size_t i = 0; i < siftRef.RegionCount(); ++i)
+    {
+      const PointFeature& featRef = siftRef.Features()[i];
+      const PointFeature& feat = sift.Features()[i];
+      BOOST_CHECK_EQUAL(feat.x(), featRef.x());
+      BOOST_CHECK_EQUAL(feat.y(), featRef.y());
+      BOOST_CHECK_EQUAL(feat.scale(), featRef.scale());
+      BOOST_CHECK_EQUAL(feat.orientation(), featRef.orientation());
+      BOOST_CHECK(sift.Descriptors()[i] == siftRef.Descriptors()[i]);
+    }
+  }
+}
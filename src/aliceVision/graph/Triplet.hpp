@@ -9,10 +9,13 @@
 
 #include <aliceVision/types.hpp>
 #include <aliceVision/graph/graph.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <lemon/list_graph.h>
 
 #include <algorithm>
+#include <numeric>
+#include <tuple>
 #include <vector>
 
 namespace aliceVision {
@@ -119,29 +122,152 @@ bool List_Triplets(const GraphT & g, std::vector< Triplet > & vec_triplets)
   return (!vec_triplets.empty());
 }
 
-/// Return triplets contained in the graph build from IterablePairs
+/**
+ * @brief Compressed sparse row adjacency of an undirected graph, where each edge is
+ *        oriented from its lowest ranked node to its highest ranked node.
+ *        The nodes are ranked by increasing degree, so that the out-degree of each node
+ *        is bounded by sqrt(2 * nbEdges).
+ */
+struct DegreeOrderedGraph
+{
+  /// node id of each node index
+  std::vector<IndexT> nodeIds;
+  /// out-neighbours of node n are outNeighbours[offsets[n], offsets[n+1]), sorted by rank
+  std::vector<std::size_t> offsets;
+  /// out-neighbours, stored as node ranks
+  std::vector<std::size_t> outNeighbours;
+  /// node index of each rank
+  std::vector<std::size_t> nodePerRank;
+
+  template <typename IterablePairs>
+  explicit DegreeOrderedGraph(const IterablePairs& pairs)
+  {
+    // unique undirected edges between node indexes
+    std::vector<std::pair<IndexT, IndexT>> edges;
+    for(const auto& pair : pairs)
+    {
+      if(pair.first != pair.second)
+        edges.emplace_back(std::min<IndexT>(pair.first, pair.second), std::max<IndexT>(pair.first, pair.second));
+      nodeIds.push_back(pair.first);
+      nodeIds.push_back(pair.second);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    std::sort(nodeIds.begin(), nodeIds.end());
+    nodeIds.erase(std::unique(nodeIds.begin(), nodeIds.end()), nodeIds.end());
+
+    const auto nodeIndex = [this](IndexT nodeId)
+    {
+      return static_cast<std::size_t>(std::lower_bound(nodeIds.begin(), nodeIds.end(), nodeId) - nodeIds.begin());
+    };
+
+    const std::size_t nbNodes = nodeIds.size();
+    std::vector<std::size_t> degrees(nbNodes, 0);
+    for(auto& edge : edges)
+    {
+      edge = std::make_pair(nodeIndex(edge.first), nodeIndex(edge.second));
+      ++degrees[edge.first];
+      ++degrees[edge.second];
+    }
+
+    // rank the nodes by increasing degree
+    nodePerRank.resize(nbNodes);
+    std::iota(nodePerRank.begin(), nodePerRank.end(), 0);
+    std::sort(nodePerRank.begin(), nodePerRank.end(), [&degrees](std::size_t a, std::size_t b)
+    {
+      return (degrees[a] != degrees[b]) ? (degrees[a] < degrees[b]) : (a < b);
+    });
+    std::vector<std::size_t> rankPerNode(nbNodes);
+    for(std::size_t rank = 0; rank < nbNodes; ++rank)
+      rankPerNode[nodePerRank[rank]] = rank;
+
+    // orient the edges from the lowest rank to the highest rank, indexed by rank
+    offsets.assign(nbNodes + 1, 0);
+    for(auto& edge : edges)
+    {
+      edge = std::make_pair(std::min(rankPerNode[edge.first], rankPerNode[edge.second]),
+                            std::max(rankPerNode[edge.first], rankPerNode[edge.second]));
+      ++offsets[edge.first + 1];
+    }
+    for(std::size_t rank = 0; rank < nbNodes; ++rank)
+      offsets[rank + 1] += offsets[rank];
+
+    std::sort(edges.begin(), edges.end());
+    outNeighbours.resize(edges.size());
+    for(std::size_t e = 0; e < edges.size(); ++e)
+      outNeighbours[e] = edges[e].second;
+  }
+
+  std::size_t nbNodes() const { return nodeIds.size(); }
+
+  IndexT nodeId(std::size_t rank) const { return nodeIds[nodePerRank[rank]]; }
+};
+
+/**
+ * @brief List the triplets (cycles of length 3) of the graph defined by the given pairs.
+ *
+ * Each triangle is found once from its lowest ranked node u: for each out-neighbour v of u,
+ * the common out-neighbours of u and v close a triangle. The intersections of the sorted
+ * adjacency lists are computed in parallel, one node per task.
+ * Complexity: O(nbEdges^1.5).
+ *
+ * @param[in] pairs the edges of the graph
+ * @return the triplets, with i < j < k, sorted in lexicographic order
+ */
 template <typename IterablePairs>
 inline std::vector< graph::Triplet > tripletListing(
   const IterablePairs & pairs)
 {
-  std::vector< graph::Triplet > vec_triplets;
+  const DegreeOrderedGraph orderedGraph(pairs);
+  const std::ptrdiff_t nbNodes = static_cast<std::ptrdiff_t>(orderedGraph.nbNodes());
 
-  indexedGraph putativeGraph(pairs);
+  std::vector<std::vector<graph::Triplet>> tripletsPerThread(omp_get_max_threads());
 
-  graph::List_Triplets<indexedGraph::GraphT>(putativeGraph.g, vec_triplets);
-
-  //Change triplets to ImageIds
-  for (size_t i = 0; i < vec_triplets.size(); ++i)
+  #pragma omp parallel for schedule(dynamic, 16)
+  for(std::ptrdiff_t u = 0; u < nbNodes; ++u)
   {
-    graph::Triplet & triplet = vec_triplets[i];
-    IndexT I = triplet.i, J = triplet.j , K = triplet.k;
-    I = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(I)];
-    J = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(J)];
-    K = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(K)];
-    IndexT triplet_[3] = { I, J, K };
-    std::sort(&triplet_[0], &triplet_[3]);
-    triplet = graph::Triplet(triplet_[0],triplet_[1],triplet_[2]);
+    std::vector<graph::Triplet>& triplets = tripletsPerThread[omp_get_thread_num()];
+
+    const auto uBegin = orderedGraph.outNeighbours.begin() + orderedGraph.offsets[u];
+    const auto uEnd = orderedGraph.outNeighbours.begin() + orderedGraph.offsets[u + 1];
+
+    for(auto itV = uBegin; itV != uEnd; ++itV)
+    {
+      const std::size_t v = *itV;
+      auto itU = itV + 1; // the common neighbours have a higher rank than v
+      auto itW = orderedGraph.outNeighbours.begin() + orderedGraph.offsets[v];
+      const auto wEnd = orderedGraph.outNeighbours.begin() + orderedGraph.offsets[v + 1];
+
+      while(itU != uEnd && itW != wEnd)
+      {
+        if(*itU < *itW)
+          ++itU;
+        else if(*itW < *itU)
+          ++itW;
+        else
+        {
+          IndexT triplet[3] = {orderedGraph.nodeId(u), orderedGraph.nodeId(v), orderedGraph.nodeId(*itW)};
+          std::sort(&triplet[0], &triplet[3]);
+          triplets.emplace_back(triplet[0], triplet[1], triplet[2]);
+          ++itU;
+          ++itW;
+        }
+      }
+    }
   }
+
+  std::vector< graph::Triplet > vec_triplets;
+  std::size_t nbTriplets = 0;
+  for(const auto& triplets : tripletsPerThread)
+    nbTriplets += triplets.size();
+  vec_triplets.reserve(nbTriplets);
+  for(const auto& triplets : tripletsPerThread)
+    vec_triplets.insert(vec_triplets.end(), triplets.begin(), triplets.end());
+
+  std::sort(vec_triplets.begin(), vec_triplets.end(), [](const graph::Triplet& a, const graph::Triplet& b)
+  {
+    return std::make_tuple(a.i, a.j, a.k) < std::make_tuple(b.i, b.j, b.k);
+  });
   return vec_triplets;
 }
 
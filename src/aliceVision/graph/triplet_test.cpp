@@ -8,6 +8,9 @@
 #include "aliceVision/graph/Triplet.hpp"
 
 #include <iostream>
+#include <random>
+#include <set>
+#include <tuple>
 #include <vector>
 
 #define BOOST_TEST_MODULE tripletFinder
@@ -269,3 +272,70 @@ BOOST_AUTO_TEST_CASE(test_for_triplet) {
     BOOST_CHECK_EQUAL(4, vec_triplets.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(test_tripletListing) {
+
+  {
+    //
+    // 10__20
+    // | \/ |
+    // | /\ |
+    // 30--40--50
+    //
+    // (duplicated and reversed pairs are ignored)
+    const aliceVision::PairSet pairs = {
+      {10, 20}, {10, 30}, {10, 40}, {30, 40}, {20, 40}, {30, 20}, {40, 50}, {40, 10}};
+
+    const std::vector< Triplet > vec_triplets = tripletListing(pairs);
+    BOOST_REQUIRE_EQUAL(4, vec_triplets.size());
+    // triplets are sorted with i < j < k
+    BOOST_CHECK(vec_triplets[0] == Triplet(10, 20, 30));
+    BOOST_CHECK(vec_triplets[1] == Triplet(10, 20, 40));
+    BOOST_CHECK(vec_triplets[2] == Triplet(10, 30, 40));
+    BOOST_CHECK(vec_triplets[3] == Triplet(20, 30, 40));
+    for(const Triplet& triplet : vec_triplets)
+      BOOST_CHECK(triplet.i < triplet.j && triplet.j < triplet.k);
+  }
+
+  {
+    // random graph: same triplets as the lemon graph listing
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_int_distribution<aliceVision::IndexT> distribution(0, 99);
+
+    aliceVision::PairSet pairs;
+    while(pairs.size() < 1000)
+    {
+      const aliceVision::IndexT a = distribution(randomNumberGenerator);
+      const aliceVision::IndexT b = distribution(randomNumberGenerator);
+      if(a != b)
+        pairs.insert(std::make_pair(std::min(a, b), std::max(a, b)));
+    }
+
+    std::vector< Triplet > vec_triplets = tripletListing(pairs);
+
+    aliceVision::graph::indexedGraph putativeGraph(pairs);
+    std::vector< Triplet > vec_triplets_lemon;
+    List_Triplets<aliceVision::graph::indexedGraph::GraphT>(putativeGraph.g, vec_triplets_lemon);
+
+    BOOST_CHECK_EQUAL(vec_triplets.size(), vec_triplets_lemon.size());
+
+    const auto tripletKey = [](const Triplet& triplet)
+    {
+      return std::make_tuple(triplet.i, triplet.j, triplet.k);
+    };
+    std::set<std::tuple<aliceVision::IndexT, aliceVision::IndexT, aliceVision::IndexT>> triplets, tripletsLemon;
+    for(const Triplet& triplet : vec_triplets)
+      triplets.insert(tripletKey(triplet));
+    for(const Triplet& triplet : vec_triplets_lemon)
+    {
+      aliceVision::IndexT ids[3] = {
+        (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(triplet.i)],
+        (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(triplet.j)],
+        (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(triplet.k)]};
+      std::sort(&ids[0], &ids[3]);
+      tripletsLemon.insert(std::make_tuple(ids[0], ids[1], ids[2]));
+    }
+    BOOST_CHECK_EQUAL(triplets.size(), vec_triplets.size());
+    BOOST_CHECK(triplets == tripletsLemon);
+  }
+}
@@ -7,75 +7,391 @@
 
 #include "convolution.hpp"
 
+#include <aliceVision/system/cpu.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+// AVX2 kernels are compiled with a function target attribute (GCC/Clang) or directly (MSVC),
+// so they do not depend on the global architecture flags and are selected at runtime.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ALICEVISION_CONVOLUTION_AVX2 1
+#define ALICEVISION_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#define ALICEVISION_CONVOLUTION_AVX2 1
+#define ALICEVISION_TARGET_AVX2
+#else
+#define ALICEVISION_CONVOLUTION_AVX2 0
+#endif
+
 namespace aliceVision {
 namespace image {
 
-void SeparableConvolution2d(const RowMatrixXf& image,
-                            const Eigen::Matrix<float, 1, Eigen::Dynamic>& kernel_x,
-                            const Eigen::Matrix<float, 1, Eigen::Dynamic>& kernel_y,
-                            RowMatrixXf* out) {
-  const int sigma_y = static_cast<int>( kernel_y.cols() );
-  const int half_sigma_y = static_cast<int>( kernel_y.cols() ) / 2;
+namespace {
+
+/// number of consecutive rows processed by a thread (the vertical kernel window stays in cache)
+const int convolutionBandHeight = 16;
+
+/// minimal number of values for the parallel computation
+const int convolutionParallelMinSize = 256 * 256;
+
+/**
+ * @brief Border handling of the separable convolution
+ */
+enum class EBorderMode
+{
+  /// repeat the first/last pixel
+  REPLICATE,
+  /// mirror without repeating the first/last pixel,
+  /// except on the right border which is shifted by one pixel (as in the former Eigen implementation of SeparableConvolution2d)
+  MIRROR
+};
+
+/**
+ * @brief Vertical convolution of rows: out[i] = sum_k kernel[k] * rows[k][i]
+ */
+void convolveColumnsScalar(const float* const* rows, const float* kernel, int kernelSize, float* out, int size)
+{
+  const float* row = rows[0];
+  const float w = kernel[0];
+  for(int i = 0; i < size; ++i)
+    out[i] = w * row[i];
+
+  for(int k = 1; k < kernelSize; ++k)
+  {
+    const float* row = rows[k];
+    const float w = kernel[k];
+    for(int i = 0; i < size; ++i)
+      out[i] += w * row[i];
+  }
+}
+
+/**
+ * @brief Horizontal convolution of a padded line of interleaved pixels:
+ *        out[i] = sum_k kernel[k] * line[i + k * stride]
+ */
+void convolveRowScalar(const float* line, const float* kernel, int kernelSize, int stride, float* out, int size)
+{
+  const float w = kernel[0];
+  for(int i = 0; i < size; ++i)
+    out[i] = w * line[i];
+
+  for(int k = 1; k < kernelSize; ++k)
+  {
+    const float* shifted = line + k * stride;
+    const float w = kernel[k];
+    for(int i = 0; i < size; ++i)
+      out[i] += w * shifted[i];
+  }
+}
+
+#if ALICEVISION_CONVOLUTION_AVX2
 
-  // Convolving a vertical filter across rows is the same thing as transpose
-  // multiply i.e. kernel_y^t * rows. This will give us the convoled value for
-  // each row. However, care must be taken at the top and bottom borders.
-  const Eigen::Matrix<float, 1, Eigen::Dynamic> reverse_kernel_y = kernel_y.reverse();
+ALICEVISION_TARGET_AVX2
+void convolveColumnsAVX2(const float* const* rows, const float* kernel, int kernelSize, float* out, int size)
+{
+  int i = 0;
 
-  #pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < half_sigma_y; i++)
+  // two registers per iteration to hide the FMA latency
+  for(; i + 16 <= size; i += 16)
   {
-    const int forward_size = i + half_sigma_y + 1;
-    const int reverse_size = sigma_y - forward_size;
-    out->row(i) = kernel_y.tail(forward_size) *
-                  image.block(0, 0, forward_size, image.cols()) +
-                  reverse_kernel_y.tail(reverse_size) *
-                  image.block(1, 0, reverse_size, image.cols());
-
-    // Apply the same technique for the end rows.
-    out->row(image.rows() - i - 1) =
-      kernel_y.head(forward_size) *
-      image.block(image.rows() - forward_size, 0, forward_size, image.cols())
-      +
-      reverse_kernel_y.head(reverse_size) *
-      image.block(image.rows() - reverse_size - 1, 0, reverse_size, image.cols());
+    __m256 w = _mm256_set1_ps(kernel[0]);
+    __m256 acc0 = _mm256_mul_ps(w, _mm256_loadu_ps(rows[0] + i));
+    __m256 acc1 = _mm256_mul_ps(w, _mm256_loadu_ps(rows[0] + i + 8));
+    for(int k = 1; k < kernelSize; ++k)
+    {
+      w = _mm256_set1_ps(kernel[k]);
+      acc0 = _mm256_fmadd_ps(w, _mm256_loadu_ps(rows[k] + i), acc0);
+      acc1 = _mm256_fmadd_ps(w, _mm256_loadu_ps(rows[k] + i + 8), acc1);
+    }
+    _mm256_storeu_ps(out + i, acc0);
+    _mm256_storeu_ps(out + i + 8, acc1);
   }
 
-  // Applying the rest of the y filter.
-  #pragma omp parallel for schedule(dynamic)
-  for (int row = half_sigma_y; row < image.rows() - half_sigma_y; row++)
+  for(; i + 8 <= size; i += 8)
   {
-    out->row(row) =  kernel_y * image.block(row - half_sigma_y, 0, sigma_y, out->cols());
+    __m256 acc = _mm256_mul_ps(_mm256_set1_ps(kernel[0]), _mm256_loadu_ps(rows[0] + i));
+    for(int k = 1; k < kernelSize; ++k)
+      acc = _mm256_fmadd_ps(_mm256_set1_ps(kernel[k]), _mm256_loadu_ps(rows[k] + i), acc);
+    _mm256_storeu_ps(out + i, acc);
   }
 
-  const int sigma_x = static_cast<int>(kernel_x.cols());
-  const int half_sigma_x = static_cast<int>(kernel_x.cols() / 2);
+  for(; i < size; ++i)
+  {
+    float sum = kernel[0] * rows[0][i];
+    for(int k = 1; k < kernelSize; ++k)
+      sum += kernel[k] * rows[k][i];
+    out[i] = sum;
+  }
+}
 
-  // Convolving with the horizontal filter is easy. Rather than using the kernel
-  // as a sliding window, we use the row pixels as a sliding window around the
-  // filter. We prepend and append the proper border values so that we are sure
-  // to end up with the correct convolved values.
-  Eigen::RowVectorXf temp_row(image.cols() + sigma_x - 1);
+ALICEVISION_TARGET_AVX2
+void convolveRowAVX2(const float* line, const float* kernel, int kernelSize, int stride, float* out, int size)
+{
+  int i = 0;
 
-  #pragma omp parallel for firstprivate(temp_row), schedule(dynamic)
-  for (int row = 0; row < out->rows(); row++)
+  for(; i + 16 <= size; i += 16)
   {
-    temp_row.head(half_sigma_x) =
-      out->row(row).segment(1, half_sigma_x).reverse();
-    temp_row.segment(half_sigma_x, image.cols()) = out->row(row);
-    temp_row.tail(half_sigma_x) =
-      out->row(row)
-      .segment(image.cols() - 2 - half_sigma_x, half_sigma_x)
-      .reverse();
-
-    // Convolve the row. We perform the first step here explicitly so that we
-    // avoid setting the row equal to zero.
-    out->row(row) = kernel_x(0) * temp_row.head(image.cols());
-    for (int i = 1; i < sigma_x; i++) {
-      out->row(row) += kernel_x(i) * temp_row.segment(i, image.cols());
+    __m256 w = _mm256_set1_ps(kernel[0]);
+    __m256 acc0 = _mm256_mul_ps(w, _mm256_loadu_ps(line + i));
+    __m256 acc1 = _mm256_mul_ps(w, _mm256_loadu_ps(line + i + 8));
+    for(int k = 1; k < kernelSize; ++k)
+    {
+      const float* shifted = line + k * stride + i;
+      w = _mm256_set1_ps(kernel[k]);
+      acc0 = _mm256_fmadd_ps(w, _mm256_loadu_ps(shifted), acc0);
+      acc1 = _mm256_fmadd_ps(w, _mm256_loadu_ps(shifted + 8), acc1);
     }
+    _mm256_storeu_ps(out + i, acc0);
+    _mm256_storeu_ps(out + i + 8, acc1);
+  }
+
+  for(; i + 8 <= size; i += 8)
+  {
+    __m256 acc = _mm256_mul_ps(_mm256_set1_ps(kernel[0]), _mm256_loadu_ps(line + i));
+    for(int k = 1; k < kernelSize; ++k)
+      acc = _mm256_fmadd_ps(_mm256_set1_ps(kernel[k]), _mm256_loadu_ps(line + k * stride + i), acc);
+    _mm256_storeu_ps(out + i, acc);
+  }
+
+  for(; i < size; ++i)
+  {
+    float sum = kernel[0] * line[i];
+    for(int k = 1; k < kernelSize; ++k)
+      sum += kernel[k] * line[i + k * stride];
+    out[i] = sum;
   }
 }
 
+#endif // ALICEVISION_CONVOLUTION_AVX2
+
+/**
+ * @brief Set of 1D convolution kernels
+ */
+struct ConvolutionKernels
+{
+  void (*columns)(const float* const* rows, const float* kernel, int kernelSize, float* out, int size);
+  void (*row)(const float* line, const float* kernel, int kernelSize, int stride, float* out, int size);
+};
+
+const ConvolutionKernels scalarKernels = {&convolveColumnsScalar, &convolveRowScalar};
+#if ALICEVISION_CONVOLUTION_AVX2
+const ConvolutionKernels avx2Kernels = {&convolveColumnsAVX2, &convolveRowAVX2};
+#endif
+
+std::atomic<bool>& convolutionSIMDFlag()
+{
+#if ALICEVISION_CONVOLUTION_AVX2
+  static std::atomic<bool> enabled(system::cpu_has_avx2());
+#else
+  static std::atomic<bool> enabled(false);
+#endif
+  return enabled;
+}
+
+const ConvolutionKernels& getConvolutionKernels()
+{
+#if ALICEVISION_CONVOLUTION_AVX2
+  if(convolutionSIMDFlag())
+    return avx2Kernels;
+#endif
+  return scalarKernels;
+}
+
+/**
+ * @brief Index of a row/column outside of the image according to the border mode
+ */
+inline int borderIndex(int i, int size, EBorderMode border)
+{
+  if(border == EBorderMode::REPLICATE || size == 1)
+    return std::min(std::max(i, 0), size - 1);
+
+  // mirror (several times if the kernel is larger than the image)
+  while(i < 0 || i >= size)
+    i = (i < 0) ? -i : 2 * (size - 1) - i;
+  return i;
+}
+
+inline void convertRow(const float* in, float* out, int size)
+{
+  std::memcpy(out, in, sizeof(float) * size);
+}
+
+inline void convertRow(const unsigned char* in, float* out, int size)
+{
+  for(int i = 0; i < size; ++i)
+    out[i] = static_cast<float>(in[i]);
+}
+
+inline void convertRow(const float* in, unsigned char* out, int size)
+{
+  // truncation, as the generic convolution on 8-bit images
+  for(int i = 0; i < size; ++i)
+    out[i] = static_cast<unsigned char>(std::min(std::max(in[i], 0.f), 255.f));
+}
+
+/**
+ * @brief Separable convolution on interleaved pixels.
+ *        The image is processed per band of rows: each row is filtered vertically in a padded line buffer
+ *        and then horizontally into the output, so there is no intermediate image.
+ * @param[in] in Input values
+ * @param[out] out Output values (can be the input buffer)
+ * @param[in] width Image width
+ * @param[in] height Image height
+ * @param[in] nbChannels Number of interleaved channels
+ * @param[in] kernelX Horizontal kernel (skipped if kernelSizeX is 0)
+ * @param[in] kernelSizeX Horizontal kernel size (odd)
+ * @param[in] kernelY Vertical kernel (skipped if kernelSizeY is 0)
+ * @param[in] kernelSizeY Vertical kernel size (odd)
+ * @param[in] border Border handling mode
+ */
+template <typename T>
+void separableConvolutionImpl(const T* in, T* out,
+                              int width, int height, int nbChannels,
+                              const float* kernelX, int kernelSizeX,
+                              const float* kernelY, int kernelSizeY,
+                              EBorderMode border)
+{
+  if(width <= 0 || height <= 0)
+    return;
+
+  const int rowSize = width * nbChannels;
+
+  // the vertical pass reads rows already written in the output
+  std::vector<T> inCopy;
+  if(kernelSizeY > 0 && in == out)
+  {
+    inCopy.assign(in, in + static_cast<std::size_t>(rowSize) * height);
+    in = inCopy.data();
+  }
+
+  const ConvolutionKernels& kernels = getConvolutionKernels();
+  const int halfX = kernelSizeX / 2;
+  const int halfY = kernelSizeY / 2;
+  const int nbBands = (height + convolutionBandHeight - 1) / convolutionBandHeight;
+  const bool isFloat = std::is_same<T, float>::value;
+
+  #pragma omp parallel if(nbBands > 1 && rowSize * height >= convolutionParallelMinSize)
+  {
+    // padded line: vertically filtered row with the horizontal borders
+    std::vector<float> line((width + 2 * halfX) * nbChannels);
+    std::vector<float> result(isFloat ? 0 : rowSize);
+
+    // rows of the vertical kernel window
+    std::vector<const float*> rows(kernelSizeY);
+    // float copies of the last rows used by the vertical kernel (8-bit images only)
+    std::vector<float> cachedRows(isFloat ? 0 : static_cast<std::size_t>(kernelSizeY) * rowSize);
+    std::vector<int> cachedRowsIndex(kernelSizeY, -1);
+
+    const auto getRow = [&](int y) -> const float*
+    {
+      const T* src = in + static_cast<std::size_t>(y) * rowSize;
+      if(isFloat)
+        return reinterpret_cast<const float*>(src);
+
+      // rows of the window are in a range smaller than the kernel size, so they never share a slot
+      const int slot = y % kernelSizeY;
+      float* cached = cachedRows.data() + static_cast<std::size_t>(slot) * rowSize;
+      if(cachedRowsIndex[slot] != y)
+      {
+        convertRow(src, cached, rowSize);
+        cachedRowsIndex[slot] = y;
+      }
+      return cached;
+    };
+
+    #pragma omp for schedule(dynamic)
+    for(int band = 0; band < nbBands; ++band)
+    {
+      const int yEnd = std::min(height, (band + 1) * convolutionBandHeight);
+      for(int y = band * convolutionBandHeight; y < yEnd; ++y)
+      {
+        T* dst = out + static_cast<std::size_t>(y) * rowSize;
+        float* lineCenter = line.data() + halfX * nbChannels;
+
+        // vertical pass
+        if(kernelSizeY > 0)
+        {
+          for(int k = 0; k < kernelSizeY; ++k)
+            rows[k] = getRow(borderIndex(y + k - halfY, height, border));
+          kernels.columns(rows.data(), kernelY, kernelSizeY, lineCenter, rowSize);
+        }
+        else
+        {
+          convertRow(in + static_cast<std::size_t>(y) * rowSize, lineCenter, rowSize);
+        }
+
+        if(kernelSizeX == 0)
+        {
+          convertRow(lineCenter, dst, rowSize);
+          continue;
+        }
+
+        // horizontal borders
+        for(int x = 1; x <= halfX; ++x)
+        {
+          const int left = (border == EBorderMode::REPLICATE) ? 0 : borderIndex(x, width, border);
+          const int right = (border == EBorderMode::REPLICATE) ? width - 1 : borderIndex(width - 1 - x - 1, width, border);
+          std::memcpy(lineCenter - x * nbChannels, lineCenter + left * nbChannels, sizeof(float) * nbChannels);
+          std::memcpy(lineCenter + (width - 1 + x) * nbChannels, lineCenter + right * nbChannels, sizeof(float) * nbChannels);
+        }
+
+        // horizontal pass
+        float* rowOut = isFloat ? reinterpret_cast<float*>(dst) : result.data();
+        kernels.row(line.data(), kernelX, kernelSizeX, nbChannels, rowOut, rowSize);
+        if(!isFloat)
+          convertRow(rowOut, dst, rowSize);
+      }
+    }
+  }
+}
+
+} // namespace
+
+void setConvolutionSIMD(bool enable)
+{
+#if ALICEVISION_CONVOLUTION_AVX2
+  convolutionSIMDFlag() = enable && system::cpu_has_avx2();
+#endif
+}
+
+bool isConvolutionSIMDEnabled()
+{
+  return convolutionSIMDFlag();
+}
+
+void separableConvolution(const float* in, float* out,
+                          int width, int height, int nbChannels,
+                          const float* kernelX, int kernelSizeX,
+                          const float* kernelY, int kernelSizeY)
+{
+  separableConvolutionImpl(in, out, width, height, nbChannels, kernelX, kernelSizeX, kernelY, kernelSizeY, EBorderMode::REPLICATE);
+}
+
+void separableConvolution(const unsigned char* in, unsigned char* out,
+                          int width, int height, int nbChannels,
+                          const float* kernelX, int kernelSizeX,
+                          const float* kernelY, int kernelSizeY)
+{
+  separableConvolutionImpl(in, out, width, height, nbChannels, kernelX, kernelSizeX, kernelY, kernelSizeY, EBorderMode::REPLICATE);
+}
+
+void SeparableConvolution2d(const RowMatrixXf& image,
+                            const Eigen::Matrix<float, 1, Eigen::Dynamic>& kernel_x,
+                            const Eigen::Matrix<float, 1, Eigen::Dynamic>& kernel_y,
+                            RowMatrixXf* out)
+{
+  out->resize(image.rows(), image.cols());
+  separableConvolutionImpl(image.data(), out->data(),
+                           static_cast<int>(image.cols()), static_cast<int>(image.rows()), 1,
+                           kernel_x.data(), static_cast<int>(kernel_x.cols()),
+                           kernel_y.data(), static_cast<int>(kernel_y.cols()),
+                           EBorderMode::MIRROR);
+}
+
 } // namespace image
 } // namespace aliceVision
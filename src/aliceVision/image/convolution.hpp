@@ -15,6 +15,7 @@
 
 #include <vector>
 #include <cassert>
+#include <type_traits>
 
 /**
  ** @file Standard 2D image convolution functions :
@@ -26,6 +27,43 @@
 namespace aliceVision {
 namespace image {
 
+/**
+ ** Enable or disable the AVX2 implementation of the separable convolutions.
+ ** It is enabled by default if the CPU supports it.
+ ** @param enable false to use the scalar implementation
+ **/
+void setConvolutionSIMD(bool enable);
+
+/**
+ ** @return true if the separable convolutions use the AVX2 implementation
+ **/
+bool isConvolutionSIMDEnabled();
+
+/**
+ ** Separable convolution of an image with interleaved channels (border pixels are copied)
+ ** The vertical and horizontal passes are computed per band of rows with float accumulation,
+ ** using AVX2 if available and OpenMP on large images.
+ ** @param in input buffer (width * height * nbChannels values)
+ ** @param out output buffer (can be the input buffer)
+ ** @param width image width
+ ** @param height image height
+ ** @param nbChannels number of interleaved channels
+ ** @param kernelX horizontal kernel (odd size, the pass is skipped if kernelSizeX is 0)
+ ** @param kernelSizeX horizontal kernel size
+ ** @param kernelY vertical kernel (odd size, the pass is skipped if kernelSizeY is 0)
+ ** @param kernelSizeY vertical kernel size
+ **/
+void separableConvolution(const float* in, float* out,
+                          int width, int height, int nbChannels,
+                          const float* kernelX, int kernelSizeX,
+                          const float* kernelY, int kernelSizeY);
+
+/// 8-bit version (values are truncated to [0, 255])
+void separableConvolution(const unsigned char* in, unsigned char* out,
+                          int width, int height, int nbChannels,
+                          const float* kernelX, int kernelSizeX,
+                          const float* kernelY, int kernelSizeY);
+
 /**
  ** General image convolution by a kernel
  ** assume kernel has odd size in both dimensions and (border pixel are copied)
@@ -163,6 +201,78 @@ void ImageVerticalConvolution( const ImageTypeIn & img , const Kernel & kernel ,
   }
 }
 
+/**
+ ** Traits of the image types handled by separableConvolution
+ **/
+template <typename T>
+struct SeparableConvolutionPixel { static const bool supported = false; };
+
+template <>
+struct SeparableConvolutionPixel<float> { typedef float Tvalue; static const int nbChannels = 1; static const bool supported = true; };
+
+template <>
+struct SeparableConvolutionPixel<unsigned char> { typedef unsigned char Tvalue; static const int nbChannels = 1; static const bool supported = true; };
+
+template <>
+struct SeparableConvolutionPixel<RGBfColor> { typedef float Tvalue; static const int nbChannels = 3; static const bool supported = true; };
+
+/**
+ ** Separable convolution of an image (float, RGBfColor or unsigned char) using separableConvolution
+ ** @param img source image
+ ** @param horiz_k horizontal kernel (nullptr to skip the horizontal pass)
+ ** @param horizSize horizontal kernel size
+ ** @param vert_k vertical kernel (nullptr to skip the vertical pass)
+ ** @param vertSize vertical kernel size
+ ** @param out output image
+ **/
+template <typename T>
+void ImageSeparableConvolutionFast(const Image<T>& img,
+                                   const float* horiz_k, int horizSize,
+                                   const float* vert_k, int vertSize,
+                                   Image<T>& out)
+{
+  typedef SeparableConvolutionPixel<T> Traits;
+  typedef typename Traits::Tvalue Tvalue;
+  static_assert(Traits::supported, "Unsupported pixel type");
+  static_assert(sizeof(T) == Traits::nbChannels * sizeof(Tvalue), "Pixel channels must be packed");
+
+  if(&img != &out)
+    out.resize(img.Width(), img.Height(), false);
+
+  separableConvolution(reinterpret_cast<const Tvalue*>(img.data()), reinterpret_cast<Tvalue*>(out.data()),
+                       img.Width(), img.Height(), Traits::nbChannels,
+                       horiz_k, horiz_k ? horizSize : 0,
+                       vert_k, vert_k ? vertSize : 0);
+}
+
+/**
+ ** Horizontal (1d) convolution for float, RGBfColor and unsigned char images
+ ** @param img Input image
+ ** @param kernel convolution kernel
+ ** @param out Output image
+ **/
+template< typename T, typename Kernel >
+typename std::enable_if<SeparableConvolutionPixel<T>::supported>::type
+ImageHorizontalConvolution( const Image<T> & img , const Kernel & kernel , Image<T> & out)
+{
+  const Eigen::Matrix<float, Eigen::Dynamic, 1> kernelCast = kernel.template cast<float>();
+  ImageSeparableConvolutionFast(img, kernelCast.data(), static_cast<int>(kernelCast.size()), nullptr, 0, out);
+}
+
+/**
+ ** Vertical (1d) convolution for float, RGBfColor and unsigned char images
+ ** @param img Input image
+ ** @param kernel convolution kernel
+ ** @param out Output image
+ **/
+template< typename T, typename Kernel >
+typename std::enable_if<SeparableConvolutionPixel<T>::supported>::type
+ImageVerticalConvolution( const Image<T> & img , const Kernel & kernel , Image<T> & out)
+{
+  const Eigen::Matrix<float, Eigen::Dynamic, 1> kernelCast = kernel.template cast<float>();
+  ImageSeparableConvolutionFast(img, nullptr, 0, kernelCast.data(), static_cast<int>(kernelCast.size()), out);
+}
+
 /**
  ** Separable 2D convolution
  ** (nxm kernel is replaced by two 1D convolution of (size n then size m) )
@@ -196,6 +306,19 @@ void SeparableConvolution2d(const RowMatrixXf& image,
                             const Eigen::Matrix<float, 1, Eigen::Dynamic>& kernel_y,
                             RowMatrixXf* out);
 
+// Specialization for RGBfColor and unsigned char images (no intermediate image, float accumulation)
+template<typename T, typename Kernel>
+typename std::enable_if<SeparableConvolutionPixel<T>::supported && !std::is_same<T, float>::value>::type
+ImageSeparableConvolution( const Image<T> & img ,
+                           const Kernel & horiz_k ,
+                           const Kernel & vert_k ,
+                           Image<T> & out)
+{
+  const Eigen::Matrix<float, Eigen::Dynamic, 1> horiz_k_cast = horiz_k.template cast<float>();
+  const Eigen::Matrix<float, Eigen::Dynamic, 1> vert_k_cast = vert_k.template cast<float>();
+  ImageSeparableConvolutionFast(img, horiz_k_cast.data(), static_cast<int>(horiz_k_cast.size()), vert_k_cast.data(), static_cast<int>(vert_k_cast.size()), out);
+}
+
 // Specialization for Image<float> in order to use SeparableConvolution2d
 template<typename Kernel>
 void ImageSeparableConvolution( const Image<float> & img ,
@@ -49,8 +49,9 @@ void ImagePeronaMalikG2DiffusionCoef( const Image & Lx , const Image & Ly , cons
 ** @param out Output image
 ** @param row_start Row range beginning (range is [row_start ; row_end [ )
 ** @param row_end Row range end (range is [row_start ; row_end [ )
+** @tparam Accumulate if true, out = src + FED step (single pass), else out = FED step
 **/
-template< typename Image >
+template< typename Image , bool Accumulate = false >
 void ImageFEDCentral( const Image & src , const Image & diff , const typename Image::Tpixel half_t , Image & out ,
                       const int row_start , const int row_end )
 {
@@ -81,7 +82,7 @@ void ImageFEDCentral( const Image & src , const Image & diff , const typename Im
       const Real c = ( cur_diff + n_diff[2] ) * ( cur_src - n_src[2] ) ;
       const Real d = ( cur_diff + n_diff[3] ) * ( n_src[3] - cur_src ) ;
       const Real value = half_t * ( a - c + d - b ) ;
-      out( i , j ) = value ;
+      out( i , j ) = Accumulate ? cur_src + value : value ;
     }
   }
 }
@@ -92,8 +93,9 @@ void ImageFEDCentral( const Image & src , const Image & diff , const typename Im
 ** @param diff diffusion coefficient image
 ** @param half_t Half diffusion time
 ** @param out Output image
+** @tparam Accumulate if true, out = src + FED step (single pass), else out = FED step
 **/
-template< typename Image >
+template< typename Image , bool Accumulate = false >
 void ImageFEDCentralCPPThread( const Image & src , const Image & diff , const typename Image::Tpixel half_t , Image & out )
 {
   const int nb_thread = omp_get_max_threads();
@@ -105,7 +107,7 @@ void ImageFEDCentralCPPThread( const Image & src , const Image & diff , const ty
   #pragma omp parallel for schedule(dynamic)
   for( int i = 1 ; i < static_cast<int>(range.size()) ; ++i )
   {
-    ImageFEDCentral( src, diff, half_t, out, range[i-1] , range[i]) ;
+    ImageFEDCentral< Image , Accumulate >( src, diff, half_t, out, range[i-1] , range[i]) ;
   }
 }
 
@@ -115,8 +117,9 @@ void ImageFEDCentralCPPThread( const Image & src , const Image & diff , const ty
 ** @param diff diffusion coefficient image
 ** @param t diffusion time
 ** @param out output image
+** @tparam Accumulate if true, out = src + FED step (single pass), else out = FED step
 **/
-template< typename Image >
+template< typename Image , bool Accumulate = false >
 void ImageFED( const Image & src , const Image & diff , const typename Image::Tpixel t , Image & out )
 {
   typedef typename Image::Tpixel Real ;
@@ -131,7 +134,7 @@ void ImageFED( const Image & src , const Image & diff , const typename Image::Tp
   Real n_src[4] ;
 
   // Take care of the central part
-  ImageFEDCentralCPPThread( src , diff , half_t , out ) ;
+  ImageFEDCentralCPPThread< Image , Accumulate >( src , diff , half_t , out ) ;
 
   // Take care of the border
   // - first/last row
@@ -154,7 +157,7 @@ void ImageFED( const Image & src , const Image & diff , const typename Image::Tp
     const Real c = ( cur_diff + n_diff[2] ) * ( cur_src - n_src[2] ) ;
     const Real d = ( cur_diff + n_diff[3] ) * ( n_src[3] - cur_src ) ;
     const Real value = half_t * ( a - c + d ) ;
-    out( 0 , j ) = value ;
+    out( 0 , j ) = Accumulate ? cur_src + value : value ;
   }
 
   // Compute FED step on last row
@@ -174,7 +177,7 @@ void ImageFED( const Image & src , const Image & diff , const typename Image::Tp
     const Real b = ( cur_diff + n_diff[1] ) * ( cur_src - n_src[1] ) ;
     const Real c = ( cur_diff + n_diff[2] ) * ( cur_src - n_src[2] ) ;
     const Real value = half_t * ( a - c - b ) ;
-    out( height - 1 , j ) = value ;
+    out( height - 1 , j ) = Accumulate ? cur_src + value : value ;
   }
 
   // Compute FED step on first col
@@ -194,7 +197,7 @@ void ImageFED( const Image & src , const Image & diff , const typename Image::Tp
     const Real b = ( cur_diff + n_diff[1] ) * ( cur_src - n_src[1] ) ;
     const Real d = ( cur_diff + n_diff[3] ) * ( n_src[3] - cur_src ) ;
     const Real value = half_t * ( a + d - b ) ;
-    out( i , 0 ) = value ;
+    out( i , 0 ) = Accumulate ? cur_src + value : value ;
   }
 
   // Compute FED step on last col
@@ -214,7 +217,16 @@ void ImageFED( const Image & src , const Image & diff , const typename Image::Tp
     const Real c = ( cur_diff + n_diff[2] ) * ( cur_src - n_src[2] ) ;
     const Real d = ( cur_diff + n_diff[3] ) * ( n_src[3] - cur_src ) ;
     const Real value = half_t * ( - c + d - b ) ;
-    out( i , width - 1 ) = value ;
+    out( i , width - 1 ) = Accumulate ? cur_src + value : value ;
+  }
+
+  // Corners are not diffused
+  if( Accumulate )
+  {
+    out( 0 , 0 ) = src( 0 , 0 ) ;
+    out( 0 , width - 1 ) = src( 0 , width - 1 ) ;
+    out( height - 1 , 0 ) = src( height - 1 , 0 ) ;
+    out( height - 1 , width - 1 ) = src( height - 1 , width - 1 ) ;
   }
 }
 
@@ -235,6 +247,24 @@ void ImageFEDCycle( Image & self , const Image & diff , const std::vector< typen
   }
 }
 
+/**
+ ** Compute Fast Explicit Diffusion cycle without allocation
+ ** Each step is computed and accumulated in a single pass into the buffer, which is then swapped with self.
+ ** @param self input/output image
+ ** @param diff diffusion coefficient
+ ** @param tau cycle timing vector
+ ** @param buffer temporary image (reused if it already has the right size)
+ **/
+template< typename Image >
+void ImageFEDCycle( Image & self , const Image & diff , const std::vector< typename Image::Tpixel > & tau , Image & buffer )
+{
+  for( int i = 0 ; i < tau.size() ; ++i )
+  {
+    ImageFED< Image , true >( self , diff , tau[i] , buffer ) ;
+    self.swap( buffer ) ;
+  }
+}
+
 // Compute if a number is prime of not
 inline bool IsPrime( const int i )
 {
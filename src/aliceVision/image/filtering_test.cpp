@@ -135,3 +135,59 @@ BOOST_AUTO_TEST_CASE(Image_Convolution_Sobel_X_Y)
   outFilteredCast = Image<unsigned char>(outFiltered.cast<unsigned char>());
   BOOST_CHECK_NO_THROW(writeImage("out_SobelY.png", outFilteredCast, image::EImageColorSpace::NO_CONVERSION));
 }
+
+BOOST_AUTO_TEST_CASE(Image_Convolution_Separable_Reference)
+{
+  const int width = 67;
+  const int height = 45;
+
+  Image<float> in(width, height);
+  Image<RGBfColor> inRGB(width, height);
+  Image<unsigned char> inGray(width, height);
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      in(y, x) = static_cast<float>((x * 7 + y * 13) % 256);
+      inRGB(y, x) = RGBfColor(in(y, x), 255.f - in(y, x), 0.5f * in(y, x));
+      inGray(y, x) = static_cast<unsigned char>(in(y, x));
+    }
+  }
+
+  Vec kernel(5);
+  kernel << 0.1, 0.2, 0.4, 0.2, 0.1;
+
+  // reference: 2D convolution with replicated borders
+  const Mat kernel2d = kernel * kernel.transpose();
+  Image<float> reference;
+  ImageConvolution(in, kernel2d, reference);
+
+  for(const bool simd : {false, true})
+  {
+    setConvolutionSIMD(simd);
+
+    Image<float> tmp, out;
+    ImageHorizontalConvolution(in, kernel, tmp);
+    ImageVerticalConvolution(tmp, kernel, out);
+    BOOST_CHECK_SMALL((out.GetMat() - reference.GetMat()).cwiseAbs().maxCoeff(), 1e-3f);
+
+    // in-place vertical convolution
+    ImageHorizontalConvolution(in, kernel, tmp);
+    ImageVerticalConvolution(tmp, kernel, tmp);
+    BOOST_CHECK_SMALL((tmp.GetMat() - reference.GetMat()).cwiseAbs().maxCoeff(), 1e-3f);
+
+    Image<RGBfColor> outRGB;
+    ImageSeparableConvolution(inRGB, kernel, kernel, outRGB);
+    for(int y = 0; y < height; ++y)
+      for(int x = 0; x < width; ++x)
+        BOOST_CHECK_SMALL(outRGB(y, x).r() - reference(y, x), 1e-3f);
+
+    Image<unsigned char> outGray;
+    ImageSeparableConvolution(inGray, kernel, kernel, outGray);
+    for(int y = 0; y < height; ++y)
+      for(int x = 0; x < width; ++x)
+        BOOST_CHECK_LE(std::abs(outGray(y, x) - static_cast<int>(reference(y, x))), 1);
+  }
+
+  setConvolutionSIMD(true);
+}
@@ -23,6 +23,7 @@
 #include <stdexcept>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 namespace fs = boost::filesystem;
 
@@ -339,12 +340,90 @@ void readImage(const std::string& path,
   configSpec.attribute("raw:ColorSpace", "Linear"); // use linear colorspace with sRGB primaries
 #endif
 
+  const int downscale = std::max(1, imageReadOptions.downscale);
+
+  // libRAW can directly demosaic at half resolution
+  bool rawHalfSize = false;
+  if(downscale % 2 == 0)
+  {
+    // the reader is chosen from the file extension, the file is not opened
+    std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::create(path));
+    rawHalfSize = (in && std::string(in->format_name()) == "raw");
+    if(rawHalfSize)
+      configSpec.attribute("raw:HalfSize", 1);
+  }
+
   oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
 
-  inBuf.read(0, 0, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+  // downscale factor already provided by the decoder
+  int decodedScale = 1;
 
-  if(!inBuf.initialized())
-    ALICEVISION_THROW_ERROR("Failed to open the image file: '" << path << "'.");
+  if(downscale > 1)
+  {
+    if(rawHalfSize)
+      decodedScale = 2;
+
+    // use the finest mip level (EXR, TIFF) matching the requested downscale
+    int miplevel = 0;
+    while(miplevel + 1 < inBuf.nmiplevels() && downscale % (decodedScale << (miplevel + 1)) == 0)
+      ++miplevel;
+
+    if(miplevel > 0)
+    {
+      inBuf.reset(path, 0, miplevel, NULL, &configSpec);
+      decodedScale <<= miplevel;
+    }
+  }
+
+  if(imageReadOptions.subROI.defined())
+  {
+    // subROI is expressed in full resolution, relative to the image data window
+    const oiio::ImageSpec& fileSpec = inBuf.spec();
+    oiio::ROI roi = imageReadOptions.subROI;
+    roi.xbegin = fileSpec.x + roi.xbegin / decodedScale;
+    roi.xend = fileSpec.x + (roi.xend + decodedScale - 1) / decodedScale;
+    roi.ybegin = fileSpec.y + roi.ybegin / decodedScale;
+    roi.yend = fileSpec.y + (roi.yend + decodedScale - 1) / decodedScale;
+    roi.chbegin = 0;
+    roi.chend = fileSpec.nchannels;
+    roi = oiio::roi_intersection(roi, inBuf.roi());
+
+    if(roi.npixels() == 0)
+      ALICEVISION_THROW_ERROR("Region of interest is outside of the image file: '" << path << "'.");
+
+    // the input buffer is not read explicitly: pixels are pulled through the image cache,
+    // so tiled files (EXR, TIFF) only decode the tiles intersecting the region of interest
+    oiio::ImageBuf roiBuf(oiio::ImageSpec(roi.width(), roi.height(), roi.nchannels(), oiio::TypeDesc::FLOAT));
+    if(!oiio::ImageBufAlgo::paste(roiBuf, 0, 0, 0, 0, inBuf, roi))
+      ALICEVISION_THROW_ERROR("Failed to read the region of interest of the image file: '" << path << "'.");
+
+    roiBuf.specmod().extra_attribs = fileSpec.extra_attribs;
+    inBuf.swap(roiBuf);
+  }
+  else
+  {
+    inBuf.read(0, inBuf.miplevel(), true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+
+    if(!inBuf.initialized())
+      ALICEVISION_THROW_ERROR("Failed to open the image file: '" << path << "'.");
+  }
+
+  // remaining downscale not handled by the decoder
+  const int residualScale = downscale / decodedScale;
+
+  if(residualScale > 1)
+  {
+    // box filtering before the color conversion and channels manipulations,
+    // so they are only applied on the output resolution
+    const oiio::ImageSpec& fullSpec = inBuf.spec();
+    const oiio::ROI downscaledROI(0, std::max(1, fullSpec.width / residualScale),
+                                  0, std::max(1, fullSpec.height / residualScale),
+                                  0, 1, 0, fullSpec.nchannels);
+    oiio::ImageBuf downscaledBuf(oiio::ImageSpec(downscaledROI, oiio::TypeDesc::FLOAT));
+    oiio::ImageBufAlgo::resize(downscaledBuf, inBuf, "box", float(residualScale), downscaledROI);
+    downscaledBuf.specmod().extra_attribs = fullSpec.extra_attribs;
+    inBuf.swap(downscaledBuf);
+  }
 
   // check picture channels number
   if(inBuf.spec().nchannels != 1 && inBuf.spec().nchannels < 3)
@@ -57,8 +57,8 @@ enum class EImageFileType
  */
 struct ImageReadOptions
 {  
-  ImageReadOptions(EImageColorSpace colorSpace = EImageColorSpace::AUTO, bool useWhiteBalance = true, const oiio::ROI & roi = oiio::ROI()) :
-  outputColorSpace(colorSpace), applyWhiteBalance(useWhiteBalance), subROI(roi)
+  ImageReadOptions(EImageColorSpace colorSpace = EImageColorSpace::AUTO, bool useWhiteBalance = true, const oiio::ROI & roi = oiio::ROI(), int downscaleFactor = 1) :
+  outputColorSpace(colorSpace), applyWhiteBalance(useWhiteBalance), subROI(roi), downscale(downscaleFactor)
   {
   }
 
@@ -67,7 +67,13 @@ struct ImageReadOptions
 
   //ROI for this image.
   //If the image contains an roi, this is the roi INSIDE the roi.
+  //Expressed in full resolution pixels, even if a downscale is requested.
   oiio::ROI subROI;
+
+  //Integer downscale factor applied at decoding time (1 means full resolution).
+  //Format-native reduced decoding is used when available (RAW half size, EXR/TIFF mip levels),
+  //the remaining factor is applied with a box filter before the color conversion.
+  int downscale;
 };
 
 
@@ -258,3 +258,46 @@ BOOST_AUTO_TEST_CASE(read_write_from_grayscale_to_rgb) {
     remove(filename.c_str());
   }
 }
+
+BOOST_AUTO_TEST_CASE(read_downscale) {
+  Image<float> image(8, 6);
+  for(int y = 0; y < image.Height(); ++y)
+    for(int x = 0; x < image.Width(); ++x)
+      image(y, x) = (x / 2 + y / 2) * 0.1f;
+
+  for(const auto& extension : {"png", "tiff", "exr"})
+  {
+    const std::string filename = std::string("test_read_downscale.") + extension;
+    BOOST_CHECK_NO_THROW(writeImage(filename, image, image::EImageColorSpace::NO_CONVERSION));
+
+    Image<float> read_image;
+    ImageReadOptions options(image::EImageColorSpace::NO_CONVERSION);
+    options.downscale = 2;
+    BOOST_CHECK_NO_THROW(readImage(filename, read_image, options));
+    BOOST_CHECK_EQUAL(4, read_image.Width());
+    BOOST_CHECK_EQUAL(3, read_image.Height());
+    BOOST_CHECK_CLOSE(read_image(1, 2), image(2, 4), 1.0);
+    BOOST_CHECK_CLOSE(read_image(2, 3), image(4, 6), 1.0);
+    remove(filename.c_str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(read_roi) {
+  Image<float> image(8, 6);
+  for(int y = 0; y < image.Height(); ++y)
+    for(int x = 0; x < image.Width(); ++x)
+      image(y, x) = (x + y * image.Width()) / 64.f;
+
+  const std::string filename = "test_read_roi.exr";
+  BOOST_CHECK_NO_THROW(writeImage(filename, image, image::EImageColorSpace::NO_CONVERSION));
+
+  Image<float> read_image;
+  ImageReadOptions options(image::EImageColorSpace::NO_CONVERSION);
+  options.subROI = oiio::ROI(2, 6, 1, 4);
+  BOOST_CHECK_NO_THROW(readImage(filename, read_image, options));
+  BOOST_CHECK_EQUAL(4, read_image.Width());
+  BOOST_CHECK_EQUAL(3, read_image.Height());
+  BOOST_CHECK_EQUAL(read_image(0, 0), image(1, 2));
+  BOOST_CHECK_EQUAL(read_image(2, 3), image(3, 5));
+  remove(filename.c_str());
+}
@@ -16,6 +16,9 @@
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 
+#include <cassert>
+#include <type_traits>
+
 namespace oiio = OIIO;
 
 namespace aliceVision {
@@ -25,30 +28,96 @@ namespace image {
    ** Half sample an image (ie reduce its size by a factor 2) using bilinear interpolation
    ** @param src input image
    ** @param out output image
+   ** @note The bilinear sample at the center of each 2x2 block falls exactly on the pixel (2i+1, 2j+1),
+   **       so it is computed as a strided copy.
    **/
   template < typename Image >
   void ImageHalfSample( const Image & src , Image & out )
   {
+    typedef typename Image::Tpixel pix_t;
+
     const int new_width  = src.Width() / 2 ;
     const int new_height = src.Height() / 2 ;
 
-    out.resize( new_width , new_height ) ;
+    out.resize( new_width , new_height, false ) ;
 
-    const Sampler2d<SamplerLinear> sampler;
+    const int src_width = src.Width();
 
+    #pragma omp parallel for if(new_width * new_height >= 512 * 512)
     for( int i = 0 ; i < new_height ; ++i )
     {
+      const pix_t* src_row = src.data() + static_cast<std::size_t>(2 * i + 1) * src_width + 1;
+      pix_t* out_row = out.data() + static_cast<std::size_t>(i) * new_width;
       for( int j = 0 ; j < new_width ; ++j )
       {
-        // Use .5f offset to ensure mid pixel and correct bilinear sampling
-        out( i , j ) =  sampler( src, 2.f * (i+.5f), 2.f * (j+.5f) );
+        out_row[ j ] = src_row[ 2 * j ];
       }
     }
   }
 
+  /**
+   ** Downscale an image by an integer factor using bilinear interpolation at the center of each block
+   ** Equivalent to downscaleImage<SamplerLinear> for downscale >= 2:
+   ** - even factor: the sample falls exactly on a pixel
+   ** - odd factor: the sample is the mean of the 2x2 pixels around the block center
+   ** @param src input image
+   ** @param out output image
+   ** @param downscale downscale factor (>= 2)
+   **/
+  template <typename Image>
+  void downscaleImageLinear(const Image& src, Image& out, int downscale)
+  {
+      typedef typename Image::Tpixel pix_t;
+      typedef RealPixel<pix_t> real_pix_t;
+
+      assert(downscale >= 2);
+
+      const int new_width = src.Width() / downscale;
+      const int new_height = src.Height() / downscale;
+
+      out.resize(new_width, new_height, false);
+
+      const int offset = (downscale - 1) / 2;
+      const bool isOdd = (downscale % 2) != 0;
+
+      #pragma omp parallel for if(new_width * new_height >= 512 * 512)
+      for(int i = 0; i < new_height; ++i)
+      {
+          const int y = downscale * i + (isOdd ? offset : downscale / 2);
+          const pix_t* row0 = src.data() + static_cast<std::size_t>(y) * src.Width();
+          pix_t* out_row = out.data() + static_cast<std::size_t>(i) * new_width;
+
+          if(!isOdd)
+          {
+              for(int j = 0; j < new_width; ++j)
+                  out_row[j] = row0[downscale * j + downscale / 2];
+              continue;
+          }
+
+          const pix_t* row1 = row0 + src.Width();
+          for(int j = 0; j < new_width; ++j)
+          {
+              const int x = downscale * j + offset;
+              // same accumulation order as Sampler2d<SamplerLinear>
+              auto res = real_pix_t::zero();
+              res += real_pix_t::convert_to_real(row0[x]) * 0.25;
+              res += real_pix_t::convert_to_real(row0[x + 1]) * 0.25;
+              res += real_pix_t::convert_to_real(row1[x]) * 0.25;
+              res += real_pix_t::convert_to_real(row1[x + 1]) * 0.25;
+              out_row[j] = real_pix_t::convert_from_real(res);
+          }
+      }
+  }
+
   template <typename SamplerType, typename Image>
   void downscaleImage(const Image& src, Image& out, int downscale)
   {
+      if(std::is_same<SamplerType, SamplerLinear>::value && downscale >= 2)
+      {
+          downscaleImageLinear(src, out, downscale);
+          return;
+      }
+
       const int new_width = src.Width() / downscale;
       const int new_height = src.Height() / downscale;
 
@@ -123,3 +123,33 @@ BOOST_AUTO_TEST_CASE(Ressampling_SampleRotate)
   BOOST_CHECK_NO_THROW(ImageRotation(image, Sampler2d< SamplerSpline16 >(), "SamplerSpline16"));
   BOOST_CHECK_NO_THROW(ImageRotation(image, Sampler2d< SamplerSpline64 >(), "SamplerSpline64"));
 }
+
+BOOST_AUTO_TEST_CASE(Ressampling_HalfSampleAndDownscale)
+{
+  Image<float> image(101, 77);
+  for(int y = 0; y < image.Height(); ++y)
+    for(int x = 0; x < image.Width(); ++x)
+      image(y, x) = static_cast<float>((x * 31 + y * 17) % 255);
+
+  const Sampler2d<SamplerLinear> sampler;
+
+  Image<float> halfSampled;
+  ImageHalfSample(image, halfSampled);
+  BOOST_CHECK_EQUAL(halfSampled.Width(), 50);
+  BOOST_CHECK_EQUAL(halfSampled.Height(), 38);
+  for(int i = 0; i < halfSampled.Height(); ++i)
+    for(int j = 0; j < halfSampled.Width(); ++j)
+      BOOST_CHECK_EQUAL(halfSampled(i, j), sampler(image, 2.f * (i + .5f), 2.f * (j + .5f)));
+
+  // even and odd factors
+  for(int downscale = 2; downscale <= 5; ++downscale)
+  {
+    Image<float> downscaled;
+    downscaleImage<SamplerLinear>(image, downscaled, downscale);
+    BOOST_CHECK_EQUAL(downscaled.Width(), image.Width() / downscale);
+    BOOST_CHECK_EQUAL(downscaled.Height(), image.Height() / downscale);
+    for(int i = 0; i < downscaled.Height(); ++i)
+      for(int j = 0; j < downscaled.Width(); ++j)
+        BOOST_CHECK_EQUAL(downscaled(i, j), sampler(image, downscale * (i + .5f), downscale * (j + .5f)));
+  }
+}
@@ -0,0 +1,127 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief This class implements a thread-safe bounded queue, used to connect the
+ * stages of a pipeline. When the queue is full, push() either waits for an element
+ * to be popped or, if the queue drops elements, removes the oldest element (FIFO
+ * strategy, as BoundedBuffer) to make place for the new one.
+ */
+template<class T>
+class BoundedQueue
+{
+public:
+
+  /**
+   * @brief Build a bounded queue of the given size.
+   * @param[in] maxSize The maximum number of elements in the queue.
+   * @param[in] dropWhenFull If true, pushing into a full queue removes its oldest
+   * element, otherwise it waits for an element to be popped.
+   */
+  BoundedQueue(std::size_t maxSize, bool dropWhenFull)
+    : _maxSize(maxSize)
+    , _dropWhenFull(dropWhenFull)
+  {}
+
+  /**
+   * @brief Add a new element at the end of the queue.
+   * @param[in] element The element to add.
+   * @return false if the queue is closed, the element is not added.
+   */
+  bool push(T element)
+  {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+
+      if(!_dropWhenFull)
+        _notFull.wait(lock, [this] { return _closed || _queue.size() < _maxSize; });
+
+      if(_closed)
+        return false;
+
+      if(_queue.size() == _maxSize)
+      {
+        _queue.pop_front();
+        ++_nbDropped;
+      }
+      _queue.push_back(std::move(element));
+    }
+    _notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Remove the first element of the queue, wait for an element if the queue is empty.
+   * @param[out] element The removed element.
+   * @return false if the queue is closed and empty.
+   */
+  bool pop(T& element)
+  {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _notEmpty.wait(lock, [this] { return _closed || !_queue.empty(); });
+
+      if(_queue.empty())
+        return false;
+
+      element = std::move(_queue.front());
+      _queue.pop_front();
+    }
+    _notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Close the queue: no element can be added anymore, and pop() returns
+   * false once the remaining elements have been removed.
+   */
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _closed = true;
+    }
+    _notEmpty.notify_all();
+    _notFull.notify_all();
+  }
+
+  /**
+   * @brief Return the number of elements removed to make place for new ones.
+   * @return the number of dropped elements
+   */
+  std::size_t nbDropped() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nbDropped;
+  }
+
+private:
+
+  std::deque<T> _queue;
+  /// The fixed maximum size for the queue
+  std::size_t _maxSize;
+  /// Whether the oldest element is removed when pushing into a full queue
+  bool _dropWhenFull;
+  bool _closed = false;
+  std::size_t _nbDropped = 0;
+
+  mutable std::mutex _mutex;
+  std::condition_variable _notEmpty;
+  std::condition_variable _notFull;
+};
+
+} // namespace localization
+} // namespace aliceVision
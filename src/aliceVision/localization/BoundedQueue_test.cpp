@@ -0,0 +1,62 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "BoundedQueue.hpp"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE BoundedQueue
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision::localization;
+
+BOOST_AUTO_TEST_CASE(BoundedQueue_dropOldest)
+{
+  BoundedQueue<std::unique_ptr<int>> queue(2, true);
+
+  for(int i = 0; i < 5; ++i)
+    BOOST_CHECK(queue.push(std::unique_ptr<int>(new int(i))));
+  BOOST_CHECK_EQUAL(queue.nbDropped(), 3);
+
+  queue.close();
+  BOOST_CHECK(!queue.push(std::unique_ptr<int>(new int(5))));
+
+  // only the most recent elements remain, in order
+  std::unique_ptr<int> element;
+  BOOST_CHECK(queue.pop(element));
+  BOOST_CHECK_EQUAL(*element, 3);
+  BOOST_CHECK(queue.pop(element));
+  BOOST_CHECK_EQUAL(*element, 4);
+  BOOST_CHECK(!queue.pop(element));
+}
+
+BOOST_AUTO_TEST_CASE(BoundedQueue_producerConsumer)
+{
+  const int nbElements = 10000;
+  BoundedQueue<int> queue(4, false);
+
+  std::thread producer([&queue]()
+  {
+    for(int i = 0; i < nbElements; ++i)
+      queue.push(i);
+    queue.close();
+  });
+
+  // without dropping, every element is received in order
+  std::vector<int> received;
+  int element;
+  while(queue.pop(element))
+    received.push_back(element);
+  producer.join();
+
+  BOOST_CHECK_EQUAL(queue.nbDropped(), 0);
+  BOOST_REQUIRE_EQUAL(received.size(), nbElements);
+  for(int i = 0; i < nbElements; ++i)
+    BOOST_CHECK_EQUAL(received[i], i);
+}
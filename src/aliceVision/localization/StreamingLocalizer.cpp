@@ -0,0 +1,200 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "StreamingLocalizer.hpp"
+#include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief A frame going through the stages of the streaming localizer
+ */
+struct StreamingLocalizer::Frame
+{
+  std::size_t frameId = 0;
+  std::string imagePath;
+  std::mt19937 randomNumberGenerator;
+
+  // decode
+  image::Image<float> imageGrey;
+  camera::PinholeRadialK3 intrinsics;
+  bool hasIntrinsics = false;
+  std::pair<std::size_t, std::size_t> imageSize;
+  // extraction
+  feature::MapRegionsPerDesc regions;
+  // retrieval
+  bool isRetrieved = false;
+  std::vector<voctree::DocMatch> matchedImages;
+  // matching
+  OccurenceMap occurences;
+  sfm::ImageLocalizerMatchData resectionData;
+};
+
+namespace {
+
+template<class PipelineParameters>
+PipelineParameters makePipelineParameters(const StreamingLocalizer::Parameters& param)
+{
+  PipelineParameters pipelineParam;
+  pipelineParam.queueSize = param.queueSize;
+  pipelineParam.dropElements = param.dropFrames;
+  pipelineParam.maxLatency = param.maxLatency;
+  pipelineParam.rate = param.frameRate;
+  return pipelineParam;
+}
+
+} // namespace
+
+StreamingLocalizer::StreamingLocalizer(VoctreeLocalizer& localizer,
+                                       const VoctreeLocalizer::Parameters& localizerParam,
+                                       const Parameters& param)
+  : _localizer(localizer)
+  , _localizerParam(localizerParam)
+  , _param(param)
+  , _pipeline(makePipelineParameters<Pipeline::Parameters>(param),
+              {EStage_enumToString(DECODE),
+               EStage_enumToString(EXTRACTION),
+               EStage_enumToString(RETRIEVAL),
+               EStage_enumToString(MATCHING),
+               EStage_enumToString(RESECTION)})
+{
+  if(_localizerParam._algorithm != VoctreeLocalizer::Algorithm::AllResults)
+    throw std::invalid_argument("The streaming localizer only supports the AllResults algorithm.");
+}
+
+std::size_t StreamingLocalizer::run(const FrameSource& source, const ResultCallback& callback, std::mt19937::result_type seed)
+{
+  std::mutex callbackMutex;
+
+  // feature extraction, with image describers owned by each thread
+  _pipeline.setStage(EXTRACTION, _param.nbExtractionThreads, [this]()
+  {
+    auto imageDescribers = std::make_shared<std::vector<std::unique_ptr<feature::ImageDescriber>>>();
+    for(const auto& imageDescriber : _localizer._imageDescribers)
+      imageDescribers->push_back(feature::createImageDescriber(imageDescriber->getDescriberType()));
+
+    return [this, imageDescribers](Frame& frame)
+    {
+      VoctreeLocalizer::extractFeatures(*imageDescribers, frame.imageGrey, _localizerParam._featurePreset, _localizer._cudaPipe, frame.regions);
+      frame.imageSize = std::make_pair(frame.imageGrey.Width(), frame.imageGrey.Height());
+      frame.imageGrey = image::Image<float>(); // the image is not needed anymore
+    };
+  });
+
+  // vocabulary tree query
+  _pipeline.setStage(RETRIEVAL, _param.nbRetrievalThreads, [this]()
+  {
+    return [this](Frame& frame)
+    {
+      frame.isRetrieved = _localizer.retrieveImages(frame.regions, _localizerParam, frame.matchedImages);
+    };
+  });
+
+  // matching with the retrieved images and the frame buffer
+  _pipeline.setStage(MATCHING, _param.nbMatchingThreads, [this]()
+  {
+    return [this](Frame& frame)
+    {
+      if(!frame.isRetrieved)
+        return;
+      _localizer.getAssociations(frame.regions,
+                                 frame.imageSize,
+                                 _localizerParam,
+                                 frame.randomNumberGenerator,
+                                 frame.hasIntrinsics,
+                                 frame.intrinsics,
+                                 frame.matchedImages,
+                                 frame.occurences,
+                                 frame.resectionData.pt2D,
+                                 frame.resectionData.pt3D,
+                                 frame.resectionData.vec_descType,
+                                 frame.imagePath);
+    };
+  });
+
+  // pose estimation and refinement
+  _pipeline.setStage(RESECTION, _param.nbResectionThreads, [this, &callback, &callbackMutex]()
+  {
+    return [this, &callback, &callbackMutex](Frame& frame)
+    {
+      LocalizationResult localizationResult;
+      _localizer.localizeFromAssociations(frame.regions,
+                                          frame.imageSize,
+                                          _localizerParam,
+                                          frame.randomNumberGenerator,
+                                          frame.hasIntrinsics,
+                                          frame.intrinsics,
+                                          frame.occurences,
+                                          frame.resectionData,
+                                          frame.matchedImages,
+                                          localizationResult,
+                                          frame.imagePath);
+
+      std::lock_guard<std::mutex> lock(callbackMutex);
+      callback(frame.frameId, frame.imagePath, localizationResult);
+    };
+  });
+
+  // decode the frames on the calling thread
+  return _pipeline.run([&source, seed](std::size_t frameId, Frame& frame)
+  {
+    if(!source(frame.imageGrey, frame.intrinsics, frame.imagePath, frame.hasIntrinsics))
+      return false;
+    frame.frameId = frameId;
+    frame.randomNumberGenerator.seed(seed + frameId);
+    return true;
+  });
+}
+
+void StreamingLocalizer::printStatistics() const
+{
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(1);
+  os << "Streaming localization latencies [ms] (p50 / p90 / p99 / max):" << std::endl;
+
+  const auto printLatencies = [&os](const std::string& name, const LatencyStatistics& latencies)
+  {
+    os << "\t- " << name << ": " << latencies.count() << " frames, "
+       << 1000.0 * latencies.percentile(50) << " / "
+       << 1000.0 * latencies.percentile(90) << " / "
+       << 1000.0 * latencies.percentile(99) << " / "
+       << 1000.0 * latencies.percentile(100);
+  };
+
+  for(int stage = 0; stage < NB_STAGES; ++stage)
+  {
+    printLatencies(EStage_enumToString(static_cast<EStage>(stage)), _pipeline.getStageStatistics(stage));
+    os << ", " << _pipeline.getNbDropped(stage) << " dropped" << std::endl;
+  }
+  printLatencies("end-to-end", _pipeline.getLatencyStatistics());
+
+  ALICEVISION_LOG_INFO(os.str());
+}
+
+std::string EStage_enumToString(StreamingLocalizer::EStage stage)
+{
+  switch(stage)
+  {
+    case StreamingLocalizer::DECODE:     return "decode";
+    case StreamingLocalizer::EXTRACTION: return "extraction";
+    case StreamingLocalizer::RETRIEVAL:  return "retrieval";
+    case StreamingLocalizer::MATCHING:   return "matching";
+    case StreamingLocalizer::RESECTION:  return "resection";
+    case StreamingLocalizer::NB_STAGES:  break;
+  }
+  throw std::out_of_range("Invalid streaming localizer stage: " + std::to_string(int(stage)));
+}
+
+} // namespace localization
+} // namespace aliceVision
@@ -0,0 +1,133 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/localization/VoctreeLocalizer.hpp>
+#include <aliceVision/localization/LocalizationResult.hpp>
+#include <aliceVision/localization/StreamingPipeline.hpp>
+#include <aliceVision/camera/PinholeRadial.hpp>
+#include <aliceVision/image/Image.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief Localize a stream of frames with a VoctreeLocalizer (AllResults algorithm).
+ *
+ * The localization is split into a pipeline of stages: decode, feature extraction,
+ * retrieval (vocabulary tree query), matching (2D-3D associations) and resection
+ * (pose estimation and refinement). Each stage runs on its own threads and the
+ * stages are connected by bounded queues, so that several frames are processed
+ * at the same time (see StreamingPipeline).
+ */
+class StreamingLocalizer
+{
+public:
+
+  enum EStage : int {DECODE = 0, EXTRACTION, RETRIEVAL, MATCHING, RESECTION, NB_STAGES};
+
+  struct Parameters
+  {
+    /// number of threads of each stage (the decode stage always uses one thread)
+    std::size_t nbExtractionThreads = 2;
+    std::size_t nbRetrievalThreads = 1;
+    std::size_t nbMatchingThreads = 2;
+    std::size_t nbResectionThreads = 1;
+    /// maximum number of frames waiting between two stages
+    std::size_t queueSize = 2;
+    /// drop frames under overload instead of waiting for the next stages (live feeds only:
+    /// the dropped frames have no pose)
+    bool dropFrames = false;
+    /// in seconds, frames older than that are dropped (0 = no limit), only if dropFrames is set
+    double maxLatency = 0.0;
+    /// rate of the frames read from the source, to simulate a live feed (0 = as fast as possible)
+    double frameRate = 0.0;
+  };
+
+  /**
+   * @brief Read the next frame.
+   * Same parameters as dataio::FeedProvider::readImage, it returns false at the end of the stream.
+   */
+  using FrameSource = std::function<bool(image::Image<float>& imageGrey,
+                                         camera::PinholeRadialK3& intrinsics,
+                                         std::string& imagePath,
+                                         bool& hasIntrinsics)>;
+
+  /**
+   * @brief Receive the result of a frame, called from the resection threads but never concurrently.
+   * The results are received in the order of completion, which may differ from the order of the frames.
+   */
+  using ResultCallback = std::function<void(std::size_t frameId,
+                                            const std::string& imagePath,
+                                            const LocalizationResult& localizationResult)>;
+
+  /**
+   * @brief Build a streaming localizer.
+   * @param[in] localizer The initialized localizer, it must outlive the streaming localizer.
+   * @param[in] localizerParam The parameters of the localization, with the AllResults algorithm.
+   * @param[in] param The parameters of the pipeline.
+   */
+  StreamingLocalizer(VoctreeLocalizer& localizer,
+                     const VoctreeLocalizer::Parameters& localizerParam,
+                     const Parameters& param);
+
+  /**
+   * @brief Localize all the frames of the source.
+   * @param[in] source The frames to localize.
+   * @param[in] callback The function receiving the results of the localized frames,
+   * the dropped frames have no result.
+   * @param[in] seed The seed of the random generators, each frame has its own generator.
+   * @return the number of frames read from the source
+   * @note the statistics are reset at the beginning of each run.
+   * @note if the source throws, the pipeline is stopped and the error is rethrown.
+   */
+  std::size_t run(const FrameSource& source, const ResultCallback& callback, std::mt19937::result_type seed);
+
+  /**
+   * @brief Return the processing time statistics of a stage.
+   */
+  const LatencyStatistics& getStageStatistics(EStage stage) const { return _pipeline.getStageStatistics(stage); }
+
+  /**
+   * @brief Return the statistics of the latency between the decode and the result of the frames.
+   */
+  const LatencyStatistics& getLatencyStatistics() const { return _pipeline.getLatencyStatistics(); }
+
+  /**
+   * @brief Return the number of frames dropped before a stage.
+   */
+  std::size_t getNbDroppedFrames(EStage stage) const { return _pipeline.getNbDropped(stage); }
+
+  /**
+   * @brief Log the latency percentiles of each stage and the number of dropped frames.
+   */
+  void printStatistics() const;
+
+private:
+  struct Frame;
+  using Pipeline = StreamingPipeline<Frame, NB_STAGES>;
+
+  VoctreeLocalizer& _localizer;
+  const VoctreeLocalizer::Parameters _localizerParam;
+  const Parameters _param;
+
+  Pipeline _pipeline;
+};
+
+/**
+ * @brief Get the name of a stage of the streaming localizer
+ */
+std::string EStage_enumToString(StreamingLocalizer::EStage stage);
+
+} // namespace localization
+} // namespace aliceVision
@@ -0,0 +1,51 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "StreamingPipeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace aliceVision {
+namespace localization {
+
+void LatencyStatistics::add(double latency)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _latencies.push_back(latency);
+}
+
+void LatencyStatistics::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _latencies.clear();
+}
+
+std::size_t LatencyStatistics::count() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _latencies.size();
+}
+
+double LatencyStatistics::percentile(double percent) const
+{
+  std::vector<double> latencies;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    latencies = _latencies;
+  }
+  if(latencies.empty())
+    return 0.0;
+
+  // nearest-rank percentile
+  const double rank = std::ceil(std::min(std::max(percent, 0.0), 100.0) / 100.0 * latencies.size());
+  const std::size_t index = std::max<std::size_t>(1, static_cast<std::size_t>(rank)) - 1;
+  std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+  return latencies[index];
+}
+
+} // namespace localization
+} // namespace aliceVision
@@ -0,0 +1,293 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/localization/BoundedQueue.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aliceVision {
+namespace localization {
+
+/**
+ * @brief Thread-safe collection of latencies, to compute their percentiles.
+ */
+class LatencyStatistics
+{
+public:
+
+  /**
+   * @brief Add a latency.
+   * @param[in] latency The latency in seconds.
+   */
+  void add(double latency);
+
+  /**
+   * @brief Remove all the latencies.
+   */
+  void clear();
+
+  /**
+   * @brief Return the number of latencies.
+   */
+  std::size_t count() const;
+
+  /**
+   * @brief Return a percentile of the latencies.
+   * @param[in] percent The percentile, in [0, 100].
+   * @return the latency in seconds, 0 if there is no latency.
+   */
+  double percentile(double percent) const;
+
+private:
+  mutable std::mutex _mutex;
+  std::vector<double> _latencies;
+};
+
+/**
+ * @brief A pipeline of stages connected by bounded queues.
+ *
+ * The elements are read on the calling thread (stage 0), then go through the
+ * processing stages [1, NbStages) in order, each stage running on its own threads.
+ *
+ * When dropping elements is enabled (live feeds), a stage never waits for the next
+ * one: the oldest element of a full queue is dropped, as well as the elements older
+ * than the maximum latency, so that the pipeline always works on the most recent elements.
+ */
+template<class T, int NbStages>
+class StreamingPipeline
+{
+public:
+
+  struct Parameters
+  {
+    /// maximum number of elements waiting between two stages
+    std::size_t queueSize = 2;
+    /// drop elements under overload instead of waiting for the next stages
+    bool dropElements = true;
+    /// in seconds, elements older than that are dropped (0 = no limit), only if dropElements is set
+    double maxLatency = 0.5;
+    /// rate of the elements read, to simulate a live feed (0 = as fast as possible)
+    double rate = 0.0;
+  };
+
+  /// process an element in a stage
+  using ProcessFunction = std::function<void(T& element)>;
+  /// build the processing function of a thread of a stage, called on the calling thread of run()
+  using MakeProcessFunction = std::function<ProcessFunction()>;
+  /// read the next element, return false at the end of the stream
+  using ReadFunction = std::function<bool(std::size_t elementId, T& element)>;
+
+  /**
+   * @brief Build a pipeline.
+   * @param[in] param The parameters of the pipeline.
+   * @param[in] stageNames The names of the stages, for the logs.
+   */
+  StreamingPipeline(const Parameters& param, const std::array<std::string, NbStages>& stageNames)
+    : _param(param)
+    , _stageNames(stageNames)
+  {
+    for(auto& nbDropped : _nbDropped)
+      nbDropped = 0;
+  }
+
+  /**
+   * @brief Set a processing stage.
+   * @param[in] stage The stage, in [1, NbStages).
+   * @param[in] nbThreads The number of threads of the stage.
+   * @param[in] makeProcess Build the processing function of each thread of the stage.
+   */
+  void setStage(int stage, std::size_t nbThreads, const MakeProcessFunction& makeProcess)
+  {
+    if(stage < 1 || stage >= NbStages)
+      throw std::out_of_range("Invalid processing stage: " + std::to_string(stage));
+    _stages[stage].nbThreads = std::max<std::size_t>(1, nbThreads);
+    _stages[stage].makeProcess = makeProcess;
+  }
+
+  /**
+   * @brief Read all the elements and process them through the stages.
+   * If an error occurs on the calling thread (read or processing functions creation),
+   * all the stages are stopped and the error is rethrown once the threads are joined.
+   * The errors of the processing functions are logged and the element is discarded.
+   * @param[in] read The function reading the elements.
+   * @return the number of elements read
+   * @note the statistics are reset at the beginning of each run.
+   */
+  std::size_t run(const ReadFunction& read)
+  {
+    using ElementPtr = std::unique_ptr<Element>;
+    using ElementQueue = BoundedQueue<ElementPtr>;
+
+    for(int stage = 0; stage < NbStages; ++stage)
+    {
+      _stageLatencies[stage].clear();
+      _nbDropped[stage] = 0;
+    }
+    _latencies.clear();
+
+    // the input queue of each stage, except the read stage
+    std::array<std::unique_ptr<ElementQueue>, NbStages> queues;
+    for(int stage = 1; stage < NbStages; ++stage)
+      queues[stage].reset(new ElementQueue(std::max<std::size_t>(1, _param.queueSize), _param.dropElements));
+
+    std::vector<std::thread> threads;
+    std::array<std::atomic<std::size_t>, NbStages> nbRunningThreads;
+
+    const auto joinThreads = [&]()
+    {
+      for(std::thread& thread : threads)
+        thread.join();
+      for(int stage = 1; stage < NbStages; ++stage)
+        _nbDropped[stage] += queues[stage]->nbDropped();
+    };
+
+    std::size_t nbElements = 0;
+    try
+    {
+      // start the processing stages,
+      // the last thread of a stage to finish closes the input queue of the next stage
+      for(int stage = 1; stage < NbStages; ++stage)
+      {
+        if(!_stages[stage].makeProcess)
+          throw std::logic_error("The processing stage " + _stageNames[stage] + " is not set.");
+
+        nbRunningThreads[stage] = _stages[stage].nbThreads;
+        for(std::size_t t = 0; t < _stages[stage].nbThreads; ++t)
+        {
+          const ProcessFunction process = _stages[stage].makeProcess();
+          threads.emplace_back([this, &queues, &nbRunningThreads, stage, process]()
+          {
+            ElementQueue& input = *queues[stage];
+            ElementPtr element;
+
+            while(input.pop(element))
+            {
+              // under overload, give the priority to the most recent elements
+              if(_param.dropElements && _param.maxLatency > 0.0 && elapsedSince(element->readTime) > _param.maxLatency)
+              {
+                ++_nbDropped[stage];
+                continue;
+              }
+
+              const system::Timer timer;
+              try
+              {
+                process(element->data);
+              }
+              catch(const std::exception& e)
+              {
+                ALICEVISION_LOG_ERROR("[streaming]\tElement " << element->id << ": " << _stageNames[stage] << " failed: " << e.what());
+                continue;
+              }
+              _stageLatencies[stage].add(timer.elapsed());
+
+              if(stage + 1 < NbStages)
+                queues[stage + 1]->push(std::move(element));
+              else
+                _latencies.add(elapsedSince(element->readTime));
+            }
+
+            if(--nbRunningThreads[stage] == 0 && stage + 1 < NbStages)
+              queues[stage + 1]->close();
+          });
+        }
+      }
+
+      // read the elements on the calling thread
+      const auto start = std::chrono::steady_clock::now();
+      while(true)
+      {
+        if(_param.rate > 0.0)
+          std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(nbElements / _param.rate)));
+
+        ElementPtr element(new Element);
+        element->id = nbElements;
+        element->readTime = std::chrono::steady_clock::now();
+        if(!read(element->id, element->data))
+          break;
+
+        ++nbElements;
+        _stageLatencies[0].add(elapsedSince(element->readTime));
+
+        queues[1]->push(std::move(element));
+      }
+    }
+    catch(...)
+    {
+      // stop all the stages, the queued elements are discarded
+      for(int stage = 1; stage < NbStages; ++stage)
+        queues[stage]->close();
+      joinThreads();
+      throw;
+    }
+
+    queues[1]->close();
+    joinThreads();
+
+    return nbElements;
+  }
+
+  /**
+   * @brief Return the processing time statistics of a stage.
+   */
+  const LatencyStatistics& getStageStatistics(int stage) const { return _stageLatencies.at(stage); }
+
+  /**
+   * @brief Return the statistics of the latency between the read and the end of the last stage.
+   */
+  const LatencyStatistics& getLatencyStatistics() const { return _latencies; }
+
+  /**
+   * @brief Return the number of elements dropped before a stage.
+   */
+  std::size_t getNbDropped(int stage) const { return _nbDropped.at(stage); }
+
+private:
+
+  struct Element
+  {
+    std::size_t id = 0;
+    std::chrono::steady_clock::time_point readTime;
+    T data;
+  };
+
+  struct Stage
+  {
+    std::size_t nbThreads = 1;
+    MakeProcessFunction makeProcess;
+  };
+
+  static double elapsedSince(const std::chrono::steady_clock::time_point& start)
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  const Parameters _param;
+  const std::array<std::string, NbStages> _stageNames;
+  std::array<Stage, NbStages> _stages;
+
+  std::array<LatencyStatistics, NbStages> _stageLatencies;
+  std::array<std::atomic<std::size_t>, NbStages> _nbDropped;
+  LatencyStatistics _latencies;
+};
+
+} // namespace localization
+} // namespace aliceVision
@@ -0,0 +1,186 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "StreamingPipeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE StreamingPipeline
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision::localization;
+
+namespace {
+
+enum EStage : int {READ = 0, FIRST, SECOND, LAST, NB_STAGES};
+
+using Pipeline = StreamingPipeline<std::vector<int>, NB_STAGES>;
+
+const std::array<std::string, NB_STAGES> stageNames = {"read", "first", "second", "last"};
+
+/// each stage appends its index to the element
+void setStages(Pipeline& pipeline, std::size_t nbThreads, std::chrono::milliseconds lastStageDuration,
+               std::mutex& resultsMutex, std::vector<int>& results)
+{
+  for(int stage = FIRST; stage < LAST; ++stage)
+  {
+    pipeline.setStage(stage, nbThreads, [stage]()
+    {
+      return [stage](std::vector<int>& element) { element.push_back(stage); };
+    });
+  }
+  pipeline.setStage(LAST, nbThreads, [&resultsMutex, &results, lastStageDuration]()
+  {
+    return [&resultsMutex, &results, lastStageDuration](std::vector<int>& element)
+    {
+      std::this_thread::sleep_for(lastStageDuration);
+      // the checks are done on the test thread, an element which missed a stage is reported as -1
+      const bool valid = (element.size() == 3 && element[1] == FIRST && element[2] == SECOND);
+      std::lock_guard<std::mutex> lock(resultsMutex);
+      results.push_back(valid ? element.front() : -1);
+    };
+  });
+}
+
+Pipeline::ReadFunction readElements(int nbElements)
+{
+  return [nbElements](std::size_t elementId, std::vector<int>& element)
+  {
+    if(elementId == static_cast<std::size_t>(nbElements))
+      return false;
+    element.push_back(elementId);
+    return true;
+  };
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(StreamingPipeline_ordering)
+{
+  Pipeline::Parameters param;
+  param.dropElements = false;
+  Pipeline pipeline(param, stageNames);
+
+  std::mutex resultsMutex;
+  std::vector<int> results;
+  setStages(pipeline, 1, std::chrono::milliseconds(0), resultsMutex, results);
+
+  const int nbElements = 200;
+  BOOST_CHECK_EQUAL(pipeline.run(readElements(nbElements)), nbElements);
+
+  // with one thread per stage and no drop, the elements are processed in order
+  BOOST_REQUIRE_EQUAL(results.size(), nbElements);
+  for(int i = 0; i < nbElements; ++i)
+    BOOST_CHECK_EQUAL(results[i], i);
+
+  for(int stage = READ; stage < NB_STAGES; ++stage)
+  {
+    BOOST_CHECK_EQUAL(pipeline.getNbDropped(stage), 0);
+    BOOST_CHECK_EQUAL(pipeline.getStageStatistics(stage).count(), nbElements);
+  }
+  BOOST_CHECK_EQUAL(pipeline.getLatencyStatistics().count(), nbElements);
+}
+
+BOOST_AUTO_TEST_CASE(StreamingPipeline_dropAccounting)
+{
+  Pipeline::Parameters param;
+  param.queueSize = 1;
+  param.dropElements = true;
+  param.maxLatency = 0.005;
+  Pipeline pipeline(param, stageNames);
+
+  // the last stage is much slower than the read
+  std::mutex resultsMutex;
+  std::vector<int> results;
+  setStages(pipeline, 2, std::chrono::milliseconds(2), resultsMutex, results);
+
+  const int nbElements = 500;
+  BOOST_CHECK_EQUAL(pipeline.run(readElements(nbElements)), nbElements);
+
+  // each element is either processed or dropped once
+  std::size_t nbDropped = 0;
+  for(int stage = READ; stage < NB_STAGES; ++stage)
+    nbDropped += pipeline.getNbDropped(stage);
+  BOOST_CHECK_GT(nbDropped, 0);
+  BOOST_CHECK_EQUAL(results.size() + nbDropped, nbElements);
+  BOOST_CHECK_EQUAL(pipeline.getLatencyStatistics().count(), results.size());
+
+  std::sort(results.begin(), results.end());
+  BOOST_CHECK(results.empty() || results.front() >= 0);
+  BOOST_CHECK(std::adjacent_find(results.begin(), results.end()) == results.end());
+}
+
+BOOST_AUTO_TEST_CASE(StreamingPipeline_processingError)
+{
+  Pipeline::Parameters param;
+  param.dropElements = false;
+  Pipeline pipeline(param, stageNames);
+
+  std::mutex resultsMutex;
+  std::vector<int> results;
+  setStages(pipeline, 2, std::chrono::milliseconds(0), resultsMutex, results);
+
+  // an element failing in a stage is discarded, the others go on
+  pipeline.setStage(FIRST, 2, []()
+  {
+    return [](std::vector<int>& element)
+    {
+      if(element.front() == 10)
+        throw std::runtime_error("invalid element");
+      element.push_back(FIRST);
+    };
+  });
+
+  const int nbElements = 50;
+  BOOST_CHECK_EQUAL(pipeline.run(readElements(nbElements)), nbElements);
+  BOOST_CHECK_EQUAL(results.size(), nbElements - 1);
+  BOOST_CHECK(std::find(results.begin(), results.end(), 10) == results.end());
+  BOOST_CHECK(std::find(results.begin(), results.end(), -1) == results.end());
+}
+
+BOOST_AUTO_TEST_CASE(StreamingPipeline_readError)
+{
+  Pipeline::Parameters param;
+  param.dropElements = false;
+  Pipeline pipeline(param, stageNames);
+
+  std::mutex resultsMutex;
+  std::vector<int> results;
+  setStages(pipeline, 2, std::chrono::milliseconds(1), resultsMutex, results);
+
+  // the threads are stopped and joined before the error is propagated
+  const auto failingRead = [](std::size_t elementId, std::vector<int>& element)
+  {
+    if(elementId == 20)
+      throw std::runtime_error("invalid source");
+    element.push_back(elementId);
+    return true;
+  };
+  BOOST_CHECK_THROW(pipeline.run(failingRead), std::runtime_error);
+  BOOST_CHECK_LE(results.size(), 20);
+  BOOST_CHECK(std::find(results.begin(), results.end(), -1) == results.end());
+
+  // the pipeline can run again
+  results.clear();
+  const int nbElements = 30;
+  BOOST_CHECK_EQUAL(pipeline.run(readElements(nbElements)), nbElements);
+  BOOST_CHECK_EQUAL(results.size(), nbElements);
+}
+
+BOOST_AUTO_TEST_CASE(StreamingPipeline_stageNotSet)
+{
+  Pipeline pipeline(Pipeline::Parameters(), stageNames);
+  pipeline.setStage(FIRST, 1, []() { return [](std::vector<int>&) {}; });
+
+  BOOST_CHECK_THROW(pipeline.run(readElements(10)), std::logic_error);
+  BOOST_CHECK_THROW(pipeline.setStage(READ, 1, []() { return [](std::vector<int>&) {}; }), std::out_of_range);
+}
@@ -25,11 +25,17 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/system/Timer.hpp>
 
+#include <aliceVision/system/MappedFile.hpp>
+
 #include <boost/progress.hpp>
 #include <boost/filesystem.hpp>
 
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <set>
 
 namespace aliceVision {
 namespace localization {
@@ -111,7 +117,8 @@ VoctreeLocalizer::VoctreeLocalizer(const sfmData::SfMData &sfmData,
                                    const std::string &descriptorsFolder,
                                    const std::string &vocTreeFilepath,
                                    const std::string &weightsFilepath,
-                                   const std::vector<feature::EImageDescriberType>& matchingDescTypes)
+                                   const std::vector<feature::EImageDescriberType>& matchingDescTypes,
+                                   const std::string &indexFolder)
   : ILocalizer()
   , _frameBuffer(5)
 {
@@ -131,7 +138,10 @@ VoctreeLocalizer::VoctreeLocalizer(const sfmData::SfMData &sfmData,
   // then we can store only those associated to 3D points
   //? can we use Feature_Provider to load the features and filter them later?
 
-  _isInit = initDatabase(vocTreeFilepath, weightsFilepath, descriptorsFolder);
+  if(!indexFolder.empty())
+    _isInit = loadIndex(vocTreeFilepath, indexFolder);
+  else
+    _isInit = initDatabase(vocTreeFilepath, weightsFilepath, descriptorsFolder);
 }
 
 bool VoctreeLocalizer::localize(const feature::MapRegionsPerDesc & queryRegions,
@@ -149,72 +159,195 @@ bool VoctreeLocalizer::localize(const feature::MapRegionsPerDesc & queryRegions,
     // error!
     throw std::invalid_argument("The parameters are not in the right format!!");
   }
-  
+
+  _lastFrameTracked = false;
+
+  // try to track the frame from the previous ones before querying the database
+  if(voctreeParam->_useFrameTracking && !_trackedPoses.empty())
+  {
+    system::Timer timer;
+    if(trackFrame(queryRegions,
+                  imageSize,
+                  *voctreeParam,
+                  randomNumberGenerator,
+                  useInputIntrinsics,
+                  queryIntrinsics,
+                  localizationResult,
+                  imagePath))
+    {
+      ALICEVISION_LOG_DEBUG("[tracking]\tFrame tracked in " << timer.elapsedMs() << " [ms]");
+      updateTracking(localizationResult, queryRegions);
+      _lastFrameTracked = true;
+      return true;
+    }
+    ALICEVISION_LOG_DEBUG("[tracking]\tTracking lost, localizing the frame with the database");
+  }
+
+  bool isLocalized = false;
   switch(voctreeParam->_algorithm)
   {
     case Algorithm::FirstBest:
-    return localizeFirstBestResult(queryRegions,
-                                   imageSize,
-                                   *voctreeParam,
-                                   randomNumberGenerator,
-                                   useInputIntrinsics,
-                                   queryIntrinsics,
-                                   localizationResult,
-                                   imagePath);
+    isLocalized = localizeFirstBestResult(queryRegions,
+                                          imageSize,
+                                          *voctreeParam,
+                                          randomNumberGenerator,
+                                          useInputIntrinsics,
+                                          queryIntrinsics,
+                                          localizationResult,
+                                          imagePath);
+    break;
     case Algorithm::BestResult: throw std::invalid_argument("BestResult not yet implemented");
     case Algorithm::AllResults:
-    return localizeAllResults(queryRegions,
-                              imageSize,
-                              *voctreeParam,
-                              randomNumberGenerator,
-                              useInputIntrinsics,
-                              queryIntrinsics,
-                              localizationResult,
-                              imagePath);
+    isLocalized = localizeAllResults(queryRegions,
+                                     imageSize,
+                                     *voctreeParam,
+                                     randomNumberGenerator,
+                                     useInputIntrinsics,
+                                     queryIntrinsics,
+                                     localizationResult,
+                                     imagePath);
+    break;
     case Algorithm::Cluster: throw std::invalid_argument("Cluster not yet implemented");
     default: throw std::invalid_argument("Unknown algorithm type");
   }
+
+  if(voctreeParam->_useFrameTracking)
+    updateTracking(localizationResult, queryRegions);
+
+  return isLocalized;
 }
 
-bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
-                                const LocalizerParameters *param,
-                                std::mt19937 & randomNumberGenerator,
-                                bool useInputIntrinsics,
-                                camera::PinholeRadialK3 &queryIntrinsics,
-                                LocalizationResult &localizationResult,
-                                const std::string& imagePath /* = std::string() */)
+bool VoctreeLocalizer::trackFrame(const feature::MapRegionsPerDesc &queryRegions,
+                                  const std::pair<std::size_t, std::size_t> &imageSize,
+                                  const Parameters &param,
+                                  std::mt19937 & randomNumberGenerator,
+                                  bool useInputIntrinsics,
+                                  camera::PinholeRadialK3 &queryIntrinsics,
+                                  LocalizationResult &localizationResult,
+                                  const std::string& imagePath)
 {
-  // A. extract descriptors and features from image
-  ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
-  feature::MapRegionsPerDesc queryRegionsPerDesc;
+  assert(!_trackedPoses.empty());
 
-  image::Image<unsigned char> imageGrayUChar; // uchar image copy for uchar image describer
+  // predict the pose with a constant velocity model
+  geometry::Pose3 predictedPose = _trackedPoses.back();
+  if(_trackedPoses.size() > 1)
+  {
+    const geometry::Pose3 motion = _trackedPoses.back() * _trackedPoses.front().inverse();
+    predictedPose = motion * _trackedPoses.back();
+  }
+  const camera::PinholeRadialK3& predictedIntrinsics = useInputIntrinsics ? queryIntrinsics : _trackedIntrinsics;
 
-  for(const auto& imageDescriber : _imageDescribers)
+  // match the query features with the landmarks projected around their predicted position
+  OccurenceMap occurences;
+  Mat3X landmarksX;
+  Mat2X projections;
+  const auto matchProjectedLandmarks = [&](const feature::MapRegionsPerDesc& regions, const ReconstructedRegionsMappingPerDesc& mapping)
   {
-    const auto descType = imageDescriber->getDescriberType();
-    auto & queryRegions = queryRegionsPerDesc[descType];
+    for(const auto& regionsIt : regions)
+    {
+      const feature::EImageDescriberType descType = regionsIt.first;
+      if(queryRegions.count(descType) == 0 || regionsIt.second->RegionCount() == 0)
+        continue;
 
-    imageDescriber->allocate(queryRegions);
+      const std::vector<IndexT>& associated3dPoint = mapping.at(descType)._associated3dPoint;
+      landmarksX.resize(3, associated3dPoint.size());
+      for(std::size_t i = 0; i < associated3dPoint.size(); ++i)
+        landmarksX.col(i) = _sfm_data.getLandmarks().at(associated3dPoint[i]).X;
 
-    system::Timer timer;
-    imageDescriber->setCudaPipe(_cudaPipe);
-    imageDescriber->setConfigurationPreset(param->_featurePreset);
+      predictedIntrinsics.projectPoints(predictedPose, landmarksX, projections);
+      // the landmarks behind the camera are not visible
+      for(std::size_t i = 0; i < associated3dPoint.size(); ++i)
+      {
+        if(predictedPose.depth(landmarksX.col(i)) <= 0.0)
+          projections.col(i).setConstant(std::numeric_limits<double>::quiet_NaN());
+      }
 
-    if(imageDescriber->useFloatImage())
-    {
-      imageDescriber->describe(imageGrey, queryRegions, nullptr);
-    }
-    else
-    {
-      // image descriptor can't use float image
-      if(imageGrayUChar.Width() == 0) // the first time, convert the float buffer to uchar
-        imageGrayUChar = (imageGrey.GetMat() * 255.f).cast<unsigned char>();
-      imageDescriber->describe(imageGrayUChar, queryRegions, nullptr);
+      matching::IndMatches matches;
+      matching::guidedMatchingFromPredictions(*regionsIt.second,
+                                              projections,
+                                              *queryRegions.at(descType),
+                                              param._trackingSearchRadius,
+                                              param._fDistRatio,
+                                              matches);
+      for(const matching::IndMatch& match : matches)
+        ++occurences[OccurenceKey(associated3dPoint[match._i], descType, match._j)];
     }
+  };
 
-    ALICEVISION_LOG_DEBUG("[features]\tExtract " << feature::EImageDescriberType_enumToString(descType) << " done: found " << queryRegions->RegionCount() << " features in " << timer.elapsedMs() << " [ms]");
+  for(const voctree::DocMatch& trackedImage : _trackedImages)
+  {
+    matchProjectedLandmarks(_regionsPerView.getRegionsPerDesc(trackedImage.id),
+                            _reconstructedRegionsMappingPerView.at(trackedImage.id));
   }
+  if(_trackedFrame)
+    matchProjectedLandmarks(_trackedFrame->_regions, _trackedFrame->_regionsWith3D);
+
+  ALICEVISION_LOG_DEBUG("[tracking]\tFound " << occurences.size() << " associations around the predicted pose");
+  if(occurences.size() < std::max<std::size_t>(param._trackingMinInliers, 1))
+    return false;
+
+  sfm::ImageLocalizerMatchData resectionData;
+  getAssociationsPoints(queryRegions, occurences, resectionData.pt2D, resectionData.pt3D, resectionData.vec_descType);
+
+  // the frame is added to the frame buffer only if it is tracked
+  Parameters trackingParam = param;
+  trackingParam._nbFrameBufferMatching = 0;
+
+  camera::PinholeRadialK3 trackedIntrinsics = queryIntrinsics;
+  const bool isLocalized = localizeFromAssociations(queryRegions,
+                                                    imageSize,
+                                                    trackingParam,
+                                                    randomNumberGenerator,
+                                                    useInputIntrinsics,
+                                                    trackedIntrinsics,
+                                                    occurences,
+                                                    resectionData,
+                                                    _trackedImages,
+                                                    localizationResult,
+                                                    imagePath);
+  if(!isLocalized || localizationResult.getInliers().size() < param._trackingMinInliers)
+    return false;
+
+  queryIntrinsics = trackedIntrinsics;
+  if(param._nbFrameBufferMatching > 0)
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(_frameBufferMutex);
+    _frameBuffer.emplace_back(localizationResult, queryRegions);
+  }
+  return true;
+}
+
+void VoctreeLocalizer::updateTracking(const LocalizationResult &localizationResult,
+                                      const feature::MapRegionsPerDesc &queryRegions)
+{
+  if(!localizationResult.isValid())
+  {
+    // the next frame is localized from the database
+    _trackedPoses.clear();
+    _trackedImages.clear();
+    _trackedFrame.reset();
+    return;
+  }
+
+  if(_trackedPoses.size() == 2)
+    _trackedPoses.erase(_trackedPoses.begin());
+  _trackedPoses.push_back(localizationResult.getPose());
+  _trackedIntrinsics = localizationResult.getIntrinsics();
+  _trackedImages = localizationResult.getMatchedImages();
+  _trackedFrame.reset(new FrameData(localizationResult, queryRegions));
+}
+
+bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
+                                const LocalizerParameters *param,
+                                std::mt19937 & randomNumberGenerator,
+                                bool useInputIntrinsics,
+                                camera::PinholeRadialK3 &queryIntrinsics,
+                                LocalizationResult &localizationResult,
+                                const std::string& imagePath /* = std::string() */)
+{
+  // A. extract descriptors and features from image
+  feature::MapRegionsPerDesc queryRegionsPerDesc;
+  extractFeatures(_imageDescribers, imageGrey, param->_featurePreset, _cudaPipe, queryRegionsPerDesc);
 
   const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
 
@@ -246,6 +379,43 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
                   imagePath);
 }
 
+void VoctreeLocalizer::extractFeatures(const std::vector<std::unique_ptr<feature::ImageDescriber>>& imageDescribers,
+                                       const image::Image<float>& imageGrey,
+                                       const feature::ConfigurationPreset& featurePreset,
+                                       int cudaPipe,
+                                       feature::MapRegionsPerDesc& out_queryRegionsPerDesc)
+{
+  ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
+
+  image::Image<unsigned char> imageGrayUChar; // uchar image copy for uchar image describer
+
+  for(const auto& imageDescriber : imageDescribers)
+  {
+    const auto descType = imageDescriber->getDescriberType();
+    auto & queryRegions = out_queryRegionsPerDesc[descType];
+
+    imageDescriber->allocate(queryRegions);
+
+    system::Timer timer;
+    imageDescriber->setCudaPipe(cudaPipe);
+    imageDescriber->setConfigurationPreset(featurePreset);
+
+    if(imageDescriber->useFloatImage())
+    {
+      imageDescriber->describe(imageGrey, queryRegions, nullptr);
+    }
+    else
+    {
+      // image descriptor can't use float image
+      if(imageGrayUChar.Width() == 0) // the first time, convert the float buffer to uchar
+        imageGrayUChar = (imageGrey.GetMat() * 255.f).cast<unsigned char>();
+      imageDescriber->describe(imageGrayUChar, queryRegions, nullptr);
+    }
+
+    ALICEVISION_LOG_DEBUG("[features]\tExtract " << feature::EImageDescriberType_enumToString(descType) << " done: found " << queryRegions->RegionCount() << " features in " << timer.elapsedMs() << " [ms]");
+  }
+}
+
 bool VoctreeLocalizer::loadReconstructionDescriptors(const sfmData::SfMData & sfm_data,
                                                      const std::string & feat_directory)
 {
@@ -380,6 +550,259 @@ bool VoctreeLocalizer::initDatabase(const std::string & vocTreeFilepath,
   return true;
 }
 
+namespace {
+
+/*
+ * Layout of the regions file of a localization index, every block is 8-byte aligned:
+ *  - RegionsIndexHeader
+ *  - RegionsIndexEntry[nbEntries], one per view and describer type
+ *  - for each entry: the features (x, y, scale, orientation as floats),
+ *    the raw descriptors and the landmark ids (IndexT) of the regions
+ */
+const char regionsIndexMagic[8] = {'A', 'V', 'L', 'O', 'C', 'I', 'D', 'X'};
+const uint32_t regionsIndexVersion = 1;
+
+struct RegionsIndexHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t nbEntries;
+  /// number of landmarks of the SfMData used to build the index
+  uint64_t nbLandmarks;
+};
+
+struct RegionsIndexEntry
+{
+  uint32_t viewId;
+  int32_t descType;
+  uint64_t nbRegions;
+  uint64_t descriptorByteSize;
+  uint64_t featuresOffset;
+  uint64_t descriptorsOffset;
+  uint64_t landmarksOffset;
+};
+
+std::size_t alignedSize(std::size_t size)
+{
+  return (size + 7) & ~std::size_t(7);
+}
+
+const std::string regionsIndexFilename = "regions.bin";
+const std::string databaseIndexFilename = "database.bin";
+
+} // namespace
+
+void VoctreeLocalizer::saveIndex(const std::string &indexFolder) const
+{
+  namespace bfs = boost::filesystem;
+
+  if(!bfs::exists(indexFolder))
+    bfs::create_directories(indexFolder);
+
+  _database.save((bfs::path(indexFolder) / databaseIndexFilename).string());
+
+  std::vector<RegionsIndexEntry> entries;
+  std::vector<const feature::Regions*> entriesRegions;
+  std::vector<const ReconstructedRegionsMapping*> entriesMappings;
+
+  for(const auto& viewRegions : _regionsPerView.getData())
+  {
+    for(const auto& descRegions : viewRegions.second)
+    {
+      RegionsIndexEntry entry;
+      entry.viewId = static_cast<uint32_t>(viewRegions.first);
+      entry.descType = static_cast<int32_t>(descRegions.first);
+      entry.nbRegions = descRegions.second->RegionCount();
+      entry.descriptorByteSize = descRegions.second->DescriptorByteSize();
+      entries.push_back(entry);
+      entriesRegions.push_back(descRegions.second.get());
+      entriesMappings.push_back(&_reconstructedRegionsMappingPerView.at(viewRegions.first).at(descRegions.first));
+    }
+  }
+
+  // compute the offsets of the data blocks
+  std::size_t offset = alignedSize(sizeof(RegionsIndexHeader) + entries.size() * sizeof(RegionsIndexEntry));
+  for(RegionsIndexEntry& entry : entries)
+  {
+    entry.featuresOffset = offset;
+    offset += alignedSize(entry.nbRegions * 4 * sizeof(float));
+    entry.descriptorsOffset = offset;
+    offset += alignedSize(entry.nbRegions * entry.descriptorByteSize);
+    entry.landmarksOffset = offset;
+    offset += alignedSize(entry.nbRegions * sizeof(IndexT));
+  }
+
+  RegionsIndexHeader header;
+  std::copy(regionsIndexMagic, regionsIndexMagic + sizeof(header.magic), header.magic);
+  header.version = regionsIndexVersion;
+  header.nbEntries = static_cast<uint32_t>(entries.size());
+  header.nbLandmarks = _sfm_data.getLandmarks().size();
+
+  const std::string filepath = (bfs::path(indexFolder) / regionsIndexFilename).string();
+  std::ofstream out(filepath, std::ios_base::binary);
+  if(!out.is_open())
+    throw std::runtime_error("Unable to write the localization index file '" + filepath + "'.");
+
+  const char padding[8] = {0};
+  const auto writeAligned = [&out, &padding](const void* data, std::size_t size)
+  {
+    out.write(static_cast<const char*>(data), size);
+    out.write(padding, alignedSize(size) - size);
+  };
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  writeAligned(entries.data(), entries.size() * sizeof(RegionsIndexEntry));
+
+  std::vector<float> features;
+  for(std::size_t i = 0; i < entries.size(); ++i)
+  {
+    const feature::Regions& regions = *entriesRegions[i];
+
+    features.clear();
+    features.reserve(4 * regions.RegionCount());
+    for(const feature::PointFeature& feat : regions.Features())
+    {
+      features.push_back(feat.x());
+      features.push_back(feat.y());
+      features.push_back(feat.scale());
+      features.push_back(feat.orientation());
+    }
+    writeAligned(features.data(), features.size() * sizeof(float));
+    writeAligned(regions.RegionCount() ? regions.DescriptorRawData() : nullptr, entries[i].nbRegions * entries[i].descriptorByteSize);
+    writeAligned(entriesMappings[i]->_associated3dPoint.data(), entries[i].nbRegions * sizeof(IndexT));
+  }
+
+  if(!out.good())
+    throw std::runtime_error("Unable to write the localization index file '" + filepath + "'.");
+
+  ALICEVISION_LOG_INFO("Localization index saved in " << indexFolder << " (" << entries.size() << " regions sets).");
+}
+
+bool VoctreeLocalizer::loadIndex(const std::string & vocTreeFilepath,
+                                 const std::string & indexFolder)
+{
+  namespace bfs = boost::filesystem;
+
+  // Load vocabulary tree, it is still needed to quantize the query images
+  ALICEVISION_LOG_DEBUG("Loading vocabulary tree...");
+  voctree::load(_voctree, _voctreeDescType, vocTreeFilepath);
+
+  // the database is queried in place from the mapped file
+  ALICEVISION_LOG_DEBUG("Loading the database from the localization index...");
+  const std::string databaseFilepath = (bfs::path(indexFolder) / databaseIndexFilename).string();
+  const std::string regionsFilepath = (bfs::path(indexFolder) / regionsIndexFilename).string();
+  std::unique_ptr<system::MappedFile> mapping;
+  try
+  {
+    _database.load(databaseFilepath);
+    mapping.reset(new system::MappedFile(regionsFilepath));
+  }
+  catch(const std::runtime_error& e)
+  {
+    ALICEVISION_LOG_ERROR("Unable to load the localization index '" << indexFolder << "': " << e.what());
+    return false;
+  }
+
+  if(_database.getNbWords() != _voctree->words())
+  {
+    ALICEVISION_LOG_ERROR("The localization index '" << indexFolder << "' was built with another vocabulary tree.");
+    return false;
+  }
+
+  const char* data = mapping->data();
+  const std::size_t size = mapping->size();
+
+  RegionsIndexHeader header;
+  if(size < sizeof(header))
+  {
+    ALICEVISION_LOG_ERROR("Invalid localization index file '" << regionsFilepath << "'.");
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if(!std::equal(regionsIndexMagic, regionsIndexMagic + sizeof(header.magic), header.magic) ||
+     header.version != regionsIndexVersion ||
+     size < sizeof(header) + header.nbEntries * sizeof(RegionsIndexEntry))
+  {
+    ALICEVISION_LOG_ERROR("Invalid localization index file '" << regionsFilepath << "'.");
+    return false;
+  }
+  if(header.nbLandmarks != _sfm_data.getLandmarks().size())
+  {
+    ALICEVISION_LOG_ERROR("The localization index '" << indexFolder << "' was built for another SfMData ("
+                          << header.nbLandmarks << " landmarks instead of " << _sfm_data.getLandmarks().size() << ").");
+    return false;
+  }
+
+  std::vector<RegionsIndexEntry> entries(header.nbEntries);
+  std::memcpy(entries.data(), data + sizeof(header), entries.size() * sizeof(RegionsIndexEntry));
+
+  std::map<feature::EImageDescriberType, const feature::ImageDescriber*> imageDescribers;
+  for(const auto& imageDescriber : _imageDescribers)
+    imageDescribers[imageDescriber->getDescriberType()] = imageDescriber.get();
+
+  std::set<feature::EImageDescriberType> indexedDescTypes;
+  for(const RegionsIndexEntry& entry : entries)
+  {
+    const feature::EImageDescriberType descType = static_cast<feature::EImageDescriberType>(entry.descType);
+    indexedDescTypes.insert(descType);
+
+    // the index may contain more describer types than used by the localizer
+    const auto imageDescriberIt = imageDescribers.find(descType);
+    if(imageDescriberIt == imageDescribers.end())
+      continue;
+
+    if(entry.landmarksOffset + entry.nbRegions * sizeof(IndexT) > size ||
+       entry.featuresOffset + entry.nbRegions * 4 * sizeof(float) > size ||
+       entry.descriptorsOffset + entry.nbRegions * entry.descriptorByteSize > size)
+    {
+      ALICEVISION_LOG_ERROR("Invalid localization index file '" << regionsFilepath << "'.");
+      return false;
+    }
+    if(_sfm_data.getViews().count(entry.viewId) == 0)
+    {
+      ALICEVISION_LOG_ERROR("The localization index '" << indexFolder << "' was built for another SfMData (unknown view " << entry.viewId << ").");
+      return false;
+    }
+
+    std::unique_ptr<feature::Regions> regions;
+    imageDescriberIt->second->allocate(regions);
+    if(entry.descriptorByteSize != regions->DescriptorByteSize())
+    {
+      ALICEVISION_LOG_ERROR("Invalid descriptor size for " << feature::EImageDescriberType_enumToString(descType)
+                            << " in the localization index file '" << regionsFilepath << "'.");
+      return false;
+    }
+
+    // the regions are copied out of the mapping: they own their data and are shared with
+    // the matchers and the frame tracking, while the mapping is released after the loading
+    const float* features = reinterpret_cast<const float*>(data + entry.featuresOffset);
+    regions->Features().reserve(entry.nbRegions);
+    for(std::size_t i = 0; i < entry.nbRegions; ++i)
+      regions->Features().emplace_back(features[4 * i], features[4 * i + 1], features[4 * i + 2], features[4 * i + 3]);
+    regions->assignDescriptors(data + entry.descriptorsOffset, entry.nbRegions);
+
+    const IndexT* landmarks = reinterpret_cast<const IndexT*>(data + entry.landmarksOffset);
+    ReconstructedRegionsMapping& mapping = _reconstructedRegionsMappingPerView[entry.viewId][descType];
+    mapping._associated3dPoint.assign(landmarks, landmarks + entry.nbRegions);
+
+    _regionsPerView.getData()[entry.viewId][descType] = std::move(regions);
+  }
+
+  for(const auto& imageDescriber : _imageDescribers)
+  {
+    if(indexedDescTypes.count(imageDescriber->getDescriberType()) == 0)
+    {
+      ALICEVISION_LOG_ERROR("The localization index '" << indexFolder << "' has no "
+                            << feature::EImageDescriberType_enumToString(imageDescriber->getDescriberType()) << " features.");
+      return false;
+    }
+  }
+
+  ALICEVISION_LOG_DEBUG("Localization index loaded with " << _regionsPerView.getData().size() << " views and "
+                        << _database.size() << " documents.");
+  return true;
+}
+
 bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc &queryRegions,
                                                const std::pair<std::size_t, std::size_t> &queryImageSize,
                                                const Parameters &param,
@@ -493,7 +916,7 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc
                       param._visualDebug + "/" + queryimage + "_" + matchedImage + ".svg"); 
     }
     
-    // C. recover the 2D-3D associations from the matches 
+    // recover the 2D-3D associations from the matches 
     // Each matched feature in the current similar image is associated to a 3D point,
     // hence we can recover the 2D-3D associations to estimate the pose
     // Prepare data for resection
@@ -631,6 +1054,31 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                      matchedImages,
                      imagePath);
 
+  return localizeFromAssociations(queryRegions,
+                                  queryImageSize,
+                                  param,
+                                  randomNumberGenerator,
+                                  useInputIntrinsics,
+                                  queryIntrinsics,
+                                  occurences,
+                                  resectionData,
+                                  matchedImages,
+                                  localizationResult,
+                                  imagePath);
+}
+
+bool VoctreeLocalizer::localizeFromAssociations(const feature::MapRegionsPerDesc &queryRegions,
+                                                const std::pair<std::size_t, std::size_t> & queryImageSize,
+                                                const Parameters &param,
+                                                std::mt19937 & randomNumberGenerator,
+                                                bool useInputIntrinsics,
+                                                camera::PinholeRadialK3 &queryIntrinsics,
+                                                const OccurenceMap &occurences,
+                                                sfm::ImageLocalizerMatchData &resectionData,
+                                                const std::vector<voctree::DocMatch>& matchedImages,
+                                                LocalizationResult &localizationResult,
+                                                const std::string& imagePath)
+{
   const std::size_t numCollectedPts = occurences.size();
   std::vector<IndMatch3D2D> associationIDs;
   associationIDs.reserve(numCollectedPts);
@@ -734,6 +1182,7 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
   if(param._nbFrameBufferMatching > 0)
   {
     // add everything to the buffer
+    std::unique_lock<std::shared_timed_mutex> lock(_frameBufferMutex);
     _frameBuffer.emplace_back(localizationResult, queryRegions);
   }
 
@@ -756,18 +1205,57 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
   assert(out_descTypes.empty());
 
   // A. Find the (visually) similar images in the database 
+  if(!retrieveImages(queryRegions, param, out_matchedImages))
+    return;
+
+  // B. match them with the query image to get the 2D-3D associations
+  getAssociations(queryRegions,
+                  imageSize,
+                  param,
+                  randomNumberGenerator,
+                  useInputIntrinsics,
+                  queryIntrinsics,
+                  out_matchedImages,
+                  out_occurences,
+                  out_pt2D,
+                  out_pt3D,
+                  out_descTypes,
+                  imagePath);
+}
+
+bool VoctreeLocalizer::retrieveImages(const feature::MapRegionsPerDesc &queryRegions,
+                                      const Parameters &param,
+                                      std::vector<voctree::DocMatch>& out_matchedImages) const
+{
   // pass the descriptors through the vocabulary tree to get the visual words
   // associated to each feature
   ALICEVISION_LOG_DEBUG("[database]\tRequest closest images from voctree");
   if(queryRegions.count(_voctreeDescType) == 0)
   {
     ALICEVISION_LOG_WARNING("[database]\t No feature type " << feature::EImageDescriberType_enumToString(_voctreeDescType) << " in query region.");
-    return;
+    return false;
   }
   voctree::SparseHistogram requestImageWords = _voctree->quantizeToSparse(queryRegions.at(_voctreeDescType)->blindDescriptors());
   
   // Request closest images from voctree
   _database.find(requestImageWords, (param._numResults==0) ? (_database.size()) : (param._numResults) , out_matchedImages);
+  return true;
+}
+
+void VoctreeLocalizer::getAssociations(const feature::MapRegionsPerDesc &queryRegions,
+                                       const std::pair<std::size_t, std::size_t> &imageSize,
+                                       const Parameters &param,
+                                       std::mt19937 & randomNumberGenerator,
+                                       bool useInputIntrinsics,
+                                       const camera::PinholeRadialK3 &queryIntrinsics,
+                                       const std::vector<voctree::DocMatch>& matchedImages,
+                                       OccurenceMap &out_occurences,
+                                       Mat &out_pt2D,
+                                       Mat &out_pt3D,
+                                       std::vector<feature::EImageDescriberType>& out_descTypes,
+                                       const std::string& imagePath) const
+{
+  assert(out_descTypes.empty());
 
 //  // Debugging log
 //  // for each similar image found print score and number of features
@@ -787,11 +1275,11 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
 
   std::map< std::pair<IndexT, IndexT>, std::size_t > repeated;
   
-  // B. for each found similar image, try to find the correspondences between the 
+  // for each found similar image, try to find the correspondences between the 
   // query image adn the similar image
   // stop when param._maxResults successful matches have been found
   std::size_t goodMatches = 0;
-  for(const voctree::DocMatch& matchedImage : out_matchedImages)
+  for(const voctree::DocMatch& matchedImage : matchedImages)
   {
     // minimum number of points that allows a reliable 3D reconstruction
     const size_t minNum3DPoints = 5;
@@ -892,7 +1380,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
 
     const auto& matchedRegionsMapping = _reconstructedRegionsMappingPerView.at(matchedViewId);
 
-    // C. recover the 2D-3D associations from the matches 
+    // recover the 2D-3D associations from the matches 
     // Each matched feature in the current similar image is associated to a 3D point
     for(const auto& featureMatchesIt : featureMatches)
     {
@@ -955,14 +1443,25 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
     }
   }
   
+  getAssociationsPoints(queryRegions, out_occurences, out_pt2D, out_pt3D, out_descTypes);
+}
+
+void VoctreeLocalizer::getAssociationsPoints(const feature::MapRegionsPerDesc &queryRegions,
+                                             const OccurenceMap &occurences,
+                                             Mat &out_pt2D,
+                                             Mat &out_pt3D,
+                                             std::vector<feature::EImageDescriberType>& out_descTypes) const
+{
+  const std::size_t numCollectedPts = occurences.size();
+
   out_pt2D = Mat2X(2, numCollectedPts);
   out_pt3D = Mat3X(3, numCollectedPts);
   
 
-  out_descTypes.resize(out_occurences.size());
+  out_descTypes.resize(occurences.size());
 
   std::size_t index = 0;
-  for(const auto &idx : out_occurences)
+  for(const auto &idx : occurences)
   {
      // recopy all the points in the matching structure
     const IndexT pt2D_id = idx.first.featId;
@@ -975,7 +1474,6 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
     out_descTypes.at(index) = landmark.descType;
      ++index;
   }
-  
 }
 
 void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatcherPerDesc & matchers,
@@ -988,6 +1486,8 @@ void VoctreeLocalizer::getAssociationsFromBuffer(matching::RegionsDatabaseMatche
                                                  const std::string& imagePath) const
 {
   std::size_t frameCounter = 0;
+  // the frames can be added concurrently by the resection of other frames
+  std::shared_lock<std::shared_timed_mutex> lock(_frameBufferMutex);
   // for all the past frames
   for(const auto& frame : _frameBuffer)
   {
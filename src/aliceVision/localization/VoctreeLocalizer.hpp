@@ -22,6 +22,8 @@
 
 #include <flann/algorithms/dist.h>
 
+#include <shared_mutex>
+
 namespace aliceVision {
 namespace localization {
 
@@ -55,6 +57,9 @@ public:
       , _ccTagUseCuda(true)
       , _matchingError(std::numeric_limits<double>::infinity())
       , _nbFrameBufferMatching(10)
+      , _useFrameTracking(false)
+      , _trackingSearchRadius(20.0)
+      , _trackingMinInliers(30)
     {}
     
     /// Enable/disable guided matching when matching images
@@ -75,6 +80,13 @@ public:
     double _matchingError;
     /// maximum capacity of the frame buffer
     std::size_t _nbFrameBufferMatching;
+    /// enable the tracking of consecutive frames: the landmarks are matched around their projection
+    /// with the predicted pose, the database is only queried when the tracking is lost
+    bool _useFrameTracking;
+    /// search radius (in pixels) around the projection of the landmarks when tracking
+    double _trackingSearchRadius;
+    /// minimum number of resection inliers for a frame to be tracked
+    std::size_t _trackingMinInliers;
   };
   
 public:
@@ -92,6 +104,9 @@ public:
    * when all the documents are added.
    * @param[in] matchingDescTypes List of descriptor types to use for feature matching.
    * @param[in] voctreeDescType Descriptor type used for image matching with voctree.
+   * @param[in] indexFolder Optional path to a localization index built with saveIndex(),
+   * if provided the reconstructed regions and the database are loaded from it instead of
+   * being rebuilt from the features of the scene.
    *
    * It enable the use of combined SIFT and CCTAG features.
    */
@@ -99,8 +114,27 @@ public:
                    const std::string &descriptorsFolder,
                    const std::string &vocTreeFilepath,
                    const std::string &weightsFilepath,
-                   const std::vector<feature::EImageDescriberType>& matchingDescTypes
+                   const std::vector<feature::EImageDescriberType>& matchingDescTypes,
+                   const std::string &indexFolder = std::string()
                   );
+
+  /**
+   * @brief Save the localization index: the features and descriptors associated
+   * to the reconstructed landmarks of each view and the vocabulary tree database.
+   * The index is specific to the SfMData and the describer types of the localizer.
+   *
+   * @param[in] indexFolder The folder where to save the index, it is created if needed.
+   */
+  void saveIndex(const std::string &indexFolder) const;
+
+  /// Return the features and descriptors associated to the reconstructed landmarks, per view and describer type
+  const feature::RegionsPerView& getReconstructedRegions() const { return _regionsPerView; }
+
+  /// Return the landmark ids of the reconstructed regions, per view and describer type
+  const ReconstructedRegionsMappingPerView& getReconstructedRegionsMapping() const { return _reconstructedRegionsMappingPerView; }
+
+  /// Return true if the last frame has been localized by tracking, without querying the database
+  bool isLastFrameTracked() const { return _lastFrameTracked; }
   
   void setCudaPipe( int i ) override
   {
@@ -154,6 +188,20 @@ public:
                 const std::string& imagePath = std::string()) override;
   
   
+  /**
+   * @brief Extract the features of the query image.
+   * @param[in] imageDescribers The image describers to use, one per describer type
+   * @param[in] imageGrey The input greyscale image.
+   * @param[in] featurePreset The preset of the feature extraction.
+   * @param[in] cudaPipe The CUDA pipe used by the image describers supporting it.
+   * @param[out] out_queryRegionsPerDesc The features of the query image.
+   */
+  static void extractFeatures(const std::vector<std::unique_ptr<feature::ImageDescriber>>& imageDescribers,
+                              const image::Image<float>& imageGrey,
+                              const feature::ConfigurationPreset& featurePreset,
+                              int cudaPipe,
+                              feature::MapRegionsPerDesc& out_queryRegionsPerDesc);
+
   bool localizeRig(const std::vector<image::Image<float>> & vec_imageGrey,
                    const LocalizerParameters *param,
                    std::mt19937 & randomNumberGenerator,
@@ -277,6 +325,77 @@ public:
                           std::vector<voctree::DocMatch>& out_matchedImages,
                           const std::string& imagePath = std::string()) const;
 
+  /**
+   * @brief Query the database for the images which are the most similar to the query image.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] param The parameters for the localization
+   * @param[out] out_matchedImages The retrieved images, sorted by decreasing similarity
+   * @return false if the query image has no feature of the vocabulary tree describer type
+   */
+  bool retrieveImages(const feature::MapRegionsPerDesc & queryRegions,
+                      const Parameters &param,
+                      std::vector<voctree::DocMatch>& out_matchedImages) const;
+
+  /**
+   * @brief Retrieve the 2D-3D associations of the query image by matching it with the
+   * given database images, and with the frame buffer if enabled.
+   *
+   * @param[in] queryRegions
+   * @param[in] imageSize
+   * @param[in] param
+   * @param[in] randomNumberGenerator
+   * @param[in] useInputIntrinsics
+   * @param[in] queryIntrinsics
+   * @param[in] matchedImages The database images to match, see retrieveImages()
+   * @param[out] out_occurences
+   * @param[out] out_pt2D output matrix of 2D points
+   * @param[out] out_pt3D output matrix of 3D points
+   * @param[out] out_descTypes output vector of describerType
+   * @param[in] imagePath
+   */
+  void getAssociations(const feature::MapRegionsPerDesc & queryRegions,
+                       const std::pair<std::size_t, std::size_t> &imageSize,
+                       const Parameters &param,
+                       std::mt19937 & randomNumberGenerator,
+                       bool useInputIntrinsics,
+                       const camera::PinholeRadialK3 &queryIntrinsics,
+                       const std::vector<voctree::DocMatch>& matchedImages,
+                       OccurenceMap & out_occurences,
+                       Mat &out_pt2D,
+                       Mat &out_pt3D,
+                       std::vector<feature::EImageDescriberType>& out_descTypes,
+                       const std::string& imagePath = std::string()) const;
+
+  /**
+   * @brief Estimate the camera pose from the 2D-3D associations (resection and refinement)
+   * and add the frame to the frame buffer if enabled.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] imageSize The size of the input image
+   * @param[in] param The parameters for the localization
+   * @param[in] randomNumberGenerator The random seed
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera
+   * @param[in] occurences The 2D-3D associations, see getAssociations()
+   * @param[in,out] resectionData The 2D and 3D points of the associations
+   * @param[in] matchedImages The database images used for the associations
+   * @param[out] localizationResult The localization result
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   * @return true if the localization is successful
+   */
+  bool localizeFromAssociations(const feature::MapRegionsPerDesc & queryRegions,
+                                const std::pair<std::size_t, std::size_t> & imageSize,
+                                const Parameters &param,
+                                std::mt19937 & randomNumberGenerator,
+                                bool useInputIntrinsics,
+                                camera::PinholeRadialK3 &queryIntrinsics,
+                                const OccurenceMap & occurences,
+                                sfm::ImageLocalizerMatchData & resectionData,
+                                const std::vector<voctree::DocMatch>& matchedImages,
+                                LocalizationResult &localizationResult,
+                                const std::string& imagePath = std::string());
+
 private:
   /**
    * @brief Load the vocabulary tree.
@@ -294,6 +413,17 @@ private:
                     const std::string & weightsFilepath,
                     const std::string & featFolder);
 
+  /**
+   * @brief Load the vocabulary tree, then the reconstructed regions and the database
+   * from a localization index.
+   *
+   * @param[in] vocTreeFilepath The path to the vocabulary tree used to build the index.
+   * @param[in] indexFolder The folder of the index, see saveIndex()
+   * @return true if everything went ok
+   */
+  bool loadIndex(const std::string & vocTreeFilepath,
+                 const std::string & indexFolder);
+
   /**
    * @brief robustMatching
    *
@@ -334,6 +464,46 @@ private:
                                  std::mt19937 & randomNumberGenerator,
                                  const std::string& imagePath = std::string()) const;
   
+  /**
+   * @brief Localize the query image by tracking: the pose is predicted from the last localized
+   * frames (constant velocity) and the landmarks of the last matched images and of the last frame
+   * are matched with the query features around their projection.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] imageSize The size of the input image
+   * @param[in] param The parameters for the localization
+   * @param[in] randomNumberGenerator The random seed
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera
+   * @param[out] localizationResult The localization result
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   * @return true if the frame is localized with at least param._trackingMinInliers inliers
+   */
+  bool trackFrame(const feature::MapRegionsPerDesc & queryRegions,
+                  const std::pair<std::size_t, std::size_t> & imageSize,
+                  const Parameters &param,
+                  std::mt19937 & randomNumberGenerator,
+                  bool useInputIntrinsics,
+                  camera::PinholeRadialK3 &queryIntrinsics,
+                  LocalizationResult &localizationResult,
+                  const std::string& imagePath = std::string());
+
+  /**
+   * @brief Update the tracking state with the result of the last frame,
+   * the tracking is reset if the frame is not localized.
+   */
+  void updateTracking(const LocalizationResult &localizationResult,
+                      const feature::MapRegionsPerDesc & queryRegions);
+
+  /**
+   * @brief Fill the 2D and 3D points of the associations.
+   */
+  void getAssociationsPoints(const feature::MapRegionsPerDesc & queryRegions,
+                             const OccurenceMap & occurences,
+                             Mat &out_pt2D,
+                             Mat &out_pt3D,
+                             std::vector<feature::EImageDescriberType>& out_descTypes) const;
+
   /**
    * @brief Load all the Descriptors who have contributed to the reconstruction.
    * deprecated.. now inside initDatabase
@@ -368,6 +538,19 @@ public:
   
   /// Last frames buffer
   BoundedBuffer<FrameData> _frameBuffer;
+  /// protect the frame buffer when frames are localized concurrently
+  mutable std::shared_timed_mutex _frameBufferMutex;
+
+  /// poses of the last two localized frames, to predict the pose when tracking
+  std::vector<geometry::Pose3> _trackedPoses;
+  /// intrinsics of the last localized frame
+  camera::PinholeRadialK3 _trackedIntrinsics;
+  /// images of the database matched by the last localization from the database
+  std::vector<voctree::DocMatch> _trackedImages;
+  /// inlier regions of the last localized frame
+  std::unique_ptr<FrameData> _trackedFrame;
+  /// the last frame has been localized by tracking
+  bool _lastFrameTracked = false;
 
   matching::EMatcherType _matcherType = matching::ANN_L2;
 };
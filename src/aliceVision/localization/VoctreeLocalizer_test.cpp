@@ -0,0 +1,272 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "VoctreeLocalizer.hpp"
+#include <aliceVision/feature/regionsFactory.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE VoctreeLocalizer
+
+#include <boost/test/unit_test.hpp>
+
+namespace fs = boost::filesystem;
+using namespace aliceVision;
+
+namespace {
+
+using DescriptorT = feature::SIFT_Regions::DescriptorT;
+
+/**
+ * @brief Write the features of the database views in \p folder: the observations of the
+ * landmarks with a random descriptor per landmark, slightly perturbed in each view.
+ * @return the descriptors of the landmarks
+ */
+std::vector<DescriptorT> writeSyntheticRegions(const sfmData::SfMData& sfmData, const std::string& folder, std::mt19937& generator)
+{
+  std::uniform_int_distribution<int> distValue(0, 255);
+  std::uniform_int_distribution<int> distNoise(-2, 2);
+
+  std::vector<DescriptorT> landmarksDescriptors(sfmData.getLandmarks().size());
+  for(DescriptorT& descriptor : landmarksDescriptors)
+    for(std::size_t i = 0; i < DescriptorT::static_size; ++i)
+      descriptor[i] = static_cast<unsigned char>(distValue(generator));
+
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const IndexT viewId = viewPair.first;
+    feature::SIFT_Regions regions;
+    for(const auto& landmarkPair : sfmData.getLandmarks())
+    {
+      const sfmData::Observation& observation = landmarkPair.second.observations.at(viewId);
+      BOOST_REQUIRE_EQUAL(observation.id_feat, regions.RegionCount());
+      regions.Features().emplace_back(observation.x(0), observation.x(1), 1.f, 0.f);
+
+      DescriptorT descriptor = landmarksDescriptors.at(landmarkPair.first);
+      for(std::size_t i = 0; i < DescriptorT::static_size; ++i)
+        descriptor[i] = static_cast<unsigned char>(std::min(255, std::max(0, descriptor[i] + distNoise(generator))));
+      regions.Descriptors().push_back(descriptor);
+    }
+    const std::string basename = (fs::path(folder) / std::to_string(viewId)).string();
+    regions.Save(basename + ".sift.feat", basename + ".sift.desc");
+  }
+  return landmarksDescriptors;
+}
+
+/// Save a one level vocabulary tree whose words are the descriptors of some landmarks
+void writeVocabularyTree(const std::vector<DescriptorT>& landmarksDescriptors, const std::string& filepath)
+{
+  const uint32_t nbWords = 16;
+  voctree::MutableVocabularyTree<DescriptorT> tree;
+  tree.setSize(1, nbWords);
+  for(uint32_t i = 0; i < nbWords; ++i)
+    tree.centers().push_back(landmarksDescriptors.at(i * landmarksDescriptors.size() / nbWords));
+  tree.validCenters().assign(nbWords, 1);
+  tree.save(filepath);
+}
+
+/**
+ * @brief Synthetic scene of a ring of cameras: the last camera of the ring is the query,
+ * the others are the reconstructed scene whose features and vocabulary tree are written
+ * in a temporary folder.
+ */
+struct SyntheticScene
+{
+  SyntheticScene()
+    : config(1000, 1000, 500, 500, 1.5, 0.0)
+    , dataset(NRealisticCamerasRing(5, 200, config))
+    , folder(fs::temp_directory_path() / fs::unique_path("localization_%%%%%%%%"))
+  {
+    sfmData = sfm::getInputScene(dataset, config, camera::EINTRINSIC::PINHOLE_CAMERA_RADIAL3);
+    sfmData.views.erase(queryViewId);
+    sfmData.getPoses().erase(queryViewId);
+    for(auto& landmarkPair : sfmData.structure)
+    {
+      landmarkPair.second.descType = feature::EImageDescriberType::SIFT;
+      landmarkPair.second.observations.erase(queryViewId);
+    }
+
+    fs::create_directories(folder);
+    vocTreeFilepath = (folder / "vocabulary.sift.tree").string();
+
+    std::mt19937 generator(42);
+    landmarksDescriptors = writeSyntheticRegions(sfmData, folder.string(), generator);
+    writeVocabularyTree(landmarksDescriptors, vocTreeFilepath);
+  }
+
+  ~SyntheticScene()
+  {
+    fs::remove_all(folder);
+  }
+
+  const camera::PinholeRadialK3& intrinsics() const
+  {
+    return dynamic_cast<const camera::PinholeRadialK3&>(*sfmData.getIntrinsics().at(0));
+  }
+
+  /// Query features: the projections of the landmarks seen from \p pose, with their descriptors
+  feature::MapRegionsPerDesc queryRegions(const geometry::Pose3& pose) const
+  {
+    std::unique_ptr<feature::Regions> regions(new feature::SIFT_Regions());
+    feature::SIFT_Regions& siftRegions = static_cast<feature::SIFT_Regions&>(*regions);
+    for(const auto& landmarkPair : sfmData.getLandmarks())
+    {
+      const Vec2 pt = intrinsics().project(pose, landmarkPair.second.X.homogeneous());
+      siftRegions.Features().emplace_back(pt(0), pt(1), 1.f, 0.f);
+      siftRegions.Descriptors().push_back(landmarksDescriptors.at(landmarkPair.first));
+    }
+    feature::MapRegionsPerDesc regionsPerDesc;
+    regionsPerDesc[descTypes.front()] = std::move(regions);
+    return regionsPerDesc;
+  }
+
+  const IndexT queryViewId = 4;
+  const std::vector<feature::EImageDescriberType> descTypes = {feature::EImageDescriberType::SIFT};
+  const NViewDatasetConfigurator config;
+  const NViewDataSet dataset;
+  const fs::path folder;
+  sfmData::SfMData sfmData;
+  std::string vocTreeFilepath;
+  std::vector<DescriptorT> landmarksDescriptors;
+};
+
+localization::VoctreeLocalizer::Parameters localizationParameters()
+{
+  localization::VoctreeLocalizer::Parameters param;
+  param._algorithm = localization::VoctreeLocalizer::Algorithm::AllResults;
+  param._refineIntrinsics = false;
+  return param;
+}
+
+bool localize(localization::VoctreeLocalizer& localizer, const localization::VoctreeLocalizer::Parameters& param,
+              const feature::MapRegionsPerDesc& queryRegions, const camera::PinholeRadialK3& intrinsics,
+              localization::LocalizationResult& localizationResult)
+{
+  std::mt19937 generator(7);
+  camera::PinholeRadialK3 queryIntrinsics = intrinsics;
+  return localizer.localize(queryRegions, {intrinsics.w(), intrinsics.h()}, &param, generator,
+                            true, queryIntrinsics, localizationResult);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(VoctreeLocalizer_indexRoundTrip)
+{
+  makeRandomOperationsReproducible();
+
+  const SyntheticScene scene;
+  const std::string indexFolder = (scene.folder / "index").string();
+
+  localization::VoctreeLocalizer localizer(scene.sfmData, scene.folder.string(), scene.vocTreeFilepath, "", scene.descTypes);
+  BOOST_REQUIRE(localizer.isInit());
+  localizer.saveIndex(indexFolder);
+
+  localization::VoctreeLocalizer indexedLocalizer(scene.sfmData, "", scene.vocTreeFilepath, "", scene.descTypes, indexFolder);
+  BOOST_REQUIRE(indexedLocalizer.isInit());
+
+  // same reconstructed regions
+  const feature::EImageDescriberType descType = scene.descTypes.front();
+  const auto& regionsPerView = localizer.getReconstructedRegions().getData();
+  const auto& indexedRegionsPerView = indexedLocalizer.getReconstructedRegions().getData();
+  BOOST_REQUIRE_EQUAL(regionsPerView.size(), indexedRegionsPerView.size());
+  for(const auto& viewRegions : regionsPerView)
+  {
+    const feature::Regions& regions = *viewRegions.second.at(descType);
+    const feature::Regions& indexedRegions = *indexedRegionsPerView.at(viewRegions.first).at(descType);
+
+    BOOST_REQUIRE_EQUAL(regions.RegionCount(), indexedRegions.RegionCount());
+    BOOST_CHECK_GT(regions.RegionCount(), 0);
+    BOOST_CHECK(regions.Features() == indexedRegions.Features());
+    BOOST_CHECK_EQUAL(std::memcmp(regions.DescriptorRawData(), indexedRegions.DescriptorRawData(),
+                                  regions.RegionCount() * regions.DescriptorByteSize()), 0);
+
+    const auto& landmarks = localizer.getReconstructedRegionsMapping().at(viewRegions.first).at(descType)._associated3dPoint;
+    const auto& indexedLandmarks = indexedLocalizer.getReconstructedRegionsMapping().at(viewRegions.first).at(descType)._associated3dPoint;
+    BOOST_CHECK(landmarks == indexedLandmarks);
+  }
+
+  // same localization
+  const geometry::Pose3 queryPose(scene.dataset._R[scene.queryViewId], scene.dataset._C[scene.queryViewId]);
+  const feature::MapRegionsPerDesc queryRegions = scene.queryRegions(queryPose);
+  const localization::VoctreeLocalizer::Parameters param = localizationParameters();
+
+  localization::LocalizationResult result;
+  localization::LocalizationResult indexedResult;
+  BOOST_REQUIRE(localize(localizer, param, queryRegions, scene.intrinsics(), result));
+  BOOST_REQUIRE(localize(indexedLocalizer, param, queryRegions, scene.intrinsics(), indexedResult));
+
+  BOOST_CHECK(result.getInliers() == indexedResult.getInliers());
+  BOOST_CHECK(result.getPose().rotation().isApprox(indexedResult.getPose().rotation()));
+  BOOST_CHECK(result.getPose().center().isApprox(indexedResult.getPose().center()));
+  BOOST_REQUIRE_EQUAL(result.getMatchedImages().size(), indexedResult.getMatchedImages().size());
+  for(std::size_t i = 0; i < result.getMatchedImages().size(); ++i)
+    BOOST_CHECK_EQUAL(result.getMatchedImages()[i].id, indexedResult.getMatchedImages()[i].id);
+
+  // the pose is the one of the query camera
+  BOOST_CHECK_SMALL((result.getPose().center() - queryPose.center()).norm(), 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(VoctreeLocalizer_frameTracking)
+{
+  makeRandomOperationsReproducible();
+
+  const SyntheticScene scene;
+
+  // two consecutive frames: the second camera slightly moved from the first one
+  const geometry::Pose3 firstPose(scene.dataset._R[scene.queryViewId], scene.dataset._C[scene.queryViewId]);
+  const geometry::Pose3 secondPose(firstPose.rotation(), firstPose.center() + Vec3(0.01, -0.005, 0.01));
+  const feature::MapRegionsPerDesc firstRegions = scene.queryRegions(firstPose);
+  const feature::MapRegionsPerDesc secondRegions = scene.queryRegions(secondPose);
+
+  localization::VoctreeLocalizer::Parameters param = localizationParameters();
+  param._useFrameTracking = true;
+  param._trackingMinInliers = 30;
+
+  {
+    localization::VoctreeLocalizer localizer(scene.sfmData, scene.folder.string(), scene.vocTreeFilepath, "", scene.descTypes);
+    BOOST_REQUIRE(localizer.isInit());
+
+    // the first frame is localized with the database
+    localization::LocalizationResult firstResult;
+    BOOST_REQUIRE(localize(localizer, param, firstRegions, scene.intrinsics(), firstResult));
+    BOOST_CHECK(!localizer.isLastFrameTracked());
+    BOOST_CHECK_SMALL((firstResult.getPose().center() - firstPose.center()).norm(), 1e-3);
+
+    // the second frame is tracked from the first one
+    localization::LocalizationResult secondResult;
+    BOOST_REQUIRE(localize(localizer, param, secondRegions, scene.intrinsics(), secondResult));
+    BOOST_CHECK(localizer.isLastFrameTracked());
+    BOOST_CHECK_GE(secondResult.getInliers().size(), param._trackingMinInliers);
+    BOOST_CHECK_SMALL((secondResult.getPose().center() - secondPose.center()).norm(), 1e-3);
+  }
+
+  {
+    localization::VoctreeLocalizer localizer(scene.sfmData, scene.folder.string(), scene.vocTreeFilepath, "", scene.descTypes);
+    BOOST_REQUIRE(localizer.isInit());
+
+    localization::LocalizationResult firstResult;
+    BOOST_REQUIRE(localize(localizer, param, firstRegions, scene.intrinsics(), firstResult));
+    BOOST_CHECK(!localizer.isLastFrameTracked());
+
+    // more inliers are required than the number of landmarks: the tracking fails
+    // and the second frame is localized with the database
+    param._trackingMinInliers = scene.sfmData.getLandmarks().size() + 1;
+
+    localization::LocalizationResult secondResult;
+    BOOST_REQUIRE(localize(localizer, param, secondRegions, scene.intrinsics(), secondResult));
+    BOOST_CHECK(!localizer.isLastFrameTracked());
+    BOOST_CHECK(secondResult.isValid());
+    BOOST_CHECK_SMALL((secondResult.getPose().center() - secondPose.center()).norm(), 1e-3);
+  }
+}
@@ -14,6 +14,7 @@
 #include "flann/flann.hpp"
 
 #include <memory>
+#include <vector>
 
 namespace aliceVision {
 namespace matching  {
@@ -110,12 +111,13 @@ class ArrayMatcher_kdtreeFlann : public ArrayMatcher<Scalar, Metric>
     if (_index.get() == nullptr || NN > _datasetM->rows)
       return false;
 
-    std::vector<DistanceType> vec_distances(nbQuery * NN);
-    DistanceType * distancePTR = &(vec_distances[0]);
+    // the buffers are kept between the searches to avoid reallocating them
+    _knnDistances.resize(nbQuery * NN);
+    DistanceType * distancePTR = &(_knnDistances[0]);
     flann::Matrix<DistanceType> dists(distancePTR, nbQuery, NN);
 
-    std::vector<int> vec_indices(nbQuery * NN);
-    int * indicePTR = &(vec_indices[0]);
+    _knnIndices.resize(nbQuery * NN);
+    int * indicePTR = &(_knnIndices[0]);
     flann::Matrix<int> indices(indicePTR, nbQuery, NN);
 
     flann::Matrix<Scalar> queries((Scalar*)query, nbQuery, _dimension);
@@ -133,8 +135,8 @@ class ArrayMatcher_kdtreeFlann : public ArrayMatcher<Scalar, Metric>
     {
       for (size_t j = 0; j < NN; ++j)
       {
-          pvec_indices->emplace_back(i, vec_indices[i*NN+j]);
-          pvec_distances->emplace_back(vec_distances[i*NN+j]);
+          pvec_indices->emplace_back(i, _knnIndices[i*NN+j]);
+          pvec_distances->emplace_back(_knnDistances[i*NN+j]);
       }
     }
     return true;
@@ -145,6 +147,8 @@ class ArrayMatcher_kdtreeFlann : public ArrayMatcher<Scalar, Metric>
   std::unique_ptr< flann::Matrix<Scalar> > _datasetM;
   std::unique_ptr< flann::Index<Metric> > _index;
   std::size_t _dimension;
+  std::vector<DistanceType> _knnDistances;
+  std::vector<int> _knnIndices;
 };
 
 } // namespace matching
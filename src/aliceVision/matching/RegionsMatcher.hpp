@@ -100,6 +100,17 @@ public:
   typedef typename ArrayMatcherT::ScalarT Scalar;
   typedef typename ArrayMatcherT::DistanceType DistanceType;
 
+private:
+  // Buffers kept between the Match() calls: a database matched with several
+  // Regions (e.g. a query image against its matched views) only allocates
+  // them for the largest Regions.
+  matching::IndMatches _nnIndices;
+  std::vector<DistanceType> _nnDistances;
+  std::vector<int> _nnRatioIndices;
+  std::vector<float> _distanceRatios;
+
+public:
+
   /**
    * @brief Empty constructor, by default it initializes the database to an empty database.
    */
@@ -140,8 +151,10 @@ public:
     const Scalar * queries = reinterpret_cast<const Scalar *>(queryregions_.DescriptorRawData());
 
     const size_t NNN__ = 2;
-    matching::IndMatches vec_nIndice;
-    std::vector<DistanceType> vec_fDistance;
+    matching::IndMatches& vec_nIndice = _nnIndices;
+    std::vector<DistanceType>& vec_fDistance = _nnDistances;
+    vec_nIndice.clear();
+    vec_fDistance.clear();
 
     // Search the 2 closest features neighbours for each query descriptor
     if (!matcher_.SearchNeighbours(queries, queryregions_.RegionCount(), &vec_nIndice, &vec_fDistance, NNN__))
@@ -149,8 +162,8 @@ public:
 
     assert(vec_nIndice.size() == vec_fDistance.size());
 
-    std::vector<int> vec_nn_ratio_idx;
-    std::vector<float> vec_distanceRatio;
+    std::vector<int>& vec_nn_ratio_idx = _nnRatioIndices;
+    std::vector<float>& vec_distanceRatio = _distanceRatios;
     // Filter the matches using a distance ratio test:
     //   The probability that a match is correct is determined by taking
     //   the ratio of distance from the closest neighbor to the distance
@@ -180,7 +193,7 @@ public:
 
     // Remove matches that have the same (X,Y) coordinates
     matching::IndMatchDecorator<float> matchDeduplicator(vec_putative_matches,
-      regions_.GetRegionsPositions(), queryregions_.GetRegionsPositions());
+      regions_.Features(), queryregions_.Features());
     matchDeduplicator.getDeduplicated(vec_putative_matches);
 
     return (!vec_putative_matches.empty());
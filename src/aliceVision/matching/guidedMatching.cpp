@@ -7,9 +7,99 @@
 
 #include "guidedMatching.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace aliceVision {
 namespace matching {
 
+void guidedMatchingFromPredictions(const feature::Regions& lRegions,
+                                   const Mat2X& lPredictedPositions,
+                                   const feature::Regions& rRegions,
+                                   double radius,
+                                   double distRatio,
+                                   matching::IndMatches& out_matches)
+{
+  assert(lPredictedPositions.cols() == lRegions.RegionCount());
+  assert(radius > 0.0);
+
+  if(rRegions.RegionCount() == 0)
+    return;
+
+  // sort the right regions in a grid of cells of the radius size (counting sort)
+  const std::vector<feature::PointFeature>& rFeatures = rRegions.Features();
+  float maxX = 0.f;
+  float maxY = 0.f;
+  for(const feature::PointFeature& feat : rFeatures)
+  {
+    maxX = std::max(maxX, feat.x());
+    maxY = std::max(maxY, feat.y());
+  }
+  const int gridWidth = static_cast<int>(maxX / radius) + 1;
+  const int gridHeight = static_cast<int>(maxY / radius) + 1;
+  const auto cellIndex = [&](double x, double y)
+  {
+    const int cx = std::min(std::max(static_cast<int>(x / radius), 0), gridWidth - 1);
+    const int cy = std::min(std::max(static_cast<int>(y / radius), 0), gridHeight - 1);
+    return cy * gridWidth + cx;
+  };
+
+  std::vector<std::size_t> cellOffsets(gridWidth * gridHeight + 1, 0);
+  for(const feature::PointFeature& feat : rFeatures)
+    ++cellOffsets[cellIndex(feat.x(), feat.y()) + 1];
+  for(std::size_t c = 1; c < cellOffsets.size(); ++c)
+    cellOffsets[c] += cellOffsets[c - 1];
+  std::vector<std::size_t> cellRegions(rFeatures.size());
+  {
+    std::vector<std::size_t> cellFill(cellOffsets.begin(), cellOffsets.end() - 1);
+    for(std::size_t j = 0; j < rFeatures.size(); ++j)
+      cellRegions[cellFill[cellIndex(rFeatures[j].x(), rFeatures[j].y())]++] = j;
+  }
+
+  const double squaredRadius = radius * radius;
+
+  for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
+  {
+    const Vec2 predicted = lPredictedPositions.col(i);
+    if(!predicted.allFinite() ||
+       predicted(0) < -radius || predicted(1) < -radius ||
+       predicted(0) > maxX + radius || predicted(1) > maxY + radius)
+      continue;
+
+    const int minCx = std::max(static_cast<int>(std::floor((predicted(0) - radius) / radius)), 0);
+    const int maxCx = std::min(static_cast<int>(std::floor((predicted(0) + radius) / radius)), gridWidth - 1);
+    const int minCy = std::max(static_cast<int>(std::floor((predicted(1) - radius) / radius)), 0);
+    const int maxCy = std::min(static_cast<int>(std::floor((predicted(1) + radius) / radius)), gridHeight - 1);
+
+    distanceRatio<double> dR;
+    std::size_t nbCandidates = 0;
+    for(int cy = minCy; cy <= maxCy; ++cy)
+    {
+      for(int cx = minCx; cx <= maxCx; ++cx)
+      {
+        const int cell = cy * gridWidth + cx;
+        for(std::size_t k = cellOffsets[cell]; k < cellOffsets[cell + 1]; ++k)
+        {
+          const std::size_t j = cellRegions[k];
+          if((rRegions.GetRegionPosition(j) - predicted).squaredNorm() > squaredRadius)
+            continue;
+          dR.update(j, lRegions.SquaredDescriptorDistance(i, &rRegions, j));
+          ++nbCandidates;
+        }
+      }
+    }
+    // add correspondence only iff the distance ratio is valid or the candidate is unique
+    if(nbCandidates == 1 || dR.isValid(distRatio))
+    {
+      // save the best corresponding index
+      out_matches.emplace_back(i, dR.idx);
+    }
+  }
+
+  // remove duplicates (when multiple points at same position exist)
+  matching::IndMatch::getDeduplicated(out_matches);
+}
+
 unsigned int pix_to_bucket(const Vec2i& x, int W, int H)
 {
     if(x(1) == 0)
@@ -315,6 +315,29 @@ void guidedMatching(const ModelT& mod,
   }
 }
 
+/**
+ * @brief Guided Matching (predicted positions + descriptors with distance ratio):
+ *        Match regions whose position in the right image is predicted (e.g. landmarks
+ *        projected with a predicted pose) with the regions of the right image.
+ *        Only the right regions within a radius of the predicted position are compared,
+ *        they are looked up in a grid of cells of the radius size.
+ *        A region with a single candidate in its search window is matched to it.
+ *
+ * @param[in] lRegions regions (descriptors) with a predicted position
+ * @param[in] lPredictedPositions the predicted positions of the left regions in the right image,
+ *            the non finite positions are ignored
+ * @param[in] rRegions regions (point features & corresponding descriptors)
+ * @param[in] radius Search radius around the predicted positions (in pixels)
+ * @param[in] distRatio Maximal authorized distance ratio
+ * @param[out] out_matches Ouput corresponding index
+ */
+void guidedMatchingFromPredictions(const feature::Regions& lRegions,
+                                   const Mat2X& lPredictedPositions,
+                                   const feature::Regions& rRegions,
+                                   double radius,
+                                   double distRatio,
+                                   matching::IndMatches& out_matches);
+
 /**
  * @brief Compute a bucket index from an epipolar point
  *        (the one that is closer to image border intersection)
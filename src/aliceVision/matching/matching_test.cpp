@@ -9,6 +9,7 @@
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
+#include "aliceVision/matching/guidedMatching.hpp"
 #include <iostream>
 
 #define BOOST_TEST_MODULE matching
@@ -169,3 +170,28 @@ BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_Simple_EmptyArrays)
   float fDistance = -1.0f;
   BOOST_CHECK(! matcher.SearchNeighbour( &array[0], &nIndice, &fDistance) );
 }
+
+BOOST_AUTO_TEST_CASE(Matching_guidedMatchingFromPredictions)
+{
+  using Regions2D = feature::ScalarRegions<float, 2>;
+
+  Regions2D rRegions;
+  rRegions.Features() = {feature::PointFeature(10.f, 10.f, 1.f, 0.f), feature::PointFeature(50.f, 50.f, 1.f, 0.f), feature::PointFeature(53.f, 50.f, 1.f, 0.f)};
+  rRegions.Descriptors() = {Regions2D::DescriptorT(0.f), Regions2D::DescriptorT(5.f), Regions2D::DescriptorT(1.f)};
+
+  Regions2D lRegions;
+  lRegions.Descriptors() = {Regions2D::DescriptorT(0.f), Regions2D::DescriptorT(1.1f), Regions2D::DescriptorT(0.f)};
+  lRegions.Features().resize(3);
+
+  Mat2X predicted(2, 3);
+  predicted.col(0) = Vec2(12.0, 11.0);  // single candidate in the window
+  predicted.col(1) = Vec2(51.0, 50.0);  // two candidates, the closest descriptor passes the ratio test
+  predicted.col(2) = Vec2::Constant(std::numeric_limits<double>::quiet_NaN()); // not visible
+
+  IndMatches matches;
+  guidedMatchingFromPredictions(lRegions, predicted, rRegions, 5.0, 0.8, matches);
+
+  BOOST_REQUIRE_EQUAL(matches.size(), 2);
+  BOOST_CHECK_EQUAL(matches[0], IndMatch(0, 0));
+  BOOST_CHECK_EQUAL(matches[1], IndMatch(1, 2));
+}
@@ -12,9 +12,14 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
 
 #include <boost/progress.hpp>
 
+#include <algorithm>
+#include <numeric>
+#include <random>
 #include <vector>
 #include <map>
 
@@ -51,23 +56,49 @@ void robustModelEstimation(
 {
   out_geometricMatches.clear();
 
+  // process the pairs with the most putative matches first, so that the
+  // longest estimations do not end up alone at the end of the loop
+  std::vector<PairwiseMatches::const_iterator> pairs;
+  pairs.reserve(putativeMatches.size());
+  for(PairwiseMatches::const_iterator iter = putativeMatches.begin(); iter != putativeMatches.end(); ++iter)
+    pairs.push_back(iter);
+
+  std::vector<std::size_t> nbPutativeMatches(pairs.size());
+  for(std::size_t i = 0; i < pairs.size(); ++i)
+    nbPutativeMatches[i] = pairs[i]->second.getNbAllMatches();
+
+  std::vector<std::size_t> order(pairs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return nbPutativeMatches[a] > nbPutativeMatches[b];
+  });
+
+  // one random generator per pair, seeded in the pairs order:
+  // the threads do not share a generator and the result does not depend on the scheduling
+  std::vector<std::mt19937::result_type> seeds(pairs.size());
+  for(auto& seed : seeds)
+    seed = randomNumberGenerator();
+
+  std::vector<MatchesPerDescType> geometricMatchesPerPair(pairs.size());
+  std::vector<char> isValid(pairs.size(), false);
+  std::vector<double> pairTimes(pairs.size(), 0.0);
+
   boost::progress_display progressBar(putativeMatches.size(), std::cout, "Robust Model Estimation\n");
-  
+
 #pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < (int)putativeMatches.size(); ++i)
+  for (int o = 0; o < (int)order.size(); ++o)
   {
-    PairwiseMatches::const_iterator iter = putativeMatches.begin();
-    std::advance(iter, i);
-
-    const Pair currentPair = iter->first;
-    const MatchesPerDescType& putativeMatchesPerType = iter->second;
-    const Pair& imagePair = iter->first;
+    const std::size_t i = order[o];
+    const Pair& imagePair = pairs[i]->first;
+    const MatchesPerDescType& putativeMatchesPerType = pairs[i]->second;
+    std::mt19937 pairRandomNumberGenerator(seeds[i]);
+    const system::Timer timer;
 
     // apply the geometric filter (robust model estimation)
     {
       MatchesPerDescType inliers;
       GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
-      const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, randomNumberGenerator, inliers);
+      const EstimationStatus state = geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, pairRandomNumberGenerator, inliers);
       if(state.hasStrongSupport)
       {
         if(guidedMatching)
@@ -78,19 +109,40 @@ void robustModelEstimation(
           std::swap(inliers, guidedGeometricInliers);
         }
 
-#pragma omp critical
-        {
-          out_geometricMatches.emplace(currentPair, std::move(inliers));
-        }
-
+        geometricMatchesPerPair[i] = std::move(inliers);
+        isValid[i] = true;
       }
     }
 
+    pairTimes[i] = timer.elapsed();
+
 #pragma omp critical
     {
       ++progressBar;
     }
   }
+
+  for(std::size_t i = 0; i < pairs.size(); ++i)
+  {
+    if(isValid[i])
+      out_geometricMatches.emplace_hint(out_geometricMatches.end(), pairs[i]->first, std::move(geometricMatchesPerPair[i]));
+  }
+
+  // per-pair timing statistics
+  if(!pairs.empty())
+  {
+    const std::size_t slowest = std::max_element(pairTimes.begin(), pairTimes.end()) - pairTimes.begin();
+    const double totalTime = std::accumulate(pairTimes.begin(), pairTimes.end(), 0.0);
+    std::vector<double> sortedTimes = pairTimes;
+    std::nth_element(sortedTimes.begin(), sortedTimes.begin() + sortedTimes.size() / 2, sortedTimes.end());
+
+    ALICEVISION_LOG_INFO("Robust model estimation of " << pairs.size() << " pairs (" << out_geometricMatches.size() << " valid):" << std::endl
+                         << "\t- total time (all threads): " << totalTime << " s" << std::endl
+                         << "\t- mean time per pair: " << 1000.0 * totalTime / pairs.size() << " ms" << std::endl
+                         << "\t- median time per pair: " << 1000.0 * sortedTimes[sortedTimes.size() / 2] << " ms" << std::endl
+                         << "\t- slowest pair: (" << pairs[slowest]->first.first << ", " << pairs[slowest]->first.second << "), "
+                         << nbPutativeMatches[slowest] << " putative matches, " << 1000.0 * pairTimes[slowest] << " ms");
+  }
 }
 
 } // namespace matchingImageCollection
@@ -58,6 +58,7 @@ struct GeometricFilterMatrix
   double m_dPrecision;  //upper_bound precision used for robust estimation
   double m_dPrecision_robust;
   std::size_t m_stIteration; //maximal number of iteration for robust estimation
+  bool m_adaptiveIterations = false; //bound the ACRansac focused sampling iterations by the inlier ratio found
 };
 
 
@@ -232,7 +232,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
       const double upper_bound_precision = Square(m_dPrecision);
 
       robustEstimation::Mat3Model model;
-      const std::pair<double, double> ACRansacOut = ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upper_bound_precision);
+      const std::pair<double, double> ACRansacOut = ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upper_bound_precision, m_adaptiveIterations);
 
       m_F = model.getMatrix();
 
@@ -280,7 +280,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
     const double upperBoundPrecision = Square(m_dPrecision);
 
     ModelT_ model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upperBoundPrecision);
+    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upperBoundPrecision, m_adaptiveIterations);
     m_F = model.getMatrix();
 
     if(out_inliers.empty())
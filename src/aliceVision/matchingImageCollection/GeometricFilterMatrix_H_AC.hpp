@@ -78,7 +78,7 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
 
     std::vector<std::size_t> inliers;
     robustEstimation::Mat3Model model;
-    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision);
+    const std::pair<double,double> ACRansacOut = robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision, m_adaptiveIterations);
     m_H = model.getMatrix();
 
     if (inliers.empty())
@@ -11,6 +11,7 @@
 #include <aliceVision/robustEstimation/conditioning.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
 #include <aliceVision/robustEstimation/PointFittingRansacKernel.hpp>
+#include <aliceVision/system/Logger.hpp>
 
 namespace aliceVision {
 namespace multiview {
@@ -154,6 +155,14 @@ public:
     return _errorEstimator.error(modelF, PFRansacKernel::PFKernel::_x1.col(sample), PFRansacKernel::PFKernel::_x2.col(sample));
   }
 
+  void errors(const ModelT_& model, std::vector<double>& errors) const override
+  {
+    Mat3 F;
+    fundamentalFromEssential(model.getMatrix(), _K1, _K2, &F);
+    const ModelT_ modelF(F);
+    PFRansacKernel::errors(modelF, errors);
+  }
+
   void unnormalize(ModelT_& model) const override
   {
     // do nothing, no normalization in this case
@@ -13,9 +13,9 @@ namespace aliceVision {
 namespace multiview {
 namespace relativePose {
 
-Vec o1(const Vec& a, const Vec& b)
+Vec20 o1(const Vec20& a, const Vec20& b)
 {
-  Vec res = Vec::Zero(20);
+  Vec20 res = Vec20::Zero();
 
   res(Pc::coef_xx) = a(Pc::coef_x) * b(Pc::coef_x);
   res(Pc::coef_xy) = a(Pc::coef_x) * b(Pc::coef_y)
@@ -37,9 +37,9 @@ Vec o1(const Vec& a, const Vec& b)
   return res;
 }
 
-Vec o2(const Vec& a, const Vec& b)
+Vec20 o2(const Vec20& a, const Vec20& b)
 {
-  Vec res(20);
+  Vec20 res;
 
   res(Pc::coef_xxx) = a(Pc::coef_xx) * b(Pc::coef_x);
   res(Pc::coef_xxy) = a(Pc::coef_xx) * b(Pc::coef_y)
@@ -88,7 +88,7 @@ Vec o2(const Vec& a, const Vec& b)
 /**
  * @brief Compute the nullspace of the linear constraints given by the matches.
  */
-Mat fivePointsNullspaceBasis(const Mat2X& x1, const Mat2X& x2)
+Eigen::Matrix<double, 9, 4> fivePointsNullspaceBasis(const Mat& x1, const Mat& x2)
 {
   Eigen::Matrix<double,9, 9> A;
   A.setZero();  // make A square until Eigen supports rectangular SVD.
@@ -100,13 +100,13 @@ Mat fivePointsNullspaceBasis(const Mat2X& x1, const Mat2X& x2)
 /**
  * @brief Builds the polynomial constraint matrix M.
  */
-Mat fivePointsPolynomialConstraints(const Mat& EBasis)
+Eigen::Matrix<double, 10, 20> fivePointsPolynomialConstraints(const Eigen::Matrix<double, 9, 4>& EBasis)
 {
   // build the polynomial form of E (equation (8) in Stewenius et al. [1])
-  Vec E[3][3];
+  Vec20 E[3][3];
   for (int i = 0; i < 3; ++i) {
     for (int j = 0; j < 3; ++j) {
-      E[i][j] = Vec::Zero(20);
+      E[i][j] = Vec20::Zero();
       E[i][j](Pc::coef_x) = EBasis(3 * i + j, 0);
       E[i][j](Pc::coef_y) = EBasis(3 * i + j, 1);
       E[i][j](Pc::coef_z) = EBasis(3 * i + j, 2);
@@ -115,7 +115,7 @@ Mat fivePointsPolynomialConstraints(const Mat& EBasis)
   }
 
   // the constraint matrix.
-  Mat M(10, 20);
+  Eigen::Matrix<double, 10, 20> M;
   int mrow = 0;
 
   // determinant constraint det(E) = 0; equation (19) of Nister [2].
@@ -125,7 +125,7 @@ Mat fivePointsPolynomialConstraints(const Mat& EBasis)
 
   // cubic singular values constraint.
   // equation (20).
-  Vec EET[3][3];
+  Vec20 EET[3][3];
   for (int i = 0; i < 3; ++i) {    // since EET is symmetric, we only compute
     for (int j = 0; j < 3; ++j) {  // its upper triangular part.
       if (i <= j) {
@@ -139,8 +139,8 @@ Mat fivePointsPolynomialConstraints(const Mat& EBasis)
   }
 
   // equation (21).
-  Vec (&L)[3][3] = EET;
-  Vec trace  = 0.5 * (EET[0][0] + EET[1][1] + EET[2][2]);
+  Vec20 (&L)[3][3] = EET;
+  const Vec20 trace  = 0.5 * (EET[0][0] + EET[1][1] + EET[2][2]);
   for (int i = 0; i < 3; ++i) {
     L[i][i] -= trace;
   }
@@ -148,7 +148,7 @@ Mat fivePointsPolynomialConstraints(const Mat& EBasis)
   // equation (23).
   for (int i = 0; i < 3; ++i) {
     for (int j = 0; j < 3; ++j) {
-      Vec LEij = o2(L[i][0], E[0][j])
+      const Vec20 LEij = o2(L[i][0], E[0][j])
                + o2(L[i][1], E[1][j])
                + o2(L[i][2], E[2][j]);
       M.row(mrow++) = LEij;
@@ -31,6 +31,25 @@ struct FundamentalSampsonError : public ISolverErrorRelativePose<robustEstimatio
 
     return Square(y.dot(F_x)) / (  F_x.head<2>().squaredNorm() + Ft_y.head<2>().squaredNorm());
   }
+
+  void errors(const robustEstimation::Mat3Model& F, const Eigen::Ref<const RMat>& x1, const Eigen::Ref<const RMat>& x2, Eigen::Ref<Vec> errors) const override
+  {
+    const Mat3& f = F.getMatrix();
+    const auto u1 = x1.row(0).transpose().array();
+    const auto v1 = x1.row(1).transpose().array();
+    const auto u2 = x2.row(0).transpose().array();
+    const auto v2 = x2.row(1).transpose().array();
+
+    // F * x
+    const auto a = f(0, 0) * u1 + f(0, 1) * v1 + f(0, 2);
+    const auto b = f(1, 0) * u1 + f(1, 1) * v1 + f(1, 2);
+    const auto c = f(2, 0) * u1 + f(2, 1) * v1 + f(2, 2);
+    // F^t * y
+    const auto at = f(0, 0) * u2 + f(1, 0) * v2 + f(2, 0);
+    const auto bt = f(0, 1) * u2 + f(1, 1) * v2 + f(2, 1);
+
+    errors.array() = (u2 * a + v2 * b + c).square() / (a.square() + b.square() + at.square() + bt.square());
+  }
 };
 
 struct FundamentalSymmetricEpipolarDistanceError: public ISolverErrorRelativePose<robustEstimation::Mat3Model>
@@ -47,6 +66,25 @@ struct FundamentalSymmetricEpipolarDistanceError: public ISolverErrorRelativePos
     // @note the divide by 4 is to make this match the Sampson distance.
     return Square(y.dot(F_x)) * ( 1.0 / F_x.head<2>().squaredNorm() + 1.0 / Ft_y.head<2>().squaredNorm()) / 4.0;
   }
+
+  void errors(const robustEstimation::Mat3Model& F, const Eigen::Ref<const RMat>& x1, const Eigen::Ref<const RMat>& x2, Eigen::Ref<Vec> errors) const override
+  {
+    const Mat3& f = F.getMatrix();
+    const auto u1 = x1.row(0).transpose().array();
+    const auto v1 = x1.row(1).transpose().array();
+    const auto u2 = x2.row(0).transpose().array();
+    const auto v2 = x2.row(1).transpose().array();
+
+    // F * x
+    const auto a = f(0, 0) * u1 + f(0, 1) * v1 + f(0, 2);
+    const auto b = f(1, 0) * u1 + f(1, 1) * v1 + f(1, 2);
+    const auto c = f(2, 0) * u1 + f(2, 1) * v1 + f(2, 2);
+    // F^t * y
+    const auto at = f(0, 0) * u2 + f(1, 0) * v2 + f(2, 0);
+    const auto bt = f(0, 1) * u2 + f(1, 1) * v2 + f(2, 1);
+
+    errors.array() = (u2 * a + v2 * b + c).square() * ((a.square() + b.square()).inverse() + (at.square() + bt.square()).inverse()) / 4.0;
+  }
 };
 
 struct FundamentalEpipolarDistanceError : public ISolverErrorRelativePose<robustEstimation::Mat3Model>
@@ -61,6 +99,22 @@ struct FundamentalEpipolarDistanceError : public ISolverErrorRelativePose<robust
 
     return Square(F_x.dot(y)) /  F_x.head<2>().squaredNorm();
   }
+
+  void errors(const robustEstimation::Mat3Model& F, const Eigen::Ref<const RMat>& x1, const Eigen::Ref<const RMat>& x2, Eigen::Ref<Vec> errors) const override
+  {
+    const Mat3& f = F.getMatrix();
+    const auto u1 = x1.row(0).transpose().array();
+    const auto v1 = x1.row(1).transpose().array();
+    const auto u2 = x2.row(0).transpose().array();
+    const auto v2 = x2.row(1).transpose().array();
+
+    // F * x
+    const auto a = f(0, 0) * u1 + f(0, 1) * v1 + f(0, 2);
+    const auto b = f(1, 0) * u1 + f(1, 1) * v1 + f(1, 2);
+    const auto c = f(2, 0) * u1 + f(2, 1) * v1 + f(2, 2);
+
+    errors.array() = (a * u2 + b * v2 + c).square() / (a.square() + b.square());
+  }
 };
 
 
@@ -28,6 +28,22 @@ struct HomographyAsymmetricError : ISolverErrorRelativePose<robustEstimation::Ma
         const Vec2 x2_est = x2h_est.head<2>() / x2h_est[2];
         return (x2 - x2_est).squaredNorm();
     }
+
+    void errors(const robustEstimation::Mat3Model& H, const Eigen::Ref<const RMat>& x1, const Eigen::Ref<const RMat>& x2, Eigen::Ref<Vec> errors) const override
+    {
+        const Mat3& h = H.getMatrix();
+        const auto u1 = x1.row(0).transpose().array();
+        const auto v1 = x1.row(1).transpose().array();
+        const auto u2 = x2.row(0).transpose().array();
+        const auto v2 = x2.row(1).transpose().array();
+
+        // H * x
+        const auto a = h(0, 0) * u1 + h(0, 1) * v1 + h(0, 2);
+        const auto b = h(1, 0) * u1 + h(1, 1) * v1 + h(1, 2);
+        const auto c = h(2, 0) * u1 + h(2, 1) * v1 + h(2, 2);
+
+        errors.array() = (u2 - a / c).square() + (v2 - b / c).square();
+    }
 };
 
 }  // namespace relativePose
@@ -20,6 +20,19 @@ template <typename ModelT>
 struct ISolverErrorRelativePose
 {
   virtual double error(const ModelT& model, const Vec2& x1, const Vec2& x2) const = 0;
+
+  /**
+   * @brief Compute the errors of a set of correspondences.
+   * @param[in] model The model
+   * @param[in] x1 The points of the first view, one row per coordinate (SoA layout)
+   * @param[in] x2 The points of the second view, one row per coordinate (SoA layout)
+   * @param[out] errors The error of each correspondence
+   */
+  virtual void errors(const ModelT& model, const Eigen::Ref<const RMat>& x1, const Eigen::Ref<const RMat>& x2, Eigen::Ref<Vec> errors) const
+  {
+    for(Eigen::Index i = 0; i < x1.cols(); ++i)
+      errors(i) = error(model, x1.col(i), x2.col(i));
+  }
 };
 
 }  // namespace relativePose
@@ -133,3 +133,34 @@ BOOST_AUTO_TEST_CASE(NormalizedFundamental8PKernel_EasyCase)
 
   BOOST_CHECK(expectKernelProperties<relativePose::NormalizedFundamental8PKernel>(x1, x2));
 }
+
+// check that the batch errors of an error functor match its point by point errors
+template<class ErrorT>
+bool expectBatchErrors(const Mat3& F, const Mat& x1, const Mat& x2)
+{
+  const ErrorT errorEstimator;
+  const robustEstimation::Mat3Model model(F);
+  const RMat x1Rows = x1;
+  const RMat x2Rows = x2;
+  Vec errors(x1.cols());
+  errorEstimator.errors(model, x1Rows, x2Rows, errors);
+
+  bool bOk = true;
+  for(int i = 0; i < x1.cols(); ++i)
+  {
+    const double error = errorEstimator.error(model, x1.col(i), x2.col(i));
+    bOk &= std::abs(errors(i) - error) <= 1e-9 * std::max(1.0, error);
+  }
+  return bOk;
+}
+
+BOOST_AUTO_TEST_CASE(FundamentalError_BatchErrors)
+{
+  const Mat3 F = Mat3::Random();
+  const Mat x1 = 100.0 * Mat::Random(2, 1000);
+  const Mat x2 = 100.0 * Mat::Random(2, 1000);
+
+  BOOST_CHECK(expectBatchErrors<relativePose::FundamentalSampsonError>(F, x1, x2));
+  BOOST_CHECK(expectBatchErrors<relativePose::FundamentalSymmetricEpipolarDistanceError>(F, x1, x2));
+  BOOST_CHECK(expectBatchErrors<relativePose::FundamentalEpipolarDistanceError>(F, x1, x2));
+}
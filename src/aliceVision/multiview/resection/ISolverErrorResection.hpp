@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <aliceVision/numeric/numeric.hpp>
+
 namespace aliceVision {
 namespace multiview {
 namespace resection {
@@ -17,6 +19,19 @@ template <typename ModelT>
 struct ISolverErrorResection
 {
   virtual double error(const ModelT& model, const Vec2& x2d, const Vec3& x3d) const = 0;
+
+  /**
+   * @brief Compute the errors of a set of 2D-3D correspondences.
+   * @param[in] model The model
+   * @param[in] x2d The 2D points, one row per coordinate (SoA layout)
+   * @param[in] x3d The 3D points, one row per coordinate (SoA layout)
+   * @param[out] errors The error of each correspondence
+   */
+  virtual void errors(const ModelT& model, const Eigen::Ref<const RMat>& x2d, const Eigen::Ref<const RMat>& x3d, Eigen::Ref<Vec> errors) const
+  {
+    for(Eigen::Index i = 0; i < x2d.cols(); ++i)
+      errors(i) = error(model, x2d.col(i), x3d.col(i));
+  }
 };
 
 }  // namespace resection
@@ -16,6 +16,27 @@ namespace aliceVision {
 namespace multiview {
 namespace resection {
 
+/**
+ * @brief Compute the squared projection distances of a set of 2D-3D correspondences
+ * @param[in] P The projection matrix
+ * @param[in] x2d The 2D points, one row per coordinate (SoA layout)
+ * @param[in] x3d The 3D points, one row per coordinate (SoA layout)
+ * @param[out] errors The squared projection distance of each correspondence
+ */
+inline void projectionSquaredDistances(const Mat34& P, const Eigen::Ref<const RMat>& x2d, const Eigen::Ref<const RMat>& x3d, Eigen::Ref<Vec> errors)
+{
+  const auto X = x3d.row(0).transpose().array();
+  const auto Y = x3d.row(1).transpose().array();
+  const auto Z = x3d.row(2).transpose().array();
+
+  // P * [X; 1]
+  const auto a = P(0, 0) * X + P(0, 1) * Y + P(0, 2) * Z + P(0, 3);
+  const auto b = P(1, 0) * X + P(1, 1) * Y + P(1, 2) * Z + P(1, 3);
+  const auto c = P(2, 0) * X + P(2, 1) * Y + P(2, 2) * Z + P(2, 3);
+
+  errors.array() = (a / c - x2d.row(0).transpose().array()).square() + (b / c - x2d.row(1).transpose().array()).square();
+}
+
 /**
  * @brief Compute the residual of the projection distance
  *        (pt2D, project(P,pt3D))
@@ -26,6 +47,12 @@ struct ProjectionDistanceError : public ISolverErrorResection<robustEstimation::
   {
     return (project(P.getMatrix(), p3d) - p2d).norm();
   }
+
+  void errors(const robustEstimation::Mat34Model& P, const Eigen::Ref<const RMat>& x2d, const Eigen::Ref<const RMat>& x3d, Eigen::Ref<Vec> errors) const override
+  {
+    projectionSquaredDistances(P.getMatrix(), x2d, x3d, errors);
+    errors = errors.cwiseSqrt();
+  }
 };
 
 /**
@@ -38,6 +65,11 @@ struct ProjectionDistanceSquaredError : public ISolverErrorResection<robustEstim
   {
     return (project(P.getMatrix(), p3d) - p2d).squaredNorm();
   }
+
+  void errors(const robustEstimation::Mat34Model& P, const Eigen::Ref<const RMat>& x2d, const Eigen::Ref<const RMat>& x3d, Eigen::Ref<Vec> errors) const override
+  {
+    projectionSquaredDistances(P.getMatrix(), x2d, x3d, errors);
+  }
 };
 
 }  // namespace resection
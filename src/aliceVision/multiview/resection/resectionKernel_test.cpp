@@ -56,6 +56,27 @@ BOOST_AUTO_TEST_CASE(Resection_Kernel_Multiview)
   }
 }
 
+BOOST_AUTO_TEST_CASE(Resection_Kernel_BatchErrors)
+{
+  const int nViews = 3;
+  const int nbPoints = 1000;
+  const NViewDataSet d = NRealisticCamerasRing(nViews, nbPoints,
+    NViewDatasetConfigurator(1000,1000,500,500,5,0));
+
+  // the kernel computes the errors by blocks of points in SoA layout
+  const Mat x = d._x[2] + 0.5 * Mat::Random(2, nbPoints);
+  const Mat X = d._X;
+  const resection::Resection6PKernel kernel(x, X);
+  const robustEstimation::Mat34Model P(d.P(2));
+
+  std::vector<double> errors;
+  kernel.errors(P, errors);
+
+  BOOST_CHECK_EQUAL(errors.size(), nbPoints);
+  for(std::size_t i = 0; i < x.cols(); ++i)
+    BOOST_CHECK_SMALL(errors[i] - kernel.error(i, P), 1e-9);
+}
+
 /*
 BOOST_AUTO_TEST_CASE(P3P_Kneip_CVPR11_Multiview)
 {
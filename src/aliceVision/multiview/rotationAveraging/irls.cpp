@@ -0,0 +1,526 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "irls.hpp"
+#include <aliceVision/multiview/rotationAveraging/l2.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <Eigen/SparseCholesky>
+#include <Eigen/IterativeLinearSolvers>
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+namespace aliceVision   {
+namespace rotationAveraging  {
+namespace irls  {
+
+namespace {
+
+typedef Eigen::SparseMatrix<double, Eigen::ColMajor, int> SparseMat;
+typedef Eigen::SparseMatrix<double, Eigen::RowMajor, int> SparseMatRowMajor;
+typedef Eigen::Matrix<double, Eigen::Dynamic, 3> MatX3;
+
+/// Relative rotation seen from one of its two poses
+struct Incidence
+{
+  /// index of the relative rotation
+  std::size_t edge;
+  /// true if the pose is the first one (i) of the relative rotation
+  bool isFirst;
+  /// slot of the other pose in the column of this pose, -1 if the other pose is the main view
+  int otherSlot;
+};
+
+/**
+ * @brief View graph stored as compressed incidence lists and the sparsity pattern of its normal equations.
+ *
+ * The main view is fixed, the other poses are the unknowns. The column of an unknown contains
+ * one block per neighbouring unknown and one diagonal block, sorted by unknown index.
+ * The pattern is built once and the values are filled in parallel, one column per thread.
+ */
+class ViewGraph
+{
+public:
+  bool build(const RelativeRotations& relRs, std::size_t nbPoses, std::size_t mainPose)
+  {
+    if(mainPose >= nbPoses)
+    {
+      ALICEVISION_LOG_WARNING("Rotation averaging: invalid main view " << mainPose << " (" << nbPoses << " poses).");
+      return false;
+    }
+
+    // compressed incidence lists
+    _incidenceOffsets.assign(nbPoses + 1, 0);
+    for(const RelativeRotation& relR : relRs)
+    {
+      if(relR.i >= nbPoses || relR.j >= nbPoses || relR.i == relR.j)
+      {
+        ALICEVISION_LOG_WARNING("Rotation averaging: invalid relative rotation (" << relR.i << ", " << relR.j << ").");
+        return false;
+      }
+      ++_incidenceOffsets[relR.i + 1];
+      ++_incidenceOffsets[relR.j + 1];
+    }
+    for(std::size_t pose = 0; pose < nbPoses; ++pose)
+      _incidenceOffsets[pose + 1] += _incidenceOffsets[pose];
+
+    _incidences.resize(_incidenceOffsets.back());
+    {
+      std::vector<std::size_t> fill(_incidenceOffsets.begin(), _incidenceOffsets.end() - 1);
+      for(std::size_t edge = 0; edge < relRs.size(); ++edge)
+      {
+        _incidences[fill[relRs[edge].i]++] = {edge, true, -1};
+        _incidences[fill[relRs[edge].j]++] = {edge, false, -1};
+      }
+    }
+
+    // the normal equations are singular if the graph is not connected
+    {
+      std::vector<bool> visited(nbPoses, false);
+      std::queue<std::size_t> queue;
+      queue.push(mainPose);
+      visited[mainPose] = true;
+      std::size_t nbVisited = 1;
+      while(!queue.empty())
+      {
+        const std::size_t pose = queue.front();
+        queue.pop();
+        for(std::size_t k = _incidenceOffsets[pose]; k < _incidenceOffsets[pose + 1]; ++k)
+        {
+          const std::size_t other = otherPose(relRs, _incidences[k]);
+          if(!visited[other])
+          {
+            visited[other] = true;
+            ++nbVisited;
+            queue.push(other);
+          }
+        }
+      }
+      if(nbVisited != nbPoses)
+      {
+        ALICEVISION_LOG_WARNING("Rotation averaging: the view graph is not connected (" << nbVisited << " / " << nbPoses << " poses reachable).");
+        return false;
+      }
+    }
+
+    // unknowns indexing
+    _unknownPerPose.resize(nbPoses);
+    _posePerUnknown.clear();
+    _posePerUnknown.reserve(nbPoses - 1);
+    for(std::size_t pose = 0; pose < nbPoses; ++pose)
+    {
+      _unknownPerPose[pose] = (pose == mainPose) ? -1 : static_cast<int>(_posePerUnknown.size());
+      if(pose != mainPose)
+        _posePerUnknown.push_back(pose);
+    }
+
+    // blocks of each column
+    const int nbUnknowns = static_cast<int>(_posePerUnknown.size());
+    std::vector<std::vector<int>> blocksPerUnknown(nbUnknowns);
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(int unknown = 0; unknown < nbUnknowns; ++unknown)
+    {
+      const std::size_t pose = _posePerUnknown[unknown];
+      std::vector<int>& blocks = blocksPerUnknown[unknown];
+      blocks.reserve(_incidenceOffsets[pose + 1] - _incidenceOffsets[pose] + 1);
+      blocks.push_back(unknown);
+      for(std::size_t k = _incidenceOffsets[pose]; k < _incidenceOffsets[pose + 1]; ++k)
+      {
+        const int otherUnknown = _unknownPerPose[otherPose(relRs, _incidences[k])];
+        if(otherUnknown >= 0)
+          blocks.push_back(otherUnknown);
+      }
+      std::sort(blocks.begin(), blocks.end());
+      blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+    }
+
+    _blockOffsets.assign(nbUnknowns + 1, 0);
+    for(int unknown = 0; unknown < nbUnknowns; ++unknown)
+      _blockOffsets[unknown + 1] = _blockOffsets[unknown] + static_cast<int>(blocksPerUnknown[unknown].size());
+
+    _blockRows.resize(_blockOffsets.back());
+    _diagonalSlot.resize(nbUnknowns);
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(int unknown = 0; unknown < nbUnknowns; ++unknown)
+    {
+      const std::vector<int>& blocks = blocksPerUnknown[unknown];
+      std::copy(blocks.begin(), blocks.end(), _blockRows.begin() + _blockOffsets[unknown]);
+      _diagonalSlot[unknown] = slot(blocks, unknown);
+
+      const std::size_t pose = _posePerUnknown[unknown];
+      for(std::size_t k = _incidenceOffsets[pose]; k < _incidenceOffsets[pose + 1]; ++k)
+      {
+        const int otherUnknown = _unknownPerPose[otherPose(relRs, _incidences[k])];
+        _incidences[k].otherSlot = (otherUnknown >= 0) ? slot(blocks, otherUnknown) : -1;
+      }
+    }
+
+    return true;
+  }
+
+  std::size_t nbUnknowns() const { return _posePerUnknown.size(); }
+  std::size_t posePerUnknown(std::size_t unknown) const { return _posePerUnknown[unknown]; }
+
+  /**
+   * @brief Allocate the symmetric sparse matrix of the normal equations for square blocks of size blockSize.
+   */
+  void initMatrix(int blockSize, SparseMat& H) const
+  {
+    const int nbUnknowns = static_cast<int>(_posePerUnknown.size());
+    H.resize(blockSize * nbUnknowns, blockSize * nbUnknowns);
+    H.resizeNonZeros(blockSize * blockSize * _blockOffsets.back());
+
+    int* outer = H.outerIndexPtr();
+    int* inner = H.innerIndexPtr();
+
+    #pragma omp parallel for
+    for(int unknown = 0; unknown < nbUnknowns; ++unknown)
+    {
+      const int nbBlocks = _blockOffsets[unknown + 1] - _blockOffsets[unknown];
+      for(int c = 0; c < blockSize; ++c)
+      {
+        const int begin = blockSize * blockSize * _blockOffsets[unknown] + c * blockSize * nbBlocks;
+        outer[blockSize * unknown + c] = begin;
+        for(int s = 0; s < nbBlocks; ++s)
+          for(int r = 0; r < blockSize; ++r)
+            inner[begin + s * blockSize + r] = blockSize * _blockRows[_blockOffsets[unknown] + s] + r;
+      }
+    }
+    outer[blockSize * nbUnknowns] = blockSize * blockSize * _blockOffsets.back();
+  }
+
+  /**
+   * @brief Fill the normal equations of the chordal problem || wij * (Rj - Rij * Ri) ||,
+   *        the main view rotation is Identity.
+   */
+  void fillChordal(const RelativeRotations& relRs, SparseMat& H, MatX3& B) const
+  {
+    const int nbUnknowns = static_cast<int>(_posePerUnknown.size());
+    B.setZero(3 * nbUnknowns, 3);
+    std::fill(H.valuePtr(), H.valuePtr() + H.nonZeros(), 0.0);
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(int unknown = 0; unknown < nbUnknowns; ++unknown)
+    {
+      const std::size_t pose = _posePerUnknown[unknown];
+      const int nbBlocks = _blockOffsets[unknown + 1] - _blockOffsets[unknown];
+      double* values = H.valuePtr() + H.outerIndexPtr()[3 * unknown];
+      // value of the row r of the block in slot s, in the column c of this unknown
+      const auto value = [&](int c, int s, int r) -> double& { return values[c * 3 * nbBlocks + s * 3 + r]; };
+
+      for(std::size_t k = _incidenceOffsets[pose]; k < _incidenceOffsets[pose + 1]; ++k)
+      {
+        const Incidence& incidence = _incidences[k];
+        const RelativeRotation& relR = relRs[incidence.edge];
+        const double w2 = double(relR.weight) * double(relR.weight);
+        // residual Rj - Rij * Ri, the other block is -Rij (this pose is i) or -Rij^T (this pose is j)
+        const Mat3 otherBlock = incidence.isFirst ? Mat3(-w2 * relR.Rij) : Mat3(-w2 * relR.Rij.transpose());
+
+        for(int c = 0; c < 3; ++c)
+          value(c, _diagonalSlot[unknown], c) += w2;
+
+        if(incidence.otherSlot >= 0)
+        {
+          for(int c = 0; c < 3; ++c)
+            for(int r = 0; r < 3; ++r)
+              value(c, incidence.otherSlot, r) += otherBlock(r, c);
+        }
+        else
+        {
+          // the other pose is the main view: its Identity rotation goes to the right hand side
+          B.block<3, 3>(3 * unknown, 0) -= otherBlock.transpose();
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Fill the weighted graph Laplacian of the rotation updates, the main view is fixed.
+   *        The system minimizes sum(wij * || omega_i - omega_j + delta_ij ||^2).
+   */
+  void fillLaplacian(const std::vector<double>& weights, const std::vector<Vec3>& deltas, SparseMat& H, MatX3& B) const
+  {
+    const int nbUnknowns = static_cast<int>(_posePerUnknown.size());
+    B.setZero(nbUnknowns, 3);
+    std::fill(H.valuePtr(), H.valuePtr() + H.nonZeros(), 0.0);
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(int unknown = 0; unknown < nbUnknowns; ++unknown)
+    {
+      const std::size_t pose = _posePerUnknown[unknown];
+      double* values = H.valuePtr() + H.outerIndexPtr()[unknown];
+
+      for(std::size_t k = _incidenceOffsets[pose]; k < _incidenceOffsets[pose + 1]; ++k)
+      {
+        const Incidence& incidence = _incidences[k];
+        const double w = weights[incidence.edge];
+
+        values[_diagonalSlot[unknown]] += w;
+        if(incidence.otherSlot >= 0)
+          values[incidence.otherSlot] -= w;
+
+        if(incidence.isFirst)
+          B.row(unknown) -= w * deltas[incidence.edge].transpose();
+        else
+          B.row(unknown) += w * deltas[incidence.edge].transpose();
+      }
+    }
+  }
+
+private:
+  static std::size_t otherPose(const RelativeRotations& relRs, const Incidence& incidence)
+  {
+    const RelativeRotation& relR = relRs[incidence.edge];
+    return incidence.isFirst ? relR.j : relR.i;
+  }
+
+  static int slot(const std::vector<int>& blocks, int unknown)
+  {
+    return static_cast<int>(std::lower_bound(blocks.begin(), blocks.end(), unknown) - blocks.begin());
+  }
+
+  std::vector<std::size_t> _incidenceOffsets;
+  std::vector<Incidence> _incidences;
+  std::vector<int> _unknownPerPose;
+  std::vector<std::size_t> _posePerUnknown;
+  std::vector<int> _blockOffsets;
+  std::vector<int> _blockRows;
+  std::vector<int> _diagonalSlot;
+};
+
+/**
+ * @brief Solve the sparse symmetric positive definite systems of a given pattern.
+ *
+ * The sparse Cholesky analyzes the pattern once and only factorizes the new values.
+ * The conjugate gradient uses the symmetric column major matrix as a row major one,
+ * so that Eigen parallelizes the sparse matrix products.
+ */
+class LinearSolver
+{
+public:
+  LinearSolver(const Params& params, const SparseMat& H)
+  {
+    _useCholesky = (params.linearSolver == ELinearSolver::SPARSE_CHOLESKY) ||
+                   (params.linearSolver == ELinearSolver::AUTO && std::size_t(H.rows()) <= params.maxNbUnknownsForCholesky);
+    if(_useCholesky)
+      _cholesky.analyzePattern(H);
+    else
+    {
+      _cg.setMaxIterations(static_cast<Eigen::Index>(params.cgMaxIterations));
+      _cg.setTolerance(params.cgTolerance);
+    }
+  }
+
+  bool solve(const SparseMat& H, const MatX3& B, MatX3& X)
+  {
+    if(_useCholesky)
+    {
+      _cholesky.factorize(H);
+      if(_cholesky.info() != Eigen::Success)
+      {
+        ALICEVISION_LOG_WARNING("Rotation averaging: sparse Cholesky factorization failed.");
+        return false;
+      }
+      X = _cholesky.solve(B);
+      return true;
+    }
+
+    const Eigen::Map<const SparseMatRowMajor> Hrm(H.rows(), H.cols(), H.nonZeros(),
+                                                  H.outerIndexPtr(), H.innerIndexPtr(), H.valuePtr());
+    _cg.compute(Hrm);
+    X = _cg.solve(B);
+    if(_cg.info() == Eigen::NumericalIssue || _cg.info() == Eigen::InvalidInput)
+    {
+      ALICEVISION_LOG_WARNING("Rotation averaging: conjugate gradient failed.");
+      return false;
+    }
+    if(_cg.info() == Eigen::NoConvergence)
+      ALICEVISION_LOG_DEBUG("Rotation averaging: conjugate gradient stopped after " << _cg.iterations() << " iterations (error: " << _cg.error() << ").");
+    return true;
+  }
+
+  const char* name() const
+  {
+    return _useCholesky ? "sparse Cholesky" : "conjugate gradient";
+  }
+
+private:
+  bool _useCholesky = true;
+  Eigen::SimplicialLDLT<SparseMat> _cholesky;
+  Eigen::ConjugateGradient<SparseMatRowMajor, Eigen::Lower | Eigen::Upper> _cg;
+};
+
+/// Angle-axis vector of a rotation matrix
+inline Vec3 rotationLog(const Mat3& R)
+{
+  const Eigen::AngleAxisd angleAxis(R);
+  return angleAxis.angle() * angleAxis.axis();
+}
+
+/// Rotation matrix of an angle-axis vector
+inline Mat3 rotationExp(const Vec3& omega)
+{
+  const double angle = omega.norm();
+  if(angle < std::numeric_limits<double>::epsilon())
+    return Mat3::Identity();
+  return Eigen::AngleAxisd(angle, omega / angle).toRotationMatrix();
+}
+
+/**
+ * @brief Residuals log(Rj^T * Rij * Ri) of all the relative rotations, evaluated in parallel.
+ */
+void computeResiduals(const RelativeRotations& relRs, const std::vector<Mat3>& Rs, std::vector<Vec3>& deltas)
+{
+  deltas.resize(relRs.size());
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t edge = 0; edge < static_cast<std::ptrdiff_t>(relRs.size()); ++edge)
+  {
+    const RelativeRotation& relR = relRs[edge];
+    deltas[edge] = rotationLog(Rs[relR.j].transpose() * relR.Rij * Rs[relR.i]);
+  }
+}
+
+} // namespace
+
+bool ChordalInitialization(
+  const RelativeRotations& RelRs,
+  std::vector<Mat3>& Rs,
+  const std::size_t nMainViewID,
+  const Params& params)
+{
+  ViewGraph graph;
+  if(!graph.build(RelRs, Rs.size(), nMainViewID))
+    return false;
+
+  SparseMat H;
+  MatX3 B, X;
+  graph.initMatrix(3, H);
+  graph.fillChordal(RelRs, H, B);
+
+  LinearSolver solver(params, H);
+  if(!solver.solve(H, B, X))
+    return false;
+
+  ALICEVISION_LOG_DEBUG("Rotation averaging: chordal initialization of " << Rs.size() << " poses from "
+                        << RelRs.size() << " relative rotations (" << solver.name() << ").");
+
+  Rs[nMainViewID] = Mat3::Identity();
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t unknown = 0; unknown < static_cast<std::ptrdiff_t>(graph.nbUnknowns()); ++unknown)
+  {
+    const Mat3 R = X.block<3, 3>(3 * unknown, 0);
+    Rs[graph.posePerUnknown(unknown)] = l2::ClosestSVDRotationMatrix(R);
+  }
+
+  return true;
+}
+
+bool RefineRotationsIRLS(
+  const RelativeRotations& RelRs,
+  std::vector<Mat3>& Rs,
+  const std::size_t nMainViewID,
+  const Params& params)
+{
+  ViewGraph graph;
+  if(!graph.build(RelRs, Rs.size(), nMainViewID))
+    return false;
+
+  SparseMat H;
+  MatX3 B, X;
+  graph.initMatrix(1, H);
+
+  LinearSolver solver(params, H);
+
+  const double sigma2 = params.sigma * params.sigma;
+  std::vector<Vec3> deltas;
+  std::vector<double> weights(RelRs.size());
+
+  std::size_t iteration = 0;
+  double meanUpdate = 0.0;
+  for(; iteration < params.maxIterations; ++iteration)
+  {
+    computeResiduals(RelRs, Rs, deltas);
+
+    // Geman-McClure weights
+    #pragma omp parallel for
+    for(std::ptrdiff_t edge = 0; edge < static_cast<std::ptrdiff_t>(RelRs.size()); ++edge)
+    {
+      const double w = double(RelRs[edge].weight);
+      const double robust = sigma2 / (deltas[edge].squaredNorm() + sigma2);
+      weights[edge] = w * w * robust * robust;
+    }
+
+    graph.fillLaplacian(weights, deltas, H, B);
+    if(!solver.solve(H, B, X))
+      return false;
+
+    double sumUpdate = 0.0;
+    #pragma omp parallel for reduction(+:sumUpdate)
+    for(std::ptrdiff_t unknown = 0; unknown < static_cast<std::ptrdiff_t>(graph.nbUnknowns()); ++unknown)
+    {
+      const Vec3 omega = X.row(unknown).transpose();
+      Mat3& R = Rs[graph.posePerUnknown(unknown)];
+      R = R * rotationExp(omega);
+      sumUpdate += omega.norm();
+    }
+    meanUpdate = sumUpdate / std::max<std::size_t>(1, graph.nbUnknowns());
+
+    ALICEVISION_LOG_DEBUG("Rotation averaging IRLS, iteration " << iteration << ": mean update " << radianToDegree(meanUpdate) << " deg.");
+
+    if(meanUpdate < params.convergenceThreshold)
+    {
+      ++iteration;
+      break;
+    }
+  }
+
+  ALICEVISION_LOG_INFO("Rotation averaging IRLS: " << Rs.size() << " poses, " << RelRs.size() << " relative rotations, "
+                       << iteration << " iterations (" << solver.name() << "), last mean update: " << radianToDegree(meanUpdate) << " deg.");
+  return true;
+}
+
+bool GlobalRotationsIRLS(
+  const RelativeRotations& RelRs,
+  std::vector<Mat3>& Rs,
+  const std::size_t nMainViewID,
+  double inlierThreshold,
+  std::vector<bool>* vec_inliers,
+  const Params& params)
+{
+  if(!ChordalInitialization(RelRs, Rs, nMainViewID, params))
+    return false;
+
+  if(!RefineRotationsIRLS(RelRs, Rs, nMainViewID, params))
+    return false;
+
+  if(vec_inliers)
+  {
+    std::vector<Vec3> deltas;
+    computeResiduals(RelRs, Rs, deltas);
+
+    vec_inliers->resize(RelRs.size());
+    std::size_t nbInliers = 0;
+    for(std::size_t edge = 0; edge < RelRs.size(); ++edge)
+    {
+      (*vec_inliers)[edge] = (deltas[edge].norm() < inlierThreshold);
+      nbInliers += (*vec_inliers)[edge] ? 1 : 0;
+    }
+    ALICEVISION_LOG_INFO("Rotation averaging IRLS: " << nbInliers << " / " << RelRs.size() << " inlier relative rotations.");
+  }
+
+  return true;
+}
+
+} // namespace irls
+} // namespace rotationAveraging
+} // namespace aliceVision
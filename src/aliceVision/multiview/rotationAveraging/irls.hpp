@@ -0,0 +1,107 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/multiview/rotationAveraging/common.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <vector>
+
+namespace aliceVision   {
+namespace rotationAveraging  {
+namespace irls  {
+
+/**
+ * @brief Solver of the sparse normal equations.
+ */
+enum class ELinearSolver
+{
+  AUTO = 0,              //< sparse Cholesky on small graphs, conjugate gradient otherwise
+  SPARSE_CHOLESKY,       //< simplicial LDLT, the factorization pattern is analyzed once
+  CONJUGATE_GRADIENT     //< Jacobi preconditioned conjugate gradient, multithreaded products
+};
+
+struct Params
+{
+  /// solver of the linear systems
+  ELinearSolver linearSolver = ELinearSolver::AUTO;
+  /// maximum number of unknowns of a system solved by a sparse Cholesky in AUTO mode
+  std::size_t maxNbUnknownsForCholesky = 30000;
+  /// maximum number of iterations of the conjugate gradient
+  std::size_t cgMaxIterations = 1000;
+  /// relative residual tolerance of the conjugate gradient
+  double cgTolerance = 1e-10;
+  /// maximum number of reweighting iterations
+  std::size_t maxIterations = 100;
+  /// scale of the Geman-McClure robust function (radians)
+  double sigma = degreeToRadian(5.0);
+  /// the refinement stops when the mean update of the rotations is below this angle (radians)
+  double convergenceThreshold = 1e-7;
+};
+
+/**
+ * @brief Compute an initial estimation of the global rotations with the chordal distance.
+ *
+ * The linear system || wij * (Rj - Rij * Ri) || = 0 is solved in the least squares sense with
+ * Ri of the main view fixed to Identity. Each column of the rotations is an independent
+ * right hand side of the same sparse system, and the solutions are projected on SO(3).
+ *
+ * @param[in] RelRs Relative weighted rotation matrices
+ * @param[out] Rs output global rotation matrices (must be sized to the number of poses)
+ * @param[in] nMainViewID Id of the image considered as Identity (unit rotation)
+ * @param[in] params solver parameters
+ * @return false if the view graph is not connected or if the solve failed
+ */
+bool ChordalInitialization(
+  const RelativeRotations& RelRs,
+  std::vector<Mat3>& Rs,
+  const std::size_t nMainViewID,
+  const Params& params = Params());
+
+/**
+ * @brief Refine the global rotations by Iteratively Reweighted Least Squares in the Lie algebra [1].
+ *
+ * At each iteration the residuals log(Rj^T * Rij * Ri) are evaluated in parallel, weighted by
+ * the Geman-McClure function and the rotation updates are solved on the weighted graph Laplacian.
+ *
+ * [1] "Efficient and Robust Large-Scale Rotation Averaging."
+ *     Avishek Chatterjee, Venu Madhav Govindu. ICCV 2013.
+ *
+ * @param[in] RelRs Relative weighted rotation matrices
+ * @param[in,out] Rs global rotation matrices
+ * @param[in] nMainViewID Id of the image considered as Identity (unit rotation)
+ * @param[in] params solver parameters
+ * @return false if the view graph is not connected or if a solve failed
+ */
+bool RefineRotationsIRLS(
+  const RelativeRotations& RelRs,
+  std::vector<Mat3>& Rs,
+  const std::size_t nMainViewID,
+  const Params& params = Params());
+
+/**
+ * @brief Compute the global rotations by a chordal initialization followed by an IRLS refinement.
+ *
+ * @param[in] RelRs Relative weighted rotation matrices
+ * @param[out] Rs output global rotation matrices (must be sized to the number of poses)
+ * @param[in] nMainViewID Id of the image considered as Identity (unit rotation)
+ * @param[in] inlierThreshold maximum angular residual of an inlier relative rotation (radians)
+ * @param[out] vec_inliers rotation labelled as inliers or outliers
+ * @param[in] params solver parameters
+ * @return true if the global rotations are computed
+ */
+bool GlobalRotationsIRLS(
+  const RelativeRotations& RelRs,
+  std::vector<Mat3>& Rs,
+  const std::size_t nMainViewID,
+  double inlierThreshold,
+  std::vector<bool>* vec_inliers = nullptr,
+  const Params& params = Params());
+
+} // namespace irls
+} // namespace rotationAveraging
+} // namespace aliceVision
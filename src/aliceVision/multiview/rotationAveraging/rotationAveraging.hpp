@@ -26,3 +26,4 @@
 #include <aliceVision/multiview/rotationAveraging/common.hpp>
 #include <aliceVision/multiview/rotationAveraging/l1.hpp>
 #include <aliceVision/multiview/rotationAveraging/l2.hpp>
+#include <aliceVision/multiview/rotationAveraging/irls.hpp>
@@ -26,6 +26,7 @@ using namespace aliceVision;
 using namespace aliceVision::rotationAveraging;
 using namespace aliceVision::rotationAveraging::l1;
 using namespace aliceVision::rotationAveraging::l2;
+using namespace aliceVision::rotationAveraging::irls;
 
 BOOST_AUTO_TEST_CASE ( rotationAveraging_ClosestSVDRotationMatrix )
 {
@@ -315,6 +316,71 @@ BOOST_AUTO_TEST_CASE ( rotationAveraging_RefineRotationsAvgL1IRLS_CompleteGraph_
   }
 }
 
+// Test over a loop of cameras linked to their 4 next neighbours, without and with outliers
+// - the rotations are estimated by the chordal initialization and the IRLS refinement
+// - with the sparse Cholesky and the conjugate gradient solvers
+BOOST_AUTO_TEST_CASE ( rotationAveraging_GlobalRotationsIRLS_outliers)
+{
+  //-- Setup a circular camera rig
+  const std::size_t iNviews = 20;
+  NViewDataSet d = NRealisticCamerasRing(iNviews, 5,
+    NViewDatasetConfigurator(1,1,0,0,5,0)); // Suppose a camera with Unit matrix as K
+
+  RelativeRotations vec_relativeRotEstimate;
+  for (std::size_t i = 0; i < iNviews; ++i)
+  {
+    for (std::size_t k = 1; k <= 4; ++k)
+    {
+      const std::size_t j = (i + k) % iNviews;
+      Mat3 Rrel;
+      Vec3 trel;
+      relativeCameraMotion(d._R[i], d._t[i], d._R[j], d._t[j], &Rrel, &trel);
+      vec_relativeRotEstimate.push_back(RelativeRotation(i, j, Rrel, 1));
+    }
+  }
+
+  // Outliers rotations
+  const std::vector<std::size_t> outliers = {3, 17, 42, 61};
+  RelativeRotations vec_relativeRotOutliers = vec_relativeRotEstimate;
+  for (std::size_t outlier : outliers)
+  {
+    RelativeRotation& relR = vec_relativeRotOutliers[outlier];
+    relR.Rij = RotationAroundX(degreeToRadian(40.0)) * RotationAroundY(degreeToRadian(-25.0)) * relR.Rij;
+  }
+
+  for (ELinearSolver linearSolver : {ELinearSolver::SPARSE_CHOLESKY, ELinearSolver::CONJUGATE_GRADIENT})
+  {
+    irls::Params params;
+    params.linearSolver = linearSolver;
+
+    for (const RelativeRotations* relRs : {&vec_relativeRotEstimate, &vec_relativeRotOutliers})
+    {
+      const std::size_t nMainViewID = 0;
+      Matrix3x3Arr vec_globalR(iNviews);
+      std::vector<bool> inliers;
+      BOOST_CHECK(GlobalRotationsIRLS(*relRs, vec_globalR, nMainViewID, degreeToRadian(5.0), &inliers, params));
+
+      // Check that the outliers are rejected
+      BOOST_CHECK_EQUAL(std::count(inliers.begin(), inliers.end(), false),
+                        (relRs == &vec_relativeRotOutliers) ? outliers.size() : 0);
+
+      // Check that each global rotation is near the true one, the main view is Identity
+      for (std::size_t i = 0; i < iNviews; ++i)
+      {
+        const Mat3 R = d._R[i] * d._R[nMainViewID].transpose();
+        BOOST_CHECK_SMALL(FrobeniusDistance(R, vec_globalR[i]), 1e-4);
+      }
+    }
+  }
+
+  // A disconnected view graph is rejected
+  {
+    RelativeRotations vec_relativeRotDisconnected = vec_relativeRotEstimate;
+    Matrix3x3Arr vec_globalR(iNviews + 1);
+    BOOST_CHECK(!GlobalRotationsIRLS(vec_relativeRotDisconnected, vec_globalR, 0, degreeToRadian(5.0)));
+  }
+}
+
 /*
 template<typename TYPE, int N>
 inline REAL ComputePSNR(const Eigen::Matrix<REAL, N,1>& x0, const Eigen::Matrix<REAL, N,1>& x)
@@ -12,6 +12,9 @@
 #include <aliceVision/robustEstimation/LORansac.hpp>
 #include <aliceVision/robustEstimation/ScoreEvaluator.hpp>
 
+#include <algorithm>
+#include <limits>
+
 namespace aliceVision {
 namespace multiview {
 
@@ -72,6 +75,78 @@ void TriangulateNViewLORANSAC(const Mat2X& x,
   *X = model.getMatrix();
 }
 
+void TriangulateNViewIterativeBatch(const std::vector<Mat34>& Ps,
+                                    const std::vector<std::size_t>& cameraIndexes,
+                                    const Mat2X& x,
+                                    const std::vector<std::size_t>& offsets,
+                                    Mat3X& X,
+                                    Vec& minDepths,
+                                    int iter)
+{
+  assert(!offsets.empty());
+  assert(cameraIndexes.size() == offsets.back());
+  assert(static_cast<std::size_t>(x.cols()) == offsets.back());
+
+  const std::size_t nbPoints = offsets.size() - 1;
+  X.resize(3, nbPoints);
+  minDepths.resize(nbPoints);
+
+  std::size_t maxNbObservations = 0;
+  for(std::size_t p = 0; p < nbPoints; ++p)
+    maxNbObservations = std::max(maxNbObservations, offsets[p + 1] - offsets[p]);
+  std::vector<double> weights(maxNbObservations);
+
+  for(std::size_t p = 0; p < nbPoints; ++p)
+  {
+    const std::size_t begin = offsets[p];
+    const std::size_t nbObservations = offsets[p + 1] - begin;
+
+    if(nbObservations < 2)
+    {
+      X.col(p).setZero();
+      minDepths(p) = -std::numeric_limits<double>::infinity();
+      continue;
+    }
+
+    std::fill_n(weights.begin(), nbObservations, 1.0);
+
+    Vec3 point = Vec3::Zero();
+    double zmin = 0.0;
+
+    for(int it = 0; it < iter; ++it)
+    {
+      // normal equations of the weighted linear system, 4-vector rows to let Eigen vectorize
+      Mat3 AtA = Mat3::Zero();
+      Vec3 Atb = Vec3::Zero();
+      for(std::size_t i = 0; i < nbObservations; ++i)
+      {
+        const Mat34& P = Ps[cameraIndexes[begin + i]];
+        const double w2 = weights[i] * weights[i];
+        const Vec4 r0 = P.row(0) - x(0, begin + i) * P.row(2);
+        const Vec4 r1 = P.row(1) - x(1, begin + i) * P.row(2);
+
+        AtA.noalias() += w2 * (r0.head<3>() * r0.head<3>().transpose() + r1.head<3>() * r1.head<3>().transpose());
+        Atb.noalias() -= w2 * (r0(3) * r0.head<3>() + r1(3) * r1.head<3>());
+      }
+
+      point = AtA.inverse() * Atb;
+
+      // min depth and weights update
+      zmin = std::numeric_limits<double>::max();
+      for(std::size_t i = 0; i < nbObservations; ++i)
+      {
+        const Mat34& P = Ps[cameraIndexes[begin + i]];
+        const double z = P.row(2).head<3>().dot(point) + P(2, 3);
+        zmin = std::min(zmin, z);
+        weights[i] = 1.0 / z;
+      }
+    }
+
+    X.col(p) = point;
+    minDepths(p) = zmin;
+  }
+}
+
 double Triangulation::error(const Vec3 &X) const
 {
   double squared_reproj_error = 0.0;
@@ -72,6 +72,28 @@ void TriangulateNViewLORANSAC(const Mat2X &x,
 
 //Iterated linear method
 
+/**
+ * @brief Compute the 3D positions of a batch of points from several images of each of them.
+ * Same algorithm as Triangulation::compute (iterative weighted linear least squares),
+ * without memory allocation per point: the projective matrices are shared by all the points
+ * and the observations of all the points are stored contiguously.
+ *
+ * @param[in] Ps is the list of projective matrices of all the cameras
+ * @param[in] cameraIndexes is the camera index (in Ps) of each observation
+ * @param[in] x are the 2D coordinates of each observation
+ * @param[in] offsets is the index of the first observation of each point, followed by the number of observations (size = nbPoints + 1)
+ * @param[out] X are the estimated 3D points
+ * @param[out] minDepths is the min depth of each point (-inf for points with less than 2 observations)
+ * @param[in] iter is the number of iterations
+ */
+void TriangulateNViewIterativeBatch(const std::vector<Mat34>& Ps,
+                                    const std::vector<std::size_t>& cameraIndexes,
+                                    const Mat2X& x,
+                                    const std::vector<std::size_t>& offsets,
+                                    Mat3X& X,
+                                    Vec& minDepths,
+                                    int iter = 3);
+
 class Triangulation
 {
 public:
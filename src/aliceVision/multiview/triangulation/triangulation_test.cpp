@@ -168,6 +168,54 @@ BOOST_AUTO_TEST_CASE(Triangulate_NViewIterative_FiveViews)
   }
 }
 
+BOOST_AUTO_TEST_CASE(Triangulate_NViewIterativeBatch_FiveViews)
+{
+  const int nviews = 5;
+  const int npoints = 6;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints);
+
+  std::vector<Mat34> Ps;
+  for(int j = 0; j < nviews; ++j)
+    Ps.push_back(d.P(j));
+
+  // point i is seen by the views [0, 2 + i % 4], the last point has a single observation
+  std::vector<std::size_t> cameraIndexes;
+  std::vector<std::size_t> offsets = {0};
+  std::vector<Vec2> observations;
+  for(int i = 0; i < npoints; ++i)
+  {
+    const int nbObservations = (i == npoints - 1) ? 1 : 2 + i % 4;
+    for(int j = 0; j < nbObservations; ++j)
+    {
+      cameraIndexes.push_back(j);
+      observations.push_back(d._x[j].col(i));
+    }
+    offsets.push_back(cameraIndexes.size());
+  }
+
+  Mat2X x(2, observations.size());
+  for(std::size_t k = 0; k < observations.size(); ++k)
+    x.col(k) = observations[k];
+
+  Mat3X X;
+  Vec minDepths;
+  multiview::TriangulateNViewIterativeBatch(Ps, cameraIndexes, x, offsets, X, minDepths);
+
+  BOOST_CHECK_EQUAL(X.cols(), npoints);
+  for(int i = 0; i < npoints - 1; ++i)
+  {
+    multiview::Triangulation triangulationObj;
+    for(std::size_t k = offsets[i]; k < offsets[i + 1]; ++k)
+      triangulationObj.add(Ps[cameraIndexes[k]], x.col(k));
+
+    const Vec3 expected = triangulationObj.compute();
+    BOOST_CHECK_SMALL((X.col(i) - expected).norm(), 1e-9);
+    BOOST_CHECK_SMALL((X.col(i) - d._X.col(i)).norm(), 1e-9);
+    BOOST_CHECK_CLOSE(minDepths(i), triangulationObj.minDepth(), 1e-6);
+  }
+  BOOST_CHECK(minDepths(npoints - 1) < 0);
+}
+
 //// Test triangulation as algebric problem, it generates some random projection
 //// matrices, a random 3D points and its corresponding 2d image points. Some of these
 //// points are considered as outliers. Inliers are assigned a max weight, outliers
@@ -206,7 +206,8 @@ void readImage(const std::string& path,
                int& width,
                int& height,
                std::vector<T>& buffer,
-               EImageColorSpace toColorSpace)
+               EImageColorSpace toColorSpace,
+               int downscale = 1)
 {
     ALICEVISION_LOG_DEBUG("[IO] Read Image: " << path);
 
@@ -229,13 +230,49 @@ void readImage(const std::string& path,
     configSpec.attribute("raw:ColorSpace", "Linear");   // want linear colorspace with sRGB primaries
 #endif
 
+    downscale = std::max(1, downscale);
+
+    // libRAW can directly demosaic at half resolution
+    bool rawHalfSize = false;
+    if(downscale % 2 == 0)
+    {
+        // the reader is chosen from the file extension, the file is not opened
+        std::unique_ptr<oiio::ImageInput> in(oiio::ImageInput::create(path));
+        rawHalfSize = (in && std::string(in->format_name()) == "raw");
+        if(rawHalfSize)
+            configSpec.attribute("raw:HalfSize", 1);
+    }
+
     oiio::ImageBuf inBuf(path, 0, 0, NULL, &configSpec);
 
-    inBuf.read(0, 0, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
+    // downscale factor already provided by the decoder
+    int decodedScale = rawHalfSize ? 2 : 1;
+
+    // use the finest mip level (EXR, TIFF) matching the requested downscale
+    int miplevel = 0;
+    while(miplevel + 1 < inBuf.nmiplevels() && downscale % (decodedScale << (miplevel + 1)) == 0)
+        ++miplevel;
+    decodedScale <<= miplevel;
+
+    inBuf.read(0, miplevel, true, oiio::TypeDesc::FLOAT); // force image convertion to float (for grayscale and color space convertion)
 
     if(!inBuf.initialized())
         throw std::runtime_error("Cannot find/open image file '" + path + "'.");
 
+    // remaining downscale not handled by the decoder,
+    // applied before the color conversion and channels manipulations so they only run on the output pixels
+    const int residualScale = downscale / decodedScale;
+    if(residualScale > 1)
+    {
+        const oiio::ImageSpec& decodedSpec = inBuf.spec();
+        oiio::ImageBuf downscaledBuf(oiio::ImageSpec(std::max(1, decodedSpec.width / residualScale),
+                                                     std::max(1, decodedSpec.height / residualScale),
+                                                     decodedSpec.nchannels, oiio::TypeDesc::FLOAT));
+        oiio::ImageBufAlgo::resize(downscaledBuf, inBuf, "", 0, oiio::ROI::All());
+        downscaledBuf.specmod().extra_attribs = decodedSpec.extra_attribs;
+        inBuf.swap(downscaledBuf);
+    }
+
 #if OIIO_VERSION <= (10000 * 2 + 100 * 0 + 8) // OIIO_VERSION <= 2.0.8
     // Workaround for bug in RAW colorspace management in previous versions of OIIO:
     //     When asking sRGB we got sRGB primaries with linear gamma,
@@ -360,18 +397,18 @@ void readImage(const std::string& path, int& width, int& height, std::vector<Col
     readImage(path, oiio::TypeDesc::FLOAT, 4, width, height, buffer, toColorSpace);
 }
 
-void readImage(const std::string& path, ImageRGBf& image, EImageColorSpace toColorSpace)
+void readImage(const std::string& path, ImageRGBf& image, EImageColorSpace toColorSpace, int downscale)
 {
     int width, height;
-    readImage(path, width, height, image.data(), toColorSpace);
+    readImage(path, oiio::TypeDesc::FLOAT, 3, width, height, image.data(), toColorSpace, downscale);
     image.setWidth(width);
     image.setHeight(height);
 }
 
-void readImage(const std::string& path, ImageRGBAf& image, EImageColorSpace toColorSpace)
+void readImage(const std::string& path, ImageRGBAf& image, EImageColorSpace toColorSpace, int downscale)
 {
     int width, height;
-    readImage(path, width, height, image.data(), toColorSpace);
+    readImage(path, oiio::TypeDesc::FLOAT, 4, width, height, image.data(), toColorSpace, downscale);
     image.setWidth(width);
     image.setHeight(height);
 }
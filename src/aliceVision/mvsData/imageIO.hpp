@@ -198,8 +198,18 @@ void readImage(const std::string& path, int& width, int& height, std::vector<rgb
 void readImage(const std::string& path, int& width, int& height, std::vector<float>& buffer, EImageColorSpace toColorSpace);
 void readImage(const std::string& path, int& width, int& height, std::vector<ColorRGBf>& buffer, EImageColorSpace toColorSpace);
 void readImage(const std::string& path, int& width, int& height, std::vector<ColorRGBAf>& buffer, EImageColorSpace toColorSpace);
-void readImage(const std::string& path, ImageRGBf& image, EImageColorSpace toColorSpace);
-void readImage(const std::string& path, ImageRGBAf& image, EImageColorSpace toColorSpace);
+
+/**
+ * @brief read an image with a given path
+ * @param[in] path The given path to the image
+ * @param[out] image The output image
+ * @param[in] toColorSpace The output image color space
+ * @param[in] downscale The integer downscale factor, the output size is the file size divided by this factor.
+ *            The reduced decoding of the file format is used when available (RAW half size, EXR/TIFF mip levels),
+ *            the remaining factor is applied before the color conversion.
+ */
+void readImage(const std::string& path, ImageRGBf& image, EImageColorSpace toColorSpace, int downscale = 1);
+void readImage(const std::string& path, ImageRGBAf& image, EImageColorSpace toColorSpace, int downscale = 1);
 
 /**
  * @brief write an image with a given path and buffer
@@ -316,14 +316,23 @@ Matrix3x4 load3x4MatrixFromFile(std::istream& in)
 template<class Image>
 void loadImage(const std::string& path, const MultiViewParams& mp, int camId, Image& img, imageIO::EImageColorSpace colorspace, ECorrectEV correctEV)
 {
+    // scale choosed by the user and apply during the process,
+    // the image is directly decoded at this scale
+    const int processScale = mp.getProcessDownscale();
+
+    if(processScale > 1)
+        ALICEVISION_LOG_DEBUG("Downscale (x" << processScale << ") image: " << mp.getViewId(camId) << ".");
+
     // check image size
-    auto checkImageSize = [&path, &mp, camId, &img](){
-        if((mp.getOriginalWidth(camId) != img.width()) || (mp.getOriginalHeight(camId) != img.height()))
+    auto checkImageSize = [&path, &mp, camId, &img, processScale](){
+        const int expectedWidth = mp.getOriginalWidth(camId) / processScale;
+        const int expectedHeight = mp.getOriginalHeight(camId) / processScale;
+        if((expectedWidth != img.width()) || (expectedHeight != img.height()))
         {
             std::stringstream s;
             s << "Bad image dimension for camera : " << camId << "\n";
             s << "\t- image path : " << path << "\n";
-            s << "\t- expected dimension : " << mp.getOriginalWidth(camId) << "x" << mp.getOriginalHeight(camId) << "\n";
+            s << "\t- expected dimension : " << expectedWidth << "x" << expectedHeight << " (downscale x" << processScale << ")\n";
             s << "\t- real dimension : " << img.width() << "x" << img.height() << "\n";
             throw std::runtime_error(s.str());
         }
@@ -331,13 +340,13 @@ void loadImage(const std::string& path, const MultiViewParams& mp, int camId, Im
 
     if(correctEV == ECorrectEV::NO_CORRECTION)
     {
-        imageIO::readImage(path, img, colorspace);
+        imageIO::readImage(path, img, colorspace, processScale);
         checkImageSize();
     }
     // if exposure correction, apply it in linear colorspace and then convert colorspace
     else
     {
-        imageIO::readImage(path, img, imageIO::EImageColorSpace::LINEAR);
+        imageIO::readImage(path, img, imageIO::EImageColorSpace::LINEAR, processScale);
         checkImageSize();
 
         oiio::ParamValueList metadata;
@@ -361,16 +370,6 @@ void loadImage(const std::string& path, const MultiViewParams& mp, int camId, Im
         }
     }
 
-    // scale choosed by the user and apply during the process
-    const int processScale = mp.getProcessDownscale();
-
-    if(processScale > 1)
-    {
-        ALICEVISION_LOG_DEBUG("Downscale (x" << processScale << ") image: " << mp.getViewId(camId) << ".");
-        Image bmpr;
-        imageAlgo::resizeImage(processScale, img, bmpr);
-        img.swap(bmpr);
-    }
 }
 
 template void loadImage<ImageRGBf>(const std::string& path, const MultiViewParams& mp, int camId, ImageRGBf& img, imageIO::EImageColorSpace colorspace, ECorrectEV correctEV);
@@ -105,6 +105,7 @@ using RMat3 = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>;
 
 //-- General purpose Matrix and Vector
 using Mat = Eigen::MatrixXd;
+using RMat = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
 using Vec = Eigen::VectorXd;
 using Vecu = Eigen::Matrix<unsigned int, Eigen::Dynamic, 1>;
 using Matf = Eigen::MatrixXf;
@@ -18,6 +18,9 @@ bool CoordinatesMap::build(const std::pair<int, int>& panoramaSize, const geomet
     int min_x = std::numeric_limits<int>::max();
     int min_y = std::numeric_limits<int>::max();
 
+    Mat3X rays(3, coarseBbox.width);
+    Mat2X pix_disto;
+
     for(int y = 0; y < coarseBbox.height; y++)
     {
 
@@ -29,35 +32,39 @@ bool CoordinatesMap::build(const std::pair<int, int>& panoramaSize, const geomet
 
         for(int x = 0; x < coarseBbox.width; x++)
         {
-
             int cx = x + coarseBbox.left;
+            rays.col(x) = SphericalMapping::fromEquirectangular(Vec2(cx, cy), panoramaSize.first, panoramaSize.second);
+        }
 
-            Vec3 ray = SphericalMapping::fromEquirectangular(Vec2(cx, cy), panoramaSize.first, panoramaSize.second);
+        /**
+         * Project the rays of the whole row to camera pixel coordinates
+         */
+        intrinsics.projectPoints(pose, rays, pix_disto, true);
+
+        for(int x = 0; x < coarseBbox.width; x++)
+        {
+
+            int cx = x + coarseBbox.left;
 
             /**
              * Check that this ray should be visible.
              * This test is camera type dependent
              */
-            Vec3 transformedRay = pose(ray);
+            Vec3 transformedRay = pose(rays.col(x));
             if(!intrinsics.isVisibleRay(transformedRay))
             {
                 continue;
             }
 
-            /**
-             * Project this ray to camera pixel coordinates
-             */
-            const Vec2 pix_disto = intrinsics.project(pose, ray.homogeneous(), true);
-
             /**
              * Ignore invalid coordinates
              */
-            if(!intrinsics.isVisible(pix_disto))
+            if(!intrinsics.isVisible(pix_disto.col(x)))
             {
                 continue;
             }
 
-            _coordinates(y, x) = pix_disto;
+            _coordinates(y, x) = pix_disto.col(x);
             _mask(y, x) = 1;
 
             min_x = std::min(cx, min_x);
@@ -13,7 +13,10 @@
 #include <aliceVision/system/Logger.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <limits>
@@ -129,6 +132,218 @@ inline ErrorIndex bestNFA(int startIndex, //number of point required for estimat
   return bestIndex;
 }
 
+/**
+ * @brief Find the best NFA of a model without sorting all its residuals.
+ *
+ * The residuals below the threshold are bucketed in a histogram with logarithmic bins
+ * (using the exponent and the high bits of the mantissa of the float residuals).
+ * The smallest and largest residuals of a bin give a lower bound of the NFA over the bin,
+ * so only the bins that can beat the NFA to beat are sorted and evaluated, most promising first.
+ * The result is the same as bestNFA() on the fully sorted residuals.
+ *
+ * All the buffers are allocated once, for the given number of residuals.
+ */
+class NFAHistogram
+{
+public:
+  explicit NFAHistogram(std::size_t nData)
+    : _binOf(nData)
+    , _bucketed(nData)
+    , _binBegin(maxBins + 1)
+    , _binMin(maxBins)
+    , _binMax(maxBins)
+    , _binLowerBound(maxBins)
+    , _binOrder(maxBins)
+    , _binSorted(maxBins)
+  {}
+
+  /**
+   * @brief Find the best NFA and its index wrt square error threshold.
+   * @param[in] residuals the residual of each data, in data order
+   * @param[in] minNFA the NFA to beat: the bins that cannot give a smaller NFA are not evaluated
+   * @return the best NFA and its number of inliers if it is smaller than minNFA,
+   *         (infinity, startIndex) otherwise
+   * @see bestNFA
+   */
+  ErrorIndex bestNFA(int startIndex,
+                     double logalpha0,
+                     const std::vector<double>& residuals,
+                     double loge0,
+                     double maxThreshold,
+                     const std::vector<float>& logc_n,
+                     const std::vector<float>& logc_k,
+                     double multError,
+                     double minNFA)
+  {
+    assert(residuals.size() <= _bucketed.size());
+    _nbKept = 0;
+    _nbBins = 0;
+
+    // select the residuals below the threshold
+    double minError = std::numeric_limits<double>::infinity();
+    double maxError = -std::numeric_limits<double>::infinity();
+    for(std::size_t i = 0; i < residuals.size(); ++i)
+    {
+      const double error = residuals[i];
+      if(!(error <= maxThreshold))
+        continue;
+      minError = std::min(minError, error);
+      maxError = std::max(maxError, error);
+      ++_nbKept;
+    }
+
+    const ErrorIndex notFound(std::numeric_limits<double>::infinity(), startIndex);
+    if(_nbKept <= static_cast<std::size_t>(startIndex))
+      return notFound;
+
+    // logarithmic bins: the bits of positive floats are ordered like their values
+    _nbBins = std::min(static_cast<std::size_t>(maxBins), _nbKept / 4 + 1);
+    const bool logBins = (minError >= 0.0);
+    const std::uint32_t keyMin = logBins ? floatKey(minError) : 0;
+    const std::uint64_t keyRange = logBins ? floatKey(maxError) - keyMin : 0;
+    int shift = 0;
+    while((keyRange >> shift) >= _nbBins)
+      ++shift;
+    if(!logBins)
+      _nbBins = 1;
+
+    std::fill(_binBegin.begin(), _binBegin.begin() + _nbBins + 1, 0);
+    std::fill(_binMin.begin(), _binMin.begin() + _nbBins, std::numeric_limits<double>::infinity());
+    std::fill(_binMax.begin(), _binMax.begin() + _nbBins, -std::numeric_limits<double>::infinity());
+    std::fill(_binSorted.begin(), _binSorted.begin() + _nbBins, 0);
+
+    for(std::size_t i = 0; i < residuals.size(); ++i)
+    {
+      const double error = residuals[i];
+      if(!(error <= maxThreshold))
+        continue;
+      const std::uint32_t bin = logBins ? ((floatKey(error) - keyMin) >> shift) : 0;
+      _binOf[i] = bin;
+      ++_binBegin[bin + 1];
+      _binMin[bin] = std::min(_binMin[bin], error);
+      _binMax[bin] = std::max(_binMax[bin], error);
+    }
+    std::partial_sum(_binBegin.begin(), _binBegin.begin() + _nbBins + 1, _binBegin.begin());
+
+    // scatter the residuals in their bins (counting sort)
+    {
+      std::vector<std::size_t>& binEnd = _binOrder; // used as insertion cursors
+      std::copy(_binBegin.begin(), _binBegin.begin() + _nbBins, binEnd.begin());
+      for(std::size_t i = 0; i < residuals.size(); ++i)
+      {
+        const double error = residuals[i];
+        if(!(error <= maxThreshold))
+          continue;
+        _bucketed[binEnd[_binOf[i]]++] = ErrorIndex(error, i);
+      }
+    }
+
+    // lower bound of the NFA over each bin, with k the number of inliers
+    for(std::size_t b = 0; b < _nbBins; ++b)
+    {
+      _binLowerBound[b] = std::numeric_limits<double>::infinity();
+      const std::size_t kBegin = std::max(_binBegin[b] + 1, static_cast<std::size_t>(startIndex + 1));
+      const std::size_t kEnd = _binBegin[b + 1];
+      if(kBegin > kEnd)
+        continue;
+      const double logalpha = std::min(logalpha0 + multError * log10(_binMin[b] + std::numeric_limits<float>::epsilon()),
+                                       logalpha0 + multError * log10(_binMax[b] + std::numeric_limits<float>::epsilon()));
+      for(std::size_t k = kBegin; k <= kEnd; ++k)
+      {
+        const double nfa = loge0 + logalpha * (double) (k - startIndex) + logc_n[k] + logc_k[k];
+        _binLowerBound[b] = std::min(_binLowerBound[b], nfa);
+      }
+    }
+
+    std::iota(_binOrder.begin(), _binOrder.begin() + _nbBins, 0);
+    std::sort(_binOrder.begin(), _binOrder.begin() + _nbBins, [this](std::size_t a, std::size_t b) {
+      return _binLowerBound[a] < _binLowerBound[b] || (_binLowerBound[a] == _binLowerBound[b] && a < b);
+    });
+
+    // evaluate the most promising bins first, until no bin can beat the best NFA
+    ErrorIndex bestIndex(minNFA, startIndex);
+    bool found = false;
+    for(std::size_t o = 0; o < _nbBins; ++o)
+    {
+      const std::size_t b = _binOrder[o];
+      const std::size_t kBegin = std::max(_binBegin[b] + 1, static_cast<std::size_t>(startIndex + 1));
+      if(!(_binLowerBound[b] <= bestIndex.first))
+        break;
+      if(_binLowerBound[b] == bestIndex.first && (!found || kBegin > bestIndex.second))
+        continue;
+
+      sortBin(b);
+      for(std::size_t k = kBegin; k <= _binBegin[b + 1]; ++k)
+      {
+        const double logalpha = logalpha0 +
+          multError * log10(_bucketed[k - 1].first + std::numeric_limits<float>::epsilon());
+        const ErrorIndex index(loge0 +
+                               logalpha * (double) (k - startIndex) +
+                               logc_n[k] +
+                               logc_k[k], k);
+
+        // same choice as bestNFA: the smallest NFA, with the fewest inliers
+        if(index.first < bestIndex.first || (found && index.first == bestIndex.first && index.second < bestIndex.second))
+        {
+          bestIndex = index;
+          found = true;
+        }
+      }
+    }
+    return found ? bestIndex : notFound;
+  }
+
+  /**
+   * @brief Get the data with the smallest residuals, from the last call to bestNFA()
+   * @param[in] nbInliers the number of inliers, as returned by bestNFA()
+   * @param[out] inliers the indices of the inliers, sorted by residual
+   * @return the largest residual of the inliers
+   */
+  double getInliers(std::size_t nbInliers, std::vector<std::size_t>& inliers)
+  {
+    assert(nbInliers > 0 && nbInliers <= _nbKept);
+    for(std::size_t b = 0; b < _nbBins && _binBegin[b] < nbInliers; ++b)
+      sortBin(b);
+
+    inliers.resize(nbInliers);
+    for(std::size_t i = 0; i < nbInliers; ++i)
+      inliers[i] = _bucketed[i].second;
+    return _bucketed[nbInliers - 1].first;
+  }
+
+private:
+  /// Key of a positive residual, ordered like the residuals
+  static std::uint32_t floatKey(double error)
+  {
+    const float value = static_cast<float>(error) + 0.0f; // no negative zero
+    std::uint32_t key;
+    std::memcpy(&key, &value, sizeof(key));
+    return key;
+  }
+
+  void sortBin(std::size_t bin)
+  {
+    if(_binSorted[bin])
+      return;
+    std::sort(_bucketed.begin() + _binBegin[bin], _bucketed.begin() + _binBegin[bin + 1]);
+    _binSorted[bin] = 1;
+  }
+
+  /// Maximal number of bins of the histogram
+  static const std::size_t maxBins = 256;
+
+  std::size_t _nbKept = 0;
+  std::size_t _nbBins = 0;
+  std::vector<std::uint32_t> _binOf;
+  std::vector<ErrorIndex> _bucketed;
+  std::vector<std::size_t> _binBegin;
+  std::vector<double> _binMin;
+  std::vector<double> _binMax;
+  std::vector<double> _binLowerBound;
+  std::vector<std::size_t> _binOrder;
+  std::vector<char> _binSorted;
+};
+
 
 /**
  * @brief ACRANSAC routine (ErrorThreshold, NFA)
@@ -138,6 +353,9 @@ inline ErrorIndex bestNFA(int startIndex, //number of point required for estimat
  * @param[in] nIter maximum number of consecutive iterations
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
+ * @param[in] adaptiveIterations bound the focused sampling iterations by the number of
+ *            iterations needed to draw an outlier-free sample at the inlier ratio found
+ *            (faster on high inlier ratios, but the model precision may be lower)
  *
  * @return (errorMax, minNFA)
  */
@@ -147,7 +365,8 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
                                    std::vector<size_t>& vec_inliers,
                                    std::size_t nIter = 1024,
                                    typename Kernel::ModelT* model = nullptr,
-                                   double precision = std::numeric_limits<double>::infinity())
+                                   double precision = std::numeric_limits<double>::infinity(),
+                                   bool adaptiveIterations = false)
 {
   vec_inliers.clear();
 
@@ -160,8 +379,8 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
     std::numeric_limits<double>::infinity() :
     precision * kernel.normalizer2()(0,0) * kernel.normalizer2()(0,0);
 
-  std::vector<ErrorIndex> vec_residuals(nData); // [residual,index]
-  std::vector<double> vec_residuals_(nData);
+  std::vector<double> vec_residuals(nData);
+  NFAHistogram nfaHistogram(nData);
 
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
   std::vector<size_t> vec_index(nData);
@@ -182,31 +401,33 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
 
   bool bACRansacMode = (precision == std::numeric_limits<double>::infinity());
 
+  std::vector<std::size_t> vec_sample(sizeSample); // Sample indices
+  std::vector<typename Kernel::ModelT> vec_models; // Up to max_models solutions
+
   // Main estimation loop.
   for(std::size_t iter = 0; iter < nIter; ++iter)
   {
-    std::vector<std::size_t> vec_sample(sizeSample); // Sample indices
     if (bACRansacMode)
       uniformSample(randomNumberGenerator, sizeSample, vec_index, vec_sample); // Get random sample
     else
       uniformSample(randomNumberGenerator, sizeSample, nData, vec_sample); // Get random sample
 
-    std::vector<typename Kernel::ModelT> vec_models; // Up to max_models solutions
+    vec_models.clear();
     kernel.fit(vec_sample, vec_models);
 
     // Evaluate models
     bool better = false;
     for (std::size_t k = 0; k < vec_models.size(); ++k)
     {
-      // Residuals computation and ordering
-      kernel.errors(vec_models[k], vec_residuals_);
+      // Residuals computation
+      kernel.errors(vec_models[k], vec_residuals);
 
       if (!bACRansacMode)
       {
         unsigned int nInlier = 0;
         for (std::size_t i = 0; i < nData; ++i)
         {
-          if (vec_residuals_[i] <= maxThreshold)
+          if (vec_residuals[i] <= maxThreshold)
             ++nInlier;
         }
         if (nInlier > 2.5 * sizeSample) // does the model is meaningful
@@ -214,15 +435,9 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
       }
       if (bACRansacMode)
       {
-        for (size_t i = 0; i < nData; ++i)
-        {
-          const double error = vec_residuals_[i];
-          vec_residuals[i] = ErrorIndex(error, i);
-        }
-        std::sort(vec_residuals.begin(), vec_residuals.end());
-
-        // Most meaningful discrimination inliers/outliers
-        const ErrorIndex best = bestNFA(
+        // Most meaningful discrimination inliers/outliers,
+        // only evaluated where the model can beat the best NFA so far
+        const ErrorIndex best = nfaHistogram.bestNFA(
           sizeSample,
           kernel.logalpha0(),
           vec_residuals,
@@ -230,17 +445,15 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
           maxThreshold,
           vec_logc_n,
           vec_logc_k,
-          kernel.multError());
+          kernel.multError(),
+          minNFA);
 
         if (best.first < minNFA /*&& vec_residuals[best.second-1].first < errorMax*/)
         {
           // A better model was found
           better = true;
           minNFA = best.first;
-          vec_inliers.resize(best.second);
-          for (size_t i=0; i<best.second; ++i)
-            vec_inliers[i] = vec_residuals[i].second;
-          errorMax = vec_residuals[best.second-1].first; // Error threshold
+          errorMax = nfaHistogram.getInliers(best.second, vec_inliers); // Error threshold
           if(model) *model = vec_models[k];
 
           ALICEVISION_LOG_TRACE("  nfa=" << minNFA
@@ -273,6 +486,16 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
         vec_index = vec_inliers;
         if(nIterReserve)
         {
+          if(adaptiveIterations)
+          {
+            // iterations needed to draw an outlier-free sample with a 99% confidence,
+            // the focused sampling keeps at least a quarter of its budget to refine the precision
+            const double inlierRatio = vec_inliers.size() / static_cast<double>(nData);
+            const double nbRequired = std::log(0.01) / std::log1p(-std::pow(inlierRatio, static_cast<int>(sizeSample)));
+            const std::size_t minIterReserve = std::max<std::size_t>(1, nIterReserve / 4);
+            if(nbRequired < nIterReserve)
+              nIterReserve = std::max(minIterReserve, static_cast<std::size_t>(nbRequired));
+          }
           nIter = iter + 1 + nIterReserve;
           nIterReserve = 0;
         }
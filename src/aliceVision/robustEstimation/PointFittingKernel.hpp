@@ -12,12 +12,29 @@
 #include <aliceVision/robustEstimation/conditioning.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
 
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <cassert>
 
 namespace aliceVision {
 namespace robustEstimation {
 
+/**
+ * @brief Tells if an error functor can compute the errors of a set of points at once:
+ *        errors(model, x1, x2, errors) with the points in SoA layout (one row per coordinate).
+ */
+template<typename ErrorT, typename ModelT, typename = void>
+struct HasBatchErrors : std::false_type {};
+
+template<typename ErrorT, typename ModelT>
+struct HasBatchErrors<ErrorT, ModelT, decltype(std::declval<const ErrorT&>().errors(std::declval<const ModelT&>(),
+                                                                                     std::declval<const RMat&>(),
+                                                                                     std::declval<const RMat&>(),
+                                                                                     std::declval<Eigen::Ref<Vec>>()), void())>
+  : std::true_type {};
+
 /**
  * @brief This is one example (targeted at solvers that operate on correspondences
  * between two views) that shows the "kernel" part of a robust fitting
@@ -43,6 +60,9 @@ namespace robustEstimation {
  *
  * The fit routine must not clear existing entries in the vector of models; it
  * should append new solutions to the end.
+ *
+ * A kernel that overrides error() must also override errors(), which is used
+ * by the robust estimators to score the models.
  */
 template<typename SolverT_, typename ErrorT_, typename ModelT_ = Mat3Model>
 class PointFittingKernel
@@ -83,9 +103,16 @@ public:
    */
   inline virtual void fit(const std::vector<std::size_t>& samples, std::vector<ModelT>& models) const
   {
-    const Mat x1 = ExtractColumns(_x1, samples);
-    const Mat x2 = ExtractColumns(_x2, samples);
-    _kernelSolver.solve(x1, x2, models);
+    // the sample buffers are reused across the iterations of the robust estimators
+    // (the size of the minimal samples does not change, so they are not reallocated)
+    _x1Samples.resize(_x1.rows(), samples.size());
+    _x2Samples.resize(_x2.rows(), samples.size());
+    for(std::size_t i = 0; i < samples.size(); ++i)
+    {
+      _x1Samples.col(i) = _x1.col(samples[i]);
+      _x2Samples.col(i) = _x2.col(samples[i]);
+    }
+    _kernelSolver.solve(_x1Samples, _x2Samples, models);
   }
 
   /**
@@ -107,8 +134,7 @@ public:
   inline virtual void errors(const ModelT& model, std::vector<double>& errors) const
   {
     errors.resize(_x1.cols());
-    for(std::size_t sample = 0; sample < _x1.cols(); ++sample)
-      errors.at(sample) = error(sample, model);
+    computeErrors(model, errors, HasBatchErrors<ErrorT, ModelT>());
   }
 
   /**
@@ -122,6 +148,34 @@ public:
 
 protected:
 
+  /// Compute the errors point by point
+  void computeErrors(const ModelT& model, std::vector<double>& errors, std::false_type) const
+  {
+    for(std::size_t sample = 0; sample < _x1.cols(); ++sample)
+      errors[sample] = _errorEstimator.error(model, _x1.col(sample), _x2.col(sample));
+  }
+
+  /// Compute the errors by blocks of points, copied in SoA layout so the error functor can use SIMD instructions
+  void computeErrors(const ModelT& model, std::vector<double>& errors, std::true_type) const
+  {
+    using RowBlock = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor, 4, errorsBlockSize>;
+    assert(_x1.rows() <= 4 && _x2.rows() <= 4);
+
+    RowBlock x1Block;
+    RowBlock x2Block;
+    for(Eigen::Index begin = 0; begin < _x1.cols(); begin += errorsBlockSize)
+    {
+      const Eigen::Index size = std::min<Eigen::Index>(errorsBlockSize, _x1.cols() - begin);
+      x1Block = _x1.middleCols(begin, size);
+      x2Block = _x2.middleCols(begin, size);
+      Eigen::Map<Vec> blockErrors(errors.data() + begin, size);
+      _errorEstimator.errors(model, x1Block, x2Block, blockErrors);
+    }
+  }
+
+  /// number of points of a block for the batch errors computation
+  static const int errorsBlockSize = 256;
+
   /// left corresponding data
   const Mat& _x1;
   /// right corresponding data
@@ -130,6 +184,10 @@ protected:
   const SolverT _kernelSolver{};
   /// solver error estimation
   const ErrorT _errorEstimator{};
+  /// left samples buffer of fit (a kernel is not shared between threads)
+  mutable Mat _x1Samples;
+  /// right samples buffer of fit
+  mutable Mat _x2Samples;
 };
 
 template<typename SolverT_, typename ErrorT_, typename UnnormalizerT_, typename ModelT_ = Mat3Model>
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <vector>
+
 namespace aliceVision {
 namespace robustEstimation{
 
@@ -28,10 +30,15 @@ public:
                std::vector<T>& inliers,
                double threshold) const
   {
+    // all the samples are usually scored: use the batch errors computation
+    const bool allSamples = (samples.size() == kernel.nbSamples());
+    if(allSamples)
+      kernel.errors(model, _errors);
+
     double cost = 0.0;
     for(std::size_t j = 0; j < samples.size(); ++j)
     {
-      double error = kernel.error(samples.at(j), model);
+      double error = allSamples ? _errors[samples[j]] : kernel.error(samples.at(j), model);
       if (error < threshold) 
       {
         cost += error;
@@ -59,6 +66,8 @@ public:
   
 private:
   double _threshold;
+  /// buffer for the errors of all the samples
+  mutable std::vector<double> _errors;
 };
 
 } // namespace robustEstimation
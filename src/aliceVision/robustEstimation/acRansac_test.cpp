@@ -271,3 +271,115 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACSimu)
 
   }
 }
+
+// test the adaptive iterations of the focused sampling give models as good as the full budget
+BOOST_AUTO_TEST_CASE(RansacLineFitter_AdaptiveIterations)
+{
+  const int S = 100;
+  Vec2 GTModel;
+  GTModel << -2, .3;
+  std::mt19937 gen;
+
+  for(std::size_t trial = 0; trial < 20; ++trial)
+  {
+    const double gaussianNoiseLevel = (trial % 5) * 0.5;
+    const double outlierRatio = 0.1 + (trial % 4) * 0.15;
+    const std::size_t numPoints = 2.0 * S * sqrt(2.0);
+
+    Mat2X points(2, numPoints);
+    std::vector<std::size_t> vec_inliersGT;
+    generateLine(numPoints, outlierRatio, gaussianNoiseLevel, GTModel, gen, points, vec_inliersGT);
+
+    LineKernel lineKernel(points, S, S);
+
+    const std::mt19937::result_type seed = gen();
+
+    std::mt19937 fullGen(seed);
+    std::vector<std::size_t> fullInliers;
+    robustEstimation::MatrixModel<Vec2> fullModel;
+    const std::pair<double,double> full = ACRANSAC(lineKernel, fullGen, fullInliers, 1000, &fullModel,
+                                                   std::numeric_limits<double>::infinity(), false);
+
+    std::mt19937 adaptiveGen(seed);
+    std::vector<std::size_t> adaptiveInliers;
+    robustEstimation::MatrixModel<Vec2> adaptiveModel;
+    const std::pair<double,double> adaptive = ACRANSAC(lineKernel, adaptiveGen, adaptiveInliers, 1000, &adaptiveModel,
+                                                       std::numeric_limits<double>::infinity(), true);
+
+    BOOST_TEST_MESSAGE("noise " << gaussianNoiseLevel << " outliers " << outlierRatio
+                       << " \tinliers " << fullInliers.size() << " / " << adaptiveInliers.size()
+                       << " \tNFA " << full.second << " / " << adaptive.second);
+
+    BOOST_REQUIRE(!fullInliers.empty());
+    BOOST_REQUIRE(!adaptiveInliers.empty());
+    BOOST_CHECK_GE(adaptiveInliers.size(), 0.9 * fullInliers.size());
+    BOOST_CHECK_LT(adaptive.second, 0.95 * full.second);
+  }
+}
+
+// test the NFA evaluation on a residual histogram gives the same result as on the sorted residuals
+BOOST_AUTO_TEST_CASE(NFAHistogram_SameAsSorted)
+{
+  std::mt19937 gen;
+  std::uniform_real_distribution<double> inlierError(0.0, 1e-4);
+  std::uniform_real_distribution<double> outlierError(0.0, 1.0);
+  std::uniform_real_distribution<double> ratio(0.0, 1.0);
+
+  const std::size_t sizeSample = 7;
+  const double logalpha0 = log10(M_PI);
+
+  for(std::size_t trial = 0; trial < 200; ++trial)
+  {
+    const std::size_t nData = 8 + gen() % 2000;
+    const double inlierRatio = ratio(gen);
+    const double maxThreshold = (trial % 3 == 0) ? 0.5 : std::numeric_limits<double>::infinity();
+    const double multError = (trial % 2 == 0) ? 1.0 : 0.5;
+
+    // residuals with ties and zeros
+    std::vector<double> residuals(nData);
+    for(double& error : residuals)
+      error = (ratio(gen) < inlierRatio) ? inlierError(gen) : outlierError(gen);
+    for(std::size_t i = 0; i < nData / 10; ++i)
+      residuals[gen() % nData] = residuals[gen() % nData];
+    residuals[gen() % nData] = 0.0;
+
+    const double loge0 = log10(3.0 * (nData - sizeSample));
+    std::vector<float> logc_n, logc_k;
+    makelogcombi(sizeSample, nData, logc_k, logc_n);
+
+    std::vector<ErrorIndex> sorted(nData);
+    for(std::size_t i = 0; i < nData; ++i)
+      sorted[i] = ErrorIndex(residuals[i], i);
+    std::sort(sorted.begin(), sorted.end());
+    const ErrorIndex expected = bestNFA(sizeSample, logalpha0, sorted, loge0, maxThreshold, logc_n, logc_k, multError);
+
+    NFAHistogram histogram(nData);
+
+    // nothing to beat
+    const ErrorIndex best = histogram.bestNFA(sizeSample, logalpha0, residuals, loge0, maxThreshold, logc_n, logc_k, multError,
+                                              std::numeric_limits<double>::infinity());
+    BOOST_CHECK_EQUAL(best.first, expected.first);
+    BOOST_CHECK_EQUAL(best.second, expected.second);
+
+    if(expected.first < std::numeric_limits<double>::infinity())
+    {
+      std::vector<std::size_t> inliers;
+      const double errorMax = histogram.getInliers(best.second, inliers);
+      BOOST_CHECK_EQUAL(errorMax, sorted[expected.second - 1].first);
+      BOOST_REQUIRE_EQUAL(inliers.size(), expected.second);
+      for(std::size_t i = 0; i < inliers.size(); ++i)
+        BOOST_CHECK_EQUAL(inliers[i], sorted[i].second);
+
+      // the model cannot beat its own NFA
+      const ErrorIndex notBetter = histogram.bestNFA(sizeSample, logalpha0, residuals, loge0, maxThreshold, logc_n, logc_k, multError,
+                                                     expected.first);
+      BOOST_CHECK(!(notBetter.first < expected.first));
+
+      // the model beats a slightly larger NFA
+      const ErrorIndex better = histogram.bestNFA(sizeSample, logalpha0, residuals, loge0, maxThreshold, logc_n, logc_k, multError,
+                                                  expected.first + 1e-6);
+      BOOST_CHECK_EQUAL(better.first, expected.first);
+      BOOST_CHECK_EQUAL(better.second, expected.second);
+    }
+  }
+}
@@ -6,6 +6,7 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/sfm/BundleAdjustmentSymbolicCeres.hpp>
+#include <aliceVision/sfm/BundleAdjustmentSymbolicCostFunctions.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/config.hpp>
@@ -15,7 +16,10 @@
 
 #include <ceres/rotation.h>
 
+#include <atomic>
 #include <fstream>
+#include <map>
+#include <vector>
 
 
 namespace fs = boost::filesystem;
@@ -178,87 +182,8 @@ class IntrinsicsParameterization : public ceres::LocalParameterization {
 };
 
 
-class CostProjection : public ceres::CostFunction {
-public:
-  CostProjection(const sfmData::Observation& measured, const std::shared_ptr<camera::IntrinsicBase> & intrinsics, bool withRig) : _measured(measured), _intrinsics(intrinsics), _withRig(withRig)
-  {
-    set_num_residuals(2);
-
-    mutable_parameter_block_sizes()->push_back(16);
-    mutable_parameter_block_sizes()->push_back(16);
-    mutable_parameter_block_sizes()->push_back(intrinsics->getParams().size());    
-    mutable_parameter_block_sizes()->push_back(3);    
-  }
-
-  bool Evaluate(double const * const * parameters, double * residuals, double ** jacobians) const override
-  {
-    const double * parameter_pose = parameters[0];
-    const double * parameter_rig = parameters[1];
-    const double * parameter_intrinsics = parameters[2];
-    const double * parameter_landmark = parameters[3];
-
-    const Eigen::Map<const SE3::Matrix> rTo(parameter_pose);
-    const Eigen::Map<const SE3::Matrix> cTr(parameter_rig);
-    const Eigen::Map<const Vec3> pt(parameter_landmark);
-
-    /*Update intrinsics object with estimated parameters*/
-    size_t params_size = _intrinsics->getParams().size();
-    std::vector<double> params;
-    for (size_t param_id = 0; param_id < params_size; param_id++) {
-      params.push_back(parameter_intrinsics[param_id]);
-    }
-    _intrinsics->updateFromParams(params);
-
-    const SE3::Matrix T = cTr * rTo;
-    const geometry::Pose3 T_pose3(T.block<3, 4>(0, 0));
-
-    const Vec4 pth = pt.homogeneous();
-
-    const Vec2 pt_est = _intrinsics->project(T_pose3, pth, true);
-    const double scale = (_measured.scale > 1e-12) ? _measured.scale : 1.0;
-
-    residuals[0] = (pt_est(0) - _measured.x(0)) / scale;
-    residuals[1] = (pt_est(1) - _measured.x(1)) / scale;
-
-    if (jacobians == nullptr) {
-      return true;
-    }
-
-    Eigen::Matrix2d d_res_d_pt_est = Eigen::Matrix2d::Identity() / scale;
-
-    if (jacobians[0] != nullptr) {
-      Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[0]);
-
-      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtPose(T_pose3, pth) * getJacobian_AB_wrt_B<4, 4, 4>(cTr, rTo) * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), rTo);
-    }
-
-    if (jacobians[1] != nullptr) {
-      Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[1]);
-      
-      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtPose(T_pose3, pth) * getJacobian_AB_wrt_A<4, 4, 4>(cTr, rTo) * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), cTr);
-    }
-
-    if (jacobians[2] != nullptr) {
-      Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> J(jacobians[2], 2, params_size);
-      
-      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtParams(T_pose3, pth);
-    }
-
-    if (jacobians[3] != nullptr) {
-      Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J(jacobians[3]);
-
-
-      J = d_res_d_pt_est * _intrinsics->getDerivativeProjectWrtPoint(T_pose3, pth) * Eigen::Matrix<double, 4, 3>::Identity();
-    }
-
-    return true;
-  }
-
-private:
-  const sfmData::Observation & _measured;
-  const std::shared_ptr<camera::IntrinsicBase> _intrinsics;
-  bool _withRig;
-};
+/// identifier of the last created problem
+static std::atomic<std::size_t> lastProblemId(0);
 
 void BundleAdjustmentSymbolicCeres::addPose(const sfmData::CameraPose& cameraPose, bool isConstant, SE3::Matrix & poseBlock, ceres::Problem& problem, bool refineTranslation, bool refineRotation)
 {
@@ -271,6 +196,9 @@ void BundleAdjustmentSymbolicCeres::addPose(const sfmData::CameraPose& cameraPos
   double * poseBlockPtr = poseBlock.data();
   problem.AddParameterBlock(poseBlockPtr, 16);
 
+  // poses and rig sub-poses are eliminated after the landmarks
+  if(_ceresOptions.useParametersOrdering)
+    _linearSolverOrdering.AddElementToGroup(poseBlockPtr, 1);
 
   // add pose parameter to the all parameters blocks pointers list
   _allParametersBlocks.push_back(poseBlockPtr);
@@ -474,6 +402,15 @@ void BundleAdjustmentSymbolicCeres::setSolverOptions(ceres::Solver::Options& sol
   solverOptions.num_linear_solver_threads = _ceresOptions.nbThreads;
 #endif
 
+#if CERES_VERSION_MAJOR >= 2
+  // factorize the linear system in single precision and recover the accuracy with iterative refinement
+  solverOptions.use_mixed_precision_solves = _ceresOptions.useMixedPrecisionSolves;
+  solverOptions.max_num_refinement_iterations = _ceresOptions.maxNumRefinementIterations;
+#else
+  if(_ceresOptions.useMixedPrecisionSolves)
+    ALICEVISION_LOG_WARNING("BundleAdjustmentSymbolic[Ceres]: mixed precision solves require Ceres 2, option ignored.");
+#endif
+
   if(_ceresOptions.useParametersOrdering)
   {
     // copy ParameterBlockOrdering
@@ -576,6 +513,9 @@ void BundleAdjustmentSymbolicCeres::addIntrinsicsToProblem(const sfmData::SfMDat
     double* intrinsicBlockPtr = intrinsicBlock.data();
     problem.AddParameterBlock(intrinsicBlockPtr, intrinsicBlock.size());
 
+    if(_ceresOptions.useParametersOrdering)
+      _linearSolverOrdering.AddElementToGroup(intrinsicBlockPtr, 2);
+
     // add intrinsic parameter to the all parameters blocks pointers list
     _allParametersBlocks.push_back(intrinsicBlockPtr);
 
@@ -724,14 +664,12 @@ void BundleAdjustmentSymbolicCeres::addLandmarksToProblem(const sfmData::SfMData
       }
 
       // apply a specific parameter ordering:
+      // landmarks are eliminated first by the Schur complement solvers
       if(_ceresOptions.useParametersOrdering)
-      {
         _linearSolverOrdering.AddElementToGroup(landmarkBlockPtr, 0);
-        _linearSolverOrdering.AddElementToGroup(poseBlockPtr, 1);
-        _linearSolverOrdering.AddElementToGroup(intrinsicBlockPtr, 2);
-      }
 
-      ceres::CostFunction* costFunction = new CostProjection(observation, intrinsic, withRig);
+      // the residual blocks of a landmark are consecutive
+      ceres::CostFunction* costFunction = createCostProjection(observation, intrinsic, _problemId);
       problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr, rigBlockPtr, intrinsicBlockPtr, landmarkBlockPtr);
 
       if(!refineStructure || getLandmarkState(landmarkId) == EParameterState::CONSTANT)
@@ -748,6 +686,61 @@ void BundleAdjustmentSymbolicCeres::addLandmarksToProblem(const sfmData::SfMData
   }
 }
 
+void BundleAdjustmentSymbolicCeres::addConstraints2DToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem)
+{
+  // set a LossFunction to be less penalized by false measurements.
+  // note: set it to NULL if you don't want use a lossFunction.
+  ceres::LossFunction* lossFunction = _ceresOptions.lossFunction.get();
+
+  for (const auto & constraint : sfmData.getConstraints2D()) {
+    const sfmData::View& view_1 = sfmData.getView(constraint.ViewFirst);
+    const sfmData::View& view_2 = sfmData.getView(constraint.ViewSecond);
+
+    assert(getPoseState(view_1.getPoseId()) != EParameterState::IGNORED);
+    assert(getIntrinsicState(view_1.getIntrinsicId()) != EParameterState::IGNORED);
+    assert(getPoseState(view_2.getPoseId()) != EParameterState::IGNORED);
+    assert(getIntrinsicState(view_2.getIntrinsicId()) != EParameterState::IGNORED);
+
+    double * poseBlockPtr_1 = _posesBlocks.at(view_1.getPoseId()).data();
+    double * poseBlockPtr_2 = _posesBlocks.at(view_2.getPoseId()).data();
+
+    double * intrinsicBlockPtr_1 = _intrinsicsBlocks.at(view_1.getIntrinsicId()).data();
+    double * intrinsicBlockPtr_2 = _intrinsicsBlocks.at(view_2.getIntrinsicId()).data();
+
+    //For the moment assume a unique camera
+    assert(intrinsicBlockPtr_1 == intrinsicBlockPtr_2);
+
+    ceres::CostFunction* costFunction = createCostConstraint2D(constraint.ObservationFirst.x, constraint.ObservationSecond.x, sfmData.getIntrinsicsharedPtr(view_1.getIntrinsicId()), _problemId);
+    if(costFunction == nullptr)
+    {
+      ALICEVISION_LOG_WARNING("BundleAdjustmentSymbolicCeres: unsupported intrinsic for 2D constraints (view: " << constraint.ViewFirst << ").");
+      continue;
+    }
+
+    problem.AddResidualBlock(costFunction, lossFunction, intrinsicBlockPtr_1, poseBlockPtr_1, poseBlockPtr_2);
+  }
+}
+
+void BundleAdjustmentSymbolicCeres::addRotationPriorsToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem)
+{
+  // set a LossFunction to be less penalized by false measurements.
+  // note: set it to NULL if you don't want use a lossFunction.
+  ceres::LossFunction* lossFunction = nullptr;
+
+  for (const auto & prior : sfmData.getRotationPriors()) {
+    const sfmData::View& view_1 = sfmData.getView(prior.ViewFirst);
+    const sfmData::View& view_2 = sfmData.getView(prior.ViewSecond);
+
+    assert(getPoseState(view_1.getPoseId()) != EParameterState::IGNORED);
+    assert(getPoseState(view_2.getPoseId()) != EParameterState::IGNORED);
+
+    double * poseBlockPtr_1 = _posesBlocks.at(view_1.getPoseId()).data();
+    double * poseBlockPtr_2 = _posesBlocks.at(view_2.getPoseId()).data();
+
+    ceres::CostFunction* costFunction = new CostRotationPrior(prior._second_R_first);
+    problem.AddResidualBlock(costFunction, lossFunction, poseBlockPtr_1, poseBlockPtr_2);
+  }
+}
 
 void BundleAdjustmentSymbolicCeres::createProblem(const sfmData::SfMData& sfmData,
                                           ERefineOptions refineOptions,
@@ -756,6 +749,9 @@ void BundleAdjustmentSymbolicCeres::createProblem(const sfmData::SfMData& sfmDat
   // clear previously computed data
   resetProblem();
 
+  // the cost functions of this problem use their own copies of the intrinsics
+  _problemId = ++lastProblemId;
+
   // ensure we are not using incompatible options
   // REFINEINTRINSICS_OPTICALCENTER_ALWAYS and REFINEINTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA cannot be used at the same time
   assert(!((refineOptions & REFINE_INTRINSICS_OPTICALOFFSET_ALWAYS) && (refineOptions & REFINE_INTRINSICS_OPTICALOFFSET_IF_ENOUGH_DATA)));
@@ -768,6 +764,12 @@ void BundleAdjustmentSymbolicCeres::createProblem(const sfmData::SfMData& sfmDat
 
   // add SfM landmarks to the Ceres problem
   addLandmarksToProblem(sfmData, refineOptions, problem);
+
+  // add 2D constraints to the Ceres problem
+  addConstraints2DToProblem(sfmData, refineOptions, problem);
+
+  // add rotation priors to the Ceres problem
+  addRotationPriorsToProblem(sfmData, refineOptions, problem);
 }
 
 void BundleAdjustmentSymbolicCeres::updateFromSolution(sfmData::SfMData& sfmData, ERefineOptions refineOptions) const
@@ -885,7 +887,6 @@ bool BundleAdjustmentSymbolicCeres::adjust(sfmData::SfMData& sfmData, ERefineOpt
   ceres::Solve(options, &problem, &summary);
 
   // print summary
-  std::cout << "symbolic" << std::endl;
   if(_ceresOptions.summary) {
     ALICEVISION_LOG_INFO(summary.FullReport());
   }
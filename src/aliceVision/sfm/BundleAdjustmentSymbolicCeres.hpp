@@ -54,6 +54,10 @@ public:
     std::shared_ptr<ceres::LossFunction> lossFunction;
     unsigned int nbThreads;
     bool useParametersOrdering = true;
+    /// solve the linear system in single precision with iterative refinement (Cholesky based solvers, Ceres >= 2)
+    bool useMixedPrecisionSolves = false;
+    /// number of refinement iterations of the mixed precision solves
+    int maxNumRefinementIterations = 3;
     bool summary = false;
     bool verbose = true;
   };
@@ -217,6 +221,22 @@ private:
    */
   void addLandmarksToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
 
+  /**
+   * @brief Create a residual block for each 2D constraints
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction, notably the intrinsics
+   * @param[in] refineOptions The chosen refine flag
+   * @param[out] problem The Ceres bundle adjustement problem
+   */
+  void addConstraints2DToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
+
+  /**
+   * @brief Create a residual block for each rotation priors
+   * @param[in] sfmData The input SfMData contains all the information about the reconstruction, notably the intrinsics
+   * @param[in] refineOptions The chosen refine flag
+   * @param[out] problem The Ceres bundle adjustement problem
+   */
+  void addRotationPriorsToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions, ceres::Problem& problem);
+
   /**
    * @brief Create the Ceres bundle adjustement problem with:
    *  - extrincics and intrinsics parameters blocks.
@@ -298,6 +318,9 @@ private:
   ///Rig pose to use when there is no rig
   SE3::Matrix _rigNull = SE3::Matrix::Identity();
 
+  /// identifier of the current problem, used by the cost functions to get their own copies of the intrinsics
+  std::size_t _problemId = 0;
+
   /// hinted order for ceres to eliminate blocks when solving.
   /// note: this ceres parameter is built internally and must be reset on each call to the solver.
   ceres::ParameterBlockOrdering _linearSolverOrdering;
@@ -0,0 +1,381 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/camera/IntrinsicBase.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/sfmData/Landmark.hpp>
+#include <aliceVision/sfm/liealgebra.hpp>
+
+#include <ceres/ceres.h>
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * Cost functions with analytic jacobians of the BundleAdjustmentSymbolicCeres.
+ * The jacobians of the pose blocks are expressed for a left perturbation of the pose,
+ * they are completed by the jacobian of SE3::LocalParameterization.
+ */
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Get the copy of an intrinsic owned by the calling thread.
+ *        The cost functions update their intrinsic from the parameter block before each evaluation
+ *        and ceres evaluates the residual blocks in parallel, so the threads cannot share the sfmData intrinsics.
+ * @param[in] intrinsic The intrinsic of the sfmData
+ * @param[in] problemId The identifier of the problem, the copies of the other problems are released
+ * @return the intrinsic copy of the calling thread
+ */
+inline camera::IntrinsicBase& getThreadIntrinsic(const camera::IntrinsicBase& intrinsic, std::size_t problemId)
+{
+  struct ThreadIntrinsics
+  {
+    std::size_t problemId = 0;
+    std::map<const camera::IntrinsicBase*, std::unique_ptr<camera::IntrinsicBase>> intrinsics;
+  };
+
+  thread_local ThreadIntrinsics threadIntrinsics;
+
+  if(threadIntrinsics.problemId != problemId)
+  {
+    threadIntrinsics.intrinsics.clear();
+    threadIntrinsics.problemId = problemId;
+  }
+
+  std::unique_ptr<camera::IntrinsicBase>& copy = threadIntrinsics.intrinsics[&intrinsic];
+  if(copy == nullptr)
+    copy.reset(intrinsic.clone());
+
+  return *copy;
+}
+
+/**
+ * @brief Update the calling thread copy of an intrinsic from a parameter block.
+ * @param[in] intrinsic The intrinsic of the sfmData
+ * @param[in] problemId The identifier of the problem
+ * @param[in] parameters The intrinsic parameter block
+ * @param[in] paramsSize The intrinsic parameter block size
+ * @return the updated intrinsic copy of the calling thread
+ */
+inline const camera::IntrinsicBase& updateThreadIntrinsic(const camera::IntrinsicBase& intrinsic, std::size_t problemId, const double* parameters, std::size_t paramsSize)
+{
+  thread_local std::vector<double> params;
+  params.assign(parameters, parameters + paramsSize);
+
+  camera::IntrinsicBase& threadIntrinsic = getThreadIntrinsic(intrinsic, problemId);
+  threadIntrinsic.updateFromParams(params);
+  return threadIntrinsic;
+}
+
+/**
+ * @brief Evaluate the reprojection error of a landmark observation.
+ *  Parameter blocks: pose(16), rig sub-pose(16), intrinsic(IntrinsicSize), landmark(3)
+ * @note IntrinsicSize may be Eigen::Dynamic
+ */
+template <int IntrinsicSize>
+bool evaluateProjection(const sfmData::Observation& measured, const camera::IntrinsicBase& intrinsic, std::size_t problemId,
+                        std::size_t paramsSize, double const * const * parameters, double * residuals, double ** jacobians)
+{
+  const double * parameter_pose = parameters[0];
+  const double * parameter_rig = parameters[1];
+  const double * parameter_intrinsics = parameters[2];
+  const double * parameter_landmark = parameters[3];
+
+  const Eigen::Map<const SE3::Matrix> rTo(parameter_pose);
+  const Eigen::Map<const SE3::Matrix> cTr(parameter_rig);
+  const Eigen::Map<const Vec3> pt(parameter_landmark);
+
+  /*Update intrinsics object with estimated parameters*/
+  const camera::IntrinsicBase& threadIntrinsic = updateThreadIntrinsic(intrinsic, problemId, parameter_intrinsics, paramsSize);
+
+  const SE3::Matrix T = cTr * rTo;
+  const geometry::Pose3 T_pose3(T.block<3, 4>(0, 0));
+
+  const Vec4 pth = pt.homogeneous();
+
+  const Vec2 pt_est = threadIntrinsic.project(T_pose3, pth, true);
+  const double scale = (measured.scale > 1e-12) ? measured.scale : 1.0;
+
+  residuals[0] = (pt_est(0) - measured.x(0)) / scale;
+  residuals[1] = (pt_est(1) - measured.x(1)) / scale;
+
+  if (jacobians == nullptr) {
+    return true;
+  }
+
+  const double d_res_d_pt_est = 1.0 / scale;
+
+  if (jacobians[0] != nullptr || jacobians[1] != nullptr) {
+    const Eigen::Matrix<double, 2, 16> d_res_d_T = d_res_d_pt_est * threadIntrinsic.getDerivativeProjectWrtPose(T_pose3, pth);
+
+    if (jacobians[0] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[0]);
+
+      J = d_res_d_T * getJacobian_AB_wrt_B<4, 4, 4>(cTr, rTo) * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), rTo);
+    }
+
+    if (jacobians[1] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[1]);
+
+      J = d_res_d_T * getJacobian_AB_wrt_A<4, 4, 4>(cTr, rTo) * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), cTr);
+    }
+  }
+
+  if (jacobians[2] != nullptr) {
+    Eigen::Map<Eigen::Matrix<double, 2, IntrinsicSize, Eigen::RowMajor>> J(jacobians[2], 2, paramsSize);
+
+    J = d_res_d_pt_est * threadIntrinsic.getDerivativeProjectWrtParams(T_pose3, pth);
+  }
+
+  if (jacobians[3] != nullptr) {
+    Eigen::Map<Eigen::Matrix<double, 2, 3, Eigen::RowMajor>> J(jacobians[3]);
+
+    J = d_res_d_pt_est * threadIntrinsic.getDerivativeProjectWrtPoint(T_pose3, pth).block<2, 3>(0, 0);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Reprojection error with fixed size jacobian blocks.
+ *  Parameter blocks: pose(16), rig sub-pose(16), intrinsic(IntrinsicSize), landmark(3)
+ */
+template <int IntrinsicSize>
+class CostProjection : public ceres::SizedCostFunction<2, 16, 16, IntrinsicSize, 3> {
+public:
+  CostProjection(const sfmData::Observation& measured, const std::shared_ptr<camera::IntrinsicBase> & intrinsics, std::size_t problemId)
+    : _measured(measured), _intrinsics(intrinsics), _problemId(problemId)
+  {
+  }
+
+  bool Evaluate(double const * const * parameters, double * residuals, double ** jacobians) const override
+  {
+    return evaluateProjection<IntrinsicSize>(_measured, *_intrinsics, _problemId, IntrinsicSize, parameters, residuals, jacobians);
+  }
+
+private:
+  const sfmData::Observation & _measured;
+  const std::shared_ptr<camera::IntrinsicBase> _intrinsics;
+  const std::size_t _problemId;
+};
+
+/**
+ * @brief Reprojection error for an intrinsic with an unusual number of parameters.
+ *  Parameter blocks: pose(16), rig sub-pose(16), intrinsic(N), landmark(3)
+ */
+class CostProjectionDynamic : public ceres::CostFunction {
+public:
+  CostProjectionDynamic(const sfmData::Observation& measured, const std::shared_ptr<camera::IntrinsicBase> & intrinsics, std::size_t problemId)
+    : _measured(measured), _intrinsics(intrinsics), _problemId(problemId), _paramsSize(intrinsics->getParams().size())
+  {
+    set_num_residuals(2);
+
+    mutable_parameter_block_sizes()->push_back(16);
+    mutable_parameter_block_sizes()->push_back(16);
+    mutable_parameter_block_sizes()->push_back(_paramsSize);
+    mutable_parameter_block_sizes()->push_back(3);
+  }
+
+  bool Evaluate(double const * const * parameters, double * residuals, double ** jacobians) const override
+  {
+    return evaluateProjection<Eigen::Dynamic>(_measured, *_intrinsics, _problemId, _paramsSize, parameters, residuals, jacobians);
+  }
+
+private:
+  const sfmData::Observation & _measured;
+  const std::shared_ptr<camera::IntrinsicBase> _intrinsics;
+  const std::size_t _problemId;
+  const std::size_t _paramsSize;
+};
+
+/**
+ * @brief Create the reprojection cost function of an observation,
+ *        with fixed size jacobian blocks for the parameters sizes of all the camera models.
+ */
+inline ceres::CostFunction* createCostProjection(const sfmData::Observation& measured, const std::shared_ptr<camera::IntrinsicBase> & intrinsics, std::size_t problemId)
+{
+  switch(intrinsics->getParams().size())
+  {
+    case 4:  return new CostProjection<4>(measured, intrinsics, problemId);  // Pinhole, EquiDistant
+    case 5:  return new CostProjection<5>(measured, intrinsics, problemId);  // PinholeRadialK1, PinholeFisheye1
+    case 7:  return new CostProjection<7>(measured, intrinsics, problemId);  // PinholeRadialK3, EquiDistantRadialK3
+    case 8:  return new CostProjection<8>(measured, intrinsics, problemId);  // PinholeFisheye, Pinhole3DEAnamorphic4
+    case 9:  return new CostProjection<9>(measured, intrinsics, problemId);  // PinholeBrownT2, Pinhole3DEClassicLD
+    case 10: return new CostProjection<10>(measured, intrinsics, problemId); // Pinhole3DERadial4
+    default: return new CostProjectionDynamic(measured, intrinsics, problemId);
+  }
+}
+
+/**
+ * @brief Pure rotation 2D constraint: the bearing of the first observation
+ *        rotated in the second view is projected on the second observation.
+ *  Parameter blocks: intrinsic(IntrinsicSize), pose of the first view(16), pose of the second view(16)
+ * @note The translations of the poses have no effect.
+ */
+template <int IntrinsicSize>
+class CostConstraint2D : public ceres::SizedCostFunction<2, IntrinsicSize, 16, 16> {
+public:
+  CostConstraint2D(const Vec2& observationFirst, const Vec2& observationSecond, const std::shared_ptr<camera::IntrinsicBase> & intrinsics, std::size_t problemId)
+    : _observationFirst(observationFirst), _observationSecond(observationSecond), _intrinsics(intrinsics), _problemId(problemId)
+  {
+  }
+
+  bool Evaluate(double const * const * parameters, double * residuals, double ** jacobians) const override
+  {
+    const double * parameter_intrinsics = parameters[0];
+    const double * parameter_pose_1 = parameters[1];
+    const double * parameter_pose_2 = parameters[2];
+
+    const Eigen::Map<const SE3::Matrix> oneTo(parameter_pose_1);
+    const Eigen::Map<const SE3::Matrix> twoTo(parameter_pose_2);
+
+    const camera::IntrinsicBase& threadIntrinsic = updateThreadIntrinsic(*_intrinsics, _problemId, parameter_intrinsics, IntrinsicSize);
+
+    // oTone = oneTo^-1
+    Eigen::Matrix4d oTone = Eigen::Matrix4d::Identity();
+    oTone.block<3, 3>(0, 0) = oneTo.block<3, 3>(0, 0).transpose();
+    oTone.block<3, 1>(0, 3) = - oTone.block<3, 3>(0, 0) * oneTo.block<3, 1>(0, 3);
+
+    const Eigen::Matrix4d twoTone = twoTo * oTone;
+    const geometry::Pose3 T_pose3(twoTone.block<3, 4>(0, 0));
+
+    // bearing of the first observation, as a point at infinity
+    Vec4 pth = Vec4::Zero();
+    pth.head<3>() = threadIntrinsic.toUnitSphere(threadIntrinsic.removeDistortion(threadIntrinsic.ima2cam(_observationFirst)));
+
+    const Vec2 pt_est = threadIntrinsic.project(T_pose3, pth, true);
+
+    residuals[0] = pt_est(0) - _observationSecond(0);
+    residuals[1] = pt_est(1) - _observationSecond(1);
+
+    if (jacobians == nullptr) {
+      return true;
+    }
+
+    if (jacobians[0] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 2, IntrinsicSize, Eigen::RowMajor>> J(jacobians[0]);
+
+      J = threadIntrinsic.getDerivativeProjectWrtParams(T_pose3, pth) + threadIntrinsic.getDerivativeProjectWrtPoint(T_pose3, pth).block<2, 3>(0, 0) * threadIntrinsic.getDerivativeBearingWrtParams(_observationFirst);
+    }
+
+    if (jacobians[1] != nullptr || jacobians[2] != nullptr) {
+      const Eigen::Matrix<double, 2, 16> d_res_d_T = threadIntrinsic.getDerivativeProjectWrtPose(T_pose3, pth);
+
+      if (jacobians[1] != nullptr) {
+        Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[1]);
+
+        // (A * oneTo)^-1 = oTone * A^-1, and d(A^-1) = -dA around identity
+        J = - d_res_d_T * getJacobian_AB_wrt_B<4, 4, 4>(twoTone, Eigen::Matrix4d::Identity());
+      }
+
+      if (jacobians[2] != nullptr) {
+        Eigen::Map<Eigen::Matrix<double, 2, 16, Eigen::RowMajor>> J(jacobians[2]);
+
+        J = d_res_d_T * getJacobian_AB_wrt_A<4, 4, 4>(Eigen::Matrix4d::Identity(), twoTone);
+      }
+    }
+
+    return true;
+  }
+
+private:
+  const Vec2 _observationFirst;
+  const Vec2 _observationSecond;
+  const std::shared_ptr<camera::IntrinsicBase> _intrinsics;
+  const std::size_t _problemId;
+};
+
+/**
+ * @brief Create the 2D constraint cost function of a pair of observations.
+ * @return nullptr if the intrinsic parameters size is not supported
+ */
+inline ceres::CostFunction* createCostConstraint2D(const Vec2& observationFirst, const Vec2& observationSecond, const std::shared_ptr<camera::IntrinsicBase> & intrinsics, std::size_t problemId)
+{
+  switch(intrinsics->getParams().size())
+  {
+    case 4:  return new CostConstraint2D<4>(observationFirst, observationSecond, intrinsics, problemId);
+    case 5:  return new CostConstraint2D<5>(observationFirst, observationSecond, intrinsics, problemId);
+    case 7:  return new CostConstraint2D<7>(observationFirst, observationSecond, intrinsics, problemId);
+    case 8:  return new CostConstraint2D<8>(observationFirst, observationSecond, intrinsics, problemId);
+    case 9:  return new CostConstraint2D<9>(observationFirst, observationSecond, intrinsics, problemId);
+    case 10: return new CostConstraint2D<10>(observationFirst, observationSecond, intrinsics, problemId);
+    default: return nullptr;
+  }
+}
+
+/**
+ * @brief Relative rotation prior between two poses, the residual is the angle axis error in degrees
+ *        (same residual as ResidualErrorRotationPriorFunctor).
+ *  Parameter blocks: pose of the first view(16), pose of the second view(16)
+ */
+class CostRotationPrior : public ceres::SizedCostFunction<3, 16, 16> {
+public:
+  explicit CostRotationPrior(const Eigen::Matrix3d & two_R_one)
+    : _two_R_one(two_R_one)
+  {
+  }
+
+  bool Evaluate(double const * const * parameters, double * residuals, double ** jacobians) const override
+  {
+    const Eigen::Map<const SE3::Matrix> oneTo(parameters[0]);
+    const Eigen::Map<const SE3::Matrix> twoTo(parameters[1]);
+
+    const Eigen::Matrix3d oneRo = oneTo.block<3, 3>(0, 0);
+    const Eigen::Matrix3d twoRo = twoTo.block<3, 3>(0, 0);
+    const Eigen::Matrix3d twoRone = twoRo * oneRo.transpose();
+    const Eigen::Matrix3d R_error = twoRone * _two_R_one.transpose();
+
+    const double radToDeg = 180.0 / M_PI;
+
+    Eigen::Map<Vec3> res(residuals);
+    res = radToDeg * SO3::logm(R_error);
+
+    if (jacobians == nullptr) {
+      return true;
+    }
+
+    // rotation part of a pose perturbation
+    Eigen::Matrix<double, 9, 16> d_R_d_T = Eigen::Matrix<double, 9, 16>::Zero();
+    for (int col = 0; col < 3; col++)
+    {
+      for (int row = 0; row < 3; row++)
+      {
+        d_R_d_T(col * 3 + row, col * 4 + row) = 1.0;
+      }
+    }
+
+    const Eigen::Matrix<double, 3, 9> d_res_d_R_error = radToDeg * SO3::dlogmdr(R_error);
+
+    if (jacobians[0] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 3, 16, Eigen::RowMajor>> J(jacobians[0]);
+
+      // R_error = twoRone * A^t * _two_R_one^t
+      const Eigen::Matrix3d two_R_one_t = _two_R_one.transpose();
+      J = d_res_d_R_error * getJacobian_AB_wrt_B<3, 3, 3>(twoRone, two_R_one_t) * getJacobian_AB_wrt_A<3, 3, 3>(Eigen::Matrix3d::Identity(), two_R_one_t) * getJacobian_At_wrt_A<3, 3>() * d_R_d_T;
+    }
+
+    if (jacobians[1] != nullptr) {
+      Eigen::Map<Eigen::Matrix<double, 3, 16, Eigen::RowMajor>> J(jacobians[1]);
+
+      // R_error = A * R_error
+      J = d_res_d_R_error * getJacobian_AB_wrt_A<3, 3, 3>(Eigen::Matrix3d::Identity(), R_error) * d_R_d_T;
+    }
+
+    return true;
+  }
+
+private:
+  Eigen::Matrix3d _two_R_one;
+};
+
+} // namespace sfm
+} // namespace aliceVision
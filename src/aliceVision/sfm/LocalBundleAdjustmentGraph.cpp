@@ -5,14 +5,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "LocalBundleAdjustmentGraph.hpp"
-#include <aliceVision/stl/stl.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <boost/filesystem.hpp>
 
-#include <lemon/bfs.h>
-
 #include <fstream>
 #include <algorithm>
+#include <deque>
 
 namespace fs = boost::filesystem;
 
@@ -47,6 +45,11 @@ std::map<int, std::size_t> LocalBundleAdjustmentGraph::getDistancesHistogram() c
     else
       histogram.at(x.second)++;
   }
+
+  // views not reached by the bounded BFS are not stored
+  if(!_distancePerViewId.empty() && _nodePerViewId.size() > _distancePerViewId.size())
+    histogram[-1] += _nodePerViewId.size() - _distancePerViewId.size();
+
   return histogram;
 }
 
@@ -137,7 +140,6 @@ void LocalBundleAdjustmentGraph::exportIntrinsicsHistory(const std::string& fold
 bool LocalBundleAdjustmentGraph::removeViews(const sfmData::SfMData& sfmData, const std::set<IndexT>& removedViewsId)
 {
   std::size_t numRemovedNode = 0;
-  std::map<IndexT, std::vector<int>> removedEdgesByIntrinsic;
 
   for(const IndexT& viewId : removedViewsId)
   {
@@ -148,74 +150,50 @@ bool LocalBundleAdjustmentGraph::removeViews(const sfmData::SfMData& sfmData, co
       continue;
     }
 
-    // keep track of node incident edges that are going to be removed
-    // in order to update _intrinsicEdgesId accordingly
-    { 
-      const IndexT intrinsicId = sfmData.getView(viewId).getIntrinsicId();
-      const auto intrinsicIt = _intrinsicEdgesId.find(intrinsicId);
-      if(intrinsicIt != _intrinsicEdgesId.end())
-      {
-        // store incident edge ids before removal
-        for(lemon::ListGraph::IncEdgeIt e(_graph, it->second); e != lemon::INVALID; ++e)
-        {
-          removedEdgesByIntrinsic[intrinsicId].push_back(_graph.id(lemon::ListGraph::Edge(e)));
-        }
-      }
+    const std::size_t nodeIndex = it->second;
+    Node& node = _nodes.at(nodeIndex);
+
+    // remove the incident edges from the neighbours adjacency
+    for(const Edge& edge : node.edges)
+    {
+      if(edge.node == nodeIndex)
+        continue;
+      std::vector<Edge>& neighbourEdges = _nodes.at(edge.node).edges;
+      neighbourEdges.erase(std::find_if(neighbourEdges.begin(), neighbourEdges.end(), [nodeIndex](const Edge& e){ return e.node == nodeIndex; }));
     }
-    
-    _graph.erase(it->second); // this function erase a node with its incident arcs
-    _viewIdPerNode.erase(it->second);
-    _nodePerViewId.erase(it->first); // warning: invalidates the iterator "it", so it can not be used after this line
+
+    // remove the intrinsic and rig links
+    if(node.intrinsicId != UndefinedIndexT)
+      removeNodeFromGroup(_nodesPerIntrinsicId, node.intrinsicId, nodeIndex);
+    if(node.rigId != UndefinedIndexT)
+      removeNodeFromGroup(_nodesPerRigId, node.rigId, nodeIndex);
+
+    node = Node();
+    _freeNodes.push_back(nodeIndex);
+    _nodePerViewId.erase(it); // warning: invalidates the iterator "it", so it can not be used after this line
 
     ++numRemovedNode;
     ALICEVISION_LOG_DEBUG("The view #" << viewId << " has been successfully removed to the distance graph.");
   }
-
-  // remove erased edges from _intrinsicsEdgesId
-  for(auto& edgesIt : removedEdgesByIntrinsic)
-  {
-    const IndexT intrinsicId =  edgesIt.first;
-    std::vector<int>& edgeIds = _intrinsicEdgesId[intrinsicId];
-    std::vector<int>& removedEdges = edgesIt.second;
-
-    std::vector<int> newEdgeIds;
-    // sort before using set_difference
-    std::sort(edgeIds.begin(), edgeIds.end());
-    std::sort(removedEdges.begin(), removedEdges.end());
-
-    std::set_difference(
-      edgeIds.begin(), edgeIds.end(), 
-      removedEdges.begin(), removedEdges.end(), 
-      std::back_inserter(newEdgeIds)
-    );
-    std::swap(edgeIds, newEdgeIds);
-
-    if(edgeIds.empty())
-    {
-      _intrinsicEdgesId.erase(intrinsicId);
-    }
-  }
   return numRemovedNode == removedViewsId.size();
 }
 
 int LocalBundleAdjustmentGraph::getPoseDistance(const IndexT poseId) const
 {
-  if(_distancePerPoseId.find(poseId) == _distancePerPoseId.end())
-  {
-    ALICEVISION_LOG_DEBUG("The pose #" << poseId << " does not exist in the '_mapDistancePerPoseId' (map size: " << _distancePerPoseId.size() << ") \n");
+  // not reached by the bounded BFS
+  const auto it = _distancePerPoseId.find(poseId);
+  if(it == _distancePerPoseId.end())
     return -1;
-  }
-  return _distancePerPoseId.at(poseId);
+  return it->second;
 }
 
 int LocalBundleAdjustmentGraph::getViewDistance(const IndexT viewId) const
 {
-  if(_distancePerViewId.find(viewId) == _distancePerViewId.end())
-  {
-    ALICEVISION_LOG_DEBUG("Cannot get the graph-distance of the view #" << viewId << ": does not exist in the '_mapDistancePerViewId':\n");
+  // not reached by the bounded BFS
+  const auto it = _distancePerViewId.find(viewId);
+  if(it == _distancePerViewId.end())
     return -1;
-  }
-  return _distancePerViewId.at(viewId);
+  return it->second;
 }
 
 BundleAdjustment::EParameterState LocalBundleAdjustmentGraph::getStateFromDistance(int distance) const
@@ -247,7 +225,7 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
   // identify the views we need to add to the graph:
   std::set<IndexT> addedViewsId;
   
-  if(_graph.maxNodeId() + 1 == 0) // the graph is empty: add all the poses of the scene
+  if(_nodePerViewId.empty()) // the graph is empty: add all the poses of the scene
   {
     ALICEVISION_LOG_DEBUG("The graph is empty: initial pair & new view(s) added.");
     for(const auto & x : sfmData.getViews())
@@ -278,9 +256,18 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
       continue;
     }
      
-    lemon::ListGraph::Node newNode = _graph.addNode();
+    std::size_t newNode = _nodes.size();
+    if(_freeNodes.empty())
+    {
+      _nodes.emplace_back();
+    }
+    else
+    {
+      newNode = _freeNodes.back();
+      _freeNodes.pop_back();
+    }
+    _nodes.at(newNode).viewId = viewId;
     _nodePerViewId[viewId] = newNode;
-    _viewIdPerNode[newNode] = viewId;
     ++nbAddedNodes;
   }
 
@@ -295,13 +282,13 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
     numAddedEdges = newEdges.size();
 
     for(const Pair& edge: newEdges)
-      _graph.addEdge(_nodePerViewId.at(edge.first), _nodePerViewId.at(edge.second));
+      addEdge(_nodePerViewId.at(edge.first), _nodePerViewId.at(edge.second));
 
     numAddedEdges += addIntrinsicEdgesToTheGraph(sfmData, addedViewsId);
   }
   
   ALICEVISION_LOG_DEBUG("The distances graph has been completed with " << nbAddedNodes<< " nodes & " << numAddedEdges << " edges.");
-  ALICEVISION_LOG_DEBUG("It contains " << _graph.maxNodeId() + 1 << " nodes & " << _graph.maxEdgeId() + 1 << " edges");
+  ALICEVISION_LOG_DEBUG("It contains " << countNodes() << " nodes & " << countEdges() << " edges");
 }
 
 void LocalBundleAdjustmentGraph::computeGraphDistances(const sfmData::SfMData& sfmData, const std::set<IndexT>& newReconstructedViews)
@@ -312,36 +299,56 @@ void LocalBundleAdjustmentGraph::computeGraphDistances(const sfmData::SfMData& s
   _distancePerViewId.clear();
   _distancePerPoseId.clear();
   
-  // setup Breadth First Search using Lemon
-  lemon::Bfs<lemon::ListGraph> bfs(_graph);
-  bfs.init();
-  
-  // add source views for the bfs visit of the _graph
+  // Breadth First Search bounded to the first non-refined distance (D+1),
+  // farther views are ignored as the not connected ones.
+  const int maxDistance = static_cast<int>(_graphDistanceLimit) + 1;
+  std::vector<int> distancePerNode(_nodes.size(), -1);
+  std::deque<std::size_t> queue;
+  std::set<IndexT> visitedIntrinsics;
+  std::set<IndexT> visitedRigs;
+
+  const auto visit = [&](std::size_t node, int distance)
+  {
+    if(distancePerNode[node] != -1)
+      return;
+    distancePerNode[node] = distance;
+    _distancePerViewId[_nodes[node].viewId] = distance;
+    if(distance < maxDistance)
+      queue.push_back(node);
+  };
+
+  // add source views for the bfs visit of the graph
   for(const IndexT viewId: newReconstructedViews)
   {
     auto it = _nodePerViewId.find(viewId);
     if(it == _nodePerViewId.end())
       ALICEVISION_LOG_WARNING("The reconstructed view #" << viewId << " cannot be added as source for the BFS: does not exist in the graph.");
     else
-      bfs.addSource(it->second);
+      visit(it->second, 0);
   }
-  bfs.start();
-  
-  // handle bfs results (distances)
-  for(const auto& x : _nodePerViewId) // each node in the graph
+
+  while(!queue.empty())
   {
-    auto& node = x.second;
-    int d = -1; 
-    
-    if(bfs.reached(node))
+    const Node& node = _nodes[queue.front()];
+    const int neighbourDistance = distancePerNode[queue.front()] + 1;
+    queue.pop_front();
+
+    for(const Edge& edge : node.edges)
+      visit(edge.node, neighbourDistance);
+
+    // intrinsic and rig links: each group is visited once from its closest node
+    if(node.intrinsicId != UndefinedIndexT && visitedIntrinsics.insert(node.intrinsicId).second)
     {
-      d = bfs.dist(node);
-      // dist(): "If node v is not reached from the root(s), then the return value of this function is undefined."
-      // this is why the distance is previously set to -1.
+      for(const std::size_t neighbour : _nodesPerIntrinsicId.at(node.intrinsicId))
+        visit(neighbour, neighbourDistance);
+    }
+    if(node.rigId != UndefinedIndexT && visitedRigs.insert(node.rigId).second)
+    {
+      for(const std::size_t neighbour : _nodesPerRigId.at(node.rigId))
+        visit(neighbour, neighbourDistance);
     }
-    _distancePerViewId[x.first] = d;
   }
-  
+
   // re-mapping from <ViewId, distance> to <PoseId, distance>:
   for(auto x: _distancePerViewId)
   {
@@ -441,33 +448,24 @@ std::vector<Pair> LocalBundleAdjustmentGraph::getNewEdges(
     const std::size_t minNbOfEdgesPerView)
 {
   std::vector<Pair> newEdges;
-  
-  // get landmarks id. of all the reconstructed 3D points (: landmarks)
-  // TODO: avoid copy and use boost::transform_iterator
-  std::set<IndexT> landmarkIds;
-  std::transform(sfmData.getLandmarks().begin(), sfmData.getLandmarks().end(),
-                 std::inserter(landmarkIds, landmarkIds.begin()),
-                 stl::RetrieveKey());
-  
+  const sfmData::Landmarks& landmarks = sfmData.getLandmarks();
+
   for(IndexT viewId: newViewsId)
   {
     std::map<IndexT, std::size_t> sharedLandmarksPerView;
 
     // get all the tracks of the new added view
     const aliceVision::track::TrackIdSet& newViewTrackIds = tracksPerView.at(viewId);
-    
-    // keep the reconstructed tracks (with an associated landmark)
-    std::vector<IndexT> newViewLandmarks; // all landmarks (already reconstructed) visible from the new view
-    
-    newViewLandmarks.reserve(newViewTrackIds.size());
-    std::set_intersection(newViewTrackIds.begin(), newViewTrackIds.end(),
-                          landmarkIds.begin(), landmarkIds.end(),
-                          std::back_inserter(newViewLandmarks));
-    
+
     // retrieve the common track Ids
-    for(IndexT landmarkId: newViewLandmarks)
+    // keep the reconstructed tracks (with an associated landmark) visible from the new view
+    for(IndexT trackId: newViewTrackIds)
     {
-      for(const auto& observations: sfmData.getLandmarks().at(landmarkId).observations)
+      const auto landmarkIt = landmarks.find(trackId);
+      if(landmarkIt == landmarks.end())
+        continue;
+
+      for(const auto& observations: landmarkIt->second.observations)
       {
         if(observations.first == viewId)
           continue; // do not compare an observation with itself
@@ -606,37 +604,51 @@ void LocalBundleAdjustmentGraph::drawGraph(const sfmData::SfMData& sfmData, cons
     fs::create_directory(folder);
   
   std::stringstream dotStream;
-  dotStream << "digraph lemon_dot_example {" << "\n";
+  dotStream << "digraph local_ba_graph {" << "\n";
   
   // node
   dotStream << "  node [ shape=ellipse, penwidth=5.0, fontname=Helvetica, fontsize=40 ];" << "\n";
-  for(lemon::ListGraph::NodeIt n(_graph); n!=lemon::INVALID; ++n)
+  for(const auto& viewNode : _nodePerViewId)
   {
-    const IndexT viewId = _viewIdPerNode[n];
-    const int viewDist = _distancePerViewId[viewId];
+    const IndexT viewId = viewNode.first;
+    const int viewDist = getViewDistance(viewId);
     
     std::string color = ", color=";
     if(viewDist == 0) color += "red";
     else if(viewDist == 1 ) color += "green";
     else if(viewDist == 2 ) color += "blue";
     else color += "black";
-    dotStream << "  n" << _graph.id(n)
+    dotStream << "  n" << viewNode.second
               << " [ label=\"" << viewId << ": D" << viewDist << " K" << sfmData.getViews().at(viewId)->getIntrinsicId() << "\"" << color << "]; " << "\n";
   }
   
   // edge
   dotStream << "  edge [ shape=ellipse, fontname=Helvetica, fontsize=5, color=black ];" << "\n";
-  for(lemon::ListGraph::EdgeIt e(_graph); e!=lemon::INVALID; ++e)
+  for(std::size_t n = 0; n < _nodes.size(); ++n)
   {
-    dotStream << "  n" << _graph.id(_graph.u(e)) << " -> " << " n" << _graph.id(_graph.v(e));
-    if(_intrinsicEdgesId.find(static_cast<IndexT>(_graph.id(e))) != _intrinsicEdgesId.end())
-      dotStream << " [color=red]\n";
-    else
-      dotStream << "\n";
+    for(const Edge& edge : _nodes[n].edges)
+    {
+      if(edge.node < n)
+        continue;
+      for(std::size_t i = 0; i < edge.nbEdges; ++i)
+        dotStream << "  n" << n << " -> " << " n" << edge.node << "\n";
+    }
   }
+  const auto drawGroups = [&dotStream](const std::map<IndexT, std::vector<std::size_t>>& nodesPerGroup, const std::string& edgeStyle)
+  {
+    for(const auto& group : nodesPerGroup)
+    {
+      const std::vector<std::size_t>& nodes = group.second;
+      for(std::size_t i = 0; i < nodes.size(); ++i)
+        for(std::size_t j = i + 1; j < nodes.size(); ++j)
+          dotStream << "  n" << nodes[i] << " -> " << " n" << nodes[j] << edgeStyle << "\n";
+    }
+  };
+  drawGroups(_nodesPerIntrinsicId, " [color=red]");
+  drawGroups(_nodesPerRigId, "");
   dotStream << "}" << "\n";
   
-  const std::string dotFilepath = (fs::path(folder) / ("graph_" + std::to_string(_viewIdPerNode.size())  + "_" + nameComplement + ".dot")).string();
+  const std::string dotFilepath = (fs::path(folder) / ("graph_" + std::to_string(_nodePerViewId.size())  + "_" + nameComplement + ".dot")).string();
   std::ofstream dotFile;
   dotFile.open(dotFilepath);
   dotFile.write(dotStream.str().c_str(), dotStream.str().length());
@@ -647,101 +659,94 @@ void LocalBundleAdjustmentGraph::drawGraph(const sfmData::SfMData& sfmData, cons
 
 std::size_t LocalBundleAdjustmentGraph::addIntrinsicEdgesToTheGraph(const sfmData::SfMData& sfmData, const std::set<IndexT>& newReconstructedViews)
 {
-  std::map<Pair, IndexT> newIntrinsicEdges;
+  std::size_t numAddedEdges = 0;
 
   for(IndexT newViewId : newReconstructedViews) // for each new view
   {
-    IndexT newViewIntrinsicId = sfmData.getViews().at(newViewId)->getIntrinsicId();
+    const auto nodeIt = _nodePerViewId.find(newViewId);
+    if(nodeIt == _nodePerViewId.end())
+      continue;
+
+    Node& node = _nodes.at(nodeIt->second);
+    const IndexT newViewIntrinsicId = sfmData.getViews().at(newViewId)->getIntrinsicId();
     
     if(isFocalLengthConstant(newViewIntrinsicId)) // do not add edges for a constant intrinsic
       continue;
 
-    // for each reconstructed view in the graph
-    // warning: at this point, "_nodePerViewId" already contains the "newReconstructedViews"
-    for(const auto& x : _nodePerViewId)
-    {
-      const auto& otherViewId = x.first;
-
-      // if the new view share the same intrinsic than previously reconstructed views
-      // note: do not compare a view with itself (must be tested since "_nodePerViewId" contains "newReconstructedViews")
-      if(newViewId != otherViewId
-         && newViewIntrinsicId == sfmData.getViews().at(otherViewId)->getIntrinsicId())
-      {
-        // register a new intrinsic edge between those views
-        newIntrinsicEdges[std::minmax(otherViewId, newViewId)] = newViewIntrinsicId;
-      }
-    }
-  }
+    if(node.intrinsicId != UndefinedIndexT) // already linked
+      continue;
 
-  // create registered intrinsic edges in lemon graph 
-  // and update _intrinsicEdgesId accordingly
-  for(const auto& newEdge : newIntrinsicEdges)
-  {
-    const lemon::ListGraph::Edge edge = _graph.addEdge(_nodePerViewId[newEdge.first.first], _nodePerViewId[newEdge.first.second]);
-    _intrinsicEdgesId[newEdge.second].push_back(_graph.id(edge));
+    // the new view is linked to all the reconstructed views sharing the same intrinsic
+    std::vector<std::size_t>& intrinsicNodes = _nodesPerIntrinsicId[newViewIntrinsicId];
+    numAddedEdges += intrinsicNodes.size();
+    intrinsicNodes.push_back(nodeIt->second);
+    node.intrinsicId = newViewIntrinsicId;
   }
-  return newIntrinsicEdges.size();
+  return numAddedEdges;
 }
 
 void LocalBundleAdjustmentGraph::removeIntrinsicEdgesFromTheGraph(IndexT intrinsicId)
 {
-  if(_intrinsicEdgesId.count(intrinsicId) == 0)
+  const auto it = _nodesPerIntrinsicId.find(intrinsicId);
+  if(it == _nodesPerIntrinsicId.end())
     return;
-  for(const int edgeId : _intrinsicEdgesId.at(intrinsicId))
+  for(const std::size_t node : it->second)
+    _nodes.at(node).intrinsicId = UndefinedIndexT;
+  _nodesPerIntrinsicId.erase(it);
+}
+
+void LocalBundleAdjustmentGraph::addEdge(std::size_t nodeA, std::size_t nodeB)
+{
+  const auto incrementEdge = [this](std::size_t from, std::size_t to)
   {
-    const auto& edge = _graph.edgeFromId(edgeId);
-    assert(_graph.valid(edge));
-    _graph.erase(edge);
-  }
-  _intrinsicEdgesId.erase(intrinsicId);
+    std::vector<Edge>& edges = _nodes.at(from).edges;
+    auto it = std::find_if(edges.begin(), edges.end(), [to](const Edge& e){ return e.node == to; });
+    if(it == edges.end())
+      edges.push_back({to, 1});
+    else
+      ++it->nbEdges;
+  };
+
+  incrementEdge(nodeA, nodeB);
+  if(nodeA != nodeB)
+    incrementEdge(nodeB, nodeA);
 }
 
+void LocalBundleAdjustmentGraph::removeNodeFromGroup(std::map<IndexT, std::vector<std::size_t>>& nodesPerGroup, IndexT groupId, std::size_t node)
+{
+  auto groupIt = nodesPerGroup.find(groupId);
+  assert(groupIt != nodesPerGroup.end());
+  std::vector<std::size_t>& nodes = groupIt->second;
+  nodes.erase(std::find(nodes.begin(), nodes.end(), node));
+  if(nodes.empty())
+    nodesPerGroup.erase(groupIt);
+}
 
 std::size_t LocalBundleAdjustmentGraph::updateRigEdgesToTheGraph(const sfmData::SfMData& sfmData)
 {
   std::size_t numAddedEdges = 0;
 
   // remove all rig edges
-  for(auto& edgesPerRid: _rigEdgesId)
+  for(const auto& nodesPerRig : _nodesPerRigId)
   {
-    for(const int edgeId : edgesPerRid.second)
-    {
-      const auto& edge = _graph.edgeFromId(edgeId);
-      assert(_graph.valid(edge));
-      _graph.erase(edge);
-    }
+    for(const std::size_t node : nodesPerRig.second)
+      _nodes.at(node).rigId = UndefinedIndexT;
   }
-  _rigEdgesId.clear();
+  _nodesPerRigId.clear();
 
   // recreate rig edges
-  std::map<IndexT, std::vector<IndexT>> viewIdsPerRig;
-
   for(const auto& viewNode : _nodePerViewId) // for each reconstructed view in the graph
   {
     const sfmData::View& view = sfmData.getView(viewNode.first);
     if(view.isPoseIndependant())
       continue;
-    viewIdsPerRig[view.getRigId()].push_back(viewNode.first);
-  }
 
-  for(auto& it : viewIdsPerRig)
-    std::sort(it.second.begin(), it.second.end());
-
-  for(const auto& it : viewIdsPerRig)
-  {
     // if(sfmData.getRig(rigId).isLocked()) // TODO
     //   continue;
-    const IndexT rigId = it.first;
-    const std::vector<IndexT>& views = it.second;
-    for(int i = 0; i < views.size(); ++i)
-    {
-      for(int j = i; j < views.size(); ++j)
-      {
-        lemon::ListGraph::Edge edge = _graph.addEdge(_nodePerViewId[views[i]], _nodePerViewId[views[j]]);
-        _rigEdgesId[rigId].push_back(_graph.id(edge));
-        numAddedEdges++;
-      }
-    }
+    std::vector<std::size_t>& rigNodes = _nodesPerRigId[view.getRigId()];
+    numAddedEdges += rigNodes.size();
+    rigNodes.push_back(viewNode.second);
+    _nodes.at(viewNode.second).rigId = view.getRigId();
   }
 
   return numAddedEdges;
@@ -749,18 +754,26 @@ std::size_t LocalBundleAdjustmentGraph::updateRigEdgesToTheGraph(const sfmData::
 
 unsigned int LocalBundleAdjustmentGraph::countNodes() const
 {
-  unsigned int count = 0;
-  for(lemon::ListGraph::NodeIt n(_graph); n != lemon::INVALID; ++n)
-    ++count;
-  return count;
+  return static_cast<unsigned int>(_nodePerViewId.size());
 }
 
 unsigned int LocalBundleAdjustmentGraph::countEdges() const
 {
-  unsigned int count = 0;
-  for(lemon::ListGraph::EdgeIt e(_graph); e != lemon::INVALID; ++e)
-    ++count;
-  return count;
+  std::size_t count = 0;
+  for(std::size_t n = 0; n < _nodes.size(); ++n)
+  {
+    for(const Edge& edge : _nodes[n].edges)
+    {
+      if(edge.node >= n) // each edge is stored in both nodes
+        count += edge.nbEdges;
+    }
+  }
+  // intrinsic and rig links: one edge per pair of nodes
+  for(const auto& group : _nodesPerIntrinsicId)
+    count += group.second.size() * (group.second.size() - 1) / 2;
+  for(const auto& group : _nodesPerRigId)
+    count += group.second.size() * (group.second.size() - 1) / 2;
+  return static_cast<unsigned int>(count);
 }
 
 } // namespace sfm
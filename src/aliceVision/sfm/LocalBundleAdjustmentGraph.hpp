@@ -10,8 +10,9 @@
 #include <aliceVision/track/TracksBuilder.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
 
-#include <lemon/list_graph.h>
-
+#include <map>
+#include <set>
+#include <vector>
 
 namespace aliceVision {
 
@@ -34,6 +35,7 @@ public:
 
   /**
    * @brief Return the number of posed views for each graph-distance
+   * @note Views farther than the graph-distance limit + 1 are counted as not connected (-1).
    * @return map<distance, numViews>
    */
   std::map<int, std::size_t> getDistancesHistogram() const;
@@ -170,7 +172,8 @@ public:
   
   /**
    * @brief Compute the intragraph-distance between all the nodes of the graph (posed views) and the newly resected views.
-   * @details The graph-distances are computed using a Breadth-first Search (BFS) method.
+   * @details The graph-distances are computed using a Breadth-first Search (BFS) method,
+   *          bounded to the graph-distance limit + 1: farther views are ignored as the not connected ones.
    * @param[in] sfmData contains all the information about the reconstruction, notably the posed views
    * @param[in] newReconstructedViews The list of the newly resected views used (used as source in the BFS algorithm)
    */
@@ -207,13 +210,15 @@ public:
   std::size_t updateRigEdgesToTheGraph(const sfmData::SfMData& sfmData);
 
   /**
-   * @brief Count and return the number of nodes in the underlying lemon graph.
+   * @brief Count and return the number of nodes in the graph.
    * @return The number of nodes in the graph.
    */
   unsigned int countNodes() const;
 
   /**
-   * @brief Count and return the number of edges in the underlying lemon graph.
+   * @brief Count and return the number of edges in the graph.
+   * @details Parallel edges are counted separately,
+   *          intrinsic and rig links count as one edge per pair of views.
    * @return The number of edges in the graph.
    */
   unsigned int countEdges() const;
@@ -312,21 +317,63 @@ private:
    */
   void removeIntrinsicEdgesFromTheGraph(IndexT intrinsicId);
 
+  /**
+   * @brief Add an edge between two nodes, or increment the number of edges if they are already connected.
+   * @param[in] nodeA The first node index
+   * @param[in] nodeB The second node index
+   */
+  void addEdge(std::size_t nodeA, std::size_t nodeB);
+
+  /**
+   * @brief Remove a node index from a group of nodes (intrinsic or rig links).
+   * @param[in,out] nodesPerGroup The nodes of each group
+   * @param[in] groupId The group of the node
+   * @param[in] node The node index
+   */
+  static void removeNodeFromGroup(std::map<IndexT, std::vector<std::size_t>>& nodesPerGroup, IndexT groupId, std::size_t node);
+
+  /// An edge to a neighbour node
+  struct Edge
+  {
+    /// neighbour node index
+    std::size_t node;
+    /// number of parallel edges to the neighbour node
+    std::size_t nbEdges;
+  };
+
+  /// A node of the graph: a posed view
+  struct Node
+  {
+    /// view index (UndefinedIndexT: unused node)
+    IndexT viewId = UndefinedIndexT;
+    /// intrinsic index if the node has intrinsic links (UndefinedIndexT otherwise)
+    IndexT intrinsicId = UndefinedIndexT;
+    /// rig index if the node has rig links (UndefinedIndexT otherwise)
+    IndexT rigId = UndefinedIndexT;
+    /// edges to the views sharing enough landmarks
+    std::vector<Edge> edges;
+  };
+
   // Distances data
   // - Local BA needs to know the distance of all the old posed views to the new resected views.
   // - The bundle adjustment will be processed on the closest poses only.
 
-  /// A graph where nodes are poses and an edge exists when 2 poses shared at least 'kMinNbOfMatches' matches.
-  lemon::ListGraph _graph; 
+  /**
+   * @brief A graph where nodes are posed views and an edge exists when 2 views shared at least 'kMinNbOfMatches' matches.
+   * @details Nodes are stored in a dense array and reused after removal.
+   *          Views sharing a same intrinsic (not considered as Constant) or a same rig are all linked to each other,
+   *          these links are stored as groups of nodes instead of a clique of edges.
+   */
+  std::vector<Node> _nodes;
+  /// Unused nodes indexes
+  std::vector<std::size_t> _freeNodes;
   /// The graph-distance limit setting the Active region (default value: 1)
   std::size_t _graphDistanceLimit = 1;
   /// Associates each view (indexed by its viewId) to its corresponding node in the graph.
-  std::map<IndexT, lemon::ListGraph::Node> _nodePerViewId;
-  /// Associates each node (in the graph) to its corresponding view.
-  std::map<lemon::ListGraph::Node, IndexT> _viewIdPerNode;
-  /// Store the graph-distances from the new views (0: is a new view, -1: is not connected to the new views)
+  std::map<IndexT, std::size_t> _nodePerViewId;
+  /// Store the graph-distances from the new views (0: is a new view, not stored: is not connected to the new views)
   std::map<IndexT, int> _distancePerViewId;
-  /// Store the graph-distances from the new poses (0: is a new pose, -1: is not connected to the new poses)
+  /// Store the graph-distances from the new poses (0: is a new pose, not stored: is not connected to the new poses)
   std::map<IndexT, int> _distancePerPoseId;
   /// Store the \c EParameterState of each pose in the scene.
   std::map<IndexT, BundleAdjustment::EParameterState> _statePerPoseId;
@@ -368,16 +415,16 @@ private:
   std::map<IndexT, bool> _mapFocalIsConstant;
 
   /**
-   * @brief Store the Lemon index of the edges added for the intrinsic links "the intrinsic-edges"
-   * <IntrinsicId, [edgeId]>
+   * @brief Store the nodes linked by the intrinsic links "the intrinsic-edges"
+   * <IntrinsicId, [node]>
    */
-  std::map<IndexT, std::vector<int>> _intrinsicEdgesId;
+  std::map<IndexT, std::vector<std::size_t>> _nodesPerIntrinsicId;
 
   /**
-   * @brief Store the Lemon index of the edges added for the rig links "the intrinsic-edges"
-   * <rigId, [edgeId]>
+   * @brief Store the nodes linked by the rig links "the rig-edges"
+   * <rigId, [node]>
    */
-  std::map<IndexT, std::vector<int>> _rigEdgesId;
+  std::map<IndexT, std::vector<std::size_t>> _nodesPerRigId;
 };
 
 } // namespace sfm
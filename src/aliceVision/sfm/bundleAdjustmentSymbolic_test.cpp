@@ -0,0 +1,295 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/BundleAdjustmentSymbolicCeres.hpp>
+#include <aliceVision/sfm/BundleAdjustmentSymbolicCostFunctions.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE bundleAdjustmentSymbolic
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+namespace {
+
+const std::vector<EINTRINSIC> intrinsicTypes = {
+  EINTRINSIC::PINHOLE_CAMERA,
+  EINTRINSIC::PINHOLE_CAMERA_RADIAL1,
+  EINTRINSIC::PINHOLE_CAMERA_RADIAL3,
+  EINTRINSIC::PINHOLE_CAMERA_BROWN,
+  EINTRINSIC::PINHOLE_CAMERA_FISHEYE,
+  EINTRINSIC::PINHOLE_CAMERA_FISHEYE1,
+  EINTRINSIC::PINHOLE_CAMERA_3DEANAMORPHIC4,
+  EINTRINSIC::PINHOLE_CAMERA_3DECLASSICLD,
+  EINTRINSIC::PINHOLE_CAMERA_3DERADIAL4,
+  EINTRINSIC::EQUIDISTANT_CAMERA,
+  EINTRINSIC::EQUIDISTANT_CAMERA_RADIAL3};
+
+/// an intrinsic with a small distortion
+std::shared_ptr<IntrinsicBase> makeIntrinsic(EINTRINSIC type)
+{
+  std::shared_ptr<IntrinsicBase> intrinsic = createIntrinsic(type, 1000, 800, 900.0, 950.0, 12.0, -7.0);
+  std::shared_ptr<IntrinsicsScaleOffsetDisto> intrinsicDisto = std::dynamic_pointer_cast<IntrinsicsScaleOffsetDisto>(intrinsic);
+  if(intrinsicDisto != nullptr)
+  {
+    std::vector<double> distortionParams = intrinsicDisto->getDistortionParams();
+    for(std::size_t i = 0; i < distortionParams.size(); ++i)
+      distortionParams[i] += 0.01 / (i + 1.0);
+    intrinsicDisto->setDistortionParams(distortionParams);
+  }
+  return intrinsic;
+}
+
+SE3::Matrix makePose(std::mt19937& generator, double maxAngle, double maxTranslation)
+{
+  std::uniform_real_distribution<double> angle(-maxAngle, maxAngle);
+  std::uniform_real_distribution<double> translation(-maxTranslation, maxTranslation);
+
+  SE3::Matrix T = SE3::Matrix::Identity();
+  T.block<3, 3>(0, 0) = SO3::expm(Vec3(angle(generator), angle(generator), angle(generator)));
+  T.block<3, 1>(0, 3) = Vec3(translation(generator), translation(generator), translation(generator));
+  return T;
+}
+
+/**
+ * @brief Compare the analytic jacobians of a cost function with central finite differences.
+ *        The pose blocks (16 parameters) are perturbed through SE3::LocalParameterization,
+ *        as in the bundle adjustment, the other blocks are perturbed directly.
+ */
+void checkJacobians(const ceres::CostFunction& cost, const std::vector<std::vector<double>>& parameters, const std::vector<bool>& isPose,
+                    double step = 1e-6)
+{
+  const int nbResiduals = cost.num_residuals();
+  const std::vector<int32_t>& blockSizes = cost.parameter_block_sizes();
+  BOOST_REQUIRE_EQUAL(blockSizes.size(), parameters.size());
+
+  const auto evaluate = [&](const std::vector<std::vector<double>>& blocks, Vec& residuals, std::vector<std::vector<double>>* jacobians)
+  {
+    std::vector<const double*> blockPtrs;
+    for(const auto& block : blocks)
+      blockPtrs.push_back(block.data());
+
+    std::vector<double*> jacobianPtrs;
+    if(jacobians != nullptr)
+    {
+      jacobians->resize(blocks.size());
+      for(std::size_t b = 0; b < blocks.size(); ++b)
+      {
+        (*jacobians)[b].assign(nbResiduals * blockSizes[b], 0.0);
+        jacobianPtrs.push_back((*jacobians)[b].data());
+      }
+    }
+
+    residuals.resize(nbResiduals);
+    return cost.Evaluate(blockPtrs.data(), residuals.data(), (jacobians != nullptr) ? jacobianPtrs.data() : nullptr);
+  };
+
+  Vec residuals;
+  std::vector<std::vector<double>> jacobians;
+  BOOST_REQUIRE(evaluate(parameters, residuals, &jacobians));
+
+  // the residuals do not depend on the jacobians evaluation
+  Vec residualsOnly;
+  BOOST_REQUIRE(evaluate(parameters, residualsOnly, nullptr));
+  BOOST_CHECK_SMALL((residuals - residualsOnly).norm(), 1e-12);
+
+  const SE3::LocalParameterization poseParameterization(true, true);
+
+  for(std::size_t b = 0; b < parameters.size(); ++b)
+  {
+    const Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> J(jacobians[b].data(), nbResiduals, blockSizes[b]);
+
+    Mat analytic;
+    if(isPose[b])
+    {
+      Eigen::Matrix<double, 16, 6, Eigen::RowMajor> JLocal;
+      poseParameterization.ComputeJacobian(parameters[b].data(), JLocal.data());
+      analytic = J * JLocal;
+    }
+    else
+    {
+      analytic = J;
+    }
+
+    Mat numeric(nbResiduals, analytic.cols());
+    for(Eigen::Index k = 0; k < analytic.cols(); ++k)
+    {
+      std::vector<std::vector<double>> plus = parameters;
+      std::vector<std::vector<double>> minus = parameters;
+      double h = step;
+
+      if(isPose[b])
+      {
+        Eigen::Matrix<double, 6, 1> delta = Eigen::Matrix<double, 6, 1>::Zero();
+        delta(k) = h;
+        poseParameterization.Plus(parameters[b].data(), delta.data(), plus[b].data());
+        delta(k) = -h;
+        poseParameterization.Plus(parameters[b].data(), delta.data(), minus[b].data());
+      }
+      else
+      {
+        h *= std::max(1.0, std::abs(parameters[b][k]));
+        plus[b][k] += h;
+        minus[b][k] -= h;
+      }
+
+      Vec residualsPlus, residualsMinus;
+      BOOST_REQUIRE(evaluate(plus, residualsPlus, nullptr));
+      BOOST_REQUIRE(evaluate(minus, residualsMinus, nullptr));
+      numeric.col(k) = (residualsPlus - residualsMinus) / (2.0 * h);
+    }
+
+    const double error = (analytic - numeric).norm();
+    BOOST_CHECK_MESSAGE(error <= 1e-4 * std::max(1.0, numeric.norm()),
+                        "Parameter block " << b << ": jacobian error " << error << "\nanalytic:\n" << analytic << "\nnumeric:\n" << numeric);
+  }
+}
+
+std::vector<double> toBlock(const SE3::Matrix& T)
+{
+  return std::vector<double>(T.data(), T.data() + 16);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(SymbolicCostProjection_Jacobians)
+{
+  std::mt19937 generator(42);
+  std::size_t problemId = 1;
+
+  for(EINTRINSIC type : intrinsicTypes)
+  {
+    BOOST_TEST_MESSAGE("Intrinsic: " << EINTRINSIC_enumToString(type));
+    const std::shared_ptr<IntrinsicBase> intrinsic = makeIntrinsic(type);
+
+    for(const double observationScale : {0.0, 2.0})
+    {
+      const SE3::Matrix rTo = makePose(generator, 0.5, 2.0);
+      const SE3::Matrix cTr = makePose(generator, 0.1, 0.2);
+
+      // a landmark in front of the camera, in the image
+      const SE3::Matrix cTo = cTr * rTo;
+      const Vec3 ptCamera(0.3, -0.2, 5.0);
+      const Vec3 pt = cTo.block<3, 3>(0, 0).transpose() * (ptCamera - cTo.block<3, 1>(0, 3));
+
+      const geometry::Pose3 pose(cTo.block<3, 4>(0, 0));
+      const Observation observation(intrinsic->project(pose, pt.homogeneous(), true) + Vec2(1.5, -0.5), 0, observationScale);
+
+      std::unique_ptr<ceres::CostFunction> cost(createCostProjection(observation, intrinsic, ++problemId));
+      checkJacobians(*cost, {toBlock(rTo), toBlock(cTr), intrinsic->getParams(), {pt(0), pt(1), pt(2)}}, {true, true, false, false});
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SymbolicCostConstraint2D_Jacobians)
+{
+  std::mt19937 generator(42);
+  std::size_t problemId = 1;
+
+  for(EINTRINSIC type : intrinsicTypes)
+  {
+    BOOST_TEST_MESSAGE("Intrinsic: " << EINTRINSIC_enumToString(type));
+    const std::shared_ptr<IntrinsicBase> intrinsic = makeIntrinsic(type);
+
+    const SE3::Matrix oneTo = makePose(generator, 0.5, 1.0);
+    const SE3::Matrix twoTo = makePose(generator, 0.1, 1.0) * oneTo;
+    // far from the center, so that the distortion parameters have a significant effect
+    const Vec2 observationFirst(850.0, 680.0);
+    const Vec2 observationSecond(820.0, 650.0);
+
+    // the residual goes through the iterative undistortion of the first observation,
+    // a larger step keeps the finite differences above the undistortion precision
+    std::unique_ptr<ceres::CostFunction> cost(createCostConstraint2D(observationFirst, observationSecond, intrinsic, ++problemId));
+    BOOST_REQUIRE(cost != nullptr);
+    checkJacobians(*cost, {intrinsic->getParams(), toBlock(oneTo), toBlock(twoTo)}, {false, true, true}, 1e-3);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(SymbolicCostRotationPrior_Jacobians)
+{
+  std::mt19937 generator(42);
+
+  for(int i = 0; i < 10; ++i)
+  {
+    const SE3::Matrix oneTo = makePose(generator, 1.0, 1.0);
+    const SE3::Matrix twoTo = makePose(generator, 1.0, 1.0);
+    const Mat3 two_R_one = SO3::expm(Vec3(0.2, -0.1, 0.3)) * twoTo.block<3, 3>(0, 0) * oneTo.block<3, 3>(0, 0).transpose();
+
+    const CostRotationPrior cost(two_R_one);
+    checkJacobians(cost, {toBlock(oneTo), toBlock(twoTo)}, {true, true});
+  }
+}
+
+// Test summary:
+// - Create a SfMData scene from a synthetic dataset, with noisy observations and landmarks
+// - Refine it with the autodiff and the analytic jacobians bundle adjustments
+// - Check that both reach the same solution
+BOOST_AUTO_TEST_CASE(BundleAdjustmentSymbolic_SameAsAutodiff)
+{
+  const int nviews = 6;
+  const int npoints = 64;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA_RADIAL3);
+
+  std::mt19937 generator(42);
+  std::normal_distribution<double> observationNoise(0.0, 0.5);
+  std::normal_distribution<double> landmarkNoise(0.0, 0.01);
+  for(auto& landmarkPair : sfmData.structure)
+  {
+    landmarkPair.second.X += Vec3(landmarkNoise(generator), landmarkNoise(generator), landmarkNoise(generator));
+    for(auto& observationPair : landmarkPair.second.observations)
+      observationPair.second.x += Vec2(observationNoise(generator), observationNoise(generator));
+  }
+
+  // the first pose is locked to fix the gauge of both problems
+  sfmData.getPoses().at(0).lock();
+
+  SfMData sfmDataAutodiff = sfmData;
+  SfMData sfmDataSymbolic = sfmData;
+
+  BundleAdjustmentCeres::CeresOptions autodiffOptions(false, false);
+  autodiffOptions.setDenseBA();
+  BundleAdjustmentCeres autodiffBA(autodiffOptions);
+  BOOST_CHECK(autodiffBA.adjust(sfmDataAutodiff, BundleAdjustment::REFINE_ALL));
+
+  BundleAdjustmentSymbolicCeres::CeresOptions symbolicOptions(false, false);
+  symbolicOptions.setDenseBA();
+  BundleAdjustmentSymbolicCeres symbolicBA(symbolicOptions);
+  BOOST_CHECK(symbolicBA.adjust(sfmDataSymbolic, BundleAdjustment::REFINE_ALL));
+
+  for(const auto& posePair : sfmDataAutodiff.getPoses())
+  {
+    const geometry::Pose3& autodiffPose = posePair.second.getTransform();
+    const geometry::Pose3& symbolicPose = sfmDataSymbolic.getPoses().at(posePair.first).getTransform();
+    BOOST_CHECK_SMALL((autodiffPose.center() - symbolicPose.center()).norm(), 1e-4);
+    BOOST_CHECK_SMALL((autodiffPose.rotation() - symbolicPose.rotation()).norm(), 1e-6);
+  }
+
+  for(const auto& landmarkPair : sfmDataAutodiff.getLandmarks())
+    BOOST_CHECK_SMALL((landmarkPair.second.X - sfmDataSymbolic.getLandmarks().at(landmarkPair.first).X).norm(), 1e-4);
+
+  const std::vector<double> autodiffParams = sfmDataAutodiff.getIntrinsics().at(0)->getParams();
+  const std::vector<double> symbolicParams = sfmDataSymbolic.getIntrinsics().at(0)->getParams();
+  BOOST_REQUIRE_EQUAL(autodiffParams.size(), symbolicParams.size());
+  for(std::size_t i = 0; i < autodiffParams.size(); ++i)
+    BOOST_CHECK_SMALL(autodiffParams[i] - symbolicParams[i], 1e-3 * std::max(1.0, std::abs(autodiffParams[i])));
+}
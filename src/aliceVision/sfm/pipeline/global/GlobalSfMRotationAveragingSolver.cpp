@@ -140,6 +140,29 @@ bool GlobalSfMRotationAveragingSolver::Run(
       }
     }
     break;
+    case ROTATION_AVERAGING_IRLS:
+    {
+      //- Solve the global rotation estimation problem:
+      //  sparse chordal initialization and robust refinement in the Lie algebra
+      const size_t nMainViewID = 0; //arbitrary choice
+      std::vector<bool> vec_inliers;
+      bSuccess = rotationAveraging::irls::GlobalRotationsIRLS(
+        relativeRotations, vec_globalR, nMainViewID, degreeToRadian(max_angular_error), &vec_inliers);
+
+      ALICEVISION_LOG_DEBUG("rotationAveraging::irls::GlobalRotationsIRLS: success: " << bSuccess);
+
+      // save kept pairs (restore original pose indices using the backward reindexing)
+      for (size_t i = 0; i < vec_inliers.size(); ++i)
+      {
+        if (vec_inliers[i])
+        {
+          used_pairs.insert(
+            Pair(_reindexBackward[relativeRotations[i].i],
+                 _reindexBackward[relativeRotations[i].j]));
+        }
+      }
+    }
+    break;
     default:
       ALICEVISION_LOG_DEBUG(
         "Unknown rotation averaging method: " << (int) eRotationAveragingMethod);
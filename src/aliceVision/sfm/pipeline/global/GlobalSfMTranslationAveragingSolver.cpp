@@ -12,6 +12,7 @@
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/sfm/pipeline/global/reindexGlobalSfM.hpp>
 #include <aliceVision/sfm/pipeline/global/MutexSet.hpp>
+#include <aliceVision/sfm/pipeline/global/WorkStealingQueue.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/multiview/translationAveraging/common.hpp>
 #include <aliceVision/multiview/translationAveraging/solver.hpp>
@@ -301,6 +302,42 @@ void GlobalSfMTranslationAveragingSolver::Compute_translations(const SfMData& sf
     tripletWise_matches);
 }
 
+namespace {
+
+/// Iterators on the matches of each pair of poses, the pairs of poses are ordered
+typedef std::map<Pair, std::vector<matching::PairwiseMatches::const_iterator> > MatchesPerPosePair;
+
+/// List the matches between the views of the three poses of a triplet
+void getTripletMatches(const MatchesPerPosePair & matchesPerPosePair,
+  const graph::Triplet & triplet,
+  matching::PairwiseMatches & tripletMatches)
+{
+  tripletMatches.clear();
+  for (const Pair & posePair : {Pair(triplet.i, triplet.j), Pair(triplet.i, triplet.k), Pair(triplet.j, triplet.k)})
+  {
+    const auto it = matchesPerPosePair.find(posePair);
+    if (it == matchesPerPosePair.end())
+      continue;
+    for (const auto & matchesIt : it->second)
+      tripletMatches.insert(*matchesIt);
+  }
+}
+
+/// Data reused by the successive triplet solves of a thread
+struct TripletSolverBuffers
+{
+  matching::PairwiseMatches tripletMatches;
+  aliceVision::track::TracksMap tracks;
+  std::vector<Vec3> vec_tis;
+  std::vector<size_t> vec_inliers;
+  std::mt19937 randomNumberGenerator;
+  // results of the thread
+  translationAveraging::RelativeInfoVec initialEstimates;
+  matching::PairwiseMatches newPairMatches;
+};
+
+} // namespace
+
 //-- Perform a trifocal estimation of the graph contained in vec_triplets with an
 // edge coverage algorithm. Its complexity is sub-linear in term of edges count.
 void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCoverage(const SfMData & sfmData,
@@ -312,6 +349,7 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
   matching::PairwiseMatches & newpairMatches)
 {
   aliceVision::system::Timer timerLP_triplet;
+  aliceVision::system::Timer timerStage;
 
   //--
   // Compute the relative translations using triplets of rotations over the rotation graph.
@@ -321,69 +359,62 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
   //   - list all edges that have support in the rotation pose graph
   //
   PairSet rotation_pose_id_graph;
-  std::set<IndexT> set_pose_ids;
-  std::transform(map_globalR.begin(), map_globalR.end(),
-    std::inserter(set_pose_ids, set_pose_ids.begin()), stl::RetrieveKey());
+  MatchesPerPosePair matchesPerPosePair;
   // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : pairwiseMatches)
+  for (auto match_iterator = pairwiseMatches.begin(); match_iterator != pairwiseMatches.end(); ++match_iterator)
   {
-    const Pair pair = match_iterator.first;
-    const View * v1 = sfmData.getViews().at(pair.first).get();
-    const View * v2 = sfmData.getViews().at(pair.second).get();
+    const Pair pair = match_iterator->first;
+    const IndexT poseId1 = sfmData.getViews().at(pair.first)->getPoseId();
+    const IndexT poseId2 = sfmData.getViews().at(pair.second)->getPoseId();
 
     if (// Consider the pair iff it is supported by the rotation graph
-        (v1->getPoseId() != v2->getPoseId())
-        && set_pose_ids.count(v1->getPoseId())
-        && set_pose_ids.count(v2->getPoseId()))
+        (poseId1 != poseId2)
+        && map_globalR.count(poseId1)
+        && map_globalR.count(poseId2))
     {
-      rotation_pose_id_graph.insert(
-        std::make_pair(v1->getPoseId(), v2->getPoseId()));
+      const Pair posePair(std::min(poseId1, poseId2), std::max(poseId1, poseId2));
+      rotation_pose_id_graph.insert(posePair);
+      matchesPerPosePair[posePair].push_back(match_iterator);
     }
   }
   // List putative triplets (from global rotations Ids)
   const std::vector< graph::Triplet > vec_triplets =
     graph::tripletListing(rotation_pose_id_graph);
-  ALICEVISION_LOG_DEBUG("#Triplets: " << vec_triplets.size());
-
+  const double timeTripletListing = timerStage.elapsed();
+  ALICEVISION_LOG_INFO("Relative translations: " << vec_triplets.size() << " triplets listed from "
+    << rotation_pose_id_graph.size() << " pairs of poses in " << timeTripletListing << " s.");
+
+  // set number of threads, 1 if openMP is not enabled
+  const int nbThreads = omp_get_max_threads();
+  std::vector<TripletSolverBuffers> buffers(nbThreads);
+  for (TripletSolverBuffers & threadBuffers : buffers)
+    threadBuffers.randomNumberGenerator.seed(randomNumberGenerator());
+
+  double timeTrackCounting = 0.0;
+  double timeTripletSolving = 0.0;
   {
     // Compute triplets of translations
     // Avoid to cover each edge of the graph by using an edge coverage algorithm
     // An estimated triplets of translation mark three edges as estimated.
 
     //-- precompute the number of track per triplet:
-    HashMap<IndexT, IndexT> map_tracksPerTriplets;
+    timerStage.reset();
+    std::vector<std::size_t> vec_tracksPerTriplet(vec_triplets.size(), 0);
 
     #pragma omp parallel for schedule(dynamic)
     for (int i = 0; i < (int)vec_triplets.size(); ++i)
     {
+      TripletSolverBuffers & threadBuffers = buffers[omp_get_thread_num()];
       // List matches that belong to the triplet of poses
-      const graph::Triplet & triplet = vec_triplets[i];
-      matching::PairwiseMatches map_triplet_matches;
-      const std::set<IndexT> set_triplet_pose_ids = {triplet.i, triplet.j, triplet.k};
-      // List shared correspondences (pairs) between the triplet poses
-      for (const auto & match_iterator : pairwiseMatches)
-      {
-        const Pair pair = match_iterator.first;
-        const View * v1 = sfmData.getViews().at(pair.first).get();
-        const View * v2 = sfmData.getViews().at(pair.second).get();
-        if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-            (v1->getPoseId() != v2->getPoseId())
-            && set_triplet_pose_ids.count(v1->getPoseId())
-            && set_triplet_pose_ids.count(v2->getPoseId()))
-        {
-          map_triplet_matches.insert( match_iterator );
-        }
-      }
+      getTripletMatches(matchesPerPosePair, vec_triplets[i], threadBuffers.tripletMatches);
       // Compute tracks:
-      {
-        aliceVision::track::TracksBuilder tracksBuilder;
-        tracksBuilder.build(map_triplet_matches);
-        tracksBuilder.filter(true,3);
-
-        #pragma omp critical
-        map_tracksPerTriplets[i] = tracksBuilder.nbTracks(); //count the # of matches in the UF tree
-      }
+      aliceVision::track::TracksBuilder tracksBuilder;
+      tracksBuilder.build(threadBuffers.tripletMatches);
+      tracksBuilder.filter(true,3);
+      vec_tracksPerTriplet[i] = tracksBuilder.nbTracks(); //count the # of matches in the UF tree
     }
+    timeTrackCounting = timerStage.elapsed();
+    ALICEVISION_LOG_INFO("Relative translations: tracks of " << vec_triplets.size() << " triplets counted in " << timeTrackCounting << " s.");
 
     typedef Pair myEdge;
 
@@ -398,9 +429,22 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
     }
 
     // Collect edges that are covered by the triplets
+    // (sorted by pose ids: neighbouring edges share poses and are given to the same thread)
     std::vector<myEdge > vec_edges;
     std::transform(map_tripletIds_perEdge.begin(), map_tripletIds_perEdge.end(), std::back_inserter(vec_edges), stl::RetrieveKey());
 
+    //-- Sort the triplets of each edge according the number of track they are supporting
+    #pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < (int)vec_edges.size(); ++k)
+    {
+      std::vector<size_t> & vec_possibleTripletIndexes = map_tripletIds_perEdge.at(vec_edges[k]);
+      std::stable_sort(vec_possibleTripletIndexes.begin(), vec_possibleTripletIndexes.end(),
+        [&vec_tracksPerTriplet](size_t a, size_t b)
+        {
+          return vec_tracksPerTriplet[a] > vec_tracksPerTriplet[b];
+        });
+    }
+
     aliceVision::sfm::MutexSet<myEdge> m_mutexSet;
 
     boost::progress_display my_progress_bar(
@@ -408,41 +452,31 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
       std::cout,
       "\nRelative translations computation (edge coverage algorithm)\n");
 
-    // set number of threads, 1 if openMP is not enabled  
-    std::vector<translationAveraging::RelativeInfoVec> initial_estimates(omp_get_max_threads());
-    const bool bVerbose = false;
+    // the threads start with contiguous ranges of edges and steal the remaining edges of the others
+    timerStage.reset();
+    WorkStealingQueue edgesQueue(vec_edges.size(), nbThreads);
+    std::size_t nbSolvedTriplets = 0;
+    std::size_t nbTriedTriplets = 0;
 
-    #pragma omp parallel for schedule(dynamic)
-    for (int k = 0; k < vec_edges.size(); ++k)
+    #pragma omp parallel reduction(+:nbSolvedTriplets, nbTriedTriplets)
     {
-      const myEdge & edge = vec_edges[k];
-      #pragma omp critical
-      {
-        ++my_progress_bar;
-      }
-      if (m_mutexSet.count(edge) == 0 && m_mutexSet.size() != vec_edges.size())
-      {
-        // Find the triplets that support the given edge
-        const auto & vec_possibleTripletIndexes = map_tripletIds_perEdge.at(edge);
+      const int thread_id = omp_get_thread_num();
+      TripletSolverBuffers & threadBuffers = buffers[thread_id];
+      std::size_t k = 0;
 
-        //-- Sort the triplets according the number of track they are supporting
-        std::vector<size_t> vec_commonTracksPerTriplets;
-        for (const size_t triplet_index : vec_possibleTripletIndexes)
+      while (edgesQueue.pop(thread_id, k))
+      {
+        const myEdge & edge = vec_edges[k];
+        #pragma omp critical
         {
-          vec_commonTracksPerTriplets.push_back(map_tracksPerTriplets[triplet_index]);
-        }
-
-        using namespace stl::indexed_sort;
-        std::vector< sort_index_packet_descend < size_t, size_t> > packet_vec(vec_commonTracksPerTriplets.size());
-        sort_index_helper(packet_vec, &vec_commonTracksPerTriplets[0]);
-
-        std::vector<size_t> vec_triplet_ordered(vec_commonTracksPerTriplets.size(), 0);
-        for (size_t i = 0; i < vec_commonTracksPerTriplets.size(); ++i) {
-          vec_triplet_ordered[i] = vec_possibleTripletIndexes[packet_vec[i].index];
+          ++my_progress_bar;
         }
+        if (m_mutexSet.count(edge) != 0 || m_mutexSet.size() == vec_edges.size())
+          continue;
 
-        // Try to solve a triplet of translations for the given edge
-        for (const size_t triplet_index : vec_triplet_ordered)
+        // Try to solve a triplet of translations for the given edge,
+        // the triplets that support the edge are sorted by decreasing number of tracks
+        for (const size_t triplet_index : map_tripletIds_perEdge.at(edge))
         {
           const graph::Triplet & triplet = vec_triplets[triplet_index];
 
@@ -459,26 +493,27 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
           //--
           double dPrecision = 4.0; // upper bound of the residual pixel reprojection error
 
-          std::vector<Vec3> vec_tis(3);
-          std::vector<size_t> vec_inliers;
-          aliceVision::track::TracksMap pose_triplet_tracks;
+          getTripletMatches(matchesPerPosePair, triplet, threadBuffers.tripletMatches);
 
           const std::string sOutDirectory = "./";
           const bool bTriplet_estimation = Estimate_T_triplet(
               sfmData,
               map_globalR,
               normalizedFeaturesPerView,
-              pairwiseMatches,
+              threadBuffers.tripletMatches,
               triplet,
-              randomNumberGenerator,
-              vec_tis,
+              threadBuffers.randomNumberGenerator,
+              threadBuffers.vec_tis,
               dPrecision,
-              vec_inliers,
-              pose_triplet_tracks,
+              threadBuffers.vec_inliers,
+              threadBuffers.tracks,
               sOutDirectory);
+          ++nbTriedTriplets;
 
           if (bTriplet_estimation)
           {
+            ++nbSolvedTriplets;
+
             // Since new translation edges have been computed, mark their corresponding edges as estimated
             m_mutexSet.insert(std::make_pair(triplet.i, triplet.j));
             m_mutexSet.insert(std::make_pair(triplet.j, triplet.k));
@@ -491,9 +526,9 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
                 RJ = map_globalR.at(triplet.j),
                 RK = map_globalR.at(triplet.k);
               const Vec3
-                ti = vec_tis[0],
-                tj = vec_tis[1],
-                tk = vec_tis[2];
+                ti = threadBuffers.vec_tis[0],
+                tj = threadBuffers.vec_tis[1],
+                tk = threadBuffers.vec_tis[2];
 
               Mat3 Rij;
               Vec3 tij;
@@ -507,50 +542,39 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
               Vec3 tik;
               relativeCameraMotion(RI, ti, RK, tk, &Rik, &tik);
 
-              // set number of threads, 1 if openMP is not enabled
-              const int thread_id = omp_get_thread_num();
-
-              initial_estimates[thread_id].emplace_back(
+              threadBuffers.initialEstimates.emplace_back(
                 std::make_pair(triplet.i, triplet.j), std::make_pair(Rij, tij));
-              initial_estimates[thread_id].emplace_back(
+              threadBuffers.initialEstimates.emplace_back(
                 std::make_pair(triplet.j, triplet.k), std::make_pair(Rjk, tjk));
-              initial_estimates[thread_id].emplace_back(
+              threadBuffers.initialEstimates.emplace_back(
                 std::make_pair(triplet.i, triplet.k), std::make_pair(Rik, tik));
 
-              //--- ATOMIC
-              #pragma omp critical
+              // Add inliers as valid pairwise matches
+              using namespace aliceVision::track;
+              std::vector<TracksMap::const_iterator> vec_tracksIt;
+              vec_tracksIt.reserve(threadBuffers.tracks.size());
+              for (TracksMap::const_iterator it_tracks = threadBuffers.tracks.begin(); it_tracks != threadBuffers.tracks.end(); ++it_tracks)
+                vec_tracksIt.push_back(it_tracks);
+
+              for (const size_t inlier : threadBuffers.vec_inliers)
               {
-                // Add inliers as valid pairwise matches
-                for (std::vector<size_t>::const_iterator iterInliers = vec_inliers.begin();
-                  iterInliers != vec_inliers.end(); ++iterInliers)
+                const Track & track = vec_tracksIt[inlier]->second;
+
+                // create pairwise matches from inlier track
+                for (Track::FeatureIdPerView::const_iterator iter_I = track.featPerView.begin(); iter_I != track.featPerView.end(); ++iter_I)
                 {
-                  using namespace aliceVision::track;
-                  TracksMap::iterator it_tracks = pose_triplet_tracks.begin();
-                  std::advance(it_tracks, *iterInliers);
-                  const Track & track = it_tracks->second;
+                  // extract camera indexes
+                  const size_t id_view_I = iter_I->first;
+                  const size_t id_feat_I = iter_I->second;
 
-                  // create pairwise matches from inlier track
-                  for (size_t index_I = 0; index_I < track.featPerView.size() ; ++index_I)
+                  // loop on subtracks
+                  for (Track::FeatureIdPerView::const_iterator iter_J = std::next(iter_I); iter_J != track.featPerView.end(); ++iter_J)
                   {
-                    Track::FeatureIdPerView::const_iterator iter_I = track.featPerView.begin();
-                    std::advance(iter_I, index_I);
-
                     // extract camera indexes
-                    const size_t id_view_I = iter_I->first;
-                    const size_t id_feat_I = iter_I->second;
-
-                    // loop on subtracks
-                    for (size_t index_J = index_I+1; index_J < track.featPerView.size() ; ++index_J)
-                    {
-                      Track::FeatureIdPerView::const_iterator iter_J = track.featPerView.begin();
-                      std::advance(iter_J, index_J);
+                    const size_t id_view_J = iter_J->first;
+                    const size_t id_feat_J = iter_J->second;
 
-                      // extract camera indexes
-                      const size_t id_view_J = iter_J->first;
-                      const size_t id_feat_J = iter_J->second;
-
-                      newpairMatches[std::make_pair(id_view_I, id_view_J)][track.descType].emplace_back(id_feat_I, id_feat_J);
-                    }
+                    threadBuffers.newPairMatches[std::make_pair(id_view_I, id_view_J)][track.descType].emplace_back(id_feat_I, id_feat_J);
                   }
                 }
               }
@@ -562,26 +586,37 @@ void GlobalSfMTranslationAveragingSolver::ComputePutativeTranslation_EdgesCovera
         }
       }
     }
+    timeTripletSolving = timerStage.elapsed();
+    ALICEVISION_LOG_INFO("Relative translations: " << nbSolvedTriplets << " / " << nbTriedTriplets
+      << " triplets solved to cover " << vec_edges.size() << " edges in " << timeTripletSolving << " s.");
+
     // Merge thread estimates
-    for(const auto vec : initial_estimates)
+    for (TripletSolverBuffers & threadBuffers : buffers)
     {
-      for(const auto val : vec)
+      vec_initialEstimates.insert(vec_initialEstimates.end(), threadBuffers.initialEstimates.begin(), threadBuffers.initialEstimates.end());
+
+      for (auto & matchesPerDesc : threadBuffers.newPairMatches)
       {
-        vec_initialEstimates.emplace_back(val);
+        for (auto & matches : matchesPerDesc.second)
+        {
+          matching::IndMatches & outMatches = newpairMatches[matchesPerDesc.first][matches.first];
+          outMatches.insert(outMatches.end(), matches.second.begin(), matches.second.end());
+        }
       }
     }
   }
 
-
   const double timeLP_triplet = timerLP_triplet.elapsed();
   ALICEVISION_LOG_DEBUG("TRIPLET COVERAGE TIMING: " << timeLP_triplet << " seconds");
 
-  ALICEVISION_LOG_DEBUG(
+  ALICEVISION_LOG_INFO(
       "-------------------------------\n"
-      "-- #Relative translations estimates: " << m_vec_initialRijTijEstimates.size()/3 <<
+      "-- #Relative translations estimates: " << vec_initialEstimates.size()/3 <<
       " computed from " << vec_triplets.size() << " triplets.\n"
-      "-- resulting in " << m_vec_initialRijTijEstimates.size() << " translations estimation.\n"
-      "-- timing to obtain the relative translations: " << timeLP_triplet << " seconds.\n"
+      "-- resulting in " << vec_initialEstimates.size() << " translations estimation.\n"
+      "-- timing to obtain the relative translations: " << timeLP_triplet << " seconds\n"
+      "   (triplet listing: " << timeTripletListing << " s, track counting: " << timeTrackCounting
+      << " s, triplet solving: " << timeTripletSolving << " s).\n"
       "-------------------------------");
 }
 
@@ -590,7 +625,7 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
   const SfMData& sfmData,
   const HashMap<IndexT, Mat3>& map_globalR,
   const feature::FeaturesPerView& normalizedFeaturesPerView,
-  const matching::PairwiseMatches& pairwiseMatches,
+  const matching::PairwiseMatches& tripletMatches,
   const graph::Triplet& poses_id,
   std::mt19937 & randomNumberGenerator,
   std::vector<Vec3>& vec_tis,
@@ -599,26 +634,8 @@ bool GlobalSfMTranslationAveragingSolver::Estimate_T_triplet(
   aliceVision::track::TracksMap& tracks,
   const std::string& outDirectory) const
 {
-  // List matches that belong to the triplet of poses
-  matching::PairwiseMatches map_triplet_matches;
-  const std::set<IndexT> set_pose_ids = {poses_id.i, poses_id.j, poses_id.k};
-  // List shared correspondences (pairs) between poses
-  for (const auto & match_iterator : pairwiseMatches)
-  {
-    const Pair& pair = match_iterator.first;
-    const View* v1 = sfmData.getViews().at(pair.first).get();
-    const View* v2 = sfmData.getViews().at(pair.second).get();
-    if (// Consider the pair iff it is supported by the triplet graph & 2 different pose id
-        (v1->getPoseId() != v2->getPoseId())
-        && set_pose_ids.count(v1->getPoseId())
-        && set_pose_ids.count(v2->getPoseId()))
-    {
-      map_triplet_matches.insert( match_iterator );
-    }
-  }
-
   aliceVision::track::TracksBuilder tracksBuilder;
-  tracksBuilder.build(map_triplet_matches);
+  tracksBuilder.build(tripletMatches);
   tracksBuilder.filter(true,3);
   tracksBuilder.exportToSTL(tracks);
 
@@ -94,6 +94,8 @@ private:
    * Compute relative translations by using triplets of poses.
    * Use an edge coverage algorithm to reduce the graph covering complexity
    * Complexity: sub-linear in term of edges count.
+   * The triplets are listed in parallel and solved by a work stealing scheduler,
+   * each thread reusing its own matches, tracks and random number generator.
    */
   void ComputePutativeTranslation_EdgesCoverage(const sfmData::SfMData& sfmData,
            const HashMap<IndexT, Mat3>& map_globalR,
@@ -105,11 +107,12 @@ private:
 
   /**
    * @brief Robust estimation and refinement of a translation and 3D points of an image triplets.
+   * @param[in] tripletMatches the matches between the views of the three poses of the triplet
    */
   bool Estimate_T_triplet(const sfmData::SfMData& sfmData,
            const HashMap<IndexT, Mat3>& map_globalR,
            const feature::FeaturesPerView& normalizedFeaturesPerView,
-           const matching::PairwiseMatches& pairwiseMatches,
+           const matching::PairwiseMatches& tripletMatches,
            const graph::Triplet& poses_id,
            std::mt19937 & randomNumberGenerator,
            std::vector<Vec3>& vec_tis,
@@ -0,0 +1,122 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Distribute the task indexes [0, nbTasks) to a set of threads.
+ *
+ * Each thread starts with a contiguous range of tasks and takes them in order, so that
+ * neighbouring tasks are processed by the same thread. Once its range is empty, a thread
+ * steals the second half of the remaining range of another thread.
+ * A thread only runs out of tasks once all the tasks have been distributed.
+ */
+class WorkStealingQueue
+{
+  typedef std::mutex mutexT;
+  typedef std::lock_guard<mutexT> lockGuardT;
+
+public:
+  WorkStealingQueue(std::size_t nbTasks, std::size_t nbThreads)
+    : _nbRemainingTasks(nbTasks)
+  {
+    nbThreads = std::max<std::size_t>(1, nbThreads);
+    _ranges.reserve(nbThreads);
+    for(std::size_t thread = 0; thread < nbThreads; ++thread)
+    {
+      _ranges.emplace_back(new Range);
+      _ranges.back()->begin = nbTasks * thread / nbThreads;
+      _ranges.back()->end = nbTasks * (thread + 1) / nbThreads;
+    }
+  }
+
+  /**
+   * @brief Get the next task of a thread
+   * @param[in] thread the thread index, in [0, nbThreads)
+   * @param[out] task the task index
+   * @return false if all the tasks have been distributed
+   */
+  bool pop(std::size_t thread, std::size_t& task)
+  {
+    Range& range = *_ranges.at(thread);
+
+    while(true)
+    {
+      if(popFront(range, task))
+        return true;
+
+      // steal half of the remaining tasks of the next non-empty range,
+      // both ranges are locked so that the stolen tasks always belong to a range
+      for(std::size_t i = 1; i < _ranges.size(); ++i)
+      {
+        Range& victim = *_ranges[(thread + i) % _ranges.size()];
+        std::lock(range.mutex, victim.mutex);
+        lockGuardT rangeGuard(range.mutex, std::adopt_lock);
+        lockGuardT victimGuard(victim.mutex, std::adopt_lock);
+
+        if(victim.begin >= victim.end)
+          continue;
+
+        range.begin = victim.begin + (victim.end - victim.begin) / 2;
+        range.end = victim.end;
+        victim.end = range.begin;
+
+        task = range.begin++;
+        --_nbRemainingTasks;
+        return true;
+      }
+
+      if(_nbRemainingTasks == 0)
+        return false;
+
+      // the remaining tasks have moved to a range already visited
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * @brief Get the number of tasks not distributed yet
+   */
+  std::size_t getNbRemainingTasks() const
+  {
+    return _nbRemainingTasks;
+  }
+
+private:
+  struct Range
+  {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    mutexT mutex;
+  };
+
+  bool popFront(Range& range, std::size_t& task)
+  {
+    lockGuardT guard(range.mutex);
+    if(range.begin >= range.end)
+      return false;
+    task = range.begin++;
+    --_nbRemainingTasks;
+    return true;
+  }
+
+  std::vector<std::unique_ptr<Range>> _ranges;
+  /// number of tasks not distributed yet
+  std::atomic<std::size_t> _nbRemainingTasks;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,67 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/global/WorkStealingQueue.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE WorkStealingQueue
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+BOOST_AUTO_TEST_CASE(WorkStealingQueue_allTasksOnce)
+{
+  for(const int nbThreads : {1, 4, 7})
+  {
+    for(const std::size_t nbTasks : {std::size_t(0), std::size_t(1), std::size_t(nbThreads - 1), std::size_t(50000)})
+    {
+      sfm::WorkStealingQueue queue(nbTasks, nbThreads);
+
+      std::vector<std::vector<std::size_t>> tasksPerThread(nbThreads);
+      std::vector<std::size_t> nbRemainingTasksAtEnd(nbThreads, 0);
+
+#pragma omp parallel num_threads(nbThreads)
+      {
+        const int thread = omp_get_thread_num();
+        std::size_t task = 0;
+        while(queue.pop(thread, task))
+        {
+          tasksPerThread.at(thread).push_back(task);
+          // the first thread is slower: the others steal its tasks
+          if(thread == 0 && nbTasks > 1000)
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+        nbRemainingTasksAtEnd.at(thread) = queue.getNbRemainingTasks();
+      }
+
+      // pop returns false only once all the tasks have been distributed
+      for(const std::size_t nbRemainingTasks : nbRemainingTasksAtEnd)
+        BOOST_CHECK_EQUAL(nbRemainingTasks, 0);
+
+      // each task is distributed exactly once
+      std::vector<int> nbPopsPerTask(nbTasks, 0);
+      for(const std::vector<std::size_t>& tasks : tasksPerThread)
+      {
+        for(const std::size_t task : tasks)
+        {
+          BOOST_REQUIRE_LT(task, nbTasks);
+          ++nbPopsPerTask.at(task);
+        }
+      }
+      for(std::size_t task = 0; task < nbTasks; ++task)
+        BOOST_CHECK_EQUAL(nbPopsPerTask.at(task), 1);
+
+      // a drained queue stays empty
+      std::size_t task = 0;
+      BOOST_CHECK(!queue.pop(0, task));
+    }
+  }
+}
@@ -0,0 +1,453 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/hierarchical/ReconstructionEngine_hierarchicalSfM.hpp>
+#include <aliceVision/sfm/pipeline/hierarchical/viewGraphPartition.hpp>
+#include <aliceVision/sfm/utils/alignment.hpp>
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/sfmFilters.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <tuple>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace sfm {
+
+using namespace aliceVision::sfmData;
+
+ReconstructionEngine_hierarchicalSfM::ReconstructionEngine_hierarchicalSfM(const SfMData& sfmData,
+                                                                           const Params& params,
+                                                                           const std::string& outputFolder)
+  : ReconstructionEngine(sfmData, outputFolder)
+  , _params(params)
+{}
+
+bool ReconstructionEngine_hierarchicalSfM::process()
+{
+  system::Timer timer;
+
+  if(!_sfmData.getLandmarks().empty())
+    ALICEVISION_LOG_WARNING("Hierarchical SfM: the input landmarks are ignored, they are triangulated again in each cluster.");
+
+  partitionViewGraph(_sfmData, *_pairwiseMatches, _params.maxClusterSize, _params.clusterOverlapRatio, _clusters);
+
+  if(_clusters.empty())
+  {
+    ALICEVISION_LOG_ERROR("Hierarchical SfM: no cluster of connected views.");
+    return false;
+  }
+
+  // the random seeds are drawn before the parallel reconstructions to keep them reproducible
+  std::vector<int> randomSeeds(_clusters.size());
+  std::uniform_int_distribution<int> seedDistribution(0, std::numeric_limits<int>::max());
+  for(int& randomSeed : randomSeeds)
+    randomSeed = seedDistribution(_randomNumberGenerator);
+
+  // the clusters that cannot be reconstructed keep an empty scene
+  std::vector<SfMData> reconstructions(_clusters.size());
+
+  // The threads are shared between the clusters and the reconstruction of each cluster:
+  // the bundle adjustments of a cluster use the threads left by the parallel clusters.
+  // The OpenMP loops of the sequential reconstruction are nested and run on a single thread,
+  // so a few large clusters do not use all the threads.
+  const int nbThreads = omp_get_max_threads();
+  const int nbClusterThreads = std::max(1, std::min(nbThreads, static_cast<int>(_clusters.size())));
+  const int nbThreadsPerCluster = std::max(1, nbThreads / nbClusterThreads);
+
+#pragma omp parallel for schedule(dynamic) num_threads(nbClusterThreads)
+  for(int i = 0; i < _clusters.size(); ++i)
+  {
+    omp_set_num_threads(nbThreadsPerCluster);
+    reconstructCluster(i, randomSeeds.at(i), reconstructions.at(i));
+  }
+
+  omp_set_num_threads(nbThreads);
+
+  ALICEVISION_LOG_INFO("Hierarchical SfM: the reconstruction of the " << _clusters.size() << " clusters took (s): " << timer.elapsed());
+
+  if(!mergeReconstructions(reconstructions))
+    return false;
+
+  if(!bundleAdjustment())
+    return false;
+
+  ALICEVISION_LOG_INFO("Hierarchical SfM took (s): " << timer.elapsed());
+
+  return !_sfmData.getPoses().empty();
+}
+
+bool ReconstructionEngine_hierarchicalSfM::reconstructCluster(std::size_t clusterIndex, int randomSeed, SfMData& out_sfmData) const
+{
+  const std::set<IndexT>& cluster = _clusters.at(clusterIndex);
+
+  // the sequential reconstructions run in parallel and update their views and intrinsics,
+  // each cluster owns a copy of them
+  SfMData clusterSfmData;
+  for(const IndexT viewId : cluster)
+  {
+    const View& view = _sfmData.getView(viewId);
+    clusterSfmData.getViews().emplace(viewId, std::make_shared<View>(view));
+
+    const auto intrinsicIt = _sfmData.getIntrinsics().find(view.getIntrinsicId());
+    if(intrinsicIt != _sfmData.getIntrinsics().end() && !clusterSfmData.getIntrinsics().count(intrinsicIt->first))
+      clusterSfmData.getIntrinsics().emplace(intrinsicIt->first, std::shared_ptr<camera::IntrinsicBase>(intrinsicIt->second->clone()));
+
+    if(view.isPartOfRig() && !clusterSfmData.getRigs().count(view.getRigId()))
+      clusterSfmData.getRigs().emplace(view.getRigId(), _sfmData.getRigs().at(view.getRigId()));
+
+    if(_sfmData.existsPose(view))
+      clusterSfmData.setAbsolutePose(view.getPoseId(), _sfmData.getAbsolutePose(view.getPoseId()));
+  }
+
+  matching::PairwiseMatches clusterMatches;
+  for(const auto& matchesPerPair : *_pairwiseMatches)
+  {
+    if(cluster.count(matchesPerPair.first.first) && cluster.count(matchesPerPair.first.second))
+      clusterMatches.insert(matchesPerPair);
+  }
+
+  ReconstructionEngine_sequentialSfM::Params sequentialParams = _params.sequentialParams;
+
+  // the user initial pair is only used by the clusters containing its views
+  if(!cluster.count(sequentialParams.userInitialImagePair.first))
+    sequentialParams.userInitialImagePair.first = UndefinedIndexT;
+  if(!cluster.count(sequentialParams.userInitialImagePair.second))
+    sequentialParams.userInitialImagePair.second = UndefinedIndexT;
+
+  // no checkpoint log for the clusters
+  sequentialParams.checkpointFilepath.clear();
+  sequentialParams.resumeFromCheckpoint = false;
+
+  const std::string clusterFolder = (fs::path(_outputFolder) / ("cluster_" + std::to_string(clusterIndex))).string();
+  if(!fs::exists(clusterFolder))
+    fs::create_directories(clusterFolder);
+
+  ALICEVISION_LOG_INFO("Hierarchical SfM: reconstruct the cluster " << clusterIndex << " (" << cluster.size() << " views, "
+                       << clusterMatches.size() << " image pairs).");
+
+  try
+  {
+    ReconstructionEngine_sequentialSfM sfmEngine(clusterSfmData, sequentialParams, clusterFolder);
+
+    sfmEngine.initRandomSeed(randomSeed);
+    sfmEngine.setFeatures(_featuresPerView);
+    sfmEngine.setMatches(&clusterMatches);
+
+    if(!sfmEngine.process())
+    {
+      ALICEVISION_LOG_WARNING("Hierarchical SfM: the cluster " << clusterIndex << " is not reconstructed.");
+      return false;
+    }
+
+    out_sfmData = std::move(sfmEngine.getSfMData());
+  }
+  catch(const std::exception& e)
+  {
+    ALICEVISION_LOG_WARNING("Hierarchical SfM: the reconstruction of the cluster " << clusterIndex << " failed: " << e.what());
+    return false;
+  }
+
+  ALICEVISION_LOG_INFO("Hierarchical SfM: cluster " << clusterIndex << " reconstructed:" << std::endl
+                       << "\t- # cameras calibrated: " << out_sfmData.getValidViews().size() << " / " << cluster.size() << std::endl
+                       << "\t- # landmarks: " << out_sfmData.getLandmarks().size());
+  return true;
+}
+
+bool ReconstructionEngine_hierarchicalSfM::mergeReconstructions(std::vector<SfMData>& reconstructions)
+{
+  // reconstructions by decreasing number of poses
+  std::vector<std::size_t> reconstructionIndexes;
+  for(std::size_t i = 0; i < reconstructions.size(); ++i)
+  {
+    if(!reconstructions.at(i).getPoses().empty())
+      reconstructionIndexes.push_back(i);
+  }
+
+  if(reconstructionIndexes.empty())
+  {
+    ALICEVISION_LOG_ERROR("Hierarchical SfM: no cluster is reconstructed.");
+    return false;
+  }
+
+  std::stable_sort(reconstructionIndexes.begin(), reconstructionIndexes.end(), [&](std::size_t a, std::size_t b)
+  {
+    return reconstructions.at(a).getPoses().size() > reconstructions.at(b).getPoses().size();
+  });
+
+  SfMData merged = std::move(reconstructions.at(reconstructionIndexes.front()));
+
+  // index of the observations of the merged landmarks: <viewId, featureId, descType> -> landmarkId
+  using ObsKey = std::tuple<IndexT, IndexT, feature::EImageDescriberType>;
+  std::map<ObsKey, IndexT> landmarkPerObservation;
+  IndexT nextLandmarkId = 0;
+
+  for(const auto& landmarkPair : merged.getLandmarks())
+  {
+    for(const auto& observationPair : landmarkPair.second.observations)
+      landmarkPerObservation.emplace(ObsKey(observationPair.first, observationPair.second.id_feat, landmarkPair.second.descType), landmarkPair.first);
+    nextLandmarkId = std::max(nextLandmarkId, landmarkPair.first + 1);
+  }
+
+  // the resection ids of the clusters follow the ones of the merged scene
+  IndexT nextResectionId = 0;
+  for(const auto& viewPair : merged.getViews())
+  {
+    const View& view = *viewPair.second;
+    if(merged.existsPose(view) && view.getResectionId() != UndefinedIndexT)
+      nextResectionId = std::max(nextResectionId, view.getResectionId() + 1);
+  }
+
+  std::set<std::size_t> remainingIndexes(reconstructionIndexes.begin() + 1, reconstructionIndexes.end());
+  std::vector<std::size_t> unalignedIndexes;
+  std::size_t nbMerged = 1;
+
+  while(!remainingIndexes.empty())
+  {
+    // the next reconstruction is the one with the most cameras in common with the merged scene
+    std::size_t bestIndex = *remainingIndexes.begin();
+    std::vector<IndexT> bestCommonViewIds;
+    for(const std::size_t index : remainingIndexes)
+    {
+      std::vector<IndexT> commonViewIds;
+      getCommonViewsWithPoses(reconstructions.at(index), merged, commonViewIds);
+      if(commonViewIds.size() > bestCommonViewIds.size())
+      {
+        bestIndex = index;
+        bestCommonViewIds.swap(commonViewIds);
+      }
+    }
+
+    if(bestCommonViewIds.empty())
+      break;
+
+    remainingIndexes.erase(bestIndex);
+    SfMData& reconstruction = reconstructions.at(bestIndex);
+
+    // landmarks sharing an observation with a merged landmark
+    std::map<IndexT, IndexT> mergedLandmarkPerLandmark;
+    for(const auto& landmarkPair : reconstruction.getLandmarks())
+    {
+      for(const auto& observationPair : landmarkPair.second.observations)
+      {
+        const auto it = landmarkPerObservation.find(ObsKey(observationPair.first, observationPair.second.id_feat, landmarkPair.second.descType));
+        if(it != landmarkPerObservation.end())
+        {
+          mergedLandmarkPerLandmark.emplace(landmarkPair.first, it->second);
+          break;
+        }
+      }
+    }
+
+    std::vector<std::pair<IndexT, IndexT>> commonViewIds;
+    for(const IndexT viewId : bestCommonViewIds)
+      commonViewIds.emplace_back(viewId, viewId);
+
+    // regular subset of the common landmarks to bound the cost of the robust alignment
+    std::vector<std::pair<IndexT, IndexT>> commonLandmarkIds;
+    {
+      const std::size_t maxNbLandmarks = std::max(std::size_t(1), _params.maxNbCommonLandmarksForAlignment);
+      const std::size_t step = std::max(std::size_t(1), (mergedLandmarkPerLandmark.size() + maxNbLandmarks - 1) / maxNbLandmarks);
+      std::size_t i = 0;
+      for(const auto& landmarkIds : mergedLandmarkPerLandmark)
+      {
+        if(i++ % step == 0)
+          commonLandmarkIds.emplace_back(landmarkIds);
+      }
+    }
+
+    if(commonViewIds.size() + commonLandmarkIds.size() < _params.minNbCommonPointsForAlignment)
+    {
+      ALICEVISION_LOG_WARNING("Hierarchical SfM: not enough common cameras and landmarks to align the cluster " << bestIndex << ".");
+      unalignedIndexes.push_back(bestIndex);
+      continue;
+    }
+
+    double S;
+    Mat3 R;
+    Vec3 t;
+    if(!computeSimilarityFromCommonCamerasAndLandmarks(reconstruction, merged, commonViewIds, commonLandmarkIds, _randomNumberGenerator, &S, &R, &t))
+    {
+      ALICEVISION_LOG_WARNING("Hierarchical SfM: failed to align the cluster " << bestIndex << ".");
+      unalignedIndexes.push_back(bestIndex);
+      continue;
+    }
+
+    applyTransform(reconstruction, S, R, t);
+
+    // the cameras already in the merged scene keep their pose and intrinsics,
+    // the views whose pose is adopted get their reconstruction state from this cluster
+    const IndexT resectionIdOffset = nextResectionId;
+    for(const auto& viewPair : reconstruction.getViews())
+    {
+      View& view = *viewPair.second;
+      if(!reconstruction.existsPose(view) || merged.existsPose(view))
+      {
+        merged.getViews().emplace(viewPair);
+        continue;
+      }
+      if(view.getResectionId() != UndefinedIndexT)
+      {
+        view.setResectionId(view.getResectionId() + resectionIdOffset);
+        nextResectionId = std::max(nextResectionId, view.getResectionId() + 1);
+      }
+      merged.getViews()[viewPair.first] = viewPair.second;
+    }
+    for(const auto& intrinsicPair : reconstruction.getIntrinsics())
+      merged.getIntrinsics().emplace(intrinsicPair);
+    for(const auto& posePair : reconstruction.getPoses())
+      merged.getPoses().emplace(posePair);
+
+    for(const auto& rigPair : reconstruction.getRigs())
+    {
+      auto rigIt = merged.getRigs().find(rigPair.first);
+      if(rigIt == merged.getRigs().end())
+      {
+        merged.getRigs().emplace(rigPair);
+        continue;
+      }
+      for(std::size_t subPoseIndex = 0; subPoseIndex < rigPair.second.getNbSubPoses(); ++subPoseIndex)
+      {
+        RigSubPose& mergedSubPose = rigIt->second.getSubPose(subPoseIndex);
+        if(mergedSubPose.status == ERigSubPoseStatus::UNINITIALIZED)
+          mergedSubPose = rigPair.second.getSubPose(subPoseIndex);
+      }
+    }
+
+    // fuse the common landmarks, add the others
+    for(auto& landmarkPair : reconstruction.getLandmarks())
+    {
+      const auto mergedIt = mergedLandmarkPerLandmark.find(landmarkPair.first);
+      const IndexT landmarkId = (mergedIt != mergedLandmarkPerLandmark.end()) ? mergedIt->second : nextLandmarkId++;
+
+      if(mergedIt == mergedLandmarkPerLandmark.end())
+      {
+        Landmark& landmark = merged.getLandmarks()[landmarkId];
+        landmark = std::move(landmarkPair.second);
+        for(const auto& observationPair : landmark.observations)
+          landmarkPerObservation.emplace(ObsKey(observationPair.first, observationPair.second.id_feat, landmark.descType), landmarkId);
+        continue;
+      }
+
+      // the tracks of the clusters may disagree: the observations of a view already observed by the merged landmark
+      // or of a feature owned by another merged landmark are skipped, a feature belongs to a single landmark
+      Landmark& landmark = merged.getLandmarks().at(landmarkId);
+      for(const auto& observationPair : landmarkPair.second.observations)
+      {
+        if(landmark.observations.count(observationPair.first))
+          continue;
+        const auto ownerIt = landmarkPerObservation.emplace(ObsKey(observationPair.first, observationPair.second.id_feat, landmark.descType), landmarkId);
+        if(ownerIt.first->second != landmarkId)
+          continue;
+        landmark.observations.emplace(observationPair);
+      }
+    }
+
+    ++nbMerged;
+    ALICEVISION_LOG_INFO("Hierarchical SfM: cluster " << bestIndex << " merged with " << bestCommonViewIds.size() << " common cameras and "
+                         << mergedLandmarkPerLandmark.size() << " common landmarks (scale: " << S << ").");
+  }
+
+  // the clusters without common cameras with the merged scene are dropped too
+  unalignedIndexes.insert(unalignedIndexes.end(), remainingIndexes.begin(), remainingIndexes.end());
+  std::sort(unalignedIndexes.begin(), unalignedIndexes.end());
+
+  std::ostringstream unalignedClusters;
+  for(const std::size_t index : unalignedIndexes)
+    unalignedClusters << " " << index;
+
+  if(!unalignedIndexes.empty())
+    ALICEVISION_LOG_WARNING("Hierarchical SfM: " << unalignedIndexes.size() << " reconstructed clusters cannot be aligned with the merged scene and are dropped.");
+
+  ALICEVISION_LOG_INFO("Hierarchical SfM: " << nbMerged << " / " << _clusters.size() << " clusters merged:" << std::endl
+                       << "\t- # clusters not reconstructed: " << _clusters.size() - reconstructionIndexes.size() << std::endl
+                       << "\t- # reconstructed clusters dropped (not aligned): " << unalignedIndexes.size()
+                       << (unalignedIndexes.empty() ? "" : " (clusters:" + unalignedClusters.str() + ")") << std::endl
+                       << "\t- # poses: " << merged.getPoses().size() << std::endl
+                       << "\t- # landmarks: " << merged.getLandmarks().size());
+
+  // the input scene gets the merged poses, rigs, landmarks, refined intrinsics
+  // and the reconstruction state of the views from the cluster owning their pose
+  for(const auto& viewPair : merged.getViews())
+  {
+    const View& mergedView = *viewPair.second;
+    if(!merged.existsPose(mergedView))
+      continue;
+    View& view = _sfmData.getView(viewPair.first);
+    view.setResectionId(mergedView.getResectionId());
+    view.setIndependantPose(mergedView.isPoseIndependant());
+  }
+  _sfmData.getPoses() = merged.getPoses();
+  _sfmData.getLandmarks() = std::move(merged.getLandmarks());
+  for(const auto& rigPair : merged.getRigs())
+    _sfmData.getRigs()[rigPair.first] = rigPair.second;
+  for(const auto& intrinsicPair : merged.getIntrinsics())
+    _sfmData.getIntrinsics()[intrinsicPair.first] = intrinsicPair.second;
+
+  return true;
+}
+
+bool ReconstructionEngine_hierarchicalSfM::bundleAdjustment()
+{
+  const ReconstructionEngine_sequentialSfM::Params& sequentialParams = _params.sequentialParams;
+
+  BundleAdjustmentCeres::CeresOptions options;
+  BundleAdjustment::ERefineOptions refineOptions = BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE;
+
+  if(!sequentialParams.lockAllIntrinsics)
+    refineOptions |= BundleAdjustment::REFINE_INTRINSICS_ALL;
+
+  if(_sfmData.getPoses().size() > 100)
+    options.setSparseBA();
+  else
+    options.setDenseBA();
+
+  BundleAdjustmentCeres BA(options, sequentialParams.minNbCamerasToRefinePrincipalPoint);
+
+  const std::size_t nbOutliersThreshold = 50;
+  std::size_t nbOutliers = 0;
+  std::size_t iteration = 0;
+
+  // perform BA until all point are under the given precision
+  do
+  {
+    ALICEVISION_LOG_INFO("Hierarchical SfM: global bundle adjustment iteration: " << iteration);
+
+    if(!BA.adjust(_sfmData, refineOptions))
+      return false;
+
+    const BundleAdjustmentCeres::Statistics& statistics = BA.getStatistics();
+    statistics.exportToFile(_outputFolder, "bundle_adjustment.csv");
+    statistics.show();
+
+    const std::size_t nbOutliersResidualErr = RemoveOutliers_PixelResidualError(_sfmData, sequentialParams.featureConstraint, sequentialParams.maxReprojectionError, 2);
+    const std::size_t nbOutliersAngleErr = RemoveOutliers_AngleError(_sfmData, sequentialParams.minAngleForLandmark);
+    nbOutliers = nbOutliersResidualErr + nbOutliersAngleErr;
+
+    ALICEVISION_LOG_INFO("Remove outliers: " << std::endl
+                          << "\t- # outliers residual error: " << nbOutliersResidualErr << std::endl
+                          << "\t- # outliers angular error: " << nbOutliersAngleErr);
+
+    eraseUnstablePosesAndObservations(_sfmData, sequentialParams.minPointsPerPose, sequentialParams.minTrackLength);
+    ++iteration;
+  }
+  while(nbOutliers > nbOutliersThreshold);
+
+  return true;
+}
+
+} // namespace sfm
+} // namespace aliceVision
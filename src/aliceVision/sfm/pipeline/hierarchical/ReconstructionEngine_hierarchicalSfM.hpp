@@ -0,0 +1,110 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfm/pipeline/ReconstructionEngine.hpp>
+#include <aliceVision/sfm/pipeline/sequential/ReconstructionEngine_sequentialSfM.hpp>
+#include <aliceVision/feature/FeaturesPerView.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Hierarchical SfM Pipeline Reconstruction Engine.
+ *
+ * - The view graph is partitioned in overlapping clusters of views.
+ * - Each cluster is reconstructed by an independent sequential SfM, in parallel.
+ * - The reconstructions are aligned with their common cameras and landmarks and merged.
+ * - A global bundle adjustment refines the merged scene.
+ */
+class ReconstructionEngine_hierarchicalSfM : public ReconstructionEngine
+{
+public:
+  struct Params
+  {
+    /// parameters of the sequential reconstruction of each cluster
+    ReconstructionEngine_sequentialSfM::Params sequentialParams;
+    /// maximum number of views of a cluster, before its extension with the overlapping views
+    std::size_t maxClusterSize = 500;
+    /// number of views added to each cluster from its neighbours, relative to the cluster size
+    double clusterOverlapRatio = 0.2;
+    /// minimum number of common cameras and landmarks to align two reconstructions
+    std::size_t minNbCommonPointsForAlignment = 10;
+    /// maximum number of common landmarks used to align two reconstructions
+    std::size_t maxNbCommonLandmarksForAlignment = 10000;
+  };
+
+  ReconstructionEngine_hierarchicalSfM(const sfmData::SfMData& sfmData,
+                                       const Params& params,
+                                       const std::string& outputFolder);
+
+  void setFeatures(feature::FeaturesPerView* featuresPerView)
+  {
+    _featuresPerView = featuresPerView;
+  }
+
+  void setMatches(matching::PairwiseMatches* pairwiseMatches)
+  {
+    _pairwiseMatches = pairwiseMatches;
+  }
+
+  /**
+   * @brief Process the entire hierarchical reconstruction
+   * @return true if done
+   */
+  bool process() override;
+
+  /**
+   * @brief Get the view ids of each cluster
+   * @return clusters of views
+   */
+  const std::vector<std::set<IndexT>>& getClusters() const
+  {
+    return _clusters;
+  }
+
+private:
+
+  /**
+   * @brief Reconstruct the views of one cluster with a sequential SfM
+   * @param[in] clusterIndex the index of the cluster
+   * @param[in] randomSeed the random seed of the sequential SfM
+   * @param[out] out_sfmData the reconstruction of the cluster
+   * @return true if the cluster is reconstructed
+   */
+  bool reconstructCluster(std::size_t clusterIndex, int randomSeed, sfmData::SfMData& out_sfmData) const;
+
+  /**
+   * @brief Align the reconstructions on the biggest one and merge them in the scene
+   * @param[in,out] reconstructions the reconstructions of the clusters
+   * @return true if at least one reconstruction is merged
+   */
+  bool mergeReconstructions(std::vector<sfmData::SfMData>& reconstructions);
+
+  /**
+   * @brief Refine the merged scene and remove the outliers
+   * @return false if the bundle adjustment failed
+   */
+  bool bundleAdjustment();
+
+  // Parameters
+  Params _params;
+
+  // Data providers
+  feature::FeaturesPerView* _featuresPerView = nullptr;
+  matching::PairwiseMatches* _pairwiseMatches = nullptr;
+
+  /// view ids of each cluster
+  std::vector<std::set<IndexT>> _clusters;
+};
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,155 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/sfm/utils/statistics.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfm/sfm.hpp>
+
+#include <iostream>
+
+#define BOOST_TEST_MODULE HIERARCHICAL_SFM
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::geometry;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+namespace {
+
+void addMatches(matching::PairwiseMatches& pairwiseMatches, IndexT viewIdA, IndexT viewIdB, std::size_t nbMatches)
+{
+  matching::IndMatches& matches = pairwiseMatches[Pair(viewIdA, viewIdB)][feature::EImageDescriberType::UNKNOWN];
+  for(std::size_t i = 0; i < nbMatches; ++i)
+    matches.emplace_back(i, i);
+}
+
+} // namespace
+
+// Test summary:
+// - Two groups of 6 views, fully connected inside each group and weakly connected between them
+// - Assert that the partition finds the two groups
+// - Assert that the overlap extends each group with views of the other one
+BOOST_AUTO_TEST_CASE(HIERARCHICAL_SFM_Partition)
+{
+  const IndexT nbViewsPerGroup = 6;
+
+  SfMData sfmData;
+  for(IndexT viewId = 0; viewId < 2 * nbViewsPerGroup; ++viewId)
+    sfmData.views[viewId] = std::make_shared<View>("", viewId, 0, viewId);
+
+  matching::PairwiseMatches pairwiseMatches;
+  for(IndexT group = 0; group < 2; ++group)
+  {
+    for(IndexT i = 0; i < nbViewsPerGroup; ++i)
+      for(IndexT j = i + 1; j < nbViewsPerGroup; ++j)
+        addMatches(pairwiseMatches, group * nbViewsPerGroup + i, group * nbViewsPerGroup + j, 100);
+  }
+  for(IndexT i = 0; i < nbViewsPerGroup; ++i)
+    addMatches(pairwiseMatches, i, nbViewsPerGroup + i, 10);
+
+  // without overlap
+  {
+    std::vector<std::set<IndexT>> clusters;
+    partitionViewGraph(sfmData, pairwiseMatches, nbViewsPerGroup, 0.0, clusters);
+
+    BOOST_REQUIRE_EQUAL(clusters.size(), 2);
+    for(const std::set<IndexT>& cluster : clusters)
+    {
+      BOOST_CHECK_EQUAL(cluster.size(), nbViewsPerGroup);
+      const IndexT group = *cluster.begin() / nbViewsPerGroup;
+      for(const IndexT viewId : cluster)
+        BOOST_CHECK_EQUAL(viewId / nbViewsPerGroup, group);
+    }
+  }
+
+  // with overlap
+  {
+    std::vector<std::set<IndexT>> clusters;
+    partitionViewGraph(sfmData, pairwiseMatches, nbViewsPerGroup, 0.5, clusters);
+
+    BOOST_REQUIRE_EQUAL(clusters.size(), 2);
+    BOOST_CHECK_EQUAL(clusters.at(0).size(), nbViewsPerGroup + 3);
+    BOOST_CHECK_EQUAL(clusters.at(1).size(), nbViewsPerGroup + 3);
+
+    std::vector<IndexT> commonViewIds;
+    std::set_intersection(clusters.at(0).begin(), clusters.at(0).end(),
+                          clusters.at(1).begin(), clusters.at(1).end(),
+                          std::back_inserter(commonViewIds));
+    BOOST_CHECK_EQUAL(commonViewIds.size(), 6);
+  }
+}
+
+// Test summary:
+// - Create features points and matching from the synthetic dataset
+// - Init a SfMData scene View and Intrinsic from a synthetic dataset
+// - Perform Hierarchical SfM on the data with clusters smaller than the scene
+// - Assert that:
+//   - mean residual error is below the gaussian noise added to observation
+//   - the desired number of tracks are found,
+//   - the desired number of poses are found.
+BOOST_AUTO_TEST_CASE(HIERARCHICAL_SFM_Known_Intrinsics)
+{
+  const int nviews = 12;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfMData sfmData2 = sfmData;
+  sfmData2.getPoses().clear();
+  sfmData2.structure.clear();
+
+  ReconstructionEngine_hierarchicalSfM::Params sfmParams;
+  sfmParams.sequentialParams.lockAllIntrinsics = true;
+  sfmParams.maxClusterSize = 6;
+  sfmParams.clusterOverlapRatio = 0.5;
+
+  ReconstructionEngine_hierarchicalSfM sfmEngine(
+    sfmData2,
+    sfmParams,
+    "./");
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  // Configure data provider (Features and Matches)
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+
+  BOOST_CHECK (sfmEngine.process());
+  BOOST_CHECK_GT(sfmEngine.getClusters().size(), 1);
+
+  const double residual = RMSE(sfmEngine.getSfMData());
+  ALICEVISION_LOG_DEBUG("RMSE residual: " << residual);
+  BOOST_CHECK_LT(residual, 0.5);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getPoses().size(), nviews);
+  BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), npoints);
+
+  // the views of the input scene get the resection state of the clusters,
+  // only the views of the initial pairs have no resection id
+  std::size_t nbResectedViews = 0;
+  for(const auto& viewPair : sfmEngine.getSfMData().getViews())
+  {
+    if(viewPair.second->getResectionId() != UndefinedIndexT)
+      ++nbResectedViews;
+  }
+  BOOST_CHECK_GT(nbResectedViews, 0);
+}
@@ -0,0 +1,277 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/hierarchical/viewGraphPartition.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <tuple>
+
+namespace aliceVision {
+namespace sfm {
+
+namespace {
+
+/// Weighted graph of the poses, the edge weight is the number of matches between their views
+struct PoseGraph
+{
+  /// view ids of each node
+  std::vector<std::vector<IndexT>> viewsPerNode;
+  /// <neighbour node, edge weight> of each node
+  std::vector<std::vector<std::pair<std::size_t, double>>> adjacency;
+};
+
+void buildPoseGraph(const sfmData::SfMData& sfmData,
+                    const matching::PairwiseMatches& pairwiseMatches,
+                    PoseGraph& graph)
+{
+  std::map<IndexT, std::size_t> nodePerPose;
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const IndexT poseId = viewPair.second->getPoseId();
+    auto it = nodePerPose.find(poseId);
+    if(it == nodePerPose.end())
+    {
+      it = nodePerPose.emplace(poseId, graph.viewsPerNode.size()).first;
+      graph.viewsPerNode.emplace_back();
+    }
+    graph.viewsPerNode.at(it->second).push_back(viewPair.first);
+  }
+
+  std::map<std::pair<std::size_t, std::size_t>, double> edges;
+  for(const auto& matchesPerPair : pairwiseMatches)
+  {
+    const auto itViewI = sfmData.getViews().find(matchesPerPair.first.first);
+    const auto itViewJ = sfmData.getViews().find(matchesPerPair.first.second);
+    if(itViewI == sfmData.getViews().end() || itViewJ == sfmData.getViews().end())
+      continue;
+
+    const std::size_t nodeI = nodePerPose.at(itViewI->second->getPoseId());
+    const std::size_t nodeJ = nodePerPose.at(itViewJ->second->getPoseId());
+    if(nodeI == nodeJ)
+      continue;
+
+    edges[std::make_pair(std::min(nodeI, nodeJ), std::max(nodeI, nodeJ))] += matchesPerPair.second.getNbAllMatches();
+  }
+
+  graph.adjacency.resize(graph.viewsPerNode.size());
+  for(const auto& edge : edges)
+  {
+    graph.adjacency.at(edge.first.first).emplace_back(edge.first.second, edge.second);
+    graph.adjacency.at(edge.first.second).emplace_back(edge.first.first, edge.second);
+  }
+}
+
+/**
+ * @brief Label propagation: each node takes the label of its most connected
+ *        neighbouring cluster, if this cluster has room for its views.
+ */
+void propagateLabels(const PoseGraph& graph,
+                     std::size_t maxClusterSize,
+                     std::vector<std::size_t>& labels,
+                     std::vector<std::size_t>& clusterSizes)
+{
+  const std::size_t maxIterations = 50;
+  const std::size_t nbNodes = graph.viewsPerNode.size();
+
+  for(std::size_t iteration = 0; iteration < maxIterations; ++iteration)
+  {
+    std::size_t nbChanges = 0;
+
+    for(std::size_t node = 0; node < nbNodes; ++node)
+    {
+      std::map<std::size_t, double> weightPerLabel;
+      for(const auto& neighbour : graph.adjacency.at(node))
+        weightPerLabel[labels.at(neighbour.first)] += neighbour.second;
+
+      const std::size_t nodeSize = graph.viewsPerNode.at(node).size();
+      std::size_t bestLabel = labels.at(node);
+      double bestWeight = weightPerLabel[bestLabel];
+
+      for(const auto& labelWeight : weightPerLabel)
+      {
+        if(labelWeight.first == labels.at(node) ||
+           clusterSizes.at(labelWeight.first) + nodeSize > maxClusterSize)
+          continue;
+
+        if(labelWeight.second > bestWeight)
+        {
+          bestLabel = labelWeight.first;
+          bestWeight = labelWeight.second;
+        }
+      }
+
+      if(bestLabel != labels.at(node))
+      {
+        clusterSizes.at(labels.at(node)) -= nodeSize;
+        clusterSizes.at(bestLabel) += nodeSize;
+        labels.at(node) = bestLabel;
+        ++nbChanges;
+      }
+    }
+
+    ALICEVISION_LOG_DEBUG("View graph partition, label propagation iteration " << iteration << ": " << nbChanges << " changes.");
+
+    if(nbChanges == 0)
+      break;
+  }
+}
+
+/**
+ * @brief Agglomerate the clusters by decreasing weight of their connection,
+ *        while the merged clusters stay under maxClusterSize views.
+ */
+void mergeClusters(const PoseGraph& graph,
+                   std::size_t maxClusterSize,
+                   std::vector<std::size_t>& labels,
+                   std::vector<std::size_t>& clusterSizes)
+{
+  bool merged = true;
+  while(merged)
+  {
+    merged = false;
+
+    std::map<std::pair<std::size_t, std::size_t>, double> clusterEdges;
+    for(std::size_t node = 0; node < graph.adjacency.size(); ++node)
+    {
+      for(const auto& neighbour : graph.adjacency.at(node))
+      {
+        const std::size_t labelA = labels.at(node);
+        const std::size_t labelB = labels.at(neighbour.first);
+        if(labelA < labelB)
+          clusterEdges[std::make_pair(labelA, labelB)] += neighbour.second;
+      }
+    }
+
+    // <weight, labelA, labelB> sorted by decreasing weight
+    std::vector<std::tuple<double, std::size_t, std::size_t>> sortedEdges;
+    sortedEdges.reserve(clusterEdges.size());
+    for(const auto& edge : clusterEdges)
+      sortedEdges.emplace_back(edge.second, edge.first.first, edge.first.second);
+    std::sort(sortedEdges.begin(), sortedEdges.end(), [](const std::tuple<double, std::size_t, std::size_t>& a,
+                                                         const std::tuple<double, std::size_t, std::size_t>& b)
+    {
+      if(std::get<0>(a) != std::get<0>(b))
+        return std::get<0>(a) > std::get<0>(b);
+      return std::make_pair(std::get<1>(a), std::get<2>(a)) < std::make_pair(std::get<1>(b), std::get<2>(b));
+    });
+
+    // each cluster is merged at most once per round, the cluster edges are recomputed afterwards
+    std::vector<std::size_t> mergedLabel(labels.size());
+    std::iota(mergedLabel.begin(), mergedLabel.end(), 0);
+    std::set<std::size_t> modifiedLabels;
+
+    for(const auto& edge : sortedEdges)
+    {
+      const std::size_t labelA = std::get<1>(edge);
+      const std::size_t labelB = std::get<2>(edge);
+
+      if(modifiedLabels.count(labelA) || modifiedLabels.count(labelB) ||
+         clusterSizes.at(labelA) + clusterSizes.at(labelB) > maxClusterSize)
+        continue;
+
+      mergedLabel.at(labelB) = labelA;
+      clusterSizes.at(labelA) += clusterSizes.at(labelB);
+      clusterSizes.at(labelB) = 0;
+      modifiedLabels.insert(labelA);
+      modifiedLabels.insert(labelB);
+      merged = true;
+    }
+
+    for(std::size_t& label : labels)
+      label = mergedLabel.at(label);
+  }
+}
+
+} // namespace
+
+void partitionViewGraph(const sfmData::SfMData& sfmData,
+                        const matching::PairwiseMatches& pairwiseMatches,
+                        std::size_t maxClusterSize,
+                        double overlapRatio,
+                        std::vector<std::set<IndexT>>& out_clusters)
+{
+  out_clusters.clear();
+
+  PoseGraph graph;
+  buildPoseGraph(sfmData, pairwiseMatches, graph);
+
+  const std::size_t nbNodes = graph.viewsPerNode.size();
+
+  // each node starts in its own cluster
+  std::vector<std::size_t> labels(nbNodes);
+  std::iota(labels.begin(), labels.end(), 0);
+  std::vector<std::size_t> clusterSizes(nbNodes);
+  for(std::size_t node = 0; node < nbNodes; ++node)
+    clusterSizes.at(node) = graph.viewsPerNode.at(node).size();
+
+  propagateLabels(graph, maxClusterSize, labels, clusterSizes);
+  mergeClusters(graph, maxClusterSize, labels, clusterSizes);
+
+  // nodes of each cluster, the isolated nodes are not part of any cluster
+  std::map<std::size_t, std::vector<std::size_t>> nodesPerLabel;
+  for(std::size_t node = 0; node < nbNodes; ++node)
+  {
+    if(!graph.adjacency.at(node).empty())
+      nodesPerLabel[labels.at(node)].push_back(node);
+  }
+
+  for(const auto& clusterNodes : nodesPerLabel)
+  {
+    const std::size_t label = clusterNodes.first;
+
+    // connection of the outside nodes with the cluster
+    std::map<std::size_t, double> weightPerOutsideNode;
+    for(const std::size_t node : clusterNodes.second)
+    {
+      for(const auto& neighbour : graph.adjacency.at(node))
+      {
+        if(labels.at(neighbour.first) != label)
+          weightPerOutsideNode[neighbour.first] += neighbour.second;
+      }
+    }
+
+    std::vector<std::pair<double, std::size_t>> outsideNodes;
+    outsideNodes.reserve(weightPerOutsideNode.size());
+    for(const auto& nodeWeight : weightPerOutsideNode)
+      outsideNodes.emplace_back(nodeWeight.second, nodeWeight.first);
+    std::sort(outsideNodes.begin(), outsideNodes.end(), [](const std::pair<double, std::size_t>& a,
+                                                           const std::pair<double, std::size_t>& b)
+    {
+      return (a.first != b.first) ? (a.first > b.first) : (a.second < b.second);
+    });
+
+    std::set<IndexT> cluster;
+    for(const std::size_t node : clusterNodes.second)
+      cluster.insert(graph.viewsPerNode.at(node).begin(), graph.viewsPerNode.at(node).end());
+
+    const std::size_t nbOverlapViews = static_cast<std::size_t>(std::ceil(overlapRatio * cluster.size()));
+    const std::size_t clusterSize = cluster.size();
+
+    for(const auto& outsideNode : outsideNodes)
+    {
+      if(cluster.size() - clusterSize >= nbOverlapViews)
+        break;
+      cluster.insert(graph.viewsPerNode.at(outsideNode.second).begin(), graph.viewsPerNode.at(outsideNode.second).end());
+    }
+
+    out_clusters.push_back(std::move(cluster));
+  }
+
+  std::stable_sort(out_clusters.begin(), out_clusters.end(), [](const std::set<IndexT>& a, const std::set<IndexT>& b)
+  {
+    return a.size() > b.size();
+  });
+
+  ALICEVISION_LOG_INFO("View graph partition: " << out_clusters.size() << " clusters of at most " << maxClusterSize
+                       << " views (+ " << overlapRatio * 100.0 << "% overlap).");
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,44 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/types.hpp>
+
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Partition the view graph in clusters of strongly connected views.
+ *
+ * The nodes of the graph are the poses (the views of a rig frame stay together)
+ * and the edges are weighted by the number of matches between their views.
+ *
+ * 1. Communities are detected by a label propagation limited to maxClusterSize views.
+ * 2. The small communities are merged with their most connected neighbour while
+ *    the result stays under maxClusterSize views.
+ * 3. Each cluster is extended with its most connected outside poses, so that the
+ *    neighbouring reconstructions share cameras and landmarks for their alignment.
+ *
+ * @param[in] sfmData the input scene
+ * @param[in] pairwiseMatches the matches between the views
+ * @param[in] maxClusterSize the maximum number of views of a cluster before its extension
+ * @param[in] overlapRatio the number of views added to a cluster, relative to its size
+ * @param[out] out_clusters the view ids of each cluster, sorted by decreasing size
+ */
+void partitionViewGraph(const sfmData::SfMData& sfmData,
+                        const matching::PairwiseMatches& pairwiseMatches,
+                        std::size_t maxClusterSize,
+                        double overlapRatio,
+                        std::vector<std::set<IndexT>>& out_clusters);
+
+} // namespace sfm
+} // namespace aliceVision
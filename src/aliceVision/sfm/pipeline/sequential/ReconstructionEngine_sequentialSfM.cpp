@@ -13,6 +13,7 @@
 #include <aliceVision/sfm/BundleAdjustmentSymbolicCeres.hpp>
 #include <aliceVision/sfm/sfmFilters.hpp>
 #include <aliceVision/sfm/sfmStatistics.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <aliceVision/feature/FeaturesPerView.hpp>
 #include <aliceVision/graph/connectedComponent.hpp>
@@ -176,26 +177,53 @@ bool ReconstructionEngine_sequentialSfM::process()
       // and update the landmarkIds accordingly.
       // Note: each landmark has a corresponding track with the same id (landmarkId == trackId).
       remapLandmarkIdsToTrackIds();
+  }
 
-      if (_params.useLocalBundleAdjustment)
+  // replay the checkpoint log on the input scene
+  // (the log is created from the remapped input scene, its landmark ids are track ids)
+  bool resumed = false;
+  if(!_params.checkpointFilepath.empty() && _params.resumeFromCheckpoint)
+  {
+    if(fs::exists(_params.checkpointFilepath))
+    {
+      IndexT lastResectionId;
+      if(!_checkpointLog.resume(_params.checkpointFilepath, _sfmData, lastResectionId))
+        throw std::runtime_error("Unable to resume the reconstruction from the checkpoint log: " + _params.checkpointFilepath);
+
+      resumed = (_checkpointLog.getNbCheckpoints() > 0);
+      ALICEVISION_LOG_INFO("Resume the reconstruction from the checkpoint log:" << std::endl
+                           << "\t- # checkpoints: " << _checkpointLog.getNbCheckpoints() << std::endl
+                           << "\t- last resection id: " << (lastResectionId == UndefinedIndexT ? std::string("none") : std::to_string(lastResectionId)));
+    }
+    else
+    {
+      ALICEVISION_LOG_WARNING("Checkpoint log not found, start a new reconstruction: " << _params.checkpointFilepath);
+    }
+  }
+
+  if (_params.useLocalBundleAdjustment && !_sfmData.getLandmarks().empty())
+  {
+      const std::set<IndexT> reconstructedViews = _sfmData.getValidViews();
+      if (!reconstructedViews.empty())
       {
-          const std::set<IndexT> reconstructedViews = _sfmData.getValidViews();
-          if (!reconstructedViews.empty())
-          {
-              // Add the reconstructed views to the LocalBA graph
-              _localStrategyGraph->updateGraphWithNewViews(_sfmData, _map_tracksPerView, reconstructedViews, _params.kMinNbOfMatches);
-              _localStrategyGraph->updateRigEdgesToTheGraph(_sfmData);
-          }
+          // Add the reconstructed views to the LocalBA graph
+          _localStrategyGraph->updateGraphWithNewViews(_sfmData, _map_tracksPerView, reconstructedViews, _params.kMinNbOfMatches);
+          _localStrategyGraph->updateRigEdgesToTheGraph(_sfmData);
       }
   }
 
+  // start a new checkpoint log from the input scene
+  if(!_params.checkpointFilepath.empty() && !_checkpointLog.isOpen())
+    _checkpointLog.create(_params.checkpointFilepath, _sfmData);
+
   // initial pair choice
   if(_sfmData.getPoses().empty())
   {
     std::vector<Pair> initialImagePairCandidates = getInitialImagePairsCandidates();
     createInitialReconstruction(initialImagePairCandidates);
+    saveCheckpoint(UndefinedIndexT);
   }
-  else
+  else if(!resumed)
   {
     // If we don't have any landmark, we need to triangulate them from the known poses.
     // But even if we already have landmarks, we need to try to triangulate new points with the current set of parameters.
@@ -207,6 +235,7 @@ bool ReconstructionEngine_sequentialSfM::process()
     // The optimization could allow the triangulation of new landmarks
     triangulate({}, prevReconstructedViews);
     bundleAdjustment(prevReconstructedViews);
+    saveCheckpoint(UndefinedIndexT);
   }
 
   // reconstruction
@@ -473,6 +502,8 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
         ALICEVISION_LOG_DEBUG("Save of file " << os.str() << " took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
       }
 
+      saveCheckpoint(resectionId);
+
       ++resectionId;
     }
 
@@ -497,6 +528,8 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
       bundleAdjustment(updatedViews);
 
       ALICEVISION_LOG_WARNING("Rig calibration finished:\n\t- # updated views: " << updatedViews.size());
+
+      saveCheckpoint(resectionId == 0 ? UndefinedIndexT : resectionId - 1);
     }
     ++globalIteration;
   }
@@ -863,6 +896,16 @@ void ReconstructionEngine_sequentialSfM::calibrateRigs(std::set<IndexT>& updated
   }
 }
 
+void ReconstructionEngine_sequentialSfM::saveCheckpoint(IndexT resectionId)
+{
+  if(!_checkpointLog.isOpen())
+    return;
+
+  auto chrono_start = std::chrono::steady_clock::now();
+  if(_checkpointLog.append(_sfmData, resectionId))
+    ALICEVISION_LOG_DEBUG("Checkpoint " << _checkpointLog.getNbCheckpoints() << " took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - chrono_start).count() << " msec.");
+}
+
 bool ReconstructionEngine_sequentialSfM::findConnectedViews(
   std::vector<ViewConnectionScore>& out_connectedViews,
   const std::set<IndexT>& remainingViewIds) const
@@ -1241,126 +1284,200 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
 
   if(filterViewId != UndefinedIndexT)
     ALICEVISION_LOG_INFO("Selection of an initial pair with one given view id: " << filterViewId << ".");
-  
+
+  // 1. Rank the candidate pairs with a cheap score: the pyramid score of their common tracks.
+  //    The inliers of the relative pose are a subset of the common tracks, so this score
+  //    multiplied by the max angle is an upper bound of the final score of the pair.
+
+  /// CandidatePair contains <upper bound of the pair score, imagePair>
+  typedef std::pair<double, Pair> CandidatePair;
+  std::vector<CandidatePair> candidatePairs;
+  {
+    std::vector<Pair> pairs;
+    pairs.reserve(_pairwiseMatches->size());
+    for(const auto& matchesPerPair : *_pairwiseMatches)
+    {
+      const IndexT I = std::min(matchesPerPair.first.first, matchesPerPair.first.second);
+      const IndexT J = std::max(matchesPerPair.first.first, matchesPerPair.first.second);
+
+      if (filterViewId != UndefinedIndexT && filterViewId != I && filterViewId != J)
+        continue;
+
+      if (!valid_views.count(I) || !valid_views.count(J))
+        continue;
+
+      if (dynamic_cast<const Pinhole*>(_sfmData.getIntrinsicPtr(_sfmData.getView(I).getIntrinsicId())) == nullptr ||
+          dynamic_cast<const Pinhole*>(_sfmData.getIntrinsicPtr(_sfmData.getView(J).getIntrinsicId())) == nullptr)
+        continue;
+
+      pairs.push_back(matchesPerPair.first);
+    }
+
+    candidatePairs.reserve(pairs.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < pairs.size(); ++i)
+    {
+      const IndexT I = std::min(pairs[i].first, pairs[i].second);
+      const IndexT J = std::max(pairs[i].first, pairs[i].second);
+
+      std::set<std::size_t> commonTracks;
+      track::getCommonTracksInImages({I, J}, _map_tracksPerView, commonTracks);
+
+      // not enough common tracks to reach the minimal number of inliers
+      if (commonTracks.size() <= iMin_inliers_count)
+        continue;
+
+      const std::vector<std::size_t> commonTracksIds(commonTracks.begin(), commonTracks.end());
+      const double imagePairScore = std::min(computeCandidateImageScore(I, commonTracksIds), computeCandidateImageScore(J, commonTracksIds));
+
+      #pragma omp critical
+      candidatePairs.emplace_back(imagePairScore * fLimit_max_angle, pairs[i]);
+    }
+  }
+
+  // sort by decreasing score, the pair ids make the order deterministic
+  std::sort(candidatePairs.begin(), candidatePairs.end(), std::greater<CandidatePair>());
+
+  if (_params.initialPairMaxCandidates > 0 && candidatePairs.size() > _params.initialPairMaxCandidates)
+  {
+    ALICEVISION_LOG_INFO("Initial pair selection: evaluate the " << _params.initialPairMaxCandidates << " best candidates out of " << candidatePairs.size() << ".");
+    candidatePairs.resize(_params.initialPairMaxCandidates);
+  }
+
+  // 2. Evaluate the candidates with robust estimation, by batches in the ranking order.
+  //    Stop once no remaining candidate can significantly beat the best valid score.
+
   /// ImagePairScore contains <imagePairScore*scoring_angle, imagePairScore, scoring_angle, numberOfInliers, imagePair>
   typedef std::tuple<double, double, double, std::size_t, Pair> ImagePairScore;
   std::vector<ImagePairScore> bestImagePairs;
-  bestImagePairs.reserve(_pairwiseMatches->size());
-  
+  bestImagePairs.reserve(candidatePairs.size());
+
+  const std::size_t batchSize = 4 * static_cast<std::size_t>(omp_get_max_threads());
+  double bestValidScore = 0.0;
+
   // Compute the relative pose & the 'baseline score'
-  boost::progress_display my_progress_bar( _pairwiseMatches->size(),
+  boost::progress_display my_progress_bar( candidatePairs.size(),
     std::cout,"Automatic selection of an initial pair:\n" );
 
-#pragma omp parallel for schedule(dynamic)
-  for (int i = 0; i < _pairwiseMatches->size(); ++i)
+  std::size_t batchBegin = 0;
+  while (batchBegin < candidatePairs.size())
   {
-    matching::PairwiseMatches::const_iterator iter = _pairwiseMatches->begin();
-    std::advance(iter, i);
-    
-#pragma omp critical
-    ++my_progress_bar;
-    
-    const Pair current_pair = iter->first;
-
-    const IndexT I = std::min(current_pair.first, current_pair.second);
-    const IndexT J = std::max(current_pair.first, current_pair.second);
-
-    if (filterViewId != UndefinedIndexT && filterViewId != I && filterViewId != J)
-      continue;
+    if (_params.initialPairEarlyStopRatio > 0.0 &&
+        bestValidScore > 0.0 &&
+        bestValidScore >= _params.initialPairEarlyStopRatio * candidatePairs[batchBegin].first)
+    {
+      ALICEVISION_LOG_INFO("Initial pair selection: stop after " << batchBegin << " / " << candidatePairs.size() << " candidates, the remaining ones cannot reach the best score.");
+      break;
+    }
 
-    if (!valid_views.count(I) || !valid_views.count(J))
-      continue;
-    
-    const View* viewI = _sfmData.getViews().at(I).get();
-    const Intrinsics::const_iterator iterIntrinsic_I = _sfmData.getIntrinsics().find(viewI->getIntrinsicId());
-    const View* viewJ = _sfmData.getViews().at(J).get();
-    const Intrinsics::const_iterator iterIntrinsic_J = _sfmData.getIntrinsics().find(viewJ->getIntrinsicId());
-
-    const Pinhole* camI = dynamic_cast<const Pinhole*>(iterIntrinsic_I->second.get());
-    const Pinhole* camJ = dynamic_cast<const Pinhole*>(iterIntrinsic_J->second.get());
-    if (camI == nullptr || camJ == nullptr)
-      continue;
+    const std::size_t batchEnd = std::min(batchBegin + batchSize, candidatePairs.size());
 
-    aliceVision::track::TracksMap map_tracksCommon;
-    const std::set<size_t> set_imageIndex= {I, J};
-    track::getCommonTracksInImagesFast(set_imageIndex, _map_tracks, _map_tracksPerView, map_tracksCommon);
-
-    // Copy points correspondences to arrays for relative pose estimation
-    const size_t n = map_tracksCommon.size();
-    ALICEVISION_LOG_DEBUG("Automatic initial pair choice test - I: " << I << ", J: " << J << ", common tracks: " << n);
-    Mat xI(2,n), xJ(2,n);
-    size_t cptIndex = 0;
-    std::vector<std::size_t> commonTracksIds(n);
-    for (aliceVision::track::TracksMap::const_iterator
-      iterT = map_tracksCommon.begin(); iterT != map_tracksCommon.end();
-      ++iterT, ++cptIndex)
+#pragma omp parallel for schedule(dynamic)
+    for (int i = static_cast<int>(batchBegin); i < static_cast<int>(batchEnd); ++i)
     {
-      auto iter = iterT->second.featPerView.begin();
-      const size_t i = iter->second;
-      const size_t j = (++iter)->second;
-      commonTracksIds[cptIndex] = iterT->first;
+#pragma omp critical
+      ++my_progress_bar;
+    
+      const Pair current_pair = candidatePairs[i].second;
+
+      const IndexT I = std::min(current_pair.first, current_pair.second);
+      const IndexT J = std::max(current_pair.first, current_pair.second);
+
+      const View* viewI = _sfmData.getViews().at(I).get();
+      const Intrinsics::const_iterator iterIntrinsic_I = _sfmData.getIntrinsics().find(viewI->getIntrinsicId());
+      const View* viewJ = _sfmData.getViews().at(J).get();
+      const Intrinsics::const_iterator iterIntrinsic_J = _sfmData.getIntrinsics().find(viewJ->getIntrinsicId());
+
+      const Pinhole* camI = dynamic_cast<const Pinhole*>(iterIntrinsic_I->second.get());
+      const Pinhole* camJ = dynamic_cast<const Pinhole*>(iterIntrinsic_J->second.get());
+
+      aliceVision::track::TracksMap map_tracksCommon;
+      const std::set<size_t> set_imageIndex= {I, J};
+      track::getCommonTracksInImagesFast(set_imageIndex, _map_tracks, _map_tracksPerView, map_tracksCommon);
+
+      // Copy points correspondences to arrays for relative pose estimation
+      const size_t n = map_tracksCommon.size();
+      ALICEVISION_LOG_DEBUG("Automatic initial pair choice test - I: " << I << ", J: " << J << ", common tracks: " << n);
+      Mat xI(2,n), xJ(2,n);
+      size_t cptIndex = 0;
+      std::vector<std::size_t> commonTracksIds(n);
+      for (aliceVision::track::TracksMap::const_iterator
+        iterT = map_tracksCommon.begin(); iterT != map_tracksCommon.end();
+        ++iterT, ++cptIndex)
+      {
+        auto iter = iterT->second.featPerView.begin();
+        const size_t i = iter->second;
+        const size_t j = (++iter)->second;
+        commonTracksIds[cptIndex] = iterT->first;
       
-      const auto& viewI = _featuresPerView->getFeatures(I, iterT->second.descType); 
-      const auto& viewJ = _featuresPerView->getFeatures(J, iterT->second.descType);
+        const auto& viewI = _featuresPerView->getFeatures(I, iterT->second.descType); 
+        const auto& viewJ = _featuresPerView->getFeatures(J, iterT->second.descType);
       
-      Vec2 feat = viewI[i].coords().cast<double>();
-      xI.col(cptIndex) = camI->get_ud_pixel(feat);
-      feat = viewJ[j].coords().cast<double>();
-      xJ.col(cptIndex) = camJ->get_ud_pixel(feat);
-    }
+        Vec2 feat = viewI[i].coords().cast<double>();
+        xI.col(cptIndex) = camI->get_ud_pixel(feat);
+        feat = viewJ[j].coords().cast<double>();
+        xJ.col(cptIndex) = camJ->get_ud_pixel(feat);
+      }
     
-    // Robust estimation of the relative pose
-    RelativePoseInfo relativePose_info;
-    relativePose_info.initial_residual_tolerance = Square(4.0);
+      // Robust estimation of the relative pose
+      RelativePoseInfo relativePose_info;
+      relativePose_info.initial_residual_tolerance = Square(4.0);
     
-    const bool relativePoseSuccess = robustRelativePose(
-          camI->K(), camJ->K(),
-          xI, xJ, _randomNumberGenerator, relativePose_info,
-          std::make_pair(camI->w(), camI->h()), std::make_pair(camJ->w(), camJ->h()),
-          1024);
+      const bool relativePoseSuccess = robustRelativePose(
+            camI->K(), camJ->K(),
+            xI, xJ, _randomNumberGenerator, relativePose_info,
+            std::make_pair(camI->w(), camI->h()), std::make_pair(camJ->w(), camJ->h()),
+            1024);
     
-    if (relativePoseSuccess && relativePose_info.vec_inliers.size() > iMin_inliers_count)
-    {
-      // Triangulate inliers & compute angle between bearing vectors
-      std::vector<float> vec_angles(relativePose_info.vec_inliers.size());
-      std::vector<std::size_t> validCommonTracksIds(relativePose_info.vec_inliers.size());
-      const Pose3 pose_I = Pose3(Mat3::Identity(), Vec3::Zero());
-      const Pose3 pose_J = relativePose_info.relativePose;
-      const Mat34 PI = camI->getProjectiveEquivalent(pose_I);
-      const Mat34 PJ = camJ->getProjectiveEquivalent(pose_J);
-      std::size_t i = 0;
-      for (const size_t inlier_idx: relativePose_info.vec_inliers)
+      if (relativePoseSuccess && relativePose_info.vec_inliers.size() > iMin_inliers_count)
       {
-        Vec3 X;
-        multiview::TriangulateDLT(PI, xI.col(inlier_idx), PJ, xJ.col(inlier_idx), &X);
-        IndexT trackId = commonTracksIds[inlier_idx];
-        auto iter = map_tracksCommon[trackId].featPerView.begin();
-        const Vec2 featI = _featuresPerView->getFeatures(I, map_tracksCommon[trackId].descType)[iter->second].coords().cast<double>();
-        const Vec2 featJ = _featuresPerView->getFeatures(J, map_tracksCommon[trackId].descType)[(++iter)->second].coords().cast<double>();
-        vec_angles[i] = angleBetweenRays(pose_I, camI, pose_J, camJ, featI, featJ);
-        validCommonTracksIds[i] = trackId;
-        ++i;
+        // Triangulate inliers & compute angle between bearing vectors
+        std::vector<float> vec_angles(relativePose_info.vec_inliers.size());
+        std::vector<std::size_t> validCommonTracksIds(relativePose_info.vec_inliers.size());
+        const Pose3 pose_I = Pose3(Mat3::Identity(), Vec3::Zero());
+        const Pose3 pose_J = relativePose_info.relativePose;
+        const Mat34 PI = camI->getProjectiveEquivalent(pose_I);
+        const Mat34 PJ = camJ->getProjectiveEquivalent(pose_J);
+        std::size_t i = 0;
+        for (const size_t inlier_idx: relativePose_info.vec_inliers)
+        {
+          Vec3 X;
+          multiview::TriangulateDLT(PI, xI.col(inlier_idx), PJ, xJ.col(inlier_idx), &X);
+          IndexT trackId = commonTracksIds[inlier_idx];
+          auto iter = map_tracksCommon[trackId].featPerView.begin();
+          const Vec2 featI = _featuresPerView->getFeatures(I, map_tracksCommon[trackId].descType)[iter->second].coords().cast<double>();
+          const Vec2 featJ = _featuresPerView->getFeatures(J, map_tracksCommon[trackId].descType)[(++iter)->second].coords().cast<double>();
+          vec_angles[i] = angleBetweenRays(pose_I, camI, pose_J, camJ, featI, featJ);
+          validCommonTracksIds[i] = trackId;
+          ++i;
+        }
+        // Compute the median triangulation angle
+        const unsigned median_index = vec_angles.size() / 2;
+        std::nth_element(
+              vec_angles.begin(),
+              vec_angles.begin() + median_index,
+              vec_angles.end());
+        const float scoring_angle = vec_angles[median_index];
+        const double imagePairScore = std::min(computeCandidateImageScore(I, validCommonTracksIds), computeCandidateImageScore(J, validCommonTracksIds));
+        double score = scoring_angle * imagePairScore;
+
+        // If the image pair is outside the reasonable angle range: [fRequired_min_angle;fLimit_max_angle]
+        // we put it in negative to ensure that image pairs with reasonable angle will win,
+        // but keep the score ordering.
+        if (scoring_angle < fRequired_min_angle ||
+            scoring_angle > fLimit_max_angle)
+          score = - 1.0 / score;
+
+        #pragma omp critical
+        {
+          bestImagePairs.emplace_back(score, imagePairScore, scoring_angle, relativePose_info.vec_inliers.size(), current_pair);
+          if (score > bestValidScore)
+            bestValidScore = score;
+        }
       }
-      // Compute the median triangulation angle
-      const unsigned median_index = vec_angles.size() / 2;
-      std::nth_element(
-            vec_angles.begin(),
-            vec_angles.begin() + median_index,
-            vec_angles.end());
-      const float scoring_angle = vec_angles[median_index];
-      const double imagePairScore = std::min(computeCandidateImageScore(I, validCommonTracksIds), computeCandidateImageScore(J, validCommonTracksIds));
-      double score = scoring_angle * imagePairScore;
-
-      // If the image pair is outside the reasonable angle range: [fRequired_min_angle;fLimit_max_angle]
-      // we put it in negative to ensure that image pairs with reasonable angle will win,
-      // but keep the score ordering.
-      if (scoring_angle < fRequired_min_angle ||
-          scoring_angle > fLimit_max_angle)
-        score = - 1.0 / score;
-
-      #pragma omp critical
-      bestImagePairs.emplace_back(score, imagePairScore, scoring_angle, relativePose_info.vec_inliers.size(), current_pair);
     }
+    batchBegin = batchEnd;
   }
   // We print the N best scores and return the best one.
   const std::size_t nBestScores = std::min(std::size_t(50), bestImagePairs.size());
@@ -1681,159 +1798,195 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
                  std::inserter(setTracksId, setTracksId.begin()),
                  stl::RetrieveKey());
 
-#pragma omp parallel for 
-  for (int i = 0; i < setTracksId.size(); i++) // each track (already reconstructed or not)
+  // projective matrices of the reconstructed views, computed once for all the tracks
+  struct ViewProjection
   {
-    const IndexT trackId = setTracksId.at(i);
-    bool isValidTrack = true;
-    const track::Track& track = _map_tracks.at(trackId);
-    std::set<IndexT>& observations = mapTracksToTriangulate.at(trackId); // all the posed views possessing the track
-    
-    // The track needs to be seen by a min. number of views to be triangulated
-    if (observations.size() < _params.minNbObservationsForTriangulation)
+    Mat34 P;
+    Pose3 pose;
+    const camera::IntrinsicBase* intrinsic;
+  };
+  HashMap<IndexT, ViewProjection> viewProjections;
+  for(const auto& viewPair : scene.getViews())
+  {
+    const View& view = *viewPair.second;
+    if(!scene.isPoseAndIntrinsicDefined(&view))
       continue;
-    
-    Vec3 X_euclidean = Vec3::Zero();
-    std::set<IndexT> inliers;
-    
-    if (observations.size() == 2) 
-    {
-      /* --------------------------------------------
-       *    2 observations : triangulation using DLT
-       * -------------------------------------------- */ 
-       
-      inliers = observations;
-      
-      // -- Prepare:
-      IndexT I =  *(observations.begin());
-      IndexT J =  *(observations.rbegin());
-      const View* viewI = scene.getViews().at(I).get();
-      const View* viewJ = scene.getViews().at(J).get();
 
-      std::shared_ptr<camera::IntrinsicBase> camI = scene.getIntrinsics().at(viewI->getIntrinsicId());
-      std::shared_ptr<camera::Pinhole> camIPinHole = std::dynamic_pointer_cast<camera::Pinhole>(camI);
-      if (!camIPinHole) {
-        ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulate_multiViewsLORANSAC");
-        continue;
-      }
+    const camera::IntrinsicBase* cam = scene.getIntrinsics().at(view.getIntrinsicId()).get();
+    const camera::Pinhole* camPinHole = dynamic_cast<const camera::Pinhole*>(cam);
+    if (!camPinHole) {
+      ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulate_multiViewsLORANSAC");
+      continue;
+    }
 
-      std::shared_ptr<camera::IntrinsicBase> camJ = scene.getIntrinsics().at(viewJ->getIntrinsicId());
-      std::shared_ptr<camera::Pinhole> camJPinHole = std::dynamic_pointer_cast<camera::Pinhole>(camJ);
-      if (!camJPinHole) {
-        ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulate_multiViewsLORANSAC");
-        continue;
-      }
+    // the pose is copied: getPose() returns the camera pose by value
+    const Pose3 pose = scene.getPose(view).getTransform();
+    viewProjections[viewPair.first] = ViewProjection{camPinHole->getProjectiveEquivalent(pose), pose, cam};
+  }
 
-      const Pose3 poseI = scene.getPose(*viewI).getTransform();
-      const Pose3 poseJ = scene.getPose(*viewJ).getTransform();
-      const Vec2 xI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I)].coords().cast<double>();
-      const Vec2 xJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J)].coords().cast<double>();
-  
-      // -- Triangulate:
-      multiview::TriangulateDLT(camIPinHole->getProjectiveEquivalent(poseI),
-                     camI->get_ud_pixel(xI),
-                     camJPinHole->getProjectiveEquivalent(poseJ),
-                     camI->get_ud_pixel(xJ),
-                     &X_euclidean);
-
-      // -- Check:
-      //  - angle (small angle leads imprecise triangulation)
-      //  - positive depth
-      //  - residual values
-      // TODO assert(acThresholdIt != _map_ACThreshold.end());
-      const auto& acThresholdItI = _map_ACThreshold.find(I);
-      const auto& acThresholdItJ = _map_ACThreshold.find(J);
-      const double& acThresholdI = (acThresholdItI != _map_ACThreshold.end()) ? acThresholdItI->second : 4.0;
-      const double& acThresholdJ = (acThresholdItJ != _map_ACThreshold.end()) ? acThresholdItJ->second : 4.0;
-      
-      if (angleBetweenRays(poseI, camI.get(), poseJ, camJ.get(), xI, xJ) < _params.minAngleForTriangulation ||
-          poseI.depth(X_euclidean) < 0 || 
-          poseJ.depth(X_euclidean) < 0 || 
-          camI->residual(poseI, X_euclidean.homogeneous(), xI).norm() > acThresholdI || 
-          camJ->residual(poseJ, X_euclidean.homogeneous(), xJ).norm() > acThresholdJ)
-        isValidTrack = false;
-    }
-    else 
+  // each chunk of tracks has its own random generator, seeded in order:
+  // the result does not depend on the number of threads
+  const std::size_t tracksPerChunk = 256;
+  const int nbChunks = static_cast<int>((setTracksId.size() + tracksPerChunk - 1) / tracksPerChunk);
+  std::vector<std::mt19937::result_type> chunkSeeds(nbChunks);
+  for(auto& seed : chunkSeeds)
+    seed = _randomNumberGenerator();
+
+  // each thread collects its triangulated and rejected tracks,
+  // the scene structure is only updated after the parallel section
+  std::vector<std::vector<std::pair<IndexT, Landmark>>> newLandmarksPerThread(omp_get_max_threads());
+  std::vector<std::vector<IndexT>> rejectedTracksPerThread(omp_get_max_threads());
+
+#pragma omp parallel
+  {
+    std::vector<std::pair<IndexT, Landmark>>& newLandmarks = newLandmarksPerThread.at(omp_get_thread_num());
+    std::vector<IndexT>& rejectedTracks = rejectedTracksPerThread.at(omp_get_thread_num());
+    Mat2X features; // undistorted 2D features (one per pose)
+    std::vector<Mat34> Ps; // projective matrices (one per pose)
+    std::vector<std::size_t> inliersIndex;
+
+#pragma omp for schedule(dynamic)
+    for (int chunk = 0; chunk < nbChunks; ++chunk)
     {
-      /* -------------------------------------------------------
-       *    N obsevations (N>2) : triangulation using LORANSAC 
-       * ------------------------------------------------------- */ 
-     
-      // -- Prepare:
-      Mat2X features(2, observations.size()); // undistorted 2D features (one per pose)
-      std::vector<Mat34> Ps; // projective matrices (one per pose)
+      const std::size_t chunkEnd = std::min((chunk + 1) * tracksPerChunk, setTracksId.size());
+      std::mt19937 generator(chunkSeeds[chunk]);
+
+      for (std::size_t i = chunk * tracksPerChunk; i < chunkEnd; ++i) // each track (already reconstructed or not)
       {
+        const IndexT trackId = setTracksId.at(i);
+        bool isValidTrack = true;
         const track::Track& track = _map_tracks.at(trackId);
-        
-        int i = 0;
-        for (const IndexT& viewId : observations)
+        const std::set<IndexT>& observations = mapTracksToTriangulate.at(trackId); // all the posed views possessing the track
+    
+        // The track needs to be seen by a min. number of views to be triangulated
+        if (observations.size() < _params.minNbObservationsForTriangulation)
+          continue;
+    
+        Vec3 X_euclidean = Vec3::Zero();
+        std::set<IndexT> inliers;
+    
+        if (observations.size() == 2) 
         {
-          const View* view = scene.getViews().at(viewId).get();
-  
-          std::shared_ptr<camera::IntrinsicBase> cam = scene.getIntrinsics().at(view->getIntrinsicId());
-          std::shared_ptr<camera::Pinhole> camPinHole = std::dynamic_pointer_cast<camera::Pinhole>(cam);
-          if (!camPinHole) {
-            ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulate_multiViewsLORANSAC");
+          /* --------------------------------------------
+           *    2 observations : triangulation using DLT
+           * -------------------------------------------- */ 
+       
+          inliers = observations;
+      
+          // -- Prepare:
+          IndexT I =  *(observations.begin());
+          IndexT J =  *(observations.rbegin());
+          const auto viewProjectionItI = viewProjections.find(I);
+          const auto viewProjectionItJ = viewProjections.find(J);
+          if (viewProjectionItI == viewProjections.end() || viewProjectionItJ == viewProjections.end())
             continue;
-          }
 
-          const Vec2 x_ud = cam->get_ud_pixel(_featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>()); // undistorted 2D point
-          features(0,i) = x_ud(0); 
-          features(1,i) = x_ud(1);  
-          Ps.push_back(camPinHole->getProjectiveEquivalent(scene.getPose(*view).getTransform()));
-          i++;
+          const ViewProjection& viewI = viewProjectionItI->second;
+          const ViewProjection& viewJ = viewProjectionItJ->second;
+          const Vec2 xI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I)].coords().cast<double>();
+          const Vec2 xJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J)].coords().cast<double>();
+  
+          // -- Triangulate:
+          multiview::TriangulateDLT(viewI.P,
+                         viewI.intrinsic->get_ud_pixel(xI),
+                         viewJ.P,
+                         viewJ.intrinsic->get_ud_pixel(xJ),
+                         &X_euclidean);
+
+          // -- Check:
+          //  - angle (small angle leads imprecise triangulation)
+          //  - positive depth
+          //  - residual values
+          // TODO assert(acThresholdIt != _map_ACThreshold.end());
+          const auto& acThresholdItI = _map_ACThreshold.find(I);
+          const auto& acThresholdItJ = _map_ACThreshold.find(J);
+          const double& acThresholdI = (acThresholdItI != _map_ACThreshold.end()) ? acThresholdItI->second : 4.0;
+          const double& acThresholdJ = (acThresholdItJ != _map_ACThreshold.end()) ? acThresholdItJ->second : 4.0;
+      
+          if (angleBetweenRays(viewI.pose, viewI.intrinsic, viewJ.pose, viewJ.intrinsic, xI, xJ) < _params.minAngleForTriangulation ||
+              viewI.pose.depth(X_euclidean) < 0 || 
+              viewJ.pose.depth(X_euclidean) < 0 || 
+              viewI.intrinsic->residual(viewI.pose, X_euclidean.homogeneous(), xI).norm() > acThresholdI || 
+              viewJ.intrinsic->residual(viewJ.pose, X_euclidean.homogeneous(), xJ).norm() > acThresholdJ)
+            isValidTrack = false;
         }
-      }
+        else 
+        {
+          /* -------------------------------------------------------
+           *    N obsevations (N>2) : triangulation using LORANSAC 
+           * ------------------------------------------------------- */ 
+     
+          // -- Prepare:
+          features.resize(2, observations.size());
+          Ps.clear();
+          {
+            for (const IndexT& viewId : observations)
+            {
+              const auto viewProjectionIt = viewProjections.find(viewId);
+              if (viewProjectionIt == viewProjections.end())
+                continue;
+
+              const Vec2 x_ud = viewProjectionIt->second.intrinsic->get_ud_pixel(_featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>()); // undistorted 2D point
+              features.col(Ps.size()) = x_ud;
+              Ps.push_back(viewProjectionIt->second.P);
+            }
+          }
+          features.conservativeResize(2, Ps.size());
       
-      // -- Triangulate: 
-      Vec4 X_homogeneous = Vec4::Zero();
-      std::vector<std::size_t> inliersIndex;
+          // -- Triangulate: 
+          Vec4 X_homogeneous = Vec4::Zero();
+          inliersIndex.clear();
       
-      multiview::TriangulateNViewLORANSAC(features, Ps, _randomNumberGenerator, &X_homogeneous, &inliersIndex, 8.0);
+          multiview::TriangulateNViewLORANSAC(features, Ps, generator, &X_homogeneous, &inliersIndex, 8.0);
       
-      homogeneousToEuclidean(X_homogeneous, &X_euclidean);     
+          homogeneousToEuclidean(X_homogeneous, &X_euclidean);     
       
-      // observations = {350, 380, 442} | inliersIndex = [0, 1] | inliers = {350, 380}
-      for (const auto & id : inliersIndex)
-        inliers.insert(*std::next(observations.begin(), id));
-
-      // -- Check:
-      //  - nb of cameras validing the track 
-      //  - angle (small angle leads imprecise triangulation)
-      //  - positive depth (chierality)
-      if (inliers.size() < _params.minNbObservationsForTriangulation ||
-          !checkAngles(X_euclidean, inliers, scene, _params.minAngleForTriangulation) ||
-          !checkChieralities(X_euclidean, inliers, scene))
-        isValidTrack = false;
-    }  
-
-    // -- Add the tringulated point to the scene
-    if (isValidTrack)
-    {
-      Landmark landmark;
-      landmark.X = X_euclidean;
-      landmark.descType = track.descType;
-      for (const IndexT & viewId : inliers) // add inliers as observations
-      {
-        const Vec2 x = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)].coords().cast<double>();
-        const feature::PointFeature& p = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)];
-        const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : p.scale();
-        landmark.observations[viewId] = Observation(x, track.featPerView.at(viewId), scale);
-      }
-#pragma omp critical
-      {
-        scene.structure[trackId] = landmark;
-      }      
-    }
-    else
-    {
-#pragma omp critical
-      {
-        if (scene.structure.find(trackId) != scene.structure.end()) 
-          scene.structure.erase(trackId);
-      }
-    }
-  } // for all shared tracks 
+          // observations = {350, 380, 442} | inliersIndex = [0, 1] | inliers = {350, 380}
+          for (const auto & id : inliersIndex)
+            inliers.insert(*std::next(observations.begin(), id));
+
+          // -- Check:
+          //  - nb of cameras validing the track 
+          //  - angle (small angle leads imprecise triangulation)
+          //  - positive depth (chierality)
+          if (inliers.size() < _params.minNbObservationsForTriangulation ||
+              !checkAngles(X_euclidean, inliers, scene, _params.minAngleForTriangulation) ||
+              !checkChieralities(X_euclidean, inliers, scene))
+            isValidTrack = false;
+        }  
+
+        // -- Add the tringulated point to the scene
+        if (isValidTrack)
+        {
+          newLandmarks.emplace_back(trackId, Landmark(track.descType));
+          Landmark& landmark = newLandmarks.back().second;
+          landmark.X = X_euclidean;
+          for (const IndexT & viewId : inliers) // add inliers as observations
+          {
+            const feature::PointFeature& p = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId)];
+            const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : p.scale();
+            landmark.observations[viewId] = Observation(p.coords().cast<double>(), track.featPerView.at(viewId), scale);
+          }
+        }
+        else
+        {
+          rejectedTracks.push_back(trackId);
+        }
+      } // for all tracks of the chunk
+    } // for all chunks
+  }
+
+  // merge the results of all the threads in the scene
+  for (auto& newLandmarks : newLandmarksPerThread)
+  {
+    for (auto& newLandmark : newLandmarks)
+      scene.structure[newLandmark.first] = std::move(newLandmark.second);
+  }
+  for (const auto& rejectedTracks : rejectedTracksPerThread)
+  {
+    for (IndexT trackId : rejectedTracks)
+      scene.structure.erase(trackId);
+  }
 }
 
 void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, const std::set<IndexT>& previousReconstructedViews, const std::set<IndexT>& newReconstructedViews)
@@ -13,6 +13,7 @@
 #include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
 #include <aliceVision/sfm/pipeline/RigSequence.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfmDataIO/checkpointIO.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
 #include <aliceVision/track/TracksBuilder.hpp>
 #include <dependencies/htmlDoc/htmlDoc.hpp>
@@ -60,6 +61,12 @@ public:
     EFeatureConstraint featureConstraint = EFeatureConstraint::BASIC;
     float minAngleInitialPair = 5.0f;
     float maxAngleInitialPair = 40.0f;
+    /// maximum number of initial pair candidates evaluated with a robust relative pose,
+    /// candidates are ranked by the pyramid score of their common tracks ( 0 = no limit )
+    std::size_t initialPairMaxCandidates = 0;
+    /// stop the initial pair search when the best score reaches this ratio of the best score
+    /// the remaining candidates could reach ( 1 = same result as the full search, 0 = disabled )
+    double initialPairEarlyStopRatio = 1.0;
     bool filterTrackForks = true;
     robustEstimation::ERobustEstimator localizerEstimator = robustEstimation::ERobustEstimator::ACRANSAC;
     double localizerEstimatorError = std::numeric_limits<double>::infinity();
@@ -86,6 +93,12 @@ public:
       sfmDataIO::STRUCTURE |
       sfmDataIO::OBSERVATIONS |
       sfmDataIO::CONTROL_POINTS);
+
+    // Checkpoints
+    /// append-only log of the scene changes after each resection group ( "" = disabled )
+    std::string checkpointFilepath;
+    /// replay the checkpoint log and restart from its last checkpoint
+    bool resumeFromCheckpoint = false;
   };
 
 public:
@@ -189,6 +202,12 @@ public:
    */
   void calibrateRigs(std::set<IndexT>& updatedViews);
 
+  /**
+   * @brief Append the scene changes to the checkpoint log, if enabled.
+   * @param[in] resectionId The id of the last completed resection group
+   */
+  void saveCheckpoint(IndexT resectionId);
+
   /**
    * @brief Return all the images containing matches with already reconstructed 3D points.
    * The images are sorted by a score based on the number of features id shared with
@@ -375,6 +394,8 @@ private:
 
   /// sfm intermediate reconstruction files
   const std::string _sfmStepFolder;
+  /// scene changes log, to resume an interrupted reconstruction
+  sfmDataIO::CheckpointLog _checkpointLog;
 
   /// HTML logger
   std::shared_ptr<htmlDocument::htmlDocumentStream> _htmlDocStream;
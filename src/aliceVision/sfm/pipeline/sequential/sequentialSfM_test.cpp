@@ -194,3 +194,81 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Known_Rig)
   BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), nbPoints);
 }
 
+
+// Test the resume from a checkpoint log of a scene with already reconstructed landmarks
+BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Resume_Known_Landmarks)
+{
+  const int nviews = 6;
+  const int npoints = 128;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene
+  const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+  // Keep the poses of the first views and the landmarks seen by them,
+  // with landmark ids that do not correspond to the track ids
+  const IndexT nbKnownViews = 3;
+  SfMData sfmData2 = sfmData;
+  sfmData2.getPoses().clear();
+  sfmData2.structure.clear();
+  for(IndexT viewId = 0; viewId < nbKnownViews; ++viewId)
+    sfmData2.setPose(sfmData.getView(viewId), sfmData.getAbsolutePose(viewId));
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    Landmark landmark = landmarkPair.second;
+    for(IndexT viewId = nbKnownViews; viewId < nviews; ++viewId)
+      landmark.observations.erase(viewId);
+    sfmData2.structure[10 * npoints + landmarkPair.first] = landmark;
+  }
+
+  ReconstructionEngine_sequentialSfM::Params sfmParams;
+  sfmParams.lockAllIntrinsics = true;
+  sfmParams.checkpointFilepath = "./sequentialSfM_resume_test.checkpoint";
+
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+
+  // Configure the featuresPerView & the matches_provider from the synthetic dataset
+  feature::FeaturesPerView featuresPerView;
+  generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+  matching::PairwiseMatches pairwiseMatches;
+  generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+  // Reconstruction with a checkpoint log
+  ReconstructionEngine_sequentialSfM sfmEngine(
+    sfmData2,
+    sfmParams,
+    "./",
+    "./Reconstruction_Report.html");
+
+  sfmEngine.setFeatures(&featuresPerView);
+  sfmEngine.setMatches(&pairwiseMatches);
+
+  BOOST_CHECK (sfmEngine.process());
+  BOOST_CHECK_EQUAL(nviews, sfmEngine.getSfMData().getPoses().size());
+  BOOST_CHECK_EQUAL(npoints, sfmEngine.getSfMData().getLandmarks().size());
+
+  // Resume from the checkpoint log, on the same input scene
+  sfmParams.resumeFromCheckpoint = true;
+  ReconstructionEngine_sequentialSfM resumedSfmEngine(
+    sfmData2,
+    sfmParams,
+    "./",
+    "./Reconstruction_Report.html");
+
+  resumedSfmEngine.setFeatures(&featuresPerView);
+  resumedSfmEngine.setMatches(&pairwiseMatches);
+
+  BOOST_CHECK (resumedSfmEngine.process());
+
+  const SfMData& finalSfMData = sfmEngine.getSfMData();
+  const SfMData& resumedSfMData = resumedSfmEngine.getSfMData();
+  BOOST_CHECK_EQUAL(finalSfMData.getPoses().size(), resumedSfMData.getPoses().size());
+  BOOST_CHECK_EQUAL(finalSfMData.getLandmarks().size(), resumedSfMData.getLandmarks().size());
+  for(const auto& landmarkPair : finalSfMData.getLandmarks())
+    BOOST_CHECK(resumedSfMData.getLandmarks().count(landmarkPair.first) == 1);
+
+  std::remove(sfmParams.checkpointFilepath.c_str());
+}
@@ -25,6 +25,8 @@
 #include <aliceVision/sfm/pipeline/RelativePoseInfo.hpp>
 #include <aliceVision/sfm/pipeline/global/reindexGlobalSfM.hpp>
 #include <aliceVision/sfm/pipeline/global/ReconstructionEngine_globalSfM.hpp>
+#include <aliceVision/sfm/pipeline/hierarchical/ReconstructionEngine_hierarchicalSfM.hpp>
+#include <aliceVision/sfm/pipeline/hierarchical/viewGraphPartition.hpp>
 #include <aliceVision/sfm/pipeline/panorama/ReconstructionEngine_panorama.hpp>
 #include <aliceVision/sfm/pipeline/sequential/ReconstructionEngine_sequentialSfM.hpp>
 #include <aliceVision/sfm/pipeline/structureFromKnownPoses/StructureEstimationFromKnownPoses.hpp>
@@ -12,6 +12,8 @@
 #include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
 #include <aliceVision/track/TracksBuilder.hpp>
 
+#include <map>
+
 
 namespace aliceVision {
 namespace sfm {
@@ -33,6 +35,8 @@ void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>
   std::vector<double> vec_residuals;
   vec_residuals.reserve(sfmData.structure.size());
 
+  // Group the observations per view to compute the residuals of each view in a single batch
+  std::map<IndexT, std::vector<std::pair<const Vec3*, const Vec2*>>> observationsPerView;
   for(const auto &track : sfmData.getLandmarks())
   {
     const aliceVision::sfmData::Observations & observations = track.second.observations;
@@ -43,15 +47,30 @@ void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>
           if(specificViews.count(obs.first) == 0)
               continue;
       }
-      const sfmData::View& view = sfmData.getView(obs.first);
-      const aliceVision::geometry::Pose3 pose = sfmData.getPose(view).getTransform();
-      const std::shared_ptr<aliceVision::camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().find(view.getIntrinsicId())->second;
-      const Vec2 residual = intrinsic->residual(pose, track.second.X.homogeneous(), obs.second.x);
-      vec_residuals.push_back(residual.norm());
-      //ALICEVISION_LOG_INFO("[AliceVision] sfmtstatistics::computeResidualsHistogram track: " << track.first << ", residual: " << residual.norm());
+      observationsPerView[obs.first].emplace_back(&track.second.X, &obs.second.x);
     }
   }
 
+  for(const auto& viewObservations : observationsPerView)
+  {
+    const sfmData::View& view = sfmData.getView(viewObservations.first);
+    const aliceVision::geometry::Pose3 pose = sfmData.getPose(view).getTransform();
+    const std::shared_ptr<aliceVision::camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().find(view.getIntrinsicId())->second;
+
+    const std::size_t nbObservations = viewObservations.second.size();
+    Mat3X X(3, nbObservations);
+    Mat2X x(2, nbObservations);
+    for(std::size_t i = 0; i < nbObservations; ++i)
+    {
+      X.col(i) = *viewObservations.second[i].first;
+      x.col(i) = *viewObservations.second[i].second;
+    }
+
+    const Mat2X residuals = intrinsic->residuals(pose, X, x);
+    for(std::size_t i = 0; i < nbObservations; ++i)
+      vec_residuals.push_back(residuals.col(i).norm());
+  }
+
  // ALICEVISION_LOG_INFO("[AliceVision] sfmtstatistics::computeResidualsHistogram vec_residuals.size(): " << vec_residuals.size());
 
   if(vec_residuals.empty())
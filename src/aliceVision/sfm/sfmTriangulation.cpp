@@ -9,10 +9,11 @@
 #include <aliceVision/multiview/triangulation/Triangulation.hpp>
 #include <aliceVision/robustEstimation/randSampling.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/progress.hpp>
 
-#include <deque>
+#include <algorithm>
 #include <memory>
 
 namespace aliceVision {
@@ -21,6 +22,9 @@ namespace sfm {
 using namespace aliceVision::geometry;
 using namespace aliceVision::camera;
 
+/// number of landmarks triangulated together by a thread
+static const std::size_t landmarksPerChunk = 1024;
+
 StructureComputation_basis::StructureComputation_basis(bool verbose)
   : _bConsoleVerbose(verbose)
 {}
@@ -31,75 +35,109 @@ StructureComputation_blind::StructureComputation_blind(bool verbose)
 
 void StructureComputation_blind::triangulate(sfmData::SfMData& sfmData, std::mt19937 & randomNumberGenerator) const
 {
-  std::deque<IndexT> rejectedId;
+  // projective matrices of the views with a pose and a pinhole intrinsic, computed once for all the landmarks
+  std::vector<Mat34> Ps;
+  std::vector<const IntrinsicBase*> intrinsics;
+  HashMap<IndexT, std::size_t> cameraIndexPerView;
+
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const sfmData::View& view = *viewPair.second;
+    if(!sfmData.isPoseAndIntrinsicDefined(&view))
+      continue;
+
+    const IntrinsicBase* cam = sfmData.getIntrinsics().at(view.getIntrinsicId()).get();
+    const camera::Pinhole* pinHoleCam = dynamic_cast<const camera::Pinhole*>(cam);
+    if (!pinHoleCam) {
+      ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulate");
+      continue;
+    }
+
+    cameraIndexPerView[viewPair.first] = Ps.size();
+    Ps.push_back(pinHoleCam->getProjectiveEquivalent(sfmData.getPose(view).getTransform()));
+    intrinsics.push_back(cam);
+  }
+
+  std::vector<std::pair<IndexT, sfmData::Landmark*>> landmarks;
+  landmarks.reserve(sfmData.structure.size());
+  for(auto& landmarkPair : sfmData.structure)
+    landmarks.emplace_back(landmarkPair.first, &landmarkPair.second);
+
   std::unique_ptr<boost::progress_display> my_progress_bar;
   if (_bConsoleVerbose)
     my_progress_bar.reset( new boost::progress_display(
-    sfmData.structure.size(),
+    landmarks.size(),
     std::cout,
     "Blind triangulation progress:\n" ));
+
+  // each thread triangulates chunks of landmarks and collects its rejected landmarks,
+  // the landmarks are only erased after the parallel section
+  const int nbChunks = static_cast<int>((landmarks.size() + landmarksPerChunk - 1) / landmarksPerChunk);
+  std::vector<std::vector<IndexT>> rejectedIdPerThread(omp_get_max_threads());
+
   #pragma omp parallel
-  for(sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
-    iterTracks != sfmData.structure.end();
-    ++iterTracks)
   {
-    #pragma omp single nowait
+    std::vector<IndexT>& rejectedId = rejectedIdPerThread.at(omp_get_thread_num());
+    std::vector<std::size_t> cameraIndexes;
+    std::vector<std::size_t> offsets;
+    Mat2X x;
+    Mat3X X;
+    Vec minDepths;
+
+    #pragma omp for schedule(dynamic)
+    for(int chunk = 0; chunk < nbChunks; ++chunk)
     {
-      if (_bConsoleVerbose)
-      {
-        #pragma omp critical
-        ++(*my_progress_bar);
-      }
-      // Triangulate each landmark
-      multiview::Triangulation trianObj;
-      const sfmData::Observations & observations = iterTracks->second.observations;
-      for(const auto& itObs : observations)
+      const std::size_t begin = chunk * landmarksPerChunk;
+      const std::size_t end = std::min(begin + landmarksPerChunk, landmarks.size());
+
+      std::size_t nbObservations = 0;
+      for(std::size_t i = begin; i < end; ++i)
+        nbObservations += landmarks[i].second->observations.size();
+
+      cameraIndexes.clear();
+      offsets.assign(1, 0);
+      x.resize(2, nbObservations);
+
+      for(std::size_t i = begin; i < end; ++i)
       {
-        const sfmData::View * view = sfmData.views.at(itObs.first).get();
-        if (sfmData.isPoseAndIntrinsicDefined(view))
+        for(const auto& itObs : landmarks[i].second->observations)
         {
-          std::shared_ptr<IntrinsicBase> cam = sfmData.getIntrinsics().at(view->getIntrinsicId());
-          std::shared_ptr<camera::Pinhole> pinHoleCam = std::dynamic_pointer_cast<camera::Pinhole>(cam);
-          if (!pinHoleCam) {
-            ALICEVISION_LOG_ERROR("Camera is not pinhole in triangulate");
+          const auto cameraIndexIt = cameraIndexPerView.find(itObs.first);
+          if(cameraIndexIt == cameraIndexPerView.end())
             continue;
-          }
 
-          const Pose3 pose = sfmData.getPose(*view).getTransform();
-          trianObj.add(
-            pinHoleCam->getProjectiveEquivalent(pose),
-            cam->get_ud_pixel(itObs.second.x));
+          x.col(cameraIndexes.size()) = intrinsics[cameraIndexIt->second]->get_ud_pixel(itObs.second.x);
+          cameraIndexes.push_back(cameraIndexIt->second);
         }
+        offsets.push_back(cameraIndexes.size());
       }
-      if (trianObj.size() < 2)
+      x.conservativeResize(2, cameraIndexes.size());
+
+      // Triangulate each landmark
+      multiview::TriangulateNViewIterativeBatch(Ps, cameraIndexes, x, offsets, X, minDepths);
+
+      for(std::size_t i = begin; i < end; ++i)
       {
-        #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
+        const std::size_t k = i - begin;
+        if (minDepths(k) > 0) // Keep the point only if it have a positive depth
+          landmarks[i].second->X = X.col(k);
+        else
+          rejectedId.push_back(landmarks[i].first);
       }
-      else
+
+      if (_bConsoleVerbose)
       {
-        // Compute the 3D point
-        const Vec3 X = trianObj.compute();
-        if (trianObj.minDepth() > 0) // Keep the point only if it have a positive depth
-        {
-          iterTracks->second.X = X;
-        }
-        else
-        {
-          #pragma omp critical
-          {
-            rejectedId.push_front(iterTracks->first);
-          }
-        }
+        #pragma omp critical
+        (*my_progress_bar) += end - begin;
       }
     }
   }
+
   // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
+  for (const auto& rejectedId : rejectedIdPerThread)
   {
-    sfmData.structure.erase(it);
+    for (IndexT landmarkId : rejectedId)
+      sfmData.structure.erase(landmarkId);
   }
 }
 
@@ -117,42 +155,64 @@ void StructureComputation_robust::triangulate(sfmData::SfMData& sfmData, std::mt
 /// Invalid landmark are removed.
 void StructureComputation_robust::robust_triangulation(sfmData::SfMData& sfmData, std::mt19937 & randomNumberGenerator) const
 {
-  std::deque<IndexT> rejectedId;
+  std::vector<std::pair<IndexT, sfmData::Landmark*>> landmarks;
+  landmarks.reserve(sfmData.structure.size());
+  for(auto& landmarkPair : sfmData.structure)
+    landmarks.emplace_back(landmarkPair.first, &landmarkPair.second);
+
   std::unique_ptr<boost::progress_display> my_progress_bar;
   if(_bConsoleVerbose)
     my_progress_bar.reset( new boost::progress_display(
-    sfmData.structure.size(),
+    landmarks.size(),
     std::cout,
     "Robust triangulation progress:\n" ));
+
+  // one random generator per chunk of landmarks, seeded in order:
+  // the result does not depend on the number of threads
+  const int nbChunks = static_cast<int>((landmarks.size() + landmarksPerChunk - 1) / landmarksPerChunk);
+  std::vector<std::mt19937::result_type> chunkSeeds(nbChunks);
+  for(auto& seed : chunkSeeds)
+    seed = randomNumberGenerator();
+
+  std::vector<std::vector<IndexT>> rejectedIdPerThread(omp_get_max_threads());
+
   #pragma omp parallel
-  for(sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
-    iterTracks != sfmData.structure.end();
-    ++iterTracks)
   {
-    #pragma omp single nowait
+    std::vector<IndexT>& rejectedId = rejectedIdPerThread.at(omp_get_thread_num());
+
+    #pragma omp for schedule(dynamic)
+    for(int chunk = 0; chunk < nbChunks; ++chunk)
     {
-      if (_bConsoleVerbose)
+      const std::size_t begin = chunk * landmarksPerChunk;
+      const std::size_t end = std::min(begin + landmarksPerChunk, landmarks.size());
+      std::mt19937 generator(chunkSeeds[chunk]);
+
+      for(std::size_t i = begin; i < end; ++i)
       {
-        #pragma omp critical
-        ++(*my_progress_bar);
-      }
-      Vec3 X;
-      if (robust_triangulation(sfmData, iterTracks->second.observations, randomNumberGenerator, X)) {
-        iterTracks->second.X = X;
+        sfmData::Landmark& landmark = *landmarks[i].second;
+        Vec3 X;
+        if (robust_triangulation(sfmData, landmark.observations, generator, X)) {
+          landmark.X = X;
+        }
+        else {
+          landmark.X = Vec3::Zero();
+          rejectedId.push_back(landmarks[i].first);
+        }
       }
-      else {
-        iterTracks->second.X = Vec3::Zero();
+
+      if (_bConsoleVerbose)
+      {
         #pragma omp critical
-        {
-          rejectedId.push_front(iterTracks->first);
-        }
+        (*my_progress_bar) += end - begin;
       }
     }
   }
+
   // Erase the unsuccessful triangulated tracks
-  for(auto& it : rejectedId)
+  for(const auto& rejectedId : rejectedIdPerThread)
   {
-    sfmData.structure.erase(it);
+    for(IndexT landmarkId : rejectedId)
+      sfmData.structure.erase(landmarkId);
   }
 }
 
@@ -119,6 +119,72 @@ bool computeSimilarityFromCommonViews(const sfmData::SfMData& sfmDataA,
     return true;
 }
 
+bool computeSimilarityFromCommonCamerasAndLandmarks(
+    const sfmData::SfMData& sfmDataA,
+    const sfmData::SfMData& sfmDataB,
+    const std::vector<std::pair<IndexT, IndexT>>& commonViewIds,
+    const std::vector<std::pair<IndexT, IndexT>>& commonLandmarkIds,
+    std::mt19937 &randomNumberGenerator,
+    double* out_S,
+    Mat3* out_R,
+    Vec3* out_t)
+{
+    assert(out_S != nullptr);
+    assert(out_R != nullptr);
+    assert(out_t != nullptr);
+
+    std::vector<std::pair<IndexT, IndexT>> reconstructedCommonViewIds;
+    for (const auto& c : commonViewIds)
+    {
+        if (sfmDataA.isPoseAndIntrinsicDefined(c.first) && sfmDataB.isPoseAndIntrinsicDefined(c.second))
+        {
+            reconstructedCommonViewIds.emplace_back(c);
+        }
+    }
+
+    const std::size_t nbPoints = reconstructedCommonViewIds.size() + commonLandmarkIds.size();
+    if (nbPoints < 3)
+    {
+        ALICEVISION_LOG_WARNING("Cannot compute similarities with less than 3 common cameras and landmarks.");
+        return false;
+    }
+
+    // Move input point in appropriate container
+    Mat xA(3, nbPoints);
+    Mat xB(3, nbPoints);
+    std::size_t i = 0;
+    for (const auto& viewIdPair : reconstructedCommonViewIds)
+    {
+        xA.col(i) = sfmDataA.getPose(sfmDataA.getView(viewIdPair.first)).getTransform().center();
+        xB.col(i) = sfmDataB.getPose(sfmDataB.getView(viewIdPair.second)).getTransform().center();
+        ++i;
+    }
+    for (const auto& landmarkIdPair : commonLandmarkIds)
+    {
+        xA.col(i) = sfmDataA.getLandmarks().at(landmarkIdPair.first).X;
+        xB.col(i) = sfmDataB.getLandmarks().at(landmarkIdPair.second).X;
+        ++i;
+    }
+
+    // Compute rigid transformation p'i = S R pi + t
+    double S;
+    Vec3 t;
+    Mat3 R;
+    std::vector<std::size_t> inliers;
+
+    if (!aliceVision::geometry::ACRansac_FindRTS(xA, xB, randomNumberGenerator, S, t, R, inliers, true))
+        return false;
+
+    ALICEVISION_LOG_DEBUG("There are " << reconstructedCommonViewIds.size() << " common cameras, " << commonLandmarkIds.size()
+                          << " common landmarks and " << inliers.size() << " were used to compute the similarity transform.");
+
+    *out_S = S;
+    *out_R = R;
+    *out_t = t;
+
+    return true;
+}
+
 bool computeSimilarityFromCommonCameras_viewId(const sfmData::SfMData& sfmDataA,
                        const sfmData::SfMData& sfmDataB,
                        std::mt19937 &randomNumberGenerator,
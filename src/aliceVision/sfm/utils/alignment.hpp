@@ -110,6 +110,30 @@ bool computeSimilarityFromCommonCameras_poseId(
     Mat3* out_R,
     Vec3* out_t);
 
+/**
+ * @brief Compute a 7DOF similarity between two reconstructions of overlapping views,
+ *        from the centers of their common cameras and the positions of their common landmarks.
+ *
+ * @param[in] sfmDataA
+ * @param[in] sfmDataB
+ * @param[in] commonViewIds pairs of <viewIdA, viewIdB> of the same image
+ * @param[in] commonLandmarkIds pairs of <landmarkIdA, landmarkIdB> of the same 3D point
+ * @param[in] randomNumberGenerator random number generator
+ * @param[out] out_S output scale factor
+ * @param[out] out_R output rotation 3x3 matrix
+ * @param[out] out_t output translation vector
+ * @return true if it finds a similarity transformation
+ */
+bool computeSimilarityFromCommonCamerasAndLandmarks(
+    const sfmData::SfMData& sfmDataA,
+    const sfmData::SfMData& sfmDataB,
+    const std::vector<std::pair<IndexT, IndexT>>& commonViewIds,
+    const std::vector<std::pair<IndexT, IndexT>>& commonLandmarkIds,
+    std::mt19937 &randomNumberGenerator,
+    double* out_S,
+    Mat3* out_R,
+    Vec3* out_t);
+
 bool computeSimilarityFromCommonCameras_imageFileMatching(
     const sfmData::SfMData& sfmDataA,
     const sfmData::SfMData& sfmDataB,
@@ -0,0 +1,1039 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "binaryIO.hpp"
+#include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/property_tree/json_parser.hpp>
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <type_traits>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace {
+
+const char binaryMagic[8] = {'A', 'V', 'S', 'F', 'M', 'B', 'I', 'N'};
+
+/// number of landmarks per structure / control points block
+const std::size_t landmarksPerBlock = 65536;
+
+/// number of views per views block
+const std::size_t viewsPerBlock = 1024;
+
+/**
+ * @brief Binary file header, at the beginning of the file.
+ */
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t formatVersion;
+  std::uint32_t nbSections;
+  std::uint64_t sectionTableOffset;
+  std::int32_t version[3];  //< SfMData version (major, minor, revision)
+  std::uint32_t reserved;
+};
+
+/**
+ * @brief Section table entry, the section table is at the end of the file.
+ */
+struct SectionEntry
+{
+  std::uint32_t type;
+  std::uint32_t nbBlocks;
+  std::uint64_t blockTableOffset;
+};
+
+/**
+ * @brief Block table entry, each section has its own block table.
+ */
+struct BlockEntry
+{
+  std::uint64_t offset;
+  std::uint64_t storedSize;
+  std::uint64_t rawSize;
+  std::uint32_t nbItems;
+  std::uint32_t compression;
+};
+
+static_assert(sizeof(FileHeader) == 40, "Unexpected binary SfMData header size.");
+static_assert(sizeof(SectionEntry) == 16, "Unexpected binary SfMData section entry size.");
+static_assert(sizeof(BlockEntry) == 32, "Unexpected binary SfMData block entry size.");
+
+/**
+ * @brief A block ready to be written in the file.
+ */
+struct EncodedBlock
+{
+  std::vector<char> data;
+  std::uint64_t rawSize = 0;
+  std::uint32_t nbItems = 0;
+  EBinaryCompression compression = EBinaryCompression::NONE;
+};
+
+/**
+ * @brief Append arrays of trivially copyable values in a raw buffer.
+ */
+class BlockWriter
+{
+public:
+  template<typename T>
+  void write(const T* values, std::size_t count)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written.");
+    const std::size_t size = count * sizeof(T);
+    const std::size_t offset = _buffer.size();
+    _buffer.resize(offset + size);
+    if(size > 0)
+      std::memcpy(_buffer.data() + offset, values, size);
+  }
+
+  template<typename T>
+  void write(const std::vector<T>& values)
+  {
+    write(values.data(), values.size());
+  }
+
+  void write(const std::string& text)
+  {
+    write(text.data(), text.size());
+  }
+
+  std::vector<char>& buffer() { return _buffer; }
+
+private:
+  std::vector<char> _buffer;
+};
+
+/**
+ * @brief Read arrays of trivially copyable values from a raw buffer.
+ */
+class BlockReader
+{
+public:
+  explicit BlockReader(const std::vector<char>& buffer)
+    : _buffer(buffer)
+  {}
+
+  template<typename T>
+  void read(T* values, std::size_t count)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read.");
+    const std::size_t size = count * sizeof(T);
+    if(_offset + size > _buffer.size())
+      throw std::runtime_error("Truncated binary SfMData block.");
+    if(size > 0)
+      std::memcpy(values, _buffer.data() + _offset, size);
+    _offset += size;
+  }
+
+  template<typename T>
+  void read(std::vector<T>& values, std::size_t count)
+  {
+    values.resize(count);
+    read(values.data(), count);
+  }
+
+private:
+  const std::vector<char>& _buffer;
+  std::size_t _offset = 0;
+};
+
+/**
+ * @brief Finalize a raw block, compress it if requested and if it is worth it.
+ */
+EncodedBlock packBlock(std::vector<char>&& raw, std::size_t nbItems, bool compress)
+{
+  EncodedBlock block;
+  block.rawSize = raw.size();
+  block.nbItems = static_cast<std::uint32_t>(nbItems);
+
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ZLIB)
+  if(compress && !raw.empty())
+  {
+    uLongf compressedSize = compressBound(static_cast<uLong>(raw.size()));
+    std::vector<char> compressed(compressedSize);
+
+    if(compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressedSize,
+                 reinterpret_cast<const Bytef*>(raw.data()), static_cast<uLong>(raw.size()), Z_BEST_SPEED) == Z_OK &&
+       compressedSize < raw.size())
+    {
+      compressed.resize(compressedSize);
+      block.data = std::move(compressed);
+      block.compression = EBinaryCompression::ZLIB;
+      return block;
+    }
+  }
+#endif
+
+  block.data = std::move(raw);
+  return block;
+}
+
+/**
+ * @brief Decompress a block read from the file.
+ */
+std::vector<char> unpackBlock(std::vector<char>&& stored, const BlockEntry& entry)
+{
+  switch(static_cast<EBinaryCompression>(entry.compression))
+  {
+    case EBinaryCompression::NONE:
+      return std::move(stored);
+    case EBinaryCompression::ZLIB:
+    {
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ZLIB)
+      std::vector<char> raw(entry.rawSize);
+      uLongf rawSize = static_cast<uLongf>(entry.rawSize);
+      if(uncompress(reinterpret_cast<Bytef*>(raw.data()), &rawSize,
+                    reinterpret_cast<const Bytef*>(stored.data()), static_cast<uLong>(stored.size())) != Z_OK ||
+         rawSize != entry.rawSize)
+        throw std::runtime_error("Corrupted compressed binary SfMData block.");
+      return raw;
+#else
+      throw std::runtime_error("Cannot read a compressed binary SfMData block, AliceVision is built without ZLIB support.");
+#endif
+    }
+  }
+  throw std::runtime_error("Unknown binary SfMData block compression: " + std::to_string(entry.compression) + ".");
+}
+
+EncodedBlock packTree(const bpt::ptree& tree, std::size_t nbItems, bool compress)
+{
+  std::ostringstream stream;
+  bpt::write_json(stream, tree, false);
+
+  BlockWriter writer;
+  writer.write(stream.str());
+  return packBlock(std::move(writer.buffer()), nbItems, compress);
+}
+
+void unpackTree(const std::vector<char>& raw, bpt::ptree& tree)
+{
+  std::istringstream stream(std::string(raw.begin(), raw.end()));
+  bpt::read_json(stream, tree);
+}
+
+/**
+ * @brief Encoded blocks of a range of landmarks, one block per section.
+ */
+struct LandmarkBlocks
+{
+  EncodedBlock landmarks;
+  EncodedBlock observations;
+  EncodedBlock features;
+};
+
+using LandmarkRefs = std::vector<std::pair<IndexT, const sfmData::Landmark*>>;
+
+/**
+ * @brief Encode a range of landmarks in columns.
+ *
+ * Landmarks block: ids, describer type indexes, positions, colors and number of observations.
+ * Observations block: view ids of all the observations of the range.
+ * Features block: feature ids, positions and scales of all the observations of the range.
+ */
+void encodeLandmarks(const LandmarkRefs& landmarks, std::size_t begin, std::size_t end,
+                     const std::map<feature::EImageDescriberType, std::uint8_t>& descTypeIndexes,
+                     bool saveObservations, bool saveFeatures, bool compress, LandmarkBlocks& out)
+{
+  const std::size_t nbLandmarks = end - begin;
+
+  std::vector<std::uint32_t> ids(nbLandmarks);
+  std::vector<std::uint8_t> descTypes(nbLandmarks);
+  std::vector<double> positions(3 * nbLandmarks);
+  std::vector<std::uint8_t> colors(3 * nbLandmarks);
+  std::vector<std::uint32_t> nbObservations(nbLandmarks);
+
+  std::size_t nbTotalObservations = 0;
+
+  for(std::size_t i = 0; i < nbLandmarks; ++i)
+  {
+    const IndexT landmarkId = landmarks.at(begin + i).first;
+    const sfmData::Landmark& landmark = *landmarks.at(begin + i).second;
+
+    ids[i] = landmarkId;
+    descTypes[i] = descTypeIndexes.at(landmark.descType);
+    for(int c = 0; c < 3; ++c)
+    {
+      positions[3 * i + c] = landmark.X(c);
+      colors[3 * i + c] = landmark.rgb(c);
+    }
+    nbObservations[i] = static_cast<std::uint32_t>(landmark.observations.size());
+    nbTotalObservations += landmark.observations.size();
+  }
+
+  BlockWriter landmarksWriter;
+  landmarksWriter.write(ids);
+  landmarksWriter.write(descTypes);
+  landmarksWriter.write(positions);
+  landmarksWriter.write(colors);
+  landmarksWriter.write(nbObservations);
+  out.landmarks = packBlock(std::move(landmarksWriter.buffer()), nbLandmarks, compress);
+
+  if(!saveObservations)
+    return;
+
+  std::vector<std::uint32_t> viewIds;
+  std::vector<std::uint32_t> featureIds;
+  std::vector<double> featurePositions;
+  std::vector<double> featureScales;
+
+  viewIds.reserve(nbTotalObservations);
+  if(saveFeatures)
+  {
+    featureIds.reserve(nbTotalObservations);
+    featurePositions.reserve(2 * nbTotalObservations);
+    featureScales.reserve(nbTotalObservations);
+  }
+
+  for(std::size_t i = begin; i < end; ++i)
+  {
+    for(const auto& observationPair : landmarks.at(i).second->observations)
+    {
+      const sfmData::Observation& observation = observationPair.second;
+      viewIds.push_back(observationPair.first);
+
+      if(saveFeatures)
+      {
+        featureIds.push_back(observation.id_feat);
+        featurePositions.push_back(observation.x(0));
+        featurePositions.push_back(observation.x(1));
+        featureScales.push_back(observation.scale);
+      }
+    }
+  }
+
+  BlockWriter observationsWriter;
+  observationsWriter.write(viewIds);
+  out.observations = packBlock(std::move(observationsWriter.buffer()), nbTotalObservations, compress);
+
+  if(!saveFeatures)
+    return;
+
+  BlockWriter featuresWriter;
+  featuresWriter.write(featureIds);
+  featuresWriter.write(featurePositions);
+  featuresWriter.write(featureScales);
+  out.features = packBlock(std::move(featuresWriter.buffer()), nbTotalObservations, compress);
+}
+
+/**
+ * @brief Decode a landmarks block and its optional observations and features blocks.
+ */
+void decodeLandmarks(const std::vector<char>& landmarksRaw, std::size_t nbLandmarks,
+                     const std::vector<char>* observationsRaw, const std::vector<char>* featuresRaw,
+                     std::size_t nbTotalObservations,
+                     const std::vector<feature::EImageDescriberType>& descTypes,
+                     std::vector<std::pair<IndexT, sfmData::Landmark>>& out)
+{
+  std::vector<std::uint32_t> ids;
+  std::vector<std::uint8_t> descTypeIndexes;
+  std::vector<double> positions;
+  std::vector<std::uint8_t> colors;
+  std::vector<std::uint32_t> nbObservations;
+
+  BlockReader landmarksReader(landmarksRaw);
+  landmarksReader.read(ids, nbLandmarks);
+  landmarksReader.read(descTypeIndexes, nbLandmarks);
+  landmarksReader.read(positions, 3 * nbLandmarks);
+  landmarksReader.read(colors, 3 * nbLandmarks);
+  landmarksReader.read(nbObservations, nbLandmarks);
+
+  std::vector<std::uint32_t> viewIds;
+  std::vector<std::uint32_t> featureIds;
+  std::vector<double> featurePositions;
+  std::vector<double> featureScales;
+
+  if(observationsRaw != nullptr)
+  {
+    BlockReader observationsReader(*observationsRaw);
+    observationsReader.read(viewIds, nbTotalObservations);
+  }
+
+  if(featuresRaw != nullptr)
+  {
+    BlockReader featuresReader(*featuresRaw);
+    featuresReader.read(featureIds, nbTotalObservations);
+    featuresReader.read(featurePositions, 2 * nbTotalObservations);
+    featuresReader.read(featureScales, nbTotalObservations);
+  }
+
+  out.resize(nbLandmarks);
+
+  std::size_t o = 0;
+  for(std::size_t i = 0; i < nbLandmarks; ++i)
+  {
+    if(descTypeIndexes[i] >= descTypes.size())
+      throw std::runtime_error("Invalid describer type index in binary SfMData landmarks block.");
+
+    sfmData::Landmark& landmark = out[i].second;
+    out[i].first = ids[i];
+    landmark.descType = descTypes[descTypeIndexes[i]];
+    landmark.X = Vec3(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]);
+    landmark.rgb = image::RGBColor(colors[3 * i], colors[3 * i + 1], colors[3 * i + 2]);
+
+    if(observationsRaw == nullptr)
+      continue;
+
+    if(o + nbObservations[i] > nbTotalObservations)
+      throw std::runtime_error("Inconsistent number of observations in binary SfMData landmarks block.");
+
+    // observations are stored in the flat map order
+    landmark.observations.reserve(nbObservations[i]);
+    for(std::uint32_t j = 0; j < nbObservations[i]; ++j, ++o)
+    {
+      sfmData::Observation observation;
+      if(featuresRaw != nullptr)
+      {
+        observation.id_feat = featureIds[o];
+        observation.x = Vec2(featurePositions[2 * o], featurePositions[2 * o + 1]);
+        observation.scale = featureScales[o];
+      }
+      landmark.observations.emplace_hint(landmark.observations.end(), viewIds[o], observation);
+    }
+  }
+}
+
+/**
+ * @brief Sequential writer of a binary SfMData file.
+ *
+ * Blocks are written as they come, then the block table of each section,
+ * the section table and finally the header are written.
+ */
+class BinaryWriter
+{
+public:
+  explicit BinaryWriter(const std::string& filename)
+    : _stream(filename, std::ios::binary | std::ios::trunc)
+  {
+    if(!_stream.is_open())
+      throw std::runtime_error("Unable to open the binary SfMData file '" + filename + "' for writing.");
+
+    // placeholder, rewritten by close()
+    const FileHeader header{};
+    _stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+
+  BlockEntry writeBlock(const EncodedBlock& block)
+  {
+    BlockEntry entry;
+    entry.offset = static_cast<std::uint64_t>(_stream.tellp());
+    entry.storedSize = block.data.size();
+    entry.rawSize = block.rawSize;
+    entry.nbItems = block.nbItems;
+    entry.compression = static_cast<std::uint32_t>(block.compression);
+    _stream.write(block.data.data(), block.data.size());
+    return entry;
+  }
+
+  void writeSection(EBinarySection type, const std::vector<BlockEntry>& blocks)
+  {
+    SectionEntry section;
+    section.type = static_cast<std::uint32_t>(type);
+    section.nbBlocks = static_cast<std::uint32_t>(blocks.size());
+    section.blockTableOffset = static_cast<std::uint64_t>(_stream.tellp());
+    _stream.write(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(BlockEntry));
+    _sections.push_back(section);
+  }
+
+  void writeSection(EBinarySection type, const EncodedBlock& block)
+  {
+    writeSection(type, std::vector<BlockEntry>{writeBlock(block)});
+  }
+
+  void close(const Vec3i& version)
+  {
+    FileHeader header{};
+    std::copy(binaryMagic, binaryMagic + sizeof(binaryMagic), header.magic);
+    header.formatVersion = ALICEVISION_SFMDATAIO_BINARY_VERSION;
+    header.nbSections = static_cast<std::uint32_t>(_sections.size());
+    header.sectionTableOffset = static_cast<std::uint64_t>(_stream.tellp());
+    for(int i = 0; i < 3; ++i)
+      header.version[i] = version(i);
+
+    _stream.write(reinterpret_cast<const char*>(_sections.data()), _sections.size() * sizeof(SectionEntry));
+    _stream.seekp(0);
+    _stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _stream.close();
+
+    if(_stream.fail())
+      throw std::runtime_error("Failed to write the binary SfMData file.");
+  }
+
+private:
+  std::ofstream _stream;
+  std::vector<SectionEntry> _sections;
+};
+
+/**
+ * @brief Random access reader of a binary SfMData file.
+ *
+ * Only the header and the section table are read on opening,
+ * the block tables and blocks are read on demand.
+ */
+class BinaryReader
+{
+public:
+  explicit BinaryReader(const std::string& filename)
+    : _filename(filename)
+    , _stream(filename, std::ios::binary)
+  {
+    if(!_stream.is_open())
+      throw std::runtime_error("Unable to open the binary SfMData file '" + filename + "'.");
+
+    _stream.read(reinterpret_cast<char*>(&_header), sizeof(_header));
+    if(!_stream || !std::equal(binaryMagic, binaryMagic + sizeof(binaryMagic), _header.magic))
+      throw std::runtime_error("The file '" + filename + "' is not a binary SfMData file.");
+
+    if(_header.formatVersion > ALICEVISION_SFMDATAIO_BINARY_VERSION)
+      throw std::runtime_error("The binary SfMData file '" + filename + "' has an unsupported format version ("
+                               + std::to_string(_header.formatVersion) + ").");
+
+    std::vector<SectionEntry> sections(_header.nbSections);
+    _stream.seekg(_header.sectionTableOffset);
+    _stream.read(reinterpret_cast<char*>(sections.data()), sections.size() * sizeof(SectionEntry));
+    if(!_stream)
+      throw std::runtime_error("Truncated binary SfMData file '" + filename + "'.");
+
+    for(const SectionEntry& section : sections)
+      _sections.emplace(static_cast<EBinarySection>(section.type), section);
+  }
+
+  Version version() const
+  {
+    return Version(_header.version[0], _header.version[1], _header.version[2]);
+  }
+
+  bool hasSection(EBinarySection type) const
+  {
+    return _sections.count(type) > 0;
+  }
+
+  std::vector<BlockEntry> readBlockTable(EBinarySection type)
+  {
+    const auto it = _sections.find(type);
+    if(it == _sections.end())
+      return {};
+
+    std::vector<BlockEntry> blocks(it->second.nbBlocks);
+    _stream.seekg(it->second.blockTableOffset);
+    _stream.read(reinterpret_cast<char*>(blocks.data()), blocks.size() * sizeof(BlockEntry));
+    if(!_stream)
+      throw std::runtime_error("Truncated binary SfMData file '" + _filename + "'.");
+    return blocks;
+  }
+
+  /// read the stored (possibly compressed) data of a block
+  std::vector<char> readBlock(const BlockEntry& entry)
+  {
+    std::vector<char> stored(entry.storedSize);
+    _stream.seekg(entry.offset);
+    _stream.read(stored.data(), stored.size());
+    if(!_stream)
+      throw std::runtime_error("Truncated binary SfMData file '" + _filename + "'.");
+    return stored;
+  }
+
+  /// read and decompress a single block section
+  std::vector<char> readSingleBlock(EBinarySection type)
+  {
+    const std::vector<BlockEntry> blocks = readBlockTable(type);
+    if(blocks.size() != 1)
+      throw std::runtime_error("Invalid binary SfMData section in file '" + _filename + "'.");
+    return unpackBlock(readBlock(blocks.front()), blocks.front());
+  }
+
+private:
+  std::string _filename;
+  std::ifstream _stream;
+  FileHeader _header;
+  std::map<EBinarySection, SectionEntry> _sections;
+};
+
+/**
+ * @brief Run a function on each index in parallel and rethrow the first error.
+ */
+template<typename Function>
+void parallelFor(std::size_t count, Function function)
+{
+  std::string error;
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < static_cast<int>(count); ++i)
+  {
+    try
+    {
+      function(static_cast<std::size_t>(i));
+    }
+    catch(const std::exception& e)
+    {
+      #pragma omp critical
+      if(error.empty())
+        error = e.what();
+    }
+  }
+
+  if(!error.empty())
+    throw std::runtime_error(error);
+}
+
+void saveLandmarks(BinaryWriter& writer, const sfmData::Landmarks& landmarks,
+                   const std::map<feature::EImageDescriberType, std::uint8_t>& descTypeIndexes,
+                   EBinarySection landmarksSection, EBinarySection observationsSection, EBinarySection featuresSection,
+                   bool saveObservations, bool saveFeatures, bool compress)
+{
+  LandmarkRefs refs;
+  refs.reserve(landmarks.size());
+  for(const auto& landmarkPair : landmarks)
+    refs.emplace_back(landmarkPair.first, &landmarkPair.second);
+
+  const std::size_t nbBlocks = (refs.size() + landmarksPerBlock - 1) / landmarksPerBlock;
+  // encode a batch of blocks in parallel then write it, to bound the memory usage
+  const std::size_t batchSize = std::max(1, 2 * omp_get_max_threads());
+
+  std::vector<BlockEntry> landmarksEntries;
+  std::vector<BlockEntry> observationsEntries;
+  std::vector<BlockEntry> featuresEntries;
+
+  for(std::size_t batchBegin = 0; batchBegin < nbBlocks; batchBegin += batchSize)
+  {
+    const std::size_t batchEnd = std::min(nbBlocks, batchBegin + batchSize);
+    std::vector<LandmarkBlocks> batch(batchEnd - batchBegin);
+
+    parallelFor(batch.size(), [&](std::size_t i) {
+      const std::size_t begin = (batchBegin + i) * landmarksPerBlock;
+      const std::size_t end = std::min(refs.size(), begin + landmarksPerBlock);
+      encodeLandmarks(refs, begin, end, descTypeIndexes, saveObservations, saveFeatures, compress, batch.at(i));
+    });
+
+    for(const LandmarkBlocks& blocks : batch)
+    {
+      landmarksEntries.push_back(writer.writeBlock(blocks.landmarks));
+      if(saveObservations)
+        observationsEntries.push_back(writer.writeBlock(blocks.observations));
+      if(saveFeatures)
+        featuresEntries.push_back(writer.writeBlock(blocks.features));
+    }
+  }
+
+  writer.writeSection(landmarksSection, landmarksEntries);
+  if(saveObservations)
+    writer.writeSection(observationsSection, observationsEntries);
+  if(saveFeatures)
+    writer.writeSection(featuresSection, featuresEntries);
+}
+
+void loadLandmarks(BinaryReader& reader, sfmData::Landmarks& landmarks,
+                   const std::vector<feature::EImageDescriberType>& descTypes,
+                   EBinarySection landmarksSection, EBinarySection observationsSection, EBinarySection featuresSection,
+                   bool loadObservations, bool loadFeatures)
+{
+  const std::vector<BlockEntry> landmarksEntries = reader.readBlockTable(landmarksSection);
+  const std::vector<BlockEntry> observationsEntries = loadObservations ? reader.readBlockTable(observationsSection) : std::vector<BlockEntry>();
+  const std::vector<BlockEntry> featuresEntries = loadFeatures ? reader.readBlockTable(featuresSection) : std::vector<BlockEntry>();
+
+  // observations and features may not have been saved
+  loadObservations = loadObservations && observationsEntries.size() == landmarksEntries.size();
+  loadFeatures = loadObservations && loadFeatures && featuresEntries.size() == landmarksEntries.size();
+
+  const std::size_t nbBlocks = landmarksEntries.size();
+  const std::size_t batchSize = std::max(1, 2 * omp_get_max_threads());
+
+  for(std::size_t batchBegin = 0; batchBegin < nbBlocks; batchBegin += batchSize)
+  {
+    const std::size_t batchEnd = std::min(nbBlocks, batchBegin + batchSize);
+    const std::size_t batchCount = batchEnd - batchBegin;
+
+    // sequential reads
+    std::vector<std::vector<char>> landmarksData(batchCount);
+    std::vector<std::vector<char>> observationsData(batchCount);
+    std::vector<std::vector<char>> featuresData(batchCount);
+
+    for(std::size_t i = 0; i < batchCount; ++i)
+    {
+      landmarksData.at(i) = reader.readBlock(landmarksEntries.at(batchBegin + i));
+      if(loadObservations)
+        observationsData.at(i) = reader.readBlock(observationsEntries.at(batchBegin + i));
+      if(loadFeatures)
+        featuresData.at(i) = reader.readBlock(featuresEntries.at(batchBegin + i));
+    }
+
+    // parallel decompression and decoding
+    std::vector<std::vector<std::pair<IndexT, sfmData::Landmark>>> decoded(batchCount);
+
+    parallelFor(batchCount, [&](std::size_t i) {
+      const std::size_t b = batchBegin + i;
+      const std::vector<char> landmarksRaw = unpackBlock(std::move(landmarksData.at(i)), landmarksEntries.at(b));
+      std::vector<char> observationsRaw;
+      std::vector<char> featuresRaw;
+      std::size_t nbTotalObservations = 0;
+
+      if(loadObservations)
+      {
+        observationsRaw = unpackBlock(std::move(observationsData.at(i)), observationsEntries.at(b));
+        nbTotalObservations = observationsEntries.at(b).nbItems;
+      }
+      if(loadFeatures)
+        featuresRaw = unpackBlock(std::move(featuresData.at(i)), featuresEntries.at(b));
+
+      decodeLandmarks(landmarksRaw, landmarksEntries.at(b).nbItems,
+                      loadObservations ? &observationsRaw : nullptr,
+                      loadFeatures ? &featuresRaw : nullptr,
+                      nbTotalObservations, descTypes, decoded.at(i));
+    });
+
+    // sequential insertion
+    for(auto& block : decoded)
+      for(auto& landmarkPair : block)
+        landmarks.emplace(landmarkPair.first, std::move(landmarkPair.second));
+  }
+}
+
+} // namespace
+
+bool saveBinary(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool compress)
+{
+  const Vec3i version = {ALICEVISION_SFMDATAIO_VERSION_MAJOR, ALICEVISION_SFMDATAIO_VERSION_MINOR, ALICEVISION_SFMDATAIO_VERSION_REVISION};
+
+  // save flags
+  const bool saveViews = (partFlag & VIEWS) == VIEWS;
+  const bool saveIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool saveExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool saveStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool saveControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+  BinaryWriter writer(filename);
+
+  // describer types used by the structure and the control points
+  std::map<feature::EImageDescriberType, std::uint8_t> descTypeIndexes;
+  {
+    if(saveStructure)
+      for(const auto& landmarkPair : sfmData.getLandmarks())
+        descTypeIndexes.emplace(landmarkPair.second.descType, 0);
+    if(saveControlPoints)
+      for(const auto& landmarkPair : sfmData.getControlPoints())
+        descTypeIndexes.emplace(landmarkPair.second.descType, 0);
+
+    std::uint8_t index = 0;
+    for(auto& descTypePair : descTypeIndexes)
+      descTypePair.second = index++;
+  }
+
+  // metadata
+  {
+    bpt::ptree metadataTree;
+
+    bpt::ptree featureFoldersTree;
+    for(const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
+    {
+      bpt::ptree featureFolderTree;
+      featureFolderTree.put("", featuresFolder);
+      featureFoldersTree.push_back(std::make_pair("", featureFolderTree));
+    }
+    metadataTree.add_child("featuresFolders", featureFoldersTree);
+
+    bpt::ptree matchingFoldersTree;
+    for(const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
+    {
+      bpt::ptree matchingFolderTree;
+      matchingFolderTree.put("", matchesFolder);
+      matchingFoldersTree.push_back(std::make_pair("", matchingFolderTree));
+    }
+    metadataTree.add_child("matchesFolders", matchingFoldersTree);
+
+    bpt::ptree descTypesTree;
+    for(const auto& descTypePair : descTypeIndexes)
+    {
+      bpt::ptree descTypeTree;
+      descTypeTree.put("", feature::EImageDescriberType_enumToString(descTypePair.first));
+      descTypesTree.push_back(std::make_pair("", descTypeTree));
+    }
+    metadataTree.add_child("describerTypes", descTypesTree);
+
+    writer.writeSection(EBinarySection::METADATA, packTree(metadataTree, 1, compress));
+  }
+
+  // views
+  if(saveViews && !sfmData.getViews().empty())
+  {
+    std::vector<const sfmData::View*> views;
+    views.reserve(sfmData.getViews().size());
+    for(const auto& viewPair : sfmData.getViews())
+      views.push_back(viewPair.second.get());
+
+    std::vector<EncodedBlock> blocks((views.size() + viewsPerBlock - 1) / viewsPerBlock);
+
+    parallelFor(blocks.size(), [&](std::size_t b) {
+      const std::size_t begin = b * viewsPerBlock;
+      const std::size_t end = std::min(views.size(), begin + viewsPerBlock);
+
+      bpt::ptree viewsTree;
+      for(std::size_t i = begin; i < end; ++i)
+        saveView("", *views.at(i), viewsTree);
+
+      bpt::ptree blockTree;
+      blockTree.add_child("views", viewsTree);
+      blocks.at(b) = packTree(blockTree, end - begin, compress);
+    });
+
+    std::vector<BlockEntry> entries;
+    for(const EncodedBlock& block : blocks)
+      entries.push_back(writer.writeBlock(block));
+    writer.writeSection(EBinarySection::VIEWS, entries);
+  }
+
+  // intrinsics
+  if(saveIntrinsics && !sfmData.getIntrinsics().empty())
+  {
+    bpt::ptree intrinsicsTree;
+    for(const auto& intrinsicPair : sfmData.getIntrinsics())
+      saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+
+    bpt::ptree blockTree;
+    blockTree.add_child("intrinsics", intrinsicsTree);
+    writer.writeSection(EBinarySection::INTRINSICS, packTree(blockTree, sfmData.getIntrinsics().size(), compress));
+  }
+
+  // extrinsics
+  if(saveExtrinsics)
+  {
+    // poses: ids, rotations (column-major), centers and locked flags
+    if(!sfmData.getPoses().empty())
+    {
+      const std::size_t nbPoses = sfmData.getPoses().size();
+      std::vector<std::uint32_t> ids;
+      std::vector<double> rotations;
+      std::vector<double> centers;
+      std::vector<std::uint8_t> locked;
+
+      ids.reserve(nbPoses);
+      rotations.reserve(9 * nbPoses);
+      centers.reserve(3 * nbPoses);
+      locked.reserve(nbPoses);
+
+      for(const auto& posePair : sfmData.getPoses())
+      {
+        const geometry::Pose3& transform = posePair.second.getTransform();
+        const Mat3& rotation = transform.rotation();
+        const Vec3 center = transform.center();
+
+        ids.push_back(posePair.first);
+        rotations.insert(rotations.end(), rotation.data(), rotation.data() + 9);
+        centers.insert(centers.end(), center.data(), center.data() + 3);
+        locked.push_back(posePair.second.isLocked() ? 1 : 0);
+      }
+
+      BlockWriter posesWriter;
+      posesWriter.write(ids);
+      posesWriter.write(rotations);
+      posesWriter.write(centers);
+      posesWriter.write(locked);
+      writer.writeSection(EBinarySection::POSES, packBlock(std::move(posesWriter.buffer()), nbPoses, compress));
+    }
+
+    // rigs
+    if(!sfmData.getRigs().empty())
+    {
+      bpt::ptree rigsTree;
+      for(const auto& rigPair : sfmData.getRigs())
+        saveRig("", rigPair.first, rigPair.second, rigsTree);
+
+      bpt::ptree blockTree;
+      blockTree.add_child("rigs", rigsTree);
+      writer.writeSection(EBinarySection::RIGS, packTree(blockTree, sfmData.getRigs().size(), compress));
+    }
+  }
+
+  // structure
+  if(saveStructure && !sfmData.getLandmarks().empty())
+  {
+    saveLandmarks(writer, sfmData.getLandmarks(), descTypeIndexes,
+                  EBinarySection::STRUCTURE, EBinarySection::STRUCTURE_OBSERVATIONS, EBinarySection::STRUCTURE_FEATURES,
+                  saveObservations, saveFeatures, compress);
+  }
+
+  // control points
+  if(saveControlPoints && !sfmData.getControlPoints().empty())
+  {
+    saveLandmarks(writer, sfmData.getControlPoints(), descTypeIndexes,
+                  EBinarySection::CONTROL_POINTS, EBinarySection::CONTROL_POINTS_OBSERVATIONS, EBinarySection::CONTROL_POINTS_FEATURES,
+                  true, true, compress);
+  }
+
+  writer.close(version);
+
+  return true;
+}
+
+bool loadBinary(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+  // load flags
+  const bool loadViews = (partFlag & VIEWS) == VIEWS;
+  const bool loadIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+  const bool loadExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+  const bool loadStructure = (partFlag & STRUCTURE) == STRUCTURE;
+  const bool loadControlPoints = (partFlag & CONTROL_POINTS) == CONTROL_POINTS;
+  const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+  const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+  BinaryReader reader(filename);
+  const Version version = reader.version();
+
+  // metadata
+  std::vector<feature::EImageDescriberType> descTypes;
+  {
+    bpt::ptree metadataTree;
+    unpackTree(reader.readSingleBlock(EBinarySection::METADATA), metadataTree);
+
+    for(bpt::ptree::value_type& featureFolderNode : metadataTree.get_child("featuresFolders"))
+      sfmData.addFeaturesFolder(featureFolderNode.second.get_value<std::string>());
+
+    for(bpt::ptree::value_type& matchingFolderNode : metadataTree.get_child("matchesFolders"))
+      sfmData.addMatchesFolder(matchingFolderNode.second.get_value<std::string>());
+
+    for(bpt::ptree::value_type& descTypeNode : metadataTree.get_child("describerTypes"))
+      descTypes.push_back(feature::EImageDescriberType_stringToEnum(descTypeNode.second.get_value<std::string>()));
+  }
+
+  // intrinsics
+  if(loadIntrinsics && reader.hasSection(EBinarySection::INTRINSICS))
+  {
+    sfmData::Intrinsics& intrinsics = sfmData.getIntrinsics();
+
+    bpt::ptree blockTree;
+    unpackTree(reader.readSingleBlock(EBinarySection::INTRINSICS), blockTree);
+
+    for(bpt::ptree::value_type& intrinsicNode : blockTree.get_child("intrinsics"))
+    {
+      IndexT intrinsicId;
+      std::shared_ptr<camera::IntrinsicBase> intrinsic;
+
+      loadIntrinsic(version, intrinsicId, intrinsic, intrinsicNode.second);
+
+      intrinsics.emplace(intrinsicId, intrinsic);
+    }
+  }
+
+  // views
+  if(loadViews && reader.hasSection(EBinarySection::VIEWS))
+  {
+    sfmData::Views& views = sfmData.getViews();
+
+    const std::vector<BlockEntry> entries = reader.readBlockTable(EBinarySection::VIEWS);
+    std::vector<std::vector<char>> data(entries.size());
+    for(std::size_t b = 0; b < entries.size(); ++b)
+      data.at(b) = reader.readBlock(entries.at(b));
+
+    std::vector<std::vector<std::shared_ptr<sfmData::View>>> decoded(entries.size());
+
+    parallelFor(entries.size(), [&](std::size_t b) {
+      bpt::ptree blockTree;
+      unpackTree(unpackBlock(std::move(data.at(b)), entries.at(b)), blockTree);
+
+      for(bpt::ptree::value_type& viewNode : blockTree.get_child("views"))
+      {
+        std::shared_ptr<sfmData::View> view = std::make_shared<sfmData::View>();
+        loadView(*view, viewNode.second);
+        decoded.at(b).push_back(view);
+      }
+    });
+
+    for(const auto& block : decoded)
+      for(const auto& view : block)
+        views.emplace(view->getViewId(), view);
+  }
+
+  // extrinsics
+  if(loadExtrinsics)
+  {
+    // poses
+    if(reader.hasSection(EBinarySection::POSES))
+    {
+      sfmData::Poses& poses = sfmData.getPoses();
+
+      const std::vector<BlockEntry> entries = reader.readBlockTable(EBinarySection::POSES);
+      for(const BlockEntry& entry : entries)
+      {
+        const std::vector<char> raw = unpackBlock(reader.readBlock(entry), entry);
+        const std::size_t nbPoses = entry.nbItems;
+
+        std::vector<std::uint32_t> ids;
+        std::vector<double> rotations;
+        std::vector<double> centers;
+        std::vector<std::uint8_t> locked;
+
+        BlockReader posesReader(raw);
+        posesReader.read(ids, nbPoses);
+        posesReader.read(rotations, 9 * nbPoses);
+        posesReader.read(centers, 3 * nbPoses);
+        posesReader.read(locked, nbPoses);
+
+        for(std::size_t i = 0; i < nbPoses; ++i)
+        {
+          const Mat3 rotation = Eigen::Map<const Mat3>(rotations.data() + 9 * i);
+          const Vec3 center = Eigen::Map<const Vec3>(centers.data() + 3 * i);
+          poses.emplace(ids[i], sfmData::CameraPose(geometry::Pose3(rotation, center), locked[i] != 0));
+        }
+      }
+    }
+
+    // rigs
+    if(reader.hasSection(EBinarySection::RIGS))
+    {
+      sfmData::Rigs& rigs = sfmData.getRigs();
+
+      bpt::ptree blockTree;
+      unpackTree(reader.readSingleBlock(EBinarySection::RIGS), blockTree);
+
+      for(bpt::ptree::value_type& rigNode : blockTree.get_child("rigs"))
+      {
+        IndexT rigId;
+        sfmData::Rig rig;
+
+        loadRig(rigId, rig, rigNode.second);
+
+        rigs.emplace(rigId, rig);
+      }
+    }
+  }
+
+  // structure
+  if(loadStructure && reader.hasSection(EBinarySection::STRUCTURE))
+  {
+    loadLandmarks(reader, sfmData.getLandmarks(), descTypes,
+                  EBinarySection::STRUCTURE, EBinarySection::STRUCTURE_OBSERVATIONS, EBinarySection::STRUCTURE_FEATURES,
+                  loadObservations, loadFeatures);
+  }
+
+  // control points
+  if(loadControlPoints && reader.hasSection(EBinarySection::CONTROL_POINTS))
+  {
+    loadLandmarks(reader, sfmData.getControlPoints(), descTypes,
+                  EBinarySection::CONTROL_POINTS, EBinarySection::CONTROL_POINTS_OBSERVATIONS, EBinarySection::CONTROL_POINTS_FEATURES,
+                  true, true);
+  }
+
+  return true;
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -0,0 +1,75 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+
+#include <string>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+/**
+ * @brief Binary SfMData container (.sfmb) format version.
+ * @note Must be incremented when the file layout changes.
+ */
+#define ALICEVISION_SFMDATAIO_BINARY_VERSION 1
+
+/**
+ * @brief Sections of a binary SfMData file.
+ *
+ * Each section is an independent set of blocks referenced by the section table,
+ * so a reader can seek over the sections it does not need.
+ * The structure and control points are stored in columns, the observations
+ * and their features in separate sections aligned on the landmark blocks.
+ */
+enum class EBinarySection : unsigned int
+{
+  METADATA = 0,                   //< version, folders and describer types (JSON text)
+  VIEWS,                          //< views (JSON text)
+  INTRINSICS,                     //< intrinsics (JSON text)
+  POSES,                          //< poses (columns)
+  RIGS,                           //< rigs (JSON text)
+  STRUCTURE,                      //< landmarks (columns)
+  STRUCTURE_OBSERVATIONS,         //< landmark observations view ids (columns)
+  STRUCTURE_FEATURES,             //< landmark observations features (columns)
+  CONTROL_POINTS,                 //< control points (columns)
+  CONTROL_POINTS_OBSERVATIONS,    //< control point observations view ids (columns)
+  CONTROL_POINTS_FEATURES         //< control point observations features (columns)
+};
+
+/**
+ * @brief Block compression method of a binary SfMData file.
+ */
+enum class EBinaryCompression : unsigned int
+{
+  NONE = 0,
+  ZLIB
+};
+
+/**
+ * @brief Save an SfMData in a binary file.
+ * @param[in] sfmData The input SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData save flag
+ * @param[in] compress Compress the blocks if AliceVision is built with ZLIB
+ * @return true if completed
+ */
+bool saveBinary(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool compress = true);
+
+/**
+ * @brief Load a binary SfMData file.
+ * @note Only the sections requested by the partFlag are read.
+ * @param[out] sfmData The output SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData load flag
+ * @return true if completed
+ */
+bool loadBinary(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+} // namespace sfmDataIO
+} // namespace aliceVision
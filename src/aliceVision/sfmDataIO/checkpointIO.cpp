@@ -0,0 +1,802 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "checkpointIO.hpp"
+#include <aliceVision/camera/camera.hpp>
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace {
+
+const char checkpointMagic[4] = {'A', 'V', 'C', 'K'};
+
+enum class ERecordType : std::uint32_t
+{
+  BEGIN = 0,   //< reference scene fingerprint
+  CHECKPOINT   //< scene changes since the previous record
+};
+
+/**
+ * @brief Record header, each record is a header followed by its payload.
+ */
+struct RecordHeader
+{
+  char magic[4];
+  std::uint32_t type;
+  std::uint64_t payloadSize;
+  std::uint64_t checksum;  //< FNV-1a hash of the payload
+};
+
+static_assert(sizeof(RecordHeader) == 24, "Unexpected checkpoint record header size.");
+
+const std::uint64_t fnvOffsetBasis = 14695981039346656037ull;
+
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t hash = fnvOffsetBasis)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+template<typename T>
+std::uint64_t hashValue(const T& value, std::uint64_t hash)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be hashed.");
+  return hashBytes(&value, sizeof(T), hash);
+}
+
+/**
+ * @brief Hash of all the landmark data but its position.
+ */
+std::uint64_t hashLandmark(const sfmData::Landmark& landmark)
+{
+  std::uint64_t hash = hashValue(static_cast<std::uint32_t>(landmark.descType), fnvOffsetBasis);
+  hash = hashBytes(landmark.rgb.data(), 3, hash);
+  hash = hashValue(static_cast<std::uint64_t>(landmark.observations.size()), hash);
+  for(const auto& observationPair : landmark.observations)
+  {
+    const sfmData::Observation& observation = observationPair.second;
+    hash = hashValue(observationPair.first, hash);
+    hash = hashValue(observation.id_feat, hash);
+    hash = hashValue(observation.x(0), hash);
+    hash = hashValue(observation.x(1), hash);
+    hash = hashValue(observation.scale, hash);
+  }
+  return hash;
+}
+
+bool isSamePose(const geometry::Pose3& a, const geometry::Pose3& b)
+{
+  return a.rotation() == b.rotation() && a.center() == b.center();
+}
+
+bool isSameRig(const sfmData::Rig& a, const sfmData::Rig& b)
+{
+  if(a.getNbSubPoses() != b.getNbSubPoses())
+    return false;
+
+  for(std::size_t i = 0; i < a.getNbSubPoses(); ++i)
+  {
+    const sfmData::RigSubPose& subPoseA = a.getSubPoses().at(i);
+    const sfmData::RigSubPose& subPoseB = b.getSubPoses().at(i);
+
+    if(subPoseA.status != subPoseB.status || !isSamePose(subPoseA.pose, subPoseB.pose))
+      return false;
+  }
+  return true;
+}
+
+std::string intrinsicDescription(IndexT intrinsicId, const std::shared_ptr<camera::IntrinsicBase>& intrinsic)
+{
+  bpt::ptree tree;
+  saveIntrinsic("intrinsic", intrinsicId, intrinsic, tree);
+  std::ostringstream stream;
+  bpt::write_json(stream, tree, false);
+  return stream.str();
+}
+
+/**
+ * @brief Append values in a record payload.
+ */
+class RecordWriter
+{
+public:
+  template<typename T>
+  void put(const T& value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written.");
+    _data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void putString(const std::string& value)
+  {
+    put(static_cast<std::uint64_t>(value.size()));
+    _data.append(value);
+  }
+
+  void putVector(const std::vector<double>& values)
+  {
+    put(static_cast<std::uint64_t>(values.size()));
+    _data.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+  }
+
+  void putPose(const geometry::Pose3& pose)
+  {
+    _data.append(reinterpret_cast<const char*>(pose.rotation().data()), 9 * sizeof(double));
+    _data.append(reinterpret_cast<const char*>(pose.center().data()), 3 * sizeof(double));
+  }
+
+  /// write a count placeholder, returns its offset
+  std::size_t beginCount()
+  {
+    const std::size_t offset = _data.size();
+    put(std::uint32_t(0));
+    return offset;
+  }
+
+  /// set the count at the given placeholder offset
+  void endCount(std::size_t offset, std::size_t count)
+  {
+    const std::uint32_t value = static_cast<std::uint32_t>(count);
+    std::memcpy(&_data[offset], &value, sizeof(value));
+  }
+
+  const std::string& data() const { return _data; }
+
+private:
+  std::string _data;
+};
+
+/**
+ * @brief Read values from a record payload.
+ */
+class RecordReader
+{
+public:
+  explicit RecordReader(const std::string& data)
+    : _data(data)
+  {}
+
+  template<typename T>
+  T get()
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read.");
+    T value;
+    read(&value, sizeof(T));
+    return value;
+  }
+
+  std::string getString()
+  {
+    const std::uint64_t size = get<std::uint64_t>();
+    check(size);
+    std::string value = _data.substr(_offset, size);
+    _offset += size;
+    return value;
+  }
+
+  std::vector<double> getVector()
+  {
+    const std::uint64_t size = get<std::uint64_t>();
+    check(size * sizeof(double));
+    std::vector<double> values(size);
+    read(values.data(), size * sizeof(double));
+    return values;
+  }
+
+  geometry::Pose3 getPose()
+  {
+    Mat3 rotation;
+    Vec3 center;
+    read(rotation.data(), 9 * sizeof(double));
+    read(center.data(), 3 * sizeof(double));
+    return geometry::Pose3(rotation, center);
+  }
+
+  bool atEnd() const { return _offset == _data.size(); }
+
+private:
+  void check(std::size_t size) const
+  {
+    if(size > _data.size() - _offset)
+      throw std::runtime_error("Truncated checkpoint record.");
+  }
+
+  void read(void* value, std::size_t size)
+  {
+    check(size);
+    std::memcpy(value, _data.data() + _offset, size);
+    _offset += size;
+  }
+
+  const std::string& _data;
+  std::size_t _offset = 0;
+};
+
+bool writeRecord(std::ofstream& file, ERecordType type, const std::string& payload)
+{
+  RecordHeader header;
+  std::memcpy(header.magic, checkpointMagic, sizeof(checkpointMagic));
+  header.type = static_cast<std::uint32_t>(type);
+  header.payloadSize = payload.size();
+  header.checksum = hashBytes(payload.data(), payload.size());
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(payload.data(), payload.size());
+  file.flush();
+  return file.good();
+}
+
+/**
+ * @brief Read the next record.
+ * @return false at the end of the file or if the record is incomplete or corrupted
+ */
+bool readRecord(std::ifstream& file, std::uint64_t fileSize, ERecordType& type, std::string& payload)
+{
+  RecordHeader header;
+  if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    return false;
+
+  if(std::memcmp(header.magic, checkpointMagic, sizeof(checkpointMagic)) != 0 ||
+     header.type > static_cast<std::uint32_t>(ERecordType::CHECKPOINT) ||
+     header.payloadSize > fileSize - static_cast<std::uint64_t>(file.tellg()))
+    return false;
+
+  payload.resize(header.payloadSize);
+  if(!file.read(&payload[0], header.payloadSize))
+    return false;
+
+  if(hashBytes(payload.data(), payload.size()) != header.checksum)
+    return false;
+
+  type = static_cast<ERecordType>(header.type);
+  return true;
+}
+
+/**
+ * @brief Apply a checkpoint record on a scene.
+ * @return the iteration of the checkpoint
+ */
+IndexT applyCheckpoint(const std::string& payload, sfmData::SfMData& sfmData)
+{
+  RecordReader reader(payload);
+  const IndexT iteration = reader.get<IndexT>();
+
+  // views
+  for(std::uint32_t i = 0, n = reader.get<std::uint32_t>(); i < n; ++i)
+  {
+    sfmData::View& view = sfmData.getView(reader.get<IndexT>());
+    view.setPoseId(reader.get<IndexT>());
+    view.setIntrinsicId(reader.get<IndexT>());
+    view.setResectionId(reader.get<IndexT>());
+    const IndexT rigId = reader.get<IndexT>();
+    const IndexT subPoseId = reader.get<IndexT>();
+    view.setRigAndSubPoseId(rigId, subPoseId);
+    view.setIndependantPose(reader.get<std::uint8_t>() != 0);
+  }
+
+  // intrinsics
+  for(std::uint32_t i = 0, n = reader.get<std::uint32_t>(); i < n; ++i)
+    sfmData.intrinsics.erase(reader.get<IndexT>());
+
+  const Version version(ALICEVISION_SFMDATAIO_VERSION_MAJOR, ALICEVISION_SFMDATAIO_VERSION_MINOR, ALICEVISION_SFMDATAIO_VERSION_REVISION);
+
+  for(std::uint32_t i = 0, n = reader.get<std::uint32_t>(); i < n; ++i)
+  {
+    std::istringstream stream(reader.getString());
+    const std::vector<double> params = reader.getVector();
+
+    bpt::ptree tree;
+    bpt::read_json(stream, tree);
+
+    IndexT intrinsicId;
+    std::shared_ptr<camera::IntrinsicBase> intrinsic;
+    loadIntrinsic(version, intrinsicId, intrinsic, tree.get_child("intrinsic"));
+
+    if(!intrinsic->updateFromParams(params))
+      throw std::runtime_error("Invalid intrinsic parameters in checkpoint record.");
+
+    sfmData.intrinsics[intrinsicId] = intrinsic;
+  }
+
+  // rigs
+  for(std::uint32_t i = 0, n = reader.get<std::uint32_t>(); i < n; ++i)
+    sfmData.getRigs().erase(reader.get<IndexT>());
+
+  for(std::uint32_t i = 0, n = reader.get<std::uint32_t>(); i < n; ++i)
+  {
+    const IndexT rigId = reader.get<IndexT>();
+    const std::uint32_t nbSubPoses = reader.get<std::uint32_t>();
+    sfmData::Rig rig(nbSubPoses);
+    for(sfmData::RigSubPose& subPose : rig.getSubPoses())
+    {
+      subPose.status = static_cast<sfmData::ERigSubPoseStatus>(reader.get<std::uint8_t>());
+      subPose.pose = reader.getPose();
+    }
+    sfmData.getRigs()[rigId] = rig;
+  }
+
+  // poses
+  for(std::uint32_t i = 0, n = reader.get<std::uint32_t>(); i < n; ++i)
+    sfmData.getPoses().erase(reader.get<IndexT>());
+
+  for(std::uint32_t i = 0, n = reader.get<std::uint32_t>(); i < n; ++i)
+  {
+    const IndexT poseId = reader.get<IndexT>();
+    const geometry::Pose3 transform = reader.getPose();
+    const bool locked = reader.get<std::uint8_t>() != 0;
+    sfmData.getPoses()[poseId] = sfmData::CameraPose(transform, locked);
+  }
+
+  // landmarks
+  sfmData::Landmarks& landmarks = sfmData.getLandmarks();
+
+  for(std::uint32_t i = 0, n = reader.get<std::uint32_t>(); i < n; ++i)
+    landmarks.erase(reader.get<IndexT>());
+
+  for(std::uint32_t i = 0, n = reader.get<std::uint32_t>(); i < n; ++i)
+  {
+    const IndexT landmarkId = reader.get<IndexT>();
+    sfmData::Landmark& landmark = landmarks[landmarkId];
+
+    landmark.descType = static_cast<feature::EImageDescriberType>(reader.get<std::uint32_t>());
+    const std::array<double, 3> X = reader.get<std::array<double, 3>>();
+    landmark.X = Vec3(X[0], X[1], X[2]);
+    for(int c = 0; c < 3; ++c)
+      landmark.rgb(c) = reader.get<std::uint8_t>();
+
+    landmark.observations.clear();
+    const std::uint32_t nbObservations = reader.get<std::uint32_t>();
+    for(std::uint32_t o = 0; o < nbObservations; ++o)
+    {
+      const IndexT viewId = reader.get<IndexT>();
+      sfmData::Observation& observation = landmark.observations[viewId];
+      observation.id_feat = reader.get<IndexT>();
+      observation.x(0) = reader.get<double>();
+      observation.x(1) = reader.get<double>();
+      observation.scale = reader.get<double>();
+    }
+  }
+
+  for(std::uint32_t i = 0, n = reader.get<std::uint32_t>(); i < n; ++i)
+  {
+    const IndexT landmarkId = reader.get<IndexT>();
+    Vec3& X = landmarks.at(landmarkId).X;
+    X(0) = reader.get<double>();
+    X(1) = reader.get<double>();
+    X(2) = reader.get<double>();
+  }
+
+  if(!reader.atEnd())
+    throw std::runtime_error("Invalid checkpoint record size.");
+
+  return iteration;
+}
+
+} // namespace
+
+bool CheckpointLog::ViewState::operator==(const ViewState& other) const
+{
+  return poseId == other.poseId &&
+         intrinsicId == other.intrinsicId &&
+         resectionId == other.resectionId &&
+         rigId == other.rigId &&
+         subPoseId == other.subPoseId &&
+         independentPose == other.independentPose;
+}
+
+bool CheckpointLog::create(const std::string& filename, const sfmData::SfMData& sfmData)
+{
+  close();
+
+  _file.open(filename, std::ios::binary | std::ios::trunc);
+  if(!_file.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Unable to create the checkpoint log: " << filename);
+    return false;
+  }
+
+  RecordWriter writer;
+  writer.put(static_cast<std::uint32_t>(ALICEVISION_SFMDATAIO_CHECKPOINT_VERSION));
+  writer.put(static_cast<std::uint64_t>(sfmData.getViews().size()));
+  writer.put(hashViews(sfmData));
+
+  if(!writeRecord(_file, ERecordType::BEGIN, writer.data()))
+  {
+    ALICEVISION_LOG_ERROR("Unable to write the checkpoint log: " << filename);
+    close();
+    return false;
+  }
+
+  resetState(sfmData);
+  return true;
+}
+
+bool CheckpointLog::resume(const std::string& filename, sfmData::SfMData& sfmData, IndexT& lastIteration)
+{
+  close();
+  lastIteration = UndefinedIndexT;
+
+  std::ifstream file(filename, std::ios::binary);
+  if(!file.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Unable to open the checkpoint log: " << filename);
+    return false;
+  }
+
+  const std::uint64_t fileSize = fs::file_size(filename);
+  ERecordType type;
+  std::string payload;
+
+  // reference scene fingerprint
+  {
+    if(!readRecord(file, fileSize, type, payload) || type != ERecordType::BEGIN)
+    {
+      ALICEVISION_LOG_ERROR("Invalid checkpoint log: " << filename);
+      return false;
+    }
+
+    RecordReader reader(payload);
+    const std::uint32_t formatVersion = reader.get<std::uint32_t>();
+    const std::uint64_t nbViews = reader.get<std::uint64_t>();
+    const std::uint64_t viewsHash = reader.get<std::uint64_t>();
+
+    if(formatVersion != ALICEVISION_SFMDATAIO_CHECKPOINT_VERSION)
+    {
+      ALICEVISION_LOG_ERROR("Unsupported checkpoint log version " << formatVersion << ": " << filename);
+      return false;
+    }
+
+    if(nbViews != sfmData.getViews().size() || viewsHash != hashViews(sfmData))
+    {
+      ALICEVISION_LOG_ERROR("The checkpoint log does not match the input scene: " << filename);
+      return false;
+    }
+  }
+
+  // replay all the complete records
+  std::uint64_t validSize = static_cast<std::uint64_t>(file.tellg());
+  std::size_t nbCheckpoints = 0;
+
+  while(readRecord(file, fileSize, type, payload) && type == ERecordType::CHECKPOINT)
+  {
+    try
+    {
+      lastIteration = applyCheckpoint(payload, sfmData);
+    }
+    catch(const std::exception& e)
+    {
+      // records are only appended after a successful write,
+      // a valid checksum with an invalid content means a different build or input
+      ALICEVISION_LOG_ERROR("Unable to replay checkpoint " << nbCheckpoints << " of " << filename << ": " << e.what());
+      return false;
+    }
+    ++nbCheckpoints;
+    validSize = static_cast<std::uint64_t>(file.tellg());
+  }
+
+  file.close();
+
+  // remove the incomplete record of an interrupted write
+  if(fileSize != validSize)
+  {
+    ALICEVISION_LOG_WARNING("Remove the incomplete end of the checkpoint log: " << filename);
+    fs::resize_file(filename, validSize);
+  }
+
+  _file.open(filename, std::ios::binary | std::ios::app);
+  if(!_file.is_open())
+  {
+    ALICEVISION_LOG_ERROR("Unable to open the checkpoint log for append: " << filename);
+    return false;
+  }
+
+  resetState(sfmData);
+  _nbCheckpoints = nbCheckpoints;
+
+  ALICEVISION_LOG_INFO("Checkpoint log resumed:" << std::endl
+                       << "\t- # checkpoints: " << nbCheckpoints << std::endl
+                       << "\t- # poses: " << sfmData.getPoses().size() << std::endl
+                       << "\t- # landmarks: " << sfmData.getLandmarks().size());
+  return true;
+}
+
+bool CheckpointLog::append(const sfmData::SfMData& sfmData, IndexT iteration)
+{
+  if(!isOpen())
+    return false;
+
+  RecordWriter writer;
+  writer.put(iteration);
+
+  // views
+  {
+    const std::size_t countOffset = writer.beginCount();
+    std::size_t count = 0;
+    for(const auto& viewPair : sfmData.getViews())
+    {
+      const sfmData::View& view = *viewPair.second;
+      const ViewState state{view.getPoseId(), view.getIntrinsicId(), view.getResectionId(),
+                            view.getRigId(), view.getSubPoseId(), view.isPoseIndependant()};
+
+      auto lastStateIt = _views.find(viewPair.first);
+      if(lastStateIt != _views.end() && lastStateIt->second == state)
+        continue;
+      _views[viewPair.first] = state;
+
+      writer.put(viewPair.first);
+      writer.put(state.poseId);
+      writer.put(state.intrinsicId);
+      writer.put(state.resectionId);
+      writer.put(state.rigId);
+      writer.put(state.subPoseId);
+      writer.put(static_cast<std::uint8_t>(state.independentPose));
+      ++count;
+    }
+    writer.endCount(countOffset, count);
+  }
+
+  // intrinsics
+  {
+    std::vector<IndexT> removed;
+    for(const auto& intrinsicPair : _intrinsics)
+    {
+      if(sfmData.getIntrinsics().count(intrinsicPair.first) == 0)
+        removed.push_back(intrinsicPair.first);
+    }
+    writer.put(static_cast<std::uint32_t>(removed.size()));
+    for(IndexT intrinsicId : removed)
+    {
+      writer.put(intrinsicId);
+      _intrinsics.erase(intrinsicId);
+    }
+
+    const std::size_t countOffset = writer.beginCount();
+    std::size_t count = 0;
+    for(const auto& intrinsicPair : sfmData.getIntrinsics())
+    {
+      IntrinsicState state{intrinsicDescription(intrinsicPair.first, intrinsicPair.second), intrinsicPair.second->getParams()};
+
+      auto lastStateIt = _intrinsics.find(intrinsicPair.first);
+      if(lastStateIt != _intrinsics.end() &&
+         lastStateIt->second.description == state.description &&
+         lastStateIt->second.params == state.params)
+        continue;
+
+      writer.putString(state.description);
+      writer.putVector(state.params);
+      _intrinsics[intrinsicPair.first] = std::move(state);
+      ++count;
+    }
+    writer.endCount(countOffset, count);
+  }
+
+  // rigs
+  {
+    std::vector<IndexT> removed;
+    for(const auto& rigPair : _rigs)
+    {
+      if(sfmData.getRigs().count(rigPair.first) == 0)
+        removed.push_back(rigPair.first);
+    }
+    writer.put(static_cast<std::uint32_t>(removed.size()));
+    for(IndexT rigId : removed)
+    {
+      writer.put(rigId);
+      _rigs.erase(rigId);
+    }
+
+    const std::size_t countOffset = writer.beginCount();
+    std::size_t count = 0;
+    for(const auto& rigPair : sfmData.getRigs())
+    {
+      auto lastStateIt = _rigs.find(rigPair.first);
+      if(lastStateIt != _rigs.end() && isSameRig(lastStateIt->second, rigPair.second))
+        continue;
+
+      writer.put(rigPair.first);
+      writer.put(static_cast<std::uint32_t>(rigPair.second.getNbSubPoses()));
+      for(const sfmData::RigSubPose& subPose : rigPair.second.getSubPoses())
+      {
+        writer.put(static_cast<std::uint8_t>(subPose.status));
+        writer.putPose(subPose.pose);
+      }
+      _rigs[rigPair.first] = rigPair.second;
+      ++count;
+    }
+    writer.endCount(countOffset, count);
+  }
+
+  // poses
+  {
+    std::vector<IndexT> removed;
+    for(const auto& posePair : _poses)
+    {
+      if(sfmData.getPoses().count(posePair.first) == 0)
+        removed.push_back(posePair.first);
+    }
+    writer.put(static_cast<std::uint32_t>(removed.size()));
+    for(IndexT poseId : removed)
+    {
+      writer.put(poseId);
+      _poses.erase(poseId);
+    }
+
+    const std::size_t countOffset = writer.beginCount();
+    std::size_t count = 0;
+    for(const auto& posePair : sfmData.getPoses())
+    {
+      const sfmData::CameraPose& pose = posePair.second;
+
+      auto lastStateIt = _poses.find(posePair.first);
+      if(lastStateIt != _poses.end() &&
+         lastStateIt->second.isLocked() == pose.isLocked() &&
+         isSamePose(lastStateIt->second.getTransform(), pose.getTransform()))
+        continue;
+
+      writer.put(posePair.first);
+      writer.putPose(pose.getTransform());
+      writer.put(static_cast<std::uint8_t>(pose.isLocked()));
+      _poses[posePair.first] = pose;
+      ++count;
+    }
+    writer.endCount(countOffset, count);
+  }
+
+  // landmarks
+  {
+    const sfmData::Landmarks& landmarks = sfmData.getLandmarks();
+
+    std::vector<IndexT> removed;
+    for(const auto& landmarkPair : _landmarks)
+    {
+      if(landmarks.count(landmarkPair.first) == 0)
+        removed.push_back(landmarkPair.first);
+    }
+    writer.put(static_cast<std::uint32_t>(removed.size()));
+    for(IndexT landmarkId : removed)
+    {
+      writer.put(landmarkId);
+      _landmarks.erase(landmarkId);
+    }
+
+    // new landmarks or landmarks with modified observations are fully written,
+    // the other ones only if they have moved
+    std::vector<IndexT> moved;
+
+    const std::size_t countOffset = writer.beginCount();
+    std::size_t count = 0;
+    for(const auto& landmarkPair : landmarks)
+    {
+      const sfmData::Landmark& landmark = landmarkPair.second;
+      const std::uint64_t hash = hashLandmark(landmark);
+
+      auto lastStateIt = _landmarks.find(landmarkPair.first);
+      if(lastStateIt != _landmarks.end() && lastStateIt->second.hash == hash)
+      {
+        if(lastStateIt->second.X != landmark.X)
+        {
+          moved.push_back(landmarkPair.first);
+          lastStateIt->second.X = landmark.X;
+        }
+        continue;
+      }
+
+      writer.put(landmarkPair.first);
+      writer.put(static_cast<std::uint32_t>(landmark.descType));
+      writer.put(std::array<double, 3>{{landmark.X(0), landmark.X(1), landmark.X(2)}});
+      for(int c = 0; c < 3; ++c)
+        writer.put(static_cast<std::uint8_t>(landmark.rgb(c)));
+      writer.put(static_cast<std::uint32_t>(landmark.observations.size()));
+      for(const auto& observationPair : landmark.observations)
+      {
+        const sfmData::Observation& observation = observationPair.second;
+        writer.put(observationPair.first);
+        writer.put(observation.id_feat);
+        writer.put(observation.x(0));
+        writer.put(observation.x(1));
+        writer.put(observation.scale);
+      }
+      _landmarks[landmarkPair.first] = LandmarkState{landmark.X, hash};
+      ++count;
+    }
+    writer.endCount(countOffset, count);
+
+    writer.put(static_cast<std::uint32_t>(moved.size()));
+    for(IndexT landmarkId : moved)
+    {
+      const Vec3& X = landmarks.at(landmarkId).X;
+      writer.put(landmarkId);
+      writer.put(X(0));
+      writer.put(X(1));
+      writer.put(X(2));
+    }
+  }
+
+  if(!writeRecord(_file, ERecordType::CHECKPOINT, writer.data()))
+  {
+    // the last checkpoint state is no longer the state of the file
+    ALICEVISION_LOG_ERROR("Unable to write the checkpoint " << _nbCheckpoints << ", the checkpoint log is closed.");
+    close();
+    return false;
+  }
+
+  ++_nbCheckpoints;
+  return true;
+}
+
+void CheckpointLog::close()
+{
+  if(_file.is_open())
+    _file.close();
+
+  _nbCheckpoints = 0;
+  _views.clear();
+  _intrinsics.clear();
+  _poses.clear();
+  _rigs.clear();
+  _landmarks.clear();
+}
+
+void CheckpointLog::resetState(const sfmData::SfMData& sfmData)
+{
+  _nbCheckpoints = 0;
+
+  _views.clear();
+  for(const auto& viewPair : sfmData.getViews())
+  {
+    const sfmData::View& view = *viewPair.second;
+    _views[viewPair.first] = ViewState{view.getPoseId(), view.getIntrinsicId(), view.getResectionId(),
+                                       view.getRigId(), view.getSubPoseId(), view.isPoseIndependant()};
+  }
+
+  _intrinsics.clear();
+  for(const auto& intrinsicPair : sfmData.getIntrinsics())
+    _intrinsics[intrinsicPair.first] = IntrinsicState{intrinsicDescription(intrinsicPair.first, intrinsicPair.second),
+                                                      intrinsicPair.second->getParams()};
+
+  _poses.clear();
+  for(const auto& posePair : sfmData.getPoses())
+    _poses[posePair.first] = posePair.second;
+
+  _rigs = sfmData.getRigs();
+
+  _landmarks.clear();
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+    _landmarks[landmarkPair.first] = LandmarkState{landmarkPair.second.X, hashLandmark(landmarkPair.second)};
+}
+
+std::uint64_t CheckpointLog::hashViews(const sfmData::SfMData& sfmData)
+{
+  std::vector<IndexT> viewIds;
+  viewIds.reserve(sfmData.getViews().size());
+  for(const auto& viewPair : sfmData.getViews())
+    viewIds.push_back(viewPair.first);
+  std::sort(viewIds.begin(), viewIds.end());
+
+  return hashBytes(viewIds.data(), viewIds.size() * sizeof(IndexT));
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
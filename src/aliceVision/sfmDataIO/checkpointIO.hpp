@@ -0,0 +1,148 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmData/SfMData.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+/**
+ * @brief Checkpoint log file format version.
+ * @note Must be incremented when the record layout changes.
+ */
+#define ALICEVISION_SFMDATAIO_CHECKPOINT_VERSION 1
+
+/**
+ * @brief Append-only log of the changes of an SfMData during a reconstruction.
+ *
+ * The log starts with a fingerprint of the reference scene (its views),
+ * then each checkpoint appends a record with the differences since the previous one:
+ * view fields (pose, intrinsic, rig and resection ids), poses, intrinsics, rigs,
+ * added, removed or re-observed landmarks and moved landmarks positions.
+ * Each record has its own checksum, an incomplete record at the end of the file
+ * (interrupted write) is ignored and removed when the log is resumed.
+ *
+ * @note The log is meant to restart an interrupted reconstruction
+ *       with the same input scene and the same AliceVision build,
+ *       it is not an exchange format.
+ * @note Control points are not tracked.
+ */
+class CheckpointLog
+{
+public:
+  CheckpointLog() = default;
+
+  CheckpointLog(const CheckpointLog&) = delete;
+  CheckpointLog& operator=(const CheckpointLog&) = delete;
+
+  /**
+   * @brief Create a new log, the given scene is the reference state.
+   * @param[in] filename The log filename, overwritten if it exists
+   * @param[in] sfmData The reference scene
+   * @return true if the log is created
+   */
+  bool create(const std::string& filename, const sfmData::SfMData& sfmData);
+
+  /**
+   * @brief Replay an existing log on its reference scene and continue it.
+   * @param[in] filename The log filename
+   * @param[in,out] sfmData The reference scene, updated with all the complete records
+   * @param[out] lastIteration The iteration of the last complete record (UndefinedIndexT if none)
+   * @return true if the log is valid for the given scene and open for append
+   */
+  bool resume(const std::string& filename, sfmData::SfMData& sfmData, IndexT& lastIteration);
+
+  /**
+   * @brief Append the changes of the scene since the last checkpoint.
+   * @param[in] sfmData The current scene
+   * @param[in] iteration The iteration of the checkpoint
+   * @return true if the record is written
+   */
+  bool append(const sfmData::SfMData& sfmData, IndexT iteration);
+
+  /**
+   * @brief Close the log.
+   */
+  void close();
+
+  /**
+   * @brief Check if the log is open for append.
+   * @return true if open
+   */
+  bool isOpen() const
+  {
+    return _file.is_open();
+  }
+
+  /**
+   * @brief Get the number of checkpoints in the log.
+   * @return the number of checkpoints
+   */
+  std::size_t getNbCheckpoints() const
+  {
+    return _nbCheckpoints;
+  }
+
+private:
+  /// view fields updated during the reconstruction
+  struct ViewState
+  {
+    IndexT poseId;
+    IndexT intrinsicId;
+    IndexT resectionId;
+    IndexT rigId;
+    IndexT subPoseId;
+    bool independentPose;
+
+    bool operator==(const ViewState& other) const;
+  };
+
+  /// intrinsic description and exact parameters
+  struct IntrinsicState
+  {
+    std::string description;
+    std::vector<double> params;
+  };
+
+  /// landmark position and hash of all the other landmark data
+  struct LandmarkState
+  {
+    Vec3 X;
+    std::uint64_t hash;
+  };
+
+  /**
+   * @brief Set the last checkpoint state from a scene.
+   * @param[in] sfmData The scene
+   */
+  void resetState(const sfmData::SfMData& sfmData);
+
+  /**
+   * @brief Compute a hash of the scene views identifiers.
+   * @param[in] sfmData The scene
+   * @return the hash
+   */
+  static std::uint64_t hashViews(const sfmData::SfMData& sfmData);
+
+  std::ofstream _file;
+  std::size_t _nbCheckpoints = 0;
+
+  HashMap<IndexT, ViewState> _views;
+  HashMap<IndexT, IntrinsicState> _intrinsics;
+  HashMap<IndexT, sfmData::CameraPose> _poses;
+  std::map<IndexT, sfmData::Rig> _rigs;
+  HashMap<IndexT, LandmarkState> _landmarks;
+};
+
+} // namespace sfmDataIO
+} // namespace aliceVision
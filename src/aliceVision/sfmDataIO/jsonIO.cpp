@@ -6,10 +6,10 @@
 
 #include "jsonIO.hpp"
 #include <aliceVision/camera/camera.hpp>
+#include <aliceVision/sfmDataIO/jsonStream.hpp>
 #include <aliceVision/sfmDataIO/viewIO.hpp>
 
-#include <boost/property_tree/json_parser.hpp>
-
+#include <fstream>
 #include <memory>
 #include <cassert>
 
@@ -367,6 +367,188 @@ void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, bpt::ptree& l
 }
 
 
+namespace {
+
+void writePose(JsonWriter& writer, IndexT poseId, const sfmData::CameraPose& cameraPose)
+{
+  const geometry::Pose3& transform = cameraPose.getTransform();
+
+  writer.beginObject();
+  writer.write("poseId", poseId);
+  writer.beginObject("pose");
+  writer.beginObject("transform");
+  writer.writeMatrix("rotation", transform.rotation());
+  writer.writeMatrix("center", transform.center());
+  writer.endObject();
+  writer.write("locked", static_cast<int>(cameraPose.isLocked())); // convert bool to integer to avoid using "true/false" in exported file instead of "1/0".
+  writer.endObject();
+  writer.endObject();
+}
+
+void readPose(JsonReader& reader, IndexT& poseId, sfmData::CameraPose& cameraPose)
+{
+  Mat3 rotation = Mat3::Identity();
+  Vec3 center = Vec3::Zero();
+  bool locked = false;
+  std::string key;
+
+  if(reader.beginObject())
+  {
+    while(reader.nextKey(key))
+    {
+      if(key == "poseId")
+      {
+        reader.readValue(poseId);
+      }
+      else if(key == "pose")
+      {
+        if(!reader.beginObject())
+          continue;
+
+        while(reader.nextKey(key))
+        {
+          if(key == "transform")
+          {
+            if(!reader.beginObject())
+              continue;
+
+            while(reader.nextKey(key))
+            {
+              if(key == "rotation")
+                reader.readMatrix(rotation);
+              else if(key == "center")
+                reader.readMatrix(center);
+              else
+                reader.skipValue();
+            }
+          }
+          else if(key == "locked")
+            reader.readValue(locked);
+          else
+            reader.skipValue();
+        }
+      }
+      else
+      {
+        reader.skipValue();
+      }
+    }
+  }
+
+  cameraPose.setTransform(geometry::Pose3(rotation, center));
+  if(locked)
+    cameraPose.lock();
+  else
+    cameraPose.unlock();
+}
+
+void writeLandmark(JsonWriter& writer, IndexT landmarkId, const sfmData::Landmark& landmark, bool saveObservations, bool saveFeatures)
+{
+  writer.beginObject();
+  writer.write("landmarkId", landmarkId);
+  writer.write("descType", feature::EImageDescriberType_enumToString(landmark.descType));
+  writer.writeMatrix("color", landmark.rgb);
+  writer.writeMatrix("X", landmark.X);
+
+  // observations
+  if(saveObservations)
+  {
+    writer.beginArray("observations");
+    for(const auto& obsPair : landmark.observations)
+    {
+      const sfmData::Observation& observation = obsPair.second;
+
+      writer.beginObject();
+      writer.write("observationId", obsPair.first);
+
+      // features
+      if(saveFeatures)
+      {
+        writer.write("featureId", observation.id_feat);
+        writer.writeMatrix("x", observation.x);
+        writer.write("scale", observation.scale);
+      }
+      writer.endObject();
+    }
+    writer.endArray();
+  }
+
+  writer.endObject();
+}
+
+void readLandmark(JsonReader& reader, IndexT& landmarkId, sfmData::Landmark& landmark, bool loadObservations, bool loadFeatures)
+{
+  std::string key;
+
+  if(!reader.beginObject())
+    return;
+
+  while(reader.nextKey(key))
+  {
+    if(key == "landmarkId")
+      reader.readValue(landmarkId);
+    else if(key == "descType")
+      landmark.descType = feature::EImageDescriberType_stringToEnum(reader.readString());
+    else if(key == "color")
+      reader.readMatrix(landmark.rgb);
+    else if(key == "X")
+      reader.readMatrix(landmark.X);
+    else if(key == "observations" && loadObservations)
+    {
+      if(!reader.beginArray())
+        continue;
+
+      while(reader.nextElement())
+      {
+        IndexT observationId = UndefinedIndexT;
+        sfmData::Observation observation;
+
+        if(reader.beginObject())
+        {
+          while(reader.nextKey(key))
+          {
+            if(key == "observationId")
+              reader.readValue(observationId);
+            else if(key == "featureId" && loadFeatures)
+              reader.readValue(observation.id_feat);
+            else if(key == "x" && loadFeatures)
+              reader.readMatrix(observation.x);
+            else if(key == "scale" && loadFeatures)
+              reader.readValue(observation.scale);
+            else
+              reader.skipValue();
+          }
+        }
+
+        // observations are saved in the flat map order
+        landmark.observations.emplace_hint(landmark.observations.end(), observationId, observation);
+      }
+    }
+    else
+    {
+      reader.skipValue();
+    }
+  }
+}
+
+void readLandmarks(JsonReader& reader, sfmData::Landmarks& landmarks, bool loadObservations, bool loadFeatures)
+{
+  if(!reader.beginArray())
+    return;
+
+  while(reader.nextElement())
+  {
+    IndexT landmarkId = UndefinedIndexT;
+    sfmData::Landmark landmark;
+
+    readLandmark(reader, landmarkId, landmark, loadObservations, loadFeatures);
+
+    landmarks.emplace(landmarkId, std::move(landmark));
+  }
+}
+
+} // namespace
+
 bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
 {
   const Vec3i version = {ALICEVISION_SFMDATAIO_VERSION_MAJOR, ALICEVISION_SFMDATAIO_VERSION_MINOR, ALICEVISION_SFMDATAIO_VERSION_REVISION};
@@ -380,61 +562,59 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
   const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
   const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
-  // main tree
-  bpt::ptree fileTree;
+  std::ofstream stream(filename);
+
+  if(!stream.is_open())
+    throw std::runtime_error("Unable to open the JSON SfMData file '" + filename + "' for writing.");
+
+  // the document is written while it is produced, the small elements (views, intrinsics, rigs)
+  // go through a property tree to share the serialization with the other formats
+  JsonWriter writer(stream);
 
   // file version
-  saveMatrix("version", version, fileTree);
+  writer.writeMatrix("version", version);
 
   // folders
   if(!sfmData.getRelativeFeaturesFolders().empty())
   {
-    bpt::ptree featureFoldersTree;
-
+    writer.beginArray("featuresFolders");
     for(const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
-    {
-      bpt::ptree featureFolderTree;
-      featureFolderTree.put("", featuresFolder);
-      featureFoldersTree.push_back(std::make_pair("", featureFolderTree));
-    }
-
-    fileTree.add_child("featuresFolders", featureFoldersTree);
+      writer.write("", featuresFolder);
+    writer.endArray();
   }
 
   if(!sfmData.getRelativeMatchesFolders().empty())
   {
-    bpt::ptree matchingFoldersTree;
-
+    writer.beginArray("matchesFolders");
     for(const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
-    {
-      bpt::ptree matchingFolderTree;
-      matchingFolderTree.put("", matchesFolder);
-      matchingFoldersTree.push_back(std::make_pair("", matchingFolderTree));
-    }
-
-    fileTree.add_child("matchesFolders", matchingFoldersTree);
+      writer.write("", matchesFolder);
+    writer.endArray();
   }
 
   // views
   if(saveViews && !sfmData.getViews().empty())
   {
-    bpt::ptree viewsTree;
-
+    writer.beginArray("views");
     for(const auto& viewPair : sfmData.getViews())
+    {
+      bpt::ptree viewsTree;
       saveView("", *(viewPair.second), viewsTree);
-
-    fileTree.add_child("views", viewsTree);
+      writer.writeTree("", viewsTree.front().second);
+    }
+    writer.endArray();
   }
 
   // intrinsics
   if(saveIntrinsics && !sfmData.getIntrinsics().empty())
   {
-    bpt::ptree intrinsicsTree;
-
+    writer.beginArray("intrinsics");
     for(const auto& intrinsicPair : sfmData.getIntrinsics())
+    {
+      bpt::ptree intrinsicsTree;
       saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
-
-    fileTree.add_child("intrinsics", intrinsicsTree);
+      writer.writeTree("", intrinsicsTree.front().second);
+    }
+    writer.endArray();
   }
 
   //extrinsics
@@ -443,57 +623,45 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
     // poses
     if(!sfmData.getPoses().empty())
     {
-      bpt::ptree posesTree;
-
+      writer.beginArray("poses");
       for(const auto& posePair : sfmData.getPoses())
-      {
-        bpt::ptree poseTree;
-
-        poseTree.put("poseId", posePair.first);
-        saveCameraPose("pose", posePair.second, poseTree);
-        posesTree.push_back(std::make_pair("", poseTree));
-      }
-
-      fileTree.add_child("poses", posesTree);
+        writePose(writer, posePair.first, posePair.second);
+      writer.endArray();
     }
 
     // rigs
     if(!sfmData.getRigs().empty())
     {
-      bpt::ptree rigsTree;
-
+      writer.beginArray("rigs");
       for(const auto& rigPair : sfmData.getRigs())
+      {
+        bpt::ptree rigsTree;
         saveRig("", rigPair.first, rigPair.second, rigsTree);
-
-      fileTree.add_child("rigs", rigsTree);
+        writer.writeTree("", rigsTree.front().second);
+      }
+      writer.endArray();
     }
   }
 
   // structure
   if(saveStructure && !sfmData.getLandmarks().empty())
   {
-    bpt::ptree structureTree;
-
+    writer.beginArray("structure");
     for(const auto& structurePair : sfmData.getLandmarks())
-      saveLandmark("", structurePair.first, structurePair.second, structureTree, saveObservations, saveFeatures);
-
-    fileTree.add_child("structure", structureTree);
+      writeLandmark(writer, structurePair.first, structurePair.second, saveObservations, saveFeatures);
+    writer.endArray();
   }
 
   // control points
   if(saveControlPoints && !sfmData.getControlPoints().empty())
   {
-    bpt::ptree controlPointTree;
-
+    writer.beginArray("controlPoints");
     for(const auto& controlPointPair : sfmData.getControlPoints())
-      saveLandmark("", controlPointPair.first, controlPointPair.second, controlPointTree);
-
-    fileTree.add_child("controlPoints", controlPointTree);
+      writeLandmark(writer, controlPointPair.first, controlPointPair.second, true, true);
+    writer.endArray();
   }
 
-  // write the json file with the tree
-
-  bpt::write_json(filename, fileTree);
+  writer.close();
 
   return true;
 }
@@ -512,169 +680,178 @@ bool loadJSON(sfmData::SfMData& sfmData, const std::string& filename, ESfMData p
   const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
   const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
-  // main tree
-  bpt::ptree fileTree;
+  std::ifstream stream(filename, std::ios::binary);
 
-  // read the json file and initialize the tree
-  bpt::read_json(filename, fileTree);
+  if(!stream.is_open())
+    throw std::runtime_error("Unable to open the JSON SfMData file '" + filename + "'.");
 
-  // version
-  {
-    Vec3i v;
-    loadMatrix("version", v, fileTree);
-    version = v;
-  }
+  // the document is read while it is parsed, the small elements (views, intrinsics, rigs)
+  // go through a property tree to share the deserialization with the other formats
+  JsonReader reader(stream);
 
-  // folders
-  if(fileTree.count("featuresFolders"))
-    for(bpt::ptree::value_type& featureFolderNode : fileTree.get_child("featuresFolders"))
-      sfmData.addFeaturesFolder(featureFolderNode.second.get_value<std::string>());
+  bool hasVersion = false;
+  std::vector<bpt::ptree> intrinsicTrees; // loaded once the version is known
+  std::vector<sfmData::View> loadedViews; // completed once the intrinsics are loaded
+  std::string key;
 
-  if(fileTree.count("matchesFolders"))
-    for(bpt::ptree::value_type& matchingFolderNode : fileTree.get_child("matchesFolders"))
-      sfmData.addMatchesFolder(matchingFolderNode.second.get_value<std::string>());
+  if(!reader.beginObject())
+    throw std::runtime_error("Invalid JSON SfMData file '" + filename + "'.");
 
-  // intrinsics
-  if(loadIntrinsics && fileTree.count("intrinsics"))
+  while(reader.nextKey(key))
   {
-    sfmData::Intrinsics& intrinsics = sfmData.getIntrinsics();
-
-    for(bpt::ptree::value_type &intrinsicNode : fileTree.get_child("intrinsics"))
+    if(key == "version")
     {
-      IndexT intrinsicId;
-      std::shared_ptr<camera::IntrinsicBase> intrinsic;
-
-      loadIntrinsic(version, intrinsicId, intrinsic, intrinsicNode.second);
-
-      intrinsics.emplace(intrinsicId, intrinsic);
+      Vec3i v;
+      reader.readMatrix(v);
+      version = v;
+      hasVersion = true;
     }
-  }
-
-  // views
-  if(loadViews && fileTree.count("views"))
-  {
-    sfmData::Views& views = sfmData.getViews();
-
-    if(incompleteViews)
+    else if(key == "featuresFolders")
     {
-      // store incomplete views in a vector
-      std::vector<sfmData::View> incompleteViews(fileTree.get_child("views").size());
-
-      int viewIndex = 0;
-      for(bpt::ptree::value_type &viewNode : fileTree.get_child("views"))
-      {
-        loadView(incompleteViews.at(viewIndex), viewNode.second);
-        ++viewIndex;
-      }
-
-      // update incomplete views
-      #pragma omp parallel for
-      for(int i = 0; i < incompleteViews.size(); ++i)
+      if(reader.beginArray())
+        while(reader.nextElement())
+          sfmData.addFeaturesFolder(reader.readString());
+    }
+    else if(key == "matchesFolders")
+    {
+      if(reader.beginArray())
+        while(reader.nextElement())
+          sfmData.addMatchesFolder(reader.readString());
+    }
+    else if(key == "intrinsics" && loadIntrinsics)
+    {
+      if(reader.beginArray())
       {
-        sfmData::View& v = incompleteViews.at(i);
-
-        // if we have the intrinsics and the view has an valid associated intrinsics
-        // update the width and height field of View (they are mirrored)
-        if (loadIntrinsics && v.getIntrinsicId() != UndefinedIndexT)
+        while(reader.nextElement())
         {
-          const auto intrinsics = sfmData.getIntrinsicPtr(v.getIntrinsicId());
-
-          if(intrinsics == nullptr)
-          {
-            throw std::logic_error("View " + std::to_string(v.getViewId())
-                                   + " has a intrinsics id " +std::to_string(v.getIntrinsicId())
-                                   + " that cannot be found or the intrinsics are not correctly "
-                                     "loaded from the json file.");
-          }
-
-          v.setWidth(intrinsics->w());
-          v.setHeight(intrinsics->h());
+          intrinsicTrees.emplace_back();
+          reader.readTree(intrinsicTrees.back());
         }
-        updateIncompleteView(incompleteViews.at(i), viewIdMethod, viewIdRegex);
       }
-
-      // copy complete views in the SfMData views map
-      for(const sfmData::View& view : incompleteViews)
-        views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
     }
-    else
+    else if(key == "views" && loadViews)
     {
-      // store directly in the SfMData views map
-      for(bpt::ptree::value_type &viewNode : fileTree.get_child("views"))
+      if(reader.beginArray())
       {
-        sfmData::View view;
-        loadView(view, viewNode.second);
-        views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
+        while(reader.nextElement())
+        {
+          bpt::ptree viewTree;
+          reader.readTree(viewTree);
+          loadedViews.emplace_back();
+          loadView(loadedViews.back(), viewTree);
+        }
       }
     }
-  }
-
-  // extrinsics
-  if(loadExtrinsics)
-  {
-    // poses
-    if(fileTree.count("poses"))
+    else if(key == "poses" && loadExtrinsics)
     {
       sfmData::Poses& poses = sfmData.getPoses();
 
-      for(bpt::ptree::value_type &poseNode : fileTree.get_child("poses"))
+      if(reader.beginArray())
       {
-        bpt::ptree& poseTree = poseNode.second;
-        sfmData::CameraPose pose;
+        while(reader.nextElement())
+        {
+          IndexT poseId = UndefinedIndexT;
+          sfmData::CameraPose pose;
 
-        loadCameraPose("pose", pose, poseTree);
+          readPose(reader, poseId, pose);
 
-        poses.emplace(poseTree.get<IndexT>("poseId"), pose);
+          poses.emplace(poseId, pose);
+        }
       }
     }
-
-    // rigs
-    if(fileTree.count("rigs"))
+    else if(key == "rigs" && loadExtrinsics)
     {
       sfmData::Rigs& rigs = sfmData.getRigs();
 
-      for(bpt::ptree::value_type &rigNode : fileTree.get_child("rigs"))
+      if(reader.beginArray())
       {
-        IndexT rigId;
-        sfmData::Rig rig;
+        while(reader.nextElement())
+        {
+          bpt::ptree rigTree;
+          reader.readTree(rigTree);
+
+          IndexT rigId;
+          sfmData::Rig rig;
 
-        loadRig(rigId, rig, rigNode.second);
+          loadRig(rigId, rig, rigTree);
 
-        rigs.emplace(rigId, rig);
+          rigs.emplace(rigId, rig);
+        }
       }
     }
+    else if(key == "structure" && loadStructure)
+    {
+      readLandmarks(reader, sfmData.getLandmarks(), loadObservations, loadFeatures);
+    }
+    else if(key == "controlPoints" && loadControlPoints)
+    {
+      readLandmarks(reader, sfmData.getControlPoints(), true, true);
+    }
+    else
+    {
+      // unknown or not requested part
+      reader.skipValue();
+    }
   }
 
-  // structure
-  if(loadStructure && fileTree.count("structure"))
+  reader.close();
+
+  if(!hasVersion)
+    throw std::runtime_error("Invalid JSON SfMData file '" + filename + "', no version found.");
+
+  // intrinsics
+  if(loadIntrinsics)
   {
-    sfmData::Landmarks& structure = sfmData.getLandmarks();
+    sfmData::Intrinsics& intrinsics = sfmData.getIntrinsics();
 
-    for(bpt::ptree::value_type &landmarkNode : fileTree.get_child("structure"))
+    for(bpt::ptree& intrinsicTree : intrinsicTrees)
     {
-      IndexT landmarkId;
-      sfmData::Landmark landmark;
+      IndexT intrinsicId;
+      std::shared_ptr<camera::IntrinsicBase> intrinsic;
 
-      loadLandmark(landmarkId, landmark, landmarkNode.second, loadObservations, loadFeatures);
+      loadIntrinsic(version, intrinsicId, intrinsic, intrinsicTree);
 
-      structure.emplace(landmarkId, landmark);
+      intrinsics.emplace(intrinsicId, intrinsic);
     }
   }
 
-  // control points
-  if(loadControlPoints && fileTree.count("controlPoints"))
+  // views
+  if(loadViews)
   {
-    sfmData::Landmarks& controlPoints = sfmData.getControlPoints();
+    sfmData::Views& views = sfmData.getViews();
 
-    for(bpt::ptree::value_type &landmarkNode : fileTree.get_child("controlPoints"))
+    if(incompleteViews)
     {
-      IndexT landmarkId;
-      sfmData::Landmark landmark;
+      // update incomplete views
+      #pragma omp parallel for
+      for(int i = 0; i < loadedViews.size(); ++i)
+      {
+        sfmData::View& v = loadedViews.at(i);
 
-      loadLandmark(landmarkId, landmark, landmarkNode.second);
+        // if we have the intrinsics and the view has an valid associated intrinsics
+        // update the width and height field of View (they are mirrored)
+        if (loadIntrinsics && v.getIntrinsicId() != UndefinedIndexT)
+        {
+          const auto intrinsics = sfmData.getIntrinsicPtr(v.getIntrinsicId());
 
-      controlPoints.emplace(landmarkId, landmark);
+          if(intrinsics == nullptr)
+          {
+            throw std::logic_error("View " + std::to_string(v.getViewId())
+                                   + " has a intrinsics id " +std::to_string(v.getIntrinsicId())
+                                   + " that cannot be found or the intrinsics are not correctly "
+                                     "loaded from the json file.");
+          }
+
+          v.setWidth(intrinsics->w());
+          v.setHeight(intrinsics->h());
+        }
+        updateIncompleteView(loadedViews.at(i), viewIdMethod, viewIdRegex);
+      }
     }
+
+    // copy views in the SfMData views map
+    for(const sfmData::View& view : loadedViews)
+      views.emplace(view.getViewId(), std::make_shared<sfmData::View>(view));
   }
 
   return true;
@@ -0,0 +1,632 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "jsonStream.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace {
+
+/**
+ * @brief Format an integer in a character buffer.
+ * @return the number of characters written at the end of the buffer
+ */
+template<typename T>
+std::size_t formatInteger(T value, char (&buffer)[24], char*& first)
+{
+  using U = typename std::make_unsigned<T>::type;
+  const bool negative = value < 0;
+  U u = negative ? static_cast<U>(U(0) - static_cast<U>(value)) : static_cast<U>(value);
+
+  char* last = buffer + sizeof(buffer);
+  first = last;
+  do
+  {
+    *--first = static_cast<char>('0' + (u % 10));
+    u /= 10;
+  }
+  while(u != 0);
+
+  if(negative)
+    *--first = '-';
+
+  return static_cast<std::size_t>(last - first);
+}
+
+/**
+ * @brief Parse an integer from a character range, without locale and stream.
+ * @note Like the stream extraction, a negative value is accepted for an unsigned type.
+ */
+template<typename T>
+bool parseInteger(const char* first, const char* last, T& value)
+{
+  using U = typename std::make_unsigned<T>::type;
+
+  bool negative = false;
+  if(first != last && (*first == '-' || *first == '+'))
+  {
+    negative = (*first == '-');
+    ++first;
+  }
+  if(first == last)
+    return false;
+
+  const U maxValue = std::is_signed<T>::value ? static_cast<U>(std::numeric_limits<T>::max()) + (negative ? 1 : 0)
+                                              : std::numeric_limits<U>::max();
+  U u = 0;
+  for(; first != last; ++first)
+  {
+    const unsigned int digit = static_cast<unsigned int>(*first - '0');
+    if(digit > 9)
+      return false;
+    if(u > (maxValue - digit) / 10)
+      return false;
+    u = u * 10 + digit;
+  }
+
+  value = negative ? static_cast<T>(U(0) - u) : static_cast<T>(u);
+  return true;
+}
+
+} // namespace
+
+JsonWriter::JsonWriter(std::ostream& stream, std::size_t bufferSize)
+  : _stream(stream)
+  , _bufferSize(bufferSize)
+{
+  _buffer.reserve(bufferSize + 1024);
+  _scopes.push_back({'{', true});
+}
+
+void JsonWriter::beginObject(const std::string& key)
+{
+  beginValue(key);
+  _scopes.push_back({'{', true});
+}
+
+void JsonWriter::beginArray(const std::string& key)
+{
+  beginValue(key);
+  _scopes.push_back({'[', true});
+}
+
+void JsonWriter::write(const std::string& key, const std::string& value)
+{
+  beginValue(key);
+  _buffer.push_back('"');
+  writeEscaped(value.data(), value.size());
+  _buffer.push_back('"');
+  flushIfNeeded();
+}
+
+void JsonWriter::write(const std::string& key, bool value)
+{
+  if(value)
+    writeRaw(key, "true", 4);
+  else
+    writeRaw(key, "false", 5);
+}
+
+#define ALICEVISION_JSONWRITER_INTEGER(T)               \
+  void JsonWriter::write(const std::string& key, T value) \
+  {                                                     \
+    char buffer[24];                                    \
+    char* first;                                        \
+    const std::size_t size = formatInteger(value, buffer, first); \
+    writeRaw(key, first, size);                         \
+  }
+
+ALICEVISION_JSONWRITER_INTEGER(int)
+ALICEVISION_JSONWRITER_INTEGER(unsigned int)
+ALICEVISION_JSONWRITER_INTEGER(long)
+ALICEVISION_JSONWRITER_INTEGER(unsigned long)
+ALICEVISION_JSONWRITER_INTEGER(long long)
+ALICEVISION_JSONWRITER_INTEGER(unsigned long long)
+
+#undef ALICEVISION_JSONWRITER_INTEGER
+
+void JsonWriter::write(const std::string& key, float value)
+{
+  // same precision as the property tree stream translator
+  char buffer[32];
+  const int size = std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<float>::max_digits10, static_cast<double>(value));
+  writeRaw(key, buffer, static_cast<std::size_t>(size));
+}
+
+void JsonWriter::write(const std::string& key, double value)
+{
+  // same precision as the property tree stream translator
+  char buffer[32];
+  const int size = std::snprintf(buffer, sizeof(buffer), "%.*g", std::numeric_limits<double>::max_digits10, value);
+  writeRaw(key, buffer, static_cast<std::size_t>(size));
+}
+
+void JsonWriter::writeTree(const std::string& key, const boost::property_tree::ptree& tree)
+{
+  if(tree.empty())
+  {
+    write(key, tree.data());
+  }
+  else if(tree.count(std::string()) == tree.size())
+  {
+    beginArray(key);
+    for(const auto& child : tree)
+      writeTree(child.first, child.second);
+    endArray();
+  }
+  else
+  {
+    beginObject(key);
+    for(const auto& child : tree)
+      writeTree(child.first, child.second);
+    endObject();
+  }
+}
+
+void JsonWriter::close()
+{
+  if(_scopes.size() != 1)
+    throw std::logic_error("JsonWriter: unbalanced objects or arrays.");
+
+  endScope('}');
+  _buffer.push_back('\n');
+  _stream.write(_buffer.data(), _buffer.size());
+  _stream.flush();
+  _buffer.clear();
+
+  if(!_stream.good())
+    throw std::runtime_error("JsonWriter: write error.");
+}
+
+void JsonWriter::beginValue(const std::string& key)
+{
+  Scope& parent = _scopes.back();
+
+  if(parent.empty)
+  {
+    _buffer.push_back(parent.opening);
+    _buffer.push_back('\n');
+    parent.empty = false;
+  }
+  else
+  {
+    _buffer.append(",\n", 2);
+  }
+
+  _buffer.append(4 * _scopes.size(), ' ');
+
+  if(parent.opening == '{')
+  {
+    _buffer.push_back('"');
+    writeEscaped(key.data(), key.size());
+    _buffer.append("\": ", 3);
+  }
+}
+
+void JsonWriter::writeRaw(const std::string& key, const char* value, std::size_t size)
+{
+  beginValue(key);
+  _buffer.push_back('"');
+  _buffer.append(value, size);
+  _buffer.push_back('"');
+  flushIfNeeded();
+}
+
+void JsonWriter::writeEscaped(const char* value, std::size_t size)
+{
+  // same escaping as boost::property_tree::json_parser::create_escapes
+  static const char* hexDigits = "0123456789ABCDEF";
+
+  for(std::size_t i = 0; i < size; ++i)
+  {
+    const unsigned char c = static_cast<unsigned char>(value[i]);
+
+    if(c == 0x20 || c == 0x21 || (c >= 0x23 && c <= 0x2E) || (c >= 0x30 && c <= 0x5B) || c >= 0x5D)
+    {
+      _buffer.push_back(static_cast<char>(c));
+      continue;
+    }
+
+    _buffer.push_back('\\');
+    switch(c)
+    {
+      case '\b': _buffer.push_back('b'); break;
+      case '\f': _buffer.push_back('f'); break;
+      case '\n': _buffer.push_back('n'); break;
+      case '\r': _buffer.push_back('r'); break;
+      case '\t': _buffer.push_back('t'); break;
+      case '/':  _buffer.push_back('/'); break;
+      case '"':  _buffer.push_back('"'); break;
+      case '\\': _buffer.push_back('\\'); break;
+      default:
+        _buffer.append("u00", 3);
+        _buffer.push_back(hexDigits[c / 16]);
+        _buffer.push_back(hexDigits[c % 16]);
+    }
+  }
+}
+
+void JsonWriter::endScope(char closing)
+{
+  const Scope scope = _scopes.back();
+
+  if((scope.opening == '{') != (closing == '}'))
+    throw std::logic_error("JsonWriter: mismatched end of object or array.");
+
+  _scopes.pop_back();
+
+  if(!scope.empty)
+  {
+    _buffer.push_back('\n');
+    _buffer.append(4 * _scopes.size(), ' ');
+    _buffer.push_back(closing);
+  }
+  else if(_scopes.empty())
+  {
+    // empty root object
+    _buffer.append("{\n}", 3);
+  }
+  else
+  {
+    // empty property tree node
+    _buffer.append("\"\"", 2);
+  }
+
+  flushIfNeeded();
+}
+
+void JsonWriter::flushIfNeeded()
+{
+  if(_buffer.size() < _bufferSize)
+    return;
+
+  _stream.write(_buffer.data(), _buffer.size());
+  _buffer.clear();
+}
+
+JsonReader::JsonReader(std::istream& stream, std::size_t bufferSize)
+  : _stream(stream)
+  , _buffer(bufferSize)
+{}
+
+bool JsonReader::beginObject()
+{
+  const int c = peekNonSpace();
+
+  if(c == '"')
+  {
+    readStringToken(_token);
+    if(!_token.empty())
+      error("Expected an object");
+    return false;
+  }
+
+  expect('{');
+  _first.push_back(true);
+  return true;
+}
+
+bool JsonReader::nextKey(std::string& key)
+{
+  int c = peekNonSpace();
+
+  if(c == '}')
+  {
+    ++_position;
+    _first.pop_back();
+    return false;
+  }
+
+  if(!_first.back())
+  {
+    expect(',');
+    c = peekNonSpace();
+  }
+  _first.back() = false;
+
+  if(c != '"')
+    error("Expected an object key");
+
+  readStringToken(key);
+  expect(':');
+  return true;
+}
+
+bool JsonReader::beginArray()
+{
+  const int c = peekNonSpace();
+
+  if(c == '"')
+  {
+    readStringToken(_token);
+    if(!_token.empty())
+      error("Expected an array");
+    return false;
+  }
+
+  expect('[');
+  _first.push_back(true);
+  return true;
+}
+
+bool JsonReader::nextElement()
+{
+  const int c = peekNonSpace();
+
+  if(c == ']')
+  {
+    ++_position;
+    _first.pop_back();
+    return false;
+  }
+
+  if(!_first.back())
+    expect(',');
+  _first.back() = false;
+
+  return true;
+}
+
+const std::string& JsonReader::readString()
+{
+  const int c = peekNonSpace();
+
+  if(c == '"')
+    readStringToken(_token);
+  else
+    readScalarToken(_token);
+
+  return _token;
+}
+
+void JsonReader::readValue(bool& value)
+{
+  const std::string& text = readString();
+
+  if(text == "1" || text == "true")
+    value = true;
+  else if(text == "0" || text == "false")
+    value = false;
+  else
+    error("Invalid boolean value '" + text + "'");
+}
+
+#define ALICEVISION_JSONREADER_INTEGER(T)                                   \
+  void JsonReader::readValue(T& value)                                       \
+  {                                                                          \
+    const std::string& text = readString();                                  \
+    if(!parseInteger(text.data(), text.data() + text.size(), value))         \
+      error("Invalid integer value '" + text + "'");                         \
+  }
+
+ALICEVISION_JSONREADER_INTEGER(int)
+ALICEVISION_JSONREADER_INTEGER(unsigned int)
+ALICEVISION_JSONREADER_INTEGER(long)
+ALICEVISION_JSONREADER_INTEGER(unsigned long)
+ALICEVISION_JSONREADER_INTEGER(long long)
+ALICEVISION_JSONREADER_INTEGER(unsigned long long)
+ALICEVISION_JSONREADER_INTEGER(unsigned char)
+
+#undef ALICEVISION_JSONREADER_INTEGER
+
+void JsonReader::readValue(float& value)
+{
+  const std::string& text = readString();
+  char* end = nullptr;
+  value = std::strtof(text.c_str(), &end);
+  if(text.empty() || end != text.c_str() + text.size())
+    error("Invalid floating point value '" + text + "'");
+}
+
+void JsonReader::readValue(double& value)
+{
+  const std::string& text = readString();
+  char* end = nullptr;
+  value = std::strtod(text.c_str(), &end);
+  if(text.empty() || end != text.c_str() + text.size())
+    error("Invalid floating point value '" + text + "'");
+}
+
+void JsonReader::readTree(boost::property_tree::ptree& tree)
+{
+  const int c = peekNonSpace();
+
+  if(c == '{')
+  {
+    beginObject();
+    std::string key;
+    while(nextKey(key))
+    {
+      auto it = tree.push_back(std::make_pair(key, boost::property_tree::ptree()));
+      readTree(it->second);
+    }
+  }
+  else if(c == '[')
+  {
+    beginArray();
+    while(nextElement())
+    {
+      auto it = tree.push_back(std::make_pair(std::string(), boost::property_tree::ptree()));
+      readTree(it->second);
+    }
+  }
+  else
+  {
+    tree.data() = readString();
+  }
+}
+
+void JsonReader::skipValue()
+{
+  const int c = peekNonSpace();
+
+  if(c == '{')
+  {
+    beginObject();
+    std::string key;
+    while(nextKey(key))
+      skipValue();
+  }
+  else if(c == '[')
+  {
+    beginArray();
+    while(nextElement())
+      skipValue();
+  }
+  else
+  {
+    readString();
+  }
+}
+
+void JsonReader::close()
+{
+  if(!_first.empty() || peekNonSpace() != EOF)
+    error("Unexpected content at the end of the document");
+}
+
+void JsonReader::error(const std::string& message) const
+{
+  throw std::runtime_error("JSON parsing error at line " + std::to_string(_line) + ": " + message + ".");
+}
+
+bool JsonReader::fill()
+{
+  _stream.read(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+  _size = static_cast<std::size_t>(_stream.gcount());
+  _position = 0;
+  return _size > 0;
+}
+
+int JsonReader::peek()
+{
+  if(_position == _size && !fill())
+    return EOF;
+  return static_cast<unsigned char>(_buffer[_position]);
+}
+
+int JsonReader::peekNonSpace()
+{
+  for(;;)
+  {
+    const int c = peek();
+
+    if(c == '\n')
+      ++_line;
+    else if(c != ' ' && c != '\t' && c != '\r')
+      return c;
+
+    ++_position;
+  }
+}
+
+void JsonReader::expect(char c)
+{
+  if(peekNonSpace() != static_cast<unsigned char>(c))
+    error(std::string("Expected '") + c + "'");
+  ++_position;
+}
+
+void JsonReader::readStringToken(std::string& out)
+{
+  out.clear();
+  expect('"');
+
+  for(;;)
+  {
+    if(peek() == EOF)
+      error("Unterminated string");
+
+    // copy the plain characters in one go
+    std::size_t end = _position;
+    while(end < _size && _buffer[end] != '"' && _buffer[end] != '\\')
+      ++end;
+    out.append(_buffer.data() + _position, end - _position);
+    _position = end;
+
+    if(_position == _size)
+      continue;
+
+    if(_buffer[_position++] == '"')
+      return;
+
+    // escape sequence
+    if(peek() == EOF)
+      error("Unterminated string");
+
+    const char c = _buffer[_position++];
+    switch(c)
+    {
+      case '"':  out.push_back('"'); break;
+      case '\\': out.push_back('\\'); break;
+      case '/':  out.push_back('/'); break;
+      case 'b':  out.push_back('\b'); break;
+      case 'f':  out.push_back('\f'); break;
+      case 'n':  out.push_back('\n'); break;
+      case 'r':  out.push_back('\r'); break;
+      case 't':  out.push_back('\t'); break;
+      case 'u':
+      {
+        unsigned int codepoint = 0;
+        for(int i = 0; i < 4; ++i)
+        {
+          const int h = peek();
+          if(h == EOF || !std::isxdigit(h))
+            error("Invalid unicode escape sequence");
+          ++_position;
+          codepoint = codepoint * 16 + static_cast<unsigned int>(std::isdigit(h) ? h - '0' : (std::tolower(h) - 'a' + 10));
+        }
+        // UTF-8 encoding
+        if(codepoint < 0x80)
+        {
+          out.push_back(static_cast<char>(codepoint));
+        }
+        else if(codepoint < 0x800)
+        {
+          out.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+          out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        else
+        {
+          out.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+          out.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+          out.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+        break;
+      }
+      default:
+        error(std::string("Invalid escape sequence '\\") + c + "'");
+    }
+  }
+}
+
+void JsonReader::readScalarToken(std::string& out)
+{
+  out.clear();
+
+  for(;;)
+  {
+    const int c = peek();
+    if(c == EOF || !(std::isalnum(c) || c == '-' || c == '+' || c == '.'))
+      break;
+    out.push_back(static_cast<char>(c));
+    ++_position;
+  }
+
+  if(out.empty())
+    error("Expected a value");
+}
+
+} // namespace sfmDataIO
+} // namespace aliceVision
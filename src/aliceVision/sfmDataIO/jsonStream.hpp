@@ -0,0 +1,255 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+/**
+ * @brief Streaming JSON writer.
+ *
+ * Writes the document while it is produced, through a fixed size buffer.
+ * The output is byte-identical to boost::property_tree::write_json:
+ * 4 spaces indentation, all values written as strings and
+ * empty objects or arrays written as an empty string.
+ */
+class JsonWriter
+{
+public:
+  /**
+   * @brief JsonWriter constructor, begins the root object.
+   * @param[in] stream The output stream
+   * @param[in] bufferSize The output buffer size in bytes
+   */
+  explicit JsonWriter(std::ostream& stream, std::size_t bufferSize = 1 << 20);
+
+  /**
+   * @brief Begin an object.
+   * @param[in] key The object key in the parent object ( "" = array element )
+   */
+  void beginObject(const std::string& key = std::string());
+
+  /**
+   * @brief Begin an array.
+   * @param[in] key The array key in the parent object ( "" = array element )
+   */
+  void beginArray(const std::string& key = std::string());
+
+  /// end the current object
+  void endObject() { endScope('}'); }
+
+  /// end the current array
+  void endArray() { endScope(']'); }
+
+  /**
+   * @brief Write a value, formatted like boost::property_tree::ptree::put.
+   * @param[in] key The value key in the parent object ( "" = array element )
+   * @param[in] value The value
+   */
+  void write(const std::string& key, const std::string& value);
+  void write(const std::string& key, const char* value) { write(key, std::string(value)); }
+  void write(const std::string& key, bool value);
+  void write(const std::string& key, int value);
+  void write(const std::string& key, unsigned int value);
+  void write(const std::string& key, long value);
+  void write(const std::string& key, unsigned long value);
+  void write(const std::string& key, long long value);
+  void write(const std::string& key, unsigned long long value);
+  void write(const std::string& key, unsigned char value) { write(key, static_cast<unsigned int>(value)); }
+  void write(const std::string& key, float value);
+  void write(const std::string& key, double value);
+
+  /**
+   * @brief Write an Eigen Matrix (or Vector) as an array, like saveMatrix.
+   * @param[in] key The matrix key in the parent object ( "" = array element )
+   * @param[in] matrix The input matrix
+   */
+  template<typename Derived>
+  void writeMatrix(const std::string& key, const Eigen::MatrixBase<Derived>& matrix)
+  {
+    beginArray(key);
+    for(int i = 0; i < matrix.size(); ++i)
+      write("", matrix(i));
+    endArray();
+  }
+
+  /**
+   * @brief Write a boost property tree.
+   * @param[in] key The tree key in the parent object ( "" = array element )
+   * @param[in] tree The input tree
+   */
+  void writeTree(const std::string& key, const boost::property_tree::ptree& tree);
+
+  /**
+   * @brief End the root object and flush the buffer.
+   */
+  void close();
+
+private:
+  struct Scope
+  {
+    char opening;
+    bool empty;
+  };
+
+  void beginValue(const std::string& key);
+  void writeRaw(const std::string& key, const char* value, std::size_t size);
+  void writeEscaped(const char* value, std::size_t size);
+  void endScope(char closing);
+  void flushIfNeeded();
+
+  std::ostream& _stream;
+  std::size_t _bufferSize;
+  std::string _buffer;
+  std::vector<Scope> _scopes;
+};
+
+/**
+ * @brief Streaming JSON reader.
+ *
+ * Pull parser reading the document through a fixed size buffer,
+ * the caller walks the document and converts the values directly,
+ * without building an intermediate tree.
+ * Values are accepted quoted (boost::property_tree style) or not.
+ */
+class JsonReader
+{
+public:
+  /**
+   * @brief JsonReader constructor.
+   * @param[in] stream The input stream
+   * @param[in] bufferSize The input buffer size in bytes
+   */
+  explicit JsonReader(std::istream& stream, std::size_t bufferSize = 1 << 20);
+
+  /**
+   * @brief Begin reading an object.
+   * @return false if the value is an empty string (empty boost::property_tree node)
+   */
+  bool beginObject();
+
+  /**
+   * @brief Read the next key of the current object.
+   * @param[out] key The next key
+   * @return false at the end of the object
+   */
+  bool nextKey(std::string& key);
+
+  /**
+   * @brief Begin reading an array.
+   * @return false if the value is an empty string (empty boost::property_tree node)
+   */
+  bool beginArray();
+
+  /**
+   * @brief Move to the next element of the current array.
+   * @return false at the end of the array
+   */
+  bool nextElement();
+
+  /**
+   * @brief Read a value as text.
+   * @return the value text, valid until the next read
+   */
+  const std::string& readString();
+
+  /**
+   * @brief Read and convert a value, like boost::property_tree::ptree::get_value.
+   * @param[out] value The output value
+   */
+  void readValue(std::string& value) { value = readString(); }
+  void readValue(bool& value);
+  void readValue(int& value);
+  void readValue(unsigned int& value);
+  void readValue(long& value);
+  void readValue(unsigned long& value);
+  void readValue(long long& value);
+  void readValue(unsigned long long& value);
+  void readValue(unsigned char& value);
+  void readValue(float& value);
+  void readValue(double& value);
+
+  /**
+   * @brief Read and convert a value.
+   * @return the converted value
+   */
+  template<typename T>
+  T read()
+  {
+    T value;
+    readValue(value);
+    return value;
+  }
+
+  /**
+   * @brief Read an array in an Eigen Matrix (or Vector), like loadMatrix.
+   * @param[out] matrix The output matrix
+   */
+  template<typename Derived>
+  void readMatrix(Eigen::MatrixBase<Derived>& matrix)
+  {
+    int i = 0;
+    if(beginArray())
+    {
+      while(nextElement())
+      {
+        if(i >= matrix.size())
+          error("Invalid matrix / vector size");
+        readValue(matrix(i));
+        ++i;
+      }
+    }
+  }
+
+  /**
+   * @brief Read the next value in a boost property tree, like boost::property_tree::read_json.
+   * @param[out] tree The output tree
+   */
+  void readTree(boost::property_tree::ptree& tree);
+
+  /**
+   * @brief Skip the next value.
+   */
+  void skipValue();
+
+  /**
+   * @brief Check that the whole document has been read.
+   */
+  void close();
+
+private:
+  [[noreturn]] void error(const std::string& message) const;
+
+  bool fill();
+  int peek();
+  int peekNonSpace();
+  void expect(char c);
+  void readStringToken(std::string& out);
+  void readScalarToken(std::string& out);
+
+  std::istream& _stream;
+  std::vector<char> _buffer;
+  std::size_t _position = 0;
+  std::size_t _size = 0;
+  std::size_t _line = 1;
+  /// for each open object or array, true until its first element
+  std::vector<bool> _first;
+  /// current value text
+  std::string _token;
+};
+
+} // namespace sfmDataIO
+} // namespace aliceVision
@@ -8,9 +8,13 @@
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfmDataIO/checkpointIO.hpp>
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
 
 #include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
 
+#include <fstream>
 #include <sstream>
 
 #define BOOST_TEST_MODULE sfmDataIO
@@ -68,9 +72,97 @@ sfmData::SfMData createTestScene(std::size_t viewsCount = 2, std::size_t observa
   return sfmData;
 }
 
+// Save a SfM scene as JSON with a boost property tree of the whole document (reference writer)
+void savePropertyTreeJSON(const sfmData::SfMData& sfmData, const std::string& filename)
+{
+  namespace bpt = boost::property_tree;
+
+  bpt::ptree fileTree;
+
+  const Vec3i version = {ALICEVISION_SFMDATAIO_VERSION_MAJOR, ALICEVISION_SFMDATAIO_VERSION_MINOR, ALICEVISION_SFMDATAIO_VERSION_REVISION};
+  saveMatrix("version", version, fileTree);
+
+  const auto saveFolders = [&fileTree](const std::string& name, const std::vector<std::string>& folders)
+  {
+    if(folders.empty())
+      return;
+    bpt::ptree foldersTree;
+    for(const std::string& folder : folders)
+    {
+      bpt::ptree folderTree;
+      folderTree.put("", folder);
+      foldersTree.push_back(std::make_pair("", folderTree));
+    }
+    fileTree.add_child(name, foldersTree);
+  };
+  saveFolders("featuresFolders", sfmData.getRelativeFeaturesFolders());
+  saveFolders("matchesFolders", sfmData.getRelativeMatchesFolders());
+
+  if(!sfmData.getViews().empty())
+  {
+    bpt::ptree viewsTree;
+    for(const auto& viewPair : sfmData.getViews())
+      saveView("", *(viewPair.second), viewsTree);
+    fileTree.add_child("views", viewsTree);
+  }
+
+  if(!sfmData.getIntrinsics().empty())
+  {
+    bpt::ptree intrinsicsTree;
+    for(const auto& intrinsicPair : sfmData.getIntrinsics())
+      saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+    fileTree.add_child("intrinsics", intrinsicsTree);
+  }
+
+  if(!sfmData.getPoses().empty())
+  {
+    bpt::ptree posesTree;
+    for(const auto& posePair : sfmData.getPoses())
+    {
+      bpt::ptree poseTree;
+      poseTree.put("poseId", posePair.first);
+      saveCameraPose("pose", posePair.second, poseTree);
+      posesTree.push_back(std::make_pair("", poseTree));
+    }
+    fileTree.add_child("poses", posesTree);
+  }
+
+  if(!sfmData.getRigs().empty())
+  {
+    bpt::ptree rigsTree;
+    for(const auto& rigPair : sfmData.getRigs())
+      saveRig("", rigPair.first, rigPair.second, rigsTree);
+    fileTree.add_child("rigs", rigsTree);
+  }
+
+  if(!sfmData.getLandmarks().empty())
+  {
+    bpt::ptree structureTree;
+    for(const auto& landmarkPair : sfmData.getLandmarks())
+      saveLandmark("", landmarkPair.first, landmarkPair.second, structureTree);
+    fileTree.add_child("structure", structureTree);
+  }
+
+  if(!sfmData.getControlPoints().empty())
+  {
+    bpt::ptree controlPointsTree;
+    for(const auto& controlPointPair : sfmData.getControlPoints())
+      saveLandmark("", controlPointPair.first, controlPointPair.second, controlPointsTree);
+    fileTree.add_child("controlPoints", controlPointsTree);
+  }
+
+  bpt::write_json(filename, fileTree);
+}
+
+std::string readFile(const std::string& filename)
+{
+  std::ifstream stream(filename, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+}
+
 BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD)
 {
-    std::vector<std::string> ext_Type = {"sfm", "json"};
+    std::vector<std::string> ext_Type = {"sfm", "json", "sfmb"};
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
     ext_Type.push_back("abc");
@@ -178,11 +270,152 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD)
     }
 }
 
+BOOST_AUTO_TEST_CASE(SfMData_IO_JSON_STREAM)
+{
+  namespace bpt = boost::property_tree;
+
+  const std::string filename = "STREAM_SAVE_LOAD.sfm";
+  const std::string referenceFilename = "STREAM_SAVE_LOAD_REFERENCE.sfm";
+
+  sfmData::SfMData sfmData = createTestScene(20, 10, false);
+  sfmData.views.at(0)->addMetadata("Exif:Model", "a/b \"c\"\t\\");
+  sfmData.views.at(1)->setRigAndSubPoseId(0, 1);
+  sfmData.views.at(1)->setFrameId(3);
+  sfmData.getRigs()[0] = sfmData::Rig(2);
+  sfmData.addFeaturesFolder("features");
+  sfmData.addMatchesFolders({"matches", "matches/2"});
+  sfmData.getPoses().at(2).lock();
+  sfmData.setPose(*sfmData.views.at(3), sfmData::CameraPose(Pose3(RotationAroundX(0.3) * RotationAroundZ(-1.2), Vec3(-0.25, 1e-5, 1234.5))));
+  sfmData.control_points[0] = sfmData.structure.at(0);
+  sfmData.structure[1].descType = feature::EImageDescriberType::SIFT; // landmark without observation
+  sfmData.structure[2].X = Vec3(0.1, -1e-12, 1e300);
+  sfmData.structure[2].descType = feature::EImageDescriberType::AKAZE;
+  sfmData.structure[2].rgb = image::RGBColor(1, 128, 255);
+
+  BOOST_CHECK(Save(sfmData, filename, ALL));
+
+  // the streaming writer output is byte-identical to the boost property tree one
+  savePropertyTreeJSON(sfmData, referenceFilename);
+  BOOST_CHECK(readFile(filename) == readFile(referenceFilename));
+
+  // the streaming reader output is the same as the input
+  {
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(Load(sfmDataLoad, filename, ALL));
+    BOOST_CHECK(sfmDataLoad == sfmData);
+    BOOST_CHECK_EQUAL(sfmDataLoad.getControlPoints().size(), 1);
+    BOOST_CHECK_EQUAL(sfmDataLoad.structure.at(2).X, sfmData.structure.at(2).X);
+    BOOST_CHECK_EQUAL(sfmDataLoad.views.at(0)->getMetadata().at("Exif:Model"), "a/b \"c\"\t\\");
+  }
+
+  // benchmark against the boost property tree parser
+  {
+    sfmData::SfMData bigSfmData = createTestScene(100, 2, true);
+    for(IndexT landmarkId = 0; landmarkId < 20000; ++landmarkId)
+    {
+      sfmData::Landmark& landmark = bigSfmData.structure[landmarkId];
+      landmark.X = Vec3(landmarkId, 0.5 * landmarkId, 1.0 / (landmarkId + 1));
+      landmark.descType = feature::EImageDescriberType::SIFT;
+      for(IndexT viewId = 0; viewId < 100; viewId += 20)
+        landmark.observations[viewId] = sfmData::Observation(Vec2(0.1 * landmarkId, viewId), landmarkId, 1.5);
+    }
+
+    BOOST_CHECK(Save(bigSfmData, filename, ALL));
+
+    system::Timer timer;
+    bpt::ptree fileTree;
+    bpt::read_json(filename, fileTree);
+    const double ptreeDuration = timer.elapsedMs();
+
+    timer.reset();
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(Load(sfmDataLoad, filename, ALL));
+    const double streamDuration = timer.elapsedMs();
+
+    BOOST_CHECK(sfmDataLoad == bigSfmData);
+    ALICEVISION_LOG_INFO("bpt::read_json: " << ptreeDuration << " ms, streaming load: " << streamDuration << " ms");
+  }
+
+  fs::remove(filename);
+  fs::remove(referenceFilename);
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_CHECKPOINT)
+{
+  const std::string filename = "CHECKPOINT.log";
+
+  const sfmData::SfMData reference = createTestScene(10, 2, false);
+  sfmData::SfMData sfmData = reference;
+
+  CheckpointLog log;
+  BOOST_CHECK(log.create(filename, sfmData));
+
+  // checkpoint 0: new pose, landmark, intrinsic update and moved landmark
+  sfmData.getPoses()[10] = sfmData::CameraPose(geometry::Pose3(RotationAroundX(0.1), Vec3(1.0, 2.0, 3.0)), true);
+  sfmData.views.at(9)->setPoseId(10);
+  sfmData.views.at(9)->setResectionId(0);
+  sfmData.structure[1] = sfmData::Landmark(Vec3(1.0, 1.0, 1.0), feature::EImageDescriberType::AKAZE);
+  sfmData.structure[1].observations[3] = sfmData::Observation(Vec2(3.0, 4.0), 5, 1.5);
+  sfmData.structure.at(0).X += Vec3(1e-9, 0.0, 0.0);
+  sfmData.intrinsics.at(2)->updateFromParams({1501.0, 1499.5, 1.0 / 3.0, -2.0});
+  BOOST_CHECK(log.append(sfmData, 0));
+  const sfmData::SfMData checkpoint0 = sfmData;
+
+  // checkpoint 1: removed pose and landmark, new observation
+  sfmData.getPoses().erase(0);
+  sfmData.structure.erase(0);
+  sfmData.structure.at(1).observations[4] = sfmData::Observation(Vec2(5.0, 6.0), 7, 1.0);
+  BOOST_CHECK(log.append(sfmData, 1));
+  BOOST_CHECK_EQUAL(log.getNbCheckpoints(), 2);
+  log.close();
+
+  // replay all the checkpoints
+  {
+    sfmData::SfMData sfmDataResume = reference;
+    IndexT lastIteration;
+    BOOST_CHECK(log.resume(filename, sfmDataResume, lastIteration));
+    BOOST_CHECK_EQUAL(lastIteration, 1);
+    BOOST_CHECK(sfmDataResume == sfmData);
+    BOOST_CHECK(sfmDataResume.getIntrinsics().at(2)->getParams() == sfmData.getIntrinsics().at(2)->getParams());
+    log.close();
+  }
+
+  // an interrupted write only loses the last checkpoint
+  fs::resize_file(filename, fs::file_size(filename) - 3);
+  {
+    sfmData::SfMData sfmDataResume = reference;
+    IndexT lastIteration;
+    BOOST_CHECK(log.resume(filename, sfmDataResume, lastIteration));
+    BOOST_CHECK_EQUAL(lastIteration, 0);
+    BOOST_CHECK(sfmDataResume == checkpoint0);
+    BOOST_CHECK_EQUAL(sfmDataResume.structure.at(0).X, checkpoint0.structure.at(0).X);
+
+    // the log can be continued
+    BOOST_CHECK(log.append(sfmData, 1));
+    log.close();
+  }
+  {
+    sfmData::SfMData sfmDataResume = reference;
+    IndexT lastIteration;
+    BOOST_CHECK(log.resume(filename, sfmDataResume, lastIteration));
+    BOOST_CHECK_EQUAL(lastIteration, 1);
+    BOOST_CHECK(sfmDataResume == sfmData);
+    log.close();
+  }
+
+  // the log only applies to its reference scene
+  {
+    sfmData::SfMData otherScene = createTestScene(5, 2, false);
+    IndexT lastIteration;
+    BOOST_CHECK(!log.resume(filename, otherScene, lastIteration));
+  }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(SfMData_IO_BigFile) {
   const int nbViews = 1000;
   const int nbObservationPerView = 100000;
-  std::vector<std::string> ext_Type = {"sfm","json"};
+  std::vector<std::string> ext_Type = {"sfm","json","sfmb"};
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
   ext_Type.push_back("abc");
@@ -0,0 +1,50 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MappedFile.hpp"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/filesystem.hpp>
+
+#include <stdexcept>
+
+namespace aliceVision {
+namespace system {
+
+namespace bip = boost::interprocess;
+
+struct MappedFile::Mapping
+{
+  bip::file_mapping file;
+  bip::mapped_region region;
+};
+
+MappedFile::MappedFile(const std::string& filepath)
+  : _filepath(filepath)
+{
+  try
+  {
+    // an empty file cannot be mapped
+    if(boost::filesystem::file_size(filepath) == 0)
+      return;
+
+    _mapping.reset(new Mapping());
+    _mapping->file = bip::file_mapping(filepath.c_str(), bip::read_only);
+    _mapping->region = bip::mapped_region(_mapping->file, bip::read_only);
+    _data = static_cast<const char*>(_mapping->region.get_address());
+    _size = _mapping->region.get_size();
+  }
+  catch(const std::exception& e)
+  {
+    throw std::runtime_error("Failed to map file '" + filepath + "': " + e.what());
+  }
+}
+
+MappedFile::~MappedFile() = default;
+
+} // namespace system
+} // namespace aliceVision
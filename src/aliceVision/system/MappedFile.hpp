@@ -0,0 +1,65 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * The pages are loaded on demand by the OS and shared between all the processes
+ * mapping the same file.
+ */
+class MappedFile
+{
+public:
+  /**
+   * @brief Map a file in memory.
+   * @param[in] filepath path of the file to map
+   * @throw std::runtime_error if the file cannot be opened or mapped
+   */
+  explicit MappedFile(const std::string& filepath);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /// Return the address of the first byte of the file (the mapping is page aligned).
+  const char* data() const
+  {
+    return _data;
+  }
+
+  /// Return the size of the file in bytes.
+  std::size_t size() const
+  {
+    return _size;
+  }
+
+  /// Return the path of the mapped file.
+  const std::string& path() const
+  {
+    return _filepath;
+  }
+
+private:
+  struct Mapping;
+
+  std::unique_ptr<Mapping> _mapping;
+  std::string _filepath;
+  const char* _data = nullptr;
+  std::size_t _size = 0;
+};
+
+} // namespace system
+} // namespace aliceVision
@@ -164,3 +164,50 @@ int get_total_cpus(void)
 
 #endif /* GET_TOTAL_CPUS_DEFINED */
 
+
+/* cpu_has_avx2() system specific code: checks the CPU flags (AVX2, FMA) and the OS support of the YMM registers */
+#if (defined __GNUC__ || defined __clang__) && (defined __x86_64__ || defined __i386__)
+namespace aliceVision {
+namespace system {
+
+bool cpu_has_avx2(void)
+{
+	// __builtin_cpu_supports also checks that the OS saves the YMM registers
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+}}
+#elif defined _MSC_VER && (defined _M_X64 || defined _M_IX86)
+#include <intrin.h>
+#include <immintrin.h>
+namespace aliceVision {
+namespace system {
+
+bool cpu_has_avx2(void)
+{
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool fma = (info[2] & (1 << 12)) != 0;
+	if (!osxsave || !fma) return false;
+
+	// the OS must save the XMM and YMM registers
+	if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+}
+}}
+#else
+namespace aliceVision {
+namespace system {
+
+bool cpu_has_avx2(void)
+{
+	return false;
+}
+}}
+#endif
@@ -22,6 +22,11 @@ int cpu_clock_by_os();
  */
 int get_total_cpus();
 
+/**
+ * @brief Returns true if the CPU and the OS support the AVX2 and FMA instruction sets.
+ */
+bool cpu_has_avx2();
+
 }
 }
 
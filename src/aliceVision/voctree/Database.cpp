@@ -5,10 +5,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "Database.hpp"
+#include <aliceVision/alicevision_omp.hpp>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/tail.hpp>
-#include <boost/progress.hpp>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <stdexcept>
 #include <boost/format.hpp>
@@ -16,6 +18,114 @@
 namespace aliceVision{
 namespace voctree{
 
+namespace {
+
+/// Scoring of the distance methods that can be accumulated over the inverted files
+enum class EInvertedFileScoring
+{
+  CLASSIC,
+  COMMON_POINTS,
+  STRONG_COMMON_POINTS,
+  INVERSED_WEIGHTED_COMMON_POINTS,
+  NONE ///< no inverted file scoring, compare the query with each document
+};
+
+EInvertedFileScoring invertedFileScoring(const std::string& distanceMethod)
+{
+  if(distanceMethod == "classic")
+    return EInvertedFileScoring::CLASSIC;
+  if(distanceMethod == "commonPoints")
+    return EInvertedFileScoring::COMMON_POINTS;
+  if(distanceMethod == "strongCommonPoints")
+    return EInvertedFileScoring::STRONG_COMMON_POINTS;
+  if(distanceMethod == "inversedWeightedCommonPoints")
+    return EInvertedFileScoring::INVERSED_WEIGHTED_COMMON_POINTS;
+  if(distanceMethod == "weightedStrongCommonPoints")
+    return EInvertedFileScoring::NONE;
+  throw std::invalid_argument("distance method "+ distanceMethod +" unknown!");
+}
+
+/// Sort the N best matches (ties are sorted by document id) and drop the others
+void keepBestMatches(std::size_t N, std::vector<DocMatch>& matches)
+{
+  const std::size_t nMatches = std::min(N, matches.size());
+  std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end(),
+                    [](const DocMatch& a, const DocMatch& b) { return a.score < b.score || (a.score == b.score && a.id < b.id); });
+  matches.resize(nMatches);
+}
+
+/**
+ * @brief Header of a database file.
+ *
+ * The header is followed by these arrays, each of them starting on a multiple of 8 bytes:
+ * - float weights[nbWords]
+ * - DocId docIds[nbDocuments] (in insertion order)
+ * - float docSizes[nbDocuments]
+ * - uint64_t wordOffsets[nbWords + 1]: the inverted file of a word w is [wordOffsets[w], wordOffsets[w+1]) in frequencies
+ * - WordFrequency frequencies[nbFrequencies]
+ * - uint64_t documentOffsets[nbDocuments + 1]: the histogram of a document i is [documentOffsets[i], documentOffsets[i+1]) in documentsData
+ * - uint32_t documentsData[documentsDataSize]: for each word of a histogram, the word, its number of features and the features indexes
+ */
+struct DatabaseFileHeader
+{
+  char magic[8];
+  uint32_t nbWords;
+  uint32_t nbDocuments;
+  uint64_t nbFrequencies;
+  uint64_t documentsDataSize;
+};
+
+const char databaseFileMagic[8] = {'A', 'V', 'V', 'T', 'D', 'B', '0', '1'};
+
+std::size_t alignedSize(std::size_t size)
+{
+  return (size + 7) & ~std::size_t(7);
+}
+
+/// Offsets of the arrays in a database file
+struct DatabaseFileLayout
+{
+  std::size_t weights;
+  std::size_t docIds;
+  std::size_t docSizes;
+  std::size_t wordOffsets;
+  std::size_t frequencies;
+  std::size_t documentOffsets;
+  std::size_t documentsData;
+  std::size_t fileSize;
+
+  DatabaseFileLayout(const DatabaseFileHeader& header, std::size_t wordFrequencySize)
+  {
+    weights = sizeof(DatabaseFileHeader);
+    docIds = weights + alignedSize(header.nbWords * sizeof(float));
+    docSizes = docIds + alignedSize(header.nbDocuments * sizeof(DocId));
+    wordOffsets = docSizes + alignedSize(header.nbDocuments * sizeof(float));
+    frequencies = wordOffsets + alignedSize((std::size_t(header.nbWords) + 1) * sizeof(uint64_t));
+    documentOffsets = frequencies + alignedSize(header.nbFrequencies * wordFrequencySize);
+    documentsData = documentOffsets + alignedSize((std::size_t(header.nbDocuments) + 1) * sizeof(uint64_t));
+    fileSize = documentsData + alignedSize(header.documentsDataSize * sizeof(uint32_t));
+  }
+};
+
+/// Pad a database file array of the given size to a multiple of 8 bytes
+void writePadding(std::ofstream& out, std::size_t size)
+{
+  const char padding[8] = {0};
+  out.write(padding, alignedSize(size) - size);
+}
+
+/// Write an array to a database file, padded to a multiple of 8 bytes
+template<typename T>
+void writeArray(std::ofstream& out, const T* data, std::size_t count)
+{
+  const std::size_t size = count * sizeof(T);
+  if(size > 0)
+    out.write(reinterpret_cast<const char*>(data), size);
+  writePadding(out, size);
+}
+
+} // namespace
+
 std::ostream& operator<<(std::ostream& os, const SparseHistogram &dv)	
 {
 	for( const auto &e : dv )
@@ -43,21 +153,30 @@ word_weights_( num_words, 1.0f ) { }
 
 DocId Database::insert(DocId doc_id, const SparseHistogram& document)
 {
+  if(isDatabaseMapped())
+    unmap();
+
   // Ensure that the new document to insert is not already there.
   assert(database_.find(doc_id) == database_.end());
 
+  const uint32_t docIndex = doc_ids_.size();
+  float docSize = 0.0f;
+
   // For each word, retrieve its inverted file and increment the count for doc_id.
   for(SparseHistogram::const_iterator it = document.begin(), end = document.end(); it != end; ++it)
   {
     Word word = it->first;
     InvertedFile& file = word_files_[word];
-    if(file.empty() || file.back().id != doc_id)
-      file.push_back(WordFrequency(doc_id, it->second.size()));
+    if(file.empty() || file.back().index != docIndex)
+      file.push_back(WordFrequency(docIndex, it->second.size()));
     else
       file.back().count += it->second.size();
+    docSize += it->second.size();
   }
 
   database_[doc_id] = document;
+  doc_ids_.push_back(doc_id);
+  doc_sizes_.push_back(docSize);
 
   return doc_id;
 }
@@ -77,20 +196,7 @@ void Database::sanityCheck(std::size_t N, std::map<std::size_t, DocMatches>& mat
     N = std::min(N, this->size());
   }
 
-  matches.clear();
-  // since we already know the size of the vectors, in order to parallelize the 
-  // query allocate the whole memory
-  boost::progress_display display(database_.size());
-  
-  //#pragma omp parallel for default(none) shared(database_)
-  for(const auto &doc : database_)
-  {
-    std::vector<DocMatch> m;
-    find(doc.second, N, m);
-    //		matches.emplace_back( m );
-    matches[doc.first] = m;
-    ++display;
-  }
+  find(documents(), N, matches);
 }
 
 /**
@@ -121,18 +227,114 @@ void Database::find(const std::vector<Word>& document, std::size_t N, std::vecto
  */
 void Database::find( const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod) const
 {
-    matches.clear();
-    matches.reserve(database_.size());
-    for(const auto& document : database_)
+  matches.clear();
+  const EInvertedFileScoring scoring = invertedFileScoring(distanceMethod);
+
+  if(scoring == EInvertedFileScoring::NONE)
+  {
+    const SparseHistogramPerImage& database = documents();
+    matches.reserve(database.size());
+    for(const auto& document : database)
     {
-        // for each document/image in the database compute the distance between the
-        // histograms of the query image and the others
-        const float distance = sparseDistance(query, document.second, distanceMethod, word_weights_);
-        matches.emplace_back(document.first, distance);
+      // for each document/image in the database compute the distance between the
+      // histograms of the query image and the others
+      const float distance = sparseDistance(query, document.second, distanceMethod, weights());
+      matches.emplace_back(document.first, distance);
     }
-    const std::size_t nMatches = std::min(N, matches.size());
-    std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end());
-    matches.resize(nMatches);
+    keepBestMatches(N, matches);
+    return;
+  }
+
+  // accumulate the score of the documents sharing at least one word with the query,
+  // by walking through the inverted files of the query words
+  const std::size_t nbDocuments = this->nbDocuments();
+  const float* word_weights = weights();
+  std::vector<float> scores(nbDocuments, 0.0f);
+  std::vector<char> visited(nbDocuments, 0);
+  std::vector<uint32_t> candidates;
+  float querySize = 0.0f;
+
+  for(const auto& word : query)
+  {
+    const uint32_t queryCount = word.second.size();
+    querySize += queryCount;
+
+    const auto file = invertedFile(word.first);
+    for(const WordFrequency* it = file.first; it != file.second; ++it)
+    {
+      const WordFrequency& frequency = *it;
+      if(!visited[frequency.index])
+      {
+        visited[frequency.index] = 1;
+        candidates.push_back(frequency.index);
+      }
+
+      float& score = scores[frequency.index];
+      switch(scoring)
+      {
+        case EInvertedFileScoring::CLASSIC:
+        case EInvertedFileScoring::COMMON_POINTS:
+          score += std::min(queryCount, frequency.count);
+          break;
+        case EInvertedFileScoring::STRONG_COMMON_POINTS:
+          if(queryCount == 1 && frequency.count == 1)
+            score += 1.0f;
+          break;
+        case EInvertedFileScoring::INVERSED_WEIGHTED_COMMON_POINTS:
+          score += word_weights[word.first] / std::min(queryCount, frequency.count);
+          break;
+        case EInvertedFileScoring::NONE:
+          break;
+      }
+    }
+  }
+
+  // the classic distance is the L1 norm of the histograms difference:
+  // |q - d| = |q| + |d| - 2 * sum(min(q_i, d_i))
+  const auto distance = [&](uint32_t index)
+  {
+    return (scoring == EInvertedFileScoring::CLASSIC) ? querySize + docSize(index) - 2.0f * scores[index] : -scores[index];
+  };
+
+  // the documents without any common word are only needed for the classic distance
+  // (which depends on the size of the documents) or to fill the N requested matches
+  if(scoring == EInvertedFileScoring::CLASSIC || N > candidates.size())
+  {
+    matches.reserve(nbDocuments);
+    for(uint32_t index = 0; index < nbDocuments; ++index)
+      matches.emplace_back(docId(index), distance(index));
+  }
+  else
+  {
+    matches.reserve(candidates.size());
+    for(const uint32_t index : candidates)
+      matches.emplace_back(docId(index), distance(index));
+  }
+
+  keepBestMatches(N, matches);
+}
+
+void Database::find(const SparseHistogramPerImage& queries, std::size_t N, std::map<std::size_t, DocMatches>& matches, const std::string &distanceMethod) const
+{
+  // check the distance method before entering the parallel section
+  invertedFileScoring(distanceMethod);
+
+  std::vector<SparseHistogramPerImage::const_iterator> queriesIt;
+  queriesIt.reserve(queries.size());
+  for(auto it = queries.cbegin(); it != queries.cend(); ++it)
+    queriesIt.push_back(it);
+
+  std::vector<DocMatches> queriesMatches(queries.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(queriesIt.size()); ++i)
+  {
+    find(queriesIt[i]->second, N, queriesMatches[i], distanceMethod);
+  }
+
+  matches.clear();
+  for(std::size_t i = 0; i < queriesIt.size(); ++i)
+    matches[queriesIt[i]->first] = std::move(queriesMatches[i]);
 }
 
 /**
@@ -143,6 +345,8 @@ void Database::find( const SparseHistogram& query, std::size_t N, std::vector<Do
  */
 void Database::computeTfIdfWeights(float default_weight)
 {
+  unmap();
+
   float N = (float) database_.size();
   std::size_t num_words = word_files_.size();
   for(std::size_t i = 0; i < num_words; ++i)
@@ -158,29 +362,221 @@ void Database::computeTfIdfWeights(float default_weight)
 void Database::saveWeights(const std::string& file) const
 {
   std::ofstream out(file.c_str(), std::ios_base::binary);
-  uint32_t num_words = word_weights_.size();
+  uint32_t num_words = nbWords();
   out.write((char*) (&num_words), sizeof (uint32_t));
-  out.write((char*) (&word_weights_[0]), num_words * sizeof (float));
+  out.write((const char*) weights(), num_words * sizeof (float));
 }
 
 void Database::loadWeights(const std::string& file)
 {
-  std::ifstream in;
-  in.exceptions(std::ifstream::eofbit | std::ifstream::failbit | std::ifstream::badbit);
+  // the inserted documents are kept
+  if(isDatabaseMapped())
+    unmap();
 
+  std::shared_ptr<system::MappedFile> mapping;
+  uint32_t num_words = 0;
   try
   {
-    in.open(file.c_str(), std::ios_base::binary);
-    uint32_t num_words = 0;
-    in.read((char*) (&num_words), sizeof (uint32_t));
-    word_files_.resize(num_words); // Inverted files start out empty
-    word_weights_.resize(num_words);
-    in.read((char*) (&word_weights_[0]), num_words * sizeof (float));
+    mapping = std::make_shared<system::MappedFile>(file);
   }
-  catch(std::ifstream::failure& e)
+  catch(std::runtime_error& e)
   {
     throw std::runtime_error((boost::format("Failed to load vocabulary weights file '%s'") % file).str());
   }
+
+  if(mapping->size() >= sizeof (uint32_t))
+    std::memcpy(&num_words, mapping->data(), sizeof (uint32_t));
+  if(mapping->size() < sizeof (uint32_t) + num_words * sizeof (float))
+    throw std::runtime_error((boost::format("Failed to load vocabulary weights file '%s'") % file).str());
+
+  // the weights follow the number of words, they are aligned and used in place
+  mapped_ = MappedData();
+  mapped_.nbWords = num_words;
+  mapped_.weights = reinterpret_cast<const float*>(mapping->data() + sizeof (uint32_t));
+  mapped_.file = std::move(mapping);
+
+  word_files_.resize(num_words); // Inverted files start out empty
+  std::vector<float>().swap(word_weights_);
+}
+
+void Database::save(const std::string& file) const
+{
+  const SparseHistogramPerImage& database = documents();
+
+  std::vector<uint64_t> wordOffsets(1, 0);
+  wordOffsets.reserve(nbWords() + 1);
+  for(std::size_t word = 0; word < nbWords(); ++word)
+  {
+    const auto frequencies = invertedFile(word);
+    wordOffsets.push_back(wordOffsets.back() + (frequencies.second - frequencies.first));
+  }
+
+  std::vector<uint64_t> documentOffsets(1, 0);
+  std::vector<uint32_t> documentsData;
+  documentOffsets.reserve(nbDocuments() + 1);
+  for(uint32_t index = 0; index < nbDocuments(); ++index)
+  {
+    for(const auto& word : database.at(docId(index)))
+    {
+      documentsData.push_back(static_cast<uint32_t>(word.first));
+      documentsData.push_back(static_cast<uint32_t>(word.second.size()));
+      documentsData.insert(documentsData.end(), word.second.begin(), word.second.end());
+    }
+    documentOffsets.push_back(documentsData.size());
+  }
+
+  DatabaseFileHeader header;
+  std::copy(databaseFileMagic, databaseFileMagic + sizeof(header.magic), header.magic);
+  header.nbWords = nbWords();
+  header.nbDocuments = nbDocuments();
+  header.nbFrequencies = wordOffsets.back();
+  header.documentsDataSize = documentsData.size();
+
+  std::vector<DocId> docIds(nbDocuments());
+  std::vector<float> docSizes(nbDocuments());
+  for(uint32_t index = 0; index < nbDocuments(); ++index)
+  {
+    docIds[index] = docId(index);
+    docSizes[index] = docSize(index);
+  }
+
+  std::ofstream out(file.c_str(), std::ios_base::binary);
+  if(!out.is_open())
+    throw std::runtime_error((boost::format("Failed to save vocabulary database file '%s'") % file).str());
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  writeArray(out, weights(), nbWords());
+  writeArray(out, docIds.data(), docIds.size());
+  writeArray(out, docSizes.data(), docSizes.size());
+  writeArray(out, wordOffsets.data(), wordOffsets.size());
+  for(std::size_t word = 0; word < nbWords(); ++word)
+  {
+    const auto frequencies = invertedFile(word);
+    if(frequencies.first != frequencies.second)
+      out.write(reinterpret_cast<const char*>(frequencies.first), (frequencies.second - frequencies.first) * sizeof(WordFrequency));
+  }
+  writePadding(out, header.nbFrequencies * sizeof(WordFrequency));
+  writeArray(out, documentOffsets.data(), documentOffsets.size());
+  writeArray(out, documentsData.data(), documentsData.size());
+
+  if(!out.good())
+    throw std::runtime_error((boost::format("Failed to save vocabulary database file '%s'") % file).str());
+}
+
+void Database::load(const std::string& file)
+{
+  std::shared_ptr<system::MappedFile> mapping;
+  try
+  {
+    mapping = std::make_shared<system::MappedFile>(file);
+  }
+  catch(std::runtime_error& e)
+  {
+    throw std::runtime_error((boost::format("Failed to load vocabulary database file '%s'") % file).str());
+  }
+
+  DatabaseFileHeader header;
+  if(mapping->size() < sizeof(header))
+    throw std::runtime_error((boost::format("Invalid vocabulary database file '%s'") % file).str());
+  std::memcpy(&header, mapping->data(), sizeof(header));
+
+  const DatabaseFileLayout layout(header, sizeof(WordFrequency));
+  if(!std::equal(databaseFileMagic, databaseFileMagic + sizeof(header.magic), header.magic) ||
+     mapping->size() < layout.fileSize)
+    throw std::runtime_error((boost::format("Invalid vocabulary database file '%s'") % file).str());
+
+  const char* data = mapping->data();
+
+  MappedData mapped;
+  mapped.nbWords = header.nbWords;
+  mapped.weights = reinterpret_cast<const float*>(data + layout.weights);
+  mapped.nbDocuments = header.nbDocuments;
+  mapped.docIds = reinterpret_cast<const DocId*>(data + layout.docIds);
+  mapped.docSizes = reinterpret_cast<const float*>(data + layout.docSizes);
+  mapped.wordOffsets = reinterpret_cast<const uint64_t*>(data + layout.wordOffsets);
+  mapped.frequencies = reinterpret_cast<const WordFrequency*>(data + layout.frequencies);
+  mapped.documentOffsets = reinterpret_cast<const uint64_t*>(data + layout.documentOffsets);
+  mapped.documentsData = reinterpret_cast<const uint32_t*>(data + layout.documentsData);
+
+  if(mapped.wordOffsets[header.nbWords] != header.nbFrequencies ||
+     mapped.documentOffsets[header.nbDocuments] != header.documentsDataSize)
+    throw std::runtime_error((boost::format("Invalid vocabulary database file '%s'") % file).str());
+
+  mapped.file = std::move(mapping);
+  mapped_ = std::move(mapped);
+
+  word_files_.clear();
+  word_weights_.clear();
+  database_.clear();
+  doc_ids_.clear();
+  doc_sizes_.clear();
+}
+
+std::pair<const Database::WordFrequency*, const Database::WordFrequency*> Database::invertedFile(Word word) const
+{
+  if(word < 0 || static_cast<std::size_t>(word) >= (isDatabaseMapped() ? mapped_.nbWords : word_files_.size()))
+    return {nullptr, nullptr};
+
+  if(isDatabaseMapped())
+    return {mapped_.frequencies + mapped_.wordOffsets[word], mapped_.frequencies + mapped_.wordOffsets[word + 1]};
+
+  const InvertedFile& file = word_files_[word];
+  return {file.data(), file.data() + file.size()};
+}
+
+const SparseHistogramPerImage& Database::documents() const
+{
+  if(!isDatabaseMapped())
+    return database_;
+
+  std::shared_ptr<const SparseHistogramPerImage> documents = std::atomic_load(&mapped_.documents);
+  if(documents)
+    return *documents;
+
+  std::shared_ptr<SparseHistogramPerImage> decoded = std::make_shared<SparseHistogramPerImage>();
+  for(uint32_t index = 0; index < mapped_.nbDocuments; ++index)
+  {
+    SparseHistogram& histogram = (*decoded)[mapped_.docIds[index]];
+    const uint32_t* it = mapped_.documentsData + mapped_.documentOffsets[index];
+    const uint32_t* end = mapped_.documentsData + mapped_.documentOffsets[index + 1];
+    while(it < end)
+    {
+      const Word word = static_cast<Word>(it[0]);
+      const uint32_t nbFeatures = it[1];
+      histogram[word].assign(it + 2, it + 2 + nbFeatures);
+      it += 2 + nbFeatures;
+    }
+  }
+
+  // concurrent calls may decode the documents several times, only the first one is kept
+  std::shared_ptr<const SparseHistogramPerImage> expected;
+  documents = decoded;
+  if(!std::atomic_compare_exchange_strong(&mapped_.documents, &expected, documents))
+    documents = expected;
+  return *documents;
+}
+
+void Database::unmap()
+{
+  if(!isMapped())
+    return;
+
+  word_weights_.assign(weights(), weights() + nbWords());
+
+  if(isDatabaseMapped())
+  {
+    database_ = documents();
+    doc_ids_.assign(mapped_.docIds, mapped_.docIds + mapped_.nbDocuments);
+    doc_sizes_.assign(mapped_.docSizes, mapped_.docSizes + mapped_.nbDocuments);
+    word_files_.resize(mapped_.nbWords);
+    for(uint32_t word = 0; word < mapped_.nbWords; ++word)
+    {
+      const auto frequencies = invertedFile(word);
+      word_files_[word].assign(frequencies.first, frequencies.second);
+    }
+  }
+
+  mapped_ = MappedData();
 }
 
 ///**
@@ -204,7 +600,7 @@ void Database::loadWeights(const std::string& file)
  */
 std::size_t Database::size() const
 {
-  return database_.size();
+  return nbDocuments();
 }
 
 } //namespace voctree
@@ -8,8 +8,10 @@
 
 #include "VocabularyTree.hpp"
 #include <aliceVision/types.hpp>
+#include <aliceVision/system/MappedFile.hpp>
 
 #include <map>
+#include <memory>
 #include <cstddef>
 #include <string>
 
@@ -106,6 +108,16 @@ public:
    */
   void find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string &distanceMethod = "strongCommonPoints") const;
 
+  /**
+   * @brief Find the top N matches in the database for each query document, the queries are processed in parallel.
+   *
+   * @param[in] queries The query documents, a set of quantized words per document.
+   * @param[in] N        The number of matches to return for each query.
+   * @param[out] matches  IDs and scores for the top N matching database documents of each query.
+   * @param[in] distanceMethod distance method (norm L1, etc.)
+   */
+  void find(const SparseHistogramPerImage& queries, std::size_t N, std::map<std::size_t, DocMatches>& matches, const std::string &distanceMethod = "strongCommonPoints") const;
+
   /**
    * @brief Compute the TF-IDF weights of all the words. To be called after inserting a corpus of
    * training examples into the database.
@@ -120,35 +132,67 @@ public:
    */
   std::size_t size() const;
 
+  /**
+   * @brief Return the number of words of the vocabulary used by the database
+   * @return the number of words
+   */
+  std::size_t getNbWords() const
+  {
+    return nbWords();
+  }
+
   /// Save the vocabulary word weights to a file.
   void saveWeights(const std::string& file) const;
-  /// Load the vocabulary word weights from a file.
+
+  /**
+   * @brief Load the vocabulary word weights from a file.
+   *        The file is memory mapped, its pages are shared by the processes using the same weights.
+   */
   void loadWeights(const std::string& file);
 
-  // Save weights and documents
-  //void save(const std::string& file) const;
-  //void load(const std::string& file);
+  /**
+   * @brief Save the weights, the inserted documents and their inverted files to a file.
+   * @param[in] file the database file path
+   */
+  void save(const std::string& file) const;
+
+  /**
+   * @brief Load a database saved with save().
+   *        The file is memory mapped and queried in place: the loading does not depend on the size
+   *        of the database. The documents histograms are only decoded if they are needed
+   *        (getSparseHistogramPerImage(), sanityCheck(), weightedStrongCommonPoints distance).
+   *        Inserting a document or computing the weights copies the database in memory.
+   * @param[in] file the database file path
+   */
+  void load(const std::string& file);
+
+  /// Return true if the database or its weights are read from a memory mapped file.
+  bool isMapped() const
+  {
+    return mapped_.file != nullptr;
+  }
 
   const SparseHistogramPerImage& getSparseHistogramPerImage() const
   {
-    return database_;
+    return documents();
   }
   
 private:
 
   struct WordFrequency
   {
-    DocId id;
+    /// index of the document in doc_ids_
+    uint32_t index;
     uint32_t count;
 
     WordFrequency() = default;
-    WordFrequency(DocId _id, uint32_t _count)
-      : id(_id)
+    WordFrequency(uint32_t _index, uint32_t _count)
+      : index(_index)
       , count(_count)
     {}
   };
 
-  // Stored in increasing order by DocId
+  // Stored in increasing order by document index
   typedef std::vector<WordFrequency> InvertedFile;
 
   /// @todo Use sorted vector?
@@ -159,6 +203,66 @@ private:
   std::vector<InvertedFile> word_files_;
   std::vector<float> word_weights_;
   SparseHistogramPerImage database_; // Precomputed for inserted documents
+  std::vector<DocId> doc_ids_;       // Inserted documents, in insertion order
+  std::vector<float> doc_sizes_;     // Number of features of each inserted document
+
+  /// Read-only views on a memory mapped weights file or database file
+  struct MappedData
+  {
+    std::shared_ptr<system::MappedFile> file;
+    uint32_t nbWords = 0;
+    const float* weights = nullptr;
+    // only set for a database file
+    uint32_t nbDocuments = 0;
+    const DocId* docIds = nullptr;
+    const float* docSizes = nullptr;
+    const uint64_t* wordOffsets = nullptr;     // inverted file of word w: [wordOffsets[w], wordOffsets[w+1])
+    const WordFrequency* frequencies = nullptr;
+    const uint64_t* documentOffsets = nullptr; // encoded histogram of document i: [documentOffsets[i], documentOffsets[i+1])
+    const uint32_t* documentsData = nullptr;
+    mutable std::shared_ptr<const SparseHistogramPerImage> documents; // decoded on demand
+  };
+
+  MappedData mapped_;
+
+  bool isDatabaseMapped() const
+  {
+    return mapped_.wordOffsets != nullptr;
+  }
+
+  std::size_t nbWords() const
+  {
+    return mapped_.weights ? mapped_.nbWords : word_weights_.size();
+  }
+
+  const float* weights() const
+  {
+    return mapped_.weights ? mapped_.weights : word_weights_.data();
+  }
+
+  std::size_t nbDocuments() const
+  {
+    return isDatabaseMapped() ? mapped_.nbDocuments : doc_ids_.size();
+  }
+
+  DocId docId(uint32_t index) const
+  {
+    return isDatabaseMapped() ? mapped_.docIds[index] : doc_ids_[index];
+  }
+
+  float docSize(uint32_t index) const
+  {
+    return isDatabaseMapped() ? mapped_.docSizes[index] : doc_sizes_[index];
+  }
+
+  /// Return the [begin, end) range of the inverted file of a word
+  std::pair<const WordFrequency*, const WordFrequency*> invertedFile(Word word) const;
+
+  /// Return the inserted documents, decoded from the mapped file if needed
+  const SparseHistogramPerImage& documents() const;
+
+  /// Copy the memory mapped data in memory, so that the database can be modified
+  void unmap();
 
   /**
    * Normalize a document vector representing the histogram of visual words for a given image
@@ -35,6 +35,12 @@ public:
     this->setNodeCounts();
   }
 
+  /// Read the vocabulary in memory, so that its centers can be modified.
+  void load(const std::string& file) override
+  {
+    this->read(file);
+  }
+
   uint32_t nodes() const
   {
     return this->word_start_ + this->num_words_;
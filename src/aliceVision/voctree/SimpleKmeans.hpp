@@ -10,6 +10,7 @@
 #include "DefaultAllocator.hpp"
 
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <boost/function.hpp>
 #include <boost/foreach.hpp>
@@ -18,6 +19,8 @@
 #include <numeric>
 #include <vector>
 #include <limits>
+#include <random>
+#include <type_traits>
 #include <stdio.h>
 #include <stdlib.h>
 #include <iostream>
@@ -32,14 +35,15 @@ struct InitRandom
 {
 
   template<class Feature, class Distance, class FeatureAllocator>
-  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, const int verbose = 0)
+  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance,
+                  std::mt19937& randomNumberGenerator, const int verbose = 0)
   {
     ALICEVISION_LOG_DEBUG("#\t\tRandom initialization");
     // Construct a random permutation of the features using a Fisher-Yates shuffle
     std::vector<Feature*> features_perm = features;
     for(size_t i = features.size(); i > 1; --i)
     {
-      size_t k = rand() % i;
+      size_t k = std::uniform_int_distribution<size_t>(0, i - 1)(randomNumberGenerator);
       std::swap(features_perm[i - 1], features_perm[k]);
     }
     // Take the first k permuted features as the initial centers
@@ -60,7 +64,8 @@ struct InitKmeanspp
 {
 
   template<class Feature, class Distance, class FeatureAllocator>
-  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, const int verbose = 0)
+  void operator()(const std::vector<Feature*>& features, size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance,
+                  std::mt19937& randomNumberGenerator, const int verbose = 0)
   {
     typedef typename Distance::result_type squared_distance_type;
 
@@ -86,7 +91,7 @@ struct InitKmeanspp
     typename std::vector<Feature*>::const_iterator featiter;
 
     // 1. Choose a random center
-    size_t randCenter = rand() % features.size();
+    size_t randCenter = std::uniform_int_distribution<size_t>(0, features.size() - 1)(randomNumberGenerator);
 
     // add it to the centers
     centers[0] = *features[ randCenter ];
@@ -94,10 +99,11 @@ struct InitKmeanspp
     if(verbose > 2) ALICEVISION_LOG_DEBUG("First center picked randomly " << randCenter << ": " << centers[0]);
 
     // compute the distances
-    for(dstiter = dists.begin(), featiter = features.begin(); dstiter != dists.end(); ++dstiter, ++featiter)
+    #pragma omp parallel for reduction(+:currSum)
+    for(ptrdiff_t it = 0; it < static_cast<ptrdiff_t>(features.size()); ++it)
     {
-      *dstiter = distance(*(*featiter), centers[0]);
-      currSum += *dstiter;
+      dists[it] = distance(*(features[it]), centers[0]);
+      currSum += dists[it];
     }
 
     // iterate k-1 times
@@ -118,7 +124,7 @@ struct InitKmeanspp
         // 0 and this sum, then start compute the sum from the first element again
         // until the partial sum is greater than the number drawn: the
         // the previous element is what we are looking for
-        const float perc = (float)rand() / RAND_MAX;
+        const float perc = std::uniform_real_distribution<float>(0.f, 1.f)(randomNumberGenerator);
         squared_distance_type partial = (squared_distance_type)(currSum * perc);
         // look for the element that cap the partial sum that has been
         // drawn
@@ -186,7 +192,8 @@ struct InitGiven
 {
 
   template<class Feature, class Distance, class FeatureAllocator>
-  void operator()(const std::vector<Feature*>& features, std::size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance, const int verbose = 0)
+  void operator()(const std::vector<Feature*>& features, std::size_t k, std::vector<Feature, FeatureAllocator>& centers, Distance distance,
+                  std::mt19937& randomNumberGenerator, const int verbose = 0)
   {
     // Do nothing!
   }
@@ -257,6 +264,7 @@ bool checkVectorElements(const std::vector<Feature, FeatureAllocator> &f, const
  * @brief Class for performing K-means clustering, optimized for a particular feature type and metric.
  *
  * The standard Lloyd's algorithm is used. By default, cluster centers are initialized randomly.
+ * For large sets of features, the mini-batch k-means can be used instead (see setMiniBatchSize()).
  */
 template<class Feature,
          class Distance = L2<Feature, Feature>,
@@ -265,7 +273,8 @@ class SimpleKmeans
 {
 public:
   typedef typename Distance::result_type squared_distance_type;
-  typedef boost::function<void(const std::vector<Feature*>&, std::size_t, std::vector<Feature, FeatureAllocator>&, Distance, const int verbose) > Initializer;
+  typedef boost::function<void(const std::vector<Feature*>&, std::size_t, std::vector<Feature, FeatureAllocator>&, Distance,
+                               std::mt19937& randomNumberGenerator, const int verbose) > Initializer;
 
   /**
    * @brief Constructor
@@ -304,6 +313,24 @@ public:
     restarts_ = restarts;
   }
 
+  std::size_t getMiniBatchSize() const
+  {
+    return mini_batch_size_;
+  }
+
+  /**
+   * @brief Use the mini-batch k-means for the sets of features larger than the batch size.
+   *
+   * Each iteration updates the centers with a random batch of features instead of the whole set
+   * (D. Sculley, "Web-scale k-means clustering", WWW 2010).
+   *
+   * @param size the number of features of a batch, 0 to always use the Lloyd's algorithm
+   */
+  void setMiniBatchSize(std::size_t size)
+  {
+    mini_batch_size_ = size;
+  }
+
   int getVerbose() const
   {
     return verbose_;
@@ -321,10 +348,12 @@ public:
    * @param      k          The number of clusters.
    * @param[out] centers    A set of k cluster centers.
    * @param[out] membership Cluster assignment for each feature
+   * @param[in]  randomNumberGenerator The random generator used for the initialization and the mini-batches
    */
   squared_distance_type cluster(const std::vector<Feature, FeatureAllocator>& features, std::size_t k,
                                 std::vector<Feature, FeatureAllocator>& centers,
-                                std::vector<unsigned int>& membership) const;
+                                std::vector<unsigned int>& membership,
+                                std::mt19937& randomNumberGenerator) const;
 
   /**
    * @brief Partition a set of features into k clusters.
@@ -336,25 +365,70 @@ public:
    * @param      k          The number of clusters.
    * @param[out] centers    A set of k cluster centers.
    * @param[out] membership Cluster assignment for each feature
+   * @param[in]  randomNumberGenerator The random generator used for the initialization and the mini-batches
    */
   squared_distance_type clusterPointers(const std::vector<Feature*>& features, std::size_t k,
                                         std::vector<Feature, FeatureAllocator>& centers,
-                                        std::vector<unsigned int>& membership) const;
+                                        std::vector<unsigned int>& membership,
+                                        std::mt19937& randomNumberGenerator) const;
 
 private:
 
   squared_distance_type clusterOnce(const std::vector<Feature*>& features, std::size_t k,
                                     std::vector<Feature, FeatureAllocator>& centers,
-                                    std::vector<unsigned int>& membership) const;
+                                    std::vector<unsigned int>& membership,
+                                    std::mt19937& randomNumberGenerator) const;
+
+  /// Update the centers with random batches of features
+  void updateMiniBatch(const std::vector<Feature*>& features, std::size_t k,
+                       std::vector<Feature, FeatureAllocator>& centers,
+                       std::mt19937& randomNumberGenerator) const;
+
+  /**
+   * @brief Assign each feature to its nearest center.
+   * @param[in] features the features
+   * @param[in] centers the centers
+   * @param[in,out] membership the cluster of each feature
+   * @param[out] sums if not null, the sum of the features of each cluster
+   * @param[out] counts if not null, the number of features of each cluster
+   * @return true if no feature changed of cluster
+   */
+  bool assignFeatures(const std::vector<Feature*>& features,
+                      const std::vector<Feature, FeatureAllocator>& centers,
+                      std::vector<unsigned int>& membership,
+                      std::vector<Feature, FeatureAllocator>* sums,
+                      std::vector<std::size_t>* counts) const;
+
+  /// Find the nearest center of nbFeatures features (at most blockSize)
+  void nearestCenters(Feature* const* features, std::size_t nbFeatures,
+                      const std::vector<Feature, FeatureAllocator>& centers, unsigned int* nearest) const
+  {
+    nearestCenters(features, nbFeatures, centers, nearest, IsBatchQuantizable<Feature, Feature, Distance>());
+  }
+
+  /// Compare each feature with each center
+  void nearestCenters(Feature* const* features, std::size_t nbFeatures,
+                      const std::vector<Feature, FeatureAllocator>& centers, unsigned int* nearest, std::false_type) const;
+
+  /// Compare the features with all the centers at once
+  void nearestCenters(Feature* const* features, std::size_t nbFeatures,
+                      const std::vector<Feature, FeatureAllocator>& centers, unsigned int* nearest, std::true_type) const;
+
+  /// Maximal number of features compared at once with the centers
+  static const std::size_t blockSize = 64;
 
   Feature zero_;
   Distance distance_;
   Initializer choose_centers_;
   std::size_t max_iterations_;
   std::size_t restarts_;
+  std::size_t mini_batch_size_;
   int verbose_;
 };
 
+template < class Feature, class Distance, class FeatureAllocator >
+const std::size_t SimpleKmeans<Feature, Distance, FeatureAllocator>::blockSize;
+
 template < class Feature, class Distance, class FeatureAllocator >
 SimpleKmeans<Feature, Distance, FeatureAllocator>::SimpleKmeans(const Feature& zero, Distance d, const int verbose)
 : zero_(zero),
@@ -362,8 +436,9 @@ distance_(d),
 //    choose_centers_( InitRandom( ) ),
 choose_centers_(InitKmeanspp()),
 max_iterations_(100),
-verbose_(verbose),
-restarts_(1)
+restarts_(1),
+mini_batch_size_(0),
+verbose_(verbose)
 {
 }
 
@@ -371,20 +446,22 @@ template < class Feature, class Distance, class FeatureAllocator >
 typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
 SimpleKmeans<Feature, Distance, FeatureAllocator>::cluster(const std::vector<Feature, FeatureAllocator>& features, size_t k,
                                                            std::vector<Feature, FeatureAllocator>& centers,
-                                                           std::vector<unsigned int>& membership) const
+                                                           std::vector<unsigned int>& membership,
+                                                           std::mt19937& randomNumberGenerator) const
 {
   std::vector<Feature*> feature_ptrs;
   feature_ptrs.reserve(features.size());
   BOOST_FOREACH(const Feature& f, features)
   feature_ptrs.push_back(const_cast<Feature*> (&f));
-  return clusterPointers(feature_ptrs, k, centers, membership);
+  return clusterPointers(feature_ptrs, k, centers, membership, randomNumberGenerator);
 }
 
 template < class Feature, class Distance, class FeatureAllocator >
 typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
 SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterPointers(const std::vector<Feature*>& features, size_t k,
                                                                    std::vector<Feature, FeatureAllocator>& centers,
-                                                                   std::vector<unsigned int>& membership) const
+                                                                   std::vector<unsigned int>& membership,
+                                                                   std::mt19937& randomNumberGenerator) const
 {
   std::vector<Feature, FeatureAllocator> new_centers(centers);
   new_centers.resize(k);
@@ -395,8 +472,8 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterPointers(const std::ve
   for(std::size_t starts = 0; starts < restarts_; ++starts)
   {
     if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Trial " << starts + 1 << "/" << restarts_);
-    choose_centers_(features, k, new_centers, distance_, verbose_);
-    squared_distance_type sse = clusterOnce(features, k, new_centers, new_membership);
+    choose_centers_(features, k, new_centers, distance_, randomNumberGenerator, verbose_);
+    squared_distance_type sse = clusterOnce(features, k, new_centers, new_membership, randomNumberGenerator);
     if(verbose_ > 0) ALICEVISION_LOG_DEBUG("End of Trial " << starts + 1 << "/" << restarts_);
     if(sse < least_sse)
     {
@@ -415,119 +492,242 @@ template < class Feature, class Distance, class FeatureAllocator >
 typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type
 SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterOnce(const std::vector<Feature*>& features, std::size_t k,
                                                                std::vector<Feature, FeatureAllocator>& centers,
-                                                               std::vector<unsigned int>& membership) const
+                                                               std::vector<unsigned int>& membership,
+                                                               std::mt19937& randomNumberGenerator) const
 {
-  typedef typename std::vector<Feature, FeatureAllocator>::value_type centerType;
-  typedef typename Distance::value_type feature_value_type;
-
   std::vector<std::size_t> new_center_counts(k);
   std::vector<Feature, FeatureAllocator> new_centers(k);
   squared_distance_type max_center_shift = std::numeric_limits<squared_distance_type>::max();
 
-  if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Iterations");
-  for(std::size_t iter = 0; iter < max_iterations_; ++iter)
+  if(mini_batch_size_ > 0 && features.size() > mini_batch_size_)
+  {
+    if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Mini-batch iterations");
+    updateMiniBatch(features, k, centers, randomNumberGenerator);
+    assignFeatures(features, centers, membership, nullptr, nullptr);
+  }
+  else
   {
-    if(verbose_ > 0) ALICEVISION_LOG_DEBUG("*");
-    // Zero out new centers and counts
-    std::fill(new_center_counts.begin(), new_center_counts.end(), 0);
-    //		for(std::size_t i = 0; i < k; checkElements(new_centers[i++], "bef"));
-    std::fill(new_centers.begin(), new_centers.end(), zero_);
-    //		for(std::size_t i = 0; i < k; checkElements(new_centers[i++], "aft"));
-    assert(checkVectorElements(new_centers, "newcenters init"));
-    bool is_stable = true;
-
-
-    // Assign data objects to current centers
-    #pragma omp parallel for shared( new_centers, new_center_counts, features, centers, membership)
-    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+    if(verbose_ > 0) ALICEVISION_LOG_DEBUG("Iterations");
+    for(std::size_t iter = 0; iter < max_iterations_; ++iter)
     {
-      squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
-      unsigned int nearest = 0;
-      bool found = false;
+      if(verbose_ > 0) ALICEVISION_LOG_DEBUG("*");
 
-      // @todo if k is large, let's say k>100 use FLAAN to retrieve the 
-      // cluster center
+      // Assign data objects to current centers and accumulate the new centers
+      const bool is_stable = assignFeatures(features, centers, membership, &new_centers, &new_center_counts);
+      assert(checkVectorElements(new_centers, "newcenters"));
 
-      // Find the nearest cluster center to feature i
-      for(unsigned int j = 0; j < k; ++j)
+      if(is_stable) break;
+
+      if(iter > 0)
+        max_center_shift = 0;
+      // Assign new centers
+      for(std::size_t i = 0; i < k; ++i)
       {
-        squared_distance_type distance = distance_(*features[i], centers[j]);
-        //		printf("\t\tdistance %f\n", (float)distance);
-        //		PrintFeat(*features[i] );
-        if(distance < d_min)
+        if(new_center_counts[i] > 0)
         {
-          d_min = distance;
-          nearest = j;
-          found = true;
+          new_centers[i] = new_centers[i] / new_center_counts[i];
+
+          squared_distance_type shift = distance_(new_centers[i], centers[i]);
+
+          max_center_shift = std::max(max_center_shift, shift);
+
+          centers[i] = new_centers[i];
+        }
+        else
+        {
+          // Choose a new center randomly from the input features
+          // @todo use a better strategy like taking splitting the largest cluster
+          unsigned int index = std::uniform_int_distribution<unsigned int>(0, features.size() - 1)(randomNumberGenerator);
+          centers[i] = *features[index];
+          ALICEVISION_LOG_DEBUG("Choosing a new center: " << index);
         }
-        //		 printf("\t distance %f %f\n", (double)distance, (double)d_min);
-      }
-      assert(found);
-      // Assign feature i to the cluster it is nearest to
-      if(membership[i] != nearest)
-      {
-        is_stable = false;
-        membership[i] = nearest;
       }
-      // Accumulate the cluster center and its membership count
-      //	  printf("\t nearest %d\n", nearest);
-      //			checkElements(*features[i], "feat");
-      #pragma omp critical
+      //			ALICEVISION_LOG_DEBUG("max_center_shift: " << max_center_shift);
+      if(max_center_shift <= 10e-10) break;
+    }
+  }
+  if(verbose_ > 0) ALICEVISION_LOG_DEBUG("");
+
+  // Return the sum squared error
+  /// @todo Kahan summation?
+  squared_distance_type sse = squared_distance_type(0);
+  assert(features.size() > 0);
+  #pragma omp parallel for reduction(+:sse)
+  for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+  {
+    sse += distance_(*features[i], centers[membership[i]]);
+  }
+  return sse;
+}
+
+template < class Feature, class Distance, class FeatureAllocator >
+void SimpleKmeans<Feature, Distance, FeatureAllocator>::updateMiniBatch(const std::vector<Feature*>& features, std::size_t k,
+                                                                        std::vector<Feature, FeatureAllocator>& centers,
+                                                                        std::mt19937& randomNumberGenerator) const
+{
+  typedef typename Distance::value_type feature_value_type;
+
+  std::vector<std::size_t> center_counts(k, 0);
+  std::vector<Feature*> batch(mini_batch_size_);
+  std::vector<unsigned int> nearest(mini_batch_size_);
+  std::uniform_int_distribution<std::size_t> randomFeature(0, features.size() - 1);
+  const ptrdiff_t nbBlocks = (mini_batch_size_ + blockSize - 1) / blockSize;
+
+  for(std::size_t iter = 0; iter < max_iterations_; ++iter)
+  {
+    for(std::size_t i = 0; i < batch.size(); ++i)
+      batch[i] = features[randomFeature(randomNumberGenerator)];
+
+    // Assign the batch to the current centers
+    #pragma omp parallel for schedule(dynamic)
+    for(ptrdiff_t b = 0; b < nbBlocks; ++b)
+    {
+      const std::size_t begin = b * blockSize;
+      const std::size_t nbFeatures = std::min(blockSize, batch.size() - begin);
+      nearestCenters(&batch[begin], nbFeatures, centers, &nearest[begin]);
+    }
+
+    // Move each center towards its features, with a learning rate decreasing with
+    // the number of features already assigned to the center
+    for(std::size_t i = 0; i < batch.size(); ++i)
+    {
+      Feature& center = centers[nearest[i]];
+      const Feature& feature = *batch[i];
+      const double learningRate = 1.0 / ++center_counts[nearest[i]];
+      for(std::size_t d = 0; d < center.size(); ++d)
+        center[d] += static_cast<feature_value_type>((feature[d] - center[d]) * learningRate);
+    }
+  }
+}
+
+template < class Feature, class Distance, class FeatureAllocator >
+bool SimpleKmeans<Feature, Distance, FeatureAllocator>::assignFeatures(const std::vector<Feature*>& features,
+                                                                       const std::vector<Feature, FeatureAllocator>& centers,
+                                                                       std::vector<unsigned int>& membership,
+                                                                       std::vector<Feature, FeatureAllocator>* sums,
+                                                                       std::vector<std::size_t>* counts) const
+{
+  const std::size_t k = centers.size();
+  const ptrdiff_t nbBlocks = (features.size() + blockSize - 1) / blockSize;
+  bool is_stable = true;
+
+  if(sums)
+    std::fill(sums->begin(), sums->end(), zero_);
+  if(counts)
+    std::fill(counts->begin(), counts->end(), 0);
+
+  #pragma omp parallel
+  {
+    // accumulate the clusters per thread, then merge them once
+    std::vector<Feature, FeatureAllocator> thread_sums(sums ? k : 0, zero_);
+    std::vector<std::size_t> thread_counts(counts ? k : 0, 0);
+    std::vector<unsigned int> nearest(blockSize);
+    bool thread_stable = true;
+
+    #pragma omp for schedule(dynamic)
+    for(ptrdiff_t b = 0; b < nbBlocks; ++b)
+    {
+      const std::size_t begin = b * blockSize;
+      const std::size_t nbFeatures = std::min(blockSize, features.size() - begin);
+      nearestCenters(&features[begin], nbFeatures, centers, nearest.data());
+
+      for(std::size_t i = 0; i < nbFeatures; ++i)
       {
-        new_centers[nearest] += *features[i];
-        //			checkElements(new_centers[nearest], "sum");
-        //	  printf("\t new_centers[nearest] += *features[i];\n");
-        ++new_center_counts[nearest];
-        //	  printf("\taccumulate\n");
+        const unsigned int cluster = nearest[i];
+        // Assign feature i to the cluster it is nearest to
+        if(membership[begin + i] != cluster)
+        {
+          thread_stable = false;
+          membership[begin + i] = cluster;
+        }
+        // Accumulate the cluster center and its membership count
+        if(sums)
+          thread_sums[cluster] += *features[begin + i];
+        if(counts)
+          ++thread_counts[cluster];
       }
-    }//for
-
-    if(is_stable) break;
+    }
 
-    if(iter > 0)
-      max_center_shift = 0;
-    // Assign new centers
-    for(std::size_t i = 0; i < k; ++i)
+    #pragma omp critical
     {
-      if(new_center_counts[i] > 0)
+      for(std::size_t c = 0; c < k; ++c)
       {
-        //		  printf("%d - %d\n", i, new_center_counts[i] );
-        //		  PrintFeat(new_centers[i] );
-        //		checkElements(new_centers[i], "bef");
-        new_centers[i] = new_centers[i] / new_center_counts[i];
+        if(sums)
+          (*sums)[c] += thread_sums[c];
+        if(counts)
+          (*counts)[c] += thread_counts[c];
+      }
+      is_stable = is_stable && thread_stable;
+    }
+  }
+  return is_stable;
+}
 
-        squared_distance_type shift = distance_(new_centers[i], centers[i]);
+template < class Feature, class Distance, class FeatureAllocator >
+void SimpleKmeans<Feature, Distance, FeatureAllocator>::nearestCenters(Feature* const* features, std::size_t nbFeatures,
+                                                                       const std::vector<Feature, FeatureAllocator>& centers,
+                                                                       unsigned int* nearest, std::false_type) const
+{
+  for(std::size_t i = 0; i < nbFeatures; ++i)
+  {
+    squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
+    nearest[i] = 0;
 
-        max_center_shift = std::max(max_center_shift, shift);
+    // @todo if k is large, let's say k>100 use FLAAN to retrieve the
+    // cluster center
 
-        centers[i] = new_centers[i];
-        //					centers[i] = new_centers[i] / new_center_counts[i];
-        //		checkElements(new_centers[i], "aft");
-        //		PrintFeat(centers[i] );
-      }
-      else
+    // Find the nearest cluster center to feature i
+    for(unsigned int j = 0; j < centers.size(); ++j)
+    {
+      squared_distance_type distance = distance_(*features[i], centers[j]);
+      if(distance < d_min)
       {
-        // Choose a new center randomly from the input features
-        // @todo use a better strategy like taking splitting the largest cluster
-        unsigned int index = rand() % features.size();
-        centers[i] = *features[index];
-        ALICEVISION_LOG_DEBUG("Choosing a new center: " << index);
+        d_min = distance;
+        nearest[i] = j;
       }
     }
-    //			ALICEVISION_LOG_DEBUG("max_center_shift: " << max_center_shift);  
-    if(max_center_shift <= 10e-10) break;
   }
-  if(verbose_ > 0) ALICEVISION_LOG_DEBUG("");
+}
 
-  // Return the sum squared error
-  /// @todo Kahan summation?
-  squared_distance_type sse = squared_distance_type(0);
-  assert(features.size() > 0);
-  for(std::size_t i = 0; i < features.size(); ++i)
+template < class Feature, class Distance, class FeatureAllocator >
+void SimpleKmeans<Feature, Distance, FeatureAllocator>::nearestCenters(Feature* const* features, std::size_t nbFeatures,
+                                                                       const std::vector<Feature, FeatureAllocator>& centers,
+                                                                       unsigned int* nearest, std::true_type) const
+{
+  assert(nbFeatures <= blockSize);
+  const std::size_t k = centers.size();
+  const std::size_t size = Feature::static_size;
+
+  const float* queries[blockSize];
+  for(std::size_t i = 0; i < nbFeatures; ++i)
+    queries[i] = features[i]->getData();
+
+  std::vector<float> distances(nbFeatures * k);
+  l2SquaredDistances(queries, nbFeatures, centers.front().getData(), k, size, distances.data());
+
+  for(std::size_t i = 0; i < nbFeatures; ++i)
   {
-    sse += distance_(*features[i], centers[membership[i]]);
+    const float* featureDistances = &distances[i * k];
+
+    // the single precision distances only select the candidates: the centers close to the best one
+    // are compared with the exact distance, so the result is the same as the scalar version
+    const float minDistance = *std::min_element(featureDistances, featureDistances + k);
+    const float maxDistance = minDistance + 1e-4f * minDistance + 1e-3f;
+
+    squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
+    nearest[i] = 0;
+    for(unsigned int j = 0; j < k; ++j)
+    {
+      if(!(featureDistances[j] <= maxDistance))
+        continue;
+      squared_distance_type distance = distance_(*features[i], centers[j]);
+      if(distance < d_min)
+      {
+        d_min = distance;
+        nearest[i] = j;
+      }
+    }
   }
-  return sse;
 }
 
 }
@@ -8,8 +8,13 @@
 
 #include "MutableVocabularyTree.hpp"
 #include "SimpleKmeans.hpp"
-#include <deque>
-//#include <cstdio> //DEBUG
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
 
 namespace aliceVision {
 namespace voctree {
@@ -17,6 +22,11 @@ namespace voctree {
 /**
  * @brief Class for building a new vocabulary by hierarchically clustering
  * a set of training features.
+ *
+ * The tree is built level by level. When a level has enough nodes to keep all the threads busy,
+ * the subtrees are clustered in parallel (largest first), otherwise the nodes are clustered one
+ * after another with a parallel k-means. Each node is clustered with its own random generator,
+ * seeded from the generator given to build(), so the tree does not depend on the number of threads.
  */
 template<class Feature,
          template<typename, typename> class DistanceT = L2,
@@ -45,8 +55,9 @@ public:
    * @param training_features The set of training features to cluster.
    * @param k                 The branching factor, or max children of any node.
    * @param levels            The number of levels in the tree.
+   * @param randomNumberGenerator The random generator used to seed the clustering of each node.
    */
-  void build(const FeatureVector& training_features, uint32_t k, uint32_t levels);
+  void build(const FeatureVector& training_features, uint32_t k, uint32_t levels, std::mt19937& randomNumberGenerator);
 
   /// Get the built vocabulary tree.
 
@@ -97,78 +108,104 @@ verbose_(verbose)
 
 template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
 void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVector& training_features,
-                                                             uint32_t k, uint32_t levels)
+                                                             uint32_t k, uint32_t levels,
+                                                             std::mt19937& randomNumberGenerator)
 {
-  // Initial setup and memory allocation for the tree
+  // Initial setup and memory allocation for the tree:
+  // the children of a node that is not clustered stay invalid
   tree_.clear();
   tree_.setSize(levels, k);
-  tree_.centers().reserve(tree_.nodes());
-  tree_.validCenters().reserve(tree_.nodes());
+  tree_.centers().assign(tree_.nodes(), zero_);
+  tree_.validCenters().assign(tree_.nodes(), 0);
 
-  // We keep a queue of disjoint feature subsets to cluster.
+  // We keep the disjoint feature subsets of the current level to cluster, the subset i
+  // is clustered into the children of the i-th node of the level.
   // Feature* is used to avoid copying features.
-  std::deque< std::vector<Feature*> > subset_queue(1);
+  std::vector< std::vector<Feature*> > subsets(1);
 
   {
-    // At first the queue contains one "subset" containing all the features.
-    std::vector<Feature*> &feature_ptrs = subset_queue.front();
+    // At first there is one "subset" containing all the features.
+    std::vector<Feature*> &feature_ptrs = subsets.front();
     feature_ptrs.reserve(training_features.size());
     for(const Feature& f: training_features)
     {
       feature_ptrs.push_back(const_cast<Feature*> (&f));
     }
   }
-  FeatureVector centers; // always size k
+
+  std::size_t level_start = 0; // index of the first node of the current level
   for(uint32_t level = 0; level < levels; ++level)
   {
-    if(verbose_) printf("# Level %u\n", level);
-    std::vector<unsigned int> membership;
-
-    for(std::size_t i = 0, ie = subset_queue.size(); i < ie; ++i)
+    if(verbose_) ALICEVISION_LOG_INFO("Level " << level);
+
+    const bool last_level = (level + 1 == levels);
+    std::vector< std::vector<Feature*> > child_subsets(last_level ? 0 : subsets.size() * k);
+
+    // cluster the largest subsets first
+    std::vector<std::size_t> order(subsets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&subsets](std::size_t a, std::size_t b) {
+      return subsets[a].size() > subsets[b].size();
+    });
+    const std::size_t nb_clustered = std::count_if(subsets.begin(), subsets.end(), [k](const std::vector<Feature*>& subset) {
+      return subset.size() > k;
+    });
+    // parallelize over the subsets or inside the k-means
+    const bool parallel_subsets = nb_clustered >= static_cast<std::size_t>(omp_get_max_threads());
+
+    // the seeds are drawn in the order of the nodes, whatever the order of the clustering
+    std::vector<std::mt19937::result_type> seeds(subsets.size());
+    for(auto& seed : seeds)
+      seed = randomNumberGenerator();
+
+    #pragma omp parallel for schedule(dynamic) if(parallel_subsets)
+    for(ptrdiff_t s = 0; s < static_cast<ptrdiff_t>(order.size()); ++s)
     {
-      std::vector<Feature*> &subset = subset_queue.front();
-      if(verbose_ > 1) printf("#\tClustering subset %lu/%lu of size %lu\n", i + 1, ie, subset.size());
+      const std::size_t i = order[s];
+      std::vector<Feature*> &subset = subsets[i];
+      const std::size_t first_child = level_start + i * k;
+
+      if(verbose_ > 1) ALICEVISION_LOG_DEBUG("Clustering subset " << i + 1 << "/" << subsets.size() << " of size " << subset.size());
 
       // If the subset already has k or fewer elements, just use those as the centers.
       if(subset.size() <= k)
       {
-        if(verbose_ > 2) printf("#\tno need to cluster %lu elements\n", subset.size());
+        if(verbose_ > 2) ALICEVISION_LOG_DEBUG("No need to cluster " << subset.size() << " elements");
         for(std::size_t j = 0; j < subset.size(); ++j)
         {
-          tree_.centers().push_back(*subset[j]);
-          tree_.validCenters().push_back(1);
+          tree_.centers()[first_child + j] = *subset[j];
+          tree_.validCenters()[first_child + j] = 1;
         }
-        // Mark non-existent centers as invalid.
-        tree_.centers().insert(tree_.centers().end(), k - subset.size(), zero_);
-        tree_.validCenters().insert(tree_.validCenters().end(), k - subset.size(), 0);
-
-        // Push k empty subsets into the queue so all children get marked invalid.
-        subset_queue.pop_front();
-        subset_queue.insert(subset_queue.end(), k, std::vector<Feature*>());
       }
       else
       {
         // Cluster the current subset into k centers.
-        if(verbose_ > 2) printf("#\tclustering the current subset of %lu elements into %d centers\n", subset.size(), k);
-        kmeans_.clusterPointers(subset, k, centers, membership);
+        if(verbose_ > 2) ALICEVISION_LOG_DEBUG("Clustering the current subset of " << subset.size() << " elements into " << k << " centers");
+        FeatureVector centers;
+        std::vector<unsigned int> membership;
+        std::mt19937 subsetRandomNumberGenerator(seeds[i]);
+        kmeans_.clusterPointers(subset, k, centers, membership, subsetRandomNumberGenerator);
         // Add the centers and mark them as valid.
-        tree_.centers().insert(tree_.centers().end(), centers.begin(), centers.end());
-        tree_.validCenters().insert(tree_.validCenters().end(), k, 1);
+        std::copy(centers.begin(), centers.end(), tree_.centers().begin() + first_child);
+        std::fill(tree_.validCenters().begin() + first_child, tree_.validCenters().begin() + first_child + k, 1);
         // Partition the current subset into k new subsets based on the cluster assignments.
-        std::vector< std::vector<Feature*> > new_subsets(k);
-        assert(membership.size() >= subset.size());
-        for(std::size_t j = 0; j < subset.size(); ++j)
+        if(!last_level)
         {
-          assert(membership[j] < k);
-          assert(membership[j] < new_subsets.size());
-          new_subsets[ membership[j] ].push_back(subset[j]);
+          assert(membership.size() >= subset.size());
+          for(std::size_t j = 0; j < subset.size(); ++j)
+          {
+            assert(membership[j] < k);
+            child_subsets[i * k + membership[j]].push_back(subset[j]);
+          }
         }
-        // Update the queue
-        subset_queue.pop_front();
-        subset_queue.insert(subset_queue.end(), new_subsets.begin(), new_subsets.end());
       }
+      // the subset is not needed anymore
+      std::vector<Feature*>().swap(subset);
     }
-    if(verbose_) printf("# centers so far = %lu\n", tree_.centers().size());
+
+    level_start += order.size() * k;
+    subsets.swap(child_subsets);
+    if(verbose_) ALICEVISION_LOG_INFO("Centers so far: " << level_start);
   }
 }
 
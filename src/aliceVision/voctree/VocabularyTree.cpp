@@ -23,6 +23,11 @@ std::ostream& operator<<(std::ostream& os, const Document& doc)
 }
 
 float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const std::string &distanceMethod, const std::vector<float>& word_weights)
+{
+  return sparseDistance(v1, v2, distanceMethod, word_weights.data());
+}
+
+float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const std::string &distanceMethod, const float* word_weights)
 {
 
   float distance{0.0f};
@@ -49,8 +54,9 @@ float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const
       }
       else
       {
-        const auto val = std::minmax(i1->second.size(), i2->second.size());
-        distance += static_cast<float>(val.second - val.first);
+        const std::size_t size1 = i1->second.size();
+        const std::size_t size2 = i2->second.size();
+        distance += static_cast<float>(std::max(size1, size2) - std::min(size1, size2));
         ++i1;
         ++i2;
       }
@@ -10,15 +10,22 @@
 #include "distance.hpp"
 #include "DefaultAllocator.hpp"
 
+#include <aliceVision/feature/Descriptor.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/feature/regionsFactory.hpp>
 
 #include <aliceVision/types.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MappedFile.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
 #include <vector>
 #include <map>
+#include <memory>
 #include <cassert>
 #include <limits>
 #include <fstream>
@@ -119,7 +126,11 @@ public:
   template<class DescriptorT>
   Word quantize(const DescriptorT& feature) const;
 
-  /// Quantizes a set of features into visual words.
+  /**
+   * @brief Quantizes a set of features into visual words.
+   *        Float and unsigned char descriptors are processed in blocks: at each level, the features are grouped
+   *        by node and the children of a node are compared with a whole block of features.
+   */
   template<class DescriptorT>
   std::vector<Word> quantize(const std::vector<DescriptorT>& features) const;
 
@@ -145,13 +156,25 @@ public:
 
   /// Save vocabulary to a file.
   void save(const std::string& file) const override;
-  /// Load vocabulary from a file.
+
+  /**
+   * @brief Load vocabulary from a file.
+   *        When the descriptor type allows it, the centers are not read but memory mapped:
+   *        the loading is immediate and the processes using the same file share its pages.
+   */
   void load(const std::string& file) override;
 
+  /// Return true if the centers are read from a memory mapped file.
+  bool isMapped() const
+  {
+    return mapping_ != nullptr;
+  }
+
   bool operator==(const VocabularyTree& other) const
   {
-    return (centers_ == other.centers_) &&
-        (valid_centers_ == other.valid_centers_) &&
+    return (nbCenters() == other.nbCenters()) &&
+        std::equal(centersData(), centersData() + nbCenters(), other.centersData()) &&
+        std::equal(validCentersData(), validCentersData() + nbCenters(), other.validCentersData()) &&
         (k_ == other.k_) &&
         (levels_ == other.levels_) &&
         (num_words_ == other.num_words_) &&
@@ -162,6 +185,11 @@ protected:
   std::vector<Feature, FeatureAllocator> centers_;
   std::vector<uint8_t> valid_centers_; /// @todo Consider bit-vector
 
+  // Memory mapped vocabulary file, used instead of centers_ and valid_centers_ when set
+  std::shared_ptr<system::MappedFile> mapping_;
+  const Feature* mapped_centers_ = nullptr;
+  const uint8_t* mapped_valid_centers_ = nullptr;
+
   uint32_t k_; // splits, or branching factor
   uint32_t levels_;
   uint32_t num_words_; // number of leaf nodes
@@ -173,6 +201,33 @@ protected:
   }
 
   void setNodeCounts();
+
+  /// Read vocabulary from a file into centers_ and valid_centers_.
+  void read(const std::string& file);
+
+  std::size_t nbCenters() const
+  {
+    return mapping_ ? (word_start_ + num_words_) : centers_.size();
+  }
+
+  const Feature* centersData() const
+  {
+    return mapping_ ? mapped_centers_ : centers_.data();
+  }
+
+  const uint8_t* validCentersData() const
+  {
+    return mapping_ ? mapped_valid_centers_ : valid_centers_.data();
+  }
+
+private:
+  /// Quantizes each feature independently
+  template<class DescriptorT>
+  std::vector<Word> quantize(const std::vector<DescriptorT>& features, std::false_type) const;
+
+  /// Quantizes the features by blocks
+  template<class DescriptorT>
+  std::vector<Word> quantize(const std::vector<DescriptorT>& features, std::true_type) const;
 };
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -197,6 +252,8 @@ Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const Descrip
   //	printf("asserting\n");
   assert(initialized());
   //	printf("initialized\n");
+  const Feature* centers = centersData();
+  const uint8_t* valid_centers = validCentersData();
   int32_t index = -1; // virtual "root" index, which has no associated center.
   for(unsigned level = 0; level < levels_; ++level)
   {
@@ -207,9 +264,9 @@ Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const Descrip
     distance_type best_distance = std::numeric_limits<distance_type>::max();
     for(int32_t child = first_child; child < first_child + (int32_t) splits(); ++child)
     {
-      if(!valid_centers_[child])
+      if(!valid_centers[child])
         break; // Fewer than splits() children.
-      distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers_[child]);
+      distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers[child]);
       if(child_distance < best_distance)
       {
         best_child = child;
@@ -225,6 +282,13 @@ Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const Descrip
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 template<class DescriptorT>
 std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const std::vector<DescriptorT>& features) const
+{
+  return quantize(features, IsBatchQuantizable<Feature, DescriptorT, Distance<DescriptorT, Feature>>());
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+template<class DescriptorT>
+std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const std::vector<DescriptorT>& features, std::false_type) const
 {
   // ALICEVISION_LOG_DEBUG("VocabularyTree quantize: " << features.size());
   std::vector<Word> imgVisualWords(features.size(), 0);
@@ -241,6 +305,113 @@ std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(
   return imgVisualWords;
 }
 
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+template<class DescriptorT>
+std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const std::vector<DescriptorT>& features, std::true_type) const
+{
+  typedef typename Distance<DescriptorT, Feature>::result_type distance_type;
+
+  assert(initialized());
+
+  const std::size_t nbFeatures = features.size();
+  const std::size_t size = Feature::static_size;
+  const std::size_t blockSize = 64; // maximal number of features compared at once with the children of a node
+  const Feature* centers = centersData();
+  const uint8_t* valid_centers = validCentersData();
+
+  // convert the features to float once for all the levels
+  std::vector<float> queries(nbFeatures * size);
+  #pragma omp parallel for
+  for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(nbFeatures); ++j)
+  {
+    const auto* data = features[j].getData();
+    std::copy(data, data + size, queries.begin() + j * size);
+  }
+
+  std::vector<int32_t> nodes(nbFeatures, -1); // virtual "root" index, which has no associated center.
+  std::vector<uint32_t> order(nbFeatures);
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<std::pair<std::size_t, std::size_t>> blocks;
+
+  for(unsigned level = 0; level < levels_; ++level)
+  {
+    // group the features by node
+    if(level > 0)
+    {
+      std::sort(order.begin(), order.end(), [&nodes](uint32_t a, uint32_t b) {
+        return nodes[a] < nodes[b] || (nodes[a] == nodes[b] && a < b);
+      });
+    }
+
+    blocks.clear();
+    for(std::size_t begin = 0; begin < nbFeatures;)
+    {
+      std::size_t end = begin + 1;
+      while(end < nbFeatures && end - begin < blockSize && nodes[order[end]] == nodes[order[begin]])
+        ++end;
+      blocks.emplace_back(begin, end);
+      begin = end;
+    }
+
+    #pragma omp parallel
+    {
+      std::vector<const float*> blockQueries(blockSize);
+      std::vector<float> distances(blockSize * splits());
+
+      #pragma omp for schedule(dynamic)
+      for(ptrdiff_t b = 0; b < static_cast<ptrdiff_t>(blocks.size()); ++b)
+      {
+        const std::size_t begin = blocks[b].first;
+        const std::size_t nbQueries = blocks[b].second - begin;
+
+        // Calculate the offset to the first child of the current index.
+        const int32_t first_child = (nodes[order[begin]] + 1) * splits();
+        int32_t nbChildren = 0;
+        while(nbChildren < static_cast<int32_t>(splits()) && valid_centers[first_child + nbChildren])
+          ++nbChildren; // Fewer than splits() children.
+
+        for(std::size_t q = 0; q < nbQueries; ++q)
+          blockQueries[q] = &queries[order[begin + q] * size];
+
+        if(nbChildren > 0)
+          l2SquaredDistances(blockQueries.data(), nbQueries, centers[first_child].getData(), nbChildren, size, distances.data());
+
+        for(std::size_t q = 0; q < nbQueries; ++q)
+        {
+          const uint32_t featureIndex = order[begin + q];
+          const float* queryDistances = &distances[q * nbChildren];
+
+          // the single precision distances only select the candidates: the children close to the best one
+          // are compared with the exact distance, so the result is the same as quantize(feature)
+          const float minDistance = (nbChildren > 0) ? *std::min_element(queryDistances, queryDistances + nbChildren) : 0.f;
+          const float maxDistance = minDistance + 1e-4f * minDistance + 1e-3f;
+
+          int32_t best_child = first_child;
+          distance_type best_distance = std::numeric_limits<distance_type>::max();
+          for(int32_t c = 0; c < nbChildren; ++c)
+          {
+            if(!(queryDistances[c] <= maxDistance))
+              continue;
+            const distance_type child_distance = Distance<DescriptorT, Feature>()(features[featureIndex], centers[first_child + c]);
+            if(child_distance < best_distance)
+            {
+              best_child = first_child + c;
+              best_distance = child_distance;
+            }
+          }
+          nodes[featureIndex] = best_child;
+        }
+      }
+    }
+  }
+
+  std::vector<Word> imgVisualWords(nbFeatures);
+  for(std::size_t j = 0; j < nbFeatures; ++j)
+    imgVisualWords[j] = nodes[j] - word_start_;
+
+  return imgVisualWords;
+}
+
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 template<class DescriptorT>
 SparseHistogram VocabularyTree<Feature, Distance, FeatureAllocator>::quantizeToSparse(const std::vector<DescriptorT>& features) const
@@ -274,6 +445,9 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::clear()
 {
   centers_.clear();
   valid_centers_.clear();
+  mapping_.reset();
+  mapped_centers_ = nullptr;
+  mapped_valid_centers_ = nullptr;
   k_ = levels_ = num_words_ = word_start_ = 0;
 }
 
@@ -287,14 +461,48 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::save(const std::string
   std::ofstream out(file.c_str(), std::ios_base::binary);
   out.write((char*) (&k_), sizeof (uint32_t));
   out.write((char*) (&levels_), sizeof (uint32_t));
-  uint32_t size = centers_.size();
+  uint32_t size = nbCenters();
   out.write((char*) (&size), sizeof (uint32_t));
-  out.write((char*) (&centers_[0]), centers_.size() * sizeof (Feature));
-  out.write((char*) (&valid_centers_[0]), valid_centers_.size());
+  out.write((const char*) centersData(), size * sizeof (Feature));
+  out.write((const char*) validCentersData(), size);
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 void VocabularyTree<Feature, Distance, FeatureAllocator>::load(const std::string& file)
+{
+  // the centers follow the header (splits, levels and number of centers),
+  // they can be used in place if the header size preserves their alignment
+  const std::size_t headerSize = 3 * sizeof(uint32_t);
+  if(!std::is_trivially_copyable<Feature>::value || headerSize % alignof(Feature) != 0)
+  {
+    read(file);
+    return;
+  }
+
+  clear();
+
+  std::shared_ptr<system::MappedFile> mapping = std::make_shared<system::MappedFile>(file);
+  if(mapping->size() < headerSize)
+    throw std::runtime_error("Failed to load vocabulary tree file: " + file);
+
+  uint32_t header[3];
+  std::copy(mapping->data(), mapping->data() + headerSize, reinterpret_cast<char*>(header));
+  const uint32_t size = header[2];
+  if(mapping->size() < headerSize + std::size_t(size) * (sizeof(Feature) + 1))
+    throw std::runtime_error("Failed to load vocabulary tree file: " + file);
+
+  k_ = header[0];
+  levels_ = header[1];
+  mapped_centers_ = reinterpret_cast<const Feature*>(mapping->data() + headerSize);
+  mapped_valid_centers_ = reinterpret_cast<const uint8_t*>(mapping->data() + headerSize + std::size_t(size) * sizeof(Feature));
+  mapping_ = std::move(mapping);
+
+  setNodeCounts();
+  assert(size == num_words_ + word_start_);
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+void VocabularyTree<Feature, Distance, FeatureAllocator>::read(const std::string& file)
 {
   clear();
 
@@ -315,7 +523,7 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::load(const std::string
   }
   catch(std::ifstream::failure& e)
   {
-    throw std::runtime_error("Failed to load vocabulary tree file" + file);
+    throw std::runtime_error("Failed to load vocabulary tree file: " + file);
   }
 
   setNodeCounts();
@@ -345,6 +553,9 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::setNodeCounts()
  */
 float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const std::string &distanceMethod = "classic", const std::vector<float>& word_weights = std::vector<float>());
 
+/// @overload with the word weights of a memory mapped database
+float sparseDistance(const SparseHistogram& v1, const SparseHistogram& v2, const std::string &distanceMethod, const float* word_weights);
+
 inline std::unique_ptr<IVocabularyTree> createVoctreeForDescriberType(feature::EImageDescriberType imageDescriberType)
 {
   using namespace aliceVision::feature;
@@ -43,6 +43,8 @@ void getListOfDescriptorFiles(const sfmData::SfMData& sfmData,
  * @param[in] featuresFolders The folder(s) containing the descriptor files (optional)
  * @param[in,out] descriptors the vector to which append all the read descriptors
  * @param[in,out] numFeatures a vector collecting for each file read the number of features read
+ * @param[in] maxDescriptors if not 0 and if the files contain more descriptors, only this number of descriptors
+ *            evenly sampled in each file is kept (the files are read one by one)
  * @return the total number of features read
  *
  */
@@ -50,7 +52,8 @@ template<class DescriptorT, class FileDescriptorT>
 std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
                          const std::vector<std::string>& featuresFolders,
                          std::vector<DescriptorT>& descriptors,
-                         std::vector<std::size_t>& numFeatures);
+                         std::vector<std::size_t>& numFeatures,
+                         std::size_t maxDescriptors = 0);
 
 } // namespace voctree
 } // namespace aliceVision
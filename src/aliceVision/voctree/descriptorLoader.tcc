@@ -21,7 +21,8 @@ template<class DescriptorT, class FileDescriptorT>
 std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
                          const std::vector<std::string>& featuresFolders,
                          std::vector<DescriptorT>& descriptors,
-                         std::vector<std::size_t> &numFeatures)
+                         std::vector<std::size_t> &numFeatures,
+                         std::size_t maxDescriptors)
 {
   namespace bfs = boost::filesystem;
   std::map<IndexT, std::string> descriptorsFiles;
@@ -59,9 +60,16 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
     return 0;
   }
 
+  // Keep a subset of the descriptors if there are too many of them
+  const bool subsample = (maxDescriptors > 0 && numDescriptors > maxDescriptors);
+  if(subsample)
+    ALICEVISION_LOG_DEBUG("Keeping " << maxDescriptors << " descriptors out of " << numDescriptors);
+
   // Allocate the memory
-  descriptors.reserve(numDescriptors);
+  descriptors.reserve(descriptors.size() + (subsample ? maxDescriptors : numDescriptors));
   std::size_t numDescriptorsCheck = numDescriptors; // for later check
+  std::size_t numDescriptorsSeen = 0;
+  std::vector<DescriptorT> fileDescriptors;
   numDescriptors = 0;
 
   // Read the descriptors
@@ -71,9 +79,28 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
   // Run through the path vector and read the descriptors
   for(const auto &currentFile : descriptorsFiles)
   {
-    // Read the descriptors and append them in the vector
-    feature::loadDescsFromBinFile<DescriptorT, FileDescriptorT>(currentFile.second, descriptors, true);
-    std::size_t result = descriptors.size();
+    std::size_t result;
+    if(subsample)
+    {
+      // Read the descriptors of the file and append the evenly sampled ones
+      feature::loadDescsFromBinFile<DescriptorT, FileDescriptorT>(currentFile.second, fileDescriptors, false);
+      result = numDescriptors;
+      for(const DescriptorT& descriptor : fileDescriptors)
+      {
+        if((numDescriptorsSeen + 1) * maxDescriptors / numDescriptorsCheck > numDescriptorsSeen * maxDescriptors / numDescriptorsCheck)
+        {
+          descriptors.push_back(descriptor);
+          ++result;
+        }
+        ++numDescriptorsSeen;
+      }
+    }
+    else
+    {
+      // Read the descriptors and append them in the vector
+      feature::loadDescsFromBinFile<DescriptorT, FileDescriptorT>(currentFile.second, descriptors, true);
+      result = descriptors.size();
+    }
 
     // Add the number of descriptors from this file
     numFeatures.push_back(result - numDescriptors);
@@ -83,7 +110,7 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
 
     ++display;
   }
-  assert(numDescriptors == numDescriptorsCheck);
+  assert(subsample || numDescriptors == numDescriptorsCheck);
 
   // Return the result
   return numDescriptors;
@@ -0,0 +1,158 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2016 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "distance.hpp"
+
+#include <aliceVision/system/cpu.hpp>
+
+// AVX2 kernels are compiled with a function target attribute (GCC/Clang) or directly (MSVC),
+// so they do not depend on the global architecture flags and are selected at runtime.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ALICEVISION_VOCTREE_AVX2 1
+#define ALICEVISION_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#define ALICEVISION_VOCTREE_AVX2 1
+#define ALICEVISION_TARGET_AVX2
+#else
+#define ALICEVISION_VOCTREE_AVX2 0
+#endif
+
+namespace aliceVision {
+namespace voctree {
+
+namespace {
+
+void l2SquaredDistancesScalar(const float* const* queries, std::size_t nbQueries,
+                              const float* centers, std::size_t nbCenters,
+                              std::size_t size, float* distances)
+{
+  for(std::size_t q = 0; q < nbQueries; ++q)
+  {
+    const float* query = queries[q];
+    for(std::size_t c = 0; c < nbCenters; ++c)
+    {
+      const float* center = centers + c * size;
+      float result = 0.f;
+      for(std::size_t i = 0; i < size; ++i)
+      {
+        const float diff = query[i] - center[i];
+        result += diff * diff;
+      }
+      distances[q * nbCenters + c] = result;
+    }
+  }
+}
+
+#if ALICEVISION_VOCTREE_AVX2
+
+ALICEVISION_TARGET_AVX2
+inline float horizontalSum(__m256 v)
+{
+  const __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  const __m128 sum2 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+  const __m128 sum1 = _mm_add_ss(sum2, _mm_shuffle_ps(sum2, sum2, 0x1));
+  return _mm_cvtss_f32(sum1);
+}
+
+ALICEVISION_TARGET_AVX2
+void l2SquaredDistancesAVX2(const float* const* queries, std::size_t nbQueries,
+                            const float* centers, std::size_t nbCenters,
+                            std::size_t size, float* distances)
+{
+  const std::size_t simdSize = size - size % 8;
+
+  for(std::size_t c = 0; c < nbCenters; ++c)
+  {
+    const float* center = centers + c * size;
+    std::size_t q = 0;
+
+    // 4 queries per iteration: each chunk of the center is loaded once for the 4 queries
+    for(; q + 4 <= nbQueries; q += 4)
+    {
+      const float* q0 = queries[q];
+      const float* q1 = queries[q + 1];
+      const float* q2 = queries[q + 2];
+      const float* q3 = queries[q + 3];
+      __m256 acc0 = _mm256_setzero_ps();
+      __m256 acc1 = _mm256_setzero_ps();
+      __m256 acc2 = _mm256_setzero_ps();
+      __m256 acc3 = _mm256_setzero_ps();
+      for(std::size_t i = 0; i < simdSize; i += 8)
+      {
+        const __m256 cv = _mm256_loadu_ps(center + i);
+        const __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(q0 + i), cv);
+        const __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(q1 + i), cv);
+        const __m256 d2 = _mm256_sub_ps(_mm256_loadu_ps(q2 + i), cv);
+        const __m256 d3 = _mm256_sub_ps(_mm256_loadu_ps(q3 + i), cv);
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+        acc2 = _mm256_fmadd_ps(d2, d2, acc2);
+        acc3 = _mm256_fmadd_ps(d3, d3, acc3);
+      }
+      float r0 = horizontalSum(acc0);
+      float r1 = horizontalSum(acc1);
+      float r2 = horizontalSum(acc2);
+      float r3 = horizontalSum(acc3);
+      for(std::size_t i = simdSize; i < size; ++i)
+      {
+        const float d0 = q0[i] - center[i];
+        const float d1 = q1[i] - center[i];
+        const float d2 = q2[i] - center[i];
+        const float d3 = q3[i] - center[i];
+        r0 += d0 * d0;
+        r1 += d1 * d1;
+        r2 += d2 * d2;
+        r3 += d3 * d3;
+      }
+      distances[q * nbCenters + c] = r0;
+      distances[(q + 1) * nbCenters + c] = r1;
+      distances[(q + 2) * nbCenters + c] = r2;
+      distances[(q + 3) * nbCenters + c] = r3;
+    }
+
+    for(; q < nbQueries; ++q)
+    {
+      const float* query = queries[q];
+      __m256 acc = _mm256_setzero_ps();
+      for(std::size_t i = 0; i < simdSize; i += 8)
+      {
+        const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(query + i), _mm256_loadu_ps(center + i));
+        acc = _mm256_fmadd_ps(d, d, acc);
+      }
+      float result = horizontalSum(acc);
+      for(std::size_t i = simdSize; i < size; ++i)
+      {
+        const float d = query[i] - center[i];
+        result += d * d;
+      }
+      distances[q * nbCenters + c] = result;
+    }
+  }
+}
+
+#endif
+
+} // namespace
+
+void l2SquaredDistances(const float* const* queries, std::size_t nbQueries,
+                        const float* centers, std::size_t nbCenters,
+                        std::size_t size, float* distances)
+{
+#if ALICEVISION_VOCTREE_AVX2
+  static const bool useAVX2 = system::cpu_has_avx2();
+  if(useAVX2)
+  {
+    l2SquaredDistancesAVX2(queries, nbQueries, centers, nbCenters, size, distances);
+    return;
+  }
+#endif
+  l2SquaredDistancesScalar(queries, nbQueries, centers, nbCenters, size, distances);
+}
+
+} // namespace voctree
+} // namespace aliceVision
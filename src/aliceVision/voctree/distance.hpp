@@ -6,7 +6,11 @@
 
 #pragma once
 
+#include <aliceVision/feature/Descriptor.hpp>
+
 #include <stdint.h>
+#include <cstddef>
+#include <type_traits>
 #include <Eigen/Core>
 
 namespace aliceVision {
@@ -38,6 +42,34 @@ struct L2
 };
 
 
+/**
+ * @brief Compute the squared L2 distances between a set of float queries and a set of contiguous float centers
+ *        (uses AVX2 when supported by the CPU).
+ *
+ * @param[in] queries pointers to the queries
+ * @param[in] nbQueries number of queries
+ * @param[in] centers contiguous centers
+ * @param[in] nbCenters number of centers
+ * @param[in] size number of values of each query and center
+ * @param[out] distances distance between the query q and the center c at distances[q * nbCenters + c]
+ */
+void l2SquaredDistances(const float* const* queries, std::size_t nbQueries,
+                        const float* centers, std::size_t nbCenters,
+                        std::size_t size, float* distances);
+
+/**
+ * @brief Tells if a set of descriptors can be compared in batch with a set of centers (see l2SquaredDistances):
+ *        float centers and float or unsigned char descriptors of the same size, compared with the L2 distance.
+ */
+template<class Feature, class DescriptorT, class DistanceT>
+struct IsBatchQuantizable : std::false_type {};
+
+template<std::size_t N, class ValueT>
+struct IsBatchQuantizable<feature::Descriptor<float, N>, feature::Descriptor<ValueT, N>, L2<feature::Descriptor<ValueT, N>, feature::Descriptor<float, N>>>
+  : std::integral_constant<bool, (std::is_same<ValueT, float>::value || std::is_same<ValueT, unsigned char>::value) &&
+                                 sizeof(feature::Descriptor<float, N>) == N * sizeof(float)>
+{};
+
 /// @todo Version for raw data pointers that knows the size of the feature
 /// @todo Specialization for cv::Vec. Doesn't have size() so default won't work.
 
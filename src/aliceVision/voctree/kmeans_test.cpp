@@ -6,6 +6,7 @@
 
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
 #include <aliceVision/voctree/SimpleKmeans.hpp>
 
 #include <iostream>
@@ -25,6 +26,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializer)
   ALICEVISION_LOG_DEBUG("Testing kmeanspp Initializer...");
 
   makeRandomOperationsReproducible();
+  std::mt19937 randomNumberGenerator;
 
   const std::size_t DIMENSION = 128;
   const std::size_t FEATURENUMBER = 500;
@@ -49,7 +51,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializer)
 
   voctree::InitKmeanspp initializer;
 
-  initializer(featPtr, K, centers, voctree::L2<FeatureFloat, FeatureFloat>());
+  initializer(featPtr, K, centers, voctree::L2<FeatureFloat, FeatureFloat>(), randomNumberGenerator);
 
   // it's difficult to check the result as it is random, just check there are no weird things
   BOOST_CHECK(voctree::checkVectorElements(centers, "initializer1"));
@@ -69,7 +71,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializer)
     }
   }
 
-  initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>());
+  initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>(), randomNumberGenerator);
 
   // it's difficult to check the result as it is random, just check there are no weird things
   BOOST_CHECK(voctree::checkVectorElements(centers, "initializer2"));
@@ -84,6 +86,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializerVarying)
   ALICEVISION_LOG_DEBUG("Testing kmeanspp Initializer with variable k and DIM...");
 
   makeRandomOperationsReproducible();
+  std::mt19937 randomNumberGenerator;
 
   const int FEATURENUMBER = 500;
   const std::size_t numTrial = 3;
@@ -124,7 +127,7 @@ BOOST_AUTO_TEST_CASE(kmeanInitializerVarying)
       }
     }
 
-    initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>());
+    initializer(featPtr, K, centers, voctree::L2<FeatureFloat,FeatureFloat>(), randomNumberGenerator);
 
     // it's difficult to check the result as it is random, just check there are no weird things
     BOOST_CHECK(voctree::checkVectorElements(centers, "initializer"));
@@ -138,6 +141,7 @@ BOOST_AUTO_TEST_CASE(kmeanSimple)
   ALICEVISION_LOG_DEBUG("Testing kmeans...");
 
   makeRandomOperationsReproducible();
+  std::mt19937 randomNumberGenerator;
 
   const std::size_t DIMENSION = 8;
   const std::size_t FEATURENUMBER = 500;
@@ -184,7 +188,7 @@ BOOST_AUTO_TEST_CASE(kmeanSimple)
       centersGT.push_back((Eigen::MatrixXf::Constant(1, DIMENSION, STEP * i) - Eigen::MatrixXf::Constant(1, DIMENSION, STEP * (K - 1) / 2)) / ((STEP * (K - 1) / 2) * sqrt(DIMENSION)));
     }
 
-    voctree::SimpleKmeans<FeatureFloat>::squared_distance_type dist = kmeans.cluster(features, K, centers, membership);
+    voctree::SimpleKmeans<FeatureFloat>::squared_distance_type dist = kmeans.cluster(features, K, centers, membership, randomNumberGenerator);
 
 //    voctree::printFeatVector( centers );
 
@@ -218,6 +222,7 @@ BOOST_AUTO_TEST_CASE(kmeanVarying)
   ALICEVISION_LOG_DEBUG("Testing kmeans with variable k and DIM...");
 
   makeRandomOperationsReproducible();
+  std::mt19937 randomNumberGenerator;
 
   const std::size_t FEATURENUMBER = 300;
   const std::size_t numTrial = 3;
@@ -265,7 +270,7 @@ BOOST_AUTO_TEST_CASE(kmeanVarying)
       centersGT.push_back((FeatureFloat::Constant(DIMENSION, STEP * i) - FeatureFloat::Constant(DIMENSION, STEP * (K - 1) / 2)) / ((STEP * (K - 1) / 2) * sqrt(DIMENSION)));
     }
 
-    voctree::SimpleKmeans<FeatureFloat>::squared_distance_type dist = kmeans.cluster(features, K, centers, membership);
+    voctree::SimpleKmeans<FeatureFloat>::squared_distance_type dist = kmeans.cluster(features, K, centers, membership, randomNumberGenerator);
 
 //    voctree::printFeatVector( features );
 //    voctree::printFeatVector(centers);
@@ -299,3 +304,76 @@ BOOST_AUTO_TEST_CASE(kmeanVarying)
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(kmeanMiniBatch)
+{
+  using namespace aliceVision;
+  ALICEVISION_LOG_DEBUG("Testing mini-batch kmeans...");
+
+  makeRandomOperationsReproducible();
+  std::mt19937 randomNumberGenerator;
+
+  const std::size_t DIMENSION = 32;
+  const std::size_t FEATURENUMBER = 400;
+  const std::size_t K = 20;
+  const float STEP = 10.f;
+
+  // float descriptors use the batch assignment
+  typedef feature::Descriptor<float, DIMENSION> FeatureFloat;
+  typedef std::vector<FeatureFloat> FeatureFloatVector;
+
+  std::default_random_engine generator;
+  std::uniform_real_distribution<float> noise(-1.f, 1.f);
+
+  // generate K clusters well far away from each other
+  FeatureFloatVector features;
+  FeatureFloatVector centersGT;
+  features.reserve(FEATURENUMBER * K);
+  for(std::size_t i = 0; i < K; ++i)
+  {
+    FeatureFloat center;
+    for(std::size_t d = 0; d < DIMENSION; ++d)
+      center[d] = (d == i % DIMENSION) ? STEP * (1 + i / DIMENSION) : 0.f;
+    centersGT.push_back(center);
+
+    for(std::size_t j = 0; j < FEATURENUMBER; ++j)
+    {
+      FeatureFloat feature = center;
+      for(std::size_t d = 0; d < DIMENSION; ++d)
+        feature[d] += noise(generator);
+      features.push_back(feature);
+    }
+  }
+
+  FeatureFloatVector centers;
+  std::vector<unsigned int> membership;
+
+  voctree::SimpleKmeans<FeatureFloat> kmeans(FeatureFloat(0.f));
+  kmeans.setVerbose(0);
+  kmeans.setRestarts(3);
+  kmeans.setMiniBatchSize(500);
+  BOOST_CHECK_EQUAL(kmeans.getMiniBatchSize(), 500);
+
+  kmeans.cluster(features, K, centers, membership, randomNumberGenerator);
+
+  BOOST_CHECK_EQUAL(centers.size(), K);
+  BOOST_CHECK_EQUAL(membership.size(), features.size());
+
+  // each ground truth cluster is found
+  voctree::L2<FeatureFloat, FeatureFloat> distance;
+  for(std::size_t i = 0; i < K; ++i)
+  {
+    const unsigned int cluster = membership[i * FEATURENUMBER];
+    BOOST_CHECK_SMALL(distance(centers[cluster], centersGT[i]), 1.0);
+    for(std::size_t j = 0; j < FEATURENUMBER; ++j)
+      BOOST_CHECK_EQUAL(membership[i * FEATURENUMBER + j], cluster);
+  }
+
+  // each feature is assigned to its nearest center
+  for(std::size_t i = 0; i < features.size(); ++i)
+  {
+    const voctree::SimpleKmeans<FeatureFloat>::squared_distance_type assignedDist = distance(features[i], centers[membership[i]]);
+    for(std::size_t j = 0; j < K; ++j)
+      BOOST_CHECK_LE(assignedDist, distance(features[i], centers[j]));
+  }
+}
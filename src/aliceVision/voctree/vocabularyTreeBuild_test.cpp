@@ -23,6 +23,7 @@ BOOST_AUTO_TEST_CASE(voctreeBuilder)
   using namespace aliceVision;
 
   makeRandomOperationsReproducible();
+  std::mt19937 randomNumberGenerator;
 
   const std::string treeName = "test.tree";
 
@@ -60,7 +61,7 @@ BOOST_AUTO_TEST_CASE(voctreeBuilder)
   builder.setVerbose(0);
   builder.kmeans().setRestarts(10);
   ALICEVISION_LOG_DEBUG("Building a tree of L = " << LEVELS << " levels with a branching factor of k = " << K);
-  builder.build(features, K, LEVELS);
+  builder.build(features, K, LEVELS, randomNumberGenerator);
   ALICEVISION_LOG_DEBUG(builder.tree().centers().size() << " centers");
 
   // the centers should all be valid in this configuration
@@ -86,3 +87,56 @@ BOOST_AUTO_TEST_CASE(voctreeBuilder)
   }
 //  voctree::printFeatVector( features ); 
 }
+
+BOOST_AUTO_TEST_CASE(voctreeBuilderThreads)
+{
+  using namespace aliceVision;
+
+  const std::size_t DIMENSION = 8;
+  const std::size_t FEATURENUMBER = 2000;
+  const std::size_t K = 4;
+  const std::size_t LEVELS = 3;
+
+  typedef Eigen::Matrix<float, 1, DIMENSION> FeatureFloat;
+  typedef std::vector<FeatureFloat, Eigen::aligned_allocator<FeatureFloat> > FeatureFloatVector;
+
+  // integer coordinates, so the distances and their sums are exact whatever the summation order
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> coordinate(0, 15);
+  FeatureFloatVector features(FEATURENUMBER);
+  for(FeatureFloat& feature : features)
+    for(std::size_t d = 0; d < DIMENSION; ++d)
+      feature(d) = static_cast<float>(coordinate(generator));
+
+  const int previousNbThreads = omp_get_max_threads();
+
+  for(std::size_t miniBatchSize : {0, 500})
+  {
+    std::vector<FeatureFloatVector> centersPerRun;
+    std::vector<std::vector<uint8_t>> validCentersPerRun;
+
+    // sequential build, then subtrees clustered in parallel from the second level
+    for(int nbThreads : {1, 4, 4})
+    {
+      omp_set_num_threads(nbThreads);
+
+      voctree::TreeBuilder<FeatureFloat> builder(FeatureFloat::Zero());
+      builder.kmeans().setMiniBatchSize(miniBatchSize);
+      std::mt19937 randomNumberGenerator(7);
+      builder.build(features, K, LEVELS, randomNumberGenerator);
+
+      centersPerRun.push_back(builder.tree().centers());
+      validCentersPerRun.push_back(builder.tree().validCenters());
+    }
+
+    for(std::size_t run = 1; run < centersPerRun.size(); ++run)
+    {
+      BOOST_CHECK(validCentersPerRun[run] == validCentersPerRun.front());
+      BOOST_REQUIRE_EQUAL(centersPerRun[run].size(), centersPerRun.front().size());
+      for(std::size_t i = 0; i < centersPerRun.front().size(); ++i)
+        BOOST_CHECK(centersPerRun[run][i] == centersPerRun.front()[i]);
+    }
+  }
+
+  omp_set_num_threads(previousNbThreads);
+}
@@ -5,7 +5,10 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/voctree/Database.hpp>
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -57,3 +60,232 @@ BOOST_AUTO_TEST_CASE(database)
     BOOST_CHECK_SMALL(static_cast<double>(match[0].score), 0.001);
   }
 }
+
+BOOST_AUTO_TEST_CASE(database_invertedFile)
+{
+  const int cardDocuments = 50;
+  const int cardWords = 40;
+  const int cardFeatures = 30;
+
+  std::srand(1234567);
+
+  // Create random documents sharing some of their words
+  SparseHistogramPerImage documents;
+  for(int i = 0; i < cardDocuments; ++i)
+  {
+    std::vector<Word> document(cardFeatures);
+    for(int j = 0; j < cardFeatures; ++j)
+      document[j] = std::rand() % cardWords;
+    computeSparseHistogram(document, documents[i]);
+  }
+  // a document without any word in common with the others
+  computeSparseHistogram({cardWords, cardWords + 1}, documents[cardDocuments]);
+
+  Database db(cardWords + 2);
+  for(const auto& document : documents)
+    db.insert(document.first, document.second);
+
+  // no TF-IDF weights: all the words have a weight of 1
+  const std::vector<float> weights(cardWords + 2, 1.0f);
+  const std::vector<std::string> distanceMethods = {"classic", "commonPoints", "strongCommonPoints", "inversedWeightedCommonPoints"};
+
+  for(const std::string& distanceMethod : distanceMethods)
+  {
+    for(const std::size_t N : {std::size_t(5), documents.size()})
+    {
+      std::map<std::size_t, DocMatches> allMatches;
+      db.find(documents, N, allMatches, distanceMethod);
+      BOOST_CHECK_EQUAL(allMatches.size(), documents.size());
+
+      for(const auto& query : documents)
+      {
+        // brute force reference: distance to each document of the database
+        std::vector<float> distances;
+        for(const auto& document : documents)
+          distances.push_back(sparseDistance(query.second, document.second, distanceMethod, weights));
+
+        DocMatches matches;
+        db.find(query.second, N, matches, distanceMethod);
+        BOOST_CHECK_EQUAL(matches.size(), N);
+        BOOST_CHECK(matches == allMatches.at(query.first));
+
+        // the scores are sorted and match the distance to the returned document
+        for(std::size_t i = 0; i < matches.size(); ++i)
+        {
+          if(i > 0)
+            BOOST_CHECK_LE(matches[i - 1].score, matches[i].score);
+          BOOST_CHECK_SMALL(matches[i].score - distances[matches[i].id], 1e-4f);
+        }
+
+        // nothing better was left out
+        std::sort(distances.begin(), distances.end());
+        BOOST_CHECK_SMALL(matches.back().score - distances[N - 1], 1e-4f);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(vocabularyTree_batchQuantize)
+{
+  typedef aliceVision::feature::Descriptor<float, 128> DescriptorFloat;
+  typedef aliceVision::feature::Descriptor<unsigned char, 128> DescriptorUChar;
+
+  const uint32_t levels = 3;
+  const uint32_t splits = 10;
+
+  std::srand(1234567);
+
+  // random tree
+  MutableVocabularyTree<DescriptorFloat> tree;
+  tree.setSize(levels, splits);
+  tree.centers().resize(tree.nodes());
+  tree.validCenters().resize(tree.nodes(), 1);
+  for(DescriptorFloat& center : tree.centers())
+  {
+    for(std::size_t i = 0; i < center.size(); ++i)
+      center[i] = static_cast<float>(std::rand() % 2560) / 10.f;
+  }
+  // a node with fewer children than splits, and two identical children
+  tree.validCenters()[splits + 7] = 0;
+  tree.validCenters()[splits + 8] = 0;
+  tree.validCenters()[splits + 9] = 0;
+  tree.centers()[2] = tree.centers()[1];
+
+  // random features, and features equal to centers
+  std::vector<DescriptorUChar> featuresUChar(2000);
+  std::vector<DescriptorFloat> featuresFloat(featuresUChar.size());
+  for(std::size_t j = 0; j < featuresUChar.size(); ++j)
+  {
+    for(std::size_t i = 0; i < 128; ++i)
+    {
+      featuresUChar[j][i] = (j % 10 == 0) ? static_cast<unsigned char>(tree.centers()[j % tree.nodes()][i]) : std::rand() % 256;
+      featuresFloat[j][i] = (j % 10 == 0) ? tree.centers()[j % tree.nodes()][i] : featuresUChar[j][i];
+    }
+  }
+
+  const std::vector<Word> wordsUChar = tree.quantize(featuresUChar);
+  const std::vector<Word> wordsFloat = tree.quantize(featuresFloat);
+
+  BOOST_CHECK_EQUAL(wordsUChar.size(), featuresUChar.size());
+  BOOST_CHECK_EQUAL(wordsFloat.size(), featuresFloat.size());
+
+  // same words as the per feature quantization
+  for(std::size_t j = 0; j < featuresUChar.size(); ++j)
+  {
+    BOOST_CHECK_EQUAL(wordsUChar[j], tree.quantize(featuresUChar[j]));
+    BOOST_CHECK_EQUAL(wordsFloat[j], tree.quantize(featuresFloat[j]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(vocabularyTree_mappedLoad)
+{
+  typedef aliceVision::feature::Descriptor<float, 128> DescriptorFloat;
+
+  const std::string treeName = "test_mapped.tree";
+
+  std::srand(1234567);
+
+  MutableVocabularyTree<DescriptorFloat> tree;
+  tree.setSize(2, 8);
+  tree.centers().resize(tree.nodes());
+  tree.validCenters().resize(tree.nodes(), 1);
+  for(DescriptorFloat& center : tree.centers())
+  {
+    for(std::size_t i = 0; i < center.size(); ++i)
+      center[i] = static_cast<float>(std::rand() % 256);
+  }
+  tree.validCenters()[8 + 7] = 0;
+  tree.save(treeName);
+
+  VocabularyTree<DescriptorFloat> mappedTree(treeName);
+  BOOST_CHECK(mappedTree.isMapped());
+  BOOST_CHECK(mappedTree == tree);
+
+  MutableVocabularyTree<DescriptorFloat> loadedTree;
+  loadedTree.load(treeName);
+  BOOST_CHECK(!loadedTree.isMapped());
+  BOOST_CHECK(loadedTree == tree);
+
+  std::vector<DescriptorFloat> features(100);
+  for(DescriptorFloat& feature : features)
+  {
+    for(std::size_t i = 0; i < feature.size(); ++i)
+      feature[i] = static_cast<float>(std::rand() % 256);
+  }
+  BOOST_CHECK(mappedTree.quantize(features) == tree.quantize(features));
+}
+
+BOOST_AUTO_TEST_CASE(database_saveLoad)
+{
+  const int cardDocuments = 20;
+  const int cardWords = 30;
+  const int cardFeatures = 25;
+  const std::string databaseName = "test.voctreedb";
+  const std::string weightsName = "test.weights";
+
+  std::srand(1234567);
+
+  SparseHistogramPerImage documents;
+  for(int i = 0; i < cardDocuments; ++i)
+  {
+    std::vector<Word> document(cardFeatures);
+    for(int j = 0; j < cardFeatures; ++j)
+      document[j] = std::rand() % cardWords;
+    computeSparseHistogram(document, documents[10 * i + 3]);
+  }
+
+  Database db(cardWords);
+  for(const auto& document : documents)
+    db.insert(document.first, document.second);
+  db.computeTfIdfWeights();
+  db.save(databaseName);
+  db.saveWeights(weightsName);
+
+  Database mappedDb;
+  mappedDb.load(databaseName);
+  BOOST_CHECK(mappedDb.isMapped());
+  BOOST_CHECK_EQUAL(mappedDb.size(), db.size());
+
+  const std::vector<std::string> distanceMethods = {"classic", "commonPoints", "strongCommonPoints", "inversedWeightedCommonPoints"};
+  for(const std::string& distanceMethod : distanceMethods)
+  {
+    std::map<std::size_t, DocMatches> matches;
+    std::map<std::size_t, DocMatches> mappedMatches;
+    db.find(documents, 5, matches, distanceMethod);
+    mappedDb.find(documents, 5, mappedMatches, distanceMethod);
+    BOOST_CHECK(matches == mappedMatches);
+  }
+
+  // the documents are decoded on demand
+  BOOST_CHECK(mappedDb.getSparseHistogramPerImage() == documents);
+
+  // mapped weights
+  Database weightsDb(cardWords);
+  weightsDb.loadWeights(weightsName);
+  BOOST_CHECK(weightsDb.isMapped());
+  for(const auto& document : documents)
+    weightsDb.insert(document.first, document.second);
+  {
+    std::map<std::size_t, DocMatches> matches;
+    std::map<std::size_t, DocMatches> weightsMatches;
+    db.find(documents, 5, matches, "inversedWeightedCommonPoints");
+    weightsDb.find(documents, 5, weightsMatches, "inversedWeightedCommonPoints");
+    BOOST_CHECK(matches == weightsMatches);
+  }
+
+  // inserting a document copies the mapped database in memory
+  std::vector<Word> document(cardFeatures);
+  for(int j = 0; j < cardFeatures; ++j)
+    document[j] = std::rand() % cardWords;
+  computeSparseHistogram(document, documents[1000]);
+  db.insert(1000, documents[1000]);
+  mappedDb.insert(1000, documents[1000]);
+  BOOST_CHECK(!mappedDb.isMapped());
+  BOOST_CHECK_EQUAL(mappedDb.size(), db.size());
+
+  DocMatches matches;
+  DocMatches mappedMatches;
+  db.find(documents[1000], 5, matches, "classic");
+  mappedDb.find(documents[1000], 5, mappedMatches, "classic");
+  BOOST_CHECK(matches == mappedMatches);
+}
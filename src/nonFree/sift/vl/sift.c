@@ -665,6 +665,10 @@ Gaussian window size is set to have standard deviation
 #include <math.h>
 #include <stdio.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 /** @internal @brief Use bilinear interpolation to compute orientations */
 #define VL_SIFT_BILINEAR_ORIENTATIONS 1
 
@@ -677,6 +681,21 @@ double expn_tab [EXPN_SZ+1] ; /**< ::fast_expn table      @internal */
 
 #define log2(x) (log(x)/VL_LOG_OF_2)
 
+/** @internal @brief Minimum octave size (pixels) to split the work across threads
+ **
+ ** Octaves are processed in parallel (column strips for the smoothing,
+ ** row bands for the DoG and the extrema search, levels for the
+ ** gradient). The partition does not depend on the number of threads,
+ ** so the results are identical whatever the number of threads.
+ **/
+#define VL_SIFT_PARALLEL_MIN_PIXELS (512 * 512)
+
+/** @internal @brief Width of the column strips used by the parallel smoothing */
+#define VL_SIFT_SMOOTH_STRIP 64
+
+/** @internal @brief Number of row bands per thread for the parallel extrema search */
+#define VL_SIFT_BANDS_PER_THREAD 4
+
 /** ------------------------------------------------------------------
  ** @internal
  ** @brief Fast @f$exp(-x)@f$ approximation
@@ -769,6 +788,46 @@ copy_and_upsample_rows
  ** @param sigma       smoothing.
  **/
 
+/** ------------------------------------------------------------------
+ ** @internal
+ ** @brief Convolve the columns of an image with the current Gaussian filter
+ ** @param self       SIFT filter.
+ ** @param dst        output image buffer (transposed).
+ ** @param dst_stride output image stride.
+ ** @param src        input image buffer.
+ ** @param src_width  input image width.
+ ** @param src_height input image height.
+ ** @param src_stride input image stride.
+ **
+ ** Columns are independent, so large images are split in vertical
+ ** strips convolved in parallel. The strips only depend on the image
+ ** width, not on the number of threads, so the result does not depend
+ ** on it either. It may however differ in the last bits from a single
+ ** ::vl_imconvcol_vf call on the whole image: the vectorized path
+ ** needs columns past the current group, so the last group of each
+ ** strip is convolved by the scalar code.
+ **/
+
+static void
+_vl_sift_imconvcol (VlSiftFilt const * self,
+                    vl_sift_pix * dst, vl_size dst_stride,
+                    vl_sift_pix const * src,
+                    vl_size src_width, vl_size src_height, vl_size src_stride)
+{
+  int const nstrips = (int)((src_width + VL_SIFT_SMOOTH_STRIP - 1) / VL_SIFT_SMOOTH_STRIP) ;
+  int strip ;
+
+#pragma omp parallel for schedule(static) if(src_width * src_height >= VL_SIFT_PARALLEL_MIN_PIXELS)
+  for (strip = 0 ; strip < nstrips ; ++strip) {
+    vl_size const x = (vl_size)strip * VL_SIFT_SMOOTH_STRIP ;
+    vl_imconvcol_vf (dst + x * dst_stride, dst_stride,
+                     src + x, VL_MIN(VL_SIFT_SMOOTH_STRIP, src_width - x), src_height, src_stride,
+                     self->gaussFilter,
+                     - (vl_index)self->gaussFilterWidth, self->gaussFilterWidth,
+                     1, VL_PAD_BY_CONTINUITY | VL_TRANSPOSE) ;
+  }
+}
+
 static void
 _vl_sift_smooth (VlSiftFilt * self,
                  vl_sift_pix * outputImage,
@@ -802,17 +861,11 @@ _vl_sift_smooth (VlSiftFilt * self,
     return ;
   }
 
-  vl_imconvcol_vf (tempImage, height,
-                   inputImage, width, height, width,
-                   self->gaussFilter,
-                   - self->gaussFilterWidth, self->gaussFilterWidth,
-                   1, VL_PAD_BY_CONTINUITY | VL_TRANSPOSE) ;
-
-  vl_imconvcol_vf (outputImage, width,
-                   tempImage, height, width, height,
-                   self->gaussFilter,
-                   - self->gaussFilterWidth, self->gaussFilterWidth,
-                   1, VL_PAD_BY_CONTINUITY | VL_TRANSPOSE) ;
+  _vl_sift_imconvcol (self, tempImage, height,
+                      inputImage, width, height, width) ;
+
+  _vl_sift_imconvcol (self, outputImage, width,
+                      tempImage, height, width, height) ;
 }
 
 /** ------------------------------------------------------------------
@@ -1139,394 +1192,519 @@ vl_sift_process_next_octave (VlSiftFilt *f)
 }
 
 /** ------------------------------------------------------------------
- ** @brief Detect keypoints
+ ** @internal
+ ** @brief Keypoint candidates found in a band of DoG rows
+ **/
+
+typedef struct _VlSiftCandidates
+{
+  VlSiftKeypoint* keys ; /**< candidates. */
+  int nkeys ;            /**< number of candidates. */
+  int keys_res ;         /**< size of the candidates buffer. */
+} VlSiftCandidates ;
+
+/** ------------------------------------------------------------------
+ ** @internal
+ ** @brief Find the local extrema of the DoG in a band of rows
  **
- ** The function detect keypoints in the current octave filling the
- ** internal keypoint buffer. Keypoints can be retrieved by
- ** ::vl_sift_get_keypoints().
+ ** @param f     SIFT filter.
+ ** @param begin first row of the band.
+ ** @param end   last row (excluded) of the band.
+ ** @param cands candidates (output).
  **
- ** @param f SIFT filter.
+ ** Rows are indexed over the inner levels of the current octave, i.e.
+ ** row @c r is the line @c 1+r%(h-2) of the level @c s_min+1+r/(h-2).
+ ** The candidates are appended in scan order.
  **/
 
-VL_EXPORT
-void
-vl_sift_detect (VlSiftFilt * f)
+static void
+_vl_sift_find_extrema (VlSiftFilt const * f, int begin, int end,
+                       VlSiftCandidates * cands)
 {
-  vl_sift_pix* dog   = f-> dog ;
   int          s_min = f-> s_min ;
-  int          s_max = f-> s_max ;
   int          w     = f-> octave_width ;
   int          h     = f-> octave_height ;
-  double       te    = f-> edge_thresh ;
   double       tp    = f-> peak_thresh ;
 
   int const    xo    = 1 ;      /* x-stride */
   int const    yo    = w ;      /* y-stride */
   int const    so    = w * h ;  /* s-stride */
 
-  double       xper  = pow (2.0, f->o_cur) ;
-
-  int x, y, s, i, ii, jj ;
+  int r, x ;
   vl_sift_pix *pt, v ;
   VlSiftKeypoint *k ;
 
-  /* clear current list */
-  f-> nkeys = 0 ;
-
-  /* compute difference of gaussian (DoG) */
-  pt = f-> dog ;
-  for (s = s_min ; s <= s_max - 1 ; ++s) {
-    vl_sift_pix* src_a = vl_sift_get_octave (f, s    ) ;
-    vl_sift_pix* src_b = vl_sift_get_octave (f, s + 1) ;
-    vl_sift_pix* end_a = src_a + w * h ;
-    while (src_a != end_a) {
-      *pt++ = *src_b++ - *src_a++ ;
-    }
-  }
-
-  /* -----------------------------------------------------------------
-   *                                          Find local maxima of DoG
-   * -------------------------------------------------------------- */
+  for (r = begin ; r < end ; ++r) {
+    int const s = s_min + 1 + r / (h - 2) ;
+    int const y = 1 + r % (h - 2) ;
 
-  /* start from dog [1,1,s_min+1] */
-  pt  = dog + xo + yo + so ;
+    /* start from dog [1,y,s] */
+    pt = f->dog + xo + yo * y + so * (s - s_min) ;
 
-  for(s = s_min + 1 ; s <= s_max - 2 ; ++s) {
-    for(y = 1 ; y < h - 1 ; ++y) {
-      for(x = 1 ; x < w - 1 ; ++x) {
-        v = *pt ;
+    for(x = 1 ; x < w - 1 ; ++x) {
+      v = *pt ;
 
 #define CHECK_NEIGHBORS(CMP,SGN)                    \
-        ( v CMP ## = SGN 0.8 * tp &&                \
-          v CMP *(pt + xo) &&                       \
-          v CMP *(pt - xo) &&                       \
-          v CMP *(pt + so) &&                       \
-          v CMP *(pt - so) &&                       \
-          v CMP *(pt + yo) &&                       \
-          v CMP *(pt - yo) &&                       \
+      ( v CMP ## = SGN 0.8 * tp &&                  \
+        v CMP *(pt + xo) &&                         \
+        v CMP *(pt - xo) &&                         \
+        v CMP *(pt + so) &&                         \
+        v CMP *(pt - so) &&                         \
+        v CMP *(pt + yo) &&                         \
+        v CMP *(pt - yo) &&                         \
                                                     \
-          v CMP *(pt + yo + xo) &&                  \
-          v CMP *(pt + yo - xo) &&                  \
-          v CMP *(pt - yo + xo) &&                  \
-          v CMP *(pt - yo - xo) &&                  \
+        v CMP *(pt + yo + xo) &&                    \
+        v CMP *(pt + yo - xo) &&                    \
+        v CMP *(pt - yo + xo) &&                    \
+        v CMP *(pt - yo - xo) &&                    \
                                                     \
-          v CMP *(pt + xo      + so) &&             \
-          v CMP *(pt - xo      + so) &&             \
-          v CMP *(pt + yo      + so) &&             \
-          v CMP *(pt - yo      + so) &&             \
-          v CMP *(pt + yo + xo + so) &&             \
-          v CMP *(pt + yo - xo + so) &&             \
-          v CMP *(pt - yo + xo + so) &&             \
-          v CMP *(pt - yo - xo + so) &&             \
+        v CMP *(pt + xo      + so) &&               \
+        v CMP *(pt - xo      + so) &&               \
+        v CMP *(pt + yo      + so) &&               \
+        v CMP *(pt - yo      + so) &&               \
+        v CMP *(pt + yo + xo + so) &&               \
+        v CMP *(pt + yo - xo + so) &&               \
+        v CMP *(pt - yo + xo + so) &&               \
+        v CMP *(pt - yo - xo + so) &&               \
                                                     \
-          v CMP *(pt + xo      - so) &&             \
-          v CMP *(pt - xo      - so) &&             \
-          v CMP *(pt + yo      - so) &&             \
-          v CMP *(pt - yo      - so) &&             \
-          v CMP *(pt + yo + xo - so) &&             \
-          v CMP *(pt + yo - xo - so) &&             \
-          v CMP *(pt - yo + xo - so) &&             \
-          v CMP *(pt - yo - xo - so) )
-
-        if (CHECK_NEIGHBORS(>,+) ||
-            CHECK_NEIGHBORS(<,-) ) {
-
-          /* make room for more keypoints */
-          if (f->nkeys >= f->keys_res) {
-            f->keys_res += 500 ;
-            if (f->keys) {
-              f->keys = vl_realloc (f->keys,
-                                    f->keys_res *
-                                    sizeof(VlSiftKeypoint)) ;
-            } else {
-              f->keys = vl_malloc (f->keys_res *
-                                   sizeof(VlSiftKeypoint)) ;
-            }
+        v CMP *(pt + xo      - so) &&               \
+        v CMP *(pt - xo      - so) &&               \
+        v CMP *(pt + yo      - so) &&               \
+        v CMP *(pt - yo      - so) &&               \
+        v CMP *(pt + yo + xo - so) &&               \
+        v CMP *(pt + yo - xo - so) &&               \
+        v CMP *(pt - yo + xo - so) &&               \
+        v CMP *(pt - yo - xo - so) )
+
+      if (CHECK_NEIGHBORS(>,+) ||
+          CHECK_NEIGHBORS(<,-) ) {
+
+        /* make room for more keypoints */
+        if (cands->nkeys >= cands->keys_res) {
+          cands->keys_res += 500 ;
+          if (cands->keys) {
+            cands->keys = vl_realloc (cands->keys,
+                                      cands->keys_res *
+                                      sizeof(VlSiftKeypoint)) ;
+          } else {
+            cands->keys = vl_malloc (cands->keys_res *
+                                     sizeof(VlSiftKeypoint)) ;
           }
+        }
 
-          k = f->keys + (f->nkeys ++) ;
+        k = cands->keys + (cands->nkeys ++) ;
 
-          k-> ix = x ;
-          k-> iy = y ;
-          k-> is = s ;
-        }
-        pt += 1 ;
+        k-> ix = x ;
+        k-> iy = y ;
+        k-> is = s ;
       }
-      pt += 2 ;
+      pt += 1 ;
     }
-    pt += 2 * yo ;
   }
+}
 
-  /* -----------------------------------------------------------------
-   *                                               Refine local maxima
-   * -------------------------------------------------------------- */
+/** ------------------------------------------------------------------
+ ** @internal
+ ** @brief Refine the location of a keypoint candidate
+ **
+ ** @param f SIFT filter.
+ ** @param k keypoint candidate (input/output).
+ **
+ ** @return @c true if the refined keypoint passes the peak and edge
+ ** thresholds. In that case @a k is updated with the refined values.
+ **/
 
-  /* this pointer is used to write the keypoints back */
-  k = f->keys ;
+static vl_bool
+_vl_sift_refine_keypoint (VlSiftFilt const * f, VlSiftKeypoint * k)
+{
+  vl_sift_pix* dog   = f-> dog ;
+  int          s_min = f-> s_min ;
+  int          s_max = f-> s_max ;
+  int          w     = f-> octave_width ;
+  int          h     = f-> octave_height ;
+  double       te    = f-> edge_thresh ;
+  double       tp    = f-> peak_thresh ;
 
-  for (i = 0 ; i < f->nkeys ; ++i) {
+  int const    xo    = 1 ;      /* x-stride */
+  int const    yo    = w ;      /* y-stride */
+  int const    so    = w * h ;  /* s-stride */
+
+  double       xper  = pow (2.0, f->o_cur) ;
 
-    int x = f-> keys [i] .ix ;
-    int y = f-> keys [i] .iy ;
-    int s = f-> keys [i]. is ;
+  int x = k-> ix ;
+  int y = k-> iy ;
+  int s = k-> is ;
 
-    double Dx=0,Dy=0,Ds=0,Dxx=0,Dyy=0,Dss=0,Dxy=0,Dxs=0,Dys=0 ;
-    double A [3*3], b [3] ;
+  vl_sift_pix *pt ;
 
-    int dx = 0 ;
-    int dy = 0 ;
+  double Dx=0,Dy=0,Ds=0,Dxx=0,Dyy=0,Dss=0,Dxy=0,Dxs=0,Dys=0 ;
+  double A [3*3], b [3] ;
 
-    int iter, i, j ;
+  int dx = 0 ;
+  int dy = 0 ;
 
-    for (iter = 0 ; iter < 5 ; ++iter) {
+  int iter, i, j, ii, jj ;
 
-      x += dx ;
-      y += dy ;
+  for (iter = 0 ; iter < 5 ; ++iter) {
 
-      pt = dog
-        + xo * x
-        + yo * y
-        + so * (s - s_min) ;
+    x += dx ;
+    y += dy ;
 
-      /** @brief Index GSS @internal */
+    pt = dog
+      + xo * x
+      + yo * y
+      + so * (s - s_min) ;
+
+    /** @brief Index GSS @internal */
 #define at(dx,dy,ds) (*( pt + (dx)*xo + (dy)*yo + (ds)*so))
 
-      /** @brief Index matrix A @internal */
+    /** @brief Index matrix A @internal */
 #define Aat(i,j)     (A[(i)+(j)*3])
 
-      /* compute the gradient */
-      Dx = 0.5 * (at(+1,0,0) - at(-1,0,0)) ;
-      Dy = 0.5 * (at(0,+1,0) - at(0,-1,0));
-      Ds = 0.5 * (at(0,0,+1) - at(0,0,-1)) ;
-
-      /* compute the Hessian */
-      Dxx = (at(+1,0,0) + at(-1,0,0) - 2.0 * at(0,0,0)) ;
-      Dyy = (at(0,+1,0) + at(0,-1,0) - 2.0 * at(0,0,0)) ;
-      Dss = (at(0,0,+1) + at(0,0,-1) - 2.0 * at(0,0,0)) ;
-
-      Dxy = 0.25 * ( at(+1,+1,0) + at(-1,-1,0) - at(-1,+1,0) - at(+1,-1,0) ) ;
-      Dxs = 0.25 * ( at(+1,0,+1) + at(-1,0,-1) - at(-1,0,+1) - at(+1,0,-1) ) ;
-      Dys = 0.25 * ( at(0,+1,+1) + at(0,-1,-1) - at(0,-1,+1) - at(0,+1,-1) ) ;
-
-      /* solve linear system ....................................... */
-      Aat(0,0) = Dxx ;
-      Aat(1,1) = Dyy ;
-      Aat(2,2) = Dss ;
-      Aat(0,1) = Aat(1,0) = Dxy ;
-      Aat(0,2) = Aat(2,0) = Dxs ;
-      Aat(1,2) = Aat(2,1) = Dys ;
-
-      b[0] = - Dx ;
-      b[1] = - Dy ;
-      b[2] = - Ds ;
-
-      /* Gauss elimination */
-      for(j = 0 ; j < 3 ; ++j) {
-        double maxa    = 0 ;
-        double maxabsa = 0 ;
-        int    maxi    = -1 ;
-        double tmp ;
-
-        /* look for the maximally stable pivot */
-        for (i = j ; i < 3 ; ++i) {
-          double a    = Aat (i,j) ;
-          double absa = vl_abs_d (a) ;
-          if (absa > maxabsa) {
-            maxa    = a ;
-            maxabsa = absa ;
-            maxi    = i ;
-          }
+    /* compute the gradient */
+    Dx = 0.5 * (at(+1,0,0) - at(-1,0,0)) ;
+    Dy = 0.5 * (at(0,+1,0) - at(0,-1,0));
+    Ds = 0.5 * (at(0,0,+1) - at(0,0,-1)) ;
+
+    /* compute the Hessian */
+    Dxx = (at(+1,0,0) + at(-1,0,0) - 2.0 * at(0,0,0)) ;
+    Dyy = (at(0,+1,0) + at(0,-1,0) - 2.0 * at(0,0,0)) ;
+    Dss = (at(0,0,+1) + at(0,0,-1) - 2.0 * at(0,0,0)) ;
+
+    Dxy = 0.25 * ( at(+1,+1,0) + at(-1,-1,0) - at(-1,+1,0) - at(+1,-1,0) ) ;
+    Dxs = 0.25 * ( at(+1,0,+1) + at(-1,0,-1) - at(-1,0,+1) - at(+1,0,-1) ) ;
+    Dys = 0.25 * ( at(0,+1,+1) + at(0,-1,-1) - at(0,-1,+1) - at(0,+1,-1) ) ;
+
+    /* solve linear system ....................................... */
+    Aat(0,0) = Dxx ;
+    Aat(1,1) = Dyy ;
+    Aat(2,2) = Dss ;
+    Aat(0,1) = Aat(1,0) = Dxy ;
+    Aat(0,2) = Aat(2,0) = Dxs ;
+    Aat(1,2) = Aat(2,1) = Dys ;
+
+    b[0] = - Dx ;
+    b[1] = - Dy ;
+    b[2] = - Ds ;
+
+    /* Gauss elimination */
+    for(j = 0 ; j < 3 ; ++j) {
+      double maxa    = 0 ;
+      double maxabsa = 0 ;
+      int    maxi    = -1 ;
+      double tmp ;
+
+      /* look for the maximally stable pivot */
+      for (i = j ; i < 3 ; ++i) {
+        double a    = Aat (i,j) ;
+        double absa = vl_abs_d (a) ;
+        if (absa > maxabsa) {
+          maxa    = a ;
+          maxabsa = absa ;
+          maxi    = i ;
         }
+      }
 
-        /* if singular give up */
-        if (maxabsa < 1e-10f) {
-          b[0] = 0 ;
-          b[1] = 0 ;
-          b[2] = 0 ;
-          break ;
-        }
+      /* if singular give up */
+      if (maxabsa < 1e-10f) {
+        b[0] = 0 ;
+        b[1] = 0 ;
+        b[2] = 0 ;
+        break ;
+      }
 
-        i = maxi ;
+      i = maxi ;
 
-        /* swap j-th row with i-th row and normalize j-th row */
-        for(jj = j ; jj < 3 ; ++jj) {
-          tmp = Aat(i,jj) ; Aat(i,jj) = Aat(j,jj) ; Aat(j,jj) = tmp ;
-          Aat(j,jj) /= maxa ;
-        }
-        tmp = b[j] ; b[j] = b[i] ; b[i] = tmp ;
-        b[j] /= maxa ;
-
-        /* elimination */
-        for (ii = j+1 ; ii < 3 ; ++ii) {
-          double x = Aat(ii,j) ;
-          for (jj = j ; jj < 3 ; ++jj) {
-            Aat(ii,jj) -= x * Aat(j,jj) ;
-          }
-          b[ii] -= x * b[j] ;
+      /* swap j-th row with i-th row and normalize j-th row */
+      for(jj = j ; jj < 3 ; ++jj) {
+        tmp = Aat(i,jj) ; Aat(i,jj) = Aat(j,jj) ; Aat(j,jj) = tmp ;
+        Aat(j,jj) /= maxa ;
+      }
+      tmp = b[j] ; b[j] = b[i] ; b[i] = tmp ;
+      b[j] /= maxa ;
+
+      /* elimination */
+      for (ii = j+1 ; ii < 3 ; ++ii) {
+        double x = Aat(ii,j) ;
+        for (jj = j ; jj < 3 ; ++jj) {
+          Aat(ii,jj) -= x * Aat(j,jj) ;
         }
+        b[ii] -= x * b[j] ;
       }
+    }
 
-      /* backward substitution */
-      for (i = 2 ; i > 0 ; --i) {
-        double x = b[i] ;
-        for (ii = i-1 ; ii >= 0 ; --ii) {
-          b[ii] -= x * Aat(ii,i) ;
-        }
+    /* backward substitution */
+    for (i = 2 ; i > 0 ; --i) {
+      double x = b[i] ;
+      for (ii = i-1 ; ii >= 0 ; --ii) {
+        b[ii] -= x * Aat(ii,i) ;
       }
+    }
+
+    /* .......................................................... */
+    /* If the translation of the keypoint is big, move the keypoint
+     * and re-iterate the computation. Otherwise we are all set.
+     */
+
+    dx= ((b[0] >  0.6 && x < w - 2) ?  1 : 0)
+      + ((b[0] < -0.6 && x > 1    ) ? -1 : 0) ;
+
+    dy= ((b[1] >  0.6 && y < h - 2) ?  1 : 0)
+      + ((b[1] < -0.6 && y > 1    ) ? -1 : 0) ;
+
+    if (dx == 0 && dy == 0) break ;
+  }
+
+  /* check threshold and other conditions */
+  {
+    double val   = at(0,0,0)
+      + 0.5 * (Dx * b[0] + Dy * b[1] + Ds * b[2]) ;
+    double score = (Dxx+Dyy)*(Dxx+Dyy) / (Dxx*Dyy - Dxy*Dxy) ;
+    double xn = x + b[0] ;
+    double yn = y + b[1] ;
+    double sn = s + b[2] ;
+
+    vl_bool good =
+      vl_abs_d (val)  > tp                  &&
+      score           < (te+1)*(te+1)/te    &&
+      score           >= 0                  &&
+      vl_abs_d (b[0]) <  1.5                &&
+      vl_abs_d (b[1]) <  1.5                &&
+      vl_abs_d (b[2]) <  1.5                &&
+      xn              >= 0                  &&
+      xn              <= w - 1              &&
+      yn              >= 0                  &&
+      yn              <= h - 1              &&
+      sn              >= s_min              &&
+      sn              <= s_max ;
+
+    if (good) {
+      k-> o     = f->o_cur ;
+      k-> ix    = x ;
+      k-> iy    = y ;
+      k-> is    = s ;
+      k-> s     = sn ;
+      k-> x     = xn * xper ;
+      k-> y     = yn * xper ;
+      k-> sigma = f->sigma0 * pow (2.0, sn/f->S) * xper ;
+      k-> peak_value = vl_abs_d(val);
+    }
+
+    return good ;
+  }
+}
+
+/** ------------------------------------------------------------------
+ ** @brief Detect keypoints
+ **
+ ** The function detect keypoints in the current octave filling the
+ ** internal keypoint buffer. Keypoints can be retrieved by
+ ** ::vl_sift_get_keypoints().
+ **
+ ** On large octaves, the DoG, the extrema search and the refinement
+ ** are computed in parallel. Keypoints are returned in the same order
+ ** as the sequential scan.
+ **
+ ** @param f SIFT filter.
+ **/
+
+VL_EXPORT
+void
+vl_sift_detect (VlSiftFilt * f)
+{
+  int          s_min = f-> s_min ;
+  int          s_max = f-> s_max ;
+  int          w     = f-> octave_width ;
+  int          h     = f-> octave_height ;
+
+  vl_bool const parallel = (w * h >= VL_SIFT_PARALLEL_MIN_PIXELS) ;
+
+  int const    nrows = (s_max - s_min - 2) * (h - 2) ;
+  int          nbands = 1 ;
+  int          i, band ;
+  VlSiftCandidates * bands ;
+  char * good ;
+
+  /* clear current list */
+  f-> nkeys = 0 ;
 
-      /* .......................................................... */
-      /* If the translation of the keypoint is big, move the keypoint
-       * and re-iterate the computation. Otherwise we are all set.
-       */
+  /* compute difference of gaussian (DoG) */
+#pragma omp parallel for schedule(static) if(parallel)
+  for (i = 0 ; i < (s_max - s_min) * h ; ++i) {
+    int const s = s_min + i / h ;
+    int const y = i % h ;
+    vl_sift_pix const* src_a = vl_sift_get_octave (f, s    ) + y * w ;
+    vl_sift_pix const* src_b = vl_sift_get_octave (f, s + 1) + y * w ;
+    vl_sift_pix const* end_a = src_a + w ;
+    vl_sift_pix* pt = f-> dog + (vl_size)i * w ;
+    while (src_a != end_a) {
+      *pt++ = *src_b++ - *src_a++ ;
+    }
+  }
 
-      dx= ((b[0] >  0.6 && x < w - 2) ?  1 : 0)
-        + ((b[0] < -0.6 && x > 1    ) ? -1 : 0) ;
+  /* -----------------------------------------------------------------
+   *                                          Find local maxima of DoG
+   * -------------------------------------------------------------- */
+
+  if (nrows <= 0) return ;
+
+#ifdef _OPENMP
+  if (parallel) {
+    nbands = VL_MIN(omp_get_max_threads() * VL_SIFT_BANDS_PER_THREAD, nrows) ;
+  }
+#endif
 
-      dy= ((b[1] >  0.6 && y < h - 2) ?  1 : 0)
-        + ((b[1] < -0.6 && y > 1    ) ? -1 : 0) ;
+  bands = vl_calloc (nbands, sizeof(VlSiftCandidates)) ;
 
-      if (dx == 0 && dy == 0) break ;
+#pragma omp parallel for schedule(dynamic) if(nbands > 1)
+  for (band = 0 ; band < nbands ; ++band) {
+    _vl_sift_find_extrema (f,
+                           (int)((vl_int64)nrows * band / nbands),
+                           (int)((vl_int64)nrows * (band + 1) / nbands),
+                           bands + band) ;
+  }
+
+  /* gather the candidates in scan order */
+  for (band = 0 ; band < nbands ; ++band) {
+    f->nkeys += bands[band].nkeys ;
+  }
+  if (f->nkeys > f->keys_res) {
+    f->keys_res = f->nkeys ;
+    if (f->keys) {
+      f->keys = vl_realloc (f->keys, f->keys_res * sizeof(VlSiftKeypoint)) ;
+    } else {
+      f->keys = vl_malloc (f->keys_res * sizeof(VlSiftKeypoint)) ;
+    }
+  }
+  {
+    VlSiftKeypoint* k = f->keys ;
+    for (band = 0 ; band < nbands ; ++band) {
+      if (bands[band].nkeys) {
+        memcpy (k, bands[band].keys, bands[band].nkeys * sizeof(VlSiftKeypoint)) ;
+        k += bands[band].nkeys ;
+      }
+      if (bands[band].keys) vl_free (bands[band].keys) ;
     }
+  }
+  vl_free (bands) ;
+
+  /* -----------------------------------------------------------------
+   *                                               Refine local maxima
+   * -------------------------------------------------------------- */
+
+  if (f->nkeys == 0) return ;
 
-    /* check threshold and other conditions */
-    {
-      double val   = at(0,0,0)
-        + 0.5 * (Dx * b[0] + Dy * b[1] + Ds * b[2]) ;
-      double score = (Dxx+Dyy)*(Dxx+Dyy) / (Dxx*Dyy - Dxy*Dxy) ;
-      double xn = x + b[0] ;
-      double yn = y + b[1] ;
-      double sn = s + b[2] ;
-
-      vl_bool good =
-        vl_abs_d (val)  > tp                  &&
-        score           < (te+1)*(te+1)/te    &&
-        score           >= 0                  &&
-        vl_abs_d (b[0]) <  1.5                &&
-        vl_abs_d (b[1]) <  1.5                &&
-        vl_abs_d (b[2]) <  1.5                &&
-        xn              >= 0                  &&
-        xn              <= w - 1              &&
-        yn              >= 0                  &&
-        yn              <= h - 1              &&
-        sn              >= s_min              &&
-        sn              <= s_max ;
-
-      if (good) {
-        k-> o     = f->o_cur ;
-        k-> ix    = x ;
-        k-> iy    = y ;
-        k-> is    = s ;
-        k-> s     = sn ;
-        k-> x     = xn * xper ;
-        k-> y     = yn * xper ;
-        k-> sigma = f->sigma0 * pow (2.0, sn/f->S) * xper ;
-        k-> peak_value = vl_abs_d(val);
-        ++ k ;
+  good = vl_malloc (f->nkeys * sizeof(char)) ;
+
+#pragma omp parallel for schedule(static) if(parallel)
+  for (i = 0 ; i < f->nkeys ; ++i) {
+    good [i] = (char) _vl_sift_refine_keypoint (f, f->keys + i) ;
+  }
+
+  /* keep the good keypoints, preserving their order */
+  {
+    VlSiftKeypoint* k = f->keys ;
+    for (i = 0 ; i < f->nkeys ; ++i) {
+      if (good [i]) {
+        *k++ = f->keys [i] ;
       }
+    }
 
-    } /* done checking */
-  } /* next keypoint to refine */
+    /* update keypoint count */
+    f-> nkeys = (int)(k - f->keys) ;
+  }
 
-  /* update keypoint count */
-  f-> nkeys = (int)(k - f->keys) ;
+  vl_free (good) ;
 }
 
 
 /** ------------------------------------------------------------------
- ** @brief Update gradients to current GSS octave
+ ** @internal
+ ** @brief Compute the gradient of a row of a GSS level
  **
  ** @param f SIFT filter.
+ ** @param s level.
+ ** @param y row.
  **
- ** The function makes sure that the gradient buffer is up-to-date
- ** with the current GSS data.
- **
- ** @remark The minimum octave size is 2x2xS.
+ ** Central differences are used inside the image, forward and
+ ** backward differences on the borders.
  **/
 
-void
-vl_sift_update_gradient (VlSiftFilt *f)
+static void
+_vl_sift_update_gradient_row (VlSiftFilt *f, int s, int y)
 {
   int       s_min = f->s_min ;
-  int       s_max = f->s_max ;
   int       w     = vl_sift_get_octave_width  (f) ;
   int       h     = vl_sift_get_octave_height (f) ;
   int const xo    = 1 ;
   int const yo    = w ;
   int const so    = h * w ;
-  int y, s ;
-
-  if (f->grad_o == f->o_cur) return ;
-
-  for (s  = s_min + 1 ;
-       s <= s_max - 2 ; ++ s) {
 
-    vl_sift_pix *src, *end, *grad, gx, gy ;
+  vl_sift_pix const *src, *end ;
+  vl_sift_pix *grad, gx, gy ;
 
 #define SAVE_BACK                                                       \
-    *grad++ = vl_fast_sqrt_f (gx*gx + gy*gy) ;                          \
-    *grad++ = vl_mod_2pi_f   (vl_fast_atan2_f (gy, gx) + 2*VL_PI) ;     \
-    ++src ;                                                             \
-
-    src  = vl_sift_get_octave (f,s) ;
-    grad = f->grad + 2 * so * (s - s_min -1) ;
-
-    /* first pixel of the first row */
-    gx = src[+xo] - src[0] ;
-    gy = src[+yo] - src[0] ;
-    SAVE_BACK ;
-
-    /* middle pixels of the  first row */
-    end = (src - 1) + w - 1 ;
-    while (src < end) {
-      gx = 0.5 * (src[+xo] - src[-xo]) ;
-      gy =        src[+yo] - src[0] ;
-      SAVE_BACK ;
-    }
-
-    /* last pixel of the first row */
-    gx = src[0]   - src[-xo] ;
-    gy = src[+yo] - src[0] ;
+  *grad++ = vl_fast_sqrt_f (gx*gx + gy*gy) ;                            \
+  *grad++ = vl_mod_2pi_f   (vl_fast_atan2_f (gy, gx) + 2*VL_PI) ;       \
+  ++src ;                                                               \
+
+#define GRAD_Y                                                          \
+  ((y == 0)     ? (src[+yo] - src[0]) :                                 \
+   (y == h - 1) ? (src[0]   - src[-yo]) :                               \
+                  0.5 * (src[+yo] - src[-yo]))
+
+  src  = vl_sift_get_octave (f,s) + yo * y ;
+  grad = f->grad + 2 * so * (s - s_min -1) + 2 * yo * y ;
+
+  /* first pixel of the row */
+  gx = src[+xo] - src[0] ;
+  gy = GRAD_Y ;
+  SAVE_BACK ;
+
+  /* middle pixels of the row */
+  end = (src - 1) + w - 1 ;
+  while (src < end) {
+    gx = 0.5 * (src[+xo] - src[-xo]) ;
+    gy = GRAD_Y ;
     SAVE_BACK ;
+  }
 
-    for (y = 1 ; y < h -1 ; ++y) {
-
-      /* first pixel of the middle rows */
-      gx =        src[+xo] - src[0] ;
-      gy = 0.5 * (src[+yo] - src[-yo]) ;
-      SAVE_BACK ;
+  /* last pixel of the row */
+  gx = src[0] - src[-xo] ;
+  gy = GRAD_Y ;
+  SAVE_BACK ;
 
-      /* middle pixels of the middle rows */
-      end = (src - 1) + w - 1 ;
-      while (src < end) {
-        gx = 0.5 * (src[+xo] - src[-xo]) ;
-        gy = 0.5 * (src[+yo] - src[-yo]) ;
-        SAVE_BACK ;
-      }
+#undef GRAD_Y
+}
 
-      /* last pixel of the middle row */
-      gx =        src[0]   - src[-xo] ;
-      gy = 0.5 * (src[+yo] - src[-yo]) ;
-      SAVE_BACK ;
-    }
+/** ------------------------------------------------------------------
+ ** @brief Update gradients to current GSS octave
+ **
+ ** @param f SIFT filter.
+ **
+ ** The function makes sure that the gradient buffer is up-to-date
+ ** with the current GSS data. Rows are processed in parallel on large
+ ** octaves.
+ **
+ ** @remark The minimum octave size is 2x2xS.
+ **/
 
-    /* first pixel of the last row */
-    gx = src[+xo] - src[0] ;
-    gy = src[  0] - src[-yo] ;
-    SAVE_BACK ;
+void
+vl_sift_update_gradient (VlSiftFilt *f)
+{
+  int       s_min = f->s_min ;
+  int       s_max = f->s_max ;
+  int       w     = vl_sift_get_octave_width  (f) ;
+  int       h     = vl_sift_get_octave_height (f) ;
+  int       i ;
 
-    /* middle pixels of the last row */
-    end = (src - 1) + w - 1 ;
-    while (src < end) {
-      gx = 0.5 * (src[+xo] - src[-xo]) ;
-      gy =        src[0]   - src[-yo] ;
-      SAVE_BACK ;
-    }
+  if (f->grad_o == f->o_cur) return ;
 
-    /* last pixel of the last row */
-    gx = src[0]   - src[-xo] ;
-    gy = src[0]   - src[-yo] ;
-    SAVE_BACK ;
+#pragma omp parallel for schedule(static) if(w * h >= VL_SIFT_PARALLEL_MIN_PIXELS)
+  for (i = 0 ; i < (s_max - s_min - 2) * h ; ++i) {
+    _vl_sift_update_gradient_row (f, s_min + 1 + i / h, i % h) ;
   }
+
   f->grad_o = f->o_cur ;
 }
 
@@ -0,0 +1,266 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/multiview/relativePose/Fundamental7PSolver.hpp>
+#include <aliceVision/multiview/relativePose/FundamentalError.hpp>
+#include <aliceVision/multiview/RelativePoseKernel.hpp>
+#include <aliceVision/multiview/Unnormalizer.hpp>
+#include <aliceVision/robustEstimation/ACRansac.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+using KernelT = multiview::RelativePoseKernel<multiview::relativePose::Fundamental7PSolver,
+                                              multiview::relativePose::FundamentalEpipolarDistanceError,
+                                              multiview::UnnormalizerT,
+                                              robustEstimation::Mat3Model>;
+
+/**
+ * @brief Load a recorded match set
+ * @param[in] filepath Text file with one match "x1 y1 x2 y2" per line
+ * @param[out] x1 Points of the first image
+ * @param[out] x2 Points of the second image
+ * @return true if at least one match has been read
+ */
+bool loadMatches(const std::string& filepath, Mat& x1, Mat& x2)
+{
+  std::ifstream file(filepath);
+  std::vector<double> values;
+  double value;
+  while(file >> value)
+    values.push_back(value);
+
+  const std::size_t nbMatches = values.size() / 4;
+  x1.resize(2, nbMatches);
+  x2.resize(2, nbMatches);
+  for(std::size_t i = 0; i < nbMatches; ++i)
+  {
+    x1.col(i) << values[4 * i], values[4 * i + 1];
+    x2.col(i) << values[4 * i + 2], values[4 * i + 3];
+  }
+  return nbMatches > 0;
+}
+
+/**
+ * @brief Generate a match set of two views of random 3D points, with outliers
+ */
+void generateMatches(std::size_t nbMatches, double outlierRatio, int width, int height,
+                     std::mt19937& generator, Mat& x1, Mat& x2)
+{
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  std::normal_distribution<double> noise(0.0, 0.5);
+  const double focal = 1.2 * width;
+
+  x1.resize(2, nbMatches);
+  x2.resize(2, nbMatches);
+  for(std::size_t i = 0; i < nbMatches; ++i)
+  {
+    x1.col(i) << u(generator) * width, u(generator) * height;
+    if(u(generator) < outlierRatio)
+    {
+      x2.col(i) << u(generator) * width, u(generator) * height;
+      continue;
+    }
+    // back-project at a random depth, then project in a camera translated along x
+    const double depth = 5.0 + 10.0 * u(generator);
+    const Vec3 X((x1(0, i) - width / 2.0) / focal * depth, (x1(1, i) - height / 2.0) / focal * depth, depth);
+    const Vec3 Xc2 = X - Vec3(1.0, 0.0, 0.0);
+    x2.col(i) << focal * Xc2(0) / Xc2(2) + width / 2.0 + noise(generator),
+                 focal * Xc2(1) / Xc2(2) + height / 2.0 + noise(generator);
+  }
+}
+
+/**
+ * @brief Evaluate the NFA of the same models with the sorted residuals and with the residual histogram
+ * @return the number of models for which both evaluations disagree
+ */
+std::size_t benchmarkNFA(const KernelT& kernel, std::size_t nbModels, double precision, std::mt19937& generator)
+{
+  using namespace robustEstimation;
+
+  const std::size_t sizeSample = kernel.getMinimumNbRequiredSamples();
+  const std::size_t nData = kernel.nbSamples();
+  const double maxThreshold = precision * kernel.normalizer2()(0, 0) * kernel.normalizer2()(0, 0);
+  const double loge0 = log10((double)kernel.getMaximumNbModels() * (nData - sizeSample));
+  std::vector<float> logc_n, logc_k;
+  makelogcombi(sizeSample, nData, logc_k, logc_n);
+
+  // hypothesize the models
+  std::vector<Mat3Model> models;
+  std::vector<std::size_t> sample;
+  std::vector<Mat3Model> sampleModels;
+  while(models.size() < nbModels)
+  {
+    uniformSample(generator, sizeSample, nData, sample);
+    sampleModels.clear();
+    kernel.fit(sample, sampleModels);
+    models.insert(models.end(), sampleModels.begin(), sampleModels.end());
+  }
+
+  std::vector<std::vector<double>> allResiduals(models.size());
+  for(std::size_t m = 0; m < models.size(); ++m)
+    kernel.errors(models[m], allResiduals[m]);
+
+  // sort all the residuals of each model
+  std::vector<ErrorIndex> sorted(nData);
+  std::vector<ErrorIndex> sortedBest(models.size());
+  std::vector<std::size_t> inliers;
+  double minNFA = std::numeric_limits<double>::infinity();
+  const system::Timer sortTimer;
+  for(std::size_t m = 0; m < models.size(); ++m)
+  {
+    for(std::size_t i = 0; i < nData; ++i)
+      sorted[i] = ErrorIndex(allResiduals[m][i], i);
+    std::sort(sorted.begin(), sorted.end());
+    const ErrorIndex best = bestNFA(sizeSample, kernel.logalpha0(), sorted, loge0, maxThreshold, logc_n, logc_k, kernel.multError());
+    sortedBest[m] = (best.first < minNFA) ? best : ErrorIndex(std::numeric_limits<double>::infinity(), sizeSample);
+    if(best.first < minNFA)
+    {
+      minNFA = best.first;
+      inliers.resize(best.second);
+      for(std::size_t i = 0; i < best.second; ++i)
+        inliers[i] = sorted[i].second;
+    }
+  }
+  const double sortElapsed = sortTimer.elapsed();
+
+  // residual histogram, only evaluated where the model can beat the best NFA
+  NFAHistogram histogram(nData);
+  std::size_t nbDifferences = 0;
+  minNFA = std::numeric_limits<double>::infinity();
+  const system::Timer histogramTimer;
+  for(std::size_t m = 0; m < models.size(); ++m)
+  {
+    const ErrorIndex best = histogram.bestNFA(sizeSample, kernel.logalpha0(), allResiduals[m], loge0, maxThreshold, logc_n, logc_k, kernel.multError(), minNFA);
+    if(best.first < minNFA)
+    {
+      minNFA = best.first;
+      histogram.getInliers(best.second, inliers);
+    }
+    nbDifferences += (best != sortedBest[m]);
+  }
+  const double histogramElapsed = histogramTimer.elapsed();
+
+  ALICEVISION_COUT("  NFA of " << models.size() << " models: sorted residuals " << std::fixed << std::setprecision(3)
+                   << 1000.0 * sortElapsed << " ms, residual histogram " << 1000.0 * histogramElapsed << " ms"
+                   << " (x" << std::setprecision(2) << sortElapsed / histogramElapsed << ")");
+  return nbDifferences;
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<std::string> matchesFilepaths;
+  int width = 4000;
+  int height = 3000;
+  int nbMatches = 20000;
+  double outlierRatio = 0.5;
+  int nbModels = 1000;
+  int nbIterations = 1024;
+  double precision = std::numeric_limits<double>::infinity();
+
+  po::options_description allParams("AliceVision Sample benchmarkACRansac\n"
+                                    "Measure the NFA evaluation of ACRANSAC on match sets, with a fundamental matrix kernel.");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("matches,m", po::value<std::vector<std::string>>(&matchesFilepaths)->multitoken(),
+      "Recorded match sets: text files with one match 'x1 y1 x2 y2' per line. If empty, a random match set is generated.")
+    ("width", po::value<int>(&width)->default_value(width),
+      "Width of the images.")
+    ("height", po::value<int>(&height)->default_value(height),
+      "Height of the images.")
+    ("nbMatches", po::value<int>(&nbMatches)->default_value(nbMatches),
+      "Number of matches of the random match set.")
+    ("outlierRatio", po::value<double>(&outlierRatio)->default_value(outlierRatio),
+      "Ratio of outliers of the random match set.")
+    ("nbModels", po::value<int>(&nbModels)->default_value(nbModels),
+      "Number of models evaluated by the NFA benchmark.")
+    ("nbIterations", po::value<int>(&nbIterations)->default_value(nbIterations),
+      "Number of iterations of ACRANSAC.")
+    ("precision", po::value<double>(&precision)->default_value(precision),
+      "Upper bound of the precision (squared error in pixels).");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(width <= 0 || height <= 0 || nbMatches <= 7 || nbModels <= 0 || nbIterations <= 0)
+  {
+    ALICEVISION_CERR("ERROR: Invalid image size, number of matches, models or iterations.");
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 generator(1234567);
+
+  if(matchesFilepaths.empty())
+    matchesFilepaths.emplace_back();
+
+  std::size_t nbDifferences = 0;
+  for(const std::string& filepath : matchesFilepaths)
+  {
+    Mat x1, x2;
+    if(filepath.empty())
+    {
+      generateMatches(nbMatches, outlierRatio, width, height, generator, x1, x2);
+      ALICEVISION_COUT("Random match set: " << x1.cols() << " matches, " << outlierRatio << " outlier ratio");
+    }
+    else
+    {
+      if(!loadMatches(filepath, x1, x2) || x1.cols() <= 7)
+      {
+        ALICEVISION_CERR("ERROR: Cannot read enough matches from '" << filepath << "'.");
+        return EXIT_FAILURE;
+      }
+      ALICEVISION_COUT("Match set '" << filepath << "': " << x1.cols() << " matches");
+    }
+
+    const KernelT kernel(x1, width, height, x2, width, height, true);
+
+    nbDifferences += benchmarkNFA(kernel, nbModels, precision, generator);
+
+    std::vector<std::size_t> inliers;
+    robustEstimation::Mat3Model model;
+    const system::Timer timer;
+    const std::pair<double, double> ACRansacOut = robustEstimation::ACRANSAC(kernel, generator, inliers, nbIterations, &model, precision);
+    ALICEVISION_COUT("  ACRANSAC: " << inliers.size() << " inliers, NFA " << ACRansacOut.second
+                     << ", precision " << ACRansacOut.first << ", " << 1000.0 * timer.elapsed() << " ms");
+  }
+
+  ALICEVISION_COUT(std::endl << "Different NFA evaluations: " << nbDifferences);
+
+  return (nbDifferences == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
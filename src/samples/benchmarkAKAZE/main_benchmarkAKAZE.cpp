@@ -0,0 +1,183 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/all.hpp>
+#include <aliceVision/feature/akaze/AKAZE.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Run the AKAZE detection on the same frame several times
+ * @param[in] image Input frame
+ * @param[in] options AKAZE options
+ * @param[in] nbFrames Number of processed frames
+ * @param[in] reuseScaleSpace Keep the scale space memory alive between frames
+ * @param[out] timings Per-frame latency in milliseconds
+ */
+void runAKAZE(const image::Image<float>& image,
+              const AKAZEOptions& options,
+              int nbFrames,
+              bool reuseScaleSpace,
+              std::vector<double>& timings)
+{
+  AKAZE::TScaleSpace scaleSpace;
+  std::vector<AKAZEKeypoint> keypoints;
+
+  timings.clear();
+  timings.reserve(nbFrames);
+
+  for(int i = 0; i < nbFrames; ++i)
+  {
+    const system::Timer timer;
+
+    keypoints.clear();
+
+    if(reuseScaleSpace)
+    {
+      AKAZE akaze(image, options, scaleSpace);
+      akaze.computeScaleSpace();
+      akaze.featureDetection(keypoints);
+      akaze.gridFiltering(keypoints);
+    }
+    else
+    {
+      AKAZE akaze(image, options);
+      akaze.computeScaleSpace();
+      akaze.featureDetection(keypoints);
+      akaze.gridFiltering(keypoints);
+    }
+
+    timings.push_back(timer.elapsedMs());
+  }
+}
+
+/**
+ * @brief Print latency statistics
+ * @param[in] name Benchmark name
+ * @param[in] timings Per-frame latency in milliseconds (sorted in place)
+ */
+void printStats(const std::string& name, std::vector<double>& timings)
+{
+  std::sort(timings.begin(), timings.end());
+
+  double sum = 0.0;
+  for(double t : timings)
+    sum += t;
+
+  const auto percentile = [&timings](double p)
+  {
+    return timings.at(std::min(timings.size() - 1, static_cast<std::size_t>(p * timings.size())));
+  };
+
+  ALICEVISION_COUT(name << ":" << std::endl
+    << "\t- mean: " << sum / timings.size() << " ms" << std::endl
+    << "\t- median: " << percentile(0.5) << " ms" << std::endl
+    << "\t- p95: " << percentile(0.95) << " ms" << std::endl
+    << "\t- min: " << timings.front() << " ms, max: " << timings.back() << " ms");
+}
+
+int main(int argc, char **argv)
+{
+  std::string imageFilename;
+  int width = 1920;
+  int height = 1080;
+  int nbFrames = 50;
+  int nbWarmupFrames = 2;
+
+  po::options_description allParams("AliceVision Sample benchmarkAKAZE\n"
+                                    "Measure the per-frame AKAZE detection latency with and without scale space reuse.");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("input,i", po::value<std::string>(&imageFilename)->default_value(imageFilename),
+      "Input image (a synthetic image is used if empty).")
+    ("width", po::value<int>(&width)->default_value(width),
+      "Synthetic image width.")
+    ("height", po::value<int>(&height)->default_value(height),
+      "Synthetic image height.")
+    ("nbFrames,n", po::value<int>(&nbFrames)->default_value(nbFrames),
+      "Number of measured frames.")
+    ("nbWarmupFrames", po::value<int>(&nbWarmupFrames)->default_value(nbWarmupFrames),
+      "Number of frames processed before measuring.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(nbFrames <= 0)
+  {
+    ALICEVISION_CERR("ERROR: Invalid number of frames: " << nbFrames);
+    return EXIT_FAILURE;
+  }
+
+  image::Image<float> image;
+
+  if(imageFilename.empty())
+  {
+    // smoothed random blobs: enough structure to get a realistic number of keypoints
+    image::Image<float> noise(width / 8 + 1, height / 8 + 1);
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> distribution(0.f, 1.f);
+    for(int y = 0; y < noise.Height(); ++y)
+      for(int x = 0; x < noise.Width(); ++x)
+        noise(y, x) = distribution(generator);
+
+    image.resize(width, height);
+    for(int y = 0; y < height; ++y)
+      for(int x = 0; x < width; ++x)
+        image(y, x) = noise(y / 8, x / 8);
+  }
+  else
+  {
+    image::readImage(imageFilename, image, image::EImageColorSpace::SRGB);
+  }
+
+  ALICEVISION_COUT("Image size: " << image.Width() << "x" << image.Height() << ", " << nbFrames << " frames");
+
+  const AKAZEOptions options;
+  std::vector<double> timings;
+
+  runAKAZE(image, options, nbWarmupFrames, false, timings);
+  runAKAZE(image, options, nbFrames, false, timings);
+  printStats("Allocation per frame", timings);
+
+  runAKAZE(image, options, nbWarmupFrames, true, timings);
+  runAKAZE(image, options, nbFrames, true, timings);
+  printStats("Reused scale space", timings);
+
+  return EXIT_SUCCESS;
+}
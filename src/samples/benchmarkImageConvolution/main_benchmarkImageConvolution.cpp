@@ -0,0 +1,156 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/image/all.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <functional>
+#include <iomanip>
+#include <string>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::image;
+
+namespace po = boost::program_options;
+
+/**
+ * @brief Run a kernel several times and print its throughput
+ * @param[in] name Kernel name
+ * @param[in] nbPixels Number of input pixels processed by one call
+ * @param[in] nbRuns Number of measured calls
+ * @param[in] kernel Kernel to benchmark
+ */
+void benchmark(const std::string& name, std::size_t nbPixels, int nbRuns, const std::function<void()>& kernel)
+{
+  // warm up (allocations, first touch)
+  kernel();
+
+  const system::Timer timer;
+  for(int i = 0; i < nbRuns; ++i)
+    kernel();
+  const double elapsedSec = timer.elapsed();
+
+  const double megaPixelsPerSec = (static_cast<double>(nbPixels) * nbRuns) / (elapsedSec * 1e6);
+  ALICEVISION_COUT(std::left << std::setw(40) << name
+                   << std::right << std::setw(10) << std::fixed << std::setprecision(1) << megaPixelsPerSec << " MP/s"
+                   << std::setw(10) << std::setprecision(3) << 1000.0 * elapsedSec / nbRuns << " ms");
+}
+
+/**
+ * @brief Benchmark the convolution kernels on one pixel type
+ */
+template <typename T>
+void benchmarkConvolutions(const std::string& typeName, const Image<T>& image, double sigma, int nbRuns)
+{
+  const std::size_t nbPixels = static_cast<std::size_t>(image.Width()) * image.Height();
+  const Vec kernel = ComputeGaussianKernel(static_cast<std::size_t>(2 * std::ceil(4.0 * sigma) + 1), sigma);
+  Image<T> out;
+
+  benchmark("horizontal convolution (" + typeName + ")", nbPixels, nbRuns, [&]() {
+    ImageHorizontalConvolution(image, kernel, out);
+  });
+  benchmark("vertical convolution (" + typeName + ")", nbPixels, nbRuns, [&]() {
+    ImageVerticalConvolution(image, kernel, out);
+  });
+  benchmark("separable convolution (" + typeName + ")", nbPixels, nbRuns, [&]() {
+    ImageSeparableConvolution(image, kernel, kernel, out);
+  });
+  benchmark("half sample (" + typeName + ")", nbPixels, nbRuns, [&]() {
+    ImageHalfSample(image, out);
+  });
+  benchmark("downscale x3 (" + typeName + ")", nbPixels, nbRuns, [&]() {
+    downscaleImage<SamplerLinear>(image, out, 3);
+  });
+}
+
+int main(int argc, char **argv)
+{
+  int width = 4000;
+  int height = 3000;
+  double sigma = 1.6;
+  int nbRuns = 10;
+
+  po::options_description allParams("AliceVision Sample benchmarkImageConvolution\n"
+                                    "Measure the throughput of the image convolution and pyramid kernels.");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("width", po::value<int>(&width)->default_value(width),
+      "Image width.")
+    ("height", po::value<int>(&height)->default_value(height),
+      "Image height.")
+    ("sigma", po::value<double>(&sigma)->default_value(sigma),
+      "Gaussian kernel sigma.")
+    ("nbRuns,n", po::value<int>(&nbRuns)->default_value(nbRuns),
+      "Number of measured runs per kernel.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(width <= 0 || height <= 0 || nbRuns <= 0)
+  {
+    ALICEVISION_CERR("ERROR: Invalid image size or number of runs.");
+    return EXIT_FAILURE;
+  }
+
+  Image<float> imageFloat(width, height);
+  Image<RGBfColor> imageRGB(width, height);
+  Image<unsigned char> imageGray(width, height);
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const unsigned char value = static_cast<unsigned char>((x * 7 + y * 13) % 256);
+      imageFloat(y, x) = value / 255.f;
+      imageRGB(y, x) = RGBfColor(value / 255.f, 1.f - value / 255.f, 0.5f);
+      imageGray(y, x) = value;
+    }
+  }
+
+  ALICEVISION_COUT("Image size: " << width << "x" << height << ", sigma: " << sigma << ", " << nbRuns << " runs");
+
+  const bool hasSIMD = isConvolutionSIMDEnabled();
+  for(const bool simd : {false, true})
+  {
+    if(simd && !hasSIMD)
+    {
+      ALICEVISION_COUT("AVX2 is not supported by this CPU.");
+      break;
+    }
+
+    setConvolutionSIMD(simd);
+    ALICEVISION_COUT(std::endl << (simd ? "AVX2" : "Scalar") << " convolution kernels:");
+
+    benchmarkConvolutions("float", imageFloat, sigma, nbRuns);
+    benchmarkConvolutions("RGBf", imageRGB, sigma, nbRuns);
+    benchmarkConvolutions("uint8", imageGray, sigma, nbRuns);
+  }
+
+  return EXIT_SUCCESS;
+}
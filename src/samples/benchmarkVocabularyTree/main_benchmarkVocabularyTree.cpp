@@ -0,0 +1,153 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <string>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+typedef feature::Descriptor<float, 128> DescriptorFloat;
+typedef feature::Descriptor<unsigned char, 128> DescriptorUChar;
+
+/**
+ * @brief Run a quantization several times and print its throughput
+ * @param[in] name Quantization name
+ * @param[in] nbDescriptors Number of descriptors quantized by one call
+ * @param[in] nbRuns Number of measured calls
+ * @param[in] quantize Quantization to benchmark
+ */
+void benchmark(const std::string& name, std::size_t nbDescriptors, int nbRuns, const std::function<void()>& quantize)
+{
+  // warm up (allocations, first touch)
+  quantize();
+
+  const system::Timer timer;
+  for(int i = 0; i < nbRuns; ++i)
+    quantize();
+  const double elapsedSec = timer.elapsed();
+
+  const double descriptorsPerSec = (static_cast<double>(nbDescriptors) * nbRuns) / elapsedSec;
+  ALICEVISION_COUT(std::left << std::setw(40) << name
+                   << std::right << std::setw(12) << std::fixed << std::setprecision(0) << descriptorsPerSec << " desc/s"
+                   << std::setw(10) << std::setprecision(3) << 1000.0 * elapsedSec / nbRuns << " ms");
+}
+
+int main(int argc, char **argv)
+{
+  std::string treeFilepath;
+  int levels = 3;
+  int splits = 80;
+  int nbDescriptors = 40000;
+  int nbRuns = 5;
+
+  po::options_description allParams("AliceVision Sample benchmarkVocabularyTree\n"
+                                    "Measure the throughput of the vocabulary tree quantization.");
+  allParams.add_options()
+    ("help,h", "Print this message.")
+    ("tree,t", po::value<std::string>(&treeFilepath)->default_value(treeFilepath),
+      "Input vocabulary tree (SIFT float centers). If empty, a random tree is generated.")
+    ("levels", po::value<int>(&levels)->default_value(levels),
+      "Number of levels of the random tree.")
+    ("splits", po::value<int>(&splits)->default_value(splits),
+      "Branching factor of the random tree.")
+    ("nbDescriptors", po::value<int>(&nbDescriptors)->default_value(nbDescriptors),
+      "Number of random descriptors to quantize.")
+    ("nbRuns,n", po::value<int>(&nbRuns)->default_value(nbRuns),
+      "Number of measured runs.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  if(levels <= 0 || splits <= 1 || nbDescriptors <= 0 || nbRuns <= 0)
+  {
+    ALICEVISION_CERR("ERROR: Invalid tree size, number of descriptors or number of runs.");
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 generator(1234567);
+  std::uniform_int_distribution<int> distribution(0, 255);
+
+  voctree::MutableVocabularyTree<DescriptorFloat> tree;
+  if(treeFilepath.empty())
+  {
+    tree.setSize(levels, splits);
+    tree.centers().resize(tree.nodes());
+    tree.validCenters().resize(tree.nodes(), 1);
+    for(DescriptorFloat& center : tree.centers())
+    {
+      for(std::size_t i = 0; i < center.size(); ++i)
+        center[i] = static_cast<float>(distribution(generator));
+    }
+  }
+  else
+  {
+    tree.load(treeFilepath);
+  }
+
+  std::vector<DescriptorUChar> descriptors(nbDescriptors);
+  for(DescriptorUChar& descriptor : descriptors)
+  {
+    for(std::size_t i = 0; i < descriptor.size(); ++i)
+      descriptor[i] = static_cast<unsigned char>(distribution(generator));
+  }
+
+  ALICEVISION_COUT("Tree: " << tree.levels() << " levels, " << tree.splits() << " splits, " << tree.words() << " words");
+  ALICEVISION_COUT("Descriptors: " << nbDescriptors << ", " << nbRuns << " runs, " << omp_get_max_threads() << " threads" << std::endl);
+
+  std::vector<voctree::Word> wordsPerDescriptor(descriptors.size());
+  std::vector<voctree::Word> wordsBatch;
+
+  benchmark("per descriptor quantization", descriptors.size(), nbRuns, [&]() {
+    #pragma omp parallel for
+    for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(descriptors.size()); ++j)
+      wordsPerDescriptor[j] = tree.quantize(descriptors[j]);
+  });
+
+  benchmark("batch quantization", descriptors.size(), nbRuns, [&]() {
+    wordsBatch = tree.quantize(descriptors);
+  });
+
+  std::size_t nbDifferences = 0;
+  for(std::size_t j = 0; j < descriptors.size(); ++j)
+    nbDifferences += (wordsPerDescriptor[j] != wordsBatch[j]);
+
+  ALICEVISION_COUT(std::endl << "Different words: " << nbDifferences);
+
+  return (nbDifferences == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
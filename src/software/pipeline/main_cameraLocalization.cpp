@@ -7,6 +7,7 @@
 #include <aliceVision/config.hpp>
 #include <aliceVision/localization/ILocalizer.hpp>
 #include <aliceVision/localization/VoctreeLocalizer.hpp>
+#include <aliceVision/localization/StreamingLocalizer.hpp>
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
 #include <aliceVision/localization/CCTagLocalizer.hpp>
 #endif
@@ -38,6 +39,7 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <map>
 #include <memory>
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
@@ -47,7 +49,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -98,11 +100,20 @@ int aliceVision_main(int argc, char** argv)
   std::string vocTreeFilepath;
   /// the vocabulary tree weights file
   std::string weightsFilepath;
+  /// the localization index folder
+  std::string localizationIndexFolder;
   /// Number of previous frame of the sequence to use for matching
   std::size_t nbFrameBufferMatching = 10;
   /// enable/disable the robust matching (geometric validation) when matching query image
   /// and databases images
   bool robustMatching = true;
+  /// parameters of the tracking of consecutive frames
+  localization::VoctreeLocalizer::Parameters trackingParam;
+
+  /// enable the pipelined localization of the frames
+  bool streaming = false;
+  /// parameters of the streaming localization
+  localization::StreamingLocalizer::Parameters streamingParam;
   
   /// the Alembic export file
   std::string exportAlembicFile = "trackedcameras.abc";
@@ -182,6 +193,9 @@ int aliceVision_main(int argc, char** argv)
           "[voctree] Filename for the vocabulary tree")
       ("voctreeWeights", po::value<std::string>(&weightsFilepath), 
           "[voctree] Filename for the vocabulary tree weights")
+      ("localizationIndex", po::value<std::string>(&localizationIndexFolder),
+          "[voctree] Folder of the localization index built with aliceVision_utils_localizationIndex, "
+          "if provided the features of the scene are not loaded and the weights are ignored")
       ("algorithm", po::value<std::string>(&algostring)->default_value(algostring), 
           "[voctree] Algorithm type: FirstBest, AllResults" )
       ("matchingError", po::value<double>(&matchingErrorMax)->default_value(matchingErrorMax), 
@@ -194,12 +208,47 @@ int aliceVision_main(int argc, char** argv)
       ("robustMatching", po::value<bool>(&robustMatching)->default_value(robustMatching), 
           "[voctree] Enable/Disable the robust matching between query and database images, "
           "all putative matches will be considered.")
+      ("frameTracking", po::value<bool>(&trackingParam._useFrameTracking)->default_value(trackingParam._useFrameTracking),
+          "[voctree] Track the consecutive frames: the landmarks are matched around their projection with "
+          "the pose predicted from the previous frames, the database is only queried when the tracking is lost. "
+          "Not available with --streaming.")
+      ("trackingSearchRadius", po::value<double>(&trackingParam._trackingSearchRadius)->default_value(trackingParam._trackingSearchRadius),
+          "[voctree] Search radius (in pixels) around the projection of the landmarks when tracking")
+      ("trackingMinInliers", po::value<std::size_t>(&trackingParam._trackingMinInliers)->default_value(trackingParam._trackingMinInliers),
+          "[voctree] Minimum number of resection inliers for a frame to be tracked")
 // cctag specific options
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
       ("nNearestKeyFrames", po::value<size_t>(&nNearestKeyFrames)->default_value(nNearestKeyFrames), 
           "[cctag] Number of images to retrieve in the database")
 #endif
   ;
+
+// streaming options
+  po::options_description streamingParams("Parameters specific for the streaming localization (voctree, AllResults)");
+  streamingParams.add_options()
+      ("streaming", po::value<bool>(&streaming)->default_value(streaming),
+          "[streaming] Localize the frames with a pipeline of stages (decode, extraction, "
+          "retrieval, matching, resection) running on their own threads. Not available with --frameTracking.")
+      ("streamingExtractionThreads", po::value<std::size_t>(&streamingParam.nbExtractionThreads)->default_value(streamingParam.nbExtractionThreads),
+          "[streaming] Number of threads of the feature extraction stage")
+      ("streamingRetrievalThreads", po::value<std::size_t>(&streamingParam.nbRetrievalThreads)->default_value(streamingParam.nbRetrievalThreads),
+          "[streaming] Number of threads of the vocabulary tree query stage")
+      ("streamingMatchingThreads", po::value<std::size_t>(&streamingParam.nbMatchingThreads)->default_value(streamingParam.nbMatchingThreads),
+          "[streaming] Number of threads of the matching stage")
+      ("streamingResectionThreads", po::value<std::size_t>(&streamingParam.nbResectionThreads)->default_value(streamingParam.nbResectionThreads),
+          "[streaming] Number of threads of the resection stage")
+      ("streamingQueueSize", po::value<std::size_t>(&streamingParam.queueSize)->default_value(streamingParam.queueSize),
+          "[streaming] Maximum number of frames waiting between two stages")
+      ("streamingDropFrames", po::value<bool>(&streamingParam.dropFrames)->default_value(streamingParam.dropFrames),
+          "[streaming] Drop the oldest frames under overload instead of waiting for the next stages, "
+          "for live feeds only: the dropped frames are not localized")
+      ("streamingMaxLatency", po::value<double>(&streamingParam.maxLatency)->default_value(streamingParam.maxLatency),
+          "[streaming] Frames older than this latency (in seconds) are dropped (0 = no limit), "
+          "only if --streamingDropFrames is set")
+      ("streamingFrameRate", po::value<double>(&streamingParam.frameRate)->default_value(streamingParam.frameRate),
+          "[streaming] Rate of the frames read from the media, to simulate a live feed "
+          "(0 = as fast as possible)")
+  ;
   
 // final bundle adjustment options
   po::options_description bundleParams("Parameters specific for final (optional) bundle adjustment optimization of the sequence");
@@ -234,7 +283,7 @@ int aliceVision_main(int argc, char** argv)
 
       ;
   
-  allParams.add(inputParams).add(outputParams).add(commonParams).add(voctreeParams).add(bundleParams);
+  allParams.add(inputParams).add(outputParams).add(commonParams).add(voctreeParams).add(streamingParams).add(bundleParams);
 
   po::variables_map vm;
 
@@ -285,6 +334,17 @@ int aliceVision_main(int argc, char** argv)
   
   // the bundle adjustment can be run for now only if the refine intrinsics option is not set
   globalBundle = (globalBundle && !refineIntrinsics);
+
+  if(streaming && (!useVoctreeLocalizer || localization::VoctreeLocalizer::initFromString(algostring) != localization::VoctreeLocalizer::Algorithm::AllResults))
+  {
+    ALICEVISION_CERR("ERROR: the streaming localization requires the voctree localizer with the AllResults algorithm.");
+    return EXIT_FAILURE;
+  }
+  if(streaming && trackingParam._useFrameTracking)
+  {
+    ALICEVISION_CERR("ERROR: the frame tracking is not available with the streaming localization.");
+    return EXIT_FAILURE;
+  }
   ALICEVISION_COUT("Program called with the following parameters:");
   ALICEVISION_COUT(vm);
 
@@ -342,7 +402,8 @@ int aliceVision_main(int argc, char** argv)
                                                    descriptorsFolder,
                                                    vocTreeFilepath,
                                                    weightsFilepath,
-                                                   matchDescTypes);
+                                                   matchDescTypes,
+                                                   localizationIndexFolder);
 
     localizer.reset(tmpLoc);
     
@@ -356,6 +417,9 @@ int aliceVision_main(int argc, char** argv)
     tmpParam->_matchingError = matchingErrorMax;
     tmpParam->_nbFrameBufferMatching = nbFrameBufferMatching;
     tmpParam->_useRobustMatching = robustMatching;
+    tmpParam->_useFrameTracking = trackingParam._useFrameTracking;
+    tmpParam->_trackingSearchRadius = trackingParam._trackingSearchRadius;
+    tmpParam->_trackingMinInliers = trackingParam._trackingMinInliers;
   }
   
   assert(localizer);
@@ -407,48 +471,110 @@ int aliceVision_main(int argc, char** argv)
   // standard deviation of the time taken for localization
   bacc::accumulator_set<double, bacc::stats<bacc::tag::mean, bacc::tag::min, bacc::tag::max, bacc::tag::sum > > stats;
   
+  // the frames of the streaming localization are processed concurrently, only the total time is known
+  double streamingElapsed = 0.0;
+
   std::vector<localization::LocalizationResult> vec_localizationResults;
   
-  while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+  // save the result of a frame, the frames are saved in order
+  const auto saveResult = [&](const localization::LocalizationResult& localizationResult,
+                              const std::string& imgName,
+                              const camera::PinholeRadialK3& intrinsics)
   {
-    ALICEVISION_COUT("******************************");
-    ALICEVISION_COUT("FRAME " << utils::toStringZeroPadded(frameCounter, 4));
-    ALICEVISION_COUT("******************************");
-    localization::LocalizationResult localizationResult;
-    auto detect_start = std::chrono::steady_clock::now();
-    localizer->localize(imageGrey, 
-                       param.get(),
-                       generator,
-                       hasIntrinsics /*useInputIntrinsics*/,
-                       queryIntrinsics,
-                       localizationResult,
-                       currentImgName);
-    auto detect_end = std::chrono::steady_clock::now();
-    auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-    ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
-    stats(detect_elapsed.count());
-    
     vec_localizationResults.emplace_back(localizationResult);
 
     // save data
     if(localizationResult.isValid())
     {
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.addCameraKeyframe(localizationResult.getPose(), &queryIntrinsics, currentImgName, frameCounter, frameCounter);
+      exporter.addCameraKeyframe(localizationResult.getPose(), &intrinsics, imgName, frameCounter, frameCounter);
 #endif
       
       goodFrameCounter++;
-      goodFrameList.push_back(currentImgName + " : " + std::to_string(localizationResult.getIndMatch3D2D().size()) );
+      goodFrameList.push_back(imgName + " : " + std::to_string(localizationResult.getIndMatch3D2D().size()) );
     }
     else
     {
       ALICEVISION_CERR("Unable to localize frame " << frameCounter);
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.jumpKeyframe(currentImgName);
+      exporter.jumpKeyframe(imgName);
 #endif
     }
     ++frameCounter;
-    feed.goToNextFrame();
+  };
+
+  if(streaming)
+  {
+    localization::StreamingLocalizer streamingLocalizer(static_cast<localization::VoctreeLocalizer&>(*localizer),
+                                                        static_cast<const localization::VoctreeLocalizer::Parameters&>(*param),
+                                                        streamingParam);
+
+    // the frames are read by the decode stage, the results are received out of order
+    std::vector<std::string> frameNames;
+    std::map<std::size_t, localization::LocalizationResult> frameResults;
+
+    const auto source = [&](image::Image<float>& frameGrey, camera::PinholeRadialK3& frameIntrinsics, std::string& imgName, bool& frameHasIntrinsics)
+    {
+      if(!feed.readImage(frameGrey, frameIntrinsics, imgName, frameHasIntrinsics))
+        return false;
+      frameNames.push_back(imgName);
+      feed.goToNextFrame();
+      return true;
+    };
+
+    const auto callback = [&](std::size_t frameId, const std::string& imgName, const localization::LocalizationResult& localizationResult)
+    {
+      ALICEVISION_COUT("FRAME " << utils::toStringZeroPadded(frameId, 4) << " " << (localizationResult.isValid() ? "localized" : "not localized"));
+      frameResults[frameId] = localizationResult;
+    };
+
+    const auto streaming_start = std::chrono::steady_clock::now();
+    const std::size_t nbFrames = streamingLocalizer.run(source, callback, generator());
+    const auto streaming_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - streaming_start);
+    streamingElapsed = streaming_elapsed.count();
+
+    ALICEVISION_COUT("\nStreaming localization of " << nbFrames << " frames took " << streaming_elapsed.count() << " [ms]");
+    streamingLocalizer.printStatistics();
+
+    std::size_t nbDroppedFrames = 0;
+    for(int stage = 0; stage < localization::StreamingLocalizer::NB_STAGES; ++stage)
+      nbDroppedFrames += streamingLocalizer.getNbDroppedFrames(static_cast<localization::StreamingLocalizer::EStage>(stage));
+    ALICEVISION_LOG_INFO("Streaming localization: " << nbDroppedFrames << " / " << nbFrames << " frames dropped.");
+
+    // the dropped frames have no result
+    for(std::size_t frameId = 0; frameId < nbFrames; ++frameId)
+    {
+      const auto it = frameResults.find(frameId);
+      if(it == frameResults.end())
+        saveResult(localization::LocalizationResult(), frameNames.at(frameId), queryIntrinsics);
+      else
+        saveResult(it->second, frameNames.at(frameId), it->second.getIntrinsics());
+    }
+  }
+  else
+  {
+    while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+    {
+      ALICEVISION_COUT("******************************");
+      ALICEVISION_COUT("FRAME " << utils::toStringZeroPadded(frameCounter, 4));
+      ALICEVISION_COUT("******************************");
+      localization::LocalizationResult localizationResult;
+      auto detect_start = std::chrono::steady_clock::now();
+      localizer->localize(imageGrey, 
+                         param.get(),
+                         generator,
+                         hasIntrinsics /*useInputIntrinsics*/,
+                         queryIntrinsics,
+                         localizationResult,
+                         currentImgName);
+      auto detect_end = std::chrono::steady_clock::now();
+      auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+      ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
+      stats(detect_elapsed.count());
+      
+      saveResult(localizationResult, currentImgName, queryIntrinsics);
+      feed.goToNextFrame();
+    }
   }
 
   if(wantsJsonOutput)
@@ -517,10 +643,19 @@ int aliceVision_main(int argc, char** argv)
   ALICEVISION_COUT("Images localized with the number of 2D/3D matches during localization :");
   for(std::size_t i = 0; i < goodFrameList.size(); ++i)
     ALICEVISION_COUT(goodFrameList[i]);
-  ALICEVISION_COUT("Processing took " << bacc::sum(stats)/1000 << " [s] overall");
-  ALICEVISION_COUT("Mean time for localization:   " << bacc::mean(stats) << " [ms]");
-  ALICEVISION_COUT("Max time for localization:   " << bacc::max(stats) << " [ms]");
-  ALICEVISION_COUT("Min time for localization:   " << bacc::min(stats) << " [ms]");
+  if(streaming)
+  {
+    // the latencies of the frames are printed by the streaming localizer
+    ALICEVISION_COUT("Processing took " << streamingElapsed / 1000 << " [s] overall");
+    ALICEVISION_COUT("Throughput:   " << (streamingElapsed > 0.0 ? 1000.0 * frameCounter / streamingElapsed : 0.0) << " [frames/s]");
+  }
+  else
+  {
+    ALICEVISION_COUT("Processing took " << bacc::sum(stats)/1000 << " [s] overall");
+    ALICEVISION_COUT("Mean time for localization:   " << bacc::mean(stats) << " [ms]");
+    ALICEVISION_COUT("Max time for localization:   " << bacc::max(stats) << " [ms]");
+    ALICEVISION_COUT("Min time for localization:   " << bacc::min(stats) << " [ms]");
+  }
 
   return EXIT_SUCCESS;
 }
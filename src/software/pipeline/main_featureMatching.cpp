@@ -42,7 +42,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -111,6 +111,7 @@ int aliceVision_main(int argc, char **argv)
   bool guidedMatching = false;
   bool crossMatching = false;
   int maxIteration = 2048;
+  bool adaptiveIterations = false;
   bool matchFilePerImage = false;
   size_t numMatchesToKeep = 0;
   bool useGridSort = true;
@@ -179,6 +180,9 @@ int aliceVision_main(int argc, char **argv)
       "Distance ratio to discard non meaningful matches.")
     ("maxIteration", po::value<int>(&maxIteration)->default_value(maxIteration),
       "Maximum number of iterations allowed in ransac step.")
+    ("adaptiveIterations", po::value<bool>(&adaptiveIterations)->default_value(adaptiveIterations),
+      "Bound the ACRansac refinement iterations by the number of iterations needed to draw an outlier-free sample "
+      "at the inlier ratio found (faster on high inlier ratios, but the models may be less precise).")
     ("useGridSort", po::value<bool>(&useGridSort)->default_value(useGridSort),
       "Use matching grid sort.")
     ("minRequired2DMotion", po::value<double>(&minRequired2DMotion)->default_value(minRequired2DMotion),
@@ -517,10 +521,12 @@ int aliceVision_main(int argc, char **argv)
 
     case EGeometricFilterType::FUNDAMENTAL_MATRIX:
     {
+      GeometricFilterMatrix_F_AC geometricFilter(geometricErrorMax, maxIteration, geometricEstimator);
+      geometricFilter.m_adaptiveIterations = adaptiveIterations;
       matchingImageCollection::robustModelEstimation(geometricMatches,
         &sfmData,
         regionPerView,
-        GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator),
+        geometricFilter,
         mapPutativesMatches,
         randomNumberGenerator,
         guidedMatching);
@@ -529,10 +535,12 @@ int aliceVision_main(int argc, char **argv)
 
   case EGeometricFilterType::FUNDAMENTAL_WITH_DISTORTION:
   {
+    GeometricFilterMatrix_F_AC geometricFilter(geometricErrorMax, maxIteration, geometricEstimator, true);
+    geometricFilter.m_adaptiveIterations = adaptiveIterations;
     matchingImageCollection::robustModelEstimation(geometricMatches,
       &sfmData,
       regionPerView,
-      GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, true),
+      geometricFilter,
       mapPutativesMatches,
       randomNumberGenerator,
       guidedMatching);
@@ -541,10 +549,12 @@ int aliceVision_main(int argc, char **argv)
 
     case EGeometricFilterType::ESSENTIAL_MATRIX:
     {
+      GeometricFilterMatrix_E_AC geometricFilter(geometricErrorMax, maxIteration);
+      geometricFilter.m_adaptiveIterations = adaptiveIterations;
       matchingImageCollection::robustModelEstimation(geometricMatches,
         &sfmData,
         regionPerView,
-        GeometricFilterMatrix_E_AC(geometricErrorMax, maxIteration),
+        geometricFilter,
         mapPutativesMatches,
         randomNumberGenerator,
         guidedMatching);
@@ -571,10 +581,12 @@ int aliceVision_main(int argc, char **argv)
     case EGeometricFilterType::HOMOGRAPHY_MATRIX:
     {
       const bool onlyGuidedMatching = true;
+      GeometricFilterMatrix_H_AC geometricFilter(geometricErrorMax, maxIteration);
+      geometricFilter.m_adaptiveIterations = adaptiveIterations;
       matchingImageCollection::robustModelEstimation(geometricMatches,
         &sfmData,
         regionPerView,
-        GeometricFilterMatrix_H_AC(geometricErrorMax, maxIteration),
+        geometricFilter,
         mapPutativesMatches, randomNumberGenerator, guidedMatching,
         onlyGuidedMatching ? -1.0 : 0.6);
     }
@@ -23,7 +23,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -78,7 +78,8 @@ int aliceVision_main(int argc, char **argv)
       feature::EImageDescriberType_informations().c_str())
     ("rotationAveraging", po::value<sfm::ERotationAveragingMethod>(&rotationAveragingMethod)->default_value(rotationAveragingMethod),
       "* 1: L1 minimization\n"
-      "* 2: L2 minimization")
+      "* 2: L2 minimization\n"
+      "* 3: chordal initialization and robust IRLS refinement, sparse and multithreaded for large view graphs")
     ("translationAveraging", po::value<sfm::ETranslationAveragingMethod>(&translationAveragingMethod)->default_value(translationAveragingMethod),
       "* 1: L1 minimization\n"
       "* 2: L2 minimization of sum of squared Chordal distances\n"
@@ -128,7 +129,7 @@ int aliceVision_main(int argc, char **argv)
   system::Logger::get()->setLogLevel(verboseLevel);
 
   if (rotationAveragingMethod < sfm::ROTATION_AVERAGING_L1 ||
-      rotationAveragingMethod > sfm::ROTATION_AVERAGING_L2 )
+      rotationAveragingMethod > sfm::ROTATION_AVERAGING_IRLS )
   {
     ALICEVISION_LOG_ERROR("Rotation averaging method is invalid");
     return EXIT_FAILURE;
@@ -23,11 +23,12 @@
 #include <boost/filesystem.hpp>
 
 #include <cstdlib>
+#include <memory>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 3
 
 using namespace aliceVision;
 
@@ -88,6 +89,8 @@ int aliceVision_main(int argc, char **argv)
   std::pair<std::string,std::string> initialPairString("","");
 
   sfm::ReconstructionEngine_sequentialSfM::Params sfmParams;
+  std::size_t maxClusterSize = 0;
+  double clusterOverlapRatio = sfm::ReconstructionEngine_hierarchicalSfM::Params().clusterOverlapRatio;
   bool lockScenePreviouslyReconstructed = true;
   int maxNbMatches = 0;
   int minNbMatches = 0;
@@ -122,6 +125,12 @@ int aliceVision_main(int argc, char **argv)
       feature::EImageDescriberType_informations().c_str())
     ("interFileExtension", po::value<std::string>(&sfmParams.sfmStepFileExtension)->default_value(sfmParams.sfmStepFileExtension),
       "Extension of the intermediate file export.")
+    ("checkpointFile", po::value<std::string>(&sfmParams.checkpointFilepath)->default_value(sfmParams.checkpointFilepath),
+      "Path to the checkpoint log file, the scene changes are appended to it after each resection group. "
+      "Empty means no checkpoint.")
+    ("resumeFromCheckpoint", po::value<bool>(&sfmParams.resumeFromCheckpoint)->default_value(sfmParams.resumeFromCheckpoint),
+      "Replay the checkpoint log (if it exists) to restart an interrupted reconstruction from its last checkpoint. "
+      "The input SfMData and parameters must be the same as in the interrupted reconstruction.")
     ("maxNumberOfMatches", po::value<int>(&maxNbMatches)->default_value(maxNbMatches),
       "Maximum number of matches per image pair (and per feature type). "
       "This can be useful to have a quick reconstruction overview. 0 means no limit.")
@@ -140,6 +149,12 @@ int aliceVision_main(int argc, char **argv)
       "Minimum angle for the initial pair.")
     ("maxAngleInitialPair", po::value<float>(&sfmParams.maxAngleInitialPair)->default_value(sfmParams.maxAngleInitialPair),
       "Maximum angle for the initial pair.")
+    ("initialPairMaxCandidates", po::value<std::size_t>(&sfmParams.initialPairMaxCandidates)->default_value(sfmParams.initialPairMaxCandidates),
+      "Maximum number of candidate pairs evaluated for the automatic initial pair selection, "
+      "ranked by the repartition of their common tracks. 0 means no limit.")
+    ("initialPairEarlyStopRatio", po::value<double>(&sfmParams.initialPairEarlyStopRatio)->default_value(sfmParams.initialPairEarlyStopRatio),
+      "Stop the automatic initial pair selection when the best score reaches this ratio of the best score the remaining candidates could reach. "
+      "1 gives the same result as the full search, lower values stop earlier, 0 disables the early stop.")
     ("minNumberOfObservationsForTriangulation", po::value<std::size_t>(&sfmParams.minNbObservationsForTriangulation)->default_value(sfmParams.minNbObservationsForTriangulation),
       "Minimum number of observations to triangulate a point.\n"
       "Set it to 3 (or more) reduces drastically the noise in the point cloud, but the number of final poses is a little bit reduced (from 1.5% to 11% on the tested datasets).\n"
@@ -181,6 +196,11 @@ int aliceVision_main(int argc, char **argv)
       "Use of an observation constraint : basic, scale the observation or use of the covariance.\n")
     ("computeStructureColor", po::value<bool>(&computeStructureColor)->default_value(computeStructureColor),
       "Compute each 3D point color.\n")
+    ("maxClusterSize", po::value<std::size_t>(&maxClusterSize)->default_value(maxClusterSize),
+      "Maximum number of views of a cluster for the hierarchical reconstruction: the view graph is partitioned in clusters "
+      "reconstructed in parallel, then merged and refined by a global bundle adjustment. 0 means a single sequential reconstruction.")
+    ("clusterOverlapRatio", po::value<double>(&clusterOverlapRatio)->default_value(clusterOverlapRatio),
+      "Number of views added to each cluster from its neighbours (relative to the cluster size), used to align the cluster reconstructions.")
     ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
       "This seed value will generate a sequence using a linear random generator. Set -1 to use a random seed.")
     ;
@@ -311,53 +331,75 @@ int aliceVision_main(int argc, char **argv)
     }
   }
 
-  sfm::ReconstructionEngine_sequentialSfM sfmEngine(
-    sfmData,
-    sfmParams,
-    extraInfoFolder,
-    (fs::path(extraInfoFolder) / "sfm_log.html").string());
+  std::unique_ptr<sfm::ReconstructionEngine> sfmEngine;
 
-  sfmEngine.initRandomSeed(randomSeed);
+  if(maxClusterSize > 0 && maxClusterSize < sfmData.getViews().size())
+  {
+    sfm::ReconstructionEngine_hierarchicalSfM::Params hierarchicalParams{sfmParams};
+    hierarchicalParams.maxClusterSize = maxClusterSize;
+    hierarchicalParams.clusterOverlapRatio = clusterOverlapRatio;
+
+    sfm::ReconstructionEngine_hierarchicalSfM* hierarchicalEngine = new sfm::ReconstructionEngine_hierarchicalSfM(
+      sfmData,
+      hierarchicalParams,
+      extraInfoFolder);
+
+    // configure the featuresPerView & the matches_provider
+    hierarchicalEngine->setFeatures(&featuresPerView);
+    hierarchicalEngine->setMatches(&pairwiseMatches);
+    sfmEngine.reset(hierarchicalEngine);
+  }
+  else
+  {
+    sfm::ReconstructionEngine_sequentialSfM* sequentialEngine = new sfm::ReconstructionEngine_sequentialSfM(
+      sfmData,
+      sfmParams,
+      extraInfoFolder,
+      (fs::path(extraInfoFolder) / "sfm_log.html").string());
+
+    // configure the featuresPerView & the matches_provider
+    sequentialEngine->setFeatures(&featuresPerView);
+    sequentialEngine->setMatches(&pairwiseMatches);
+    sfmEngine.reset(sequentialEngine);
+  }
 
-  // configure the featuresPerView & the matches_provider
-  sfmEngine.setFeatures(&featuresPerView);
-  sfmEngine.setMatches(&pairwiseMatches);
+  sfmEngine->initRandomSeed(randomSeed);
 
-  if(!sfmEngine.process())
+  if(!sfmEngine->process())
     return EXIT_FAILURE;
 
   // set featuresFolders and matchesFolders relative paths
   {
-      sfmEngine.getSfMData().addFeaturesFolders(featuresFolders);
-      sfmEngine.getSfMData().addMatchesFolders(matchesFolders);
-      sfmEngine.getSfMData().setAbsolutePath(outputSfM);
+      sfmEngine->getSfMData().addFeaturesFolders(featuresFolders);
+      sfmEngine->getSfMData().addMatchesFolders(matchesFolders);
+      sfmEngine->getSfMData().setAbsolutePath(outputSfM);
   }
 
   // get the color for the 3D points
   if(computeStructureColor)
-    sfmEngine.colorize();
+    sfmEngine->colorize();
 
-  sfmEngine.retrieveMarkersId();
+  sfmEngine->retrieveMarkersId();
 
   ALICEVISION_LOG_INFO("Structure from motion took (s): " + std::to_string(timer.elapsed()));
   ALICEVISION_LOG_INFO("Generating HTML report...");
 
-  sfm::generateSfMReport(sfmEngine.getSfMData(), (fs::path(extraInfoFolder) / "sfm_report.html").string());
+  sfm::generateSfMReport(sfmEngine->getSfMData(), (fs::path(extraInfoFolder) / "sfm_report.html").string());
 
   // export to disk computed scene (data & visualizable results)
   ALICEVISION_LOG_INFO("Export SfMData to disk: " + outputSfM);
 
-  sfmDataIO::Save(sfmEngine.getSfMData(), (fs::path(extraInfoFolder) / ("cloud_and_poses" + sfmParams.sfmStepFileExtension)).string(), sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS|sfmDataIO::STRUCTURE));
-  sfmDataIO::Save(sfmEngine.getSfMData(), outputSfM, sfmDataIO::ESfMData::ALL);
+  sfmDataIO::Save(sfmEngine->getSfMData(), (fs::path(extraInfoFolder) / ("cloud_and_poses" + sfmParams.sfmStepFileExtension)).string(), sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS|sfmDataIO::STRUCTURE));
+  sfmDataIO::Save(sfmEngine->getSfMData(), outputSfM, sfmDataIO::ESfMData::ALL);
 
   if(!outputSfMViewsAndPoses.empty())
-   sfmDataIO:: Save(sfmEngine.getSfMData(), outputSfMViewsAndPoses, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS));
+   sfmDataIO:: Save(sfmEngine->getSfMData(), outputSfMViewsAndPoses, sfmDataIO::ESfMData(sfmDataIO::VIEWS|sfmDataIO::EXTRINSICS|sfmDataIO::INTRINSICS));
 
   ALICEVISION_LOG_INFO("Structure from Motion results:" << std::endl
-    << "\t- # input images: " << sfmEngine.getSfMData().getViews().size() << std::endl
-    << "\t- # cameras calibrated: " << sfmEngine.getSfMData().getValidViews().size() << std::endl
-    << "\t- # poses: " << sfmEngine.getSfMData().getPoses().size() << std::endl
-    << "\t- # landmarks: " << sfmEngine.getSfMData().getLandmarks().size());
+    << "\t- # input images: " << sfmEngine->getSfMData().getViews().size() << std::endl
+    << "\t- # cameras calibrated: " << sfmEngine->getSfMData().getValidViews().size() << std::endl
+    << "\t- # poses: " << sfmEngine->getSfMData().getPoses().size() << std::endl
+    << "\t- # landmarks: " << sfmEngine->getSfMData().getLandmarks().size());
 
   return EXIT_SUCCESS;
 }
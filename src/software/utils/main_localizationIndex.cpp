@@ -0,0 +1,136 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/localization/VoctreeLocalizer.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+/*
+ * This program builds the localization index of a reconstruction: the features and descriptors
+ * associated to the landmarks of each view and the vocabulary tree database.
+ * The camera localization can then load the index instead of the features of all the views.
+ */
+int aliceVision_main(int argc, char** argv)
+{
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  /// the AliceVision .json data file
+  std::string sfmFilePath;
+  /// the folder containing the descriptors
+  std::string descriptorsFolder;
+  /// the vocabulary tree file
+  std::string vocTreeFilepath;
+  /// the vocabulary tree weights file
+  std::string weightsFilepath;
+  /// the describer types name to use for the matching
+  std::string matchDescTypeNames = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+  /// the output folder of the index
+  std::string outputFolder;
+
+  po::options_description allParams("This program builds the localization index of a reconstruction, "
+                                    "used by the camera localization to start without loading the features of the scene.\n"
+                                    "AliceVision localizationIndex");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("sfmdata", po::value<std::string>(&sfmFilePath)->required(),
+      "The sfm_data.json kind of file generated by AliceVision.")
+    ("voctree", po::value<std::string>(&vocTreeFilepath)->required(),
+      "Filename for the vocabulary tree")
+    ("output,o", po::value<std::string>(&outputFolder)->required(),
+      "Output folder of the localization index.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("descriptorPath", po::value<std::string>(&descriptorsFolder),
+      "Folder containing the descriptors for all the images (ie the *.desc.)")
+    ("voctreeWeights", po::value<std::string>(&weightsFilepath),
+      "Filename for the vocabulary tree weights")
+    ("matchDescTypes", po::value<std::string>(&matchDescTypeNames)->default_value(matchDescTypeNames),
+      "The describer types to use for the matching");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  // load SfMData
+  sfmData::SfMData sfmData;
+  if(!sfmDataIO::Load(sfmData, sfmFilePath, sfmDataIO::ESfMData::ALL))
+  {
+    ALICEVISION_LOG_ERROR("The input SfMData file '" + sfmFilePath + "' cannot be read.");
+    return EXIT_FAILURE;
+  }
+
+  // build the localizer from the features of the scene
+  system::Timer timer;
+  const localization::VoctreeLocalizer localizer(sfmData,
+                                                 descriptorsFolder,
+                                                 vocTreeFilepath,
+                                                 weightsFilepath,
+                                                 feature::EImageDescriberType_stringToEnums(matchDescTypeNames));
+  if(!localizer.isInit())
+  {
+    ALICEVISION_LOG_ERROR("Unable to initialize the localizer.");
+    return EXIT_FAILURE;
+  }
+  ALICEVISION_LOG_INFO("Localizer initialized in " << timer.elapsed() << " [s]");
+
+  localizer.saveIndex(outputFolder);
+
+  return EXIT_SUCCESS;
+}
@@ -23,11 +23,12 @@
 #include <fstream>
 #include <string>
 #include <chrono>
+#include <random>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 static const int DIMENSION = 128;
 
@@ -53,7 +54,10 @@ int aliceVision_main(int argc, char** argv)
   std::uint32_t K = 10;
   std::uint32_t restart = 5;
   std::uint32_t LEVELS = 6;
+  std::size_t maxDescriptors = 0;
+  std::size_t miniBatchSize = 0;
   bool sanityCheck = true;
+  int randomSeed = std::mt19937::default_seed;
 
   po::options_description allParams("This program is used to load the sift descriptors from a SfMData file and create a vocabulary tree\n"
                                     "It takes as input either a list.txt file containing the a simple list of images (bundler format and older AliceVision version format)\n"
@@ -73,7 +77,14 @@ int aliceVision_main(int argc, char** argv)
     (",k", po::value<uint32_t>(&K)->default_value(10), "The branching factor of the tree")
     ("restart,r", po::value<uint32_t>(&restart)->default_value(5), "Number of times that the kmean is launched for each cluster, the best solution is kept")
     (",L", po::value<uint32_t>(&LEVELS)->default_value(6), "Number of levels of the tree")
-    ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree");
+    ("maxDescriptors", po::value<std::size_t>(&maxDescriptors)->default_value(maxDescriptors),
+      "Maximum number of descriptors used to train the tree, evenly sampled in the descriptor files (0 to use all of them). "
+      "The descriptors are then read again image by image to build the database.")
+    ("miniBatchSize", po::value<std::size_t>(&miniBatchSize)->default_value(miniBatchSize),
+      "Use the mini-batch k-means with batches of this size to cluster the nodes with more descriptors (0 to always use the standard k-means)")
+    ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree")
+    ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
+      "This seed value will generate a sequence using a linear random generator. Set -1 to use a random seed.");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -127,7 +138,7 @@ int aliceVision_main(int argc, char** argv)
   std::vector<size_t> descRead;
   ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
   auto detect_start = std::chrono::steady_clock::now();
-  size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
+  size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead, maxDescriptors);
   auto detect_end = std::chrono::steady_clock::now();
   auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
   if(descriptors.empty())
@@ -143,9 +154,11 @@ int aliceVision_main(int argc, char** argv)
   aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
   builder.setVerbose(tbVerbosity);
   builder.kmeans().setRestarts(restart);
+  builder.kmeans().setMiniBatchSize(miniBatchSize);
   ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
   detect_start = std::chrono::steady_clock::now();
-  builder.build(descriptors, K, LEVELS);
+  std::mt19937 randomNumberGenerator(randomSeed == -1 ? std::random_device()() : randomSeed);
+  builder.build(descriptors, K, LEVELS, randomNumberGenerator);
   detect_end = std::chrono::steady_clock::now();
   detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
   ALICEVISION_COUT("Tree created in " << ((float) detect_elapsed.count()) / 1000 << " sec");
@@ -157,31 +170,52 @@ int aliceVision_main(int argc, char** argv)
   // temporary vector used to save all the visual word for each image before adding them to documents
   std::vector<aliceVision::voctree::Word> imgVisualWords;
   ALICEVISION_COUT("Quantizing the features");
-  size_t offset = 0; ///< this is used to align to the features of a given image in 'feature'
   detect_start = std::chrono::steady_clock::now();
-  // pass each feature through the vocabulary tree to get the associated visual word
-  // for each read images, recover the number of features in it from descRead and loop over the features
-  for(size_t i = 0; i < descRead.size(); ++i)
+  if(maxDescriptors > 0)
   {
-    // for each image:
-    // clear the temporary vector used to save all the visual word and allocate the proper size
-    imgVisualWords.clear();
-    // allocate as many visual words as the number of the features in the image
-    imgVisualWords.resize(descRead[i], 0);
-
-    #pragma omp parallel for
-    for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(descRead[i]); ++j)
+    // the training descriptors are only a subset of the features:
+    // read the descriptors of each image again and quantize them
+    std::vector<DescriptorFloat>().swap(descriptors);
+
+    std::map<IndexT, std::string> descriptorsFiles;
+    aliceVision::voctree::getListOfDescriptorFiles(sfmData, featuresFolders, descriptorsFiles);
+
+    std::vector<DescriptorFloat> imgDescriptors;
+    size_t i = 0;
+    for(const auto& currentFile : descriptorsFiles)
     {
-      //	store the visual word associated to the feature in the temporary list
-      imgVisualWords[j] = builder.tree().quantize(descriptors[ j + offset ]);
+      aliceVision::feature::loadDescsFromBinFile<DescriptorFloat, DescriptorUChar>(currentFile.second, imgDescriptors, false);
+      aliceVision::voctree::computeSparseHistogram(builder.tree().quantize(imgDescriptors), allSparseHistograms[i]);
+      ++i;
     }
-    aliceVision::voctree::SparseHistogram histo;
-    aliceVision::voctree::computeSparseHistogram(imgVisualWords, histo);
-    // add the vector to the documents
-    allSparseHistograms[i] = histo;
+  }
+  else
+  {
+    size_t offset = 0; ///< this is used to align to the features of a given image in 'feature'
+    // pass each feature through the vocabulary tree to get the associated visual word
+    // for each read images, recover the number of features in it from descRead and loop over the features
+    for(size_t i = 0; i < descRead.size(); ++i)
+    {
+      // for each image:
+      // clear the temporary vector used to save all the visual word and allocate the proper size
+      imgVisualWords.clear();
+      // allocate as many visual words as the number of the features in the image
+      imgVisualWords.resize(descRead[i], 0);
+
+      #pragma omp parallel for
+      for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(descRead[i]); ++j)
+      {
+        //	store the visual word associated to the feature in the temporary list
+        imgVisualWords[j] = builder.tree().quantize(descriptors[ j + offset ]);
+      }
+      aliceVision::voctree::SparseHistogram histo;
+      aliceVision::voctree::computeSparseHistogram(imgVisualWords, histo);
+      // add the vector to the documents
+      allSparseHistograms[i] = histo;
 
-    // update the offset
-    offset += descRead[i];
+      // update the offset
+      offset += descRead[i];
+    }
   }
   detect_end = std::chrono::steady_clock::now();
   detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);